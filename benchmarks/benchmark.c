@@ -0,0 +1,155 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/common/clock.h>
+#include <aws/common/math.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int benchmark_result_init(struct benchmark_result *result, struct aws_allocator *allocator) {
+    AWS_ZERO_STRUCT(*result);
+    result->allocator = allocator;
+    result->latency_sample_stride = 1;
+    result->latency_samples_ns = aws_mem_calloc(allocator, BENCHMARK_MAX_LATENCY_SAMPLES, sizeof(uint64_t));
+    if (!result->latency_samples_ns) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void benchmark_result_clean_up(struct benchmark_result *result) {
+    aws_mem_release(result->allocator, result->latency_samples_ns);
+    AWS_ZERO_STRUCT(*result);
+}
+
+void benchmark_result_record_latency(struct benchmark_result *result, uint64_t latency_ns) {
+    if (result->latency_samples_to_skip > 0) {
+        --result->latency_samples_to_skip;
+        return;
+    }
+
+    if (result->latency_sample_count == BENCHMARK_MAX_LATENCY_SAMPLES) {
+        /* keeps the samples spread over the whole run rather than just its start */
+        for (size_t i = 0; i < BENCHMARK_MAX_LATENCY_SAMPLES / 2; ++i) {
+            result->latency_samples_ns[i] = result->latency_samples_ns[i * 2];
+        }
+        result->latency_sample_count = BENCHMARK_MAX_LATENCY_SAMPLES / 2;
+        result->latency_sample_stride *= 2;
+    }
+
+    result->latency_samples_ns[result->latency_sample_count++] = latency_ns;
+    result->latency_samples_to_skip = result->latency_sample_stride - 1;
+}
+
+static int s_compare_uint64(const void *a, const void *b) {
+    uint64_t left = *(const uint64_t *)a;
+    uint64_t right = *(const uint64_t *)b;
+    return (left > right) - (left < right);
+}
+
+static uint64_t s_percentile(const struct benchmark_result *result, double percentile) {
+    if (result->latency_sample_count == 0) {
+        return 0;
+    }
+
+    size_t index = (size_t)((double)(result->latency_sample_count - 1) * percentile / 100.0);
+    return result->latency_samples_ns[index];
+}
+
+static double s_per_second(uint64_t count, uint64_t elapsed_ns) {
+    if (elapsed_ns == 0) {
+        return 0.0;
+    }
+
+    return (double)count * (double)AWS_TIMESTAMP_NANOS / (double)elapsed_ns;
+}
+
+void benchmark_report(const char *name, struct benchmark_result *result) {
+    qsort(result->latency_samples_ns, result->latency_sample_count, sizeof(uint64_t), s_compare_uint64);
+
+    printf(
+        "{\"name\":\"%s\",\"operations\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"elapsed_ns\":%" PRIu64
+        ",\"ops_per_sec\":%.1f,\"bytes_per_sec\":%.1f,\"p50_ns\":%" PRIu64 ",\"p99_ns\":%" PRIu64 "}\n",
+        name,
+        result->operations,
+        result->bytes,
+        result->elapsed_ns,
+        s_per_second(result->operations, result->elapsed_ns),
+        s_per_second(result->bytes, result->elapsed_ns),
+        s_percentile(result, 50.0),
+        s_percentile(result, 99.0));
+    fflush(stdout);
+}
+
+bool benchmark_should_run(const struct benchmark_config *config, const char *name) {
+    return config->filter == NULL || strstr(name, config->filter) != NULL;
+}
+
+uint64_t benchmark_now_ns(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static benchmark_fn *s_benchmarks[] = {
+    benchmark_message_pool,
+    benchmark_channel_pass_through,
+    benchmark_channel_idle_footprint,
+    benchmark_socket_loopback,
+    benchmark_tls,
+    benchmark_cross_thread_tasks,
+    benchmark_server_scaling,
+};
+
+static void s_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [--duration-ms <ms>] [--filter <substring>] [--resources <dir>]\n"
+        "Runs each benchmark for the given duration (default 1000ms) and prints one JSON line per result.\n",
+        program);
+}
+
+int main(int argc, char **argv) {
+    struct benchmark_config config = {
+        .duration_ns = AWS_TIMESTAMP_NANOS,
+        .filter = NULL,
+        .resources_dir = AWS_IO_BENCHMARK_RESOURCES_DIR,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--duration-ms") == 0) {
+            config.duration_ns = aws_timestamp_convert(
+                strtoull(argv[++i], NULL, 10), AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            config.filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--resources") == 0) {
+            config.resources_dir = argv[++i];
+        } else {
+            s_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_io_library_init(allocator);
+
+    int exit_code = 0;
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_benchmarks); ++i) {
+        if (s_benchmarks[i](allocator, &config)) {
+            fprintf(stderr, "benchmark failed: %s\n", aws_error_debug_str(aws_last_error()));
+            exit_code = 1;
+        }
+    }
+
+    aws_io_library_clean_up();
+
+    return exit_code;
+}
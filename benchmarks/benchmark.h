@@ -0,0 +1,111 @@
+#ifndef AWS_IO_BENCHMARK_H
+#define AWS_IO_BENCHMARK_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/channel.h>
+
+#include <aws/common/atomics.h>
+
+/* Latency samples kept per run. Once full, every other sample is dropped and recording continues at half the rate. */
+#define BENCHMARK_MAX_LATENCY_SAMPLES (1024 * 1024)
+
+/* Writes a writer keeps outstanding on its channel at once. */
+#define BENCHMARK_WRITES_IN_FLIGHT 16
+
+struct benchmark_config {
+    uint64_t duration_ns;
+    /* only benchmarks whose name contains this run, NULL runs everything */
+    const char *filter;
+    /* directory holding unittests.crt and unittests.key for the TLS benchmarks */
+    const char *resources_dir;
+};
+
+/* What one run of one benchmark measured. */
+struct benchmark_result {
+    struct aws_allocator *allocator;
+    uint64_t operations;
+    uint64_t bytes;
+    uint64_t elapsed_ns;
+    uint64_t *latency_samples_ns;
+    size_t latency_sample_count;
+    /* record one latency out of this many, doubling whenever the sample buffer fills up */
+    size_t latency_sample_stride;
+    size_t latency_samples_to_skip;
+};
+
+int benchmark_result_init(struct benchmark_result *result, struct aws_allocator *allocator);
+void benchmark_result_clean_up(struct benchmark_result *result);
+void benchmark_result_record_latency(struct benchmark_result *result, uint64_t latency_ns);
+
+/**
+ * Prints result as one line of JSON on stdout: name, operations, bytes, elapsed_ns, ops_per_sec, bytes_per_sec,
+ * p50_ns and p99_ns. Sorts the latency samples.
+ */
+void benchmark_report(const char *name, struct benchmark_result *result);
+
+bool benchmark_should_run(const struct benchmark_config *config, const char *name);
+
+uint64_t benchmark_now_ns(void);
+
+/*
+ * Channel handlers shared by the benchmarks.
+ */
+
+/* Hands every message on to the next slot, in either direction. */
+struct aws_channel_handler *benchmark_pass_through_handler_new(struct aws_allocator *allocator);
+
+/* Like the pass-through handler, but declared as one by leaving its process functions NULL. */
+struct aws_channel_handler *benchmark_skipped_handler_new(struct aws_allocator *allocator);
+
+/* Counts and frees whatever reaches it, read or write. Never applies back pressure. */
+struct aws_channel_handler *benchmark_sink_handler_new(struct aws_allocator *allocator, struct aws_atomic_var *bytes);
+
+/*
+ * Keeps BENCHMARK_WRITES_IN_FLIGHT full size application data messages written on a channel until stopped. A
+ * write's latency is from sending the message to its completion callback.
+ */
+struct benchmark_writer {
+    struct aws_channel_slot *slot;
+    struct aws_channel_task start_task;
+    struct aws_channel_task stop_task;
+    struct benchmark_result *result;
+    /* completions come back in the order the writes went out, so these are rings indexed by the write's number */
+    uint64_t sent_ns[BENCHMARK_WRITES_IN_FLIGHT];
+    size_t sent_bytes[BENCHMARK_WRITES_IN_FLIGHT];
+    uint64_t sent_count;
+    uint64_t completed_count;
+    uint64_t start_ns;
+    bool filling;
+    bool stopping;
+    int error_code;
+    struct aws_atomic_var stopped;
+};
+
+/* Installs the writer's handler in a new slot at the end of channel. Call on the channel's thread. */
+int benchmark_writer_install(
+    struct benchmark_writer *writer,
+    struct aws_allocator *allocator,
+    struct aws_channel *channel,
+    struct benchmark_result *result);
+
+/* Both may be called from any thread. Once writes are drained after a stop, writer->stopped is set. */
+void benchmark_writer_start(struct benchmark_writer *writer);
+void benchmark_writer_stop(struct benchmark_writer *writer);
+
+/*
+ * The benchmarks. Each runs its variants that pass the filter and reports them.
+ */
+typedef int(benchmark_fn)(struct aws_allocator *allocator, const struct benchmark_config *config);
+
+int benchmark_message_pool(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_channel_pass_through(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_channel_idle_footprint(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_socket_loopback(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_tls(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_cross_thread_tasks(struct aws_allocator *allocator, const struct benchmark_config *config);
+int benchmark_server_scaling(struct aws_allocator *allocator, const struct benchmark_config *config);
+
+#endif /* AWS_IO_BENCHMARK_H */
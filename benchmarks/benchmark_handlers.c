@@ -0,0 +1,325 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/common/math.h>
+
+static int s_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_handler_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_handler_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler *s_handler_new(
+    struct aws_allocator *allocator,
+    struct aws_channel_handler_vtable *vtable,
+    void *impl) {
+
+    struct aws_channel_handler *handler = aws_mem_calloc(allocator, 1, sizeof(struct aws_channel_handler));
+    if (!handler) {
+        return NULL;
+    }
+
+    handler->vtable = vtable;
+    handler->alloc = allocator;
+    handler->impl = impl;
+    return handler;
+}
+
+/*
+ * pass-through handler
+ */
+static int s_pass_through_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_pass_through_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+}
+
+static int s_pass_through_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static struct aws_channel_handler_vtable s_pass_through_vtable = {
+    .process_read_message = s_pass_through_process_read_message,
+    .process_write_message = s_pass_through_process_write_message,
+    .increment_read_window = s_pass_through_increment_read_window,
+    .shutdown = s_handler_shutdown,
+    .initial_window_size = s_handler_initial_window_size,
+    .message_overhead = s_handler_message_overhead,
+    .destroy = s_handler_destroy,
+};
+
+struct aws_channel_handler *benchmark_pass_through_handler_new(struct aws_allocator *allocator) {
+    return s_handler_new(allocator, &s_pass_through_vtable, NULL);
+}
+
+/* no process functions, aws_channel_slot_send_message() routes around it */
+static struct aws_channel_handler_vtable s_skipped_vtable = {
+    .increment_read_window = s_pass_through_increment_read_window,
+    .shutdown = s_handler_shutdown,
+    .initial_window_size = s_handler_initial_window_size,
+    .message_overhead = s_handler_message_overhead,
+    .destroy = s_handler_destroy,
+};
+
+struct aws_channel_handler *benchmark_skipped_handler_new(struct aws_allocator *allocator) {
+    return s_handler_new(allocator, &s_skipped_vtable, NULL);
+}
+
+/*
+ * sink handler
+ */
+static int s_sink_process_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+
+    struct aws_atomic_var *bytes = handler->impl;
+    aws_atomic_fetch_add(bytes, message->message_data.len);
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_sink_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+    (void)slot;
+    (void)size;
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_channel_handler_vtable s_sink_vtable = {
+    .process_read_message = s_sink_process_message,
+    .process_write_message = s_sink_process_message,
+    .increment_read_window = s_sink_increment_read_window,
+    .shutdown = s_handler_shutdown,
+    .initial_window_size = s_handler_initial_window_size,
+    .message_overhead = s_handler_message_overhead,
+    .destroy = s_handler_destroy,
+};
+
+struct aws_channel_handler *benchmark_sink_handler_new(struct aws_allocator *allocator, struct aws_atomic_var *bytes) {
+    return s_handler_new(allocator, &s_sink_vtable, bytes);
+}
+
+/*
+ * writer
+ */
+static void s_writer_check_stopped(struct benchmark_writer *writer) {
+    if (writer->stopping && writer->completed_count == writer->sent_count) {
+        aws_atomic_store_int(&writer->stopped, 1);
+    }
+}
+
+static void s_writer_fill(struct benchmark_writer *writer);
+
+static void s_writer_on_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+
+    struct benchmark_writer *writer = user_data;
+    uint64_t now = benchmark_now_ns();
+    size_t index = writer->completed_count % BENCHMARK_WRITES_IN_FLIGHT;
+    ++writer->completed_count;
+
+    if (err_code) {
+        if (!writer->stopping) {
+            writer->error_code = err_code;
+        }
+        writer->stopping = true;
+    } else if (!writer->stopping) {
+        writer->result->operations++;
+        writer->result->bytes += writer->sent_bytes[index];
+        writer->result->elapsed_ns = now - writer->start_ns;
+        benchmark_result_record_latency(writer->result, now - writer->sent_ns[index]);
+    }
+
+    s_writer_check_stopped(writer);
+    s_writer_fill(writer);
+}
+
+static void s_writer_fill(struct benchmark_writer *writer) {
+    /* completions can come back from inside the send; the loop below picks up the room they free */
+    if (writer->filling) {
+        return;
+    }
+    writer->filling = true;
+
+    struct aws_channel *channel = writer->slot->channel;
+    size_t overhead = aws_channel_slot_upstream_message_overhead(writer->slot);
+    size_t message_size = g_aws_channel_max_fragment_size > overhead ? g_aws_channel_max_fragment_size - overhead : 1;
+
+    while (!writer->stopping && writer->sent_count - writer->completed_count < BENCHMARK_WRITES_IN_FLIGHT) {
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(channel, AWS_IO_MESSAGE_APPLICATION_DATA, message_size);
+        if (!message) {
+            writer->error_code = aws_last_error();
+            writer->stopping = true;
+            break;
+        }
+
+        message->message_data.len = aws_min_size(message_size, message->message_data.capacity);
+        message->on_completion = s_writer_on_write_completed;
+        message->user_data = writer;
+
+        size_t index = writer->sent_count % BENCHMARK_WRITES_IN_FLIGHT;
+        writer->sent_ns[index] = benchmark_now_ns();
+        writer->sent_bytes[index] = message->message_data.len;
+        ++writer->sent_count;
+
+        if (aws_channel_slot_send_message(writer->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            --writer->sent_count;
+            writer->error_code = aws_last_error();
+            writer->stopping = true;
+            aws_mem_release(message->allocator, message);
+            break;
+        }
+    }
+
+    writer->filling = false;
+    s_writer_check_stopped(writer);
+}
+
+static void s_writer_start_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct benchmark_writer *writer = arg;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        writer->stopping = true;
+        s_writer_check_stopped(writer);
+        return;
+    }
+
+    writer->start_ns = benchmark_now_ns();
+    s_writer_fill(writer);
+}
+
+static void s_writer_stop_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct benchmark_writer *writer = arg;
+
+    writer->stopping = true;
+    s_writer_check_stopped(writer);
+}
+
+static int s_writer_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+
+    aws_mem_release(message->allocator, message);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_writer_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+
+    /* the writer is always the last slot, nothing writes into it */
+    AWS_ASSERT(0);
+    return aws_raise_error(AWS_ERROR_INVALID_STATE);
+}
+
+static struct aws_channel_handler_vtable s_writer_vtable = {
+    .process_read_message = s_writer_process_read_message,
+    .process_write_message = s_writer_process_write_message,
+    .increment_read_window = s_sink_increment_read_window,
+    .shutdown = s_handler_shutdown,
+    .initial_window_size = s_handler_initial_window_size,
+    .message_overhead = s_handler_message_overhead,
+    .destroy = s_handler_destroy,
+};
+
+int benchmark_writer_install(
+    struct benchmark_writer *writer,
+    struct aws_allocator *allocator,
+    struct aws_channel *channel,
+    struct benchmark_result *result) {
+
+    AWS_ZERO_STRUCT(*writer);
+    writer->result = result;
+    aws_atomic_init_int(&writer->stopped, 0);
+    aws_channel_task_init(&writer->start_task, s_writer_start_task, writer, "benchmark_writer_start");
+    aws_channel_task_init(&writer->stop_task, s_writer_stop_task, writer, "benchmark_writer_stop");
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(channel);
+    if (!slot || aws_channel_slot_insert_end(channel, slot)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *handler = s_handler_new(allocator, &s_writer_vtable, writer);
+    if (!handler) {
+        aws_channel_slot_remove(slot);
+        return AWS_OP_ERR;
+    }
+
+    if (aws_channel_slot_set_handler(slot, handler)) {
+        s_handler_destroy(handler);
+        aws_channel_slot_remove(slot);
+        return AWS_OP_ERR;
+    }
+
+    writer->slot = slot;
+    return AWS_OP_SUCCESS;
+}
+
+void benchmark_writer_start(struct benchmark_writer *writer) {
+    aws_channel_schedule_task_now(writer->slot->channel, &writer->start_task);
+}
+
+void benchmark_writer_stop(struct benchmark_writer *writer) {
+    aws_channel_schedule_task_now(writer->slot->channel, &writer->stop_task);
+}
@@ -0,0 +1,429 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/io/event_loop.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+
+#define CHANNEL_BENCHMARK_MESSAGE_SIZE 1024
+
+struct channel_benchmark {
+    struct aws_allocator *allocator;
+    const struct benchmark_config *config;
+    size_t handler_count;
+    /* build the middle handlers with NULL process functions so the channel skips them */
+    bool skip_handlers;
+    struct aws_channel *channel;
+    struct aws_channel_task run_task;
+    struct benchmark_result result;
+    struct aws_atomic_var sink_bytes;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    int error_code;
+    bool setup_completed;
+    bool run_completed;
+    bool shutdown_completed;
+};
+
+static void s_signal(struct channel_benchmark *benchmark, bool *flag, int error_code) {
+    aws_mutex_lock(&benchmark->mutex);
+    *flag = true;
+    if (error_code && !benchmark->error_code) {
+        benchmark->error_code = error_code;
+    }
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static bool s_setup_completed_pred(void *arg) {
+    struct channel_benchmark *benchmark = arg;
+    return benchmark->setup_completed;
+}
+
+static bool s_run_completed_pred(void *arg) {
+    struct channel_benchmark *benchmark = arg;
+    return benchmark->run_completed;
+}
+
+static bool s_shutdown_completed_pred(void *arg) {
+    struct channel_benchmark *benchmark = arg;
+    return benchmark->shutdown_completed;
+}
+
+static void s_on_setup_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    struct channel_benchmark *benchmark = user_data;
+    s_signal(benchmark, &benchmark->setup_completed, error_code);
+}
+
+static void s_on_shutdown_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct channel_benchmark *benchmark = user_data;
+    s_signal(benchmark, &benchmark->shutdown_completed, AWS_OP_SUCCESS);
+}
+
+static int s_add_slot(
+    struct aws_channel *channel,
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot **slot) {
+
+    if (!handler) {
+        return AWS_OP_ERR;
+    }
+
+    *slot = aws_channel_slot_new(channel);
+    if (!*slot) {
+        handler->vtable->destroy(handler);
+        return AWS_OP_ERR;
+    }
+
+    aws_channel_slot_insert_end(channel, *slot);
+    return aws_channel_slot_set_handler(*slot, handler);
+}
+
+/* Builds sink <- N pass-through handlers <- driver, then pushes messages in from the driver for the whole run. */
+static void s_run_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct channel_benchmark *benchmark = arg;
+    struct aws_channel *channel = benchmark->channel;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        s_signal(benchmark, &benchmark->run_completed, AWS_ERROR_IO_OPERATION_CANCELLED);
+        return;
+    }
+
+    struct aws_channel_slot *slot = NULL;
+    if (s_add_slot(channel, benchmark_sink_handler_new(benchmark->allocator, &benchmark->sink_bytes), &slot)) {
+        goto error;
+    }
+
+    for (size_t i = 0; i < benchmark->handler_count; ++i) {
+        struct aws_channel_handler *handler = benchmark->skip_handlers
+                                                  ? benchmark_skipped_handler_new(benchmark->allocator)
+                                                  : benchmark_pass_through_handler_new(benchmark->allocator);
+        if (s_add_slot(channel, handler, &slot)) {
+            goto error;
+        }
+    }
+
+    /* the driver slot is one more pass-through handler, only ever used to send from */
+    if (s_add_slot(channel, benchmark_pass_through_handler_new(benchmark->allocator), &slot)) {
+        goto error;
+    }
+
+    struct benchmark_result *result = &benchmark->result;
+    uint64_t start_ns = benchmark_now_ns();
+    uint64_t end_ns = start_ns + benchmark->config->duration_ns;
+    uint64_t now_ns = start_ns;
+    while (now_ns < end_ns) {
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            channel, AWS_IO_MESSAGE_APPLICATION_DATA, CHANNEL_BENCHMARK_MESSAGE_SIZE);
+        if (!message) {
+            goto error;
+        }
+        message->message_data.len = CHANNEL_BENCHMARK_MESSAGE_SIZE;
+
+        uint64_t op_start_ns = benchmark_now_ns();
+        if (aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            aws_mem_release(message->allocator, message);
+            goto error;
+        }
+        now_ns = benchmark_now_ns();
+
+        benchmark_result_record_latency(result, now_ns - op_start_ns);
+        ++result->operations;
+        result->bytes += CHANNEL_BENCHMARK_MESSAGE_SIZE;
+    }
+    result->elapsed_ns = now_ns - start_ns;
+
+    s_signal(benchmark, &benchmark->run_completed, AWS_OP_SUCCESS);
+    return;
+
+error:
+    s_signal(benchmark, &benchmark->run_completed, aws_last_error());
+}
+
+static int s_run_variant(
+    struct aws_allocator *allocator,
+    const struct benchmark_config *config,
+    const char *name,
+    size_t handler_count,
+    bool skip_handlers) {
+
+    struct channel_benchmark benchmark = {
+        .allocator = allocator,
+        .config = config,
+        .handler_count = handler_count,
+        .skip_handlers = skip_handlers,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    aws_atomic_init_int(&benchmark.sink_bytes, 0);
+    if (benchmark_result_init(&benchmark.result, allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    if (!el_group) {
+        goto done;
+    }
+
+    struct aws_channel_options channel_options = {
+        .event_loop = aws_event_loop_group_get_next_loop(el_group),
+        .on_setup_completed = s_on_setup_completed,
+        .on_shutdown_completed = s_on_shutdown_completed,
+        .setup_user_data = &benchmark,
+        .shutdown_user_data = &benchmark,
+    };
+    benchmark.channel = aws_channel_new(allocator, &channel_options);
+    if (!benchmark.channel) {
+        goto done;
+    }
+
+    aws_mutex_lock(&benchmark.mutex);
+    aws_condition_variable_wait_pred(
+        &benchmark.condition_variable, &benchmark.mutex, s_setup_completed_pred, &benchmark);
+    aws_mutex_unlock(&benchmark.mutex);
+
+    if (!benchmark.error_code) {
+        aws_channel_task_init(&benchmark.run_task, s_run_task, &benchmark, "benchmark_channel_pass_through");
+        aws_channel_schedule_task_now(benchmark.channel, &benchmark.run_task);
+
+        aws_mutex_lock(&benchmark.mutex);
+        aws_condition_variable_wait_pred(
+            &benchmark.condition_variable, &benchmark.mutex, s_run_completed_pred, &benchmark);
+        aws_mutex_unlock(&benchmark.mutex);
+    }
+
+    aws_channel_shutdown(benchmark.channel, AWS_OP_SUCCESS);
+    aws_mutex_lock(&benchmark.mutex);
+    aws_condition_variable_wait_pred(
+        &benchmark.condition_variable, &benchmark.mutex, s_shutdown_completed_pred, &benchmark);
+    aws_mutex_unlock(&benchmark.mutex);
+    aws_channel_destroy(benchmark.channel);
+
+    if (benchmark.error_code) {
+        aws_raise_error(benchmark.error_code);
+        goto done;
+    }
+
+    benchmark_report(name, &benchmark.result);
+    result = AWS_OP_SUCCESS;
+
+done:
+    aws_event_loop_group_release(el_group);
+    benchmark_result_clean_up(&benchmark.result);
+    return result;
+}
+
+/* One operation is a message sent from the top of the channel until the bottom handler has freed it. */
+int benchmark_channel_pass_through(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    static const size_t s_handler_counts[] = {1, 4, 16};
+
+    for (size_t skip = 0; skip < 2; ++skip) {
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(s_handler_counts); ++i) {
+            char name[64];
+            snprintf(
+                name,
+                sizeof(name),
+                "channel_slot_send_message/%s=%zu",
+                skip ? "skipped_handlers" : "handlers",
+                s_handler_counts[i]);
+            if (!benchmark_should_run(config, name)) {
+                continue;
+            }
+
+            if (s_run_variant(allocator, config, name, s_handler_counts[i], skip != 0)) {
+                return AWS_OP_ERR;
+            }
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * idle footprint: what an idle channel with a few handlers costs in heap, counted by a tracing allocator
+ */
+#define IDLE_FOOTPRINT_CHANNEL_COUNT 10000
+
+struct idle_footprint_benchmark {
+    /* what the setup callback allocates handlers with, the tracer once the warm-up channel is up */
+    struct aws_allocator *handler_allocator;
+    size_t handler_count;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t setups_completed;
+    size_t shutdowns_completed;
+    size_t expected;
+    int error_code;
+};
+
+static bool s_idle_footprint_setups_pred(void *arg) {
+    struct idle_footprint_benchmark *benchmark = arg;
+    return benchmark->setups_completed == benchmark->expected;
+}
+
+static bool s_idle_footprint_shutdowns_pred(void *arg) {
+    struct idle_footprint_benchmark *benchmark = arg;
+    return benchmark->shutdowns_completed == benchmark->expected;
+}
+
+static void s_idle_footprint_on_setup_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    struct idle_footprint_benchmark *benchmark = user_data;
+
+    /* stands in for socket, TLS and application handlers */
+    for (size_t i = 0; !error_code && i < benchmark->handler_count; ++i) {
+        struct aws_channel_slot *slot = NULL;
+        if (s_add_slot(channel, benchmark_pass_through_handler_new(benchmark->handler_allocator), &slot)) {
+            error_code = aws_last_error();
+        }
+    }
+
+    aws_mutex_lock(&benchmark->mutex);
+    ++benchmark->setups_completed;
+    if (error_code && !benchmark->error_code) {
+        benchmark->error_code = error_code;
+    }
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static void s_idle_footprint_on_shutdown_completed(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+    (void)error_code;
+    struct idle_footprint_benchmark *benchmark = user_data;
+
+    aws_mutex_lock(&benchmark->mutex);
+    ++benchmark->shutdowns_completed;
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static void s_idle_footprint_wait(struct idle_footprint_benchmark *benchmark, aws_condition_predicate_fn *pred) {
+    aws_mutex_lock(&benchmark->mutex);
+    aws_condition_variable_wait_pred(&benchmark->condition_variable, &benchmark->mutex, pred, benchmark);
+    aws_mutex_unlock(&benchmark->mutex);
+}
+
+static int s_run_idle_footprint_variant(struct aws_allocator *allocator, const char *name, size_t handler_count) {
+    struct idle_footprint_benchmark benchmark = {
+        .handler_allocator = allocator,
+        .handler_count = handler_count,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .expected = 1,
+    };
+
+    int result = AWS_OP_ERR;
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_channel **channels =
+        aws_mem_calloc(allocator, IDLE_FOOTPRINT_CHANNEL_COUNT, sizeof(struct aws_channel *));
+    struct aws_allocator *traced_allocator = aws_mem_tracer_new(allocator, NULL, AWS_MEMTRACE_BYTES, 0);
+    if (!el_group || !channels || !traced_allocator) {
+        goto done;
+    }
+
+    struct aws_channel_options channel_options = {
+        .event_loop = aws_event_loop_group_get_next_loop(el_group),
+        .on_setup_completed = s_idle_footprint_on_setup_completed,
+        .on_shutdown_completed = s_idle_footprint_on_shutdown_completed,
+        .setup_user_data = &benchmark,
+        .shutdown_user_data = &benchmark,
+    };
+
+    /* the first channel on a loop creates the loop's message pool, which isn't a per-channel cost */
+    struct aws_channel *warm_up = aws_channel_new(allocator, &channel_options);
+    if (!warm_up) {
+        goto done;
+    }
+    s_idle_footprint_wait(&benchmark, s_idle_footprint_setups_pred);
+
+    size_t created = 0;
+    aws_mutex_lock(&benchmark.mutex);
+    benchmark.handler_allocator = traced_allocator;
+    benchmark.expected = 1 + IDLE_FOOTPRINT_CHANNEL_COUNT;
+    aws_mutex_unlock(&benchmark.mutex);
+    for (; created < IDLE_FOOTPRINT_CHANNEL_COUNT; ++created) {
+        channels[created] = aws_channel_new(traced_allocator, &channel_options);
+        if (!channels[created]) {
+            break;
+        }
+    }
+
+    aws_mutex_lock(&benchmark.mutex);
+    benchmark.expected = 1 + created;
+    aws_mutex_unlock(&benchmark.mutex);
+    s_idle_footprint_wait(&benchmark, s_idle_footprint_setups_pred);
+
+    size_t bytes = aws_mem_tracer_bytes(traced_allocator);
+    size_t allocations = aws_mem_tracer_count(traced_allocator);
+    if (created == IDLE_FOOTPRINT_CHANNEL_COUNT && !benchmark.error_code) {
+        printf(
+            "{\"name\":\"%s\",\"channels\":%zu,\"bytes_per_channel\":%.1f,\"allocations_per_channel\":%.2f}\n",
+            name,
+            created,
+            (double)bytes / (double)created,
+            (double)allocations / (double)created);
+        fflush(stdout);
+        result = AWS_OP_SUCCESS;
+    } else if (benchmark.error_code) {
+        aws_raise_error(benchmark.error_code);
+    }
+
+    aws_channel_shutdown(warm_up, AWS_OP_SUCCESS);
+    for (size_t i = 0; i < created; ++i) {
+        aws_channel_shutdown(channels[i], AWS_OP_SUCCESS);
+    }
+    s_idle_footprint_wait(&benchmark, s_idle_footprint_shutdowns_pred);
+
+    aws_channel_destroy(warm_up);
+    for (size_t i = 0; i < created; ++i) {
+        aws_channel_destroy(channels[i]);
+    }
+
+    /* channels are freed by a task on their loop, the tracer has to outlive them */
+    while (aws_mem_tracer_bytes(traced_allocator) > 0) {
+        aws_thread_current_sleep(aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    }
+
+done:
+    if (traced_allocator) {
+        aws_mem_tracer_destroy(traced_allocator);
+    }
+    if (channels) {
+        aws_mem_release(allocator, channels);
+    }
+    aws_event_loop_group_release(el_group);
+    return result;
+}
+
+/* Heap bytes and allocations per idle channel, on top of what the event loop's shared message pool costs. */
+int benchmark_channel_idle_footprint(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    static const size_t s_handler_counts[] = {1, 3};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_handler_counts); ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "channel_idle_footprint/handlers=%zu", s_handler_counts[i]);
+        if (!benchmark_should_run(config, name)) {
+            continue;
+        }
+
+        if (s_run_idle_footprint_variant(allocator, name, s_handler_counts[i])) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
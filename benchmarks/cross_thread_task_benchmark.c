@@ -0,0 +1,175 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/io/event_loop.h>
+
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+
+/* Tasks each producer cycles through. A task is rescheduled only after the loop has run it. */
+#define CROSS_THREAD_TASKS_PER_PRODUCER 1024
+
+struct cross_thread_benchmark;
+
+struct cross_thread_task {
+    struct aws_task task;
+    struct cross_thread_benchmark *benchmark;
+    uint64_t scheduled_ns;
+    struct aws_atomic_var in_flight;
+};
+
+struct cross_thread_producer {
+    struct cross_thread_benchmark *benchmark;
+    struct aws_thread thread;
+    struct cross_thread_task tasks[CROSS_THREAD_TASKS_PER_PRODUCER];
+};
+
+struct cross_thread_benchmark {
+    struct aws_event_loop *event_loop;
+    uint64_t start_ns;
+    struct aws_atomic_var stop;
+    /* only touched on the event loop's thread until every task has drained */
+    struct benchmark_result result;
+};
+
+static void s_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct cross_thread_task *cross_thread_task = arg;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        struct benchmark_result *result = &cross_thread_task->benchmark->result;
+        uint64_t now_ns = benchmark_now_ns();
+        benchmark_result_record_latency(result, now_ns - cross_thread_task->scheduled_ns);
+        ++result->operations;
+        result->elapsed_ns = now_ns - cross_thread_task->benchmark->start_ns;
+    }
+
+    aws_atomic_store_int(&cross_thread_task->in_flight, 0);
+}
+
+static void s_producer_fn(void *arg) {
+    struct cross_thread_producer *producer = arg;
+    struct cross_thread_benchmark *benchmark = producer->benchmark;
+
+    size_t index = 0;
+    while (!aws_atomic_load_int(&benchmark->stop)) {
+        struct cross_thread_task *task = &producer->tasks[index];
+        if (aws_atomic_load_int(&task->in_flight)) {
+            /* the loop is a full ring behind, wait for it */
+            continue;
+        }
+
+        aws_atomic_store_int(&task->in_flight, 1);
+        task->scheduled_ns = benchmark_now_ns();
+        aws_event_loop_schedule_task_now(benchmark->event_loop, &task->task);
+        index = (index + 1) % CROSS_THREAD_TASKS_PER_PRODUCER;
+    }
+}
+
+static bool s_is_drained(struct cross_thread_producer *producers, size_t producer_count) {
+    for (size_t i = 0; i < producer_count; ++i) {
+        for (size_t j = 0; j < CROSS_THREAD_TASKS_PER_PRODUCER; ++j) {
+            if (aws_atomic_load_int(&producers[i].tasks[j].in_flight)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static int s_run_variant(
+    struct aws_allocator *allocator,
+    const struct benchmark_config *config,
+    const char *name,
+    size_t producer_count) {
+
+    struct cross_thread_benchmark benchmark;
+    AWS_ZERO_STRUCT(benchmark);
+    aws_atomic_init_int(&benchmark.stop, 0);
+    if (benchmark_result_init(&benchmark.result, allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    size_t launched_count = 0;
+    struct cross_thread_producer *producers =
+        aws_mem_calloc(allocator, producer_count, sizeof(struct cross_thread_producer));
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    if (!producers || !el_group) {
+        goto done;
+    }
+    benchmark.event_loop = aws_event_loop_group_get_next_loop(el_group);
+
+    for (size_t i = 0; i < producer_count; ++i) {
+        producers[i].benchmark = &benchmark;
+        for (size_t j = 0; j < CROSS_THREAD_TASKS_PER_PRODUCER; ++j) {
+            struct cross_thread_task *task = &producers[i].tasks[j];
+            task->benchmark = &benchmark;
+            aws_atomic_init_int(&task->in_flight, 0);
+            aws_task_init(&task->task, s_task_fn, task, "benchmark_cross_thread_task");
+        }
+    }
+
+    benchmark.start_ns = benchmark_now_ns();
+    for (; launched_count < producer_count; ++launched_count) {
+        struct cross_thread_producer *producer = &producers[launched_count];
+        aws_thread_init(&producer->thread, allocator);
+        if (aws_thread_launch(&producer->thread, s_producer_fn, producer, NULL)) {
+            aws_thread_clean_up(&producer->thread);
+            break;
+        }
+    }
+
+    if (launched_count == producer_count) {
+        aws_thread_current_sleep(config->duration_ns);
+    }
+
+    aws_atomic_store_int(&benchmark.stop, 1);
+    for (size_t i = 0; i < launched_count; ++i) {
+        aws_thread_join(&producers[i].thread);
+        aws_thread_clean_up(&producers[i].thread);
+    }
+
+    /* the tasks live in producers, so every scheduled one has to run before they can go */
+    while (!s_is_drained(producers, launched_count)) {
+        aws_thread_current_sleep(0);
+    }
+
+    if (launched_count == producer_count) {
+        benchmark_report(name, &benchmark.result);
+        result = AWS_OP_SUCCESS;
+    }
+
+done:
+    aws_event_loop_group_release(el_group);
+    if (producers) {
+        aws_mem_release(allocator, producers);
+    }
+    benchmark_result_clean_up(&benchmark.result);
+    return result;
+}
+
+/* One operation is a task scheduled from another thread, from aws_event_loop_schedule_task_now until it runs. */
+int benchmark_cross_thread_tasks(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    static const size_t s_producer_counts[] = {1, 4};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_producer_counts); ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "cross_thread_task_schedule/producers=%zu", s_producer_counts[i]);
+        if (!benchmark_should_run(config, name)) {
+            continue;
+        }
+
+        if (s_run_variant(allocator, config, name, s_producer_counts[i])) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
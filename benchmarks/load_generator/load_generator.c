@@ -0,0 +1,1153 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* for RUSAGE_THREAD */
+#    define _GNU_SOURCE
+#endif
+
+#include <aws/io/channel.h>
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define LOAD_GENERATOR_HOST "127.0.0.1"
+
+/* One loopback client address has ~28k ephemeral ports on a default Linux; stay well under that per listener port. */
+#define LOAD_GENERATOR_CONNECTIONS_PER_LISTENER 20000
+
+enum load_pattern {
+    /* connect and hold: memory and CPU per idle connection */
+    LOAD_PATTERN_IDLE,
+    /* every client keeps writes_in_flight messages written, the server discards them */
+    LOAD_PATTERN_STREAM,
+    /* every client writes one message and waits for the server to echo it back before writing the next */
+    LOAD_PATTERN_PING_PONG,
+};
+
+struct load_generator_config {
+    size_t connections;
+    /* event loops on each side, 0 for one per processor */
+    size_t loops;
+    size_t listeners;
+    uint16_t port;
+    size_t max_pending_connects;
+    bool use_tls;
+    bool listener_per_loop;
+    enum load_pattern pattern;
+    size_t message_size;
+    size_t writes_in_flight;
+    uint64_t duration_ns;
+    const char *resources_dir;
+};
+
+struct load_generator;
+
+/* One client channel. Only touched on its channel's thread once the channel is up. */
+struct load_connection {
+    struct load_generator *generator;
+    struct aws_channel *channel;
+    struct aws_channel_slot *slot;
+    struct aws_channel_task start_task;
+    size_t writes_in_flight;
+    size_t reply_bytes;
+    uint64_t bytes_written;
+    uint64_t bytes_read;
+    uint64_t round_trips;
+    bool filling;
+};
+
+/* One accepted channel's handler state. */
+struct load_server_connection {
+    struct load_generator *generator;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+};
+
+struct load_generator {
+    struct aws_allocator *allocator;
+    struct load_generator_config config;
+
+    struct aws_event_loop_group *server_el_group;
+    struct aws_event_loop_group *client_el_group;
+    struct aws_host_resolver *resolver;
+    struct aws_server_bootstrap *server_bootstrap;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct aws_socket_options socket_options;
+    struct aws_socket **listeners;
+
+    struct aws_tls_ctx_options server_ctx_options;
+    struct aws_tls_ctx_options client_ctx_options;
+    struct aws_tls_ctx *server_ctx;
+    struct aws_tls_ctx *client_ctx;
+    struct aws_tls_connection_options server_tls_options;
+    struct aws_tls_connection_options client_tls_options;
+
+    struct load_connection *connections;
+    struct aws_atomic_var next_connection;
+    struct aws_atomic_var running;
+
+    /* updated from the event loops */
+    struct aws_atomic_var accepted;
+    struct aws_atomic_var last_accept_ns;
+    struct aws_atomic_var client_bytes_written;
+    struct aws_atomic_var client_bytes_read;
+    struct aws_atomic_var server_bytes_written;
+    struct aws_atomic_var server_bytes_read;
+    struct aws_atomic_var round_trips;
+
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    /* everything below is guarded by mutex */
+    size_t connects_finished;
+    size_t connect_failures;
+    int first_connect_error;
+    uint64_t last_connect_ns;
+    size_t channels_opened;
+    size_t channels_closed;
+    size_t listeners_destroyed;
+    size_t cpu_samples_taken;
+};
+
+static uint64_t s_now_ns(void) {
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+static void s_unlock_and_notify(struct load_generator *generator) {
+    aws_mutex_unlock(&generator->mutex);
+    aws_condition_variable_notify_all(&generator->condition_variable);
+}
+
+/*
+ * process and thread resource usage
+ */
+
+/* Resident set size, or 0 where it can't be read. */
+static uint64_t s_rss_bytes(void) {
+#if defined(__linux__)
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm) {
+        return 0;
+    }
+
+    unsigned long long size_pages = 0;
+    unsigned long long resident_pages = 0;
+    int fields = fscanf(statm, "%llu %llu", &size_pages, &resident_pages);
+    fclose(statm);
+
+    return fields == 2 ? resident_pages * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+/* CPU time, user and system, the calling thread has used, or UINT64_MAX where it can't be read. */
+static uint64_t s_thread_cpu_ns(void) {
+#if defined(RUSAGE_THREAD)
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage)) {
+        return UINT64_MAX;
+    }
+
+    uint64_t user_us = (uint64_t)usage.ru_utime.tv_sec * 1000000 + (uint64_t)usage.ru_utime.tv_usec;
+    uint64_t system_us = (uint64_t)usage.ru_stime.tv_sec * 1000000 + (uint64_t)usage.ru_stime.tv_usec;
+    return (user_us + system_us) * 1000;
+#else
+    return UINT64_MAX;
+#endif
+}
+
+/* 100k channels take 200k descriptors between both ends of the loopback. */
+static void s_raise_fd_limit(size_t connections) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit)) {
+        return;
+    }
+
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < connections * 2 + 128) {
+        fprintf(
+            stderr,
+            "warning: RLIMIT_NOFILE is %llu, %zu connections need about %zu descriptors\n",
+            (unsigned long long)limit.rlim_cur,
+            connections,
+            connections * 2 + 128);
+    }
+}
+
+struct loop_cpu_sample {
+    struct aws_task task;
+    struct load_generator *generator;
+    uint64_t cpu_ns;
+};
+
+static void s_sample_cpu_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct loop_cpu_sample *sample = arg;
+    sample->cpu_ns = s_thread_cpu_ns();
+
+    aws_mutex_lock(&sample->generator->mutex);
+    ++sample->generator->cpu_samples_taken;
+    s_unlock_and_notify(sample->generator);
+}
+
+struct loop_cpu_samples_pred_args {
+    struct load_generator *generator;
+    size_t count;
+};
+
+static bool s_cpu_samples_taken_pred(void *arg) {
+    struct loop_cpu_samples_pred_args *args = arg;
+    return args->generator->cpu_samples_taken == args->count;
+}
+
+/* Reads the CPU time of every loop in both groups, client loops first, from the loops' own threads. */
+static void s_sample_loops(struct load_generator *generator, struct loop_cpu_sample *samples, size_t count) {
+    size_t client_loop_count = aws_event_loop_group_get_loop_count(generator->client_el_group);
+
+    aws_mutex_lock(&generator->mutex);
+    generator->cpu_samples_taken = 0;
+    aws_mutex_unlock(&generator->mutex);
+
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_event_loop *loop =
+            i < client_loop_count
+                ? aws_event_loop_group_get_loop_at(generator->client_el_group, i)
+                : aws_event_loop_group_get_loop_at(generator->server_el_group, i - client_loop_count);
+
+        samples[i].generator = generator;
+        aws_task_init(&samples[i].task, s_sample_cpu_task, &samples[i], "load_generator_sample_cpu");
+        aws_event_loop_schedule_task_now(loop, &samples[i].task);
+    }
+
+    struct loop_cpu_samples_pred_args pred_args = {.generator = generator, .count = count};
+    aws_mutex_lock(&generator->mutex);
+    aws_condition_variable_wait_pred(
+        &generator->condition_variable, &generator->mutex, s_cpu_samples_taken_pred, &pred_args);
+    aws_mutex_unlock(&generator->mutex);
+}
+
+/*
+ * handlers shared by both ends
+ */
+static size_t s_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return SIZE_MAX;
+}
+
+static size_t s_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static int s_increment_read_window(struct aws_channel_handler *handler, struct aws_channel_slot *slot, size_t size) {
+    (void)handler;
+    (void)slot;
+    (void)size;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    (void)slot;
+    (void)message;
+
+    /* both handlers are the last slot of their channel, nothing writes into them */
+    AWS_ASSERT(0);
+    return aws_raise_error(AWS_ERROR_INVALID_STATE);
+}
+
+static int s_install_handler(
+    struct aws_allocator *allocator,
+    struct aws_channel *channel,
+    struct aws_channel_handler_vtable *vtable,
+    void *impl,
+    struct aws_channel_slot **out_slot) {
+
+    struct aws_channel_slot *slot = aws_channel_slot_new(channel);
+    if (!slot || aws_channel_slot_insert_end(channel, slot)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *handler = aws_mem_calloc(allocator, 1, sizeof(struct aws_channel_handler));
+    if (!handler) {
+        aws_channel_slot_remove(slot);
+        return AWS_OP_ERR;
+    }
+    handler->vtable = vtable;
+    handler->alloc = allocator;
+    handler->impl = impl;
+
+    if (aws_channel_slot_set_handler(slot, handler)) {
+        aws_mem_release(allocator, handler);
+        aws_channel_slot_remove(slot);
+        return AWS_OP_ERR;
+    }
+
+    if (out_slot) {
+        *out_slot = slot;
+    }
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * client handler
+ */
+static void s_client_fill(struct load_connection *connection);
+
+static void s_client_on_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+    (void)err_code;
+
+    struct load_connection *connection = user_data;
+    --connection->writes_in_flight;
+    s_client_fill(connection);
+}
+
+/* Writes size bytes, in as many messages as the channel's message pool needs. */
+static int s_client_write(struct load_connection *connection, size_t size) {
+    struct load_generator *generator = connection->generator;
+
+    while (size > 0) {
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(connection->channel, AWS_IO_MESSAGE_APPLICATION_DATA, size);
+        if (!message) {
+            return AWS_OP_ERR;
+        }
+
+        message->message_data.len = aws_min_size(size, message->message_data.capacity);
+        if (generator->config.pattern == LOAD_PATTERN_STREAM) {
+            message->on_completion = s_client_on_write_completed;
+            message->user_data = connection;
+            ++connection->writes_in_flight;
+        }
+
+        size_t len = message->message_data.len;
+        if (aws_channel_slot_send_message(connection->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            if (message->on_completion) {
+                --connection->writes_in_flight;
+            }
+            aws_mem_release(message->allocator, message);
+            return AWS_OP_ERR;
+        }
+
+        connection->bytes_written += len;
+        size -= len;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_client_fill(struct load_connection *connection) {
+    struct load_generator *generator = connection->generator;
+
+    /* completions can come back from inside the send; the loop below picks up the room they free */
+    if (connection->filling) {
+        return;
+    }
+    connection->filling = true;
+
+    while (aws_atomic_load_int(&generator->running) &&
+           connection->writes_in_flight < generator->config.writes_in_flight) {
+        if (s_client_write(connection, generator->config.message_size)) {
+            aws_channel_shutdown(connection->channel, aws_last_error());
+            break;
+        }
+    }
+
+    connection->filling = false;
+}
+
+static void s_client_start_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct load_connection *connection = arg;
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    switch (connection->generator->config.pattern) {
+        case LOAD_PATTERN_STREAM:
+            s_client_fill(connection);
+            break;
+        case LOAD_PATTERN_PING_PONG:
+            if (s_client_write(connection, connection->generator->config.message_size)) {
+                aws_channel_shutdown(connection->channel, aws_last_error());
+            }
+            break;
+        case LOAD_PATTERN_IDLE:
+            break;
+    }
+}
+
+static int s_client_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)slot;
+
+    struct load_connection *connection = handler->impl;
+    struct load_generator *generator = connection->generator;
+    size_t len = message->message_data.len;
+    aws_mem_release(message->allocator, message);
+
+    if (!aws_atomic_load_int(&generator->running)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    connection->bytes_read += len;
+    if (generator->config.pattern != LOAD_PATTERN_PING_PONG) {
+        return AWS_OP_SUCCESS;
+    }
+
+    connection->reply_bytes += len;
+    if (connection->reply_bytes < generator->config.message_size) {
+        return AWS_OP_SUCCESS;
+    }
+
+    connection->reply_bytes -= generator->config.message_size;
+    ++connection->round_trips;
+    return s_client_write(connection, generator->config.message_size);
+}
+
+static int s_client_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+
+    struct load_connection *connection = handler->impl;
+    if (dir == AWS_CHANNEL_DIR_WRITE) {
+        struct load_generator *generator = connection->generator;
+        aws_atomic_fetch_add(&generator->client_bytes_written, (size_t)connection->bytes_written);
+        aws_atomic_fetch_add(&generator->client_bytes_read, (size_t)connection->bytes_read);
+        aws_atomic_fetch_add(&generator->round_trips, (size_t)connection->round_trips);
+    }
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static void s_client_destroy(struct aws_channel_handler *handler) {
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler_vtable s_client_vtable = {
+    .process_read_message = s_client_process_read_message,
+    .process_write_message = s_process_write_message,
+    .increment_read_window = s_increment_read_window,
+    .shutdown = s_client_shutdown,
+    .initial_window_size = s_initial_window_size,
+    .message_overhead = s_message_overhead,
+    .destroy = s_client_destroy,
+};
+
+/*
+ * server handler
+ */
+static int s_server_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct load_server_connection *connection = handler->impl;
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(&message->message_data);
+    connection->bytes_read += data.len;
+
+    int result = AWS_OP_SUCCESS;
+    /* echo it back as it came */
+    while (connection->generator->config.pattern == LOAD_PATTERN_PING_PONG && data.len > 0) {
+        struct aws_io_message *echo =
+            aws_channel_acquire_message_from_pool(slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, data.len);
+        if (!echo) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        struct aws_byte_cursor chunk =
+            aws_byte_cursor_advance(&data, aws_min_size(data.len, echo->message_data.capacity));
+        aws_byte_buf_write_from_whole_cursor(&echo->message_data, chunk);
+        if (aws_channel_slot_send_message(slot, echo, AWS_CHANNEL_DIR_WRITE)) {
+            aws_mem_release(echo->allocator, echo);
+            result = AWS_OP_ERR;
+            break;
+        }
+        connection->bytes_written += chunk.len;
+    }
+
+    aws_mem_release(message->allocator, message);
+    return result;
+}
+
+static int s_server_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+
+    struct load_server_connection *connection = handler->impl;
+    if (dir == AWS_CHANNEL_DIR_WRITE) {
+        struct load_generator *generator = connection->generator;
+        aws_atomic_fetch_add(&generator->server_bytes_read, (size_t)connection->bytes_read);
+        aws_atomic_fetch_add(&generator->server_bytes_written, (size_t)connection->bytes_written);
+    }
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static void s_server_destroy(struct aws_channel_handler *handler) {
+    struct load_server_connection *connection = handler->impl;
+    aws_mem_release(handler->alloc, connection);
+    aws_mem_release(handler->alloc, handler);
+}
+
+static struct aws_channel_handler_vtable s_server_vtable = {
+    .process_read_message = s_server_process_read_message,
+    .process_write_message = s_process_write_message,
+    .increment_read_window = s_increment_read_window,
+    .shutdown = s_server_shutdown,
+    .initial_window_size = s_initial_window_size,
+    .message_overhead = s_message_overhead,
+    .destroy = s_server_destroy,
+};
+
+/*
+ * server bootstrap callbacks
+ */
+static void s_server_on_incoming_channel_setup(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct load_generator *generator = user_data;
+
+    if (error_code) {
+        return;
+    }
+
+    struct load_server_connection *connection =
+        aws_mem_calloc(generator->allocator, 1, sizeof(struct load_server_connection));
+    if (!connection) {
+        aws_channel_shutdown(channel, aws_last_error());
+        return;
+    }
+    connection->generator = generator;
+
+    if (s_install_handler(generator->allocator, channel, &s_server_vtable, connection, NULL)) {
+        aws_mem_release(generator->allocator, connection);
+        aws_channel_shutdown(channel, aws_last_error());
+        return;
+    }
+
+    aws_atomic_fetch_add(&generator->accepted, 1);
+    aws_atomic_store_int(&generator->last_accept_ns, (size_t)s_now_ns());
+}
+
+static void s_server_on_incoming_channel_shutdown(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    (void)user_data;
+}
+
+static void s_server_on_listener_destroy(struct aws_server_bootstrap *bootstrap, void *user_data) {
+    (void)bootstrap;
+    struct load_generator *generator = user_data;
+
+    aws_mutex_lock(&generator->mutex);
+    ++generator->listeners_destroyed;
+    s_unlock_and_notify(generator);
+}
+
+/*
+ * client bootstrap callbacks
+ */
+static void s_launch_connects(struct load_generator *generator);
+
+static void s_client_on_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct load_connection *connection = user_data;
+    struct load_generator *generator = connection->generator;
+
+    /* a channel that was set up gets a shutdown callback, even if the handler can't be installed */
+    bool opened = !error_code;
+    if (opened) {
+        aws_channel_task_init(&connection->start_task, s_client_start_task, connection, "load_generator_start");
+        if (s_install_handler(generator->allocator, channel, &s_client_vtable, connection, &connection->slot)) {
+            error_code = aws_last_error();
+            aws_channel_shutdown(channel, error_code);
+        }
+    }
+
+    aws_mutex_lock(&generator->mutex);
+    ++generator->connects_finished;
+    generator->last_connect_ns = s_now_ns();
+    if (opened) {
+        ++generator->channels_opened;
+    }
+    if (!error_code) {
+        connection->channel = channel;
+    }
+    if (error_code) {
+        ++generator->connect_failures;
+        if (!generator->first_connect_error) {
+            generator->first_connect_error = error_code;
+        }
+    }
+    s_unlock_and_notify(generator);
+
+    /* keep max_pending_connects in flight until every connection has been tried */
+    s_launch_connects(generator);
+}
+
+static void s_client_on_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    struct load_connection *connection = user_data;
+    struct load_generator *generator = connection->generator;
+
+    /* the bootstrap destroys the channel once this returns, so nobody may use it past here */
+    aws_mutex_lock(&generator->mutex);
+    connection->channel = NULL;
+    ++generator->channels_closed;
+    s_unlock_and_notify(generator);
+}
+
+/* Starts the next connection, or the next one that can be started. */
+static void s_launch_connects(struct load_generator *generator) {
+    while (true) {
+        size_t index = aws_atomic_fetch_add(&generator->next_connection, 1);
+        if (index >= generator->config.connections) {
+            return;
+        }
+
+        struct load_connection *connection = &generator->connections[index];
+        struct aws_socket_channel_bootstrap_options channel_options = {
+            .bootstrap = generator->client_bootstrap,
+            .host_name = LOAD_GENERATOR_HOST,
+            .port = (uint32_t)(generator->config.port + index % generator->config.listeners),
+            .socket_options = &generator->socket_options,
+            .tls_options = generator->config.use_tls ? &generator->client_tls_options : NULL,
+            .setup_callback = s_client_on_setup,
+            .shutdown_callback = s_client_on_shutdown,
+            .user_data = connection,
+        };
+
+        if (!aws_client_bootstrap_new_socket_channel(&channel_options)) {
+            return;
+        }
+
+        int error_code = aws_last_error();
+        aws_mutex_lock(&generator->mutex);
+        ++generator->connects_finished;
+        ++generator->connect_failures;
+        if (!generator->first_connect_error) {
+            generator->first_connect_error = error_code;
+        }
+        s_unlock_and_notify(generator);
+    }
+}
+
+/*
+ * setup and teardown
+ */
+static int s_init_tls(struct load_generator *generator) {
+    char cert_path[512];
+    char key_path[512];
+    snprintf(cert_path, sizeof(cert_path), "%s/unittests.crt", generator->config.resources_dir);
+    snprintf(key_path, sizeof(key_path), "%s/unittests.key", generator->config.resources_dir);
+
+    if (aws_tls_ctx_options_init_default_server_from_path(
+            &generator->server_ctx_options, generator->allocator, cert_path, key_path)) {
+        fprintf(stderr, "failed to load %s and %s, see --resources\n", cert_path, key_path);
+        return AWS_OP_ERR;
+    }
+    generator->server_ctx = aws_tls_server_ctx_new(generator->allocator, &generator->server_ctx_options);
+    if (!generator->server_ctx) {
+        return AWS_OP_ERR;
+    }
+    aws_tls_connection_options_init_from_ctx(&generator->server_tls_options, generator->server_ctx);
+
+    /* the test certificate is self-signed */
+    aws_tls_ctx_options_init_default_client(&generator->client_ctx_options, generator->allocator);
+    aws_tls_ctx_options_set_verify_peer(&generator->client_ctx_options, false);
+    generator->client_ctx = aws_tls_client_ctx_new(generator->allocator, &generator->client_ctx_options);
+    if (!generator->client_ctx) {
+        return AWS_OP_ERR;
+    }
+    aws_tls_connection_options_init_from_ctx(&generator->client_tls_options, generator->client_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    return aws_tls_connection_options_set_server_name(
+        &generator->client_tls_options, generator->allocator, &server_name);
+}
+
+static int s_generator_init(
+    struct load_generator *generator,
+    struct aws_allocator *allocator,
+    const struct load_generator_config *config) {
+
+    AWS_ZERO_STRUCT(*generator);
+    generator->allocator = allocator;
+    generator->config = *config;
+    aws_mutex_init(&generator->mutex);
+    aws_condition_variable_init(&generator->condition_variable);
+    aws_atomic_init_int(&generator->next_connection, 0);
+    aws_atomic_init_int(&generator->running, 0);
+    aws_atomic_init_int(&generator->accepted, 0);
+    aws_atomic_init_int(&generator->last_accept_ns, 0);
+    aws_atomic_init_int(&generator->client_bytes_written, 0);
+    aws_atomic_init_int(&generator->client_bytes_read, 0);
+    aws_atomic_init_int(&generator->server_bytes_written, 0);
+    aws_atomic_init_int(&generator->server_bytes_read, 0);
+    aws_atomic_init_int(&generator->round_trips, 0);
+
+    /* every connection's state is written here, so it's resident before the baseline RSS is taken */
+    generator->connections = aws_mem_calloc(allocator, config->connections, sizeof(struct load_connection));
+    generator->listeners = aws_mem_calloc(allocator, config->listeners, sizeof(struct aws_socket *));
+    if (!generator->connections || !generator->listeners) {
+        return AWS_OP_ERR;
+    }
+    for (size_t i = 0; i < config->connections; ++i) {
+        generator->connections[i].generator = generator;
+    }
+
+    if (config->use_tls && s_init_tls(generator)) {
+        return AWS_OP_ERR;
+    }
+
+    generator->server_el_group = aws_event_loop_group_new_default(allocator, (uint16_t)config->loops, NULL);
+    generator->client_el_group = aws_event_loop_group_new_default(allocator, (uint16_t)config->loops, NULL);
+    if (!generator->server_el_group || !generator->client_el_group) {
+        return AWS_OP_ERR;
+    }
+
+    generator->resolver = aws_host_resolver_new_default(allocator, 8, generator->client_el_group, NULL);
+    if (!generator->resolver) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_client_bootstrap_options client_options = {
+        .event_loop_group = generator->client_el_group,
+        .host_resolver = generator->resolver,
+    };
+    generator->client_bootstrap = aws_client_bootstrap_new(allocator, &client_options);
+    generator->server_bootstrap = aws_server_bootstrap_new(allocator, generator->server_el_group);
+    if (!generator->client_bootstrap || !generator->server_bootstrap) {
+        return AWS_OP_ERR;
+    }
+
+    generator->socket_options.type = AWS_SOCKET_STREAM;
+    generator->socket_options.domain = AWS_SOCKET_IPV4;
+    generator->socket_options.connect_timeout_ms = 10000;
+
+    for (size_t i = 0; i < config->listeners; ++i) {
+        struct aws_server_socket_channel_bootstrap_options listener_options = {
+            .bootstrap = generator->server_bootstrap,
+            .host_name = LOAD_GENERATOR_HOST,
+            .port = (uint16_t)(config->port + i),
+            .socket_options = &generator->socket_options,
+            .tls_options = config->use_tls ? &generator->server_tls_options : NULL,
+            .incoming_callback = s_server_on_incoming_channel_setup,
+            .shutdown_callback = s_server_on_incoming_channel_shutdown,
+            .destroy_callback = s_server_on_listener_destroy,
+            .listener_per_event_loop = config->listener_per_loop,
+            .user_data = generator,
+        };
+        generator->listeners[i] = aws_server_bootstrap_new_socket_listener(&listener_options);
+        if (!generator->listeners[i]) {
+            fprintf(stderr, "failed to listen on port %u\n", (unsigned)listener_options.port);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_connects_finished_pred(void *arg) {
+    struct load_generator *generator = arg;
+    return generator->connects_finished == generator->config.connections;
+}
+
+static bool s_channels_closed_pred(void *arg) {
+    struct load_generator *generator = arg;
+    return generator->channels_closed == generator->channels_opened;
+}
+
+static bool s_listeners_destroyed_pred(void *arg) {
+    struct load_generator *generator = arg;
+    size_t listener_count = 0;
+    for (size_t i = 0; i < generator->config.listeners; ++i) {
+        listener_count += generator->listeners[i] != NULL;
+    }
+    return generator->listeners_destroyed == listener_count;
+}
+
+static void s_generator_clean_up(struct load_generator *generator) {
+    if (generator->listeners) {
+        for (size_t i = 0; i < generator->config.listeners; ++i) {
+            if (generator->listeners[i]) {
+                aws_server_bootstrap_destroy_socket_listener(generator->server_bootstrap, generator->listeners[i]);
+            }
+        }
+
+        aws_mutex_lock(&generator->mutex);
+        aws_condition_variable_wait_pred(
+            &generator->condition_variable, &generator->mutex, s_listeners_destroyed_pred, generator);
+        aws_mutex_unlock(&generator->mutex);
+        aws_mem_release(generator->allocator, generator->listeners);
+    }
+
+    aws_server_bootstrap_release(generator->server_bootstrap);
+    aws_client_bootstrap_release(generator->client_bootstrap);
+    aws_host_resolver_release(generator->resolver);
+    aws_event_loop_group_release(generator->client_el_group);
+    aws_event_loop_group_release(generator->server_el_group);
+
+    if (generator->config.use_tls) {
+        aws_tls_connection_options_clean_up(&generator->client_tls_options);
+        aws_tls_connection_options_clean_up(&generator->server_tls_options);
+        aws_tls_ctx_release(generator->client_ctx);
+        aws_tls_ctx_release(generator->server_ctx);
+        aws_tls_ctx_options_clean_up(&generator->client_ctx_options);
+        aws_tls_ctx_options_clean_up(&generator->server_ctx_options);
+    }
+
+    if (generator->connections) {
+        aws_mem_release(generator->allocator, generator->connections);
+    }
+    aws_condition_variable_clean_up(&generator->condition_variable);
+    aws_mutex_clean_up(&generator->mutex);
+}
+
+/*
+ * the run
+ */
+static const char *s_pattern_name(enum load_pattern pattern) {
+    switch (pattern) {
+        case LOAD_PATTERN_IDLE:
+            return "idle";
+        case LOAD_PATTERN_STREAM:
+            return "stream";
+        case LOAD_PATTERN_PING_PONG:
+            return "ping-pong";
+    }
+    return "unknown";
+}
+
+static double s_per_sec(uint64_t count, uint64_t elapsed_ns) {
+    return elapsed_ns ? (double)count * (double)AWS_TIMESTAMP_NANOS / (double)elapsed_ns : 0.0;
+}
+
+static void s_print_loops(
+    const char *side,
+    const struct loop_cpu_sample *before,
+    const struct loop_cpu_sample *after,
+    size_t first,
+    size_t count,
+    uint64_t elapsed_ns,
+    bool *first_printed) {
+
+    for (size_t i = first; i < first + count; ++i) {
+        if (before[i].cpu_ns == UINT64_MAX || after[i].cpu_ns == UINT64_MAX) {
+            continue;
+        }
+
+        uint64_t cpu_ns = after[i].cpu_ns - before[i].cpu_ns;
+        printf(
+            "%s{\"side\":\"%s\",\"index\":%zu,\"cpu_ns\":%llu,\"utilization\":%.4f}",
+            *first_printed ? "," : "",
+            side,
+            i - first,
+            (unsigned long long)cpu_ns,
+            elapsed_ns ? (double)cpu_ns / (double)elapsed_ns : 0.0);
+        *first_printed = true;
+    }
+}
+
+static int s_run(struct load_generator *generator) {
+    const struct load_generator_config *config = &generator->config;
+
+    size_t client_loop_count = aws_event_loop_group_get_loop_count(generator->client_el_group);
+    size_t loop_count = client_loop_count + aws_event_loop_group_get_loop_count(generator->server_el_group);
+    struct loop_cpu_sample *before = aws_mem_calloc(generator->allocator, loop_count, sizeof(struct loop_cpu_sample));
+    struct loop_cpu_sample *after = aws_mem_calloc(generator->allocator, loop_count, sizeof(struct loop_cpu_sample));
+    if (!before || !after) {
+        if (before) {
+            aws_mem_release(generator->allocator, before);
+        }
+        return AWS_OP_ERR;
+    }
+
+    uint64_t rss_baseline = s_rss_bytes();
+
+    /* connect */
+    uint64_t connect_start_ns = s_now_ns();
+    for (size_t i = 0; i < aws_min_size(config->max_pending_connects, config->connections); ++i) {
+        s_launch_connects(generator);
+    }
+
+    aws_mutex_lock(&generator->mutex);
+    aws_condition_variable_wait_pred(
+        &generator->condition_variable, &generator->mutex, s_connects_finished_pred, generator);
+    size_t established = generator->connects_finished - generator->connect_failures;
+    size_t connect_failures = generator->connect_failures;
+    int first_connect_error = generator->first_connect_error;
+    uint64_t connect_elapsed_ns = generator->last_connect_ns - connect_start_ns;
+    aws_mutex_unlock(&generator->mutex);
+
+    if (connect_failures) {
+        fprintf(
+            stderr,
+            "%zu of %zu connections failed, first with %s\n",
+            connect_failures,
+            config->connections,
+            aws_error_debug_str(first_connect_error));
+    }
+
+    /* the server side sees a connection a moment after the client does */
+    uint64_t accept_deadline_ns = s_now_ns() + aws_timestamp_convert(5, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    while (aws_atomic_load_int(&generator->accepted) < established && s_now_ns() < accept_deadline_ns) {
+        aws_thread_current_sleep(aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    }
+    size_t accepted = aws_atomic_load_int(&generator->accepted);
+    uint64_t last_accept_ns = aws_atomic_load_int(&generator->last_accept_ns);
+    uint64_t rss_connected = s_rss_bytes();
+
+    /* drive traffic; connection->channel is only stable under the mutex, a channel can go away at any time */
+    s_sample_loops(generator, before, loop_count);
+    uint64_t traffic_start_ns = s_now_ns();
+    aws_atomic_store_int(&generator->running, 1);
+    aws_mutex_lock(&generator->mutex);
+    for (size_t i = 0; i < config->connections; ++i) {
+        struct load_connection *connection = &generator->connections[i];
+        if (connection->channel) {
+            aws_channel_schedule_task_now(connection->channel, &connection->start_task);
+        }
+    }
+    aws_mutex_unlock(&generator->mutex);
+
+    aws_thread_current_sleep(config->duration_ns);
+    aws_atomic_store_int(&generator->running, 0);
+    uint64_t traffic_elapsed_ns = s_now_ns() - traffic_start_ns;
+    s_sample_loops(generator, after, loop_count);
+
+    /* hang up, which also folds every connection's counters into the totals */
+    aws_mutex_lock(&generator->mutex);
+    for (size_t i = 0; i < config->connections; ++i) {
+        if (generator->connections[i].channel) {
+            aws_channel_shutdown(generator->connections[i].channel, AWS_OP_SUCCESS);
+        }
+    }
+    aws_condition_variable_wait_pred(
+        &generator->condition_variable, &generator->mutex, s_channels_closed_pred, generator);
+    aws_mutex_unlock(&generator->mutex);
+
+    uint64_t bytes_written = aws_atomic_load_int(&generator->client_bytes_written) +
+                             aws_atomic_load_int(&generator->server_bytes_written);
+    uint64_t bytes_read =
+        aws_atomic_load_int(&generator->client_bytes_read) + aws_atomic_load_int(&generator->server_bytes_read);
+    uint64_t cpu_ns = 0;
+    for (size_t i = 0; i < loop_count; ++i) {
+        if (before[i].cpu_ns != UINT64_MAX && after[i].cpu_ns != UINT64_MAX) {
+            cpu_ns += after[i].cpu_ns - before[i].cpu_ns;
+        }
+    }
+
+    printf(
+        "{\"pattern\":\"%s\",\"tls\":%s,\"connections\":%zu,\"established\":%zu,\"connect_failures\":%zu,"
+        "\"connect_elapsed_ns\":%llu,\"connects_per_sec\":%.1f,\"accepted\":%zu,\"accepts_per_sec\":%.1f,"
+        "\"rss_baseline_bytes\":%llu,\"rss_connected_bytes\":%llu,\"rss_per_connection_bytes\":%.1f,"
+        "\"message_size\":%zu,\"traffic_elapsed_ns\":%llu,\"bytes_written\":%llu,\"bytes_read\":%llu,"
+        "\"bytes_per_sec\":%.1f,\"round_trips\":%llu,\"round_trips_per_sec\":%.1f,\"cpu_ns\":%llu,"
+        "\"cpu_ns_per_gb\":%.1f,\"loops\":[",
+        s_pattern_name(config->pattern),
+        config->use_tls ? "true" : "false",
+        config->connections,
+        established,
+        connect_failures,
+        (unsigned long long)connect_elapsed_ns,
+        s_per_sec(established, connect_elapsed_ns),
+        accepted,
+        s_per_sec(accepted, last_accept_ns > connect_start_ns ? last_accept_ns - connect_start_ns : 0),
+        (unsigned long long)rss_baseline,
+        (unsigned long long)rss_connected,
+        established && rss_connected > rss_baseline ? (double)(rss_connected - rss_baseline) / (double)established
+                                                    : 0.0,
+        config->message_size,
+        (unsigned long long)traffic_elapsed_ns,
+        (unsigned long long)bytes_written,
+        (unsigned long long)bytes_read,
+        s_per_sec(bytes_read, traffic_elapsed_ns),
+        (unsigned long long)aws_atomic_load_int(&generator->round_trips),
+        s_per_sec(aws_atomic_load_int(&generator->round_trips), traffic_elapsed_ns),
+        (unsigned long long)cpu_ns,
+        bytes_read ? (double)cpu_ns * 1e9 / (double)bytes_read : 0.0);
+
+    bool first_printed = false;
+    s_print_loops("client", before, after, 0, client_loop_count, traffic_elapsed_ns, &first_printed);
+    s_print_loops(
+        "server",
+        before,
+        after,
+        client_loop_count,
+        loop_count - client_loop_count,
+        traffic_elapsed_ns,
+        &first_printed);
+    printf("]}\n");
+    fflush(stdout);
+
+    aws_mem_release(generator->allocator, before);
+    aws_mem_release(generator->allocator, after);
+    return connect_failures ? aws_raise_error(first_connect_error) : AWS_OP_SUCCESS;
+}
+
+static void s_usage(const char *program) {
+    fprintf(
+        stderr,
+        "usage: %s [options]\n"
+        "Opens N loopback channels, drives traffic over them and prints one JSON line of results.\n"
+        "  --connections <n>           channels to open (default 1000)\n"
+        "  --loops <n>                 event loops for each of client and server, 0 for one per processor (default 0)\n"
+        "  --listeners <n>             listener ports, from --port up (default one per %d connections)\n"
+        "  --port <port>               first listener port (default 8150)\n"
+        "  --listener-per-loop         open every listener once per server loop with SO_REUSEPORT\n"
+        "  --max-pending-connects <n>  connects in flight at once (default 512)\n"
+        "  --tls                       negotiate TLS on every channel\n"
+        "  --pattern <p>               idle, stream or ping-pong (default idle)\n"
+        "  --message-size <bytes>      bytes per write or per round trip (default 4096)\n"
+        "  --writes-in-flight <n>      writes each stream client keeps outstanding (default 4)\n"
+        "  --duration-ms <ms>          how long to drive traffic for (default 10000)\n"
+        "  --resources <dir>           directory with unittests.crt and unittests.key, for --tls\n",
+        program,
+        LOAD_GENERATOR_CONNECTIONS_PER_LISTENER);
+}
+
+int main(int argc, char **argv) {
+    struct load_generator_config config = {
+        .connections = 1000,
+        .loops = 0,
+        .listeners = 0,
+        .port = 8150,
+        .max_pending_connects = 512,
+        .pattern = LOAD_PATTERN_IDLE,
+        .message_size = 4096,
+        .writes_in_flight = 4,
+        .duration_ns = aws_timestamp_convert(10, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL),
+        .resources_dir = AWS_IO_BENCHMARK_RESOURCES_DIR,
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--tls") == 0) {
+            config.use_tls = true;
+        } else if (strcmp(argv[i], "--listener-per-loop") == 0) {
+            config.listener_per_loop = true;
+        } else if (has_value && strcmp(argv[i], "--connections") == 0) {
+            config.connections = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--loops") == 0) {
+            config.loops = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--listeners") == 0) {
+            config.listeners = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--port") == 0) {
+            config.port = (uint16_t)strtoul(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--max-pending-connects") == 0) {
+            config.max_pending_connects = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--message-size") == 0) {
+            config.message_size = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--writes-in-flight") == 0) {
+            config.writes_in_flight = strtoull(argv[++i], NULL, 10);
+        } else if (has_value && strcmp(argv[i], "--duration-ms") == 0) {
+            config.duration_ns = aws_timestamp_convert(
+                strtoull(argv[++i], NULL, 10), AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+        } else if (has_value && strcmp(argv[i], "--resources") == 0) {
+            config.resources_dir = argv[++i];
+        } else if (has_value && strcmp(argv[i], "--pattern") == 0) {
+            const char *pattern = argv[++i];
+            if (strcmp(pattern, "idle") == 0) {
+                config.pattern = LOAD_PATTERN_IDLE;
+            } else if (strcmp(pattern, "stream") == 0) {
+                config.pattern = LOAD_PATTERN_STREAM;
+            } else if (strcmp(pattern, "ping-pong") == 0) {
+                config.pattern = LOAD_PATTERN_PING_PONG;
+            } else {
+                s_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            s_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.connections == 0 || config.message_size == 0 || config.max_pending_connects == 0 ||
+        config.writes_in_flight == 0) {
+        s_usage(argv[0]);
+        return 1;
+    }
+
+    if (config.listeners == 0) {
+        config.listeners = config.connections / LOAD_GENERATOR_CONNECTIONS_PER_LISTENER + 1;
+    }
+
+    s_raise_fd_limit(config.connections);
+
+    struct aws_allocator *allocator = aws_default_allocator();
+    aws_io_library_init(allocator);
+
+    struct load_generator generator;
+    int exit_code = 1;
+    if (s_generator_init(&generator, allocator, &config) == AWS_OP_SUCCESS && s_run(&generator) == AWS_OP_SUCCESS) {
+        exit_code = 0;
+    } else {
+        fprintf(stderr, "load generator failed: %s\n", aws_error_debug_str(aws_last_error()));
+    }
+
+    s_generator_clean_up(&generator);
+    aws_io_library_clean_up();
+
+    return exit_code;
+}
@@ -0,0 +1,490 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+
+#define LOOPBACK_BENCHMARK_HOST "127.0.0.1"
+#define LOOPBACK_BENCHMARK_PORT 8141
+
+/* A server and a client bootstrap talking over TCP on 127.0.0.1, optionally with TLS in both channels. */
+struct loopback_benchmark {
+    struct aws_allocator *allocator;
+    const struct benchmark_config *config;
+    bool use_tls;
+
+    struct aws_event_loop_group *el_group;
+    struct aws_host_resolver *resolver;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct aws_server_bootstrap *server_bootstrap;
+    struct aws_socket *listener;
+    struct aws_socket_options socket_options;
+
+    struct aws_tls_ctx_options server_ctx_options;
+    struct aws_tls_ctx_options client_ctx_options;
+    struct aws_tls_ctx *server_ctx;
+    struct aws_tls_ctx *client_ctx;
+    struct aws_tls_connection_options server_tls_options;
+    struct aws_tls_connection_options client_tls_options;
+
+    struct benchmark_result result;
+    struct benchmark_writer writer;
+    struct aws_atomic_var server_bytes;
+    /* handshake runs only */
+    uint64_t connect_start_ns;
+    struct aws_atomic_var stop_connecting;
+
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    /* everything below is guarded by mutex */
+    int error_code;
+    struct aws_channel *client_channel;
+    bool client_setup;
+    bool server_setup;
+    bool client_shutdown;
+    bool handshakes_done;
+    bool listener_destroyed;
+};
+
+static void s_signal(struct loopback_benchmark *benchmark, bool *flag, int error_code) {
+    aws_mutex_lock(&benchmark->mutex);
+    *flag = true;
+    if (error_code && !benchmark->error_code) {
+        benchmark->error_code = error_code;
+    }
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static bool s_flag_is_set(void *arg) {
+    return *(bool *)arg;
+}
+
+static int s_wait(struct loopback_benchmark *benchmark, bool *flag) {
+    aws_mutex_lock(&benchmark->mutex);
+    aws_condition_variable_wait_pred(&benchmark->condition_variable, &benchmark->mutex, s_flag_is_set, flag);
+    int error_code = benchmark->error_code;
+    aws_mutex_unlock(&benchmark->mutex);
+
+    if (error_code) {
+        return aws_raise_error(error_code);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_server_on_incoming_channel_setup(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct loopback_benchmark *benchmark = user_data;
+
+    if (!error_code) {
+        struct aws_channel_handler *sink = benchmark_sink_handler_new(benchmark->allocator, &benchmark->server_bytes);
+        struct aws_channel_slot *slot = sink ? aws_channel_slot_new(channel) : NULL;
+        if (!slot || aws_channel_slot_insert_end(channel, slot) || aws_channel_slot_set_handler(slot, sink)) {
+            error_code = aws_last_error();
+            aws_channel_shutdown(channel, error_code);
+        }
+    }
+
+    s_signal(benchmark, &benchmark->server_setup, error_code);
+}
+
+static void s_server_on_incoming_channel_shutdown(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    (void)user_data;
+}
+
+static void s_server_on_listener_destroy(struct aws_server_bootstrap *bootstrap, void *user_data) {
+    (void)bootstrap;
+    struct loopback_benchmark *benchmark = user_data;
+    s_signal(benchmark, &benchmark->listener_destroyed, AWS_OP_SUCCESS);
+}
+
+static int s_init_tls(struct loopback_benchmark *benchmark) {
+    char cert_path[512];
+    char key_path[512];
+    snprintf(cert_path, sizeof(cert_path), "%s/unittests.crt", benchmark->config->resources_dir);
+    snprintf(key_path, sizeof(key_path), "%s/unittests.key", benchmark->config->resources_dir);
+
+    if (aws_tls_ctx_options_init_default_server_from_path(
+            &benchmark->server_ctx_options, benchmark->allocator, cert_path, key_path)) {
+        fprintf(stderr, "failed to load %s and %s, see --resources\n", cert_path, key_path);
+        return AWS_OP_ERR;
+    }
+    benchmark->server_ctx = aws_tls_server_ctx_new(benchmark->allocator, &benchmark->server_ctx_options);
+    if (!benchmark->server_ctx) {
+        return AWS_OP_ERR;
+    }
+    aws_tls_connection_options_init_from_ctx(&benchmark->server_tls_options, benchmark->server_ctx);
+
+    /* the test certificate is self-signed; the handshake still does all of its key exchange and signing */
+    aws_tls_ctx_options_init_default_client(&benchmark->client_ctx_options, benchmark->allocator);
+    aws_tls_ctx_options_set_verify_peer(&benchmark->client_ctx_options, false);
+    benchmark->client_ctx = aws_tls_client_ctx_new(benchmark->allocator, &benchmark->client_ctx_options);
+    if (!benchmark->client_ctx) {
+        return AWS_OP_ERR;
+    }
+    aws_tls_connection_options_init_from_ctx(&benchmark->client_tls_options, benchmark->client_ctx);
+
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    return aws_tls_connection_options_set_server_name(
+        &benchmark->client_tls_options, benchmark->allocator, &server_name);
+}
+
+static int s_loopback_init(
+    struct loopback_benchmark *benchmark,
+    struct aws_allocator *allocator,
+    const struct benchmark_config *config,
+    bool use_tls) {
+
+    AWS_ZERO_STRUCT(*benchmark);
+    benchmark->allocator = allocator;
+    benchmark->config = config;
+    benchmark->use_tls = use_tls;
+    aws_mutex_init(&benchmark->mutex);
+    aws_condition_variable_init(&benchmark->condition_variable);
+    aws_atomic_init_int(&benchmark->server_bytes, 0);
+    aws_atomic_init_int(&benchmark->stop_connecting, 0);
+
+    if (benchmark_result_init(&benchmark->result, allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    if (use_tls && s_init_tls(benchmark)) {
+        return AWS_OP_ERR;
+    }
+
+    /* client and server each get a loop of their own */
+    benchmark->el_group = aws_event_loop_group_new_default(allocator, 2, NULL);
+    if (!benchmark->el_group) {
+        return AWS_OP_ERR;
+    }
+
+    benchmark->resolver = aws_host_resolver_new_default(allocator, 8, benchmark->el_group, NULL);
+    if (!benchmark->resolver) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_client_bootstrap_options client_options = {
+        .event_loop_group = benchmark->el_group,
+        .host_resolver = benchmark->resolver,
+    };
+    benchmark->client_bootstrap = aws_client_bootstrap_new(allocator, &client_options);
+    benchmark->server_bootstrap = aws_server_bootstrap_new(allocator, benchmark->el_group);
+    if (!benchmark->client_bootstrap || !benchmark->server_bootstrap) {
+        return AWS_OP_ERR;
+    }
+
+    benchmark->socket_options.type = AWS_SOCKET_STREAM;
+    benchmark->socket_options.domain = AWS_SOCKET_IPV4;
+    benchmark->socket_options.connect_timeout_ms = 3000;
+
+    struct aws_server_socket_channel_bootstrap_options listener_options = {
+        .bootstrap = benchmark->server_bootstrap,
+        .host_name = LOOPBACK_BENCHMARK_HOST,
+        .port = LOOPBACK_BENCHMARK_PORT,
+        .socket_options = &benchmark->socket_options,
+        .tls_options = use_tls ? &benchmark->server_tls_options : NULL,
+        .incoming_callback = s_server_on_incoming_channel_setup,
+        .shutdown_callback = s_server_on_incoming_channel_shutdown,
+        .destroy_callback = s_server_on_listener_destroy,
+        .user_data = benchmark,
+    };
+    benchmark->listener = aws_server_bootstrap_new_socket_listener(&listener_options);
+    if (!benchmark->listener) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_loopback_clean_up(struct loopback_benchmark *benchmark) {
+    if (benchmark->listener) {
+        aws_server_bootstrap_destroy_socket_listener(benchmark->server_bootstrap, benchmark->listener);
+        s_wait(benchmark, &benchmark->listener_destroyed);
+    }
+
+    aws_server_bootstrap_release(benchmark->server_bootstrap);
+    aws_client_bootstrap_release(benchmark->client_bootstrap);
+    aws_host_resolver_release(benchmark->resolver);
+    aws_event_loop_group_release(benchmark->el_group);
+
+    if (benchmark->use_tls) {
+        aws_tls_connection_options_clean_up(&benchmark->client_tls_options);
+        aws_tls_connection_options_clean_up(&benchmark->server_tls_options);
+        aws_tls_ctx_release(benchmark->client_ctx);
+        aws_tls_ctx_release(benchmark->server_ctx);
+        aws_tls_ctx_options_clean_up(&benchmark->client_ctx_options);
+        aws_tls_ctx_options_clean_up(&benchmark->server_ctx_options);
+    }
+
+    benchmark_result_clean_up(&benchmark->result);
+    aws_condition_variable_clean_up(&benchmark->condition_variable);
+    aws_mutex_clean_up(&benchmark->mutex);
+}
+
+/*
+ * bulk throughput: one connection, the client writing as fast as the channel completes its writes
+ */
+static void s_bulk_on_client_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct loopback_benchmark *benchmark = user_data;
+
+    if (!error_code) {
+        aws_mutex_lock(&benchmark->mutex);
+        benchmark->client_channel = channel;
+        aws_mutex_unlock(&benchmark->mutex);
+
+        if (benchmark_writer_install(&benchmark->writer, benchmark->allocator, channel, &benchmark->result)) {
+            error_code = aws_last_error();
+            aws_channel_shutdown(channel, error_code);
+        }
+    } else {
+        /* no shutdown callback follows a failed setup */
+        s_signal(benchmark, &benchmark->client_shutdown, error_code);
+    }
+
+    s_signal(benchmark, &benchmark->client_setup, error_code);
+}
+
+static void s_bulk_on_client_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    struct loopback_benchmark *benchmark = user_data;
+    s_signal(benchmark, &benchmark->client_shutdown, AWS_OP_SUCCESS);
+}
+
+static int s_connect(struct loopback_benchmark *benchmark, aws_client_bootstrap_on_channel_event_fn *setup_callback) {
+    struct aws_socket_channel_bootstrap_options channel_options = {
+        .bootstrap = benchmark->client_bootstrap,
+        .host_name = LOOPBACK_BENCHMARK_HOST,
+        .port = LOOPBACK_BENCHMARK_PORT,
+        .socket_options = &benchmark->socket_options,
+        .tls_options = benchmark->use_tls ? &benchmark->client_tls_options : NULL,
+        .setup_callback = setup_callback,
+        .shutdown_callback = s_bulk_on_client_shutdown,
+        .user_data = benchmark,
+    };
+
+    return aws_client_bootstrap_new_socket_channel(&channel_options);
+}
+
+/* One operation is one full size write, completed. */
+static int s_run_bulk(
+    struct aws_allocator *allocator,
+    const struct benchmark_config *config,
+    const char *name,
+    size_t max_fragment_size,
+    bool use_tls) {
+
+    /* the socket handler reads at most this much per event and the channel's messages are this big */
+    size_t previous_max_fragment_size = g_aws_channel_max_fragment_size;
+    g_aws_channel_max_fragment_size = max_fragment_size;
+
+    struct loopback_benchmark benchmark;
+    int result = AWS_OP_ERR;
+    if (s_loopback_init(&benchmark, allocator, config, use_tls)) {
+        goto done;
+    }
+
+    if (s_connect(&benchmark, s_bulk_on_client_setup)) {
+        goto done;
+    }
+
+    if (s_wait(&benchmark, &benchmark.client_setup) || s_wait(&benchmark, &benchmark.server_setup)) {
+        goto hang_up;
+    }
+
+    benchmark_writer_start(&benchmark.writer);
+    aws_thread_current_sleep(config->duration_ns);
+    benchmark_writer_stop(&benchmark.writer);
+    while (!aws_atomic_load_int(&benchmark.writer.stopped)) {
+        aws_thread_current_sleep(aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    }
+
+    if (benchmark.writer.error_code) {
+        aws_raise_error(benchmark.writer.error_code);
+        goto hang_up;
+    }
+
+    benchmark_report(name, &benchmark.result);
+    result = AWS_OP_SUCCESS;
+
+hang_up:
+    aws_mutex_lock(&benchmark.mutex);
+    struct aws_channel *client_channel = benchmark.client_channel;
+    aws_mutex_unlock(&benchmark.mutex);
+    if (client_channel) {
+        aws_channel_shutdown(client_channel, AWS_OP_SUCCESS);
+    }
+    s_wait(&benchmark, &benchmark.client_shutdown);
+
+done:
+    s_loopback_clean_up(&benchmark);
+    g_aws_channel_max_fragment_size = previous_max_fragment_size;
+    return result;
+}
+
+/* Throughput over plain TCP, with the socket handler's read size (and so the message size) varied. */
+int benchmark_socket_loopback(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    static const size_t s_max_rw_sizes[] = {4 * 1024, 16 * 1024, 64 * 1024};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_max_rw_sizes); ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "socket_loopback_throughput/max_rw_size=%zu", s_max_rw_sizes[i]);
+        if (!benchmark_should_run(config, name)) {
+            continue;
+        }
+
+        if (s_run_bulk(allocator, config, name, s_max_rw_sizes[i], false)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * handshakes: connect, finish the TLS handshake, hang up, repeat
+ */
+static void s_handshake_on_client_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data);
+
+static void s_handshake_on_client_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data);
+
+static int s_handshake_connect(struct loopback_benchmark *benchmark) {
+    struct aws_socket_channel_bootstrap_options channel_options = {
+        .bootstrap = benchmark->client_bootstrap,
+        .host_name = LOOPBACK_BENCHMARK_HOST,
+        .port = LOOPBACK_BENCHMARK_PORT,
+        .socket_options = &benchmark->socket_options,
+        .tls_options = &benchmark->client_tls_options,
+        .setup_callback = s_handshake_on_client_setup,
+        .shutdown_callback = s_handshake_on_client_shutdown,
+        .user_data = benchmark,
+    };
+
+    benchmark->connect_start_ns = benchmark_now_ns();
+    return aws_client_bootstrap_new_socket_channel(&channel_options);
+}
+
+static void s_handshake_on_client_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct loopback_benchmark *benchmark = user_data;
+
+    if (error_code) {
+        s_signal(benchmark, &benchmark->handshakes_done, error_code);
+        return;
+    }
+
+    uint64_t now_ns = benchmark_now_ns();
+    benchmark_result_record_latency(&benchmark->result, now_ns - benchmark->connect_start_ns);
+    ++benchmark->result.operations;
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+}
+
+static void s_handshake_on_client_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    struct loopback_benchmark *benchmark = user_data;
+
+    if (aws_atomic_load_int(&benchmark->stop_connecting)) {
+        s_signal(benchmark, &benchmark->handshakes_done, AWS_OP_SUCCESS);
+        return;
+    }
+
+    if (s_handshake_connect(benchmark)) {
+        s_signal(benchmark, &benchmark->handshakes_done, aws_last_error());
+    }
+}
+
+/* One operation is a connection from connect() until its TLS handshake is done. One connection at a time. */
+static int s_run_handshakes(struct aws_allocator *allocator, const struct benchmark_config *config, const char *name) {
+    struct loopback_benchmark benchmark;
+    int result = AWS_OP_ERR;
+    if (s_loopback_init(&benchmark, allocator, config, true)) {
+        goto done;
+    }
+
+    uint64_t start_ns = benchmark_now_ns();
+    if (s_handshake_connect(&benchmark)) {
+        goto done;
+    }
+
+    aws_thread_current_sleep(config->duration_ns);
+    aws_atomic_store_int(&benchmark.stop_connecting, 1);
+    if (s_wait(&benchmark, &benchmark.handshakes_done)) {
+        goto done;
+    }
+    benchmark.result.elapsed_ns = benchmark_now_ns() - start_ns;
+
+    benchmark_report(name, &benchmark.result);
+    result = AWS_OP_SUCCESS;
+
+done:
+    s_loopback_clean_up(&benchmark);
+    return result;
+}
+
+int benchmark_tls(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    const char *bulk_name = "tls_bulk_throughput";
+    if (benchmark_should_run(config, bulk_name) && s_run_bulk(allocator, config, bulk_name, 16 * 1024, true)) {
+        return AWS_OP_ERR;
+    }
+
+    const char *handshake_name = "tls_handshakes";
+    if (benchmark_should_run(config, handshake_name) && s_run_handshakes(allocator, config, handshake_name)) {
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
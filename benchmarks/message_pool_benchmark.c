@@ -0,0 +1,67 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/io/message_pool.h>
+
+#include <stdio.h>
+
+/* One operation is an acquire followed by a release of the same message, on one thread. */
+int benchmark_message_pool(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    static const size_t s_size_hints[] = {128, 16 * 1024};
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_size_hints); ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "message_pool_acquire_release/size=%zu", s_size_hints[i]);
+        if (!benchmark_should_run(config, name)) {
+            continue;
+        }
+
+        struct aws_message_pool_creation_args pool_args = {
+            .application_data_msg_data_size = 16 * 1024,
+            .application_data_msg_count = 4,
+            .small_block_msg_data_size = 128,
+            .small_block_msg_count = 4,
+        };
+        struct aws_message_pool pool;
+        if (aws_message_pool_init(&pool, allocator, &pool_args)) {
+            return AWS_OP_ERR;
+        }
+
+        struct benchmark_result result;
+        if (benchmark_result_init(&result, allocator)) {
+            aws_message_pool_clean_up(&pool);
+            return AWS_OP_ERR;
+        }
+
+        uint64_t start_ns = benchmark_now_ns();
+        uint64_t end_ns = start_ns + config->duration_ns;
+        uint64_t op_start_ns = start_ns;
+        uint64_t now_ns = start_ns;
+        while (now_ns < end_ns) {
+            struct aws_io_message *message =
+                aws_message_pool_acquire(&pool, AWS_IO_MESSAGE_APPLICATION_DATA, s_size_hints[i]);
+            if (!message) {
+                benchmark_result_clean_up(&result);
+                aws_message_pool_clean_up(&pool);
+                return AWS_OP_ERR;
+            }
+            aws_message_pool_release(&pool, message);
+
+            now_ns = benchmark_now_ns();
+            benchmark_result_record_latency(&result, now_ns - op_start_ns);
+            op_start_ns = now_ns;
+            ++result.operations;
+        }
+        result.elapsed_ns = now_ns - start_ns;
+
+        benchmark_report(name, &result);
+        benchmark_result_clean_up(&result);
+        aws_message_pool_clean_up(&pool);
+    }
+
+    return AWS_OP_SUCCESS;
+}
@@ -0,0 +1,354 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include "benchmark.h"
+
+#include <aws/io/channel_bootstrap.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
+
+#include <stdio.h>
+
+#define SERVER_SCALING_HOST "127.0.0.1"
+#define SERVER_SCALING_PORT 8142
+
+/* the most server loops tried, doubling from one */
+#define SERVER_SCALING_MAX_LOOPS 64
+
+/* connections kept cycling per server loop, enough to keep every loop busy accepting */
+#define SERVER_SCALING_CONNECTIONS_PER_LOOP 8
+
+/*
+ * A server with a listener per event loop, each loop pinned to a core, and a client group of the same size connecting,
+ * setting up and hanging up as fast as it can. The clients run on the same machine, so past half the cores they
+ * compete with the server for cpu; drive the server from another host with the load generator for the far end of the
+ * curve.
+ */
+struct server_scaling_benchmark {
+    struct aws_allocator *allocator;
+    struct aws_event_loop_group *server_el_group;
+    struct aws_event_loop_group *client_el_group;
+    struct aws_host_resolver *resolver;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct aws_server_bootstrap *server_bootstrap;
+    struct aws_socket *listener;
+    struct aws_socket_options socket_options;
+
+    struct aws_atomic_var stop_connecting;
+    struct aws_atomic_var connections_set_up;
+
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    /* everything below is guarded by mutex */
+    int error_code;
+    size_t clients_running;
+    bool listener_destroyed;
+};
+
+static void s_record_error(struct server_scaling_benchmark *benchmark, int error_code) {
+    aws_mutex_lock(&benchmark->mutex);
+    if (!benchmark->error_code) {
+        benchmark->error_code = error_code;
+    }
+    aws_mutex_unlock(&benchmark->mutex);
+}
+
+static void s_client_finished(struct server_scaling_benchmark *benchmark) {
+    aws_mutex_lock(&benchmark->mutex);
+    --benchmark->clients_running;
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static bool s_clients_finished(void *arg) {
+    struct server_scaling_benchmark *benchmark = arg;
+    return benchmark->clients_running == 0;
+}
+
+static bool s_listener_destroyed(void *arg) {
+    struct server_scaling_benchmark *benchmark = arg;
+    return benchmark->listener_destroyed;
+}
+
+static void s_server_on_incoming_channel_setup(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)channel;
+
+    /* the client hangs up, the server channel only has to exist */
+    if (error_code) {
+        s_record_error(user_data, error_code);
+    }
+}
+
+static void s_server_on_incoming_channel_shutdown(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    (void)user_data;
+}
+
+static void s_server_on_listener_destroy(struct aws_server_bootstrap *bootstrap, void *user_data) {
+    (void)bootstrap;
+    struct server_scaling_benchmark *benchmark = user_data;
+
+    aws_mutex_lock(&benchmark->mutex);
+    benchmark->listener_destroyed = true;
+    aws_mutex_unlock(&benchmark->mutex);
+    aws_condition_variable_notify_all(&benchmark->condition_variable);
+}
+
+static void s_client_on_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data);
+
+static void s_client_on_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data);
+
+static int s_client_connect(struct server_scaling_benchmark *benchmark) {
+    struct aws_socket_channel_bootstrap_options channel_options = {
+        .bootstrap = benchmark->client_bootstrap,
+        .host_name = SERVER_SCALING_HOST,
+        .port = SERVER_SCALING_PORT,
+        .socket_options = &benchmark->socket_options,
+        .setup_callback = s_client_on_setup,
+        .shutdown_callback = s_client_on_shutdown,
+        .user_data = benchmark,
+    };
+
+    return aws_client_bootstrap_new_socket_channel(&channel_options);
+}
+
+static void s_client_on_setup(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    struct server_scaling_benchmark *benchmark = user_data;
+
+    if (error_code) {
+        /* no shutdown callback follows a failed setup */
+        s_record_error(benchmark, error_code);
+        s_client_finished(benchmark);
+        return;
+    }
+
+    aws_atomic_fetch_add(&benchmark->connections_set_up, 1);
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+}
+
+static void s_client_on_shutdown(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+    struct server_scaling_benchmark *benchmark = user_data;
+
+    if (aws_atomic_load_int(&benchmark->stop_connecting)) {
+        s_client_finished(benchmark);
+        return;
+    }
+
+    if (s_client_connect(benchmark)) {
+        s_record_error(benchmark, aws_last_error());
+        s_client_finished(benchmark);
+    }
+}
+
+/* Returns the number of server loops actually created, which is fewer than loop_count on a smaller machine. */
+static size_t s_server_scaling_init(
+    struct server_scaling_benchmark *benchmark,
+    struct aws_allocator *allocator,
+    size_t loop_count) {
+
+    AWS_ZERO_STRUCT(*benchmark);
+    benchmark->allocator = allocator;
+    aws_mutex_init(&benchmark->mutex);
+    aws_condition_variable_init(&benchmark->condition_variable);
+    aws_atomic_init_int(&benchmark->stop_connecting, 0);
+    aws_atomic_init_int(&benchmark->connections_set_up, 0);
+
+    benchmark->server_el_group =
+        aws_event_loop_group_new_default_pinned_to_cpu_group(allocator, (uint16_t)loop_count, 0, NULL);
+    if (!benchmark->server_el_group) {
+        return 0;
+    }
+
+    size_t server_loop_count = aws_event_loop_group_get_loop_count(benchmark->server_el_group);
+    benchmark->client_el_group = aws_event_loop_group_new_default(allocator, (uint16_t)server_loop_count, NULL);
+    if (!benchmark->client_el_group) {
+        return 0;
+    }
+
+    benchmark->resolver = aws_host_resolver_new_default(allocator, 8, benchmark->client_el_group, NULL);
+    if (!benchmark->resolver) {
+        return 0;
+    }
+
+    struct aws_client_bootstrap_options client_options = {
+        .event_loop_group = benchmark->client_el_group,
+        .host_resolver = benchmark->resolver,
+    };
+    benchmark->client_bootstrap = aws_client_bootstrap_new(allocator, &client_options);
+    benchmark->server_bootstrap = aws_server_bootstrap_new(allocator, benchmark->server_el_group);
+    if (!benchmark->client_bootstrap || !benchmark->server_bootstrap) {
+        return 0;
+    }
+
+    benchmark->socket_options.type = AWS_SOCKET_STREAM;
+    benchmark->socket_options.domain = AWS_SOCKET_IPV4;
+    benchmark->socket_options.connect_timeout_ms = 3000;
+
+    struct aws_server_socket_channel_bootstrap_options listener_options = {
+        .bootstrap = benchmark->server_bootstrap,
+        .host_name = SERVER_SCALING_HOST,
+        .port = SERVER_SCALING_PORT,
+        .socket_options = &benchmark->socket_options,
+        .incoming_callback = s_server_on_incoming_channel_setup,
+        .shutdown_callback = s_server_on_incoming_channel_shutdown,
+        .destroy_callback = s_server_on_listener_destroy,
+        .listener_per_event_loop = true,
+        .user_data = benchmark,
+    };
+    benchmark->listener = aws_server_bootstrap_new_socket_listener(&listener_options);
+    if (!benchmark->listener) {
+        return 0;
+    }
+
+    return server_loop_count;
+}
+
+static void s_server_scaling_clean_up(struct server_scaling_benchmark *benchmark) {
+    if (benchmark->listener) {
+        aws_server_bootstrap_destroy_socket_listener(benchmark->server_bootstrap, benchmark->listener);
+        aws_mutex_lock(&benchmark->mutex);
+        aws_condition_variable_wait_pred(
+            &benchmark->condition_variable, &benchmark->mutex, s_listener_destroyed, benchmark);
+        aws_mutex_unlock(&benchmark->mutex);
+    }
+
+    aws_server_bootstrap_release(benchmark->server_bootstrap);
+    aws_client_bootstrap_release(benchmark->client_bootstrap);
+    aws_host_resolver_release(benchmark->resolver);
+    aws_event_loop_group_release(benchmark->client_el_group);
+    aws_event_loop_group_release(benchmark->server_el_group);
+
+    aws_condition_variable_clean_up(&benchmark->condition_variable);
+    aws_mutex_clean_up(&benchmark->mutex);
+}
+
+/*
+ * One operation is a connection accepted and set up on both ends, then hung up. Run at each loop count, ops_per_sec
+ * should grow in step with the loop count for as long as the machine has cores to spare.
+ *
+ * Sets *out_loop_count to the loops the server got, and skips the run if that's fewer than asked for.
+ */
+static int s_run_server_scaling(
+    struct aws_allocator *allocator,
+    const struct benchmark_config *config,
+    const char *name,
+    size_t loop_count,
+    size_t *out_loop_count) {
+
+    struct server_scaling_benchmark benchmark;
+    struct benchmark_result result;
+    int return_code = AWS_OP_ERR;
+    if (benchmark_result_init(&result, allocator)) {
+        return AWS_OP_ERR;
+    }
+
+    *out_loop_count = s_server_scaling_init(&benchmark, allocator, loop_count);
+    if (*out_loop_count == 0) {
+        goto done;
+    }
+
+    if (*out_loop_count < loop_count) {
+        return_code = AWS_OP_SUCCESS;
+        goto done;
+    }
+
+    size_t client_count = loop_count * SERVER_SCALING_CONNECTIONS_PER_LOOP;
+    uint64_t start_ns = benchmark_now_ns();
+    for (size_t i = 0; i < client_count; ++i) {
+        aws_mutex_lock(&benchmark.mutex);
+        ++benchmark.clients_running;
+        aws_mutex_unlock(&benchmark.mutex);
+
+        if (s_client_connect(&benchmark)) {
+            aws_atomic_store_int(&benchmark.stop_connecting, 1);
+            s_record_error(&benchmark, aws_last_error());
+            s_client_finished(&benchmark);
+            break;
+        }
+    }
+
+    aws_thread_current_sleep(config->duration_ns);
+    aws_atomic_store_int(&benchmark.stop_connecting, 1);
+
+    aws_mutex_lock(&benchmark.mutex);
+    aws_condition_variable_wait_pred(&benchmark.condition_variable, &benchmark.mutex, s_clients_finished, &benchmark);
+    int error_code = benchmark.error_code;
+    aws_mutex_unlock(&benchmark.mutex);
+
+    if (error_code) {
+        aws_raise_error(error_code);
+        goto done;
+    }
+
+    result.operations = aws_atomic_load_int(&benchmark.connections_set_up);
+    result.elapsed_ns = benchmark_now_ns() - start_ns;
+
+    benchmark_report(name, &result);
+    return_code = AWS_OP_SUCCESS;
+
+done:
+    s_server_scaling_clean_up(&benchmark);
+    benchmark_result_clean_up(&result);
+    return return_code;
+}
+
+int benchmark_server_scaling(struct aws_allocator *allocator, const struct benchmark_config *config) {
+    for (size_t loop_count = 1; loop_count <= SERVER_SCALING_MAX_LOOPS; loop_count *= 2) {
+        char name[64];
+        snprintf(name, sizeof(name), "server_scaling_connections/loops=%zu", loop_count);
+        if (!benchmark_should_run(config, name)) {
+            continue;
+        }
+
+        size_t server_loop_count = 0;
+        if (s_run_server_scaling(allocator, config, name, loop_count, &server_loop_count)) {
+            return AWS_OP_ERR;
+        }
+
+        /* out of cores */
+        if (server_loop_count < loop_count) {
+            break;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
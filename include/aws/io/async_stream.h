@@ -0,0 +1,93 @@
+#ifndef AWS_IO_ASYNC_STREAM_H
+#define AWS_IO_ASYNC_STREAM_H
+
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_async_input_stream;
+struct aws_byte_buf;
+struct aws_event_loop;
+struct aws_event_loop_group;
+struct aws_input_stream;
+
+/**
+ * Invoked when a read started by aws_async_input_stream_read() completes. On success, the bytes read have been
+ * appended to the destination buffer and end_of_stream tells whether there is more to come. If error_code is non-zero,
+ * the stream is assumed to be invalid and the contents of the destination buffer beyond its original length are
+ * unspecified. Another read may be started from within this callback.
+ */
+typedef void(aws_async_input_stream_on_read_complete_fn)(
+    struct aws_async_input_stream *stream,
+    int error_code,
+    bool end_of_stream,
+    void *user_data);
+
+struct aws_async_input_stream_vtable {
+    /**
+     * Start reading as much data as will fit into the destination buffer, without blocking the calling thread.
+     * The destination buffer's capacity MUST NOT be changed, and it must stay valid until on_complete is invoked.
+     *
+     * Return AWS_OP_SUCCESS if the read was started, on_complete will then be invoked exactly once, and never from
+     * within this call. At most one read may be in flight at a time.
+     */
+    int (*read)(
+        struct aws_async_input_stream *stream,
+        struct aws_byte_buf *dest,
+        aws_async_input_stream_on_read_complete_fn *on_complete,
+        void *user_data);
+    void (*destroy)(struct aws_async_input_stream *stream);
+};
+
+struct aws_async_input_stream {
+    struct aws_allocator *allocator;
+    void *impl;
+    struct aws_async_input_stream_vtable *vtable;
+};
+
+struct aws_async_input_stream_from_sync_options {
+    /** Synchronous stream to read from. The async stream takes ownership of it and destroys it along with itself. */
+    struct aws_input_stream *source;
+    /**
+     * Event loop group whose threads run the blocking reads of the source. Don't use the group that runs channels,
+     * blocking reads there stall everything else on the loop, which is the point of this stream. A group of a couple of
+     * threads set aside for disk I/O is enough. One of its loops is picked for the stream, so its reads run in order.
+     */
+    struct aws_event_loop_group *io_group;
+    /**
+     * Optional. Event loop to invoke read completions on, e.g. the one of the channel the data is sent through. If
+     * NULL, completions are invoked on the I/O thread the read ran on.
+     */
+    struct aws_event_loop *completion_loop;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Starts a read from a stream. See aws_async_input_stream_vtable.read for the rules.
+ */
+AWS_IO_API int aws_async_input_stream_read(
+    struct aws_async_input_stream *stream,
+    struct aws_byte_buf *dest,
+    aws_async_input_stream_on_read_complete_fn *on_complete,
+    void *user_data);
+
+/**
+ * Tears down the stream. A read must not be in flight.
+ */
+AWS_IO_API void aws_async_input_stream_destroy(struct aws_async_input_stream *stream);
+
+/**
+ * Creates an async stream that runs the reads of a synchronous stream, a file stream for example, on a thread of
+ * options->io_group, so that an event-loop thread serializing a body never waits on disk latency.
+ */
+AWS_IO_API struct aws_async_input_stream *aws_async_input_stream_new_from_sync(
+    struct aws_allocator *allocator,
+    const struct aws_async_input_stream_from_sync_options *options);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_ASYNC_STREAM_H */
@@ -6,6 +6,7 @@
  */
 
 #include <aws/io/io.h>
+#include <aws/io/message_pool.h>
 
 #include <aws/common/statistics.h>
 #include <aws/common/task_scheduler.h>
@@ -23,6 +24,9 @@ struct aws_event_loop_local_object;
 
 typedef void(aws_channel_on_setup_completed_fn)(struct aws_channel *channel, int error_code, void *user_data);
 
+/* Callback called when a channel has arrived on the event loop aws_channel_migrate() moved it to. */
+typedef void(aws_channel_on_migrated_fn)(struct aws_channel *channel, int error_code, void *user_data);
+
 /* Callback called when a channel is completely shutdown. error_code refers to the reason the channel was closed. */
 typedef void(aws_channel_on_shutdown_completed_fn)(struct aws_channel *channel, int error_code, void *user_data);
 
@@ -55,6 +59,10 @@ struct aws_channel_handler_vtable {
      *
      * Also keep in mind that your slot's internal window has been decremented. You'll want to call
      * aws_channel_slot_increment_read_window() at some point in the future if you want to keep receiving data.
+     *
+     * May be NULL for a handler that would only forward read messages as-is: aws_channel_slot_send_message() then
+     * hands them to the next slot to the right directly, still charging this slot's window. The handler keeps getting
+     * window updates and shutdown. The right-most handler can't be a read pass-through.
      */
     int (*process_read_message)(
         struct aws_channel_handler *handler,
@@ -63,6 +71,9 @@ struct aws_channel_handler_vtable {
     /**
      * Called by the channel when a message is available for processing in the write direction. It is your
      * responsibility to call aws_mem_release(message->allocator, message); on message when you are finished with it.
+     *
+     * May be NULL for a handler that would only forward write messages as-is, they then go straight to the next slot
+     * to the left. The left-most handler can't be a write pass-through.
      */
     int (*process_write_message)(
         struct aws_channel_handler *handler,
@@ -119,6 +130,75 @@ struct aws_channel_handler_vtable {
      * associated with the channel's handler chain.
      */
     void (*gather_statistics)(struct aws_channel_handler *handler, struct aws_array_list *stats_list);
+
+    /**
+     * Optional. Called instead of process_read_message when aws_channel_slot_send_messages() delivers several
+     * messages at once. messages holds struct aws_io_message, linked through queueing_handle, in the order they were
+     * read. Your slot's window has been decremented by their combined length. Remove every message you take
+     * ownership of from the list; on a successful return the list must be empty, on error whatever is left stays
+     * with the sender. If NULL, the channel hands the messages to process_read_message one at a time.
+     */
+    int (*process_read_messages)(
+        struct aws_channel_handler *handler,
+        struct aws_channel_slot *slot,
+        struct aws_linked_list *messages);
+
+    /**
+     * Optional. The write direction counterpart of process_read_messages, with the same ownership rules. If NULL, the
+     * channel hands the messages to process_write_message one at a time.
+     */
+    int (*process_write_messages)(
+        struct aws_channel_handler *handler,
+        struct aws_channel_slot *slot,
+        struct aws_linked_list *messages);
+
+    /**
+     * Optional. Called by aws_channel_drain() when the channel should wind down gracefully, such as a server draining
+     * its listener during a rolling restart. A protocol handler would tell its peer to go away (an HTTP/2 GOAWAY, say)
+     * and shut the channel down once in-flight work is done. Handlers without one, like the socket and TLS handlers,
+     * are skipped.
+     */
+    void (*drain)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
+
+    /**
+     * Optional. Called by aws_channel_migrate() on the channel's current thread before anything moves. A handler with
+     * state tied to the event loop, such as an I/O subscription, detaches it here. If it can't move right now, for
+     * instance with I/O in flight, it raises an error and the channel stays where it is. Handlers without one are
+     * assumed to use the loop through channel tasks only, and those move along.
+     */
+    int (*leave_event_loop)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
+
+    /**
+     * Optional. Undoes leave_event_loop once the channel has arrived on its new loop, on that loop's thread, or on the
+     * old loop's thread if a later handler refused to leave. aws_channel_get_event_loop() returns the loop to attach
+     * to. An error shuts the channel down.
+     */
+    int (*join_event_loop)(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
+
+    /**
+     * Optional. Lets the socket handler read straight into memory this handler owns, such as an application's ring
+     * buffer, instead of into a pool message the handler would then copy out of. Point out_buffer's buffer and
+     * capacity at up to max_size bytes of free space (len is ignored), or leave capacity at 0 to take this read as a
+     * message as usual. Every buffer handed out is followed by exactly one call to read_buffer_filled.
+     */
+    void (*acquire_read_buffer)(
+        struct aws_channel_handler *handler,
+        struct aws_channel_slot *slot,
+        size_t max_size,
+        struct aws_byte_buf *out_buffer);
+
+    /**
+     * Required with acquire_read_buffer. Called once the read into the buffer from acquire_read_buffer is done, with
+     * how many bytes landed at its start, possibly 0 if the read failed. Your slot's window has been decremented by
+     * bytes_read, just as for a message of that size. An error shuts the channel down.
+     */
+    int (*read_buffer_filled)(struct aws_channel_handler *handler, struct aws_channel_slot *slot, size_t bytes_read);
+};
+
+/* A task and the channel it runs on, see aws_channel_schedule_task_batch_now(). */
+struct aws_channel_task_batch_entry {
+    struct aws_channel *channel;
+    struct aws_channel_task *task;
 };
 
 struct aws_channel_handler {
@@ -128,6 +208,46 @@ struct aws_channel_handler {
     void *impl;
 };
 
+/**
+ * Sizing of the message pool shared by all channels on one event loop. The pool is created by the first channel set up
+ * on a loop; later channels on that loop reuse it, so their sizing options have no effect.
+ */
+struct aws_channel_message_pool_options {
+    /* Number of max-fragment-size messages the pool retains for reuse. */
+    size_t application_data_msg_count;
+    /* Number of small (128 byte) messages the pool retains for reuse. */
+    size_t small_block_msg_count;
+    /* If true, each retained count grows towards the most messages of that size observed in use at once, up to the
+     * matching max below (or a default, if the max is 0). */
+    bool auto_grow;
+    size_t max_application_data_msg_count;
+    size_t max_small_block_msg_count;
+    /* If non-zero, the pool also keeps power-of-two size classes between the small and max-fragment sizes, each
+     * retaining this many messages (see aws_message_pool_creation_args.size_class_msg_count). */
+    size_t size_class_msg_count;
+    size_t max_size_class_msg_count;
+    /* Whether released messages are wiped. Defaults to AWS_MESSAGE_POOL_ZERO_ALWAYS. */
+    enum aws_message_pool_zero_policy zero_policy;
+    /* Optional. Set the same depot in the options of channels on every loop so that one loop's surplus messages
+     * refill another's pool rather than being freed. It must use the channels' allocator and outlive the event
+     * loops. */
+    struct aws_message_pool_depot *depot;
+    /* If true, the max-fragment-size messages the pool retains are carved from one mapping of 2MB huge pages, where
+     * the OS has them, rather than allocated one by one. See aws_memory_pool_init_from_huge_pages(). */
+    bool use_huge_pages;
+};
+
+/**
+ * How large a share of its event loop's reads a channel gets while several channels on the loop have more data
+ * waiting than they may read at once. Each class is served in turn, but HIGH channels read 4 times as much per turn as
+ * NORMAL ones, and LOW channels a quarter as much.
+ */
+enum aws_channel_read_priority {
+    AWS_CHANNEL_READ_PRIORITY_NORMAL = 0,
+    AWS_CHANNEL_READ_PRIORITY_HIGH,
+    AWS_CHANNEL_READ_PRIORITY_LOW,
+};
+
 /**
  * Args for creating a new channel.
  *  event_loop to use for IO and tasks. on_setup_completed will be invoked when
@@ -148,12 +268,44 @@ struct aws_channel_options {
     void *setup_user_data;
     void *shutdown_user_data;
     bool enable_read_back_pressure;
+    /* Optional. Sizing of the event loop's message pool, if this channel ends up creating it. If NULL,
+     * g_aws_channel_message_pool_options is used. */
+    const struct aws_channel_message_pool_options *message_pool_options;
+    /* Only used with enable_read_back_pressure. Once a slot's window has shrunk to this many bytes, the read window
+     * increments queued up for it are sent upstream. If zero, twice g_aws_channel_max_fragment_size is used. */
+    size_t window_update_batch_emit_threshold;
+    /* Only used with enable_read_back_pressure. If non-zero, window updates are sent upstream at most once per this
+     * many microseconds, and increments that arrive in between are merged into the next update. Useful when the
+     * consumer drains in small chunks. */
+    uint64_t window_update_min_interval_us;
+    /* Optional. If non-zero, this many bytes are allocated along with the channel and handed out as slots and
+     * handler impls through aws_channel_get_arena_allocator(), so a typical pipeline is built without further
+     * allocations. Arena memory is only returned when the channel is freed; what doesn't fit comes from the channel's
+     * allocator as usual. */
+    size_t arena_size;
+    /* Share of the event loop's reads this channel gets when it competes with other busy channels on the loop.
+     * Defaults to AWS_CHANNEL_READ_PRIORITY_NORMAL. See g_aws_channel_read_budget_per_tick. */
+    enum aws_channel_read_priority read_priority;
 };
 
 AWS_EXTERN_C_BEGIN
 
 extern AWS_IO_API size_t g_aws_channel_max_fragment_size;
 
+/**
+ * Message pool sizing used by channels that don't specify aws_channel_options.message_pool_options, which includes
+ * every channel created by the client and server bootstraps. Set it before creating channels.
+ */
+extern AWS_IO_API struct aws_channel_message_pool_options g_aws_channel_message_pool_options;
+
+/**
+ * Bytes an event loop's socket handlers read per tick, all together, on behalf of channels that had more data waiting
+ * than their last read took. Those channels take turns in round-robin order, weighted by their read priority, until
+ * the budget is spent, and the rest wait for the next tick. This bounds how long bulk transfers hold up other channels
+ * on the same loop. Reads made as data arrives are not counted against it. Set it before creating channels.
+ */
+extern AWS_IO_API size_t g_aws_channel_read_budget_per_tick;
+
 /**
  * Initializes channel_task for use.
  */
@@ -193,6 +345,19 @@ void aws_channel_destroy(struct aws_channel *channel);
 AWS_IO_API
 int aws_channel_shutdown(struct aws_channel *channel, int error_code);
 
+/**
+ * Shuts down count channels with error_code, as calling aws_channel_shutdown() on each would, for mass disconnects such
+ * as a loop stopping or a server draining. The channels on each event loop share a single task instead of scheduling
+ * one each, and the steps the channel itself takes between handlers (turning from the read to the write direction, and
+ * invoking the shutdown callback) queue up and run back to back from that task as well. Handlers still take as long as
+ * they need. Channels whose shutdown is already pending are left alone. The channels may be on different event
+ * loops, and none of them can be migrated until they have shut down.
+ *
+ * This function can be called from any thread.
+ */
+AWS_IO_API
+int aws_channel_shutdown_many(struct aws_channel **channels, size_t count, int error_code);
+
 /**
  * Prevent a channel's memory from being freed.
  * Any number of users may acquire a hold to prevent a channel and its handlers from being unexpectedly freed.
@@ -209,15 +374,39 @@ void aws_channel_acquire_hold(struct aws_channel *channel);
 AWS_IO_API
 void aws_channel_release_hold(struct aws_channel *channel);
 
+/**
+ * Returns the allocator handlers should build their impl with when added to this channel. For channels created with
+ * aws_channel_options.arena_size it carves from the channel's arena, otherwise it is the channel's allocator.
+ * Memory from it must not outlive the channel, and it may only be used from the channel's thread. Slots made by
+ * aws_channel_slot_new() come from it too.
+ */
+AWS_IO_API
+struct aws_allocator *aws_channel_get_arena_allocator(struct aws_channel *channel);
+
 /**
  * Allocates and initializes a new slot for use with the channel. If this is the first slot in the channel, it will
  * automatically be added to the channel as the first slot. For all subsequent calls on a given channel, the slot will
  * need to be added to the channel via. the aws_channel_slot_insert_right(), aws_channel_slot_insert_end(), and
  * aws_channel_slot_insert_left() APIs.
+ *
+ * Slots may live inside the channel itself or in its arena, so never free one with aws_mem_release(), even one that
+ * was never inserted: aws_channel_slot_remove() is the only way to dispose of a slot.
  */
 AWS_IO_API
 struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel);
 
+/**
+ * Returns the channel's read priority, see aws_channel_options.read_priority.
+ */
+AWS_IO_API
+enum aws_channel_read_priority aws_channel_get_read_priority(const struct aws_channel *channel);
+
+/**
+ * Changes the channel's read priority, taking effect on its next turn. Must be called from the channel's thread.
+ */
+AWS_IO_API
+void aws_channel_set_read_priority(struct aws_channel *channel, enum aws_channel_read_priority read_priority);
+
 /**
  * Fetches the event loop the channel is a part of.
  */
@@ -268,6 +457,57 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
     enum aws_io_message_type message_type,
     size_t size_hint);
 
+/**
+ * Describes the caller-owned buffers of a message made by aws_channel_acquire_borrowed_message().
+ */
+struct aws_io_message_borrowed_options {
+    /* the payload, in order. The array is copied, the memory it points at is not and must stay valid and unchanged
+     * until on_release is invoked. */
+    const struct aws_byte_cursor *segments;
+    size_t segment_count;
+    /* invoked once the message is released, whether it was written or not. The segments may be reused from then on. */
+    void (*on_release)(void *user_data);
+    void *release_user_data;
+};
+
+/**
+ * Makes an AWS_IO_MESSAGE_BORROWED_DATA message whose payload is options->segments rather than a copy in pooled
+ * memory. Send it in the write direction like any other message; the socket handler hands the segments to the kernel
+ * gathered into as few writes as it can, and the s2n TLS handler encrypts straight from them. on_completion behaves
+ * as for other messages.
+ */
+AWS_IO_API
+struct aws_io_message *aws_channel_acquire_borrowed_message(
+    struct aws_channel *channel,
+    const struct aws_io_message_borrowed_options *options);
+
+/**
+ * Writes message on channel from any thread, without a task per write: it is sent in the write direction on the
+ * channel's thread as though the handler in the channel's last slot had sent it with aws_channel_slot_send_message().
+ * Writes queued before the channel's thread gets to them go down together, and wake it once, along with any tasks
+ * scheduled from other threads meanwhile. Writes from one thread keep their order; there is none between writes
+ * and tasks.
+ *
+ * Message pools belong to the channel's thread, so off that thread message should be one from
+ * aws_channel_acquire_borrowed_message(), which is safe to call from any thread, or one you allocated yourself.
+ *
+ * On success the channel owns message. If it can't be sent once on the channel's thread, because the channel is
+ * shutting down or has no slot left of the last one, message is released and its on_completion invoked with the
+ * error. Fails with AWS_IO_CHANNEL_ERROR_ERROR_CANT_ACCEPT_INPUT once the channel has shut down, in which case
+ * message is still the caller's.
+ */
+AWS_IO_API
+int aws_channel_write_from_any_thread(struct aws_channel *channel, struct aws_io_message *message);
+
+/**
+ * For an AWS_IO_MESSAGE_BORROWED_DATA message, points segments at its payload and returns how many there are.
+ * Returns 0 for any other message.
+ */
+AWS_IO_API
+size_t aws_io_message_get_borrowed_segments(
+    const struct aws_io_message *message,
+    const struct aws_byte_cursor **segments);
+
 /**
  * Schedules a task to run on the event loop as soon as possible.
  * This is the ideal way to move a task into the correct thread. It's also handy for context switches.
@@ -292,6 +532,22 @@ void aws_channel_schedule_task_future(
     struct aws_channel_task *task,
     uint64_t run_at_nanos);
 
+/**
+ * Schedules each entry's task to run on its channel as soon as possible, like aws_channel_schedule_task_now(), for
+ * any number of channels. The tasks headed for the same event loop reach it together, so a producer feeding many
+ * channels wakes each loop once rather than once per channel, and takes none of the channels' locks. Writing
+ * messages to many channels works the same way, from tasks that send them. Entries for channels on the caller's
+ * thread are scheduled as usual. allocator is for the one hand-off per loop. This function is safe to call from any
+ * thread.
+ *
+ * The tasks should not be cleaned up or modified until their functions are executed.
+ */
+AWS_IO_API
+void aws_channel_schedule_task_batch_now(
+    struct aws_allocator *allocator,
+    const struct aws_channel_task_batch_entry *entries,
+    size_t count);
+
 /**
  * Instrument a channel with a statistics handler.  While instrumented with a statistics handler, the channel
  * will periodically report per-channel-handler-specific statistics about handler performance and state.
@@ -306,6 +562,44 @@ void aws_channel_schedule_task_future(
 AWS_IO_API
 int aws_channel_set_statistics_handler(struct aws_channel *channel, struct aws_crt_statistics_handler *handler);
 
+/**
+ * Changes how read window updates are batched on a channel with read back pressure enabled. See
+ * aws_channel_options.window_update_batch_emit_threshold and window_update_min_interval_us; a zero threshold keeps the
+ * current one. Lets channels created by a bootstrap be tuned from their setup callback. Must be called from the
+ * channel's event loop thread. The interval applies from the next update on.
+ */
+AWS_IO_API
+void aws_channel_set_window_update_policy(
+    struct aws_channel *channel,
+    size_t batch_emit_threshold,
+    uint64_t min_interval_us);
+
+/**
+ * Calls drain on every handler that has one, from the right-most slot to the left, so the application protocol hears
+ * first. Does nothing once the channel has started shutting down. Must be called from the channel's thread.
+ */
+AWS_IO_API
+void aws_channel_drain(struct aws_channel *channel);
+
+/**
+ * Moves a quiescent channel to new_loop, another loop of the same event loop group, to even out load between the
+ * loops without dropping the connection. The channel's pending tasks move with it, and its handlers move through
+ * leave_event_loop and join_event_loop. The socket handler refuses while writes are in flight, and on Windows. The
+ * channel must be active and not hold on to any messages from its loop's pool. From then on it uses new_loop's
+ * pool, which is created with g_aws_channel_message_pool_options if new_loop has none yet.
+ *
+ * If a handler refuses, this fails with its error and the channel stays where it was. On success, on_migrated is
+ * invoked on new_loop's thread once the channel has arrived; until then the channel must not be touched from the old
+ * loop's thread. If a handler fails to join the new loop, the channel is shut down, and that error is passed to
+ * on_migrated. Must be called from the channel's thread.
+ */
+AWS_IO_API
+int aws_channel_migrate(
+    struct aws_channel *channel,
+    struct aws_event_loop *new_loop,
+    aws_channel_on_migrated_fn *on_migrated,
+    void *user_data);
+
 /**
  * Returns true if the caller is on the event loop's thread. If false, you likely need to use
  * aws_channel_schedule_task(). This function is safe to call from any thread.
@@ -367,6 +661,41 @@ int aws_channel_slot_send_message(
     struct aws_io_message *message,
     enum aws_channel_direction dir);
 
+/**
+ * Sends a list of messages (struct aws_io_message, linked through queueing_handle) to the adjacent slot in the channel
+ * based on dir, as if each were sent with aws_channel_slot_send_message() in order, but in one call to the handler's
+ * process_read_messages or process_write_messages when it has one. In the read direction the window is checked for
+ * their combined length up front.
+ *
+ * On success the list is empty and the recipient owns every message. On error the messages still in the list remain
+ * the caller's to release; those already removed have been handed over.
+ */
+AWS_IO_API
+int aws_channel_slot_send_messages(
+    struct aws_channel_slot *slot,
+    struct aws_linked_list *messages,
+    enum aws_channel_direction dir);
+
+/**
+ * Asks the first slot to the right that processes reads for up to max_size bytes of its own memory to read into, see
+ * acquire_read_buffer in struct aws_channel_handler_vtable. out_buffer's capacity is 0 if that handler doesn't offer
+ * one, in which case send the data as a message instead. Otherwise the buffer must be passed back through
+ * aws_channel_slot_read_buffer_filled() before anything else is sent in the read direction.
+ */
+AWS_IO_API
+void aws_channel_slot_acquire_read_buffer(
+    struct aws_channel_slot *slot,
+    size_t max_size,
+    struct aws_byte_buf *out_buffer);
+
+/**
+ * Tells the handler that provided a buffer through aws_channel_slot_acquire_read_buffer() that bytes_read bytes were
+ * read into it, charging them against the read windows on the way as aws_channel_slot_send_message() would. If
+ * bytes_read would exceed a window, the buffer is handed back with 0 bytes instead and the error is returned.
+ */
+AWS_IO_API
+int aws_channel_slot_read_buffer_filled(struct aws_channel_slot *slot, size_t bytes_read);
+
 /**
  * Convenience function that invokes aws_channel_acquire_message_from_pool(),
  * asking for the largest reasonable DATA message that can be sent in the write direction,
@@ -414,6 +743,14 @@ size_t aws_channel_slot_downstream_read_window(struct aws_channel_slot *slot);
 AWS_IO_API
 size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot);
 
+/**
+ * Recomputes the upstream message overhead of every slot in the channel. Handlers whose message_overhead() changes
+ * once they are in the channel call this, the slots above them keep the old value otherwise. This must be called
+ * from the channel's thread.
+ */
+AWS_IO_API
+void aws_channel_update_message_overheads(struct aws_channel *channel);
+
 /**
  * Calls destroy on handler's vtable
  */
@@ -5,6 +5,9 @@
  * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
  * SPDX-License-Identifier: Apache-2.0.
  */
+#include <aws/common/hash_table.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/mutex.h>
 #include <aws/common/ref_count.h>
 #include <aws/io/channel.h>
 #include <aws/io/host_resolver.h>
@@ -54,6 +57,51 @@ struct aws_event_loop_group;
  */
 typedef void aws_client_bootstrap_shutdown_complete_fn(void *user_data);
 
+/**
+ * Points in a connection's life reported to an aws_connection_tracer. A client connection goes through DNS (only for a
+ * host name), one CONNECT_START and CONNECT_END per address tried, TLS if it's used, then SETUP_COMPLETE. One taken
+ * from a warm pool only reports CONNECT_END before TLS. A server connection starts at CONNECT_END, when it's accepted.
+ * Once a connection has a channel it ends with CLOSE, otherwise with SETUP_COMPLETE carrying the error. FIRST_BYTE is
+ * the first read off the socket, if there ever is one.
+ */
+enum aws_connection_trace_event_type {
+    AWS_CONNECTION_TRACE_DNS_START,
+    AWS_CONNECTION_TRACE_DNS_END,
+    AWS_CONNECTION_TRACE_CONNECT_START,
+    AWS_CONNECTION_TRACE_CONNECT_END,
+    AWS_CONNECTION_TRACE_TLS_START,
+    AWS_CONNECTION_TRACE_TLS_END,
+    AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+    AWS_CONNECTION_TRACE_FIRST_BYTE,
+    AWS_CONNECTION_TRACE_CLOSE,
+};
+
+struct aws_connection_trace_event {
+    enum aws_connection_trace_event_type type;
+    /* the same for every event of one connection, and not reused until after its last event */
+    const void *connection;
+    /* NULL until the connection has a channel */
+    struct aws_channel *channel;
+    int error_code;
+    /* from aws_channel_current_clock_time() once there's a channel, the high res clock before that */
+    uint64_t timestamp_ns;
+};
+
+/**
+ * Invoked on whichever thread the event happened on, which is the channel's once it has one. event is only valid for
+ * the duration of the call.
+ */
+typedef void(aws_connection_trace_fn)(const struct aws_connection_trace_event *event, void *user_data);
+
+/**
+ * Receives the lifecycle events of every connection made through a bootstrap, see aws_client_bootstrap_set_tracer()
+ * and aws_server_bootstrap_set_tracer(). Without one, each event costs a single branch.
+ */
+struct aws_connection_tracer {
+    aws_connection_trace_fn *on_event;
+    void *user_data;
+};
+
 /**
  * aws_client_bootstrap handles creation and setup of channels that communicate via socket with a specific endpoint.
  */
@@ -63,9 +111,24 @@ struct aws_client_bootstrap {
     struct aws_host_resolver *host_resolver;
     struct aws_host_resolution_config host_resolver_config;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    struct aws_connection_tracer tracer;
     struct aws_ref_count ref_count;
     aws_client_bootstrap_shutdown_complete_fn *on_shutdown_complete;
     void *user_data;
+    uint64_t connection_attempt_delay_ns;
+    /* warm pools added with aws_client_bootstrap_add_warm_pool(), protected by warm_pools_lock */
+    struct aws_linked_list warm_pools;
+    struct aws_mutex warm_pools_lock;
+    /* connection setup limits, see aws_client_bootstrap_options. 0 means unlimited. */
+    size_t max_connection_setups;
+    size_t max_connection_setups_per_host;
+    /* the rest is protected by setup_limit_lock */
+    size_t connection_setups_in_flight;
+    /* aws_string * host name -> count of setups in flight to it, only holds hosts that have any */
+    struct aws_hash_table connection_setups_in_flight_per_host;
+    /* setups waiting for room under the limits, oldest first */
+    struct aws_linked_list queued_connection_setups;
+    struct aws_mutex setup_limit_lock;
 };
 
 /**
@@ -89,6 +152,37 @@ struct aws_client_bootstrap_options {
 
     /* Optional. Passed to callbacks */
     void *user_data;
+
+    /* Optional. When a host resolves to several addresses, connection attempts are started this far apart
+     * (RFC 8305 "Connection Attempt Delay") rather than all at once. 0 means the RFC's recommended 250ms. */
+    uint32_t connection_attempt_delay_ms;
+
+    /* Optional. Most channel setups from aws_client_bootstrap_new_socket_channel() in flight at once, from the call
+     * until its setup_callback. Calls beyond it wait in a FIFO queue and start as earlier setups finish, so a burst
+     * of connections turns into a steady pipeline. 0 means unlimited. */
+    size_t max_connection_setups;
+
+    /* Optional. Like max_connection_setups, but counted per host name. A queued setup waits for room under both.
+     * 0 means unlimited. */
+    size_t max_connection_setups_per_host;
+};
+
+/**
+ * Options for aws_client_bootstrap_add_warm_pool().
+ *
+ * host_name, port - the endpoint to keep connections to. host_name is resolved with the bootstrap's host resolver.
+ * socket_options - must be an AWS_SOCKET_STREAM socket over IPv4 or IPv6. Sockets handed out from the pool were
+ *   created with these options, not with the ones passed to aws_client_bootstrap_new_socket_channel().
+ * size - number of connected sockets to keep in standby.
+ * max_idle_ms - standby sockets connected longer ago than this are closed instead of handed out, since peers and load
+ *   balancers drop idle connections. 0 means no limit.
+ */
+struct aws_client_bootstrap_warm_pool_options {
+    const char *host_name;
+    uint16_t port;
+    const struct aws_socket_options *socket_options;
+    size_t size;
+    uint32_t max_idle_ms;
 };
 
 struct aws_server_bootstrap;
@@ -138,6 +232,16 @@ typedef void(aws_server_bootstrap_on_accept_channel_shutdown_fn)(
 typedef void(
     aws_server_bootstrap_on_server_listener_destroy_fn)(struct aws_server_bootstrap *bootstrap, void *user_data);
 
+/**
+ * Invoked once a listener drained with aws_server_bootstrap_drain_socket_listener() has no channels left open, with
+ * AWS_ERROR_SUCCESS, or when the drain deadline passes first, with AWS_IO_CHANNEL_DRAIN_TIMEOUT. Invoked on the
+ * listener's event-loop thread. The listener's destroy callback still follows once everything is cleaned up.
+ */
+typedef void(aws_server_bootstrap_on_listener_drained_fn)(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    void *user_data);
+
 /**
  * aws_server_bootstrap manages listening sockets, creating and setting up channels to handle each incoming connection.
  */
@@ -145,9 +249,42 @@ struct aws_server_bootstrap {
     struct aws_allocator *allocator;
     struct aws_event_loop_group *event_loop_group;
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated;
+    struct aws_connection_tracer tracer;
     struct aws_ref_count ref_count;
 };
 
+/**
+ * When each phase of a client channel setup happened, as high res clock timestamps in nanoseconds. Phases that didn't
+ * happen, such as DNS for a local socket or TLS for a plain connection, are left 0.
+ */
+struct aws_client_connection_timing {
+    /* aws_client_bootstrap_new_socket_channel() was called */
+    uint64_t requested_ns;
+    /* the setup got its turn under the bootstrap's max_connection_setups, the same as requested_ns if it didn't wait */
+    uint64_t started_ns;
+    uint64_t dns_start_ns;
+    uint64_t dns_end_ns;
+    /* connection attempts started, one per address tried */
+    uint32_t connect_attempt_count;
+    uint64_t first_connect_start_ns;
+    /* the attempt the channel was set up on connected */
+    uint64_t connected_ns;
+    uint64_t tls_start_ns;
+    uint64_t tls_end_ns;
+    /* right before setup_callback */
+    uint64_t setup_complete_ns;
+};
+
+/**
+ * Reports how long a client channel setup spent in each phase, see aws_socket_channel_bootstrap_options.
+ * timing is only valid for the duration of the call.
+ */
+typedef void(aws_client_bootstrap_on_connection_timing_fn)(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    const struct aws_client_connection_timing *timing,
+    void *user_data);
+
 /**
  * Socket-based channel creation options.
  *
@@ -163,6 +300,12 @@ struct aws_server_bootstrap {
  * setup_callback - callback invoked once the channel is ready for use and TLS has been negotiated or if an error
  *   is encountered
  * shutdown_callback - callback invoked once the channel has shutdown.
+ * idle_timeout_ms - (optional) shut the channel down with AWS_IO_CHANNEL_IDLE_TIMEOUT once nothing has been read from
+ *   or written to its socket for this long. 0 disables it. See aws_socket_handler_set_idle_timeout().
+ * write_coalescing_threshold - (optional) coalesce the channel's socket writes up to this many bytes per event loop
+ *   tick. 0 disables it. See aws_socket_handler_set_write_coalescing().
+ * timing_callback - (optional) callback invoked right before setup_callback, with the same error code and the time
+ *   each phase of the setup happened.
  *
  * Immediately after the `shutdown_callback` returns, the channel is cleaned up automatically. All callbacks are invoked
  * in the thread of the event-loop that the new channel is assigned to.
@@ -177,7 +320,13 @@ struct aws_socket_channel_bootstrap_options {
     aws_client_bootstrap_on_channel_event_fn *creation_callback;
     aws_client_bootstrap_on_channel_event_fn *setup_callback;
     aws_client_bootstrap_on_channel_event_fn *shutdown_callback;
+    aws_client_bootstrap_on_connection_timing_fn *timing_callback;
     bool enable_read_back_pressure;
+    uint32_t idle_timeout_ms;
+    size_t write_coalescing_threshold;
+    /* If non-zero, each channel is created with this aws_channel_options.arena_size, and the socket, TLS and ALPN
+     * handlers it sets up are carved from that arena. */
+    size_t channel_arena_size;
     void *user_data;
 };
 
@@ -206,6 +355,35 @@ struct aws_server_socket_channel_bootstrap_options {
     aws_server_bootstrap_on_accept_channel_shutdown_fn *shutdown_callback;
     aws_server_bootstrap_on_server_listener_destroy_fn *destroy_callback;
     bool enable_read_back_pressure;
+    /* If set, opens one SO_REUSEPORT listener per event loop in the bootstrap's group instead of a single one. The
+     * kernel then balances incoming connections across the loops, and each channel stays on the loop that accepted
+     * it. Needs a non-local socket and a non-zero port. The returned socket stands for all of them: destroying it
+     * destroys every listener.
+     *
+     * This is the shared-nothing mode: each listener keeps the books on its own channels, so accepting, setting up
+     * and closing a channel only lock state of the loop it runs on, and channels get their messages from that loop's
+     * pool. Pair it with aws_event_loop_group_new_default_pinned_to_cpu_group() to pin each loop to a core. */
+    bool listener_per_event_loop;
+    /* If non-zero, each accepted channel is shut down with AWS_IO_CHANNEL_IDLE_TIMEOUT once nothing has been read from
+     * or written to its socket for this long. See aws_socket_handler_set_idle_timeout(). */
+    uint32_t idle_timeout_ms;
+    /* If non-zero, each accepted channel coalesces its socket writes up to this many bytes per event loop tick. See
+     * aws_socket_handler_set_write_coalescing(). */
+    size_t write_coalescing_threshold;
+    /* If non-zero, each channel is created with this aws_channel_options.arena_size, and the socket, TLS and ALPN
+     * handlers it sets up are carved from that arena. */
+    size_t channel_arena_size;
+    void *user_data;
+};
+
+/**
+ * How aws_server_bootstrap_drain_socket_listener() winds a listener's channels down.
+ */
+struct aws_server_bootstrap_drain_options {
+    /* If non-zero, channels still open this long after the drain started are shut down with
+     * AWS_IO_CHANNEL_DRAIN_TIMEOUT, and on_drained is invoked right away. Zero waits for as long as they take. */
+    uint32_t timeout_ms;
+    aws_server_bootstrap_on_listener_drained_fn *on_drained;
     void *user_data;
 };
 
@@ -238,11 +416,37 @@ AWS_IO_API int aws_client_bootstrap_set_alpn_callback(
     struct aws_client_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Reports the lifecycle of every connection the bootstrap sets up to tracer, which is copied. NULL removes it. Not
+ * synchronized with connections in progress, so set it before making any.
+ */
+AWS_IO_API void aws_client_bootstrap_set_tracer(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_connection_tracer *tracer);
+
 /**
  * Sets up a client socket channel.
+ * When host_name resolves to several addresses, connections are raced Happy Eyeballs style (RFC 8305): IPv6 and IPv4
+ * addresses are interleaved and each attempt starts connection_attempt_delay_ms after the previous one, or as soon as
+ * it fails. The first socket to connect is used and the attempts still in flight are abandoned.
+ * If the bootstrap has a warm pool for host_name:port with a socket in standby, the channel is built on that socket
+ * and skips host resolution and connecting. TLS, if requested, is still negotiated.
  */
 AWS_IO_API int aws_client_bootstrap_new_socket_channel(struct aws_socket_channel_bootstrap_options *options);
 
+/**
+ * Keeps options->size TCP connections to options->host_name:options->port open in the background, so that
+ * aws_client_bootstrap_new_socket_channel() calls for that endpoint can take one instead of waiting for DNS and a
+ * connect. Whenever a socket is handed out (or found too old) the pool is topped back up. Sockets are spread across the
+ * bootstrap's event loops. The pool lives as long as the bootstrap.
+ *
+ * Only one pool per endpoint is allowed, and only raw sockets are pooled: TLS handshakes happen once a socket is handed
+ * out, so they are tied to the caller's tls_options. Use a ctx with a session cache to keep those cheap.
+ */
+AWS_IO_API int aws_client_bootstrap_add_warm_pool(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_client_bootstrap_warm_pool_options *options);
+
 /**
  * Initializes the server bootstrap with `allocator` and `el_group`. This object manages listeners, server connections,
  * and channels.
@@ -271,6 +475,14 @@ AWS_IO_API int aws_server_bootstrap_set_alpn_callback(
     struct aws_server_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated);
 
+/**
+ * Reports the lifecycle of every connection accepted through the bootstrap to tracer, which is copied. NULL removes
+ * it. Not synchronized with listeners that are already open, so set it before opening any.
+ */
+AWS_IO_API void aws_server_bootstrap_set_tracer(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_connection_tracer *tracer);
+
 /**
  * Sets up a server socket listener. If you are planning on using TLS, use
  * `aws_server_bootstrap_new_tls_socket_listener` instead. This creates a socket listener bound to `local_endpoint`
@@ -297,6 +509,24 @@ AWS_IO_API void aws_server_bootstrap_destroy_socket_listener(
     struct aws_server_bootstrap *bootstrap,
     struct aws_socket *listener);
 
+/**
+ * Gracefully shuts down 'listener', for use instead of aws_server_bootstrap_destroy_socket_listener(): it stops
+ * accepting, destroys the listener the same way, and calls aws_channel_drain() on each of its channels on their own
+ * threads, so their protocol handlers can tell peers to go away. Channels still being set up are drained once their
+ * incoming callback has run. on_drained fires once they have all shut down, or at the deadline. Fails with
+ * AWS_ERROR_INVALID_STATE if the listener is already draining. This function can be called from any thread.
+ */
+AWS_IO_API int aws_server_bootstrap_drain_socket_listener(
+    struct aws_server_bootstrap *bootstrap,
+    struct aws_socket *listener,
+    const struct aws_server_bootstrap_drain_options *options);
+
+/**
+ * Returns how many channels accepted by 'listener' are set up or being set up and have not yet shut down. This
+ * function can be called from any thread, and after the listener was destroyed until its destroy callback fires.
+ */
+AWS_IO_API size_t aws_server_bootstrap_get_open_channel_count(struct aws_socket *listener);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_CHANNEL_BOOTSTRAP_H */
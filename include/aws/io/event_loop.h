@@ -8,6 +8,7 @@
 
 #include <aws/common/atomics.h>
 #include <aws/common/hash_table.h>
+#include <aws/common/mutex.h>
 #include <aws/common/ref_count.h>
 #include <aws/io/io.h>
 
@@ -21,6 +22,7 @@ enum aws_io_event_type {
 
 struct aws_event_loop;
 struct aws_task;
+struct aws_thread_options;
 
 #if AWS_USE_IO_COMPLETION_PORTS
 #    include <Windows.h>
@@ -80,15 +82,118 @@ struct aws_event_loop_vtable {
     bool (*is_on_callers_thread)(struct aws_event_loop *event_loop);
 };
 
+/**
+ * Snapshot of the cheap load signals an event loop records once per tick.
+ * See aws_event_loop_get_load_metrics().
+ */
+struct aws_event_loop_load_metrics {
+    /* Nanoseconds the most recent tick spent processing I/O events and tasks. */
+    uint64_t last_tick_duration_ns;
+    /* Nanoseconds the event-thread spent blocked in the wait preceding the most recent tick. */
+    uint64_t last_wait_duration_ns;
+    /* Number of I/O events (or completions) dispatched during the most recent tick. */
+    size_t last_tick_io_event_count;
+    /* Number of handles currently subscribed to (or connected to) the event loop. */
+    size_t subscribed_handle_count;
+    /* Nanoseconds spent busy during the most recently completed one second window. */
+    size_t load_factor;
+};
+
+/* The most work items a slow tick report names. */
+#define AWS_EVENT_LOOP_PROFILER_SLOWEST_COUNT 8
+
+/**
+ * One piece of work the profiler timed: a channel task, named by its type_tag, or an I/O event callback, named
+ * "io_event".
+ */
+struct aws_event_loop_profiler_entry {
+    const char *type_tag;
+    uint64_t duration_ns;
+};
+
+/**
+ * What a tick that went over the profiler's threshold spent its time on.
+ */
+struct aws_event_loop_slow_tick_report {
+    uint64_t tick_duration_ns;
+    size_t io_event_count;
+    /* the slowest work of the tick, slowest first. Event loop tasks that aren't channel tasks aren't timed, so these
+     * may not add up to the tick's duration. */
+    const struct aws_event_loop_profiler_entry *slowest;
+    size_t slowest_count;
+};
+
+/**
+ * Totals for one task type since the profiler was enabled, see aws_event_loop_profiler_for_each_type().
+ */
+struct aws_event_loop_task_type_stats {
+    const char *type_tag;
+    uint64_t run_count;
+    uint64_t total_duration_ns;
+    uint64_t max_duration_ns;
+};
+
+typedef void(aws_event_loop_on_slow_tick_fn)(
+    struct aws_event_loop *event_loop,
+    const struct aws_event_loop_slow_tick_report *report,
+    void *user_data);
+
+typedef void(aws_event_loop_on_task_type_stats_fn)(
+    const struct aws_event_loop_task_type_stats *stats,
+    void *user_data);
+
+struct aws_event_loop_profiler_options {
+    /* Ticks that take at least this long are reported to on_slow_tick. 0 reports none, only keeping per type totals. */
+    uint64_t slow_tick_threshold_ns;
+    aws_event_loop_on_slow_tick_fn *on_slow_tick;
+    void *user_data;
+};
+
+struct aws_event_loop_profiler;
+
+struct aws_event_loop_local_object;
+
+/**
+ * Local object slots the library reserves for objects it looks up on hot paths, such as every channel setup. A slot
+ * is a plain array entry on the event loop, so fetching it is a single load instead of a hash table lookup.
+ */
+enum aws_event_loop_local_slot {
+    /* the message pool shared by the loop's channels */
+    AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL,
+    /* marks that s2n's thread-local state is cleaned up when the loop's thread exits */
+    AWS_EVENT_LOOP_LOCAL_SLOT_TLS_THREAD_CLEANUP,
+    /* the queue of socket handlers taking turns at reading, see g_aws_channel_read_budget_per_tick */
+    AWS_EVENT_LOOP_LOCAL_SLOT_SOCKET_READ_SCHEDULER,
+    AWS_EVENT_LOOP_LOCAL_SLOT_COUNT,
+};
+
 struct aws_event_loop {
     struct aws_event_loop_vtable *vtable;
     struct aws_allocator *alloc;
     aws_io_clock_fn *clock;
     struct aws_hash_table local_data;
+    /* see aws_event_loop_get_local_slot(). Only touched by the event-thread. */
+    struct aws_event_loop_local_object *local_slots[AWS_EVENT_LOOP_LOCAL_SLOT_COUNT];
+    /* Load signals. The atomics are written by the event-thread and may be read from any thread. */
+    struct {
+        struct aws_atomic_var load_factor;
+        struct aws_atomic_var next_flush_time_secs;
+        struct aws_atomic_var last_tick_duration_ns;
+        struct aws_atomic_var last_wait_duration_ns;
+        struct aws_atomic_var last_tick_io_event_count;
+        struct aws_atomic_var subscribed_handle_count;
+        /* Only touched by the event-thread. */
+        uint64_t latest_tick_start;
+        uint64_t latest_tick_end;
+        size_t current_tick_latency_sum;
+    } load;
+    /* this loop's counts for the metrics registry, see aws_io_metrics_set_enabled() */
+    struct aws_io_metrics_shard *metrics_shard;
+    /* NULL unless aws_event_loop_enable_profiler() was called. Only touched by the event-thread. */
+    struct aws_event_loop_profiler *profiler;
     void *impl_data;
 };
 
-struct aws_event_loop_local_object;
 typedef void(aws_event_loop_on_local_object_removed_fn)(struct aws_event_loop_local_object *);
 
 struct aws_event_loop_local_object {
@@ -100,10 +205,84 @@ struct aws_event_loop_local_object {
 typedef struct aws_event_loop *(
     aws_new_event_loop_fn)(struct aws_allocator *alloc, aws_io_clock_fn *clock, void *new_loop_user_data);
 
+/**
+ * Configuration for an event loop created by aws_event_loop_new_default_with_options().
+ */
+struct aws_event_loop_options {
+    /**
+     * Clock used by the event loop for task scheduling. Required.
+     */
+    aws_io_clock_fn *clock;
+
+    /**
+     * Number of I/O events fetched from the operating system per tick of the event loop. If 0, the platform default is
+     * used. When more handles than this are ready at once, their events are spread over several ticks.
+     *
+     * Currently only honored by the epoll and IOCP event loops. IOCP counts completion packets rather than events.
+     */
+    size_t events_per_tick;
+
+    /**
+     * If true, the event batch starts at events_per_tick and doubles whenever a tick fills it, up to
+     * max_events_per_tick. It shrinks back towards events_per_tick once the loop has been mostly idle for a while.
+     */
+    bool adaptive_events_per_tick;
+
+    /**
+     * Upper bound for the event batch in adaptive mode. If 0, a default is used. Ignored if adaptive_events_per_tick
+     * is false.
+     */
+    size_t max_events_per_tick;
+
+    /**
+     * If non-zero, the loop busy-polls for up to this many microseconds before blocking: it polls for I/O without
+     * waiting and checks for tasks scheduled from other threads, which then skip the wakeup write. This trades a
+     * spinning cpu for shorter wakeups, so only use it with loops pinned to dedicated cores (see thread_options).
+     *
+     * Currently only honored by the epoll event loop.
+     */
+    uint32_t busy_poll_spin_us;
+
+    /**
+     * If true, tasks scheduled at least 10ms into the future go into a timer wheel with O(1) scheduling and
+     * cancellation instead of the task scheduler's heap. They then run up to 1ms late, which suits timeouts, retries
+     * and other coarse timers, and helps loops that keep a timer per connection for many thousands of connections.
+     *
+     * Currently only honored by the epoll event loop.
+     */
+    bool use_timer_wheel;
+
+    /**
+     * Options for the event loop's thread, such as the cpu to pin it to. If NULL, the platform defaults are used.
+     */
+    const struct aws_thread_options *thread_options;
+};
+
+/**
+ * How aws_event_loop_group_get_next_loop() picks a loop.
+ */
+enum aws_event_loop_selection_policy {
+    /* Hand out loops in order, ignoring load. */
+    AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN,
+    /* Sample two loops at random and pick the less loaded of the two. */
+    AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES,
+    /* Scan every loop and pick the least loaded one. */
+    AWS_EVENT_LOOP_SELECTION_LEAST_LOADED,
+};
+
 struct aws_event_loop_group {
     struct aws_allocator *allocator;
+    /* one entry per loop the group may have, NULL for those a lazy group hasn't started yet */
     struct aws_array_list event_loops;
+    /* the event_loops entries that are running, from the front. All of them unless the group is lazy. */
+    struct aws_atomic_var started_loop_count;
+    /* set for groups from aws_event_loop_group_new_default_lazy() */
+    bool is_lazy;
+    /* serializes starting loops in a lazy group */
+    struct aws_mutex lazy_start_lock;
     struct aws_atomic_var current_index;
+    struct aws_atomic_var selection_policy;
+    struct aws_atomic_var selection_seed;
     struct aws_ref_count ref_count;
     struct aws_shutdown_callback_options shutdown_options;
 };
@@ -134,6 +313,29 @@ void aws_overlapped_reset(struct aws_overlapped *overlapped);
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, aws_io_clock_fn *clock);
 
+/**
+ * Creates an instance of the default event loop implementation for the current architecture and operating system,
+ * using the supplied options.
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_default_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options);
+
+#ifdef AWS_USE_IO_URING
+/**
+ * Creates an instance of the io_uring based event loop (Linux 5.13+). It honors the same readiness-based contract as
+ * the default epoll loop, but batches subscription changes with the wait for events so each tick costs a single
+ * syscall. Pass a function calling this to aws_event_loop_group_new() to use it for a whole group.
+ *
+ * Fails with AWS_ERROR_PLATFORM_NOT_SUPPORTED if the running kernel lacks the required io_uring features, or doesn't
+ * let this process use io_uring (a seccomp profile or kernel.io_uring_disabled), in which case callers should fall
+ * back to aws_event_loop_new_default().
+ */
+AWS_IO_API
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock);
+#endif /* AWS_USE_IO_URING */
+
 /**
  * Invokes the destroy() fn for the event loop implementation.
  * If the event loop is still in a running state, this function will block waiting on the event loop to shutdown.
@@ -151,6 +353,75 @@ void aws_event_loop_destroy(struct aws_event_loop *event_loop);
 AWS_IO_API
 int aws_event_loop_init_base(struct aws_event_loop *event_loop, struct aws_allocator *alloc, aws_io_clock_fn *clock);
 
+/**
+ * Marks the start of a tick: the event-thread has returned from its wait and is about to process I/O events and tasks.
+ * This is only called from the event-thread of event loop implementations.
+ */
+AWS_IO_API
+void aws_event_loop_register_tick_start(struct aws_event_loop *event_loop);
+
+/**
+ * Marks the end of a tick, recording how long it took and how many I/O events it dispatched.
+ * This is only called from the event-thread of event loop implementations, right before it waits again.
+ */
+AWS_IO_API
+void aws_event_loop_register_tick_end(struct aws_event_loop *event_loop, size_t io_event_count);
+
+/**
+ * Starts timing the channel tasks and I/O event callbacks the loop runs: per task type totals, and a report of the
+ * slowest work of every tick that goes over options->slow_tick_threshold_ns. Enabling it again replaces the options
+ * and starts the totals over. Costs two clock reads per timed item while enabled, one branch when not.
+ * Must be called from the event-thread, e.g. from a task scheduled on the loop.
+ */
+AWS_IO_API
+int aws_event_loop_enable_profiler(
+    struct aws_event_loop *event_loop,
+    const struct aws_event_loop_profiler_options *options);
+
+/**
+ * Stops the profiler and drops its totals. Safe to call from on_slow_tick. Must be called from the event-thread.
+ */
+AWS_IO_API
+void aws_event_loop_disable_profiler(struct aws_event_loop *event_loop);
+
+/**
+ * Calls on_stats with the totals of every task type the profiler has timed, in no particular order. Must be called
+ * from the event-thread.
+ */
+AWS_IO_API
+void aws_event_loop_profiler_for_each_type(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_on_task_type_stats_fn *on_stats,
+    void *user_data);
+
+/**
+ * Returns the time to pass to aws_event_loop_profiler_end() after running an item of work, or 0 if the profiler is
+ * off. For event loop implementations and whatever dispatches work on the event-thread.
+ */
+AWS_IO_API
+uint64_t aws_event_loop_profiler_begin(struct aws_event_loop *event_loop);
+
+/**
+ * Records an item of work started at start_ns, which came from aws_event_loop_profiler_begin(). type_tag must live as
+ * long as the loop, like a task's type_tag does.
+ */
+AWS_IO_API
+void aws_event_loop_profiler_end(struct aws_event_loop *event_loop, const char *type_tag, uint64_t start_ns);
+
+/**
+ * Returns the number of nanoseconds the event loop spent busy during the last completed one second window.
+ * Returns 0 if the loop has not completed a tick recently. This function is thread-safe.
+ */
+AWS_IO_API
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop);
+
+/**
+ * Copies the event loop's most recent load signals into `metrics`. This function is thread-safe; the individual
+ * values are read independently, so they may straddle a tick boundary.
+ */
+AWS_IO_API
+void aws_event_loop_get_load_metrics(struct aws_event_loop *event_loop, struct aws_event_loop_load_metrics *metrics);
+
 /**
  * Common cleanup code for all implementations.
  * This is only called from the *destroy() function of event loop implementations.
@@ -188,6 +459,26 @@ int aws_event_loop_remove_local_object(
     void *key,
     struct aws_event_loop_local_object *removed_obj);
 
+/**
+ * Returns the object in one of the event-loop's reserved local slots, or NULL if the slot is empty. This function is
+ * not thread safe and should be called inside the event-loop's thread.
+ */
+AWS_IO_API
+struct aws_event_loop_local_object *aws_event_loop_get_local_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_slot slot);
+
+/**
+ * Puts obj in one of the event-loop's reserved local slots, replacing whatever was there without notifying it. NULL
+ * empties the slot. obj must live until it is replaced, or until the event loop is destroyed, which invokes its
+ * on_object_removed. This function is not thread safe and should be called inside the event-loop's thread.
+ */
+AWS_IO_API
+void aws_event_loop_set_local_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_slot slot,
+    struct aws_event_loop_local_object *obj);
+
 /**
  * Triggers the running of the event loop. This function must not block. The event loop is not active until this
  * function is invoked. This function can be called again on an event loop after calling aws_event_loop_stop() and
@@ -338,6 +629,45 @@ struct aws_event_loop_group *aws_event_loop_group_new_default(
     uint16_t max_threads,
     const struct aws_shutdown_callback_options *shutdown_options);
 
+/**
+ * Same as aws_event_loop_group_new_default(), but no loop is created until it is first asked for, so startup costs
+ * (a thread, an epoll or kqueue descriptor, a wakeup descriptor per loop) are paid for the loops actually used rather
+ * than one per core up front: each call to aws_event_loop_group_get_next_loop() starts one more loop until max_threads
+ * are running, and aws_event_loop_group_get_loop_at() starts the loops up to the one asked for. Suits short-lived
+ * processes that only ever make a connection or two.
+ */
+AWS_IO_API
+struct aws_event_loop_group *aws_event_loop_group_new_default_lazy(
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    const struct aws_shutdown_callback_options *shutdown_options);
+
+/**
+ * Initializes an event loop group with platform defaults, pinning each loop's thread to its own cpu within
+ * `cpu_group` (a NUMA node). Cpus suspected to be hyper-threads are skipped. If max_threads == 0, the loop count will
+ * be the number of usable cpus in the group; otherwise at most max_threads loops are created.
+ *
+ * Since each thread (and the per-loop objects it creates, such as the channel message pool) stays on one node, memory
+ * first touched by a loop is allocated node-locally by the operating system.
+ */
+AWS_IO_API
+struct aws_event_loop_group *aws_event_loop_group_new_default_pinned_to_cpu_group(
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    uint16_t cpu_group,
+    const struct aws_shutdown_callback_options *shutdown_options);
+
+/**
+ * Initializes an event loop group with platform defaults and one loop per entry of `cpu_ids`, with the thread of loop
+ * `i` pinned to cpu `cpu_ids[i]`.
+ */
+AWS_IO_API
+struct aws_event_loop_group *aws_event_loop_group_new_default_pinned_to_cpus(
+    struct aws_allocator *alloc,
+    const int32_t *cpu_ids,
+    uint16_t cpu_count,
+    const struct aws_shutdown_callback_options *shutdown_options);
+
 /**
  * Increments the reference count on the event loop group, allowing the caller to take a reference to it.
  *
@@ -353,20 +683,45 @@ struct aws_event_loop_group *aws_event_loop_group_acquire(struct aws_event_loop_
 AWS_IO_API
 void aws_event_loop_group_release(struct aws_event_loop_group *el_group);
 
+/**
+ * Returns the loop at index, starting it (along with any before it) first in a lazy group. Returns NULL if index is out
+ * of range or the loop couldn't be started.
+ */
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_group_get_loop_at(struct aws_event_loop_group *el_group, size_t index);
 
+/**
+ * Returns how many loops the group has, counting those a lazy group hasn't started yet.
+ */
 AWS_IO_API
 size_t aws_event_loop_group_get_loop_count(struct aws_event_loop_group *el_group);
 
+/**
+ * Returns how many of the group's loops are running. Only differs from aws_event_loop_group_get_loop_count() for a
+ * lazy group. This function is thread-safe.
+ */
+AWS_IO_API
+size_t aws_event_loop_group_get_started_loop_count(struct aws_event_loop_group *el_group);
+
 /**
  * Fetches the next loop for use. The purpose is to enable load balancing across loops. You should not depend on how
- * this load balancing is done as it is subject to change in the future. Currently it just returns them round-robin
- * style.
+ * this load balancing is done as it is subject to change in the future. By default it returns them round-robin
+ * style; see aws_event_loop_group_set_selection_policy(). A lazy group starts and returns a new loop instead, for as
+ * long as it has loops left to start. If a lazy group can't start its first loop, this returns NULL with the error
+ * raised.
  */
 AWS_IO_API
 struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group);
 
+/**
+ * Sets the policy aws_event_loop_group_get_next_loop() uses to pick a loop. This is what client bootstraps use to place
+ * new connections and server bootstraps use to place accepted sockets. This function is thread-safe.
+ */
+AWS_IO_API
+void aws_event_loop_group_set_selection_policy(
+    struct aws_event_loop_group *el_group,
+    enum aws_event_loop_selection_policy policy);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_EVENT_LOOP_H */
@@ -67,6 +67,54 @@ int aws_fseek(FILE *file, aws_off_t offset, int whence);
 AWS_IO_API
 int aws_file_get_length(FILE *file, int64_t *length);
 
+/**
+ * One entry of a directory, as passed to aws_directory_entry_fn. The cursors are only good for the duration of the
+ * callback.
+ */
+struct aws_directory_entry {
+    /* the directory's path, a separator, then name */
+    struct aws_byte_cursor path;
+    struct aws_byte_cursor name;
+    bool is_directory;
+    bool is_file;
+};
+
+/**
+ * Invoked for each entry of a directory. Return false to stop iterating.
+ */
+typedef bool(aws_directory_entry_fn)(const struct aws_directory_entry *entry, void *user_data);
+
+/**
+ * Invokes on_entry for every entry of the directory at 'path' other than "." and "..", in no particular order, without
+ * descending into subdirectories. Stopping early is not an error. Whether an entry is a file or directory comes from
+ * the directory listing itself where the file system provides it, so most entries cost no extra stat.
+ */
+AWS_IO_API
+int aws_directory_for_each_entry(
+    struct aws_allocator *allocator,
+    const char *path,
+    aws_directory_entry_fn *on_entry,
+    void *user_data);
+
+/**
+ * Reads each of the 'count' files named in 'file_names' into the matching element of 'out_bufs', with the same
+ * result aws_byte_buf_init_from_file() would give, null terminator included. The files are spread over up to
+ * 'thread_count' threads, counting the calling one, with 0 picking the processor count. Each file is sized once and
+ * read with positional reads straight into a buffer of exactly that size.
+ *
+ * out_error_codes, if not NULL, gets AWS_ERROR_SUCCESS or the error for each file. The buffers of files that failed are
+ * left zeroed and the others must be cleaned up by the caller even when this fails. Returns AWS_OP_ERR, raising the
+ * error of the first file that failed, if any did.
+ */
+AWS_IO_API
+int aws_byte_bufs_init_from_files(
+    struct aws_allocator *allocator,
+    const char *const *file_names,
+    size_t count,
+    size_t thread_count,
+    struct aws_byte_buf *out_bufs,
+    int *out_error_codes);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_FILE_UTILS_H */
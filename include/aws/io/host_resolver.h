@@ -8,7 +8,9 @@
 #include <aws/common/ref_count.h>
 #include <aws/io/io.h>
 
+struct aws_event_loop;
 struct aws_event_loop_group;
+struct aws_socket_endpoint;
 
 enum aws_address_record_type {
     /* ipv4 address. */
@@ -37,6 +39,8 @@ struct aws_host_address {
     size_t use_count;
     /* give a hint on when to remove a bad host from service. */
     size_t connection_failure_count;
+    /* smoothed connect round trip reported through aws_host_resolver_record_connection_success(), 0 until one is. */
+    uint64_t connect_latency_ns;
     /* we don't implement this yet, but we will asap. */
     uint8_t weight;
 };
@@ -66,10 +70,42 @@ typedef int(aws_resolve_host_implementation_fn)(
     struct aws_array_list *output_addresses,
     void *user_data);
 
+/**
+ * How the default resolver picks which of a host's cached addresses to hand out.
+ */
+enum aws_host_address_selection {
+    /* rotate through the addresses, least recently used first */
+    AWS_HOST_ADDRESS_SELECTION_LEAST_RECENTLY_USED = 0,
+    /*
+     * hand out the address with the lowest connect latency recorded for it, one never measured going first. Every
+     * eighth pick still takes the next address in rotation, so a slow address that recovers gets noticed.
+     */
+    AWS_HOST_ADDRESS_SELECTION_LOWEST_LATENCY,
+};
+
 struct aws_host_resolution_config {
     aws_resolve_host_implementation_fn *impl;
     size_t max_ttl;
     void *impl_data;
+    /*
+     * Seconds to remember that a host failed to resolve (NXDOMAIN, SERVFAIL, ...) while it has no addresses, during
+     * which queries for it fail right away with the same error instead of waiting on another attempt. 0 disables it.
+     */
+    size_t negative_ttl;
+    /* fixed by the query that creates the host's entry, like the rest of the config. */
+    enum aws_host_address_selection address_selection;
+};
+
+/**
+ * Counters a resolver keeps over its lifetime, for checking that concurrent queries for a host share one lookup.
+ */
+struct aws_host_resolver_stats {
+    /* queries that had nothing to wait on and had a lookup done for them. */
+    size_t fresh_resolutions;
+    /* queries that joined others already waiting on the same host and were answered by that lookup. */
+    size_t coalesced_resolutions;
+    /* queries failed straight from the negative cache. */
+    size_t negative_cache_hits;
 };
 
 struct aws_host_listener;
@@ -106,6 +142,61 @@ struct aws_host_resolver_vtable {
 
     /** removes a host listener from the host resolver and frees it. */
     int (*remove_host_listener)(struct aws_host_resolver *resolver, struct aws_host_listener *listener);
+
+    /** fills out_stats with the resolver's counters. */
+    int (*get_stats)(struct aws_host_resolver *resolver, struct aws_host_resolver_stats *out_stats);
+
+    /** resolve_host, but res must be invoked from event_loop's thread. */
+    int (*resolve_host_on_event_loop)(
+        struct aws_host_resolver *resolver,
+        const struct aws_string *host_name,
+        aws_on_host_resolved_result_fn *res,
+        struct aws_host_resolution_config *config,
+        struct aws_event_loop *event_loop,
+        void *user_data);
+
+    /** resolve_host for every host in host_names at once. res is invoked once per host, failures included. */
+    int (*resolve_hosts)(
+        struct aws_host_resolver *resolver,
+        const struct aws_string *const *host_names,
+        size_t host_count,
+        aws_on_host_resolved_result_fn *res,
+        struct aws_host_resolution_config *config,
+        void *user_data);
+
+    /** adds addresses (struct aws_host_address) for host_name to the cache, creating its entry if needed. */
+    int (*seed_host)(
+        struct aws_host_resolver *resolver,
+        const struct aws_string *host_name,
+        const struct aws_array_list *addresses,
+        struct aws_host_resolution_config *config);
+
+    /** appends a copy of every cached address (struct aws_host_address) to out_addresses, grouped by host. */
+    int (*copy_cached_addresses)(struct aws_host_resolver *resolver, struct aws_array_list *out_addresses);
+
+    /** gives your implementation a hint that a connection to address succeeded after connect_latency_ns. */
+    int (*record_connection_success)(
+        struct aws_host_resolver *resolver,
+        struct aws_host_address *address,
+        uint64_t connect_latency_ns);
+};
+
+/**
+ * Options for aws_host_resolver_new_async().
+ */
+struct aws_host_resolver_async_options {
+    /* the resolver does all of its network io on one loop from this group. Required. */
+    struct aws_event_loop_group *el_group;
+    /* hosts kept in the cache at once, the least recently used idle one is evicted first. 0 means 64. */
+    size_t max_entries;
+    /* servers to ask, in order of preference. With nameserver_count 0 the system configured ones are used. */
+    const struct aws_socket_endpoint *nameservers;
+    size_t nameserver_count;
+    /* how long to wait for an answer before asking the next server. 0 means 2 seconds. */
+    uint32_t query_timeout_ms;
+    /* how many more times to ask, moving to the next server each time, before giving up. 0 means 2. */
+    uint32_t max_retries;
+    const struct aws_shutdown_callback_options *shutdown_options;
 };
 
 struct aws_host_resolver {
@@ -149,10 +240,12 @@ AWS_IO_API int aws_default_dns_resolve(
  * on every Unix system in existence, we work around it by doing a threaded implementation.
  *
  * When you request an address, it checks the cache. If the entry isn't in the cache it creates a new one.
- * Each entry has a potentially short lived back-ground thread based on ttl for the records. Once we've populated the
- * cache and you keep the resolver active, the resolution callback will be invoked immediately. When it's idle, it will
- * take a little while in the background thread to fetch more, evaluate TTLs etc... In that case your callback will be
- * invoked from the background thread.
+ * Each entry is refreshed in the background for as long as it's in use, based on ttl for the records. Entries don't get
+ * a thread each: a small, bounded pool of resolver threads shared by all entries runs each entry's refresh as it comes
+ * due, so the thread count stays flat no matter how many hosts you resolve. Once we've populated the cache and you keep
+ * the resolver active, the resolution callback will be invoked immediately. When it's idle, it will take a little while
+ * in the background to fetch more, evaluate TTLs etc... In that case your callback will be invoked from one of the
+ * resolver threads.
  *
  * --------------------------------------------------------------------------------------------------------------------
  *
@@ -161,6 +254,9 @@ AWS_IO_API int aws_default_dns_resolve(
  * We attempt to honor your max ttl but will not honor it if dns queries are failing or all of your connections are
  * marked as failed. Once we are able to query dns again, we will re-evaluate the TTLs.
  *
+ * A host that fails to resolve keeps being retried in the background. With negative_ttl set in the resolution config,
+ * queries for it fail immediately for that long after a failure rather than each waiting for the next attempt.
+ *
  * Upon notification connection failures, we move them to a separate list. Eventually we retry them when it's likely
  * that the endpoint is healthy again or we don't really have another choice, but we try to keep them out of your
  * hot path.
@@ -180,6 +276,26 @@ AWS_IO_API struct aws_host_resolver *aws_host_resolver_new_default(
     struct aws_event_loop_group *el_group,
     const struct aws_shutdown_callback_options *shutdown_options);
 
+/**
+ * Creates a host resolver that speaks DNS itself instead of calling getaddrinfo(), so no thread ever blocks on a
+ * lookup.
+ *
+ * All queries share one UDP socket per nameserver on a single event loop and are matched to their answers by a random
+ * id, so any number of lookups can be outstanding at once. Each lookup sends its A and AAAA queries together and
+ * completes when both are answered. An unanswered query is retried on the next nameserver, and an answer too large
+ * for UDP is fetched again over TCP.
+ *
+ * Addresses are cached for the TTL the nameserver gave them, capped by max_ttl when the resolution config sets one.
+ * Cached hosts resolve immediately on the calling thread; anything else is answered from the resolver's event loop.
+ * If a refresh fails because no server answers, the expired addresses keep being handed out until one does.
+ *
+ * Host listeners are not supported. With no nameservers given, only POSIX systems can find the system's own
+ * (from /etc/resolv.conf); elsewhere creation fails with AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+AWS_IO_API struct aws_host_resolver *aws_host_resolver_new_async(
+    struct aws_allocator *allocator,
+    const struct aws_host_resolver_async_options *options);
+
 /**
  * Increments the reference count on the host resolver, allowing the caller to take a reference to it.
  *
@@ -202,6 +318,33 @@ AWS_IO_API int aws_host_resolver_resolve_host(
     struct aws_host_resolution_config *config,
     void *user_data);
 
+/**
+ * Like aws_host_resolver_resolve_host(), but res is invoked on event_loop's thread, so a caller about to do its work
+ * there (connecting a socket, say) doesn't need a task of its own to get onto it. Answers ready on any other thread
+ * are handed over with one task per event loop, shared by every query for the same host waiting on that loop.
+ * Resolvers that can't target an event loop resolve as aws_host_resolver_resolve_host() does.
+ */
+AWS_IO_API int aws_host_resolver_resolve_host_on_event_loop(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    struct aws_event_loop *event_loop,
+    void *user_data);
+
+/**
+ * Resolves every host in host_names, like calling aws_host_resolver_resolve_host() for each, but lets the resolver
+ * take its locks and schedule the lookups once for the whole batch. res is invoked once per host, with host_name
+ * saying which; a host that can't even be queued gets it right away with the error. config will be copied.
+ */
+AWS_IO_API int aws_host_resolver_resolve_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data);
+
 /**
  * calls record_connection_failure on the vtable.
  */
@@ -209,6 +352,17 @@ AWS_IO_API int aws_host_resolver_record_connection_failure(
     struct aws_host_resolver *resolver,
     struct aws_host_address *address);
 
+/**
+ * calls record_connection_success on the vtable, or fails with AWS_ERROR_UNSUPPORTED_OPERATION if there isn't one.
+ *
+ * The default resolver folds connect_latency_ns into the address's connect_latency_ns, each report weighing a quarter
+ * so older ones fade out, for AWS_HOST_ADDRESS_SELECTION_LOWEST_LATENCY to pick by.
+ */
+AWS_IO_API int aws_host_resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_latency_ns);
+
 /**
  * calls purge_cache on the vtable.
  */
@@ -222,6 +376,56 @@ AWS_IO_API size_t aws_host_resolver_get_host_address_count(
     const struct aws_string *host_name,
     uint32_t flags);
 
+/**
+ * Reads the resolver's lifetime counters into out_stats. Raises AWS_ERROR_UNSUPPORTED_OPERATION if the resolver
+ * doesn't keep any.
+ */
+AWS_IO_API int aws_host_resolver_get_stats(
+    struct aws_host_resolver *resolver,
+    struct aws_host_resolver_stats *out_stats);
+
+/**
+ * Adds addresses (struct aws_host_address, only address and record_type are used) for host_name to the resolver's
+ * cache, so queries for it are answered right away instead of waiting on a first lookup. config is used for the host's
+ * entry if this creates one. Seeded addresses are treated as stale: they're handed out until the host's next
+ * resolution, which starts right away for a new entry, and are then dropped unless dns returns them too.
+ * Raises AWS_ERROR_UNSUPPORTED_OPERATION if the resolver can't be seeded.
+ */
+AWS_IO_API int aws_host_resolver_seed_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    const struct aws_array_list *addresses,
+    struct aws_host_resolution_config *config);
+
+/**
+ * Appends a compact binary copy of every host and address in the resolver's cache to out_buf, growing it as needed.
+ * Feed it to aws_host_resolver_load_cache() later, typically at startup, to skip the first lookup for those hosts.
+ */
+AWS_IO_API int aws_host_resolver_save_cache(struct aws_host_resolver *resolver, struct aws_byte_buf *out_buf);
+
+/**
+ * Seeds the resolver, as aws_host_resolver_seed_host() does, with every host in cache, which was written by
+ * aws_host_resolver_save_cache(). Raises AWS_IO_FILE_VALIDATION_FAILURE if cache is malformed, in which case the hosts
+ * before the bad one have been seeded already.
+ */
+AWS_IO_API int aws_host_resolver_load_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor cache,
+    struct aws_host_resolution_config *config);
+
+/**
+ * aws_host_resolver_save_cache(), written to the file at file_path, replacing whatever was there.
+ */
+AWS_IO_API int aws_host_resolver_save_cache_to_file(struct aws_host_resolver *resolver, const char *file_path);
+
+/**
+ * aws_host_resolver_load_cache(), reading the cache from the file at file_path.
+ */
+AWS_IO_API int aws_host_resolver_load_cache_from_file(
+    struct aws_host_resolver *resolver,
+    const char *file_path,
+    struct aws_host_resolution_config *config);
+
 /* Callback for receiving new host addresses from a listener. Memory for the new address list is only guaranteed to
  * exist during the callback, and must be copied if the caller needs it to persist after. */
 typedef void(aws_host_listener_resolved_address_fn)(
@@ -22,6 +22,10 @@ struct aws_io_handle {
 
 enum aws_io_message_type {
     AWS_IO_MESSAGE_APPLICATION_DATA,
+    /* Application data in caller-owned buffers rather than message_data, which is empty. Made with
+     * aws_channel_acquire_borrowed_message(), read with aws_io_message_get_borrowed_segments(). Only goes in the
+     * write direction. Handlers that can't take one fail with AWS_IO_CHANNEL_UNKNOWN_MESSAGE_TYPE. */
+    AWS_IO_MESSAGE_BORROWED_DATA,
 };
 
 struct aws_io_message;
@@ -46,8 +50,7 @@ struct aws_io_message {
     struct aws_byte_buf message_data;
 
     /**
-     * type of the message. This is used for framework control messages. Currently the only type is
-     * AWS_IO_MESSAGE_APPLICATION_DATA
+     * type of the message. This is used for framework control messages. See enum aws_io_message_type.
      */
     enum aws_io_message_type message_type;
 
@@ -63,6 +66,12 @@ struct aws_io_message {
      */
     size_t copy_mark;
 
+    /**
+     * Set if message_data holds sensitive data, such as TLS plaintext. Message pools configured with
+     * AWS_MESSAGE_POOL_ZERO_SENSITIVE only wipe messages with this set when they are released.
+     */
+    bool is_sensitive;
+
     /**
      * The channel that the message is bound to.
      */
@@ -134,6 +143,8 @@ enum aws_io_errors {
     AWS_IO_TLS_ALERT_NOT_GRACEFUL,
     AWS_IO_MAX_RETRIES_EXCEEDED,
     AWS_IO_RETRY_PERMISSION_DENIED,
+    AWS_IO_CHANNEL_IDLE_TIMEOUT,
+    AWS_IO_CHANNEL_DRAIN_TIMEOUT,
 
     AWS_IO_ERROR_END_RANGE = AWS_ERROR_ENUM_END_RANGE(AWS_C_IO_PACKAGE_ID)
 };
@@ -28,6 +28,7 @@ enum aws_io_log_subject {
     AWS_LS_IO_FILE_UTILS,
     AWS_LS_IO_SHARED_LIBRARY,
     AWS_LS_IO_EXPONENTIAL_BACKOFF_RETRY_STRATEGY,
+    AWS_LS_IO_STANDARD_RETRY_STRATEGY,
     AWS_IO_LS_LAST = AWS_LOG_SUBJECT_END_RANGE(AWS_C_IO_PACKAGE_ID)
 };
 
@@ -5,27 +5,94 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 #include <aws/common/array_list.h>
+#include <aws/common/mutex.h>
 #include <aws/io/io.h>
 
+/* The share of an aws_message_pool_depot holding segments of one size. */
+struct aws_memory_pool_depot;
+
 struct aws_memory_pool {
     struct aws_allocator *alloc;
     struct aws_array_list stack;
-    uint16_t ideal_segment_count;
+    size_t ideal_segment_count;
     size_t segment_size;
     void *data_ptr;
+    /* If greater than ideal_segment_count, the number of segments retained grows towards the observed high-water mark
+     * of segments in use, up to this many. Defaults to ideal_segment_count (no growth). */
+    size_t max_segment_count;
+    size_t outstanding_count;
+    size_t high_water_mark;
+    /* Optional, set by aws_message_pool_init() when given a depot. Once the pool is full, released segments go to the
+     * depot rather than being freed, and an empty pool refills from it before allocating. */
+    struct aws_memory_pool_depot *depot;
+    /* how many segments move between the pool and its depot at once, so the depot's lock is taken once per batch */
+    size_t depot_batch_count;
+    /* Set by aws_memory_pool_init_from_huge_pages(): the segments it started with, carved back to back from one
+     * mapping of huge pages. They stay with the pool and are only unmapped by aws_memory_pool_clean_up(). */
+    void *slab;
+    size_t slab_length;
+};
+
+/**
+ * A thread-safe tier beneath message pools that live on different threads, such as those of each event loop. A pool
+ * that frees more messages than it retains hands the surplus to the depot, and a pool that runs dry takes it back,
+ * rather than each going to the allocator. Segments of each size are kept apart, so pools with different size classes
+ * can share one depot.
+ */
+struct aws_message_pool_depot {
+    struct aws_allocator *alloc;
+    struct aws_mutex lock;
+    /* struct aws_memory_pool_depot *, one per segment size, added as pools attach. Protected by lock. */
+    struct aws_array_list tiers;
+    /* segments of each size the depot holds on to, beyond which released segments are freed */
+    size_t max_segment_count;
+};
+
+/**
+ * Whether aws_message_pool_release() wipes a message's data before recycling it.
+ */
+enum aws_message_pool_zero_policy {
+    /* Wipe every released message. */
+    AWS_MESSAGE_POOL_ZERO_ALWAYS,
+    /* Never wipe. Only suitable when nothing sensitive flows through the pool. */
+    AWS_MESSAGE_POOL_ZERO_NEVER,
+    /* Wipe only messages flagged with aws_io_message.is_sensitive, which TLS handlers set on plaintext. */
+    AWS_MESSAGE_POOL_ZERO_SENSITIVE,
 };
 
 struct aws_message_pool {
     struct aws_allocator *alloc;
     struct aws_memory_pool application_data_pool;
     struct aws_memory_pool small_block_pool;
+    /* Power-of-two size classes between the small block and application data sizes, ascending. May be empty. */
+    struct aws_memory_pool *size_class_pools;
+    size_t size_class_count;
+    enum aws_message_pool_zero_policy zero_policy;
 };
 
 struct aws_message_pool_creation_args {
     size_t application_data_msg_data_size;
-    uint8_t application_data_msg_count;
+    size_t application_data_msg_count;
     size_t small_block_msg_data_size;
-    uint8_t small_block_msg_count;
+    size_t small_block_msg_count;
+    /* Optional. If greater than the matching *_msg_count, the pool retains more messages once more than *_msg_count
+     * have been observed in use at once, up to this many. */
+    size_t application_data_msg_max_count;
+    size_t small_block_msg_max_count;
+    /* Optional. If non-zero, a size class is added for every power of two greater than small_block_msg_data_size and
+     * less than application_data_msg_data_size, each retaining this many messages (growing up to
+     * size_class_msg_max_count, if greater). Requests then use the smallest class that fits, rather than a full
+     * application data message. */
+    size_t size_class_msg_count;
+    size_t size_class_msg_max_count;
+    /* Defaults to AWS_MESSAGE_POOL_ZERO_ALWAYS. */
+    enum aws_message_pool_zero_policy zero_policy;
+    /* Optional. Shared tier the pool overflows to and refills from. Must use the same allocator as the pool and
+     * outlive it. */
+    struct aws_message_pool_depot *depot;
+    /* Optional. Carve the application data messages the pool retains from huge pages, see
+     * aws_memory_pool_init_from_huge_pages(). */
+    bool use_huge_pages;
 };
 
 AWS_EXTERN_C_BEGIN
@@ -34,7 +101,22 @@ AWS_IO_API
 int aws_memory_pool_init(
     struct aws_memory_pool *mempool,
     struct aws_allocator *alloc,
-    uint16_t ideal_segment_count,
+    size_t ideal_segment_count,
+    size_t segment_size);
+
+/**
+ * Same as aws_memory_pool_init(), but the ideal_segment_count segments are carved from one contiguous mapping, backed
+ * by 2MB huge pages where the OS has them to give (regular pages otherwise), so a pool's worth of buffers takes a
+ * handful of TLB entries. Those segments never go back to the allocator: once released they return to the pool even
+ * if it is full, displacing a segment that came from the allocator, and they are unmapped by
+ * aws_memory_pool_clean_up(), which must only run once all of them are back. Segments acquired beyond them, or kept
+ * by growth, come from alloc as usual.
+ */
+AWS_IO_API
+int aws_memory_pool_init_from_huge_pages(
+    struct aws_memory_pool *mempool,
+    struct aws_allocator *alloc,
+    size_t ideal_segment_count,
     size_t segment_size);
 
 AWS_IO_API
@@ -47,11 +129,27 @@ AWS_IO_API
 void *aws_memory_pool_acquire(struct aws_memory_pool *mempool);
 
 /**
- * Releases memory to the pool if space is available, otherwise frees `to_release`
+ * Releases memory to the pool if space is available, otherwise frees `to_release`. If the pool is full but has seen
+ * more segments in use at once than it retains, and max_segment_count allows it, the pool grows to keep `to_release`.
  */
 AWS_IO_API
 void aws_memory_pool_release(struct aws_memory_pool *mempool, void *to_release);
 
+/**
+ * Initializes a depot holding at most max_segment_count segments of each size. Safe to share between threads.
+ */
+AWS_IO_API
+int aws_message_pool_depot_init(
+    struct aws_message_pool_depot *depot,
+    struct aws_allocator *alloc,
+    size_t max_segment_count);
+
+/**
+ * Frees everything the depot holds. Every message pool using it must have been cleaned up first.
+ */
+AWS_IO_API
+void aws_message_pool_depot_clean_up(struct aws_message_pool_depot *depot);
+
 /**
  * Initializes message pool using 'msg_pool' as the backing pool, 'args' is copied.
  */
@@ -67,6 +165,8 @@ void aws_message_pool_clean_up(struct aws_message_pool *msg_pool);
 /**
  * Acquires a message from the pool if available, otherwise, it attempts to allocate. If a message is acquired,
  * note that size_hint is just a hint. the return value's capacity will be set to the actual buffer size.
+ * The message comes from the smallest size class whose messages can hold size_hint bytes, or from the application
+ * data pool if size_hint is larger than all of them.
  */
 AWS_IO_API
 struct aws_io_message *aws_message_pool_acquire(
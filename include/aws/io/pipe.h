@@ -10,6 +10,7 @@
 #include <aws/io/io.h>
 
 struct aws_event_loop;
+struct aws_socket;
 
 struct aws_pipe_read_end {
     void *impl_data;
@@ -93,6 +94,7 @@ struct aws_event_loop *aws_pipe_get_write_end_event_loop(const struct aws_pipe_w
  * The data referenced by `src_buffer` must remain in memory until the operation completes.
  * `on_complete` is called on the event-loop thread when the operation has either completed or failed.
  * The callback's pipe argument will be NULL if the callback is invoked after the pipe has been cleaned up.
+ * Writes pending behind one another are gathered into as few system calls as the platform allows (writev() on POSIX).
  * This must be called on the thread of the connected event-loop.
  */
 AWS_IO_API
@@ -114,6 +116,24 @@ int aws_pipe_write(
 AWS_IO_API
 int aws_pipe_read(struct aws_pipe_read_end *read_end, struct aws_byte_buf *dst_buffer, size_t *num_bytes_read);
 
+/**
+ * Move up to `max_bytes` of data from the pipe straight to a connected socket, without copying it through userspace
+ * (splice() on Linux). `num_bytes_spliced` (optional) is set to the number of bytes moved, 0 once the write-end is
+ * closed and the pipe is drained, like a read would return.
+ * This function never blocks. If nothing could be moved without blocking, then AWS_OP_ERR is returned and
+ * aws_last_error() code will be AWS_IO_READ_WOULD_BLOCK. That happens both when the pipe is empty and when the
+ * socket's send buffer is full.
+ * The bytes skip the socket's write queue, so don't call this while aws_socket_write() calls are pending.
+ * This must be called on the thread of the connected event-loop, which must also be the socket's event-loop.
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without splice().
+ */
+AWS_IO_API
+int aws_pipe_splice_to_socket(
+    struct aws_pipe_read_end *read_end,
+    struct aws_socket *socket,
+    size_t max_bytes,
+    size_t *num_bytes_spliced);
+
 /**
  * Subscribe to be notified when the pipe becomes readable (edge-triggered), or an error occurs.
  * `on_readable` is invoked on the event-loop's thread when the pipe has data to read, or the pipe has an error.
@@ -17,8 +17,9 @@ AWS_IO_API void aws_cert_chain_clean_up(struct aws_array_list *cert_chain);
 /**
  * Decodes a PEM file and adds the results to 'cert_chain_or_key' if successful.
  * Otherwise, 'cert_chain_or_key' will be empty. The type stored in 'cert_chain_or_key'
- * is 'struct aws_byte_buf' by value. This code is slow, and it allocates, so please try
- * not to call this in the middle of something that needs to be fast or resource sensitive.
+ * is 'struct aws_byte_buf' by value. The PEM is decoded in a single pass, but each decoded
+ * object is allocated, so please try not to call this in the middle of something that needs
+ * to be fast or resource sensitive.
  */
 AWS_IO_API int aws_decode_pem_to_buffer_list(
     struct aws_allocator *alloc,
@@ -28,14 +29,50 @@ AWS_IO_API int aws_decode_pem_to_buffer_list(
 /**
  * Decodes a PEM file at 'filename' and adds the results to 'cert_chain_or_key' if successful.
  * Otherwise, 'cert_chain_or_key' will be empty. The type stored in 'cert_chain_or_key'
- * is 'struct aws_byte_buf' by value. This code is slow, and it allocates, so please try
- * not to call this in the middle of something that needs to be fast or resource sensitive.
+ * is 'struct aws_byte_buf' by value. The file is decoded as it is read, a chunk at a time,
+ * rather than being read into memory whole first. For a CA bundle loaded over and over, see
+ * aws_trust_store_acquire_from_file().
  */
 AWS_IO_API int aws_read_and_decode_pem_file_to_buffer_list(
     struct aws_allocator *alloc,
     const char *filename,
     struct aws_array_list *cert_chain_or_key);
 
+/**
+ * A set of trusted CA certificates decoded from a PEM file. Trust stores are shared: everyone who acquires one from
+ * the same file gets the same decoded copy for as long as the file is unchanged on disk.
+ */
+struct aws_trust_store;
+
+/**
+ * Acquires the trust store decoded from the PEM file at 'file_path'. The first call for a path decodes the file and
+ * keeps it in a process-wide cache keyed by path, later calls get a new reference to the cached copy as long as the
+ * file's modification time and length are unchanged, and decode it again otherwise. The cache is emptied by
+ * aws_io_library_clean_up(). Returns NULL and raises an error if the file can't be read or isn't valid PEM.
+ * Release the result with aws_trust_store_release().
+ */
+AWS_IO_API struct aws_trust_store *aws_trust_store_acquire_from_file(const char *file_path);
+
+AWS_IO_API struct aws_trust_store *aws_trust_store_acquire(struct aws_trust_store *trust_store);
+
+AWS_IO_API void aws_trust_store_release(struct aws_trust_store *trust_store);
+
+/**
+ * Returns the DER encoded certificates in the trust store, as 'struct aws_byte_buf' by value. They are shared and must
+ * not be modified.
+ */
+AWS_IO_API const struct aws_array_list *aws_trust_store_get_certificates(const struct aws_trust_store *trust_store);
+
+#if defined(AWS_OS_APPLE) || defined(_WIN32)
+/**
+ * Sets up and tears down the process-wide cache behind the aws_import_* functions below, which hands out the result
+ * of an earlier import of the same bytes instead of importing them again. Called from the TLS implementation's static
+ * init and clean up.
+ */
+void aws_pki_init_import_cache(struct aws_allocator *alloc);
+void aws_pki_clean_up_import_cache(void);
+#endif
+
 #ifdef AWS_OS_APPLE
 struct __CFArray;
 typedef const struct __CFArray *CFArrayRef;
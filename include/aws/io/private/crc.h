@@ -0,0 +1,26 @@
+#ifndef AWS_IO_CRC_H
+#define AWS_IO_CRC_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Computes the CRC32 (Ethernet, gzip) of input. Pass 0 as previous_crc32 to start, or the result of the previous call
+ * to continue a running checksum.
+ */
+AWS_IO_API uint32_t aws_io_crc32(const uint8_t *input, size_t length, uint32_t previous_crc32);
+
+/**
+ * Computes the CRC32C (Castagnoli, iSCSI) of input, using the CPU's CRC32 instructions where there are any. Chains
+ * like aws_io_crc32().
+ */
+AWS_IO_API uint32_t aws_io_crc32c(const uint8_t *input, size_t length, uint32_t previous_crc32c);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_CRC_H */
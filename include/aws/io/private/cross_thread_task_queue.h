@@ -0,0 +1,54 @@
+#ifndef AWS_IO_CROSS_THREAD_TASK_QUEUE_H
+#define AWS_IO_CROSS_THREAD_TASK_QUEUE_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/atomics.h>
+
+struct aws_task;
+
+/**
+ * Intrusive, lock-free, multi-producer/single-consumer queue of tasks, used by event loops to hand tasks scheduled
+ * from other threads over to the event-thread. It links tasks through aws_task's node, so it never allocates.
+ *
+ * Producers push with a single CAS. The consumer takes everything at once with an atomic exchange, which keeps the
+ * queue free of ABA problems.
+ */
+struct aws_cross_thread_task_queue {
+    /* struct aws_linked_list_node *, the most recently pushed task. Older tasks are reached through node.next */
+    struct aws_atomic_var head;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API void aws_cross_thread_task_queue_init(struct aws_cross_thread_task_queue *queue);
+
+/**
+ * Pushes task onto the queue. May be called from any thread.
+ * Returns true if the queue was empty beforehand. Only that producer needs to wake the consumer: every later push
+ * will be picked up by the same wakeup.
+ */
+AWS_IO_API bool aws_cross_thread_task_queue_push(struct aws_cross_thread_task_queue *queue, struct aws_task *task);
+
+/**
+ * Returns true if nothing is queued. May be called from any thread, but a concurrent push can make the answer stale
+ * as soon as it returns.
+ */
+AWS_IO_API bool aws_cross_thread_task_queue_is_empty(struct aws_cross_thread_task_queue *queue);
+
+/**
+ * Moves every task in the queue to the back of out_list, in the order they were pushed.
+ * Only the consumer may call this. On an event loop, drain the wakeup fd BEFORE calling this, otherwise a wakeup
+ * written for a task pushed right after the pop could be consumed and the task would sit in the queue.
+ */
+AWS_IO_API void aws_cross_thread_task_queue_pop_all(
+    struct aws_cross_thread_task_queue *queue,
+    struct aws_linked_list *out_list);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_CROSS_THREAD_TASK_QUEUE_H */
@@ -0,0 +1,99 @@
+#ifndef AWS_IO_DNS_MESSAGE_H
+#define AWS_IO_DNS_MESSAGE_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/array_list.h>
+#include <aws/common/byte_buf.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+
+/* the fixed header every dns message starts with. */
+#define AWS_DNS_HEADER_SIZE 12
+/* payload size we advertise via EDNS(0), small enough to avoid ip fragmentation on any sane path. */
+#define AWS_DNS_EDNS_UDP_PAYLOAD_SIZE 1232
+/* longest textual address we ever produce: a fully expanded ipv6 address. */
+#define AWS_DNS_ADDRESS_MAX_LEN 40
+
+enum aws_dns_record_type {
+    AWS_DNS_RECORD_TYPE_A = 1,
+    AWS_DNS_RECORD_TYPE_CNAME = 5,
+    AWS_DNS_RECORD_TYPE_AAAA = 28,
+    AWS_DNS_RECORD_TYPE_OPT = 41,
+};
+
+enum aws_dns_rcode {
+    AWS_DNS_RCODE_NOERROR = 0,
+    AWS_DNS_RCODE_FORMERR = 1,
+    AWS_DNS_RCODE_SERVFAIL = 2,
+    AWS_DNS_RCODE_NXDOMAIN = 3,
+};
+
+/**
+ * One address answering a query, already formatted the way getaddrinfo() would print it.
+ */
+struct aws_dns_address_record {
+    enum aws_address_record_type record_type;
+    uint32_t ttl_secs;
+    char address[AWS_DNS_ADDRESS_MAX_LEN];
+    size_t address_len;
+};
+
+/**
+ * What we care about in a response: whether it was cut short, the server's verdict, and the addresses for the name
+ * we asked about (CNAME chains already followed).
+ */
+struct aws_dns_response {
+    uint16_t id;
+    bool truncated;
+    uint8_t rcode;
+    /* struct aws_dns_address_record */
+    struct aws_array_list addresses;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Appends a recursive query for host_name with the given record type to out, growing it as needed. The query carries
+ * an EDNS(0) OPT record so servers may answer with up to AWS_DNS_EDNS_UDP_PAYLOAD_SIZE bytes over UDP.
+ * Raises AWS_IO_DNS_INVALID_NAME if host_name can't be encoded as a dns name.
+ */
+AWS_IO_API int aws_dns_message_encode_query(
+    struct aws_byte_buf *out,
+    uint16_t id,
+    struct aws_byte_cursor host_name,
+    enum aws_dns_record_type record_type);
+
+AWS_IO_API int aws_dns_response_init(struct aws_dns_response *response, struct aws_allocator *allocator);
+
+AWS_IO_API void aws_dns_response_clean_up(struct aws_dns_response *response);
+
+/**
+ * Parses message as the response to a query for host_name and record_type. On success, response holds the id, the
+ * truncation bit, the rcode and every address of the requested type reachable from host_name. The caller checks the id
+ * and rcode; a malformed message, or one answering a different question, raises AWS_IO_DNS_QUERY_FAILED.
+ */
+AWS_IO_API int aws_dns_message_decode_response(
+    struct aws_byte_cursor message,
+    struct aws_byte_cursor host_name,
+    enum aws_dns_record_type record_type,
+    struct aws_dns_response *response);
+
+/**
+ * Reads the id of message without parsing the rest of it. Fails if message is shorter than a dns header.
+ */
+AWS_IO_API int aws_dns_message_read_id(struct aws_byte_cursor message, uint16_t *out_id);
+
+/**
+ * Appends the nameservers the system is configured to use to out_nameservers (struct aws_socket_endpoint), each on
+ * port 53. Platform specific; raises AWS_ERROR_UNSUPPORTED_OPERATION where we don't know how to find them.
+ */
+AWS_IO_API int aws_dns_load_system_nameservers(struct aws_array_list *out_nameservers);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_DNS_MESSAGE_H */
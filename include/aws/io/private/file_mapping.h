@@ -0,0 +1,32 @@
+#ifndef AWS_IO_FILE_MAPPING_H
+#define AWS_IO_FILE_MAPPING_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+/**
+ * A whole file mapped read-only into memory. An empty file has no mapping, address is NULL and length 0.
+ */
+struct aws_file_mapping {
+    void *address;
+    size_t length;
+    /* the file mapping object on Windows, unused elsewhere */
+    void *os_handle;
+};
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Maps file_name. advise_sequential hints the OS that the mapping is going to be read front to back, so it reads ahead
+ * aggressively and may back the mapping with huge pages where it can.
+ */
+AWS_IO_API int aws_file_mapping_init(struct aws_file_mapping *mapping, const char *file_name, bool advise_sequential);
+
+AWS_IO_API void aws_file_mapping_clean_up(struct aws_file_mapping *mapping);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_FILE_MAPPING_H */
@@ -0,0 +1,41 @@
+#ifndef AWS_IO_HOT_PATH_LOGGING_H
+#define AWS_IO_HOT_PATH_LOGGING_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/logging.h>
+
+/*
+ * Trace logging for the spots that run once per message or per socket read/write.
+ *
+ * Built with AWS_IO_DISABLE_TRACE_HOT_PATH (the cmake option of the same name) these compile to nothing, message
+ * arguments included. Otherwise `enabled` is a flag the channel, handler or socket filled in with
+ * aws_io_hot_path_trace_enabled() when it was created, so with tracing off a site costs one branch rather than a call
+ * into the logger. The flip side is that turning trace logging on later only shows up on objects created afterwards.
+ */
+#ifdef AWS_IO_DISABLE_TRACE_HOT_PATH
+#    define AWS_IO_HOT_PATH_LOGF_TRACE(enabled, ...) ((void)(enabled))
+#else
+#    define AWS_IO_HOT_PATH_LOGF_TRACE(enabled, ...)                                                                   \
+        do {                                                                                                           \
+            if (enabled) {                                                                                             \
+                AWS_LOGF_TRACE(__VA_ARGS__);                                                                           \
+            }                                                                                                          \
+        } while (0)
+#endif
+
+static inline bool aws_io_hot_path_trace_enabled(aws_log_subject_t subject) {
+#ifdef AWS_IO_DISABLE_TRACE_HOT_PATH
+    (void)subject;
+    return false;
+#else
+    struct aws_logger *logger = aws_logger_get();
+    return logger != NULL && logger->vtable->get_log_level(logger, subject) >= AWS_LL_TRACE;
+#endif
+}
+
+#endif /* AWS_IO_HOT_PATH_LOGGING_H */
@@ -0,0 +1,34 @@
+#ifndef AWS_IO_HUGE_PAGES_H
+#define AWS_IO_HUGE_PAGES_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+/* The huge page size slabs are rounded up to. */
+#define AWS_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * Zeroed memory mapped straight from the OS rather than an allocator, backed by huge pages where the platform gives
+ * them out: explicitly reserved ones first (MAP_HUGETLB, MEM_LARGE_PAGES), then transparent ones (MADV_HUGEPAGE).
+ * Falls back to regular pages, so the memory is usable either way.
+ */
+struct aws_huge_page_slab {
+    void *address;
+    /* at least the size asked for, rounded up to a whole number of huge pages */
+    size_t length;
+    /* whether the slab got reserved huge pages, rather than possibly transparent or regular ones */
+    bool is_reserved;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API int aws_huge_page_slab_init(struct aws_huge_page_slab *slab, size_t size);
+
+AWS_IO_API void aws_huge_page_slab_clean_up(struct aws_huge_page_slab *slab);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_HUGE_PAGES_H */
@@ -0,0 +1,24 @@
+#ifndef AWS_IO_IOCP_H
+#define AWS_IO_IOCP_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_event_loop;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Returns the HANDLE of the I/O completion port an IOCP event loop waits on, for APIs that post their own
+ * notifications to it, such as Registered I/O completion queues. Packets must carry an OVERLAPPED embedded in a
+ * struct aws_overlapped and a completion key of 0, like those of handles connected with
+ * aws_event_loop_connect_handle_to_io_completion_port().
+ */
+void *aws_iocp_event_loop_get_completion_port(struct aws_event_loop *event_loop);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_IOCP_H */
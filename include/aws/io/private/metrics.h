@@ -0,0 +1,31 @@
+#ifndef AWS_IO_METRICS_H
+#define AWS_IO_METRICS_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_io_metrics_shard;
+
+AWS_EXTERN_C_BEGIN
+
+/**
+ * Creates an event loop's shard of the metrics registry and registers it, so snapshots include it.
+ */
+AWS_IO_API struct aws_io_metrics_shard *aws_io_metrics_shard_new(struct aws_allocator *allocator);
+
+/**
+ * Unregisters and frees a shard. What it counted is kept, so totals don't drop when a loop goes away.
+ */
+AWS_IO_API void aws_io_metrics_shard_destroy(struct aws_io_metrics_shard *shard);
+
+/**
+ * Makes shard the one counts on the calling thread go to. Event loops call this from their own thread.
+ */
+AWS_IO_API void aws_io_metrics_set_thread_shard(struct aws_io_metrics_shard *shard);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_METRICS_H */
@@ -0,0 +1,46 @@
+#ifndef AWS_IO_POSITIONAL_FILE_H
+#define AWS_IO_POSITIONAL_FILE_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+struct aws_byte_buf;
+
+/**
+ * A file opened read-only for positional reads. Reads take their offset as an argument instead of using a file
+ * position, so any number of threads can read from the same file at once.
+ */
+struct aws_positional_file {
+    /* length of the file when it was opened */
+    int64_t length;
+    /* last modification time of the file when it was opened, in nanoseconds. Only good for comparing with another
+     * open of the same file, the epoch is platform specific. */
+    uint64_t modification_time_ns;
+    /* the file descriptor on POSIX, the file HANDLE on Windows */
+    intptr_t os_handle;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API int aws_positional_file_open(struct aws_positional_file *file, const char *file_name);
+
+/**
+ * Reads up to (capacity - len) bytes at offset into dest. The read may come up short; nothing is read at or past the
+ * end of the file. Safe to call from several threads at once.
+ */
+AWS_IO_API int aws_positional_file_read(
+    const struct aws_positional_file *file,
+    uint64_t offset,
+    struct aws_byte_buf *dest);
+
+/**
+ * Closes a file opened by aws_positional_file_open().
+ */
+AWS_IO_API void aws_positional_file_close(struct aws_positional_file *file);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_POSITIONAL_FILE_H */
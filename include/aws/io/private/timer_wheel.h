@@ -0,0 +1,74 @@
+#ifndef AWS_IO_TIMER_WHEEL_H
+#define AWS_IO_TIMER_WHEEL_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/linked_list.h>
+
+struct aws_task;
+
+enum {
+    AWS_TIMER_WHEEL_LEVELS = 4,
+    /* must stay 64: each level's occupancy is tracked in a single uint64_t */
+    AWS_TIMER_WHEEL_SLOTS = 64,
+};
+
+/**
+ * Hierarchical timer wheel for coarse future tasks: AWS_TIMER_WHEEL_LEVELS levels of AWS_TIMER_WHEEL_SLOTS slots, the
+ * lowest one tick per slot and each level above 64 times coarser. Scheduling is O(1), and a task moves down a level at
+ * most AWS_TIMER_WHEEL_LEVELS - 1 times before it is handed out, which is never before its timestamp and at most one
+ * tick after it (given the wheel is advanced that often). Tasks further out than the top level spans wait in its
+ * furthest slot and are placed again when it is reached.
+ *
+ * Tasks are linked through task->node like the lists of aws_task_scheduler, so aws_task_scheduler_cancel_task(),
+ * which unlinks any task whose node is in a list, cancels a task sitting in the wheel in O(1) as well. That is also
+ * why the wheel keeps no count of its tasks: a slot emptied by cancellation is only noticed once it is reached.
+ *
+ * Not thread safe. An event loop only touches its wheel from the event-thread.
+ */
+struct aws_timer_wheel {
+    uint64_t tick_ns;
+    /* every tick up to and including this one has been handed out */
+    uint64_t current_tick;
+    /* bit i of occupied[level] is set if slots[level][i] may hold tasks */
+    uint64_t occupied[AWS_TIMER_WHEEL_LEVELS];
+    struct aws_linked_list slots[AWS_TIMER_WHEEL_LEVELS][AWS_TIMER_WHEEL_SLOTS];
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API void aws_timer_wheel_init(struct aws_timer_wheel *wheel, uint64_t tick_ns, uint64_t now_ns);
+
+/**
+ * Schedules task to be handed out by aws_timer_wheel_advance() once run_at_nanos has passed. Sets task->timestamp.
+ */
+AWS_IO_API void aws_timer_wheel_schedule(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t run_at_nanos);
+
+/**
+ * Advances the wheel to now_ns, moving every task that fell due to the back of out_due. Tasks due in the same tick come
+ * out in no particular order.
+ */
+AWS_IO_API void aws_timer_wheel_advance(
+    struct aws_timer_wheel *wheel,
+    uint64_t now_ns,
+    struct aws_linked_list *out_due);
+
+/**
+ * Returns false if the wheel is empty. Otherwise sets out_ns to the next time aws_timer_wheel_advance() has work to do,
+ * which is when a task falls due or an upper level slot must be spread over the levels below, so it may come well
+ * before any task is due.
+ */
+AWS_IO_API bool aws_timer_wheel_next_deadline(const struct aws_timer_wheel *wheel, uint64_t *out_ns);
+
+/**
+ * Moves every task still in the wheel to the back of out_tasks, e.g. to cancel them on shutdown.
+ */
+AWS_IO_API void aws_timer_wheel_pop_all(struct aws_timer_wheel *wheel, struct aws_linked_list *out_tasks);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TIMER_WHEEL_H */
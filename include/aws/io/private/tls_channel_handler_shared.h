@@ -9,6 +9,7 @@
 
 #include <aws/io/channel.h>
 #include <aws/io/statistics.h>
+#include <aws/io/tls_channel_handler.h>
 
 struct aws_tls_connection_options;
 
@@ -34,6 +35,17 @@ AWS_IO_API void aws_on_tls_negotiation_completed(
     struct aws_tls_channel_handler_shared *tls_handler_shared,
     int error_code);
 
+/**
+ * For aws_tls_connection_options.on_protocol_negotiated: puts a new slot to the right of tls_slot and lets
+ * on_protocol_negotiated fill it in. Fails with AWS_IO_UNHANDLED_ALPN_PROTOCOL_MESSAGE, and takes the slot back out,
+ * if it returns no handler.
+ */
+AWS_IO_API int aws_tls_install_negotiated_protocol_handler(
+    struct aws_channel_slot *tls_slot,
+    struct aws_byte_buf *protocol,
+    aws_tls_on_protocol_negotiated on_protocol_negotiated,
+    void *user_data);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_TLS_CHANNEL_HANDLER_SHARED_H */
@@ -0,0 +1,76 @@
+#ifndef AWS_IO_TLS_SESSION_CACHE_H
+#define AWS_IO_TLS_SESSION_CACHE_H
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/io.h>
+
+#include <aws/common/byte_buf.h>
+#include <aws/common/mutex.h>
+
+struct aws_cache;
+struct aws_string;
+
+/**
+ * Thread-safe store of serialized client TLS sessions (tickets or session ids), keyed by "server_name:port".
+ * A TLS ctx owns one and every connection made from that ctx shares it, so a reconnect to the same endpoint can
+ * resume instead of doing a full handshake.
+ *
+ * The cache holds at most max_entries sessions, evicting the least recently used one when full, and a session is
+ * dropped once it is older than the ttl. A ttl_secs of 0 means AWS_TLS_SESSION_CACHE_DEFAULT_TTL_SECS.
+ */
+struct aws_tls_session_cache {
+    struct aws_allocator *allocator;
+    struct aws_mutex lock;
+    /* struct aws_string * -> struct aws_tls_cached_session * */
+    struct aws_cache *sessions;
+    uint64_t ttl_ns;
+    /* defaults to aws_high_res_clock_get_ticks, tests override it. */
+    aws_io_clock_fn *clock_fn;
+};
+
+AWS_EXTERN_C_BEGIN
+
+AWS_IO_API int aws_tls_session_cache_init(
+    struct aws_tls_session_cache *cache,
+    struct aws_allocator *allocator,
+    size_t max_entries,
+    uint32_t ttl_secs);
+
+AWS_IO_API void aws_tls_session_cache_clean_up(struct aws_tls_session_cache *cache);
+
+/**
+ * Builds the cache key for a connection to server_name:port. Returns NULL and raises an error on failure.
+ */
+AWS_IO_API struct aws_string *aws_tls_session_cache_key_new(
+    struct aws_allocator *allocator,
+    const struct aws_string *server_name,
+    uint16_t port);
+
+/**
+ * Stores a copy of session under key, replacing whatever was there and restarting its ttl.
+ */
+AWS_IO_API int aws_tls_session_cache_put(
+    struct aws_tls_session_cache *cache,
+    const struct aws_string *key,
+    struct aws_byte_cursor session);
+
+/**
+ * Appends the session stored under key to out_session, which must already be initialized.
+ * Succeeds without touching out_session if there is no live session for key, so check out_session->len.
+ */
+AWS_IO_API int aws_tls_session_cache_get(
+    struct aws_tls_session_cache *cache,
+    const struct aws_string *key,
+    struct aws_byte_buf *out_session);
+
+/**
+ * Forgets the session stored under key, if any. Used when resuming with it failed.
+ */
+AWS_IO_API void aws_tls_session_cache_remove(struct aws_tls_session_cache *cache, const struct aws_string *key);
+
+AWS_EXTERN_C_END
+
+#endif /* AWS_IO_TLS_SESSION_CACHE_H */
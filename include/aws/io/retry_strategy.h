@@ -109,6 +109,43 @@ struct aws_exponential_backoff_retry_options {
     uint64_t (*generate_random)(void);
 };
 
+/**
+ * Options for the retry quota decorator. Any option set to 0 will signify "use defaults"
+ */
+struct aws_retry_quota_options {
+    /** Size of the token bucket of retry capacity shared by every token of the strategy. It starts out full. Default
+     * is 500 */
+    size_t initial_bucket_capacity;
+};
+
+/**
+ * Options for the standard retry strategy: exponential backoff behind a retry quota. See the comments for
+ * aws_exponential_backoff_retry_options and aws_retry_quota_options.
+ */
+struct aws_standard_retry_options {
+    struct aws_exponential_backoff_retry_options backoff_retry_options;
+    struct aws_retry_quota_options retry_quota_options;
+};
+
+/**
+ * Options for the partitioned retry strategy. partition_options.backoff_retry_options.el_group must be set, any other
+ * option, if set to 0 will signify "use defaults"
+ */
+struct aws_partitioned_retry_options {
+    /** Options every partition's standard retry strategy is created with. */
+    struct aws_standard_retry_options partition_options;
+    /** Max partitions to keep a strategy for. Past that, the least recently used one is dropped. Default is 64 */
+    size_t max_partitions;
+};
+
+/**
+ * Options for the adaptive retry strategy. See the comments for aws_standard_retry_options.
+ */
+struct aws_adaptive_retry_options {
+    /** Options for the standard retry strategy the adaptive one schedules its retries with. */
+    struct aws_standard_retry_options standard_options;
+};
+
 AWS_EXTERN_C_BEGIN
 /**
  * Acquire a reference count on retry_strategy.
@@ -163,6 +200,48 @@ AWS_IO_API void aws_retry_strategy_release_retry_token(struct aws_retry_token *t
 AWS_IO_API struct aws_retry_strategy *aws_retry_strategy_new_exponential_backoff(
     struct aws_allocator *allocator,
     const struct aws_exponential_backoff_retry_options *config);
+/**
+ * Creates a retry strategy that puts a retry quota in front of wrapped_strategy, which it acquires a reference on.
+ * Every retry draws its cost from a token bucket shared by all tokens of the strategy: 10 for
+ * AWS_RETRY_ERROR_TYPE_TRANSIENT, 5 for throttling and server errors and nothing for client errors.
+ * aws_retry_strategy_token_record_success() puts the cost of the token's last retry back, or 1 if it never retried.
+ * Once the bucket can't cover a retry, aws_retry_strategy_schedule_retry() fails right away with
+ * AWS_IO_RETRY_PERMISSION_DENIED, so an outage doesn't multiply the load on the service with retries. Otherwise the
+ * retry is scheduled by wrapped_strategy.
+ */
+AWS_IO_API struct aws_retry_strategy *aws_retry_strategy_new_retry_quota(
+    struct aws_allocator *allocator,
+    struct aws_retry_strategy *wrapped_strategy,
+    const struct aws_retry_quota_options *config);
+/**
+ * Creates the standard retry strategy: exponential backoff, see aws_retry_strategy_new_exponential_backoff(), behind
+ * a retry quota, see aws_retry_strategy_new_retry_quota().
+ */
+AWS_IO_API struct aws_retry_strategy *aws_retry_strategy_new_standard(
+    struct aws_allocator *allocator,
+    const struct aws_standard_retry_options *config);
+/**
+ * Creates a retry strategy that keeps a separate standard retry strategy, and with it a separate retry quota, for each
+ * partition_id passed to aws_retry_strategy_acquire_retry_token(), so an unhealthy endpoint can't use up the retries
+ * of healthy ones. NULL partition_id shares a single partition. Tokens belong to their partition's strategy, which is
+ * also what on_acquired is invoked with. When more than max_partitions are in use, the least recently used partition
+ * is dropped; its tokens keep working, but the next token for it starts with a fresh quota.
+ */
+AWS_IO_API struct aws_retry_strategy *aws_retry_strategy_new_partitioned(
+    struct aws_allocator *allocator,
+    const struct aws_partitioned_retry_options *config);
+/**
+ * Creates the adaptive retry strategy: the standard retry strategy, see aws_retry_strategy_new_standard(), plus a
+ * client side rate limiter shared by all of its tokens. The limiter stays out of the way until the first
+ * AWS_RETRY_ERROR_TYPE_THROTTLING retry. From then on every token acquisition and every retry takes a send token from
+ * a bucket refilled at a rate that drops on throttling and grows back CUBIC style as operations succeed or fail for
+ * other reasons. Acquisitions that have to wait for the bucket are completed from an event loop task once it has
+ * refilled, rather than by blocking. If timeout_ms is non-zero and the wait would be longer than that,
+ * aws_retry_strategy_acquire_retry_token() fails with AWS_IO_RETRY_PERMISSION_DENIED instead.
+ */
+AWS_IO_API struct aws_retry_strategy *aws_retry_strategy_new_adaptive(
+    struct aws_allocator *allocator,
+    const struct aws_adaptive_retry_options *config);
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_CLIENT_RETRY_STRATEGY_H */
@@ -8,6 +8,8 @@
 #include <aws/io/channel.h>
 #include <aws/io/io.h>
 
+#include <stdio.h>
+
 enum aws_socket_domain {
     AWS_SOCKET_IPV4,
     AWS_SOCKET_IPV6,
@@ -28,6 +30,9 @@ enum aws_socket_type {
     AWS_SOCKET_DGRAM,
 };
 
+/* Longest congestion control algorithm name, including its terminating NUL, that the kernel takes (TCP_CA_NAME_MAX). */
+#define AWS_SOCKET_CONGESTION_CONTROL_NAME_MAX 16
+
 struct aws_socket_options {
     enum aws_socket_type type;
     enum aws_socket_domain domain;
@@ -41,6 +46,63 @@ struct aws_socket_options {
      * lost. If zero OS defaults are used. On Windows, this option is meaningless until Windows 10 1703.*/
     uint16_t keep_alive_max_failed_probes;
     bool keepalive;
+    /* TCP only. If non-zero, writes of at least this many bytes are sent with MSG_ZEROCOPY where the platform
+     * supports it (Linux), so the kernel sends straight from the caller's buffer instead of copying it. The write's
+     * completion callback is then held back until the kernel has released that buffer; writes still waiting on that
+     * when the socket closes fail with AWS_IO_SOCKET_CLOSED. Zero disables it. */
+    size_t zerocopy_write_threshold;
+    /* Not for local sockets. If set, enables SO_REUSEPORT so several sockets may bind the same address and port, with
+     * the kernel spreading incoming connections (or datagrams) across them. Fails with AWS_ERROR_UNSUPPORTED_OPERATION
+     * on platforms without it. */
+    bool reuse_port;
+    /* Listening sockets only, posix only. Most connections accepted in one go before the rest of the event loop gets a
+     * turn; any still queued are accepted from a task right after. Zero picks a default. */
+    uint32_t max_accepts_per_event;
+    /* Not for local sockets, Linux only. If non-zero, sets SO_BUSY_POLL so reads on an empty socket poll the device
+     * queue for up to this many microseconds instead of waiting for an interrupt. Pairs with the event loop's
+     * busy_poll_spin_us on dedicated cores. Raising it above net.core.busy_read needs CAP_NET_ADMIN; failure to set it
+     * is only logged. */
+    uint32_t busy_poll_us;
+    /* Datagram sockets only, Linux only. If set, enables UDP_GRO so the kernel may hand several datagrams from the
+     * same sender to aws_socket_recv_from_batch() as one buffer, reporting their size in segment_size. Where it isn't
+     * available this is only logged and every datagram arrives on its own. */
+    bool udp_gro;
+    /* TCP only. If set, enables TCP_NODELAY so small writes go out right away instead of waiting on Nagle's algorithm
+     * for outstanding data to be acknowledged. Pairs with corking writes in userspace, see aws_socket_cork_writes(). */
+    bool tcp_nodelay;
+    /* TCP only, Linux only. If set, aws_socket_cork_writes() also sets TCP_CORK until its aws_socket_uncork_writes(),
+     * so the kernel packs a corked batch into full segments even when it takes more than one system call to send,
+     * as with file writes. Where it isn't available this is only logged. */
+    bool tcp_cork;
+    /* TCP only, Windows 8 and later only. If set, the socket receives through Registered I/O: it keeps a ring of
+     * pre-registered buffers posted to the kernel, with completions delivered to the event loop's completion port,
+     * and reads copy out of it. That saves locking a buffer in the kernel on every read. Where it isn't available the
+     * socket falls back to regular reads. Ignored on other platforms. */
+    bool use_registered_io;
+    /* TCP only, Linux only. If set, connecting sockets enable TCP_FASTOPEN_CONNECT: once the kernel holds a Fast Open
+     * cookie for the server, connect completes right away and the first write goes out on the SYN. A connection the
+     * server then refuses shows up as a read or write error rather than a connect error. Listening sockets enable
+     * TCP_FASTOPEN, with the listen backlog as the queue of pending Fast Open requests. Where it isn't available this
+     * is only logged. */
+    bool tcp_fast_open;
+    /* Listening TCP sockets only, Linux only. If non-zero, sets TCP_DEFER_ACCEPT so a connection is only accepted once
+     * its first data has arrived, or after roughly this many seconds. Where it isn't available this is only logged. */
+    uint32_t tcp_defer_accept_sec;
+    /* If non-zero, sets SO_SNDBUF and SO_RCVBUF respectively. The kernel may round or cap the size (on Linux it
+     * doubles it, and caps it at net.core.wmem_max and net.core.rmem_max) and stops auto-tuning that buffer. Set
+     * before connect or listen, so the receive buffer is reflected in the TCP window scale. Failure is only logged. */
+    uint32_t send_buffer_size;
+    uint32_t recv_buffer_size;
+    /* TCP only, Linux and Apple only. If non-zero, sets TCP_NOTSENT_LOWAT so the kernel holds at most about this many
+     * bytes that haven't gone out yet. Writes beyond it wait in the socket's own queue until its next writable event,
+     * so a write's completion means its data is about to hit the wire rather than sitting behind a large send buffer,
+     * and aws_socket_handler_has_pending_writes() tells how far behind the connection is. Where it isn't available
+     * this is only logged. */
+    uint32_t tcp_notsent_lowat;
+    /* TCP only, Linux only. If not empty, a NUL terminated algorithm name such as "bbr" or "cubic" set with
+     * TCP_CONGESTION. Algorithms that aren't loaded, or that net.ipv4.tcp_allowed_congestion_control doesn't allow
+     * without CAP_NET_ADMIN, keep the system default; that, like platforms without it, is only logged. */
+    char tcp_congestion_control[AWS_SOCKET_CONGESTION_CONTROL_NAME_MAX];
 };
 
 struct aws_socket;
@@ -99,6 +161,25 @@ struct aws_socket_endpoint {
     uint16_t port;
 };
 
+/**
+ * One datagram for aws_socket_send_to_batch() and aws_socket_recv_from_batch().
+ */
+struct aws_socket_datagram {
+    /* Sending: the bytes from 0 to `len` are sent. Receiving: the datagram is read into the space from `len` to
+     * `capacity`, and `len` is updated. */
+    struct aws_byte_buf buffer;
+    /* Sending: where to send it, or an empty address to send to the connected peer. Receiving: who sent it. */
+    struct aws_socket_endpoint endpoint;
+    /* Segmentation offload. Sending: if non-zero, `buffer` holds back to back datagrams of this size (the last may be
+     * shorter) that the kernel splits up (UDP_SEGMENT, Linux only). Receiving: non-zero when `udp_gro` coalesced
+     * several datagrams of this size into `buffer`. */
+    uint16_t segment_size;
+    /* Receiving: the datagram was bigger than the space in `buffer` and the rest of it was dropped. */
+    bool truncated;
+};
+
+struct aws_crt_statistics_socket;
+
 struct aws_socket {
     struct aws_allocator *allocator;
     struct aws_socket_endpoint local_endpoint;
@@ -113,6 +194,8 @@ struct aws_socket {
     aws_socket_on_connection_result_fn *connection_result_fn;
     aws_socket_on_accept_result_fn *accept_result_fn;
     void *connect_accept_user_data;
+    /* syscall counts go here once the socket channel handler's channel gathers statistics, NULL until then */
+    struct aws_crt_statistics_socket *statistics;
     void *impl;
 };
 
@@ -140,6 +223,19 @@ AWS_IO_API int aws_socket_init(
     struct aws_allocator *alloc,
     const struct aws_socket_options *options);
 
+/**
+ * Initializes a socket object around an already connected handle, such as one received with aws_socket_recv_handle(),
+ * and takes ownership of it. options will be copied and applied, and should describe the handle's domain and type.
+ * The socket comes out connected; assign it to an event loop before reading or writing, as with an accepted one.
+ *
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without handle passing (currently Windows).
+ */
+AWS_IO_API int aws_socket_init_from_handle(
+    struct aws_socket *socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    const struct aws_io_handle *handle);
+
 /**
  * Shuts down any pending operations on the socket, and cleans up state. The socket object can be re-initialized after
  * this operation. This function calls aws_socket_close. If you have not already called aws_socket_close() on the
@@ -233,6 +329,16 @@ AWS_IO_API int aws_socket_set_options(struct aws_socket *socket, const struct aw
  */
 AWS_IO_API int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_loop *event_loop);
 
+/**
+ * Stops the socket's notifications from its event-loop, keeping any readable subscription, so the socket can be
+ * handed to another loop with aws_socket_assign_to_event_loop(). A notification the socket missed meanwhile is
+ * delivered by the new loop. Fails with AWS_ERROR_INVALID_STATE while a connect or write is in flight, and for
+ * listening sockets. Not supported on Windows, where a socket stays bound to the completion port it was assigned to.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_unassign_from_event_loop(struct aws_socket *socket);
+
 /**
  * Gets the event-loop the socket is assigned to.
  */
@@ -265,6 +371,22 @@ AWS_IO_API int aws_socket_subscribe_to_readable_events(
  */
 AWS_IO_API int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
 
+/**
+ * Same as `aws_socket_read()`, but scatters the data across `buffer_count` buffers with as few system calls as the
+ * platform allows (readv() on POSIX, a multi-buffer WSARecv() on Windows). Buffers are filled in order, each from
+ * `len` to `capacity`, and every buffer's `len` is updated. `amount_read` is the total read across all buffers.
+ *
+ * The platform may cap how many buffers are used in one call, so a short read does not necessarily mean the socket
+ * is drained. For datagram sockets a single datagram is scattered across the buffers.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read);
+
 /**
  * Writes to the socket. This call is non-blocking and will attempt to write as much as it can, but will queue any
  * remaining portion of the data for write when available. written_fn will be invoked once the entire cursor has been
@@ -282,6 +404,136 @@ AWS_IO_API int aws_socket_write(
     aws_socket_on_write_completed_fn *written_fn,
     void *user_data);
 
+/**
+ * Same as `aws_socket_write()`, but sends `length` bytes of `file` starting at `offset`. The write is queued behind
+ * any pending writes. On Linux the data goes from the page cache to the socket with sendfile() and never enters
+ * userspace; other POSIX platforms read it through a small bounce buffer. The file's own position is not changed, and
+ * the file must stay open until written_fn is invoked. If the file ends before `length` bytes have been sent, the
+ * write fails with AWS_IO_STREAM_READ_FAILED.
+ *
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without a file send path (currently Windows).
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_write_from_file(
+    struct aws_socket *socket,
+    FILE *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data);
+
+/**
+ * Holds back writes: until aws_socket_uncork_writes(), aws_socket_write() and aws_socket_write_from_file() only queue
+ * their data. Meant for callers that issue several small writes in a row, which then leave in as few system calls
+ * as the platform allows rather than one each. A write already in progress carries on regardless. Corking is
+ * advisory and the platforms without a write queue (currently Windows) ignore it.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API void aws_socket_cork_writes(struct aws_socket *socket);
+
+/**
+ * Sends everything queued since aws_socket_cork_writes(). Failures are reported to each write's written_fn.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API void aws_socket_uncork_writes(struct aws_socket *socket);
+
+/**
+ * Sends one datagram to `destination`, or to the connected peer if `destination` is NULL. Datagram sockets only; the
+ * socket must be bound or connected and assigned to an event loop. Unlike aws_socket_write() nothing is queued: the
+ * datagram goes out whole within this call, or `amount_written` is 0 because the send buffer is full. The caller may
+ * drop it, as the network might, or try again later.
+ *
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without a datagram path (currently Windows).
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_send_to(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_socket_endpoint *destination,
+    size_t *amount_written);
+
+/**
+ * Sends up to `count` datagrams with as few system calls as the platform allows (sendmmsg() on Linux).
+ * `datagrams_sent` is how many went out, in order; fewer than `count` means the send buffer filled up. If a datagram
+ * can't be sent at all (a bad address, say) the call fails, with `datagrams_sent` saying how many went before it.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_send_to_batch(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_sent);
+
+/**
+ * Reads one datagram into the space from `buffer->len` to `buffer->capacity`, and stores its sender in `source` if
+ * that's not NULL. A datagram too big for the space is cut short. Raises AWS_IO_READ_WOULD_BLOCK when there is
+ * nothing to read. Datagram sockets only.
+ *
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without a datagram path (currently Windows).
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_recv_from(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_socket_endpoint *source,
+    size_t *amount_read);
+
+/**
+ * Reads up to `count` datagrams with as few system calls as the platform allows (recvmmsg() on Linux), one per entry
+ * of `datagrams`. `datagrams_received` is how many were filled; fewer than `count` means the socket is drained.
+ * Raises AWS_IO_READ_WOULD_BLOCK when nothing was read. On any other error `datagrams_received` still says how many
+ * were filled before it.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_recv_from_batch(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_received);
+
+/**
+ * Sends `data` to the peer of a connected AWS_SOCKET_LOCAL stream socket along with a duplicate of `handle`
+ * (SCM_RIGHTS), so another process can take over a connection this one accepted. The handle is still the caller's
+ * to close afterwards. `data` can't be empty, the handle travels with its first byte.
+ *
+ * Like aws_socket_send_to() nothing is queued. `amount_written` is how much of `data` went out, and the handle went
+ * with it unless that's 0 because the send buffer is full. Anything left over can follow with aws_socket_write().
+ * Fails with AWS_ERROR_INVALID_STATE while aws_socket_write() calls are outstanding, since it would jump ahead of them.
+ *
+ * Returns AWS_ERROR_UNSUPPORTED_OPERATION on platforms without handle passing (currently Windows).
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_send_handle(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_io_handle *handle,
+    size_t *amount_written);
+
+/**
+ * Reads into the space from `buffer->len` to `buffer->capacity` like aws_socket_read(), on a connected
+ * AWS_SOCKET_LOCAL stream socket, and stores a handle passed along with those bytes in `out_handle`. Without one,
+ * out_handle->data.fd is -1. A received handle belongs to the caller, typically for aws_socket_init_from_handle().
+ * Raises AWS_IO_READ_WOULD_BLOCK when there is nothing to read.
+ *
+ * A read stops at the first byte that carries a handle, so reading with this function keeps handles and the bytes
+ * sent with them together. Plain aws_socket_read() calls would silently close any handle they pass over.
+ *
+ * NOTE! This function must be called from the event-loop used in aws_socket_assign_to_event_loop
+ */
+AWS_IO_API int aws_socket_recv_handle(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_io_handle *out_handle,
+    size_t *amount_read);
+
 /**
  * Gets the latest error from the socket. If no error has occurred AWS_OP_SUCCESS will be returned. This function does
  * not raise any errors to the installed error handlers.
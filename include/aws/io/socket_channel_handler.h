@@ -16,7 +16,7 @@ AWS_EXTERN_C_BEGIN
 /**
  * Socket handlers should be the first slot/handler in a channel. It interacts directly with the channel's event loop
  * for read and write notifications. max_read_size is the maximum amount of data it will read from the socket
- * before a context switch (a continuation task will be scheduled).
+ * before a context switch (it then waits for its turn on the event loop, see g_aws_channel_read_budget_per_tick).
  */
 AWS_IO_API struct aws_channel_handler *aws_socket_handler_new(
     struct aws_allocator *allocator,
@@ -24,6 +24,47 @@ AWS_IO_API struct aws_channel_handler *aws_socket_handler_new(
     struct aws_channel_slot *slot,
     size_t max_read_size);
 
+/**
+ * Returns the socket a socket handler reads from and writes to, or NULL if `handler` isn't a socket handler.
+ */
+AWS_IO_API struct aws_socket *aws_socket_handler_get_socket(const struct aws_channel_handler *handler);
+
+/**
+ * Returns true while any message written through the socket handler is still waiting on its write to complete.
+ * Must be called from the channel's thread.
+ */
+AWS_IO_API bool aws_socket_handler_has_pending_writes(const struct aws_channel_handler *handler);
+
+/**
+ * Shuts the channel down with AWS_IO_CHANNEL_IDLE_TIMEOUT once no data has been read from or written to the socket
+ * for idle_timeout_ms. 0 turns it off. Must be called from the channel's thread.
+ *
+ * Meant to reclaim dead-but-open connections at scale: reads and writes only note the time, and a single channel
+ * task per connection checks it about once per timeout, which an event loop with use_timer_wheel schedules in O(1).
+ */
+AWS_IO_API int aws_socket_handler_set_idle_timeout(struct aws_channel_handler *handler, uint32_t idle_timeout_ms);
+
+/**
+ * Coalesces writes: the socket is corked at the first write of an event loop tick and uncorked once the tick's other
+ * tasks and events have run, or as soon as flush_threshold bytes are held back, so a burst of small messages leaves
+ * in one vectored write rather than a system call and a small segment each. 0, the default, turns it off and sends
+ * anything held back. Must be called from the channel's thread.
+ *
+ * See aws_socket_cork_writes(), and the tcp_nodelay and tcp_cork socket options that pair with it.
+ */
+AWS_IO_API void aws_socket_handler_set_write_coalescing(struct aws_channel_handler *handler, size_t flush_threshold);
+
+typedef void(aws_socket_handler_on_first_read_fn)(struct aws_channel_handler *handler, void *user_data);
+
+/**
+ * Invokes on_first_read once, on the channel's thread, the first time data is read from the socket and before it goes
+ * downstream. NULL turns it off. Must be called from the channel's thread.
+ */
+AWS_IO_API void aws_socket_handler_set_on_first_read(
+    struct aws_channel_handler *handler,
+    aws_socket_handler_on_first_read_fn *on_first_read,
+    void *user_data);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_SOCKET_CHANNEL_HANDLER_H */
@@ -8,6 +8,7 @@
 
 #include <aws/io/io.h>
 
+#include <aws/common/atomics.h>
 #include <aws/common/statistics.h>
 #include <aws/io/tls_channel_handler.h>
 
@@ -18,11 +19,23 @@ enum aws_crt_io_statistics_category {
 
 /**
  * Socket channel handler statistics record
+ *
+ * The syscall counts are kept by the socket itself, and only once its channel gathers statistics. The average size
+ * of a read is bytes_read / read_syscalls, and likewise for writes. bytes_written is counted when writes complete
+ * rather than when they're made, so an interval's write average is approximate.
  */
 struct aws_crt_statistics_socket {
     aws_crt_statistics_category_t category;
     uint64_t bytes_read;
     uint64_t bytes_written;
+    /* read and write system calls made */
+    uint64_t read_syscalls;
+    uint64_t write_syscalls;
+    /* reads that found nothing to read, writes that found no room in the send buffer */
+    uint64_t read_would_block;
+    uint64_t write_would_block;
+    /* writes the kernel took only part of, POSIX only: IOCP writes always complete in full */
+    uint64_t partial_writes;
 };
 
 /**
@@ -35,8 +48,152 @@ struct aws_crt_statistics_tls {
     enum aws_tls_negotiation_status handshake_status;
 };
 
+/*
+ * Each power of two of microseconds is split in 2^AWS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS buckets, so a recorded value is
+ * known to within 12.5%. Everything from 0 to about 4.7 hours gets a bucket, longer ones land in the last.
+ */
+#define AWS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS 3
+#define AWS_LATENCY_HISTOGRAM_BUCKET_COUNT 256
+
+/**
+ * Fixed-bucket, log-linear latency histogram. Recording is a single relaxed atomic increment, so any number of threads
+ * can record into the same histogram, or each event loop can keep its own and have them merged when read.
+ * Zero-initialized is empty and ready to use.
+ */
+struct aws_latency_histogram {
+    struct aws_atomic_var buckets[AWS_LATENCY_HISTOGRAM_BUCKET_COUNT];
+};
+
+/**
+ * Latencies the library records on its own, process wide, see aws_io_get_latency_histogram().
+ */
+enum aws_io_latency_metric {
+    /* from the first negotiation step to the handshake succeeding, failed handshakes aren't recorded */
+    AWS_IO_LATENCY_TLS_HANDSHAKE,
+    /* from connect() to the socket reporting connected, POSIX sockets only */
+    AWS_IO_LATENCY_SOCKET_CONNECT,
+    /* one call to the resolver's resolution function, whether it found addresses or not */
+    AWS_IO_LATENCY_DNS_RESOLVE,
+    /* from aws_client_bootstrap_new_socket_channel() to a successful setup_callback, queueing included */
+    AWS_IO_LATENCY_CHANNEL_SETUP,
+    AWS_IO_LATENCY_METRIC_COUNT,
+};
+
+/**
+ * Process wide counters of the metrics registry, see aws_io_metrics_set_enabled().
+ */
+enum aws_io_metric {
+    /* bytes read from and written to sockets */
+    AWS_IO_METRIC_BYTES_READ,
+    AWS_IO_METRIC_BYTES_WRITTEN,
+    /* socket read and write system calls made, and how many of them would have blocked */
+    AWS_IO_METRIC_SOCKET_SYSCALLS,
+    AWS_IO_METRIC_SOCKET_WOULD_BLOCK,
+    /* channel messages served from a pool's retained memory, and ones that needed an allocation */
+    AWS_IO_METRIC_MESSAGE_POOL_HITS,
+    AWS_IO_METRIC_MESSAGE_POOL_MISSES,
+    /* channels created and not destroyed yet. A gauge, the others only go up. */
+    AWS_IO_METRIC_OPEN_CHANNELS,
+    /* channel tasks run, or canceled */
+    AWS_IO_METRIC_CHANNEL_TASKS_RUN,
+    /* TLS handlers that picked up a pooled connection, see aws_tls_ctx_options.connection_pool_size */
+    AWS_IO_METRIC_TLS_CONNECTIONS_REUSED,
+    AWS_IO_METRIC_COUNT,
+};
+
+/**
+ * Totals of every aws_io_metric, see aws_io_metrics_snapshot().
+ */
+struct aws_io_metrics_snapshot {
+    uint64_t values[AWS_IO_METRIC_COUNT];
+};
+
 AWS_EXTERN_C_BEGIN
 
+/**
+ * Empties a histogram. Not atomic as a whole: values recorded meanwhile may or may not survive.
+ */
+AWS_IO_API
+void aws_latency_histogram_reset(struct aws_latency_histogram *histogram);
+
+/**
+ * Records one duration. Safe to call from any thread.
+ */
+AWS_IO_API
+void aws_latency_histogram_record_ns(struct aws_latency_histogram *histogram, uint64_t duration_ns);
+
+/**
+ * Adds the counts of from to to. from is left as it is and may be recorded into meanwhile.
+ */
+AWS_IO_API
+void aws_latency_histogram_merge(struct aws_latency_histogram *to, const struct aws_latency_histogram *from);
+
+/**
+ * Moves the counts of from to to, leaving from empty. Unlike aws_latency_histogram_merge() followed by
+ * aws_latency_histogram_reset(), no value recorded into from meanwhile is lost, which makes it the way to gather a
+ * histogram per interval.
+ */
+AWS_IO_API
+void aws_latency_histogram_take(struct aws_latency_histogram *to, struct aws_latency_histogram *from);
+
+/**
+ * Returns the number of values recorded.
+ */
+AWS_IO_API
+uint64_t aws_latency_histogram_get_count(const struct aws_latency_histogram *histogram);
+
+/**
+ * Returns an upper bound on the value below which percentile (0 to 100) of the recorded values fall, in nanoseconds.
+ * Returns 0 for an empty histogram.
+ */
+AWS_IO_API
+uint64_t aws_latency_histogram_get_percentile_ns(const struct aws_latency_histogram *histogram, double percentile);
+
+/**
+ * Gets the range of durations bucket index counts, in nanoseconds: lower_ns inclusive, upper_ns exclusive. For
+ * exporting a whole histogram.
+ */
+AWS_IO_API
+void aws_latency_histogram_get_bucket_range_ns(size_t index, uint64_t *lower_ns, uint64_t *upper_ns);
+
+/**
+ * Returns the process wide histogram the library records metric into. It is never reset by the library.
+ */
+AWS_IO_API
+struct aws_latency_histogram *aws_io_get_latency_histogram(enum aws_io_latency_metric metric);
+
+/**
+ * Turns the metrics registry on or off, it starts off. While it's on, the library counts every aws_io_metric
+ * into a shard per event loop, so each count is an uncontended atomic add on memory only that loop's thread writes;
+ * counts made off any event loop thread go to one shared shard. aws_io_metrics_snapshot() adds the shards up. This is
+ * the cheap way to get totals over many channels, where a statistics handler per channel isn't.
+ *
+ * Turning it off stops the counting but keeps the counts, a gauge like AWS_IO_METRIC_OPEN_CHANNELS is then only
+ * meaningful if it was on for the whole life of the channels.
+ */
+AWS_IO_API
+void aws_io_metrics_set_enabled(bool enabled);
+
+/**
+ * Returns whether the metrics registry is counting.
+ */
+AWS_IO_API
+bool aws_io_metrics_is_enabled(void);
+
+/**
+ * Adds delta to a metric, in the calling event loop's shard. Does nothing while the registry is off. For handlers
+ * outside the library as much as for the ones in it.
+ */
+AWS_IO_API
+void aws_io_metrics_add(enum aws_io_metric metric, int64_t delta);
+
+/**
+ * Fills snapshot with the totals of every metric, including the counts of event loops since destroyed. The shards are
+ * read one after the other while they go on counting, so the totals aren't from a single instant.
+ */
+AWS_IO_API
+void aws_io_metrics_snapshot(struct aws_io_metrics_snapshot *snapshot);
+
 /**
  * Initializes socket channel handler statistics
  */
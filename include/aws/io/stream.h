@@ -9,6 +9,7 @@
 #include <aws/io/io.h>
 
 struct aws_input_stream;
+struct aws_shared_file;
 struct aws_byte_buf;
 
 /*
@@ -18,6 +19,11 @@ struct aws_byte_buf;
  */
 enum aws_stream_seek_basis { AWS_SSB_BEGIN = 0, AWS_SSB_END = 2 };
 
+/*
+ * Checksums a checksumming stream can compute.
+ */
+enum aws_stream_checksum_algorithm { AWS_SCA_CRC32, AWS_SCA_CRC32C };
+
 struct aws_stream_status {
     bool is_end_of_stream;
     bool is_valid;
@@ -101,6 +107,93 @@ AWS_IO_API struct aws_input_stream *aws_input_stream_new_from_file(
  */
 AWS_IO_API struct aws_input_stream *aws_input_stream_new_from_open_file(struct aws_allocator *allocator, FILE *file);
 
+/*
+ * Creates a stream that maps a whole file read-only into memory and reads and seeks within the mapping, without stdio
+ * buffering or system calls per read. The OS is told the mapping will be read sequentially. Destruction unmaps the
+ * file. The file must not be truncated while the stream exists.
+ */
+AWS_IO_API struct aws_input_stream *aws_input_stream_new_from_mmap(
+    struct aws_allocator *allocator,
+    const char *file_name);
+
+/*
+ * Opens a file once for any number of file region streams to read concurrently. The file is read with positional reads
+ * (pread() on POSIX), so the streams share one descriptor and no file position, and need no locking. The returned
+ * file has a reference count of 1 and is closed when the last reference goes away; every region stream holds one.
+ */
+AWS_IO_API struct aws_shared_file *aws_shared_file_new(struct aws_allocator *allocator, const char *file_name);
+
+AWS_IO_API struct aws_shared_file *aws_shared_file_acquire(struct aws_shared_file *shared_file);
+
+AWS_IO_API void aws_shared_file_release(struct aws_shared_file *shared_file);
+
+/*
+ * Returns the length of the file when it was opened.
+ */
+AWS_IO_API int64_t aws_shared_file_get_length(const struct aws_shared_file *shared_file);
+
+/*
+ * Creates a stream over length bytes of a shared file starting at offset, e.g. one part of a multipart upload. Seeks,
+ * the stream length and end of stream are relative to the region. Streams over the same file can be read from
+ * different threads at once, a single stream is no more thread-safe than any other. The region must lie within the
+ * file, or AWS_ERROR_INVALID_ARGUMENT is raised.
+ */
+AWS_IO_API struct aws_input_stream *aws_input_stream_new_from_file_region(
+    struct aws_allocator *allocator,
+    struct aws_shared_file *shared_file,
+    uint64_t offset,
+    uint64_t length);
+
+/*
+ * Creates a stream that reads from source, taking ownership of it on success, and computes a running checksum of the
+ * bytes that pass through, so a body can be checksummed in the same pass that sends it. CRC32C uses the CPU's CRC32
+ * instructions where there are any. Seeking back to the beginning restarts the checksum; seeking anywhere else would
+ * leave it meaningless and raises AWS_ERROR_UNSUPPORTED_OPERATION.
+ */
+AWS_IO_API struct aws_input_stream *aws_input_stream_new_checksum(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    enum aws_stream_checksum_algorithm algorithm);
+
+/*
+ * Creates a stream that reads from source, taking ownership of it on success, read_ahead_size bytes at a time: small
+ * reads are served from what the last large read brought in, so a source that is expensive per call (decompression,
+ * a network-backed stream) is called once per read_ahead_size bytes rather than once per read. Reads with room for
+ * read_ahead_size bytes or more go straight to the source. Seeking drops whatever was read ahead. Wrapped in
+ * aws_async_input_stream_new_from_sync(), the large reads run on the I/O thread.
+ */
+AWS_IO_API struct aws_input_stream *aws_input_stream_new_read_ahead(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    size_t read_ahead_size);
+
+/*
+ * Returns the checksum of everything a stream made by aws_input_stream_new_checksum() has read so far, which is the
+ * checksum of the whole source once the stream has reached its end. Raises AWS_ERROR_UNSUPPORTED_OPERATION for any
+ * other kind of stream.
+ */
+AWS_IO_API int aws_input_stream_get_checksum(struct aws_input_stream *stream, uint32_t *out_checksum);
+
+/*
+ * Reads up to max_len bytes from a stream made by aws_input_stream_new_from_cursor() or
+ * aws_input_stream_new_from_mmap() without copying them: out_cursor is pointed at the stream's own memory, which stays
+ * valid until the stream is destroyed (or, for a cursor stream, for as long as the memory it was made from), and the
+ * stream advances past it. out_cursor is empty at the end of the stream. For example, an aws_io_message's
+ * message_data can be pointed at the bytes instead of reading them into it. Raises AWS_ERROR_UNSUPPORTED_OPERATION
+ * for any other kind of stream.
+ */
+AWS_IO_API int aws_input_stream_read_borrowed(
+    struct aws_input_stream *stream,
+    size_t max_len,
+    struct aws_byte_cursor *out_cursor);
+
+/*
+ * Returns the file behind a stream made by aws_input_stream_new_from_file() or aws_input_stream_new_from_open_file(),
+ * or NULL for any other kind of stream. Lets a caller hand file-backed bodies to aws_socket_write_from_file()
+ * instead of reading them through userspace.
+ */
+AWS_IO_API FILE *aws_input_stream_get_file(struct aws_input_stream *stream);
+
 AWS_EXTERN_C_END
 
 #endif /* AWS_IO_STREAM_H */
@@ -10,6 +10,7 @@
 
 struct aws_channel_slot;
 struct aws_channel_handler;
+struct aws_event_loop_group;
 struct aws_string;
 
 enum aws_tls_versions {
@@ -70,6 +71,13 @@ typedef void(aws_tls_on_error_fn)(
     const char *message,
     void *user_data);
 
+/**
+ * Returns the handler for new_slot, the slot that will carry the protocol ALPN settled on, or NULL if there's none for
+ * protocol. See aws_tls_alpn_handler_new() and aws_tls_connection_options.on_protocol_negotiated.
+ */
+typedef struct aws_channel_handler *(
+    *aws_tls_on_protocol_negotiated)(struct aws_channel_slot *new_slot, struct aws_byte_buf *protocol, void *user_data);
+
 struct aws_tls_connection_options {
     /** semi-colon delimited list of protocols. Example:
      *  h2;http/1.1
@@ -83,13 +91,48 @@ struct aws_tls_connection_options {
      * for verifying the subj alt name and common name of the peer's certificate.
      */
     struct aws_string *server_name;
+    /**
+     * Port of the peer, combined with server_name to look up sessions to resume when the ctx has a session cache.
+     * The client bootstrap fills this in with the port being connected to if it's left at 0.
+     */
+    uint16_t server_port;
     aws_tls_on_negotiation_result_fn *on_negotiation_result;
     aws_tls_on_data_read_fn *on_data_read;
     aws_tls_on_error_fn *on_error;
     void *user_data;
     struct aws_tls_ctx *ctx;
     bool advertise_alpn_message;
+    /**
+     * default is NULL. If set, once ALPN settles on a protocol the TLS handler puts a new slot to its right and calls
+     * this, with user_data, for that slot's handler, just before on_negotiation_result. No
+     * AWS_TLS_NEGOTIATED_PROTOCOL_MESSAGE is sent, so there's no ALPN handler to install and no extra slot to swap
+     * out. Takes the place of advertise_alpn_message. Returning NULL shuts the channel down with
+     * AWS_IO_UNHANDLED_ALPN_PROTOCOL_MESSAGE.
+     */
+    aws_tls_on_protocol_negotiated on_protocol_negotiated;
+    /**
+     * default is false. s2n only, other implementations keep failing such writes.
+     * Lets writes reach the TLS handler before negotiation completes instead of failing them with
+     * AWS_IO_TLS_ERROR_NOT_NEGOTIATED. They are held until the handshake succeeds and then sent ahead of anything
+     * written from on_negotiation_result, or completed with an error if it fails.
+     * This is not TLS 1.3 early data, which this library doesn't negotiate: the bytes still follow the handshake.
+     * They just go out in the same tick it finishes, which on a resumed session comes right behind the client's
+     * Finished message, instead of waiting for the caller to react to the negotiation result.
+     */
+    bool queue_writes_before_negotiation;
     uint32_t timeout_ms;
+    /**
+     * default is 0, off. s2n only, other implementations always send records of up to max_fragment_size.
+     * If set, records start out small enough to fit a single TCP segment, so the peer can decrypt the first bytes of a
+     * response without waiting for a full 16KB record to arrive, and grow to full size once this many bytes have been
+     * sent on the connection. See aws_tls_connection_options_set_dynamic_record_sizing().
+     */
+    uint32_t dynamic_record_threshold;
+    /**
+     * With dynamic_record_threshold set, records go back to being small after the connection has sent nothing for
+     * this many seconds. 0 means they never do.
+     */
+    uint16_t dynamic_record_reset_timeout_secs;
 };
 
 struct aws_tls_ctx_options {
@@ -174,17 +217,92 @@ struct aws_tls_ctx_options {
      * If you set this in server mode, it enforces client authentication.
      */
     bool verify_peer;
+
+    /**
+     * default is false. Linux + s2n only, and only when built with USE_KTLS.
+     * Once the handshake completes, hands the session's write keys to the kernel (kernel TLS), so outgoing
+     * application data is encrypted by the kernel and the TLS handler just passes plaintext on to the socket.
+     * If the kernel, s2n or the negotiated cipher can't support it, the handler quietly keeps encrypting itself.
+     * Reads are always decrypted by the TLS handler.
+     */
+    bool enable_ktls;
+
+    /**
+     * Client only. default is 0, which turns session resumption off.
+     * Otherwise every connection made from the ctx shares a cache of up to this many sessions, keyed by
+     * server_name:port, so reconnecting to an endpoint resumes the previous session instead of doing a full handshake.
+     * With s2n the cache lives in the ctx and honors session_cache_ttl_secs. Secure Transport and Secure Channel keep
+     * sessions in the OS's own cache, the ctx just makes them reusable across its connections, and the OS decides
+     * how many to keep and for how long.
+     */
+    size_t session_cache_max_entries;
+
+    /**
+     * How long a cached client session may be resumed, in seconds. See session_cache_max_entries.
+     * 0 means AWS_TLS_SESSION_CACHE_DEFAULT_TTL_SECS.
+     */
+    uint32_t session_cache_ttl_secs;
+
+    /**
+     * Server only, s2n only. default is 0, which turns session tickets off.
+     * Otherwise the ctx issues session tickets, encrypting them with a random key that is replaced by a fresh one
+     * every session_ticket_key_rotation_secs. Tickets stay decryptable for one more period after their key is
+     * retired. Keys are generated up front for AWS_TLS_SESSION_TICKET_KEY_COUNT periods, a ctx that outlives them
+     * stops issuing tickets and should be replaced.
+     */
+    uint32_t session_ticket_key_rotation_secs;
+
+    /**
+     * default is NULL. s2n only, and only useful with a certificate and private key.
+     * If set, the private key operation of each handshake (signing for servers and for clients doing mutual TLS) runs
+     * on one of this group's event loops instead of the channel's, and negotiation picks back up on the channel's
+     * thread once it's done. Use a group dedicated to this, so a flood of new connections only costs the other
+     * channels on a loop the cheap parts of their handshakes. The ctx holds a reference to the group.
+     */
+    struct aws_event_loop_group *private_key_offload_elg;
+
+    /**
+     * s2n only. default is 0, which turns connection pooling off.
+     * Otherwise, when a TLS handler made from the ctx is destroyed, its s2n connection is wiped and kept for the next
+     * handler on the same event loop, up to this many per event loop, which saves allocating and initializing one
+     * for every new connection. Idle connections are freed with the ctx or the event loop, whichever goes first.
+     */
+    size_t connection_pool_size;
+
+    /**
+     * s2n only. default is false.
+     * If set, each connection frees its s2n record buffers (about 34KB) whenever it has nothing left to read or
+     * write, and allocates them again for the next record. Worth it for large numbers of mostly idle connections;
+     * busy ones pay an allocation per burst of traffic.
+     */
+    bool release_idle_buffers;
+
+    /**
+     * s2n only. default is 0, which hands ciphertext to the TLS handler in pool messages.
+     * Otherwise each connection gets a ring buffer of this many bytes that the socket handler reads ciphertext
+     * straight into and s2n decrypts out of, saving a pool message, and a linked list entry, per socket read. The
+     * memory is held for the connection's lifetime, so 32KB or so is plenty; reads fall back to messages whenever
+     * the ring is full, and data from a handler other than the socket handler always comes as messages.
+     */
+    size_t input_ring_size;
 };
 
+/**
+ * Number of session ticket keys a server ctx schedules. See aws_tls_ctx_options.session_ticket_key_rotation_secs.
+ */
+#define AWS_TLS_SESSION_TICKET_KEY_COUNT 24
+
+/**
+ * How long cached client sessions are kept when aws_tls_ctx_options.session_cache_ttl_secs is 0.
+ */
+#define AWS_TLS_SESSION_CACHE_DEFAULT_TTL_SECS 3600
+
 struct aws_tls_negotiated_protocol_message {
     struct aws_byte_buf protocol;
 };
 
 static const int AWS_TLS_NEGOTIATED_PROTOCOL_MESSAGE = 0x01;
 
-typedef struct aws_channel_handler *(
-    *aws_tls_on_protocol_negotiated)(struct aws_channel_slot *new_slot, struct aws_byte_buf *protocol, void *user_data);
-
 /**
  * An enum for the current state of tls negotiation within a tls channel handler
  */
@@ -341,6 +459,49 @@ AWS_IO_API int aws_tls_ctx_options_set_alpn_list(struct aws_tls_ctx_options *opt
  */
 AWS_IO_API void aws_tls_ctx_options_set_verify_peer(struct aws_tls_ctx_options *options, bool verify_peer);
 
+/**
+ * Asks for kernel TLS offload of outgoing records where available. See aws_tls_ctx_options.enable_ktls.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_ktls_enabled(struct aws_tls_ctx_options *options, bool enable_ktls);
+
+/**
+ * Turns on client session resumption, see aws_tls_ctx_options.session_cache_max_entries.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_session_cache(
+    struct aws_tls_ctx_options *options,
+    size_t max_entries,
+    uint32_t ttl_secs);
+
+/**
+ * Turns on server session tickets, see aws_tls_ctx_options.session_ticket_key_rotation_secs.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_session_ticket_key_rotation(
+    struct aws_tls_ctx_options *options,
+    uint32_t rotation_secs);
+
+/**
+ * Runs private key operations on el_group, see aws_tls_ctx_options.private_key_offload_elg.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_private_key_offload(
+    struct aws_tls_ctx_options *options,
+    struct aws_event_loop_group *el_group);
+
+/**
+ * Keeps up to pool_size idle connections per event loop for reuse, see aws_tls_ctx_options.connection_pool_size.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_connection_pool_size(struct aws_tls_ctx_options *options, size_t pool_size);
+
+/**
+ * Frees each connection's TLS record buffers while it is idle, see aws_tls_ctx_options.release_idle_buffers.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_release_idle_buffers(struct aws_tls_ctx_options *options, bool release);
+
+/**
+ * Gives each connection a ring buffer of ring_size bytes to receive ciphertext in, see
+ * aws_tls_ctx_options.input_ring_size.
+ */
+AWS_IO_API void aws_tls_ctx_options_set_input_ring_size(struct aws_tls_ctx_options *options, size_t ring_size);
+
 /**
  * Sets the minimum TLS version to allow.
  */
@@ -415,6 +576,17 @@ AWS_IO_API int aws_tls_connection_options_set_alpn_list(
     struct aws_allocator *allocator,
     const char *alpn_list);
 
+/**
+ * Turns on dynamic record sizing, the way browsers and nginx do it: small records for the first threshold bytes of
+ * the connection, for time to first byte, then full size ones for throughput, back to small after
+ * reset_timeout_secs idle (0 to never reset). Pass a threshold of 0 to turn it off. Only the s2n implementation
+ * supports this, the others ignore it.
+ */
+AWS_IO_API void aws_tls_connection_options_set_dynamic_record_sizing(
+    struct aws_tls_connection_options *conn_options,
+    uint32_t threshold,
+    uint16_t reset_timeout_secs);
+
 /********************************* TLS context and state management *********************************/
 
 /**
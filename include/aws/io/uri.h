@@ -25,6 +25,21 @@ struct aws_uri {
     struct aws_byte_cursor path_and_query;
 };
 
+/**
+ * The parts of a URI parsed in place: every cursor points into the string that was parsed (or, for a missing path, at
+ * a static "/"), so a view allocates nothing and needs no clean up, but is only valid as long as that string is.
+ * The parts mean the same as the aws_uri accessors of the same names.
+ */
+struct aws_uri_view {
+    struct aws_byte_cursor scheme;
+    struct aws_byte_cursor authority;
+    struct aws_byte_cursor host_name;
+    uint16_t port;
+    struct aws_byte_cursor path;
+    struct aws_byte_cursor query_string;
+    struct aws_byte_cursor path_and_query;
+};
+
 /**
  * key/value pairs for a query string. If the query fragment was not in format key=value, the fragment value
  * will be stored in key
@@ -132,6 +147,19 @@ AWS_IO_API bool aws_uri_query_string_next_param(const struct aws_uri *uri, struc
  */
 AWS_IO_API int aws_uri_query_string_params(const struct aws_uri *uri, struct aws_array_list *out_params);
 
+/**
+ * Parses 'uri_str' into view without copying it or allocating anything, e.g. for the request-target of every request
+ * a server receives. The same rules as aws_uri_init_parse() apply. Returns AWS_OP_SUCCESS on success, AWS_OP_ERR
+ * on failure, in which case view is zeroed out.
+ */
+AWS_IO_API int aws_uri_view_parse(struct aws_uri_view *view, struct aws_byte_cursor uri_str);
+
+/**
+ * Same as aws_uri_query_string_next_param(), for a view. The params it returns point into the parsed string, so
+ * iterating the query string this way needs no array list or any other allocation.
+ */
+AWS_IO_API bool aws_uri_view_query_string_next_param(const struct aws_uri_view *view, struct aws_uri_param *param);
+
 /**
  * Writes the uri path encoding of a cursor to a buffer.  This is the modified version of rfc3986 used by
  * sigv4 signing.
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 #include <aws/common/clock.h>
+#include <aws/common/math.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/io/channel.h>
 #include <aws/io/event_loop.h>
@@ -12,6 +13,8 @@
 #include <aws/io/statistics.h>
 #include <aws/testing/aws_test_harness.h>
 
+#include <string.h>
+
 struct testing_loop {
     struct aws_task_scheduler scheduler;
     bool mock_on_callers_thread;
@@ -75,6 +78,28 @@ static struct aws_event_loop_vtable s_testing_loop_vtable = {
     .wait_for_stop_completion = s_testing_loop_wait_for_stop_completion,
 };
 
+/**
+ * A clock that only moves when the test moves it, so that anything scheduled in the future runs at exactly the
+ * simulated time it asked for, however long the code under test really takes. Pass testing_virtual_clock_get_ticks as
+ * aws_testing_channel_options.clock_fn, then let testing_channels_run_until() move it. There is one per translation
+ * unit, shared by every testing channel using it.
+ */
+static uint64_t s_testing_virtual_clock_ns = 0;
+
+static inline int testing_virtual_clock_get_ticks(uint64_t *timestamp) {
+    *timestamp = s_testing_virtual_clock_ns;
+    return AWS_OP_SUCCESS;
+}
+
+static inline uint64_t testing_virtual_clock_now(void) {
+    return s_testing_virtual_clock_ns;
+}
+
+/** Moves the virtual clock. It is up to the caller not to move it backwards past scheduled tasks. */
+static inline void testing_virtual_clock_set(uint64_t now_ns) {
+    s_testing_virtual_clock_ns = now_ns;
+}
+
 static struct aws_event_loop *s_testing_loop_new(struct aws_allocator *allocator, aws_io_clock_fn clock) {
     struct aws_event_loop *event_loop = aws_mem_acquire(allocator, sizeof(struct aws_event_loop));
     aws_event_loop_init_base(event_loop, allocator, clock);
@@ -94,6 +119,33 @@ typedef void(testing_channel_handler_on_shutdown_fn)(
     bool free_scarce_resources_immediately,
     void *user_data);
 
+/**
+ * How a shaped left-most handler treats what it is asked to write, like a socket on a network link: each write is
+ * serialized at bytes_per_second one after the other, completes once it has been, and reaches the peer latency_ns
+ * after that. See testing_channel_connect().
+ */
+struct testing_link_options {
+    /* 0 for no bandwidth limit */
+    uint64_t bytes_per_second;
+    uint64_t latency_ns;
+};
+
+struct testing_channel_handler;
+
+struct testing_link {
+    struct testing_link_options options;
+    /* the slot of the handler this link belongs to */
+    struct aws_channel_slot *slot;
+    /* where written data ends up, NULL to drop it once sent */
+    struct testing_channel_handler *peer;
+    /* when the last write queued on the link is done serializing */
+    uint64_t busy_until_ns;
+    /* delivered here by the peer, not yet passed up the channel because of its read window */
+    struct aws_linked_list pending_reads;
+    uint64_t bytes_sent;
+    uint64_t bytes_delivered;
+};
+
 struct testing_channel_handler {
     struct aws_linked_list messages;
     size_t latest_window_update;
@@ -103,8 +155,141 @@ struct testing_channel_handler {
     testing_channel_handler_on_shutdown_fn *on_shutdown;
     void *on_shutdown_user_data;
     struct aws_crt_statistics_socket stats;
+    /* once shaped, writes go over link instead of into messages */
+    bool shaped;
+    struct testing_link link;
+};
+
+/* One write on its way over a link: first until it is sent, on the writer's channel, then until it is delivered, on
+ * the peer's. */
+struct testing_link_transfer {
+    struct aws_allocator *allocator;
+    struct aws_channel_task task;
+    struct testing_channel_handler *handler;
+    struct aws_io_message *message;
+    uint64_t sent_at_ns;
 };
 
+/* Passes what the link has received up the channel, as far as the read window allows. */
+static inline void s_testing_link_flush_reads(struct testing_link *link) {
+    while (!aws_linked_list_empty(&link->pending_reads)) {
+        size_t window = aws_channel_slot_downstream_read_window(link->slot);
+        if (window == 0) {
+            return;
+        }
+
+        struct aws_linked_list_node *node = aws_linked_list_front(&link->pending_reads);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        if (message->message_data.len > window) {
+            /* split off what fits, the rest stays first in line */
+            struct aws_io_message *head =
+                aws_channel_acquire_message_from_pool(link->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, window);
+            if (!head) {
+                return;
+            }
+            window = aws_min_size(window, head->message_data.capacity);
+            aws_byte_buf_write(&head->message_data, message->message_data.buffer, window);
+            memmove(
+                message->message_data.buffer,
+                message->message_data.buffer + window,
+                message->message_data.len - window);
+            message->message_data.len -= window;
+            message = head;
+        } else {
+            aws_linked_list_pop_front(&link->pending_reads);
+        }
+
+        link->bytes_delivered += message->message_data.len;
+        if (aws_channel_slot_send_message(link->slot, message, AWS_CHANNEL_DIR_READ)) {
+            aws_mem_release(message->allocator, message);
+            return;
+        }
+    }
+}
+
+static inline void s_testing_link_deliver_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct testing_link_transfer *transfer = arg;
+    struct testing_link *link = &transfer->handler->link;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        /* the written message belongs to the writer's message pool, so it's copied into one of ours */
+        struct aws_byte_cursor data = aws_byte_cursor_from_buf(&transfer->message->message_data);
+        while (data.len > 0) {
+            struct aws_io_message *copy =
+                aws_channel_acquire_message_from_pool(link->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, data.len);
+            if (!copy) {
+                break;
+            }
+            struct aws_byte_cursor chunk =
+                aws_byte_cursor_advance(&data, aws_min_size(data.len, copy->message_data.capacity));
+            aws_byte_buf_write_from_whole_cursor(&copy->message_data, chunk);
+            aws_linked_list_push_back(&link->pending_reads, &copy->queueing_handle);
+        }
+    }
+
+    aws_mem_release(transfer->message->allocator, transfer->message);
+    aws_mem_release(transfer->allocator, transfer);
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_testing_link_flush_reads(link);
+    }
+}
+
+static inline void s_testing_link_sent_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct testing_link_transfer *transfer = arg;
+    struct testing_channel_handler *handler = transfer->handler;
+    struct aws_channel_slot *slot = handler->link.slot;
+    struct aws_io_message *message = transfer->message;
+
+    if (message->on_completion) {
+        int error_code = status == AWS_TASK_STATUS_RUN_READY ? AWS_ERROR_SUCCESS : AWS_IO_SOCKET_CLOSED;
+        message->on_completion(slot->channel, message, error_code, message->user_data);
+        message->on_completion = NULL;
+    }
+
+    struct testing_channel_handler *peer = handler->link.peer;
+    if (status == AWS_TASK_STATUS_RUN_READY && peer) {
+        transfer->handler = peer;
+        aws_channel_task_init(&transfer->task, s_testing_link_deliver_task, transfer, "testing_link_deliver");
+        aws_channel_schedule_task_future(
+            peer->link.slot->channel, &transfer->task, transfer->sent_at_ns + handler->link.options.latency_ns);
+        return;
+    }
+
+    aws_mem_release(message->allocator, message);
+    aws_mem_release(transfer->allocator, transfer);
+}
+
+static inline int s_testing_link_write(struct testing_channel_handler *handler, struct aws_io_message *message) {
+    struct testing_link *link = &handler->link;
+    struct testing_link_transfer *transfer =
+        aws_mem_calloc(link->slot->alloc, 1, sizeof(struct testing_link_transfer));
+    if (!transfer) {
+        return AWS_OP_ERR;
+    }
+
+    uint64_t now = 0;
+    aws_channel_current_clock_time(link->slot->channel, &now);
+    uint64_t start_ns = aws_max_u64(now, link->busy_until_ns);
+    uint64_t serialize_ns = 0;
+    if (link->options.bytes_per_second) {
+        serialize_ns = aws_mul_u64_saturating(message->message_data.len, AWS_TIMESTAMP_NANOS) /
+                       link->options.bytes_per_second;
+    }
+    link->busy_until_ns = start_ns + serialize_ns;
+    link->bytes_sent += message->message_data.len;
+
+    transfer->allocator = link->slot->alloc;
+    transfer->handler = handler;
+    transfer->message = message;
+    transfer->sent_at_ns = link->busy_until_ns;
+    aws_channel_task_init(&transfer->task, s_testing_link_sent_task, transfer, "testing_link_sent");
+    aws_channel_schedule_task_future(link->slot->channel, &transfer->task, transfer->sent_at_ns);
+    return AWS_OP_SUCCESS;
+}
+
 static int s_testing_channel_handler_process_read_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -125,6 +310,10 @@ static int s_testing_channel_handler_process_write_message(
     (void)slot;
 
     struct testing_channel_handler *testing_handler = handler->impl;
+    if (testing_handler->shaped) {
+        return s_testing_link_write(testing_handler, message);
+    }
+
     aws_linked_list_push_back(&testing_handler->messages, &message->queueing_handle);
 
     /* Invoke completion callback if this is the left-most handler */
@@ -144,6 +333,9 @@ static int s_testing_channel_handler_increment_read_window(
 
     struct testing_channel_handler *testing_handler = handler->impl;
     testing_handler->latest_window_update = size;
+    if (testing_handler->link.slot) {
+        s_testing_link_flush_reads(&testing_handler->link);
+    }
     return AWS_OP_SUCCESS;
 }
 
@@ -201,6 +393,12 @@ static void s_testing_channel_handler_destroy(struct aws_channel_handler *handle
         aws_mem_release(msg->allocator, msg);
     }
 
+    while (!aws_linked_list_empty(&testing_handler->link.pending_reads)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&testing_handler->link.pending_reads);
+        struct aws_io_message *msg = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        aws_mem_release(msg->allocator, msg);
+    }
+
     aws_mem_release(handler->alloc, testing_handler);
     aws_mem_release(handler->alloc, handler);
 }
@@ -239,6 +437,7 @@ static struct aws_channel_handler *s_new_testing_channel_handler(
     struct testing_channel_handler *testing_handler =
         aws_mem_calloc(allocator, 1, sizeof(struct testing_channel_handler));
     aws_linked_list_init(&testing_handler->messages);
+    aws_linked_list_init(&testing_handler->link.pending_reads);
     testing_handler->initial_window = initial_window;
     testing_handler->latest_window_update = 0;
     testing_handler->complete_write_immediately = true;
@@ -419,6 +618,13 @@ static inline int testing_channel_init(
 }
 
 static inline int testing_channel_clean_up(struct testing_channel *testing) {
+    /* whatever the peer still sends this way is dropped from now on */
+    struct testing_channel_handler *peer = testing->left_handler_impl->link.peer;
+    if (peer && peer->link.peer == testing->left_handler_impl) {
+        peer->link.peer = NULL;
+    }
+    testing->left_handler_impl->link.peer = NULL;
+
     aws_channel_shutdown(testing->channel, AWS_ERROR_SUCCESS);
 
     /* Wait for channel to finish shutdown */
@@ -451,6 +657,96 @@ static inline int testing_channel_install_downstream_handler(struct testing_chan
     return AWS_OP_SUCCESS;
 }
 
+/**
+ * Shapes what the channel's left-most handler writes with options, and delivers it to peer's channel in the read
+ * direction, or drops it if peer is NULL. Written messages no longer show up in the written message queue. Meant for
+ * channels on the virtual clock, driven with testing_channels_run_until(); call it once for each direction.
+ */
+static inline void testing_channel_connect(
+    struct testing_channel *testing,
+    struct testing_channel *peer,
+    const struct testing_link_options *options) {
+
+    struct testing_channel_handler *handler = testing->left_handler_impl;
+    handler->shaped = true;
+    handler->link.options = *options;
+    handler->link.slot = testing->left_handler_slot;
+    handler->link.peer = peer ? peer->left_handler_impl : NULL;
+
+    if (peer) {
+        /* the peer's side must know its slot to deliver to, even before it is shaped itself */
+        peer->left_handler_impl->link.slot = peer->left_handler_slot;
+    }
+}
+
+/** Bytes the channel's link has finished putting on the wire and bytes it has passed up its own channel. */
+static inline uint64_t testing_channel_link_bytes_sent(const struct testing_channel *testing) {
+    return testing->left_handler_impl->link.bytes_sent;
+}
+
+static inline uint64_t testing_channel_link_bytes_delivered(const struct testing_channel *testing) {
+    return testing->left_handler_impl->link.bytes_delivered;
+}
+
+/**
+ * Runs the tasks of all the channels in the order of their scheduled time, moving the virtual clock forward to each
+ * one, until no task is due at or before end_ns. Leaves the clock at end_ns. Tasks scheduled from one channel onto
+ * another, as a link's deliveries are, run in order with the rest.
+ */
+static inline void testing_channels_run_until(struct testing_channel **channels, size_t count, uint64_t end_ns) {
+    while (true) {
+        uint64_t next_task_time = UINT64_MAX;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t task_time = 0;
+            if (aws_task_scheduler_has_tasks(&channels[i]->loop_impl->scheduler, &task_time) &&
+                task_time < next_task_time) {
+                next_task_time = task_time;
+            }
+        }
+
+        if (next_task_time > end_ns) {
+            break;
+        }
+
+        if (next_task_time > s_testing_virtual_clock_ns) {
+            s_testing_virtual_clock_ns = next_task_time;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            aws_task_scheduler_run_all(&channels[i]->loop_impl->scheduler, s_testing_virtual_clock_ns);
+        }
+    }
+
+    if (end_ns > s_testing_virtual_clock_ns) {
+        s_testing_virtual_clock_ns = end_ns;
+    }
+}
+
+/**
+ * Runs every task the channels have, now or in the future, until none is left, and returns the virtual time that
+ * takes. Never returns if a task keeps rescheduling itself.
+ */
+static inline uint64_t testing_channels_run_until_idle(struct testing_channel **channels, size_t count) {
+    uint64_t start_ns = s_testing_virtual_clock_ns;
+    while (true) {
+        bool has_tasks = false;
+        uint64_t next_task_time = UINT64_MAX;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t task_time = 0;
+            if (aws_task_scheduler_has_tasks(&channels[i]->loop_impl->scheduler, &task_time)) {
+                has_tasks = true;
+                next_task_time = aws_min_u64(next_task_time, task_time);
+            }
+        }
+
+        if (!has_tasks) {
+            return s_testing_virtual_clock_ns - start_ns;
+        }
+
+        testing_channels_run_until(channels, count, aws_max_u64(next_task_time, s_testing_virtual_clock_ns));
+    }
+}
+
 /** Return whether channel is completely shut down */
 static inline bool testing_channel_is_shutdown_completed(const struct testing_channel *testing) {
     return testing->channel_shutdown_completed;
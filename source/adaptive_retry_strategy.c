@@ -0,0 +1,536 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/retry_strategy.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/logging.h>
+#include <aws/common/mutex.h>
+#include <aws/common/task_scheduler.h>
+
+#include <inttypes.h>
+
+/* Rate limiter constants, the same as the adaptive retry mode of the AWS SDKs. Rates are in sends per second. */
+static const double s_min_fill_rate = 0.5;
+static const double s_min_capacity = 1.0;
+/* weight of the newest sample in the measured send rate */
+static const double s_smooth = 0.8;
+/* how much of the rate is kept on throttling */
+static const double s_beta = 0.7;
+/* how fast the rate grows back, the C of CUBIC */
+static const double s_scale_constant = 0.4;
+/* the measured send rate is sampled over buckets of this many seconds */
+static const double s_tx_rate_bucket_seconds = 0.5;
+
+/* All of it is guarded by adaptive_retry_strategy.synced_data.lock. Times are in seconds. */
+struct adaptive_rate_limiter {
+    /* nothing is limited until the first throttling error */
+    bool enabled;
+    double fill_rate;
+    double max_capacity;
+    /* goes negative when acquisitions are waiting for the bucket, each of them owes one send */
+    double current_capacity;
+    double last_timestamp;
+    double measured_tx_rate;
+    double last_tx_rate_bucket;
+    size_t request_count;
+    double last_max_rate;
+    double last_throttle_time;
+    double time_window;
+};
+
+struct adaptive_retry_strategy {
+    struct aws_retry_strategy base;
+    struct aws_retry_strategy *standard_strategy;
+    struct aws_event_loop_group *el_group;
+
+    struct {
+        struct aws_mutex lock;
+        struct adaptive_rate_limiter rate_limiter;
+    } synced_data;
+};
+
+struct adaptive_retry_token {
+    struct aws_retry_token base;
+    /* NULL until the standard strategy has vended it */
+    struct aws_retry_token *standard_token;
+    struct aws_event_loop *bound_loop;
+    /* runs a token acquisition or a retry once the rate limiter admits it */
+    struct aws_task admission_task;
+    /* copy of the partition id for a delayed acquisition */
+    struct aws_byte_buf partition_id;
+    bool has_partition_id;
+    aws_retry_strategy_on_retry_token_acquired_fn *acquired_fn;
+    void *acquired_user_data;
+
+    struct {
+        struct aws_mutex mutex;
+        aws_retry_strategy_on_retry_ready_fn *retry_ready_fn;
+        void *user_data;
+    } thread_data;
+};
+
+static double s_now_seconds(void) {
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+    return (double)now_ns / (double)AWS_TIMESTAMP_NANOS;
+}
+
+/* Only used on non-negative values, and kept here so the library doesn't need libm. */
+static double s_floor(double value) {
+    return (double)(uint64_t)value;
+}
+
+/* Newton's method. Only used on non-negative values, and kept here so the library doesn't need libm. */
+static double s_cube_root(double value) {
+    if (value <= 0.0) {
+        return 0.0;
+    }
+
+    double root = value > 1.0 ? value / 3.0 : 1.0;
+    for (size_t i = 0; i < 100; ++i) {
+        double next = root - (root * root * root - value) / (3.0 * root * root);
+        if (next == root) {
+            break;
+        }
+        root = next;
+    }
+
+    return root;
+}
+
+static void s_rate_limiter_init(struct adaptive_rate_limiter *rate_limiter) {
+    AWS_ZERO_STRUCT(*rate_limiter);
+    rate_limiter->last_tx_rate_bucket = s_floor(s_now_seconds());
+    rate_limiter->last_throttle_time = s_now_seconds();
+}
+
+static void s_rate_limiter_refill(struct adaptive_rate_limiter *rate_limiter, double now) {
+    if (rate_limiter->last_timestamp > 0.0 && now > rate_limiter->last_timestamp) {
+        double fill_amount = (now - rate_limiter->last_timestamp) * rate_limiter->fill_rate;
+        rate_limiter->current_capacity += fill_amount;
+        if (rate_limiter->current_capacity > rate_limiter->max_capacity) {
+            rate_limiter->current_capacity = rate_limiter->max_capacity;
+        }
+    }
+
+    rate_limiter->last_timestamp = now;
+}
+
+/* Takes one send out of the bucket and returns how many seconds the caller must wait for it. */
+static double s_rate_limiter_reserve(struct adaptive_rate_limiter *rate_limiter, double now) {
+    if (!rate_limiter->enabled) {
+        return 0.0;
+    }
+
+    s_rate_limiter_refill(rate_limiter, now);
+    rate_limiter->current_capacity -= 1.0;
+
+    if (rate_limiter->current_capacity >= 0.0) {
+        return 0.0;
+    }
+
+    return -rate_limiter->current_capacity / rate_limiter->fill_rate;
+}
+
+static void s_rate_limiter_update_measured_rate(struct adaptive_rate_limiter *rate_limiter, double now) {
+    double time_bucket = s_floor(now / s_tx_rate_bucket_seconds) * s_tx_rate_bucket_seconds;
+    rate_limiter->request_count += 1;
+
+    if (time_bucket > rate_limiter->last_tx_rate_bucket) {
+        double current_rate = (double)rate_limiter->request_count / (time_bucket - rate_limiter->last_tx_rate_bucket);
+        rate_limiter->measured_tx_rate = current_rate * s_smooth + rate_limiter->measured_tx_rate * (1.0 - s_smooth);
+        rate_limiter->request_count = 0;
+        rate_limiter->last_tx_rate_bucket = time_bucket;
+    }
+}
+
+/* Feeds the outcome of an attempt to the limiter, which adjusts the fill rate. */
+static void s_rate_limiter_update(struct adaptive_rate_limiter *rate_limiter, bool throttled, double now) {
+    s_rate_limiter_update_measured_rate(rate_limiter, now);
+
+    double calculated_rate = 0.0;
+    if (throttled) {
+        double rate_to_use = rate_limiter->measured_tx_rate;
+        if (rate_limiter->enabled && rate_limiter->fill_rate < rate_to_use) {
+            rate_to_use = rate_limiter->fill_rate;
+        }
+
+        rate_limiter->last_max_rate = rate_to_use;
+        rate_limiter->time_window = s_cube_root(rate_limiter->last_max_rate * (1.0 - s_beta) / s_scale_constant);
+        rate_limiter->last_throttle_time = now;
+        calculated_rate = rate_to_use * s_beta;
+        rate_limiter->enabled = true;
+    } else {
+        rate_limiter->time_window = s_cube_root(rate_limiter->last_max_rate * (1.0 - s_beta) / s_scale_constant);
+        double elapsed = now - rate_limiter->last_throttle_time - rate_limiter->time_window;
+        calculated_rate = s_scale_constant * elapsed * elapsed * elapsed + rate_limiter->last_max_rate;
+    }
+
+    /* never ramp up faster than twice what is actually being sent */
+    double new_rate = calculated_rate;
+    if (new_rate > 2.0 * rate_limiter->measured_tx_rate) {
+        new_rate = 2.0 * rate_limiter->measured_tx_rate;
+    }
+
+    s_rate_limiter_refill(rate_limiter, now);
+    rate_limiter->fill_rate = new_rate > s_min_fill_rate ? new_rate : s_min_fill_rate;
+    rate_limiter->max_capacity = new_rate > s_min_capacity ? new_rate : s_min_capacity;
+    if (rate_limiter->current_capacity > rate_limiter->max_capacity) {
+        rate_limiter->current_capacity = rate_limiter->max_capacity;
+    }
+}
+
+/* Reserves a send with the rate limiter and returns how long to wait for it, unless that is longer than timeout_ms. */
+static uint64_t s_reserve_send(
+    struct adaptive_retry_strategy *adaptive_strategy,
+    uint64_t timeout_ms,
+    bool *timed_out) {
+    double now = s_now_seconds();
+    double delay = 0.0;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&adaptive_strategy->synced_data.lock) && "Rate limiter mutex acquisition failed");
+        delay = s_rate_limiter_reserve(&adaptive_strategy->synced_data.rate_limiter, now);
+        if (timeout_ms && delay * (double)AWS_TIMESTAMP_MILLIS > (double)timeout_ms) {
+            /* give the send back, this one isn't going to wait for it */
+            adaptive_strategy->synced_data.rate_limiter.current_capacity += 1.0;
+            *timed_out = true;
+        }
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&adaptive_strategy->synced_data.lock) && "Rate limiter mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    return (uint64_t)(delay * (double)AWS_TIMESTAMP_NANOS);
+}
+
+static void s_record_outcome(struct adaptive_retry_strategy *adaptive_strategy, bool throttled) {
+    double now = s_now_seconds();
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&adaptive_strategy->synced_data.lock) && "Rate limiter mutex acquisition failed");
+        s_rate_limiter_update(&adaptive_strategy->synced_data.rate_limiter, throttled, now);
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&adaptive_strategy->synced_data.lock) && "Rate limiter mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+}
+
+static void s_adaptive_retry_destroy(struct aws_retry_strategy *retry_strategy) {
+    if (retry_strategy) {
+        struct adaptive_retry_strategy *adaptive_strategy = retry_strategy->impl;
+        aws_retry_strategy_release(adaptive_strategy->standard_strategy);
+        aws_mutex_clean_up(&adaptive_strategy->synced_data.lock);
+        aws_mem_release(retry_strategy->allocator, adaptive_strategy);
+    }
+}
+
+static void s_adaptive_retry_token_destroy(struct adaptive_retry_token *adaptive_token) {
+    aws_retry_strategy_release(adaptive_token->base.retry_strategy);
+    aws_byte_buf_clean_up(&adaptive_token->partition_id);
+    aws_mutex_clean_up(&adaptive_token->thread_data.mutex);
+    aws_mem_release(adaptive_token->base.allocator, adaptive_token);
+}
+
+static void s_invoke_retry_ready(struct adaptive_retry_token *adaptive_token, int error_code) {
+    aws_retry_strategy_on_retry_ready_fn *retry_ready_fn = NULL;
+    void *user_data = NULL;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&adaptive_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        retry_ready_fn = adaptive_token->thread_data.retry_ready_fn;
+        user_data = adaptive_token->thread_data.user_data;
+        adaptive_token->thread_data.retry_ready_fn = NULL;
+        adaptive_token->thread_data.user_data = NULL;
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&adaptive_token->thread_data.mutex) && "Retry token mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Invoking retry_ready for token %p",
+        (void *)adaptive_token->base.retry_strategy,
+        (void *)&adaptive_token->base);
+    retry_ready_fn(&adaptive_token->base, error_code, user_data);
+}
+
+static void s_on_standard_token_acquired(
+    struct aws_retry_strategy *standard_strategy,
+    int error_code,
+    struct aws_retry_token *standard_token,
+    void *user_data) {
+    (void)standard_strategy;
+
+    struct adaptive_retry_token *adaptive_token = user_data;
+    struct aws_retry_strategy *retry_strategy = adaptive_token->base.retry_strategy;
+
+    if (error_code) {
+        adaptive_token->acquired_fn(retry_strategy, error_code, NULL, adaptive_token->acquired_user_data);
+        s_adaptive_retry_token_destroy(adaptive_token);
+        return;
+    }
+
+    adaptive_token->standard_token = standard_token;
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Vending retry_token %p",
+        (void *)retry_strategy,
+        (void *)&adaptive_token->base);
+    adaptive_token->acquired_fn(
+        retry_strategy, AWS_OP_SUCCESS, &adaptive_token->base, adaptive_token->acquired_user_data);
+}
+
+static int s_acquire_standard_token(struct adaptive_retry_token *adaptive_token, uint64_t timeout_ms) {
+    struct adaptive_retry_strategy *adaptive_strategy = adaptive_token->base.retry_strategy->impl;
+    struct aws_byte_cursor partition_id = aws_byte_cursor_from_buf(&adaptive_token->partition_id);
+
+    return aws_retry_strategy_acquire_retry_token(
+        adaptive_strategy->standard_strategy,
+        adaptive_token->has_partition_id ? &partition_id : NULL,
+        s_on_standard_token_acquired,
+        adaptive_token,
+        timeout_ms);
+}
+
+static void s_admission_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct adaptive_retry_token *adaptive_token = arg;
+    int error_code = status == AWS_TASK_STATUS_RUN_READY ? AWS_OP_SUCCESS : AWS_ERROR_IO_OPERATION_CANCELLED;
+
+    /* a retry waiting for the bucket */
+    if (adaptive_token->standard_token) {
+        s_invoke_retry_ready(adaptive_token, error_code);
+        return;
+    }
+
+    /* a token acquisition waiting for the bucket, already past any timeout */
+    if (!error_code && s_acquire_standard_token(adaptive_token, 0)) {
+        error_code = aws_last_error();
+    }
+
+    if (error_code) {
+        adaptive_token->acquired_fn(
+            adaptive_token->base.retry_strategy, error_code, NULL, adaptive_token->acquired_user_data);
+        s_adaptive_retry_token_destroy(adaptive_token);
+    }
+}
+
+static void s_schedule_admission(struct adaptive_retry_token *adaptive_token, uint64_t delay_ns) {
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(adaptive_token->bound_loop, &now);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Rate limiter delays token %p by %" PRIu64 "ns",
+        (void *)adaptive_token->base.retry_strategy,
+        (void *)&adaptive_token->base,
+        delay_ns);
+
+    aws_task_init(&adaptive_token->admission_task, s_admission_task, adaptive_token, "aws_adaptive_retry_admission");
+    aws_event_loop_schedule_task_future(
+        adaptive_token->bound_loop, &adaptive_token->admission_task, aws_add_u64_saturating(now, delay_ns));
+}
+
+static int s_adaptive_retry_acquire_token(
+    struct aws_retry_strategy *retry_strategy,
+    const struct aws_byte_cursor *partition_id,
+    aws_retry_strategy_on_retry_token_acquired_fn *on_acquired,
+    void *user_data,
+    uint64_t timeout_ms) {
+    struct adaptive_retry_strategy *adaptive_strategy = retry_strategy->impl;
+
+    bool timed_out = false;
+    uint64_t delay_ns = s_reserve_send(adaptive_strategy, timeout_ms, &timed_out);
+    if (timed_out) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+            "id=%p: Rate limiter would hold token acquisition longer than timeout of %" PRIu64 "ms",
+            (void *)retry_strategy,
+            timeout_ms);
+        return aws_raise_error(AWS_IO_RETRY_PERMISSION_DENIED);
+    }
+
+    struct adaptive_retry_token *adaptive_token =
+        aws_mem_calloc(retry_strategy->allocator, 1, sizeof(struct adaptive_retry_token));
+
+    if (!adaptive_token) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Initializing retry token %p",
+        (void *)retry_strategy,
+        (void *)&adaptive_token->base);
+
+    adaptive_token->base.allocator = retry_strategy->allocator;
+    adaptive_token->base.retry_strategy = retry_strategy;
+    aws_retry_strategy_acquire(retry_strategy);
+    adaptive_token->base.impl = adaptive_token;
+    adaptive_token->bound_loop = aws_event_loop_group_get_next_loop(adaptive_strategy->el_group);
+    adaptive_token->acquired_fn = on_acquired;
+    adaptive_token->acquired_user_data = user_data;
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&adaptive_token->thread_data.mutex) && "Retry token mutex initialization failed");
+
+    if (partition_id) {
+        adaptive_token->has_partition_id = true;
+        if (aws_byte_buf_init_copy_from_cursor(
+                &adaptive_token->partition_id, retry_strategy->allocator, *partition_id)) {
+            goto on_error;
+        }
+    }
+
+    if (delay_ns) {
+        s_schedule_admission(adaptive_token, delay_ns);
+        return AWS_OP_SUCCESS;
+    }
+
+    /* the standard strategy already guarantees on_acquired is invoked asynchronously, and only on success */
+    if (s_acquire_standard_token(adaptive_token, timeout_ms)) {
+        goto on_error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    s_adaptive_retry_token_destroy(adaptive_token);
+    return AWS_OP_ERR;
+}
+
+static void s_on_standard_retry_ready(struct aws_retry_token *standard_token, int error_code, void *user_data) {
+    (void)standard_token;
+
+    struct adaptive_retry_token *adaptive_token = user_data;
+
+    if (!error_code) {
+        /* the backoff is over, the retry still has to get past the rate limiter like any other send */
+        bool timed_out = false;
+        uint64_t delay_ns = s_reserve_send(adaptive_token->base.retry_strategy->impl, 0, &timed_out);
+        if (delay_ns) {
+            s_schedule_admission(adaptive_token, delay_ns);
+            return;
+        }
+    }
+
+    s_invoke_retry_ready(adaptive_token, error_code);
+}
+
+static int s_adaptive_retry_schedule_retry(
+    struct aws_retry_token *token,
+    enum aws_retry_error_type error_type,
+    aws_retry_strategy_on_retry_ready_fn *retry_ready,
+    void *user_data) {
+    AWS_PRECONDITION(retry_ready);
+
+    struct adaptive_retry_token *adaptive_token = token->impl;
+    bool already_scheduled = false;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&adaptive_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        if (adaptive_token->thread_data.retry_ready_fn) {
+            already_scheduled = true;
+        } else {
+            adaptive_token->thread_data.retry_ready_fn = retry_ready;
+            adaptive_token->thread_data.user_data = user_data;
+        }
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&adaptive_token->thread_data.mutex) && "Retry token mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    if (already_scheduled) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+            "id=%p: retry token %p is already scheduled.",
+            (void *)token->retry_strategy,
+            (void *)token);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    /* the attempt that failed is a response like any other, and a throttling one slows everyone down */
+    s_record_outcome(token->retry_strategy->impl, error_type == AWS_RETRY_ERROR_TYPE_THROTTLING);
+
+    if (aws_retry_strategy_schedule_retry(
+            adaptive_token->standard_token, error_type, s_on_standard_retry_ready, adaptive_token)) {
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&adaptive_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        adaptive_token->thread_data.retry_ready_fn = NULL;
+        adaptive_token->thread_data.user_data = NULL;
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&adaptive_token->thread_data.mutex) && "Retry token mutex release failed");
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_adaptive_retry_record_success(struct aws_retry_token *token) {
+    struct adaptive_retry_token *adaptive_token = token->impl;
+
+    s_record_outcome(token->retry_strategy->impl, false);
+
+    return aws_retry_strategy_token_record_success(adaptive_token->standard_token);
+}
+
+static void s_adaptive_retry_release_token(struct aws_retry_token *token) {
+    if (token) {
+        struct adaptive_retry_token *adaptive_token = token->impl;
+        aws_retry_strategy_release_retry_token(adaptive_token->standard_token);
+        s_adaptive_retry_token_destroy(adaptive_token);
+    }
+}
+
+static struct aws_retry_strategy_vtable s_adaptive_retry_vtable = {
+    .destroy = s_adaptive_retry_destroy,
+    .acquire_token = s_adaptive_retry_acquire_token,
+    .schedule_retry = s_adaptive_retry_schedule_retry,
+    .record_success = s_adaptive_retry_record_success,
+    .release_token = s_adaptive_retry_release_token,
+};
+
+struct aws_retry_strategy *aws_retry_strategy_new_adaptive(
+    struct aws_allocator *allocator,
+    const struct aws_adaptive_retry_options *config) {
+    AWS_PRECONDITION(config);
+
+    struct aws_retry_strategy *standard_strategy =
+        aws_retry_strategy_new_standard(allocator, &config->standard_options);
+
+    if (!standard_strategy) {
+        return NULL;
+    }
+
+    struct adaptive_retry_strategy *adaptive_strategy =
+        aws_mem_calloc(allocator, 1, sizeof(struct adaptive_retry_strategy));
+
+    if (!adaptive_strategy) {
+        aws_retry_strategy_release(standard_strategy);
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Initializing adaptive retry strategy over standard retry strategy %p",
+        (void *)&adaptive_strategy->base,
+        (void *)standard_strategy);
+
+    adaptive_strategy->base.allocator = allocator;
+    adaptive_strategy->base.impl = adaptive_strategy;
+    adaptive_strategy->base.vtable = &s_adaptive_retry_vtable;
+    aws_atomic_init_int(&adaptive_strategy->base.ref_count, 1);
+    adaptive_strategy->standard_strategy = standard_strategy;
+    adaptive_strategy->el_group = config->standard_options.backoff_retry_options.el_group;
+    s_rate_limiter_init(&adaptive_strategy->synced_data.rate_limiter);
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&adaptive_strategy->synced_data.lock) && "Rate limiter mutex initialization failed");
+
+    return &adaptive_strategy->base;
+}
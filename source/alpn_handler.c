@@ -35,7 +35,7 @@ static int s_alpn_process_read_message(
         alpn_handler->on_protocol_negotiated(new_slot, &protocol_message->protocol, alpn_handler->user_data);
 
     if (!new_handler) {
-        aws_mem_release(handler->alloc, (void *)new_slot);
+        aws_channel_slot_remove(new_slot);
         return aws_raise_error(AWS_IO_UNHANDLED_ALPN_PROTOCOL_MESSAGE);
     }
 
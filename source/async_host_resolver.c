@@ -0,0 +1,1417 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/host_resolver.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/string.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/logging.h>
+#include <aws/io/private/dns_message.h>
+#include <aws/io/socket.h>
+
+#include <inttypes.h>
+
+#define DEFAULT_MAX_ENTRIES 64
+#define DEFAULT_QUERY_TIMEOUT_MS 2000
+#define DEFAULT_MAX_RETRIES 2
+/* a zero ttl would send every resolve back to the network, and we would never serve from the cache. */
+#define MIN_RECORD_TTL_SECS 1
+/* how long to keep serving addresses we failed to refresh before asking again. */
+#define STALE_RECORD_RETRY_SECS 1
+/* comfortably larger than the EDNS(0) payload size we advertise. */
+#define UDP_READ_BUFFER_SIZE 4096
+#define TCP_LENGTH_PREFIX_SIZE 2
+
+enum nameserver_state {
+    NAMESERVER_IDLE,
+    NAMESERVER_CONNECTING,
+    NAMESERVER_CONNECTED,
+    /* closed after an error, clean_up is deferred to the next connect because we may be inside a socket callback. */
+    NAMESERVER_CLOSED,
+};
+
+struct async_host_resolver;
+struct dns_query;
+
+/* one udp socket per server, every query for that server is pipelined on it and told apart by id. */
+struct dns_nameserver {
+    struct async_host_resolver *resolver;
+    struct aws_socket_endpoint endpoint;
+    struct aws_socket socket;
+    enum nameserver_state state;
+    /* struct dns_query, waiting for the socket to connect. */
+    struct aws_linked_list waiting_queries;
+};
+
+/* a single query re-sent over tcp because the udp answer was truncated. */
+struct dns_tcp_exchange {
+    struct async_host_resolver *resolver;
+    /* NULL once closed, whatever happens to the socket afterwards is no longer the query's business. */
+    struct dns_query *query;
+    struct aws_socket socket;
+    struct aws_byte_buf request;
+    struct aws_byte_buf response;
+    struct aws_task destroy_task;
+    bool closed;
+};
+
+struct pending_callback {
+    aws_on_host_resolved_result_fn *callback;
+    void *user_data;
+    /* struct aws_host_address, picked while holding the lock and delivered after releasing it. */
+    struct aws_array_list addresses;
+    struct aws_linked_list_node node;
+};
+
+struct async_host_entry {
+    struct aws_allocator *allocator;
+    struct async_host_resolver *resolver;
+    struct aws_string *host_name;
+
+    /* everything below is protected by the resolver's lock */
+    /* struct aws_host_address, by value */
+    struct aws_array_list aaaa_records;
+    struct aws_array_list a_records;
+    size_t aaaa_next;
+    size_t a_next;
+    /* when the shortest lived record expires, the entry is refreshed on the next resolve once this passes. */
+    uint64_t expiry;
+    uint64_t last_use;
+    size_t max_ttl_secs;
+    struct aws_linked_list pending_callbacks;
+    bool lookup_in_flight;
+    /* callbacks are being invoked outside the lock and still reference host_name. */
+    bool delivering;
+
+    /* loop thread only, while a lookup is in flight */
+    struct aws_task lookup_task;
+    size_t queries_outstanding;
+    int lookup_error;
+    /* struct aws_host_address, both record types */
+    struct aws_array_list new_records;
+};
+
+struct dns_query {
+    struct async_host_resolver *resolver;
+    struct async_host_entry *entry;
+    enum aws_dns_record_type record_type;
+    uint16_t id;
+    bool id_registered;
+    struct aws_byte_buf request;
+    size_t attempts;
+    size_t nameserver_index;
+    struct aws_task timeout_task;
+    bool timeout_scheduled;
+    struct aws_linked_list_node waiting_node;
+    bool waiting;
+    struct aws_linked_list_node node;
+    /* the socket still holds a cursor into request until each of these completes. */
+    size_t writes_in_flight;
+    bool completed;
+    struct dns_tcp_exchange *tcp_exchange;
+};
+
+struct async_host_resolver {
+    struct aws_allocator *allocator;
+    struct aws_host_resolver *resolver;
+    struct aws_event_loop_group *el_group;
+    struct aws_event_loop *loop;
+    uint64_t query_timeout_ns;
+    size_t max_retries;
+    size_t max_entries;
+
+    struct aws_mutex lock;
+    /* struct aws_string * (owned by the entry) -> struct async_host_entry *, protected by lock */
+    struct aws_hash_table host_entries;
+    bool shutting_down;
+
+    /* everything below is only touched on loop */
+    struct dns_nameserver *nameservers;
+    size_t nameserver_count;
+    /* uint16_t id (stored in the pointer) -> struct dns_query * */
+    struct aws_hash_table queries_by_id;
+    /* struct dns_query, every query that hasn't completed yet */
+    struct aws_linked_list queries;
+    struct aws_byte_buf read_buffer;
+    size_t tcp_exchange_count;
+    bool tearing_down;
+    struct aws_task shutdown_task;
+};
+
+static void s_send_query(struct dns_query *query);
+static void s_on_attempt_failed(struct dns_query *query);
+static void s_query_complete(struct dns_query *query, int error_code, const struct aws_dns_response *response);
+static void s_finish_teardown(struct async_host_resolver *impl);
+
+static enum aws_socket_domain s_endpoint_domain(const struct aws_socket_endpoint *endpoint) {
+    return strchr(endpoint->address, ':') ? AWS_SOCKET_IPV6 : AWS_SOCKET_IPV4;
+}
+
+static void s_clear_records(struct aws_array_list *records) {
+    size_t count = aws_array_list_length(records);
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(records, (void **)&address, i);
+        aws_host_address_clean_up(address);
+    }
+    aws_array_list_clear(records);
+}
+
+static void s_host_entry_destroy(struct async_host_entry *entry) {
+    if (!entry) {
+        return;
+    }
+
+    s_clear_records(&entry->aaaa_records);
+    s_clear_records(&entry->a_records);
+    s_clear_records(&entry->new_records);
+    aws_array_list_clean_up(&entry->aaaa_records);
+    aws_array_list_clean_up(&entry->a_records);
+    aws_array_list_clean_up(&entry->new_records);
+    aws_string_destroy(entry->host_name);
+    aws_mem_release(entry->allocator, entry);
+}
+
+static struct async_host_entry *s_host_entry_new(struct async_host_resolver *impl, const struct aws_string *host_name) {
+    struct async_host_entry *entry = aws_mem_calloc(impl->allocator, 1, sizeof(struct async_host_entry));
+    if (!entry) {
+        return NULL;
+    }
+
+    entry->allocator = impl->allocator;
+    entry->resolver = impl;
+    aws_linked_list_init(&entry->pending_callbacks);
+
+    entry->host_name = aws_string_new_from_string(impl->allocator, host_name);
+    if (!entry->host_name ||
+        aws_array_list_init_dynamic(&entry->aaaa_records, impl->allocator, 4, sizeof(struct aws_host_address)) ||
+        aws_array_list_init_dynamic(&entry->a_records, impl->allocator, 4, sizeof(struct aws_host_address)) ||
+        aws_array_list_init_dynamic(&entry->new_records, impl->allocator, 8, sizeof(struct aws_host_address))) {
+        s_host_entry_destroy(entry);
+        return NULL;
+    }
+
+    return entry;
+}
+
+static bool s_host_entry_has_records(const struct async_host_entry *entry) {
+    return aws_array_list_length(&entry->aaaa_records) > 0 || aws_array_list_length(&entry->a_records) > 0;
+}
+
+static bool s_host_entry_is_busy(const struct async_host_entry *entry) {
+    return entry->lookup_in_flight || entry->delivering;
+}
+
+/* Picks the next address in round robin order among those with the fewest recorded connection failures. */
+static struct aws_host_address *s_pick_address(struct aws_array_list *records, size_t *next) {
+    size_t count = aws_array_list_length(records);
+    if (count == 0) {
+        return NULL;
+    }
+
+    struct aws_host_address *address = NULL;
+    size_t least_failures = SIZE_MAX;
+    for (size_t i = 0; i < count; ++i) {
+        aws_array_list_get_at_ptr(records, (void **)&address, i);
+        least_failures = aws_min_size(least_failures, address->connection_failure_count);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        size_t index = (*next + i) % count;
+        aws_array_list_get_at_ptr(records, (void **)&address, index);
+        if (address->connection_failure_count == least_failures) {
+            *next = index + 1;
+            address->use_count += 1;
+            return address;
+        }
+    }
+
+    return NULL;
+}
+
+/* Copies one ipv6 and one ipv4 address out of the cache into out, same as the default resolver hands out. Requires
+ * the lock. */
+static int s_copy_picked_addresses(struct async_host_entry *entry, struct aws_array_list *out) {
+    struct aws_host_address *picks[2] = {
+        s_pick_address(&entry->aaaa_records, &entry->aaaa_next),
+        s_pick_address(&entry->a_records, &entry->a_next),
+    };
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(picks); ++i) {
+        if (!picks[i]) {
+            continue;
+        }
+
+        struct aws_host_address copy;
+        if (aws_host_address_copy(picks[i], &copy)) {
+            return AWS_OP_ERR;
+        }
+
+        if (aws_array_list_push_back(out, &copy)) {
+            aws_host_address_clean_up(&copy);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_clean_up_address_list(struct aws_array_list *addresses) {
+    s_clear_records(addresses);
+    aws_array_list_clean_up(addresses);
+}
+
+/* Evicts the least recently used idle entry once the cache is full. Busy entries are left alone, so the cache can
+ * grow past max_entries for as long as every entry in it has a lookup in flight. Requires the lock. */
+static void s_make_room_for_entry(struct async_host_resolver *impl) {
+    if (aws_hash_table_get_entry_count(&impl->host_entries) < impl->max_entries) {
+        return;
+    }
+
+    struct async_host_entry *oldest = NULL;
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&impl->host_entries); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        struct async_host_entry *entry = iter.element.value;
+        if (!s_host_entry_is_busy(entry) && (!oldest || entry->last_use < oldest->last_use)) {
+            oldest = entry;
+        }
+    }
+
+    if (oldest) {
+        aws_hash_table_remove(&impl->host_entries, oldest->host_name, NULL, NULL);
+        s_host_entry_destroy(oldest);
+    }
+}
+
+/************************************************ query ids ******************************************************/
+
+static int s_register_query_id(struct dns_query *query) {
+    struct async_host_resolver *impl = query->resolver;
+
+    if (aws_hash_table_get_entry_count(&impl->queries_by_id) > UINT16_MAX) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    /* ids are picked at random so an off-path attacker has to guess them, not just count. */
+    uint16_t id = 0;
+    struct aws_hash_element *existing = NULL;
+    do {
+        if (aws_device_random_u16(&id)) {
+            return AWS_OP_ERR;
+        }
+        aws_hash_table_find(&impl->queries_by_id, (void *)(uintptr_t)id, &existing);
+    } while (existing);
+
+    if (aws_hash_table_put(&impl->queries_by_id, (void *)(uintptr_t)id, query, NULL)) {
+        return AWS_OP_ERR;
+    }
+
+    query->id = id;
+    query->id_registered = true;
+    /* the id is the first field of the header. */
+    query->request.buffer[0] = (uint8_t)(id >> 8);
+    query->request.buffer[1] = (uint8_t)(id & 0xFF);
+    return AWS_OP_SUCCESS;
+}
+
+static void s_unregister_query_id(struct dns_query *query) {
+    if (query->id_registered) {
+        aws_hash_table_remove(&query->resolver->queries_by_id, (void *)(uintptr_t)query->id, NULL, NULL);
+        query->id_registered = false;
+    }
+}
+
+/************************************************ lookups ********************************************************/
+
+static void s_on_lookup_finished(struct async_host_entry *entry) {
+    struct async_host_resolver *impl = entry->resolver;
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    struct aws_linked_list callbacks;
+    aws_linked_list_init(&callbacks);
+
+    aws_mutex_lock(&impl->lock);
+
+    int error_code = AWS_ERROR_SUCCESS;
+    bool have_stale_records = s_host_entry_has_records(entry);
+    size_t new_count = aws_array_list_length(&entry->new_records);
+
+    if (new_count > 0) {
+        s_clear_records(&entry->aaaa_records);
+        s_clear_records(&entry->a_records);
+        entry->aaaa_next = 0;
+        entry->a_next = 0;
+        entry->expiry = UINT64_MAX;
+
+        for (size_t i = 0; i < new_count; ++i) {
+            struct aws_host_address *address = NULL;
+            aws_array_list_get_at_ptr(&entry->new_records, (void **)&address, i);
+            struct aws_array_list *records =
+                address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &entry->aaaa_records : &entry->a_records;
+
+            if (aws_array_list_push_back(records, address)) {
+                aws_host_address_clean_up(address);
+                continue;
+            }
+            entry->expiry = aws_min_u64(entry->expiry, address->expiry);
+        }
+
+        /* ownership of every address moved to the typed lists above. */
+        aws_array_list_clear(&entry->new_records);
+        if (!s_host_entry_has_records(entry)) {
+            entry->expiry = 0;
+        }
+    } else if (have_stale_records && entry->lookup_error && entry->lookup_error != AWS_IO_DNS_INVALID_NAME) {
+        /* the servers are unreachable, not saying the name is gone: keep handing out what we had. */
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: refreshing %s failed with error %s, serving the expired addresses.",
+            (void *)impl->resolver,
+            aws_string_c_str(entry->host_name),
+            aws_error_name(entry->lookup_error));
+        entry->expiry =
+            now + aws_timestamp_convert(STALE_RECORD_RETRY_SECS, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    } else {
+        s_clear_records(&entry->aaaa_records);
+        s_clear_records(&entry->a_records);
+        entry->expiry = 0;
+        error_code = entry->lookup_error ? entry->lookup_error : AWS_IO_DNS_NO_ADDRESS_FOR_HOST;
+    }
+
+    entry->lookup_in_flight = false;
+    entry->delivering = true;
+    aws_linked_list_swap_contents(&callbacks, &entry->pending_callbacks);
+
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&callbacks); node != aws_linked_list_end(&callbacks);
+         node = aws_linked_list_next(node)) {
+        struct pending_callback *pending = AWS_CONTAINER_OF(node, struct pending_callback, node);
+        if (!error_code) {
+            s_copy_picked_addresses(entry, &pending->addresses);
+        }
+    }
+
+    aws_mutex_unlock(&impl->lock);
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: lookup of %s finished with error %s.",
+        (void *)impl->resolver,
+        aws_string_c_str(entry->host_name),
+        aws_error_name(error_code));
+
+    while (!aws_linked_list_empty(&callbacks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&callbacks);
+        struct pending_callback *pending = AWS_CONTAINER_OF(node, struct pending_callback, node);
+
+        int callback_error = error_code;
+        if (!callback_error && aws_array_list_length(&pending->addresses) == 0) {
+            callback_error = AWS_ERROR_OOM;
+        }
+
+        pending->callback(impl->resolver, entry->host_name, callback_error, &pending->addresses, pending->user_data);
+        s_clean_up_address_list(&pending->addresses);
+        aws_mem_release(impl->allocator, pending);
+    }
+
+    aws_mutex_lock(&impl->lock);
+    entry->delivering = false;
+    aws_mutex_unlock(&impl->lock);
+}
+
+static void s_on_entry_query_finished(
+    struct async_host_entry *entry,
+    int error_code,
+    const struct aws_dns_response *response) {
+
+    struct async_host_resolver *impl = entry->resolver;
+
+    if (error_code) {
+        /* a server saying the name doesn't exist trumps one that just didn't answer. */
+        if (!entry->lookup_error || error_code == AWS_IO_DNS_INVALID_NAME) {
+            entry->lookup_error = error_code;
+        }
+    } else {
+        uint64_t now = 0;
+        aws_high_res_clock_get_ticks(&now);
+
+        size_t count = aws_array_list_length(&response->addresses);
+        for (size_t i = 0; i < count; ++i) {
+            struct aws_dns_address_record *record = NULL;
+            aws_array_list_get_at_ptr(&response->addresses, (void **)&record, i);
+
+            /* the ttl from the answer wins, max_ttl only caps it when the caller configured one. */
+            uint64_t ttl_secs = aws_max_u64(record->ttl_secs, MIN_RECORD_TTL_SECS);
+            if (entry->max_ttl_secs > 0) {
+                ttl_secs = aws_min_u64(ttl_secs, entry->max_ttl_secs);
+            }
+
+            struct aws_host_address address;
+            AWS_ZERO_STRUCT(address);
+            address.allocator = impl->allocator;
+            address.record_type = record->record_type;
+            address.expiry = aws_add_u64_saturating(
+                now, aws_timestamp_convert(ttl_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL));
+            address.host = aws_string_new_from_string(impl->allocator, entry->host_name);
+            address.address =
+                aws_string_new_from_array(impl->allocator, (const uint8_t *)record->address, record->address_len);
+
+            if (!address.host || !address.address || aws_array_list_push_back(&entry->new_records, &address)) {
+                aws_host_address_clean_up(&address);
+            }
+        }
+    }
+
+    AWS_ASSERT(entry->queries_outstanding > 0);
+    if (--entry->queries_outstanding == 0) {
+        s_on_lookup_finished(entry);
+    }
+}
+
+static void s_query_destroy(struct dns_query *query) {
+    aws_byte_buf_clean_up(&query->request);
+    aws_mem_release(query->resolver->allocator, query);
+}
+
+static void s_start_query(struct async_host_entry *entry, enum aws_dns_record_type record_type) {
+    struct async_host_resolver *impl = entry->resolver;
+
+    struct dns_query *query = aws_mem_calloc(impl->allocator, 1, sizeof(struct dns_query));
+    if (!query) {
+        s_on_entry_query_finished(entry, aws_last_error(), NULL);
+        return;
+    }
+
+    query->resolver = impl;
+    query->entry = entry;
+    query->record_type = record_type;
+    aws_linked_list_push_back(&impl->queries, &query->node);
+
+    if (aws_byte_buf_init(&query->request, impl->allocator, AWS_DNS_HEADER_SIZE + entry->host_name->len + 21) ||
+        aws_dns_message_encode_query(&query->request, 0, aws_byte_cursor_from_string(entry->host_name), record_type) ||
+        s_register_query_id(query)) {
+        s_query_complete(query, aws_last_error(), NULL);
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_DNS,
+        "id=%p: querying %s records for %s with id %" PRIu16 ".",
+        (void *)impl->resolver,
+        record_type == AWS_DNS_RECORD_TYPE_AAAA ? "AAAA" : "A",
+        aws_string_c_str(entry->host_name),
+        query->id);
+
+    s_send_query(query);
+}
+
+static void s_lookup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct async_host_entry *entry = arg;
+
+    entry->lookup_error = AWS_ERROR_SUCCESS;
+    entry->queries_outstanding = 2;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        s_on_entry_query_finished(entry, AWS_IO_EVENT_LOOP_SHUTDOWN, NULL);
+        s_on_entry_query_finished(entry, AWS_IO_EVENT_LOOP_SHUTDOWN, NULL);
+        return;
+    }
+
+    /* both families go out back to back, the lookup finishes when the slower one does. */
+    s_start_query(entry, AWS_DNS_RECORD_TYPE_AAAA);
+    s_start_query(entry, AWS_DNS_RECORD_TYPE_A);
+}
+
+/************************************************ udp transport **************************************************/
+
+static void s_cancel_query_timeout(struct dns_query *query) {
+    if (query->timeout_scheduled) {
+        aws_event_loop_cancel_task(query->resolver->loop, &query->timeout_task);
+    }
+}
+
+static void s_on_query_timeout(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct dns_query *query = arg;
+    query->timeout_scheduled = false;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: query %" PRIu16 " for %s timed out on %s.",
+        (void *)query->resolver->resolver,
+        query->id,
+        aws_string_c_str(query->entry->host_name),
+        query->resolver->nameservers[query->nameserver_index].endpoint.address);
+
+    s_on_attempt_failed(query);
+}
+
+static void s_on_query_written(struct aws_socket *socket, int error_code, size_t bytes_written, void *user_data) {
+    (void)socket;
+    (void)bytes_written;
+    struct dns_query *query = user_data;
+
+    /* a failed send is handled like a lost datagram: the timeout moves the query on. */
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: sending query %" PRIu16 " failed with error %s.",
+            (void *)query->resolver->resolver,
+            query->id,
+            aws_error_name(error_code));
+    }
+
+    AWS_ASSERT(query->writes_in_flight > 0);
+    if (--query->writes_in_flight == 0 && query->completed) {
+        s_query_destroy(query);
+    }
+}
+
+static void s_write_query(struct dns_nameserver *nameserver, struct dns_query *query) {
+    struct aws_byte_cursor request = aws_byte_cursor_from_buf(&query->request);
+
+    query->writes_in_flight += 1;
+    if (aws_socket_write(&nameserver->socket, &request, s_on_query_written, query)) {
+        query->writes_in_flight -= 1;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: unable to send query %" PRIu16 " to %s, error %s.",
+            (void *)query->resolver->resolver,
+            query->id,
+            nameserver->endpoint.address,
+            aws_error_name(aws_last_error()));
+    }
+}
+
+static void s_close_nameserver(struct dns_nameserver *nameserver) {
+    if (nameserver->state == NAMESERVER_CONNECTING || nameserver->state == NAMESERVER_CONNECTED) {
+        aws_socket_close(&nameserver->socket);
+        nameserver->state = NAMESERVER_CLOSED;
+    }
+}
+
+static void s_on_udp_message(struct dns_nameserver *nameserver, struct aws_byte_cursor message);
+
+static void s_on_nameserver_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_nameserver *nameserver = user_data;
+    struct async_host_resolver *impl = nameserver->resolver;
+
+    if (error_code) {
+        goto on_error;
+    }
+
+    while (nameserver->state == NAMESERVER_CONNECTED) {
+        impl->read_buffer.len = 0;
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &impl->read_buffer, &amount_read)) {
+            if (aws_last_error() == AWS_IO_READ_WOULD_BLOCK) {
+                return;
+            }
+            error_code = aws_last_error();
+            goto on_error;
+        }
+
+        s_on_udp_message(nameserver, aws_byte_cursor_from_buf(&impl->read_buffer));
+    }
+
+    return;
+
+on_error:
+    /* typically an icmp port unreachable. Outstanding queries time out and move on, next use reconnects. */
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: nameserver %s failed with error %s, closing its socket.",
+        (void *)impl->resolver,
+        nameserver->endpoint.address,
+        aws_error_name(error_code));
+    s_close_nameserver(nameserver);
+}
+
+static void s_on_nameserver_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_nameserver *nameserver = user_data;
+    struct async_host_resolver *impl = nameserver->resolver;
+
+    if (!error_code && aws_socket_subscribe_to_readable_events(socket, s_on_nameserver_readable, nameserver)) {
+        error_code = aws_last_error();
+    }
+
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: unable to reach nameserver %s, error %s.",
+            (void *)impl->resolver,
+            nameserver->endpoint.address,
+            aws_error_name(error_code));
+
+        /* leave the waiting queries to their timeouts, retrying from in here could reconnect this very socket. */
+        while (!aws_linked_list_empty(&nameserver->waiting_queries)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&nameserver->waiting_queries);
+            AWS_CONTAINER_OF(node, struct dns_query, waiting_node)->waiting = false;
+        }
+
+        aws_socket_close(socket);
+        nameserver->state = NAMESERVER_CLOSED;
+        return;
+    }
+
+    nameserver->state = NAMESERVER_CONNECTED;
+
+    while (!aws_linked_list_empty(&nameserver->waiting_queries)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&nameserver->waiting_queries);
+        struct dns_query *query = AWS_CONTAINER_OF(node, struct dns_query, waiting_node);
+        query->waiting = false;
+        s_write_query(nameserver, query);
+    }
+}
+
+static int s_connect_nameserver(struct dns_nameserver *nameserver) {
+    struct async_host_resolver *impl = nameserver->resolver;
+
+    if (nameserver->state == NAMESERVER_CLOSED) {
+        aws_socket_clean_up(&nameserver->socket);
+        nameserver->state = NAMESERVER_IDLE;
+    }
+
+    struct aws_socket_options options = {
+        .type = AWS_SOCKET_DGRAM,
+        .domain = s_endpoint_domain(&nameserver->endpoint),
+        .connect_timeout_ms = (uint32_t)aws_timestamp_convert(
+            impl->query_timeout_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL),
+    };
+
+    if (aws_socket_init(&nameserver->socket, impl->allocator, &options)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_socket_connect(
+            &nameserver->socket, &nameserver->endpoint, impl->loop, s_on_nameserver_connected, nameserver)) {
+        aws_socket_clean_up(&nameserver->socket);
+        return AWS_OP_ERR;
+    }
+
+    nameserver->state = NAMESERVER_CONNECTING;
+    return AWS_OP_SUCCESS;
+}
+
+static void s_send_query(struct dns_query *query) {
+    struct async_host_resolver *impl = query->resolver;
+    struct dns_nameserver *nameserver = &impl->nameservers[query->nameserver_index];
+
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(impl->loop, &now);
+    aws_task_init(&query->timeout_task, s_on_query_timeout, query, "dns_query_timeout");
+    aws_event_loop_schedule_task_future(impl->loop, &query->timeout_task, now + impl->query_timeout_ns);
+    query->timeout_scheduled = true;
+
+    if (nameserver->state == NAMESERVER_CONNECTED) {
+        s_write_query(nameserver, query);
+        return;
+    }
+
+    if (nameserver->state != NAMESERVER_CONNECTING && s_connect_nameserver(nameserver)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: unable to open a socket to nameserver %s, error %s.",
+            (void *)impl->resolver,
+            nameserver->endpoint.address,
+            aws_error_name(aws_last_error()));
+        /* the timeout will move it on to the next server. */
+        return;
+    }
+
+    aws_linked_list_push_back(&nameserver->waiting_queries, &query->waiting_node);
+    query->waiting = true;
+}
+
+/* Stops everything the query's current attempt has going: its timer, its place in a connect queue, its tcp
+ * exchange and its id. */
+static void s_stop_attempt(struct dns_query *query);
+
+static void s_on_attempt_failed(struct dns_query *query) {
+    struct async_host_resolver *impl = query->resolver;
+
+    s_stop_attempt(query);
+
+    if (++query->attempts > impl->max_retries) {
+        s_query_complete(query, AWS_IO_DNS_QUERY_FAILED, NULL);
+        return;
+    }
+
+    /* every retry goes to the next server, with a fresh id so a late answer to the old attempt is ignored. */
+    query->nameserver_index = (query->nameserver_index + 1) % impl->nameserver_count;
+    if (s_register_query_id(query)) {
+        s_query_complete(query, aws_last_error(), NULL);
+        return;
+    }
+
+    s_send_query(query);
+}
+
+/************************************************ tcp fallback ***************************************************/
+
+static void s_tcp_exchange_destroy_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct dns_tcp_exchange *exchange = arg;
+    struct async_host_resolver *impl = exchange->resolver;
+
+    aws_socket_clean_up(&exchange->socket);
+    aws_byte_buf_clean_up(&exchange->request);
+    aws_byte_buf_clean_up(&exchange->response);
+    aws_mem_release(impl->allocator, exchange);
+
+    if (--impl->tcp_exchange_count == 0 && impl->tearing_down) {
+        s_finish_teardown(impl);
+    }
+}
+
+/* Closes the exchange's socket now and frees it from a task, since we are usually inside one of its callbacks. */
+static void s_tcp_exchange_close(struct dns_tcp_exchange *exchange) {
+    if (exchange->closed) {
+        return;
+    }
+
+    exchange->closed = true;
+    if (exchange->query) {
+        exchange->query->tcp_exchange = NULL;
+        exchange->query = NULL;
+    }
+
+    aws_socket_close(&exchange->socket);
+    aws_task_init(&exchange->destroy_task, s_tcp_exchange_destroy_task, exchange, "dns_tcp_exchange_destroy");
+    aws_event_loop_schedule_task_now(exchange->resolver->loop, &exchange->destroy_task);
+}
+
+static void s_tcp_exchange_failed(struct dns_tcp_exchange *exchange, int error_code) {
+    struct dns_query *query = exchange->query;
+    if (!query) {
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: tcp query %" PRIu16 " for %s failed with error %s.",
+        (void *)exchange->resolver->resolver,
+        query->id,
+        aws_string_c_str(query->entry->host_name),
+        aws_error_name(error_code));
+
+    s_tcp_exchange_close(exchange);
+    s_on_attempt_failed(query);
+}
+
+static void s_on_query_response(struct dns_query *query, struct aws_byte_cursor message, bool over_tcp);
+
+static void s_on_tcp_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_tcp_exchange *exchange = user_data;
+
+    if (error_code) {
+        s_tcp_exchange_failed(exchange, error_code);
+        return;
+    }
+
+    while (exchange->query) {
+        size_t needed = TCP_LENGTH_PREFIX_SIZE;
+        if (exchange->response.len >= TCP_LENGTH_PREFIX_SIZE) {
+            needed += ((size_t)exchange->response.buffer[0] << 8) | exchange->response.buffer[1];
+            if (needed == TCP_LENGTH_PREFIX_SIZE) {
+                s_tcp_exchange_failed(exchange, AWS_IO_DNS_QUERY_FAILED);
+                return;
+            }
+
+            if (exchange->response.len >= needed) {
+                struct aws_byte_cursor message = aws_byte_cursor_from_array(
+                    exchange->response.buffer + TCP_LENGTH_PREFIX_SIZE, needed - TCP_LENGTH_PREFIX_SIZE);
+                s_on_query_response(exchange->query, message, true);
+                return;
+            }
+        }
+
+        if (aws_byte_buf_reserve(&exchange->response, needed)) {
+            s_tcp_exchange_failed(exchange, aws_last_error());
+            return;
+        }
+
+        size_t amount_read = 0;
+        if (aws_socket_read(socket, &exchange->response, &amount_read)) {
+            if (aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+                s_tcp_exchange_failed(exchange, aws_last_error());
+            }
+            return;
+        }
+    }
+}
+
+static void s_on_tcp_written(struct aws_socket *socket, int error_code, size_t bytes_written, void *user_data) {
+    (void)socket;
+    (void)bytes_written;
+    struct dns_tcp_exchange *exchange = user_data;
+
+    if (error_code) {
+        s_tcp_exchange_failed(exchange, error_code);
+    }
+}
+
+static void s_on_tcp_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct dns_tcp_exchange *exchange = user_data;
+
+    if (error_code) {
+        s_tcp_exchange_failed(exchange, error_code);
+        return;
+    }
+
+    struct aws_byte_cursor request = aws_byte_cursor_from_buf(&exchange->request);
+    if (aws_socket_subscribe_to_readable_events(socket, s_on_tcp_readable, exchange) ||
+        aws_socket_write(socket, &request, s_on_tcp_written, exchange)) {
+        s_tcp_exchange_failed(exchange, aws_last_error());
+    }
+}
+
+/* Re-sends the query over tcp to the server whose udp answer didn't fit, RFC 7766 style: length prefix, one query
+ * per connection. */
+static int s_start_tcp_exchange(struct dns_query *query) {
+    struct async_host_resolver *impl = query->resolver;
+    struct dns_nameserver *nameserver = &impl->nameservers[query->nameserver_index];
+
+    struct dns_tcp_exchange *exchange = aws_mem_calloc(impl->allocator, 1, sizeof(struct dns_tcp_exchange));
+    if (!exchange) {
+        return AWS_OP_ERR;
+    }
+
+    exchange->resolver = impl;
+
+    struct aws_byte_cursor request = aws_byte_cursor_from_buf(&query->request);
+    if (aws_byte_buf_init(&exchange->request, impl->allocator, TCP_LENGTH_PREFIX_SIZE + request.len) ||
+        aws_byte_buf_init(
+            &exchange->response, impl->allocator, TCP_LENGTH_PREFIX_SIZE + AWS_DNS_EDNS_UDP_PAYLOAD_SIZE)) {
+        goto on_error;
+    }
+
+    aws_byte_buf_write_be16(&exchange->request, (uint16_t)request.len);
+    aws_byte_buf_write_from_whole_cursor(&exchange->request, request);
+
+    struct aws_socket_options options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = s_endpoint_domain(&nameserver->endpoint),
+        .connect_timeout_ms = (uint32_t)aws_timestamp_convert(
+            impl->query_timeout_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL),
+    };
+
+    if (aws_socket_init(&exchange->socket, impl->allocator, &options)) {
+        goto on_error;
+    }
+
+    if (aws_socket_connect(&exchange->socket, &nameserver->endpoint, impl->loop, s_on_tcp_connected, exchange)) {
+        aws_socket_clean_up(&exchange->socket);
+        goto on_error;
+    }
+
+    impl->tcp_exchange_count += 1;
+    exchange->query = query;
+    query->tcp_exchange = exchange;
+    return AWS_OP_SUCCESS;
+
+on_error:
+    aws_byte_buf_clean_up(&exchange->request);
+    aws_byte_buf_clean_up(&exchange->response);
+    aws_mem_release(impl->allocator, exchange);
+    return AWS_OP_ERR;
+}
+
+/************************************************ responses ******************************************************/
+
+static void s_stop_attempt(struct dns_query *query) {
+    s_cancel_query_timeout(query);
+    s_unregister_query_id(query);
+
+    if (query->waiting) {
+        aws_linked_list_remove(&query->waiting_node);
+        query->waiting = false;
+    }
+
+    if (query->tcp_exchange) {
+        s_tcp_exchange_close(query->tcp_exchange);
+    }
+}
+
+static void s_query_complete(struct dns_query *query, int error_code, const struct aws_dns_response *response) {
+    s_stop_attempt(query);
+
+    query->completed = true;
+    aws_linked_list_remove(&query->node);
+
+    s_on_entry_query_finished(query->entry, error_code, response);
+
+    if (query->writes_in_flight == 0) {
+        s_query_destroy(query);
+    }
+}
+
+static void s_on_query_response(struct dns_query *query, struct aws_byte_cursor message, bool over_tcp) {
+    struct async_host_resolver *impl = query->resolver;
+
+    struct aws_dns_response response;
+    if (aws_dns_response_init(&response, impl->allocator)) {
+        s_query_complete(query, aws_last_error(), NULL);
+        return;
+    }
+
+    if (aws_dns_message_decode_response(
+            message, aws_byte_cursor_from_string(query->entry->host_name), query->record_type, &response)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: discarding malformed response to query %" PRIu16 ".",
+            (void *)impl->resolver,
+            query->id);
+        /* over udp this could be anyone's garbage, keep waiting for the real answer. */
+        if (over_tcp) {
+            s_on_attempt_failed(query);
+        }
+        goto done;
+    }
+
+    if (response.truncated) {
+        /* the id stays registered so the timeout covers the tcp exchange too. */
+        if (over_tcp || s_start_tcp_exchange(query)) {
+            s_on_attempt_failed(query);
+        }
+        goto done;
+    }
+
+    switch (response.rcode) {
+        case AWS_DNS_RCODE_NOERROR:
+            s_query_complete(query, AWS_ERROR_SUCCESS, &response);
+            break;
+        case AWS_DNS_RCODE_NXDOMAIN:
+            s_query_complete(query, AWS_IO_DNS_INVALID_NAME, NULL);
+            break;
+        default:
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_DNS,
+                "id=%p: nameserver %s answered query %" PRIu16 " with rcode %d.",
+                (void *)impl->resolver,
+                impl->nameservers[query->nameserver_index].endpoint.address,
+                query->id,
+                (int)response.rcode);
+            s_on_attempt_failed(query);
+            break;
+    }
+
+done:
+    aws_dns_response_clean_up(&response);
+}
+
+static void s_on_udp_message(struct dns_nameserver *nameserver, struct aws_byte_cursor message) {
+    struct async_host_resolver *impl = nameserver->resolver;
+
+    uint16_t id = 0;
+    if (aws_dns_message_read_id(message, &id)) {
+        return;
+    }
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&impl->queries_by_id, (void *)(uintptr_t)id, &element);
+    if (!element) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_DNS, "id=%p: ignoring response with unknown id %" PRIu16 ".", (void *)impl->resolver, id);
+        return;
+    }
+
+    struct dns_query *query = element->value;
+    /* only the server we asked gets to answer, and once we went to tcp only the tcp answer counts. */
+    if (&impl->nameservers[query->nameserver_index] != nameserver || query->tcp_exchange) {
+        return;
+    }
+
+    s_on_query_response(query, message, false);
+}
+
+/************************************************ shutdown *******************************************************/
+
+static void s_clean_up_async_resolver(struct aws_host_resolver *resolver) {
+    struct async_host_resolver *impl = resolver->impl;
+
+    if (aws_hash_table_is_valid(&impl->host_entries)) {
+        for (struct aws_hash_iter iter = aws_hash_iter_begin(&impl->host_entries); !aws_hash_iter_done(&iter);
+             aws_hash_iter_next(&iter)) {
+            s_host_entry_destroy(iter.element.value);
+        }
+    }
+
+    for (size_t i = 0; impl->nameservers && i < impl->nameserver_count; ++i) {
+        aws_socket_clean_up(&impl->nameservers[i].socket);
+    }
+
+    aws_mem_release(impl->allocator, impl->nameservers);
+    aws_hash_table_clean_up(&impl->host_entries);
+    aws_hash_table_clean_up(&impl->queries_by_id);
+    aws_byte_buf_clean_up(&impl->read_buffer);
+    aws_mutex_clean_up(&impl->lock);
+
+    struct aws_event_loop_group *el_group = impl->el_group;
+    aws_simple_completion_callback *shutdown_callback = resolver->shutdown_options.shutdown_callback_fn;
+    void *shutdown_completion_user_data = resolver->shutdown_options.shutdown_callback_user_data;
+
+    aws_mem_release(resolver->allocator, resolver);
+    aws_event_loop_group_release(el_group);
+
+    if (shutdown_callback != NULL) {
+        shutdown_callback(shutdown_completion_user_data);
+    }
+}
+
+static void s_finish_teardown(struct async_host_resolver *impl) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_DNS, "id=%p: async host resolver shut down.", (void *)impl->resolver);
+    s_clean_up_async_resolver(impl->resolver);
+}
+
+static void s_shutdown_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct async_host_resolver *impl = arg;
+
+    /* closing flushes every pending write callback, so completed queries are freed as we go. */
+    for (size_t i = 0; i < impl->nameserver_count; ++i) {
+        struct dns_nameserver *nameserver = &impl->nameservers[i];
+        s_close_nameserver(nameserver);
+        while (!aws_linked_list_empty(&nameserver->waiting_queries)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&nameserver->waiting_queries);
+            AWS_CONTAINER_OF(node, struct dns_query, waiting_node)->waiting = false;
+        }
+    }
+
+    while (!aws_linked_list_empty(&impl->queries)) {
+        struct dns_query *query = AWS_CONTAINER_OF(aws_linked_list_front(&impl->queries), struct dns_query, node);
+        s_query_complete(query, AWS_IO_DNS_HOST_REMOVED_FROM_CACHE, NULL);
+    }
+
+    impl->tearing_down = true;
+    if (impl->tcp_exchange_count == 0) {
+        s_finish_teardown(impl);
+    }
+}
+
+static void s_async_resolver_destroy(struct aws_host_resolver *resolver) {
+    struct async_host_resolver *impl = resolver->impl;
+
+    aws_mutex_lock(&impl->lock);
+    AWS_FATAL_ASSERT(!impl->shutting_down);
+    impl->shutting_down = true;
+    aws_mutex_unlock(&impl->lock);
+
+    /* sockets, timers and in flight queries all belong to the loop, so that's where they get torn down. */
+    aws_task_init(&impl->shutdown_task, s_shutdown_task, impl, "async_host_resolver_shutdown");
+    aws_event_loop_schedule_task_now(impl->loop, &impl->shutdown_task);
+}
+
+/************************************************ vtable *********************************************************/
+
+static int s_async_resolve_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
+
+    struct async_host_resolver *impl = resolver->impl;
+
+    uint64_t now = 0;
+    if (aws_high_res_clock_get_ticks(&now)) {
+        return AWS_OP_ERR;
+    }
+
+    struct pending_callback *pending = aws_mem_calloc(impl->allocator, 1, sizeof(struct pending_callback));
+    if (!pending) {
+        return AWS_OP_ERR;
+    }
+
+    pending->callback = res;
+    pending->user_data = user_data;
+    if (aws_array_list_init_dynamic(&pending->addresses, impl->allocator, 2, sizeof(struct aws_host_address))) {
+        aws_mem_release(impl->allocator, pending);
+        return AWS_OP_ERR;
+    }
+
+    aws_mutex_lock(&impl->lock);
+
+    if (impl->shutting_down) {
+        aws_mutex_unlock(&impl->lock);
+        goto on_error_raise_state;
+    }
+
+    struct async_host_entry *entry = NULL;
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&impl->host_entries, host_name, &element);
+    if (element) {
+        entry = element->value;
+    }
+
+    if (entry && !entry->lookup_in_flight && now < entry->expiry && s_host_entry_has_records(entry)) {
+        entry->last_use = now;
+        int result = s_copy_picked_addresses(entry, &pending->addresses);
+        aws_mutex_unlock(&impl->lock);
+
+        if (result == AWS_OP_SUCCESS) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_DNS, "id=%p: %s resolved from cache.", (void *)resolver, aws_string_c_str(host_name));
+            res(resolver, host_name, AWS_ERROR_SUCCESS, &pending->addresses, user_data);
+        }
+
+        s_clean_up_address_list(&pending->addresses);
+        aws_mem_release(impl->allocator, pending);
+        return result;
+    }
+
+    if (!entry) {
+        s_make_room_for_entry(impl);
+        entry = s_host_entry_new(impl, host_name);
+        if (!entry) {
+            aws_mutex_unlock(&impl->lock);
+            goto on_error;
+        }
+
+        if (aws_hash_table_put(&impl->host_entries, entry->host_name, entry, NULL)) {
+            aws_mutex_unlock(&impl->lock);
+            s_host_entry_destroy(entry);
+            goto on_error;
+        }
+    }
+
+    entry->last_use = now;
+    aws_linked_list_push_back(&entry->pending_callbacks, &pending->node);
+
+    if (!entry->lookup_in_flight) {
+        entry->lookup_in_flight = true;
+        entry->max_ttl_secs = config ? config->max_ttl : 0;
+        aws_task_init(&entry->lookup_task, s_lookup_task, entry, "async_host_resolver_lookup");
+        aws_event_loop_schedule_task_now(impl->loop, &entry->lookup_task);
+    }
+
+    aws_mutex_unlock(&impl->lock);
+    return AWS_OP_SUCCESS;
+
+on_error_raise_state:
+    aws_raise_error(AWS_ERROR_INVALID_STATE);
+on_error:
+    aws_array_list_clean_up(&pending->addresses);
+    aws_mem_release(impl->allocator, pending);
+    return AWS_OP_ERR;
+}
+
+static int s_async_record_connection_failure(struct aws_host_resolver *resolver, struct aws_host_address *address) {
+    struct async_host_resolver *impl = resolver->impl;
+
+    aws_mutex_lock(&impl->lock);
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&impl->host_entries, address->host, &element);
+    if (element) {
+        struct async_host_entry *entry = element->value;
+        struct aws_array_list *records =
+            address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? &entry->aaaa_records : &entry->a_records;
+
+        size_t count = aws_array_list_length(records);
+        for (size_t i = 0; i < count; ++i) {
+            struct aws_host_address *cached = NULL;
+            aws_array_list_get_at_ptr(records, (void **)&cached, i);
+            if (aws_string_eq(cached->address, address->address)) {
+                /* picks prefer the addresses with the fewest failures, so this one drops out of rotation. */
+                cached->connection_failure_count += 1;
+                break;
+            }
+        }
+    }
+
+    aws_mutex_unlock(&impl->lock);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_async_purge_cache(struct aws_host_resolver *resolver) {
+    struct async_host_resolver *impl = resolver->impl;
+
+    aws_mutex_lock(&impl->lock);
+
+    struct aws_hash_iter iter = aws_hash_iter_begin(&impl->host_entries);
+    while (!aws_hash_iter_done(&iter)) {
+        struct async_host_entry *entry = iter.element.value;
+        if (s_host_entry_is_busy(entry)) {
+            /* the loop still needs it, just make sure whatever it holds now isn't served again. */
+            s_clear_records(&entry->aaaa_records);
+            s_clear_records(&entry->a_records);
+            entry->expiry = 0;
+        } else {
+            aws_hash_iter_delete(&iter, false);
+            s_host_entry_destroy(entry);
+        }
+        aws_hash_iter_next(&iter);
+    }
+
+    aws_mutex_unlock(&impl->lock);
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_async_get_host_address_count(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    uint32_t flags) {
+
+    struct async_host_resolver *impl = resolver->impl;
+    size_t count = 0;
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    aws_mutex_lock(&impl->lock);
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&impl->host_entries, host_name, &element);
+    if (element) {
+        struct async_host_entry *entry = element->value;
+        if (now < entry->expiry) {
+            if (flags & AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_A) {
+                count += aws_array_list_length(&entry->a_records);
+            }
+            if (flags & AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_AAAA) {
+                count += aws_array_list_length(&entry->aaaa_records);
+            }
+        }
+    }
+
+    aws_mutex_unlock(&impl->lock);
+    return count;
+}
+
+static struct aws_host_resolver_vtable s_async_vtable = {
+    .purge_cache = s_async_purge_cache,
+    .resolve_host = s_async_resolve_host,
+    .record_connection_failure = s_async_record_connection_failure,
+    .get_host_address_count = s_async_get_host_address_count,
+    .destroy = s_async_resolver_destroy,
+};
+
+static void s_async_host_resolver_destroy(struct aws_host_resolver *resolver) {
+    resolver->vtable->destroy(resolver);
+}
+
+struct aws_host_resolver *aws_host_resolver_new_async(
+    struct aws_allocator *allocator,
+    const struct aws_host_resolver_async_options *options) {
+
+    AWS_PRECONDITION(options);
+
+    if (!options->el_group || (options->nameserver_count > 0 && !options->nameservers)) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_host_resolver *resolver = NULL;
+    struct async_host_resolver *impl = NULL;
+    if (!aws_mem_acquire_many(
+            allocator, 2, &resolver, sizeof(struct aws_host_resolver), &impl, sizeof(struct async_host_resolver))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*resolver);
+    AWS_ZERO_STRUCT(*impl);
+
+    resolver->vtable = &s_async_vtable;
+    resolver->allocator = allocator;
+    resolver->impl = impl;
+
+    impl->allocator = allocator;
+    impl->resolver = resolver;
+    impl->max_entries = options->max_entries ? options->max_entries : DEFAULT_MAX_ENTRIES;
+    impl->max_retries = options->max_retries ? options->max_retries : DEFAULT_MAX_RETRIES;
+    impl->query_timeout_ns = aws_timestamp_convert(
+        options->query_timeout_ms ? options->query_timeout_ms : DEFAULT_QUERY_TIMEOUT_MS,
+        AWS_TIMESTAMP_MILLIS,
+        AWS_TIMESTAMP_NANOS,
+        NULL);
+    aws_linked_list_init(&impl->queries);
+    aws_mutex_init(&impl->lock);
+    impl->el_group = aws_event_loop_group_acquire(options->el_group);
+    impl->loop = aws_event_loop_group_get_next_loop(options->el_group);
+
+    struct aws_array_list nameservers;
+    if (aws_array_list_init_dynamic(&nameservers, allocator, 4, sizeof(struct aws_socket_endpoint))) {
+        goto on_error;
+    }
+
+    int load_result = AWS_OP_SUCCESS;
+    for (size_t i = 0; i < options->nameserver_count && !load_result; ++i) {
+        load_result = aws_array_list_push_back(&nameservers, &options->nameservers[i]);
+    }
+    if (options->nameserver_count == 0) {
+        load_result = aws_dns_load_system_nameservers(&nameservers);
+    }
+
+    impl->nameserver_count = aws_array_list_length(&nameservers);
+    if (!load_result && impl->nameserver_count > 0) {
+        impl->nameservers = aws_mem_calloc(allocator, impl->nameserver_count, sizeof(struct dns_nameserver));
+    }
+
+    if (!impl->nameservers) {
+        aws_array_list_clean_up(&nameservers);
+        goto on_error;
+    }
+
+    for (size_t i = 0; i < impl->nameserver_count; ++i) {
+        struct dns_nameserver *nameserver = &impl->nameservers[i];
+        nameserver->resolver = impl;
+        aws_array_list_get_at(&nameservers, &nameserver->endpoint, i);
+        aws_linked_list_init(&nameserver->waiting_queries);
+    }
+    aws_array_list_clean_up(&nameservers);
+
+    if (aws_hash_table_init(
+            &impl->host_entries,
+            allocator,
+            impl->max_entries,
+            aws_hash_string,
+            aws_hash_callback_string_eq,
+            NULL,
+            NULL)) {
+        goto on_error;
+    }
+
+    if (aws_hash_table_init(&impl->queries_by_id, allocator, 16, aws_hash_ptr, aws_ptr_eq, NULL, NULL)) {
+        goto on_error;
+    }
+
+    if (aws_byte_buf_init(&impl->read_buffer, allocator, UDP_READ_BUFFER_SIZE)) {
+        goto on_error;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_DNS,
+        "id=%p: Initializing async host resolver with %llu nameservers and %llu max host entries.",
+        (void *)resolver,
+        (unsigned long long)impl->nameserver_count,
+        (unsigned long long)impl->max_entries);
+
+    aws_ref_count_init(&resolver->ref_count, resolver, (aws_simple_completion_callback *)s_async_host_resolver_destroy);
+
+    if (options->shutdown_options != NULL) {
+        resolver->shutdown_options = *options->shutdown_options;
+    }
+
+    return resolver;
+
+on_error:
+    s_clean_up_async_resolver(resolver);
+    return NULL;
+}
@@ -0,0 +1,189 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/async_stream.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/stream.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/task_scheduler.h>
+
+int aws_async_input_stream_read(
+    struct aws_async_input_stream *stream,
+    struct aws_byte_buf *dest,
+    aws_async_input_stream_on_read_complete_fn *on_complete,
+    void *user_data) {
+    AWS_ASSERT(stream && stream->vtable && stream->vtable->read);
+    AWS_ASSERT(dest);
+    AWS_ASSERT(dest->len <= dest->capacity);
+    AWS_ASSERT(on_complete);
+
+    return stream->vtable->read(stream, dest, on_complete, user_data);
+}
+
+void aws_async_input_stream_destroy(struct aws_async_input_stream *stream) {
+    if (stream != NULL) {
+        AWS_ASSERT(stream->vtable && stream->vtable->destroy);
+
+        stream->vtable->destroy(stream);
+    }
+}
+
+/*
+ * async stream running the reads of a synchronous stream on an I/O thread
+ */
+struct aws_async_input_stream_from_sync_impl {
+    struct aws_input_stream *source;
+    struct aws_event_loop_group *io_group;
+    struct aws_event_loop *io_loop;
+    struct aws_event_loop *completion_loop;
+    struct aws_task read_task;
+    struct aws_task completion_task;
+    struct aws_atomic_var read_in_flight;
+
+    /* state of the read in flight, only touched by whoever currently owns it (caller -> I/O thread -> completion) */
+    struct aws_byte_buf *dest;
+    aws_async_input_stream_on_read_complete_fn *on_complete;
+    void *user_data;
+    int error_code;
+    bool end_of_stream;
+};
+
+static void s_complete_read(struct aws_async_input_stream *stream) {
+    struct aws_async_input_stream_from_sync_impl *impl = stream->impl;
+
+    aws_async_input_stream_on_read_complete_fn *on_complete = impl->on_complete;
+    void *user_data = impl->user_data;
+    int error_code = impl->error_code;
+    bool end_of_stream = impl->end_of_stream;
+    impl->dest = NULL;
+    impl->on_complete = NULL;
+    impl->user_data = NULL;
+
+    /* before the callback, so it can start the next read */
+    aws_atomic_store_int(&impl->read_in_flight, 0);
+
+    on_complete(stream, error_code, end_of_stream, user_data);
+}
+
+static void s_completion_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_async_input_stream *stream = arg;
+    struct aws_async_input_stream_from_sync_impl *impl = stream->impl;
+
+    if (status != AWS_TASK_STATUS_RUN_READY && !impl->error_code) {
+        impl->error_code = AWS_ERROR_IO_OPERATION_CANCELLED;
+    }
+
+    s_complete_read(stream);
+}
+
+static void s_read_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_async_input_stream *stream = arg;
+    struct aws_async_input_stream_from_sync_impl *impl = stream->impl;
+
+    impl->error_code = AWS_OP_SUCCESS;
+    impl->end_of_stream = false;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        impl->error_code = AWS_ERROR_IO_OPERATION_CANCELLED;
+    } else {
+        /* this is the blocking part */
+        struct aws_stream_status stream_status;
+        if (aws_input_stream_read(impl->source, impl->dest) ||
+            aws_input_stream_get_status(impl->source, &stream_status)) {
+            impl->error_code = aws_last_error();
+        } else {
+            impl->end_of_stream = stream_status.is_end_of_stream;
+        }
+    }
+
+    if (impl->completion_loop && status == AWS_TASK_STATUS_RUN_READY) {
+        aws_task_init(&impl->completion_task, s_completion_task, stream, "async_input_stream_read_completion");
+        aws_event_loop_schedule_task_now(impl->completion_loop, &impl->completion_task);
+        return;
+    }
+
+    s_complete_read(stream);
+}
+
+static int s_async_input_stream_from_sync_read(
+    struct aws_async_input_stream *stream,
+    struct aws_byte_buf *dest,
+    aws_async_input_stream_on_read_complete_fn *on_complete,
+    void *user_data) {
+    struct aws_async_input_stream_from_sync_impl *impl = stream->impl;
+
+    if (aws_atomic_exchange_int(&impl->read_in_flight, 1)) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    impl->dest = dest;
+    impl->on_complete = on_complete;
+    impl->user_data = user_data;
+
+    aws_task_init(&impl->read_task, s_read_task, stream, "async_input_stream_read");
+    aws_event_loop_schedule_task_now(impl->io_loop, &impl->read_task);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_async_input_stream_from_sync_destroy(struct aws_async_input_stream *stream) {
+    struct aws_async_input_stream_from_sync_impl *impl = stream->impl;
+
+    AWS_ASSERT(aws_atomic_load_int(&impl->read_in_flight) == 0);
+
+    aws_input_stream_destroy(impl->source);
+    aws_event_loop_group_release(impl->io_group);
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_async_input_stream_vtable s_async_input_stream_from_sync_vtable = {
+    .read = s_async_input_stream_from_sync_read,
+    .destroy = s_async_input_stream_from_sync_destroy,
+};
+
+struct aws_async_input_stream *aws_async_input_stream_new_from_sync(
+    struct aws_allocator *allocator,
+    const struct aws_async_input_stream_from_sync_options *options) {
+    AWS_ASSERT(options);
+
+    if (!options->source || !options->io_group) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_async_input_stream *stream = NULL;
+    struct aws_async_input_stream_from_sync_impl *impl = NULL;
+
+    aws_mem_acquire_many(
+        allocator,
+        2,
+        &stream,
+        sizeof(struct aws_async_input_stream),
+        &impl,
+        sizeof(struct aws_async_input_stream_from_sync_impl));
+
+    if (!stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    stream->allocator = allocator;
+    stream->vtable = &s_async_input_stream_from_sync_vtable;
+    stream->impl = impl;
+
+    impl->source = options->source;
+    impl->io_group = aws_event_loop_group_acquire(options->io_group);
+    impl->io_loop = aws_event_loop_group_get_next_loop(options->io_group);
+    impl->completion_loop = options->completion_loop;
+    aws_atomic_init_int(&impl->read_in_flight, 0);
+
+    return stream;
+}
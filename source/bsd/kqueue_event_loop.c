@@ -6,6 +6,7 @@
 #include <aws/io/event_loop.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/cross_thread_task_queue.h>
 
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
@@ -21,6 +22,7 @@
 #include <sys/event.h>
 
 #include <aws/io/io.h>
+#include <errno.h>
 #include <limits.h>
 #include <unistd.h>
 
@@ -56,9 +58,15 @@ enum pipe_fd_index {
     WRITE_FD,
 };
 
+enum {
+    DEFAULT_TIMEOUT_SEC = 100, /* Max kevent() timeout per loop of the event-thread */
+    MAX_EVENTS = 100,          /* Max kevents to process per loop of the event-thread */
+};
+
 struct kqueue_loop {
     /* thread_created_on is the handle to the event loop thread. */
     struct aws_thread thread_created_on;
+    struct aws_thread_options thread_options;
     /* thread_joined_to is used by the thread destroying the event loop. */
     aws_thread_id_t thread_joined_to;
     /* running_thread_id is NULL if the event loop thread is stopped or points-to the thread_id of the thread running
@@ -72,12 +80,13 @@ struct kqueue_loop {
     int cross_thread_signal_pipe[2];
 
     /* cross_thread_data holds things that must be communicated across threads.
-     * When the event-thread is running, the mutex must be locked while anyone touches anything in cross_thread_data.
+     * When the event-thread is running, the mutex must be locked while anyone touches state or thread_signaled.
+     * tasks_to_schedule is a lock-free queue and needs no lock.
      * If this data is modified outside the thread, the thread is signaled via activity on a pipe. */
     struct {
         struct aws_mutex mutex;
-        bool thread_signaled; /* whether thread has been signaled about changes to cross_thread_data */
-        struct aws_linked_list tasks_to_schedule;
+        bool thread_signaled; /* whether thread has been signaled about changes to state */
+        struct aws_cross_thread_task_queue tasks_to_schedule;
         enum event_thread_state state;
     } cross_thread_data;
 
@@ -87,6 +96,11 @@ struct kqueue_loop {
 
         int connected_handle_count;
 
+        /* kevent() changes queued by subscribe and unsubscribe, submitted together with the next wait. Never more
+         * than MAX_EVENTS, so that every failed change has room to come back in the wait's eventlist. */
+        struct kevent pending_changes[MAX_EVENTS];
+        int pending_change_count;
+
         /* These variables duplicate ones in cross_thread_data. We move values out while holding the mutex and operate
          * on them later */
         enum event_thread_state state;
@@ -109,11 +123,6 @@ struct handle_data {
     struct aws_task cleanup_task;
 };
 
-enum {
-    DEFAULT_TIMEOUT_SEC = 100, /* Max kevent() timeout per loop of the event-thread */
-    MAX_EVENTS = 100,          /* Max kevents to process per loop of the event-thread */
-};
-
 struct aws_event_loop_vtable s_kqueue_vtable = {
     .destroy = s_destroy,
     .run = s_run,
@@ -128,9 +137,14 @@ struct aws_event_loop_vtable s_kqueue_vtable = {
     .is_on_callers_thread = s_is_event_thread,
 };
 
-struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+struct aws_event_loop *aws_event_loop_new_default_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
     AWS_ASSERT(alloc);
-    AWS_ASSERT(clock);
+    AWS_ASSERT(options);
+    AWS_ASSERT(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
 
     bool clean_up_event_loop_mem = false;
     bool clean_up_event_loop_base = false;
@@ -168,6 +182,7 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
         goto clean_up;
     }
     clean_up_thread = true;
+    impl->thread_options = options->thread_options ? *options->thread_options : *aws_default_thread_options();
 
     impl->kq_fd = kqueue();
     if (impl->kq_fd == -1) {
@@ -224,7 +239,7 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
 
     impl->cross_thread_data.thread_signaled = false;
 
-    aws_linked_list_init(&impl->cross_thread_data.tasks_to_schedule);
+    aws_cross_thread_task_queue_init(&impl->cross_thread_data.tasks_to_schedule);
 
     impl->cross_thread_data.state = EVENT_THREAD_STATE_READY_TO_RUN;
 
@@ -302,8 +317,12 @@ static void s_destroy(struct aws_event_loop *event_loop) {
 
     aws_task_scheduler_clean_up(&impl->thread_data.scheduler); /* Tasks in scheduler get cancelled*/
 
-    while (!aws_linked_list_empty(&impl->cross_thread_data.tasks_to_schedule)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->cross_thread_data.tasks_to_schedule);
+    struct aws_linked_list tasks_to_schedule;
+    aws_linked_list_init(&tasks_to_schedule);
+    aws_cross_thread_task_queue_pop_all(&impl->cross_thread_data.tasks_to_schedule, &tasks_to_schedule);
+
+    while (!aws_linked_list_empty(&tasks_to_schedule)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&tasks_to_schedule);
         struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
         task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
     }
@@ -353,7 +372,8 @@ static int s_run(struct aws_event_loop *event_loop) {
      * and it's ok to touch cross_thread_data without locking the mutex */
     impl->cross_thread_data.state = EVENT_THREAD_STATE_RUNNING;
 
-    int err = aws_thread_launch(&impl->thread_created_on, s_event_thread_main, (void *)event_loop, NULL);
+    int err =
+        aws_thread_launch(&impl->thread_created_on, s_event_thread_main, (void *)event_loop, &impl->thread_options);
     if (err) {
         AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
         goto clean_up;
@@ -456,20 +476,10 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         (void *)task,
         (unsigned long long)run_at_nanos);
     task->timestamp = run_at_nanos;
-    bool should_signal_thread = false;
 
-    /* Begin critical section */
-    aws_mutex_lock(&impl->cross_thread_data.mutex);
-    aws_linked_list_push_back(&impl->cross_thread_data.tasks_to_schedule, &task->node);
-
-    /* Signal thread that cross_thread_data has changed (unless it's been signaled already) */
-    if (!impl->cross_thread_data.thread_signaled) {
-        should_signal_thread = true;
-        impl->cross_thread_data.thread_signaled = true;
-    }
-
-    aws_mutex_unlock(&impl->cross_thread_data.mutex);
-    /* End critical section */
+    /* Signal thread that cross_thread_data has changed, unless an earlier task already did and the thread hasn't
+     * picked it up yet */
+    bool should_signal_thread = aws_cross_thread_task_queue_push(&impl->cross_thread_data.tasks_to_schedule, task);
 
     if (should_signal_thread) {
         signal_cross_thread_data_changed(event_loop);
@@ -490,6 +500,84 @@ static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *ta
     aws_task_scheduler_cancel_task(&kqueue_loop->thread_data.scheduler, task);
 }
 
+/* Called from thread.
+ * Submits changes right away. EV_RECEIPT makes kevent() report the result of every change instead of draining
+ * pending events. Handles whose registration failed get AWS_IO_EVENT_TYPE_ERROR through their callback. */
+static void s_submit_changes_with_receipt(struct aws_event_loop *event_loop, struct kevent *changes, int num_changes) {
+    struct kqueue_loop *impl = event_loop->impl_data;
+
+    for (int i = 0; i < num_changes; ++i) {
+        changes[i].flags |= EV_RECEIPT;
+    }
+
+    int num_receipts = kevent(
+        impl->kq_fd,
+        changes /*changelist*/,
+        num_changes /*nchanges*/,
+        changes /*eventlist. It's OK to re-use the same memory for changelist input and eventlist output*/,
+        num_changes /*nevents*/,
+        NULL /*timeout*/);
+    if (num_receipts == -1) {
+        /* nothing is known about the individual changes, so treat them all as failed */
+        int error = errno;
+        for (int i = 0; i < num_changes; ++i) {
+            changes[i].flags |= EV_ERROR;
+            changes[i].data = error;
+        }
+        num_receipts = num_changes;
+    }
+
+    /* A handle subscribed for both read and write may have had both registrations fail, report it once */
+    struct handle_data *failed_handles[MAX_EVENTS];
+    int num_failed_handles = 0;
+    for (int i = 0; i < num_receipts; ++i) {
+        struct handle_data *handle_data = changes[i].udata;
+
+        /* If a real error occurred, .data contains the error code. Deletes carry no handle_data. */
+        if (changes[i].data == 0 || handle_data == NULL || handle_data->events_this_loop != 0) {
+            continue;
+        }
+
+        handle_data->events_this_loop = AWS_IO_EVENT_TYPE_ERROR;
+        failed_handles[num_failed_handles++] = handle_data;
+    }
+
+    for (int i = 0; i < num_failed_handles; ++i) {
+        struct handle_data *handle_data = failed_handles[i];
+        handle_data->events_this_loop = 0;
+
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to subscribe to events on fd %d",
+            (void *)event_loop,
+            handle_data->owner->data.fd);
+
+        /* a callback earlier in this batch may have unsubscribed it */
+        if (handle_data->state == HANDLE_STATE_SUBSCRIBED) {
+            handle_data->on_event(
+                event_loop, handle_data->owner, AWS_IO_EVENT_TYPE_ERROR, handle_data->on_event_user_data);
+        }
+    }
+}
+
+/* Called from thread.
+ * Queues a change to go with the next kevent() wait, or submits the queue now if it is full. */
+static void s_queue_change(struct aws_event_loop *event_loop, const struct kevent *change) {
+    struct kqueue_loop *impl = event_loop->impl_data;
+
+    impl->thread_data.pending_changes[impl->thread_data.pending_change_count++] = *change;
+    if (impl->thread_data.pending_change_count < MAX_EVENTS) {
+        return;
+    }
+
+    /* Move the changes out first, callbacks reporting failures may queue more */
+    struct kevent changes[MAX_EVENTS];
+    memcpy(changes, impl->thread_data.pending_changes, sizeof(changes));
+    impl->thread_data.pending_change_count = 0;
+
+    s_submit_changes_with_receipt(event_loop, changes, MAX_EVENTS);
+}
+
 /* Scheduled task that connects aws_io_handle with the kqueue */
 static void s_subscribe_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
     (void)task;
@@ -514,84 +602,35 @@ static void s_subscribe_task(struct aws_task *task, void *user_data, enum aws_ta
     AWS_ASSERT(handle_data->state == HANDLE_STATE_SUBSCRIBING);
 
     /* In order to monitor both reads and writes, kqueue requires you to add two separate kevents.
-     * If we're adding two separate kevents, but one of those fails, we need to remove the other kevent.
-     * Therefore we use the EV_RECEIPT flag. This causes kevent() to tell whether each EV_ADD succeeded,
-     * rather than the usual behavior of telling us about recent events. */
-    struct kevent changelist[2];
-    AWS_ZERO_ARRAY(changelist);
+     * Both are queued and go to the kernel with the next wait of the event-thread. If either fails, the failure comes
+     * back as an EV_ERROR event and is reported through the handle's callback with AWS_IO_EVENT_TYPE_ERROR.
+     * Mark the handle subscribed first, a full queue is submitted right away and may report a failure already. */
+    handle_data->state = HANDLE_STATE_SUBSCRIBED;
 
-    int changelist_size = 0;
+    struct kevent change;
 
     if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_READABLE) {
         EV_SET(
-            &changelist[changelist_size++],
+            &change,
             handle_data->owner->data.fd,
             EVFILT_READ /*filter*/,
-            EV_ADD | EV_RECEIPT | EV_CLEAR /*flags*/,
+            EV_ADD | EV_CLEAR /*flags*/,
             0 /*fflags*/,
             0 /*data*/,
             handle_data /*udata*/);
+        s_queue_change(event_loop, &change);
     }
     if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_WRITABLE) {
         EV_SET(
-            &changelist[changelist_size++],
+            &change,
             handle_data->owner->data.fd,
             EVFILT_WRITE /*filter*/,
-            EV_ADD | EV_RECEIPT | EV_CLEAR /*flags*/,
+            EV_ADD | EV_CLEAR /*flags*/,
             0 /*fflags*/,
             0 /*data*/,
             handle_data /*udata*/);
+        s_queue_change(event_loop, &change);
     }
-
-    int num_events = kevent(
-        impl->kq_fd,
-        changelist /*changelist*/,
-        changelist_size /*nchanges*/,
-        changelist /*eventlist. It's OK to re-use the same memory for changelist input and eventlist output*/,
-        changelist_size /*nevents*/,
-        NULL /*timeout*/);
-    if (num_events == -1) {
-        goto subscribe_failed;
-    }
-
-    /* Look through results to see if any failed */
-    for (int i = 0; i < num_events; ++i) {
-        /* Every result should be flagged as error, that's just how EV_RECEIPT works */
-        AWS_ASSERT(changelist[i].flags & EV_ERROR);
-
-        /* If a real error occurred, .data contains the error code */
-        if (changelist[i].data != 0) {
-            goto subscribe_failed;
-        }
-    }
-
-    /* Success */
-    handle_data->state = HANDLE_STATE_SUBSCRIBED;
-    return;
-
-subscribe_failed:
-    AWS_LOGF_ERROR(
-        AWS_LS_IO_EVENT_LOOP,
-        "id=%p: failed to subscribe to events on fd %d",
-        (void *)event_loop,
-        handle_data->owner->data.fd);
-    /* Remove any related kevents that succeeded */
-    for (int i = 0; i < num_events; ++i) {
-        if (changelist[i].data == 0) {
-            changelist[i].flags = EV_DELETE;
-            kevent(
-                impl->kq_fd,
-                &changelist[i] /*changelist*/,
-                1 /*nchanges*/,
-                NULL /*eventlist*/,
-                0 /*nevents*/,
-                NULL /*timeout*/);
-        }
-    }
-
-    /* We can't return an error code because this was a scheduled task.
-     * Notify the user of the failed subscription by passing AWS_IO_EVENT_TYPE_ERROR to the callback. */
-    handle_data->on_event(event_loop, handle_data->owner, AWS_IO_EVENT_TYPE_ERROR, handle_data->on_event_user_data);
 }
 
 static int s_subscribe_to_io_events(
@@ -622,13 +661,13 @@ static int s_subscribe_to_io_events(
 
     handle->additional_data = handle_data;
 
-    /* We schedule a task to perform the actual changes to the kqueue, read on for an explanation why...
+    /* We schedule a task to queue the actual changes to the kqueue, read on for an explanation why...
      *
      * kqueue requires separate registrations for read and write events.
      * If the user wants to know about both read and write, we need register once for read and once for write.
-     * If the first registration succeeds, but the second registration fails, we need to delete the first registration.
-     * If this all happened outside the event-thread, the successful registration's events could begin processing
-     * in the brief window of time before the registration is deleted. */
+     * The changes are queued on the event-thread and submitted with its next wait, together with those of any other
+     * handles subscribed or unsubscribed in the meantime. If a registration fails, the user is told through the
+     * AWS_IO_EVENT_TYPE_ERROR event and the other registration stays until the handle is unsubscribed. */
 
     aws_task_init(&handle_data->subscribe_task, s_subscribe_task, handle_data, "kqueue_event_loop_subscribe");
     s_schedule_task_now(event_loop, &handle_data->subscribe_task);
@@ -664,31 +703,38 @@ static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struc
 
     /* If the handle was successfully subscribed to kqueue, then remove it. */
     if (handle_data->state == HANDLE_STATE_SUBSCRIBED) {
-        struct kevent changelist[2];
-        int changelist_size = 0;
+        /* Its registrations may still be queued. The handle_data is freed before they are submitted, so they must
+         * no longer point at it. Deletes carry no handle_data either, since a failed one comes back after the free. */
+        for (int i = 0; i < impl->thread_data.pending_change_count; ++i) {
+            if (impl->thread_data.pending_changes[i].udata == handle_data) {
+                impl->thread_data.pending_changes[i].udata = NULL;
+            }
+        }
+
+        struct kevent change;
 
         if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_READABLE) {
             EV_SET(
-                &changelist[changelist_size++],
+                &change,
                 handle_data->owner->data.fd,
                 EVFILT_READ /*filter*/,
                 EV_DELETE /*flags*/,
                 0 /*fflags*/,
                 0 /*data*/,
-                handle_data /*udata*/);
+                NULL /*udata*/);
+            s_queue_change(event_loop, &change);
         }
         if (handle_data->events_subscribed & AWS_IO_EVENT_TYPE_WRITABLE) {
             EV_SET(
-                &changelist[changelist_size++],
+                &change,
                 handle_data->owner->data.fd,
                 EVFILT_WRITE /*filter*/,
                 EV_DELETE /*flags*/,
                 0 /*fflags*/,
                 0 /*data*/,
-                handle_data /*udata*/);
+                NULL /*udata*/);
+            s_queue_change(event_loop, &change);
         }
-
-        kevent(impl->kq_fd, changelist, changelist_size, NULL /*eventlist*/, 0 /*nevents*/, NULL /*timeout*/);
     }
 
     /* Schedule a task to clean up the memory. This is done in a task to prevent the following scenario:
@@ -741,8 +787,6 @@ static void s_process_cross_thread_data(struct aws_event_loop *event_loop) {
     struct kqueue_loop *impl = event_loop->impl_data;
 
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: notified of cross-thread data to process", (void *)event_loop);
-    /* If there are tasks to schedule, grab them all out of synced_data.tasks_to_schedule.
-     * We'll process them later, so that we minimize time spent holding the mutex. */
     struct aws_linked_list tasks_to_schedule;
     aws_linked_list_init(&tasks_to_schedule);
 
@@ -756,11 +800,12 @@ static void s_process_cross_thread_data(struct aws_event_loop *event_loop) {
             impl->thread_data.state = EVENT_THREAD_STATE_STOPPING;
         }
 
-        aws_linked_list_swap_contents(&impl->cross_thread_data.tasks_to_schedule, &tasks_to_schedule);
-
         aws_mutex_unlock(&impl->cross_thread_data.mutex);
     } /* End critical section */
 
+    /* The signal pipe has already been drained, so any task pushed after this will signal the thread again. */
+    aws_cross_thread_task_queue_pop_all(&impl->cross_thread_data.tasks_to_schedule, &tasks_to_schedule);
+
     s_process_tasks_to_schedule(event_loop, &tasks_to_schedule);
 }
 
@@ -832,9 +877,18 @@ static void s_event_thread_main(void *user_data) {
             (int)timeout.tv_sec,
             (unsigned long long)timeout.tv_nsec);
 
-        /* Process kqueue events */
+        /* Process kqueue events, submitting the changes queued since the last wait along with it. There are never
+         * more of them than MAX_EVENTS, so each one that fails has room to come back as an EV_ERROR event. */
         int num_kevents = kevent(
-            impl->kq_fd, NULL /*changelist*/, 0 /*nchanges*/, kevents /*eventlist*/, MAX_EVENTS /*nevents*/, &timeout);
+            impl->kq_fd,
+            impl->thread_data.pending_changes /*changelist*/,
+            impl->thread_data.pending_change_count /*nchanges*/,
+            kevents /*eventlist*/,
+            MAX_EVENTS /*nevents*/,
+            &timeout);
+        impl->thread_data.pending_change_count = 0;
+
+        aws_event_loop_register_tick_start(event_loop);
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %d events to process.", (void *)event_loop, num_kevents);
@@ -873,6 +927,10 @@ static void s_event_thread_main(void *user_data) {
 
             /* Combine flags, in case multiple kevents correspond to one handle. (see notes at top of function) */
             struct handle_data *handle_data = kevent->udata;
+            if (handle_data == NULL) {
+                /* a failed delete, its handle is already gone */
+                continue;
+            }
             if (handle_data->events_this_loop == 0) {
                 io_handle_events[num_io_handle_events++] = handle_data;
             }
@@ -889,8 +947,10 @@ static void s_event_thread_main(void *user_data) {
                     "id=%p: activity on fd %d, invoking handler.",
                     (void *)event_loop,
                     handle_data->owner->data.fd);
+                uint64_t start_ns = aws_event_loop_profiler_begin(event_loop);
                 handle_data->on_event(
                     event_loop, handle_data->owner, handle_data->events_this_loop, handle_data->on_event_user_data);
+                aws_event_loop_profiler_end(event_loop, "io_event", start_ns);
             }
 
             handle_data->events_this_loop = 0;
@@ -908,6 +968,8 @@ static void s_event_thread_main(void *user_data) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&impl->thread_data.scheduler, now_ns);
 
+        aws_event_loop_register_tick_end(event_loop, (size_t)num_io_handle_events);
+
         /* Set timeout for next kevent() call.
          * If clock fails, or scheduler has no tasks, use default timeout */
         bool use_default_timeout = false;
@@ -7,27 +7,50 @@
 
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
+#include <aws/common/math.h>
 #include <aws/common/mutex.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 #include <aws/io/message_pool.h>
+#include <aws/io/private/hot_path_logging.h>
 #include <aws/io/statistics.h>
 
 #if _MSC_VER
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
-static size_t s_message_pool_key = 0; /* Address of variable serves as key in hash table */
-
 enum {
     KB_16 = 16 * 1024,
+    DEFAULT_APPLICATION_DATA_MSG_COUNT = 4,
+    DEFAULT_SMALL_BLOCK_MSG_COUNT = 4,
+    SMALL_BLOCK_MSG_DATA_SIZE = 128,
+    /* caps for auto_grow when no max is given */
+    DEFAULT_MAX_APPLICATION_DATA_MSG_COUNT = 256,
+    DEFAULT_MAX_SMALL_BLOCK_MSG_COUNT = 1024,
+    DEFAULT_MAX_SIZE_CLASS_MSG_COUNT = 256,
 };
 
 size_t g_aws_channel_max_fragment_size = KB_16;
 
+size_t g_aws_channel_read_budget_per_tick = 8 * KB_16;
+
+struct aws_channel_message_pool_options g_aws_channel_message_pool_options = {
+    .application_data_msg_count = DEFAULT_APPLICATION_DATA_MSG_COUNT,
+    .small_block_msg_count = DEFAULT_SMALL_BLOCK_MSG_COUNT,
+    .auto_grow = false,
+    .max_application_data_msg_count = 0,
+    .max_small_block_msg_count = 0,
+    .size_class_msg_count = 0,
+    .max_size_class_msg_count = 0,
+    .zero_policy = AWS_MESSAGE_POOL_ZERO_ALWAYS,
+};
+
 #define INITIAL_STATISTIC_LIST_SIZE 5
 
+/* Slots carved out of the channel's own allocation. socket + TLS + application, the usual channel, needs no other. */
+#define CHANNEL_INLINE_SLOT_COUNT 3
+
 enum aws_channel_state {
     AWS_CHANNEL_SETTING_UP,
     AWS_CHANNEL_ACTIVE,
@@ -49,6 +72,26 @@ struct shutdown_task {
     bool shutdown_immediately;
 };
 
+/*
+ * Channels on one event loop shut down together by aws_channel_shutdown_many(). Until a channel has finished, its
+ * channel level shutdown steps (starting, turning from the read to the write direction, and the completion callback)
+ * queue up here instead of each scheduling a task, and one task runs everything queued. Only touched from the loop's
+ * thread once scheduled.
+ */
+struct channel_shutdown_batch {
+    struct aws_allocator *alloc;
+    struct aws_event_loop *loop;
+    struct aws_task task;
+    /* only used while aws_channel_shutdown_many() groups channels by loop */
+    struct aws_linked_list_node node;
+    /* channels with a step waiting, linked through shutdown_batch_node. What the step is follows from channel_state. */
+    struct aws_linked_list ready;
+    /* channels that haven't finished shutting down yet */
+    size_t outstanding;
+    bool task_scheduled;
+    bool running;
+};
+
 struct aws_channel {
     struct aws_allocator *alloc;
     struct aws_event_loop *loop;
@@ -61,10 +104,13 @@ struct aws_channel {
     struct aws_atomic_var refcount;
     struct aws_task deletion_task;
 
-    struct aws_task statistics_task;
-    struct aws_crt_statistics_handler *statistics_handler;
-    uint64_t statistics_interval_start_time_ms;
-    struct aws_array_list statistic_list;
+    /* NULL until a statistics handler is first set, most channels never have one */
+    struct channel_statistics *statistics;
+    /* only set from aws_channel_migrate() until the channel has arrived on its new loop */
+    struct channel_migration *migration;
+    /* set from aws_channel_shutdown_many() until the channel has shut down */
+    struct channel_shutdown_batch *shutdown_batch;
+    struct aws_linked_list_node shutdown_batch_node;
 
     struct {
         struct aws_linked_list list;
@@ -72,15 +118,57 @@ struct aws_channel {
     struct {
         struct aws_mutex lock;
         struct aws_linked_list list;
+        /* messages from aws_channel_write_from_any_thread(), linked through queueing_handle. Shares scheduling_task
+         * with list, so a burst of writes and tasks wakes the loop once. */
+        struct aws_linked_list writes;
         struct aws_task scheduling_task;
         struct shutdown_task shutdown_task;
         bool is_channel_shut_down;
+        /* between aws_channel_migrate() and the channel arriving on its new loop, tasks from other threads wait */
+        bool is_migrating;
+        /* scheduling_task ran while is_migrating, so the new loop has to schedule it */
+        bool schedule_after_migration;
     } cross_thread_tasks;
 
     size_t window_update_batch_emit_threshold;
+    /* window updates are spaced at least this far apart, piling up in the slots' batches meanwhile. 0 disables. */
+    uint64_t window_update_min_interval_ns;
+    uint64_t last_window_update_ns;
     struct aws_channel_task window_update_task;
+    bool trace_logging_enabled;
     bool read_back_pressure_enabled;
     bool window_update_in_progress;
+    enum aws_channel_read_priority read_priority;
+
+    /* bit i set while inline_slots[i] is handed out */
+    uint8_t inline_slots_in_use;
+    struct aws_channel_slot inline_slots[CHANNEL_INLINE_SLOT_COUNT];
+
+    /* Bump allocator over the arena_size bytes allocated right after this struct. Arena memory is never freed on its
+     * own, it goes away with the channel. Requests that don't fit go to alloc. arena_end is NULL without an arena. */
+    struct aws_allocator arena_allocator;
+    uint8_t *arena_next;
+    uint8_t *arena_end;
+};
+
+struct channel_statistics {
+    struct aws_task task;
+    struct aws_crt_statistics_handler *handler;
+    uint64_t interval_start_time_ms;
+    struct aws_array_list list;
+};
+
+struct channel_migration {
+    struct aws_event_loop *new_loop;
+    aws_channel_on_migrated_fn *on_migrated;
+    void *user_data;
+    struct aws_task task;
+    /* the channel's tasks, taken off the old loop with their wrapper tasks' timestamps intact */
+    struct aws_linked_list tasks;
+    /* when the statistics task was due, 0 if there was none */
+    uint64_t statistics_run_at_ns;
+    /* while set, s_channel_task_run() hands canceled tasks to the migration instead of running them */
+    bool taking_tasks;
 };
 
 struct channel_setup_args {
@@ -88,6 +176,7 @@ struct channel_setup_args {
     struct aws_channel *channel;
     aws_channel_on_setup_completed_fn *on_setup_completed;
     void *user_data;
+    struct aws_channel_message_pool_options message_pool_options;
     struct aws_task task;
 };
 
@@ -104,87 +193,113 @@ static void s_on_msg_pool_removed(struct aws_event_loop_local_object *object) {
     aws_mem_release(alloc, object);
 }
 
-static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
-
-    (void)task;
-    struct channel_setup_args *setup_args = arg;
-    struct aws_message_pool *message_pool = NULL;
-    struct aws_event_loop_local_object *local_object = NULL;
-
-    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
-    if (task_status == AWS_TASK_STATUS_RUN_READY) {
-        struct aws_event_loop_local_object stack_obj;
-        AWS_ZERO_STRUCT(stack_obj);
-        local_object = &stack_obj;
-
-        if (aws_event_loop_fetch_local_object(setup_args->channel->loop, &s_message_pool_key, local_object)) {
+/* Returns the message pool of the channel's event loop, creating it with pool_options if the loop has none yet. */
+static struct aws_message_pool *s_get_loop_message_pool(
+    struct aws_channel *channel,
+    struct aws_allocator *alloc,
+    const struct aws_channel_message_pool_options *pool_options) {
 
-            local_object = aws_mem_calloc(setup_args->alloc, 1, sizeof(struct aws_event_loop_local_object));
-            if (!local_object) {
-                goto cleanup_setup_args;
-            }
+    struct aws_event_loop_local_object *local_object =
+        aws_event_loop_get_local_slot(channel->loop, AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL);
 
-            message_pool = aws_mem_acquire(setup_args->alloc, sizeof(struct aws_message_pool));
-            if (!message_pool) {
-                goto cleanup_local_obj;
-            }
+    if (local_object) {
+        struct aws_message_pool *message_pool = local_object->object;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: message pool %p found in event-loop local storage: using it.",
+            (void *)channel,
+            (void *)message_pool);
+        return message_pool;
+    }
 
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: no message pool is currently stored in the event-loop "
-                "local storage, adding %p with max message size %zu, "
-                "message count 4, with 4 small blocks of 128 bytes.",
-                (void *)setup_args->channel,
-                (void *)message_pool,
-                g_aws_channel_max_fragment_size);
-
-            struct aws_message_pool_creation_args creation_args = {
-                .application_data_msg_data_size = g_aws_channel_max_fragment_size,
-                .application_data_msg_count = 4,
-                .small_block_msg_count = 4,
-                .small_block_msg_data_size = 128,
-            };
-
-            if (aws_message_pool_init(message_pool, setup_args->alloc, &creation_args)) {
-                goto cleanup_msg_pool_mem;
-            }
+    local_object = aws_mem_calloc(alloc, 1, sizeof(struct aws_event_loop_local_object));
+    if (!local_object) {
+        return NULL;
+    }
 
-            local_object->key = &s_message_pool_key;
-            local_object->object = message_pool;
-            local_object->on_object_removed = s_on_msg_pool_removed;
+    /* This runs on the channel's event-loop thread, and the pool is only ever touched from that thread. When
+     * the loop's thread is pinned (see aws_event_loop_group_new_default_pinned_to_cpu_group()), first-touch
+     * placement therefore keeps the pool's memory on the loop's NUMA node. */
+    struct aws_message_pool *message_pool = aws_mem_acquire(alloc, sizeof(struct aws_message_pool));
+    if (!message_pool) {
+        goto cleanup_local_obj;
+    }
 
-            if (aws_event_loop_put_local_object(setup_args->channel->loop, local_object)) {
-                goto cleanup_msg_pool;
-            }
-        } else {
-            message_pool = local_object->object;
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: message pool %p found in event-loop local storage: using it.",
-                (void *)setup_args->channel,
-                (void *)message_pool)
-        }
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = g_aws_channel_max_fragment_size,
+        .application_data_msg_count = pool_options->application_data_msg_count,
+        .small_block_msg_count = pool_options->small_block_msg_count,
+        .small_block_msg_data_size = SMALL_BLOCK_MSG_DATA_SIZE,
+        .size_class_msg_count = pool_options->size_class_msg_count,
+        .zero_policy = pool_options->zero_policy,
+        .depot = pool_options->depot,
+        .use_huge_pages = pool_options->use_huge_pages,
+    };
+
+    if (pool_options->auto_grow) {
+        creation_args.application_data_msg_max_count = pool_options->max_application_data_msg_count
+                                                           ? pool_options->max_application_data_msg_count
+                                                           : DEFAULT_MAX_APPLICATION_DATA_MSG_COUNT;
+        creation_args.small_block_msg_max_count = pool_options->max_small_block_msg_count
+                                                      ? pool_options->max_small_block_msg_count
+                                                      : DEFAULT_MAX_SMALL_BLOCK_MSG_COUNT;
+        creation_args.size_class_msg_max_count = pool_options->max_size_class_msg_count
+                                                     ? pool_options->max_size_class_msg_count
+                                                     : DEFAULT_MAX_SIZE_CLASS_MSG_COUNT;
+    }
 
-        setup_args->channel->msg_pool = message_pool;
-        setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
-        setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
-        aws_channel_release_hold(setup_args->channel);
-        aws_mem_release(setup_args->alloc, setup_args);
-        return;
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: no message pool is currently stored in the event-loop "
+        "local storage, adding %p with max message size %zu, "
+        "message count %zu (max %zu), with %zu (max %zu) small blocks of %d bytes.",
+        (void *)channel,
+        (void *)message_pool,
+        g_aws_channel_max_fragment_size,
+        creation_args.application_data_msg_count,
+        aws_max_size(creation_args.application_data_msg_count, creation_args.application_data_msg_max_count),
+        creation_args.small_block_msg_count,
+        aws_max_size(creation_args.small_block_msg_count, creation_args.small_block_msg_max_count),
+        (int)SMALL_BLOCK_MSG_DATA_SIZE);
+
+    if (aws_message_pool_init(message_pool, alloc, &creation_args)) {
+        goto cleanup_msg_pool_mem;
     }
 
-    goto cleanup_setup_args;
+    local_object->object = message_pool;
+    local_object->on_object_removed = s_on_msg_pool_removed;
 
-cleanup_msg_pool:
-    aws_message_pool_clean_up(message_pool);
+    aws_event_loop_set_local_slot(channel->loop, AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL, local_object);
+    return message_pool;
 
 cleanup_msg_pool_mem:
-    aws_mem_release(setup_args->alloc, message_pool);
+    aws_mem_release(alloc, message_pool);
 
 cleanup_local_obj:
-    aws_mem_release(setup_args->alloc, local_object);
+    aws_mem_release(alloc, local_object);
+    return NULL;
+}
+
+static void s_on_channel_setup_complete(struct aws_task *task, void *arg, enum aws_task_status task_status) {
+
+    (void)task;
+    struct channel_setup_args *setup_args = arg;
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: setup complete, notifying caller.", (void *)setup_args->channel);
+    if (task_status == AWS_TASK_STATUS_RUN_READY) {
+        struct aws_message_pool *message_pool =
+            s_get_loop_message_pool(setup_args->channel, setup_args->alloc, &setup_args->message_pool_options);
+
+        if (message_pool) {
+            setup_args->channel->msg_pool = message_pool;
+            setup_args->channel->channel_state = AWS_CHANNEL_ACTIVE;
+            setup_args->on_setup_completed(setup_args->channel, AWS_OP_SUCCESS, setup_args->user_data);
+            aws_channel_release_hold(setup_args->channel);
+            aws_mem_release(setup_args->alloc, setup_args);
+            return;
+        }
+    }
 
-cleanup_setup_args:
     setup_args->on_setup_completed(setup_args->channel, AWS_OP_ERR, setup_args->user_data);
     aws_channel_release_hold(setup_args->channel);
     aws_mem_release(setup_args->alloc, setup_args);
@@ -192,13 +307,38 @@ cleanup_setup_args:
 
 static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum aws_task_status status);
 
+#define CHANNEL_ARENA_ALIGNMENT (2 * sizeof(void *))
+
+static bool s_arena_owns(const struct aws_channel *channel, const void *ptr) {
+    const uint8_t *arena_start = (const uint8_t *)(channel + 1);
+    return (const uint8_t *)ptr >= arena_start && (const uint8_t *)ptr < channel->arena_end;
+}
+
+static void *s_arena_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    struct aws_channel *channel = allocator->impl;
+
+    size_t aligned_size = (size + CHANNEL_ARENA_ALIGNMENT - 1) & ~(CHANNEL_ARENA_ALIGNMENT - 1);
+    if (aligned_size >= size && aligned_size <= (size_t)(channel->arena_end - channel->arena_next)) {
+        void *mem = channel->arena_next;
+        channel->arena_next += aligned_size;
+        return mem;
+    }
+
+    return aws_mem_acquire(channel->alloc, size);
+}
+
+static void s_arena_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct aws_channel *channel = allocator->impl;
+    if (!s_arena_owns(channel, ptr)) {
+        aws_mem_release(channel->alloc, ptr);
+    }
+}
+
 static void s_destroy_partially_constructed_channel(struct aws_channel *channel) {
     if (channel == NULL) {
         return;
     }
 
-    aws_array_list_clean_up(&channel->statistic_list);
-
     aws_mem_release(channel->alloc, channel);
 }
 
@@ -207,7 +347,12 @@ struct aws_channel *aws_channel_new(struct aws_allocator *alloc, const struct aw
     AWS_PRECONDITION(creation_args->event_loop);
     AWS_PRECONDITION(creation_args->on_setup_completed);
 
-    struct aws_channel *channel = aws_mem_calloc(alloc, 1, sizeof(struct aws_channel));
+    size_t channel_size = 0;
+    if (aws_add_size_checked(sizeof(struct aws_channel), creation_args->arena_size, &channel_size)) {
+        return NULL;
+    }
+
+    struct aws_channel *channel = aws_mem_calloc(alloc, 1, channel_size);
     if (!channel) {
         return NULL;
     }
@@ -218,9 +363,13 @@ struct aws_channel *aws_channel_new(struct aws_allocator *alloc, const struct aw
     channel->on_shutdown_completed = creation_args->on_shutdown_completed;
     channel->shutdown_user_data = creation_args->shutdown_user_data;
 
-    if (aws_array_list_init_dynamic(
-            &channel->statistic_list, alloc, INITIAL_STATISTIC_LIST_SIZE, sizeof(struct aws_crt_statistics_base *))) {
-        goto on_error;
+    if (creation_args->arena_size) {
+        channel->arena_allocator.mem_acquire = s_arena_mem_acquire;
+        channel->arena_allocator.mem_release = s_arena_mem_release;
+        channel->arena_allocator.impl = channel;
+        /* sizeof(struct aws_channel) is a multiple of its alignment, which covers CHANNEL_ARENA_ALIGNMENT */
+        channel->arena_next = (uint8_t *)(channel + 1);
+        channel->arena_end = channel->arena_next + creation_args->arena_size;
     }
 
     /* Start refcount at 2:
@@ -236,13 +385,21 @@ struct aws_channel *aws_channel_new(struct aws_allocator *alloc, const struct aw
     channel->channel_state = AWS_CHANNEL_SETTING_UP;
     aws_linked_list_init(&channel->channel_thread_tasks.list);
     aws_linked_list_init(&channel->cross_thread_tasks.list);
+    aws_linked_list_init(&channel->cross_thread_tasks.writes);
     channel->cross_thread_tasks.lock = (struct aws_mutex)AWS_MUTEX_INIT;
+    channel->trace_logging_enabled = aws_io_hot_path_trace_enabled(AWS_LS_IO_CHANNEL);
+    channel->read_priority = creation_args->read_priority;
 
     if (creation_args->enable_read_back_pressure) {
         channel->read_back_pressure_enabled = true;
         /* we probably only need room for one fragment, but let's avoid potential deadlocks
          * on things like tls that need extra head-room. */
         channel->window_update_batch_emit_threshold = g_aws_channel_max_fragment_size * 2;
+        if (creation_args->window_update_batch_emit_threshold) {
+            channel->window_update_batch_emit_threshold = creation_args->window_update_batch_emit_threshold;
+        }
+        channel->window_update_min_interval_ns = aws_timestamp_convert(
+            creation_args->window_update_min_interval_us, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
     }
 
     aws_task_init(
@@ -255,9 +412,12 @@ struct aws_channel *aws_channel_new(struct aws_allocator *alloc, const struct aw
     setup_args->channel = channel;
     setup_args->on_setup_completed = creation_args->on_setup_completed;
     setup_args->user_data = creation_args->setup_user_data;
+    setup_args->message_pool_options = creation_args->message_pool_options ? *creation_args->message_pool_options
+                                                                           : g_aws_channel_message_pool_options;
 
     aws_task_init(&setup_args->task, s_on_channel_setup_complete, setup_args, "on_channel_setup_complete");
     aws_event_loop_schedule_task_now(creation_args->event_loop, &setup_args->task);
+    aws_io_metrics_add(AWS_IO_METRIC_OPEN_CHANNELS, 1);
 
     return channel;
 
@@ -273,7 +433,13 @@ static void s_cleanup_slot(struct aws_channel_slot *slot) {
         if (slot->handler) {
             aws_channel_handler_destroy(slot->handler);
         }
-        aws_mem_release(slot->alloc, slot);
+
+        struct aws_channel *channel = slot->channel;
+        if (slot >= channel->inline_slots && slot < channel->inline_slots + CHANNEL_INLINE_SLOT_COUNT) {
+            channel->inline_slots_in_use &= (uint8_t) ~(1u << (slot - channel->inline_slots));
+        } else {
+            aws_mem_release(slot->alloc, slot);
+        }
     }
 }
 
@@ -303,10 +469,13 @@ static void s_final_channel_deletion_task(struct aws_task *task, void *arg, enum
         current = tmp;
     }
 
-    aws_array_list_clean_up(&channel->statistic_list);
-
     aws_channel_set_statistics_handler(channel, NULL);
+    if (channel->statistics) {
+        aws_array_list_clean_up(&channel->statistics->list);
+        aws_mem_release(channel->alloc, channel->statistics);
+    }
 
+    aws_io_metrics_add(AWS_IO_METRIC_OPEN_CHANNELS, -1);
     aws_mem_release(channel->alloc, channel);
 }
 
@@ -342,6 +511,42 @@ static int s_channel_shutdown(struct aws_channel *channel, int error_code, bool
 
 static void s_on_shutdown_completion_task(struct aws_task *task, void *arg, enum aws_task_status status);
 
+static void s_run_shutdown_write_direction(struct aws_task *task, void *arg, enum aws_task_status status);
+
+static void s_shutdown_batch_task(struct aws_task *task, void *arg, enum aws_task_status status);
+
+/* queues the channel's next shutdown step on its batch, waking the batch if it isn't already running or due to run */
+static void s_shutdown_batch_push(struct aws_channel *channel) {
+    struct channel_shutdown_batch *batch = channel->shutdown_batch;
+
+    aws_linked_list_push_back(&batch->ready, &channel->shutdown_batch_node);
+    if (!batch->running && !batch->task_scheduled) {
+        batch->task_scheduled = true;
+        aws_event_loop_schedule_task_now(batch->loop, &batch->task);
+    }
+}
+
+/* the left-most slot finished the write direction, or there were no slots: the channel is shut down. */
+static void s_on_channel_shut_down(struct aws_channel *channel, int error_code) {
+    channel->channel_state = AWS_CHANNEL_SHUT_DOWN;
+    AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "id=%p: shutdown completed", (void *)channel);
+
+    aws_mutex_lock(&channel->cross_thread_tasks.lock);
+    channel->cross_thread_tasks.is_channel_shut_down = true;
+    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+
+    channel->shutdown_notify_task.task.fn = s_on_shutdown_completion_task;
+    channel->shutdown_notify_task.task.arg = channel;
+    channel->shutdown_notify_task.error_code = error_code;
+
+    if (channel->shutdown_batch) {
+        /* the batch has to hear about it even without a callback, to let go of the channel */
+        s_shutdown_batch_push(channel);
+    } else if (channel->on_shutdown_completed) {
+        aws_event_loop_schedule_task_now(channel->loop, &channel->shutdown_notify_task.task);
+    }
+}
+
 static void s_shutdown_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
 
     (void)task;
@@ -367,19 +572,7 @@ static void s_shutdown_task(struct aws_channel_task *task, void *arg, enum aws_t
             return;
         }
 
-        channel->channel_state = AWS_CHANNEL_SHUT_DOWN;
-        AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "id=%p: shutdown completed", (void *)channel);
-
-        aws_mutex_lock(&channel->cross_thread_tasks.lock);
-        channel->cross_thread_tasks.is_channel_shut_down = true;
-        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
-
-        if (channel->on_shutdown_completed) {
-            channel->shutdown_notify_task.task.fn = s_on_shutdown_completion_task;
-            channel->shutdown_notify_task.task.arg = channel;
-            channel->shutdown_notify_task.error_code = error_code;
-            aws_event_loop_schedule_task_now(channel->loop, &channel->shutdown_notify_task.task);
-        }
+        s_on_channel_shut_down(channel, error_code);
     }
 }
 
@@ -416,6 +609,138 @@ int aws_channel_shutdown(struct aws_channel *channel, int error_code) {
     return s_channel_shutdown(channel, error_code, false);
 }
 
+static void s_shutdown_batch_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct channel_shutdown_batch *batch = arg;
+
+    batch->task_scheduled = false;
+    batch->running = true;
+
+    /* steps run from here rather than from inside handlers, which is what scheduling each of them was for */
+    while (!aws_linked_list_empty(&batch->ready)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&batch->ready);
+        struct aws_channel *channel = AWS_CONTAINER_OF(node, struct aws_channel, shutdown_batch_node);
+
+        switch (channel->channel_state) {
+            case AWS_CHANNEL_SETTING_UP:
+            case AWS_CHANNEL_ACTIVE: {
+                struct shutdown_task *shutdown_task = &channel->cross_thread_tasks.shutdown_task;
+                s_shutdown_task(&shutdown_task->task, shutdown_task, status);
+                break;
+            }
+            case AWS_CHANNEL_SHUTTING_DOWN:
+                s_run_shutdown_write_direction(&channel->shutdown_notify_task.task, NULL, status);
+                break;
+            case AWS_CHANNEL_SHUT_DOWN:
+                channel->shutdown_batch = NULL;
+                --batch->outstanding;
+                if (channel->on_shutdown_completed) {
+                    s_on_shutdown_completion_task(&channel->shutdown_notify_task.task, channel, status);
+                }
+                aws_channel_release_hold(channel);
+                break;
+        }
+    }
+
+    batch->running = false;
+
+    /* channels whose handlers are still busy shutting down wake the batch again when they get to their next step */
+    if (batch->outstanding == 0) {
+        AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "static: channel shutdown batch %p finished", (void *)batch);
+        aws_mem_release(batch->alloc, batch);
+    }
+}
+
+int aws_channel_shutdown_many(struct aws_channel **channels, size_t count, int error_code) {
+    AWS_PRECONDITION(channels || count == 0);
+
+    struct aws_linked_list batches;
+    aws_linked_list_init(&batches);
+
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_channel *channel = channels[i];
+
+        /* a handful of loops at most, so a list beats anything cleverer */
+        struct channel_shutdown_batch *batch = NULL;
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&batches);
+             node != aws_linked_list_end(&batches);
+             node = aws_linked_list_next(node)) {
+            struct channel_shutdown_batch *candidate = AWS_CONTAINER_OF(node, struct channel_shutdown_batch, node);
+            if (candidate->loop == channel->loop) {
+                batch = candidate;
+                break;
+            }
+        }
+
+        if (!batch) {
+            batch = aws_mem_calloc(channel->alloc, 1, sizeof(struct channel_shutdown_batch));
+            if (!batch) {
+                /* shutting down can't fail, it just goes the slow way */
+                s_channel_shutdown(channel, error_code, false);
+                continue;
+            }
+
+            batch->alloc = channel->alloc;
+            batch->loop = channel->loop;
+            aws_task_init(&batch->task, s_shutdown_batch_task, batch, "channel_shutdown_batch");
+            aws_linked_list_init(&batch->ready);
+            aws_linked_list_push_back(&batches, &batch->node);
+        }
+
+        bool already_pending = false;
+        aws_mutex_lock(&channel->cross_thread_tasks.lock);
+        if (channel->cross_thread_tasks.shutdown_task.task.task_fn) {
+            already_pending = true;
+        } else {
+            /* marks the shutdown as pending, exactly as aws_channel_shutdown() would, but leaves it to the batch */
+            aws_channel_task_init(
+                &channel->cross_thread_tasks.shutdown_task.task,
+                s_shutdown_task,
+                &channel->cross_thread_tasks.shutdown_task,
+                "channel_shutdown");
+            channel->cross_thread_tasks.shutdown_task.shutdown_immediately = false;
+            channel->cross_thread_tasks.shutdown_task.channel = channel;
+            channel->cross_thread_tasks.shutdown_task.error_code = error_code;
+        }
+        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+
+        if (already_pending) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: Channel shutdown is already pending, leaving it out of the batch.",
+                (void *)channel);
+            continue;
+        }
+
+        /* nobody may destroy a channel before it has shut down, but the batch still looks at it after the callback */
+        aws_channel_acquire_hold(channel);
+        channel->shutdown_batch = batch;
+        aws_linked_list_push_back(&batch->ready, &channel->shutdown_batch_node);
+        ++batch->outstanding;
+    }
+
+    while (!aws_linked_list_empty(&batches)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&batches);
+        struct channel_shutdown_batch *batch = AWS_CONTAINER_OF(node, struct channel_shutdown_batch, node);
+
+        if (batch->outstanding == 0) {
+            aws_mem_release(batch->alloc, batch);
+            continue;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL,
+            "static: shutting down %zu channels on event loop %p in batch %p",
+            batch->outstanding,
+            (void *)batch->loop,
+            (void *)batch);
+        batch->task_scheduled = true;
+        aws_event_loop_schedule_task_now(batch->loop, &batch->task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 struct aws_io_message *aws_channel_acquire_message_from_pool(
     struct aws_channel *channel,
     enum aws_io_message_type message_type,
@@ -438,14 +763,122 @@ struct aws_io_message *aws_channel_acquire_message_from_pool(
     return message;
 }
 
+/* An AWS_IO_MESSAGE_BORROWED_DATA message and its copy of the segment array, in one allocation. Releasing the message
+ * through release_allocator runs the owner's callback. */
+struct borrowed_message {
+    struct aws_io_message message;
+    struct aws_allocator release_allocator;
+    struct aws_allocator *alloc;
+    void (*on_release)(void *user_data);
+    void *release_user_data;
+    struct aws_byte_cursor *segments;
+    size_t segment_count;
+};
+
+static void *s_borrowed_message_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    (void)allocator;
+    (void)size;
+    /* only ever used to release the message it belongs to */
+    AWS_ASSERT(false);
+    aws_raise_error(AWS_ERROR_INVALID_STATE);
+    return NULL;
+}
+
+static void s_borrowed_message_mem_release(struct aws_allocator *allocator, void *ptr) {
+    struct borrowed_message *borrowed = allocator->impl;
+    AWS_ASSERT(ptr == &borrowed->message);
+    (void)ptr;
+
+    if (borrowed->on_release) {
+        borrowed->on_release(borrowed->release_user_data);
+    }
+    aws_mem_release(borrowed->alloc, borrowed);
+}
+
+struct aws_io_message *aws_channel_acquire_borrowed_message(
+    struct aws_channel *channel,
+    const struct aws_io_message_borrowed_options *options) {
+    AWS_PRECONDITION(options);
+    AWS_PRECONDITION(options->segments || !options->segment_count);
+
+    struct borrowed_message *borrowed = NULL;
+    struct aws_byte_cursor *segments = NULL;
+    if (!aws_mem_acquire_many(
+            channel->alloc,
+            2,
+            &borrowed,
+            sizeof(struct borrowed_message),
+            &segments,
+            options->segment_count * sizeof(struct aws_byte_cursor))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*borrowed);
+    borrowed->release_allocator.mem_acquire = s_borrowed_message_mem_acquire;
+    borrowed->release_allocator.mem_release = s_borrowed_message_mem_release;
+    borrowed->release_allocator.impl = borrowed;
+    borrowed->alloc = channel->alloc;
+    borrowed->on_release = options->on_release;
+    borrowed->release_user_data = options->release_user_data;
+    borrowed->segments = segments;
+    borrowed->segment_count = options->segment_count;
+    for (size_t i = 0; i < options->segment_count; ++i) {
+        segments[i] = options->segments[i];
+    }
+
+    borrowed->message.allocator = &borrowed->release_allocator;
+    borrowed->message.message_type = AWS_IO_MESSAGE_BORROWED_DATA;
+    borrowed->message.owning_channel = channel;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: created borrowed message %p with %zu segments",
+        (void *)channel,
+        (void *)&borrowed->message,
+        options->segment_count);
+
+    return &borrowed->message;
+}
+
+size_t aws_io_message_get_borrowed_segments(
+    const struct aws_io_message *message,
+    const struct aws_byte_cursor **segments) {
+
+    if (message->message_type != AWS_IO_MESSAGE_BORROWED_DATA) {
+        *segments = NULL;
+        return 0;
+    }
+
+    const struct borrowed_message *borrowed = AWS_CONTAINER_OF(message, struct borrowed_message, message);
+    *segments = borrowed->segments;
+    return borrowed->segment_count;
+}
+
+struct aws_allocator *aws_channel_get_arena_allocator(struct aws_channel *channel) {
+    return channel->arena_end ? &channel->arena_allocator : channel->alloc;
+}
+
 struct aws_channel_slot *aws_channel_slot_new(struct aws_channel *channel) {
-    struct aws_channel_slot *new_slot = aws_mem_calloc(channel->alloc, 1, sizeof(struct aws_channel_slot));
+    struct aws_channel_slot *new_slot = NULL;
+    for (size_t i = 0; i < CHANNEL_INLINE_SLOT_COUNT; ++i) {
+        if (!(channel->inline_slots_in_use & (1u << i))) {
+            channel->inline_slots_in_use |= (uint8_t)(1u << i);
+            new_slot = &channel->inline_slots[i];
+            AWS_ZERO_STRUCT(*new_slot);
+            break;
+        }
+    }
+
+    struct aws_allocator *slot_alloc = aws_channel_get_arena_allocator(channel);
     if (!new_slot) {
-        return NULL;
+        new_slot = aws_mem_calloc(slot_alloc, 1, sizeof(struct aws_channel_slot));
+        if (!new_slot) {
+            return NULL;
+        }
     }
 
     AWS_LOGF_TRACE(AWS_LS_IO_CHANNEL, "id=%p: creating new slot %p.", (void *)channel, (void *)new_slot);
-    new_slot->alloc = channel->alloc;
+    new_slot->alloc = slot_alloc;
     new_slot->channel = channel;
 
     if (!channel->first) {
@@ -487,13 +920,64 @@ static void s_channel_task_run(struct aws_task *task, void *arg, enum aws_task_s
     struct aws_channel_task *channel_task = AWS_CONTAINER_OF(task, struct aws_channel_task, wrapper_task);
     struct aws_channel *channel = arg;
 
+    /* aws_channel_migrate() is taking the task off the old loop, it runs on the new one instead */
+    if (channel->migration && channel->migration->taking_tasks) {
+        aws_linked_list_remove(&channel_task->node);
+        aws_linked_list_push_back(&channel->migration->tasks, &channel_task->node);
+        return;
+    }
+
     /* Any task that runs after shutdown completes is considered canceled */
     if (channel->channel_state == AWS_CHANNEL_SHUT_DOWN) {
         status = AWS_TASK_STATUS_CANCELED;
     }
 
     aws_linked_list_remove(&channel_task->node);
+    aws_io_metrics_add(AWS_IO_METRIC_CHANNEL_TASKS_RUN, 1);
+
+    /* the task may destroy the channel, so the loop and the tag are read before running it */
+    struct aws_event_loop *loop = channel->loop;
+    const char *type_tag = channel_task->type_tag;
+    uint64_t start_ns = aws_event_loop_profiler_begin(loop);
     channel_task->task_fn(channel_task, channel_task->arg, status);
+    aws_event_loop_profiler_end(loop, type_tag, start_ns);
+}
+
+/* Releases a write that can't go any further, telling its writer. */
+static void s_fail_cross_thread_write(struct aws_channel *channel, struct aws_io_message *message, int error_code) {
+    if (message->on_completion) {
+        message->on_completion(channel, message, error_code, message->user_data);
+    }
+    aws_mem_release(message->allocator, message);
+}
+
+/* Hands writes from other threads to the channel, as though its last slot had sent them. */
+static void s_send_cross_thread_writes(
+    struct aws_channel *channel,
+    struct aws_linked_list *writes,
+    enum aws_task_status status) {
+
+    if (aws_linked_list_empty(writes)) {
+        return;
+    }
+
+    struct aws_channel_slot *last = channel->first;
+    while (last && last->adj_right) {
+        last = last->adj_right;
+    }
+
+    int error_code = AWS_IO_CHANNEL_ERROR_ERROR_CANT_ACCEPT_INPUT;
+    if (status == AWS_TASK_STATUS_RUN_READY && channel->channel_state == AWS_CHANNEL_ACTIVE && last && last->adj_left &&
+        last->adj_left->handler) {
+        if (aws_channel_slot_send_messages(last, writes, AWS_CHANNEL_DIR_WRITE)) {
+            error_code = aws_last_error();
+        }
+    }
+
+    while (!aws_linked_list_empty(writes)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(writes);
+        s_fail_cross_thread_write(channel, AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle), error_code);
+    }
 }
 
 static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum aws_task_status status) {
@@ -502,10 +986,26 @@ static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum
 
     struct aws_linked_list cross_thread_task_list;
     aws_linked_list_init(&cross_thread_task_list);
+    struct aws_linked_list cross_thread_writes;
+    aws_linked_list_init(&cross_thread_writes);
 
     /* Grab contents of cross-thread task list while we have the lock */
     aws_mutex_lock(&channel->cross_thread_tasks.lock);
+
+    /* The channel is moving to another loop, or has moved since this was scheduled. Its tasks are picked up there. */
+    if (channel->cross_thread_tasks.is_migrating) {
+        channel->cross_thread_tasks.schedule_after_migration = true;
+        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+        return;
+    }
+    if (!aws_event_loop_thread_is_callers_thread(channel->loop)) {
+        aws_event_loop_schedule_task_now(channel->loop, task);
+        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+        return;
+    }
+
     aws_linked_list_swap_contents(&channel->cross_thread_tasks.list, &cross_thread_task_list);
+    aws_linked_list_swap_contents(&channel->cross_thread_tasks.writes, &cross_thread_writes);
     aws_mutex_unlock(&channel->cross_thread_tasks.lock);
 
     /* If the channel has shut down since the cross-thread tasks were scheduled, run tasks immediately as canceled */
@@ -527,6 +1027,9 @@ static void s_schedule_cross_thread_tasks(struct aws_task *task, void *arg, enum
                 channel->loop, &channel_task->wrapper_task, channel_task->wrapper_task.timestamp);
         }
     }
+
+    /* after the tasks, which may be what set up the slots the writes go through */
+    s_send_cross_thread_writes(channel, &cross_thread_writes, status);
 }
 
 void aws_channel_task_init(
@@ -540,6 +1043,31 @@ void aws_channel_task_init(
     channel_task->type_tag = type_tag;
 }
 
+/* Hands a task to the channel's thread through cross_thread_tasks. */
+static void s_register_cross_thread_task(struct aws_channel *channel, struct aws_channel_task *channel_task) {
+    bool should_cancel_task = false;
+
+    /* Begin Critical Section */
+    aws_mutex_lock(&channel->cross_thread_tasks.lock);
+    if (channel->cross_thread_tasks.is_channel_shut_down) {
+        should_cancel_task = true; /* run task outside critical section to avoid deadlock */
+    } else {
+        bool list_was_empty = aws_linked_list_empty(&channel->cross_thread_tasks.list) &&
+                              aws_linked_list_empty(&channel->cross_thread_tasks.writes);
+        aws_linked_list_push_back(&channel->cross_thread_tasks.list, &channel_task->node);
+
+        if (list_was_empty) {
+            aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+        }
+    }
+    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+    /* End Critical Section */
+
+    if (should_cancel_task) {
+        channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+    }
+}
+
 /* Common functionality for scheduling "now" and "future" tasks.
  * For "now" tasks, pass 0 for `run_at_nanos` */
 static void s_register_pending_task(
@@ -587,26 +1115,7 @@ static void s_register_pending_task(
         (void *)channel,
         (void *)&channel_task->wrapper_task);
     /* Outside event-loop thread... */
-    bool should_cancel_task = false;
-
-    /* Begin Critical Section */
-    aws_mutex_lock(&channel->cross_thread_tasks.lock);
-    if (channel->cross_thread_tasks.is_channel_shut_down) {
-        should_cancel_task = true; /* run task outside critical section to avoid deadlock */
-    } else {
-        bool list_was_empty = aws_linked_list_empty(&channel->cross_thread_tasks.list);
-        aws_linked_list_push_back(&channel->cross_thread_tasks.list, &channel_task->node);
-
-        if (list_was_empty) {
-            aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
-        }
-    }
-    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
-    /* End Critical Section */
-
-    if (should_cancel_task) {
-        channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
-    }
+    s_register_cross_thread_task(channel, channel_task);
 }
 
 void aws_channel_schedule_task_now(struct aws_channel *channel, struct aws_channel_task *task) {
@@ -621,12 +1130,155 @@ void aws_channel_schedule_task_future(
     s_register_pending_task(channel, task, run_at_nanos);
 }
 
-bool aws_channel_thread_is_callers_thread(struct aws_channel *channel) {
-    return aws_event_loop_thread_is_callers_thread(channel->loop);
-}
+int aws_channel_write_from_any_thread(struct aws_channel *channel, struct aws_io_message *message) {
+    AWS_PRECONDITION(message);
 
-static void s_update_channel_slot_message_overheads(struct aws_channel *channel) {
-    size_t overhead = 0;
+    bool was_empty = false;
+
+    /* Begin Critical Section */
+    aws_mutex_lock(&channel->cross_thread_tasks.lock);
+    if (channel->cross_thread_tasks.is_channel_shut_down) {
+        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+        return aws_raise_error(AWS_IO_CHANNEL_ERROR_ERROR_CANT_ACCEPT_INPUT);
+    }
+
+    was_empty = aws_linked_list_empty(&channel->cross_thread_tasks.list) &&
+                aws_linked_list_empty(&channel->cross_thread_tasks.writes);
+    aws_linked_list_push_back(&channel->cross_thread_tasks.writes, &message->queueing_handle);
+    if (was_empty) {
+        aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+    }
+    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+    /* End Critical Section */
+
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        channel->trace_logging_enabled,
+        AWS_LS_IO_CHANNEL,
+        "id=%p: queued write of message %p from another thread%s.",
+        (void *)channel,
+        (void *)message,
+        was_empty ? ", waking the channel" : "");
+
+    return AWS_OP_SUCCESS;
+}
+
+/* The tasks of one aws_channel_schedule_task_batch_now() call headed for one event loop. */
+struct channel_task_batch {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *loop;
+    struct aws_task task;
+    /* struct aws_channel_task, linked through node, each with its channel as its wrapper task's arg */
+    struct aws_linked_list tasks;
+    struct aws_linked_list_node batch_node;
+};
+
+static void s_run_batched_channel_task(
+    struct aws_channel *channel,
+    struct aws_channel_task *channel_task,
+    enum aws_task_status status) {
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        /* the channel may have moved away since the batch was put together, or be moving right now */
+        aws_mutex_lock(&channel->cross_thread_tasks.lock);
+        bool run_here = !channel->cross_thread_tasks.is_migrating &&
+                        !channel->cross_thread_tasks.is_channel_shut_down &&
+                        aws_event_loop_thread_is_callers_thread(channel->loop);
+        aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+
+        if (!run_here) {
+            s_register_cross_thread_task(channel, channel_task);
+        } else if (channel->channel_state != AWS_CHANNEL_SHUT_DOWN) {
+            /* like the "now" tasks s_schedule_cross_thread_tasks() picks up, these run right away */
+            channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_RUN_READY);
+        } else {
+            channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+        }
+    } else {
+        channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+    }
+
+    /* taken when the task joined the batch */
+    aws_channel_release_hold(channel);
+}
+
+static void s_channel_task_batch_run(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct channel_task_batch *batch = arg;
+
+    while (!aws_linked_list_empty(&batch->tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&batch->tasks);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(node, struct aws_channel_task, node);
+        s_run_batched_channel_task(channel_task->wrapper_task.arg, channel_task, status);
+    }
+
+    aws_mem_release(batch->allocator, batch);
+}
+
+void aws_channel_schedule_task_batch_now(
+    struct aws_allocator *allocator,
+    const struct aws_channel_task_batch_entry *entries,
+    size_t count) {
+
+    /* one batch per event loop, there are only ever a handful of those */
+    struct aws_linked_list batches;
+    aws_linked_list_init(&batches);
+
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_channel *channel = entries[i].channel;
+        struct aws_channel_task *channel_task = entries[i].task;
+
+        if (aws_channel_thread_is_callers_thread(channel)) {
+            aws_channel_schedule_task_now(channel, channel_task);
+            continue;
+        }
+
+        struct aws_event_loop *loop = aws_channel_get_event_loop(channel);
+        struct channel_task_batch *batch = NULL;
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&batches);
+             node != aws_linked_list_end(&batches);
+             node = aws_linked_list_next(node)) {
+            struct channel_task_batch *candidate = AWS_CONTAINER_OF(node, struct channel_task_batch, batch_node);
+            if (candidate->loop == loop) {
+                batch = candidate;
+                break;
+            }
+        }
+
+        if (!batch) {
+            batch = aws_mem_calloc(allocator, 1, sizeof(struct channel_task_batch));
+            if (!batch) {
+                /* no batch to join, this one goes the usual way */
+                aws_channel_schedule_task_now(channel, channel_task);
+                continue;
+            }
+
+            batch->allocator = allocator;
+            batch->loop = loop;
+            aws_task_init(&batch->task, s_channel_task_batch_run, batch, "channel_task_batch");
+            aws_linked_list_init(&batch->tasks);
+            aws_linked_list_push_back(&batches, &batch->batch_node);
+        }
+
+        /* the batch isn't on the channel's cross-thread list, so nothing else keeps the channel around for it */
+        aws_channel_acquire_hold(channel);
+        aws_task_init(&channel_task->wrapper_task, s_channel_task_run, channel, channel_task->type_tag);
+        channel_task->wrapper_task.timestamp = 0;
+        aws_linked_list_push_back(&batch->tasks, &channel_task->node);
+    }
+
+    while (!aws_linked_list_empty(&batches)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&batches);
+        struct channel_task_batch *batch = AWS_CONTAINER_OF(node, struct channel_task_batch, batch_node);
+        aws_event_loop_schedule_task_now(batch->loop, &batch->task);
+    }
+}
+
+bool aws_channel_thread_is_callers_thread(struct aws_channel *channel) {
+    return aws_event_loop_thread_is_callers_thread(channel->loop);
+}
+
+static void s_update_channel_slot_message_overheads(struct aws_channel *channel) {
+    size_t overhead = 0;
     struct aws_channel_slot *slot_iter = channel->first;
     while (slot_iter) {
         slot_iter->upstream_message_overhead = overhead;
@@ -737,53 +1389,208 @@ int aws_channel_slot_insert_left(struct aws_channel_slot *slot, struct aws_chann
     return AWS_OP_SUCCESS;
 }
 
+/* The first slot right of slot that processes reads, skipping pass-through handlers, or NULL with an error raised if
+ * len bytes don't fit a window on the way. Pass-through slots are still subject to back pressure. */
+static struct aws_channel_slot *s_read_destination(struct aws_channel_slot *slot, size_t len) {
+    AWS_ASSERT(slot->adj_right);
+    AWS_ASSERT(slot->adj_right->handler);
+
+    struct aws_channel_slot *destination = slot->adj_right;
+    for (;;) {
+        if (slot->channel->read_back_pressure_enabled && destination->window_size < len) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: sending message of size %zu, "
+                "from slot %p to slot %p with handler %p, but this would exceed the channel's "
+                "read window, this is always a programming error.",
+                (void *)slot->channel,
+                len,
+                (void *)slot,
+                (void *)destination,
+                (void *)destination->handler);
+            aws_raise_error(AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW);
+            return NULL;
+        }
+
+        if (destination->handler->vtable->process_read_message || !destination->adj_right) {
+            return destination;
+        }
+        destination = destination->adj_right;
+        AWS_ASSERT(destination->handler);
+    }
+}
+
+/* charges len against the windows of every slot from slot->adj_right through destination */
+static void s_charge_read_windows(struct aws_channel_slot *slot, struct aws_channel_slot *destination, size_t len) {
+    for (struct aws_channel_slot *charged = slot->adj_right; charged != destination; charged = charged->adj_right) {
+        charged->window_size -= len;
+    }
+    destination->window_size -= len;
+}
+
+static struct aws_channel_slot *s_write_destination(struct aws_channel_slot *slot) {
+    AWS_ASSERT(slot->adj_left);
+    AWS_ASSERT(slot->adj_left->handler);
+
+    struct aws_channel_slot *destination = slot->adj_left;
+    while (!destination->handler->vtable->process_write_message && destination->adj_left) {
+        destination = destination->adj_left;
+        AWS_ASSERT(destination->handler);
+    }
+
+    return destination;
+}
+
 int aws_channel_slot_send_message(
     struct aws_channel_slot *slot,
     struct aws_io_message *message,
     enum aws_channel_direction dir) {
 
     if (dir == AWS_CHANNEL_DIR_READ) {
-        AWS_ASSERT(slot->adj_right);
-        AWS_ASSERT(slot->adj_right->handler);
-
-        if (!slot->channel->read_back_pressure_enabled || slot->adj_right->window_size >= message->message_data.len) {
-            AWS_LOGF_TRACE(
-                AWS_LS_IO_CHANNEL,
-                "id=%p: sending read message of size %zu, "
-                "from slot %p to slot %p with handler %p.",
-                (void *)slot->channel,
-                message->message_data.len,
-                (void *)slot,
-                (void *)slot->adj_right,
-                (void *)slot->adj_right->handler);
-            slot->adj_right->window_size -= message->message_data.len;
-            return aws_channel_handler_process_read_message(slot->adj_right->handler, slot->adj_right, message);
+        /* hand the message straight to the first slot that reads, skipping pass-through handlers. */
+        struct aws_channel_slot *destination = s_read_destination(slot, message->message_data.len);
+        if (!destination) {
+            return AWS_OP_ERR;
         }
-        AWS_LOGF_ERROR(
+
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            slot->channel->trace_logging_enabled,
             AWS_LS_IO_CHANNEL,
-            "id=%p: sending message of size %zu, "
-            "from slot %p to slot %p with handler %p, but this would exceed the channel's "
-            "read window, this is always a programming error.",
+            "id=%p: sending read message of size %zu, "
+            "from slot %p to slot %p with handler %p.",
             (void *)slot->channel,
             message->message_data.len,
             (void *)slot,
-            (void *)slot->adj_right,
-            (void *)slot->adj_right->handler);
-        return aws_raise_error(AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW);
+            (void *)destination,
+            (void *)destination->handler);
+
+        s_charge_read_windows(slot, destination, message->message_data.len);
+        return aws_channel_handler_process_read_message(destination->handler, destination, message);
     }
 
-    AWS_ASSERT(slot->adj_left);
-    AWS_ASSERT(slot->adj_left->handler);
-    AWS_LOGF_TRACE(
+    struct aws_channel_slot *destination = s_write_destination(slot);
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        slot->channel->trace_logging_enabled,
         AWS_LS_IO_CHANNEL,
         "id=%p: sending write message of size %zu, "
         "from slot %p to slot %p with handler %p.",
         (void *)slot->channel,
         message->message_data.len,
         (void *)slot,
-        (void *)slot->adj_left,
-        (void *)slot->adj_left->handler);
-    return aws_channel_handler_process_write_message(slot->adj_left->handler, slot->adj_left, message);
+        (void *)destination,
+        (void *)destination->handler);
+    return aws_channel_handler_process_write_message(destination->handler, destination, message);
+}
+
+int aws_channel_slot_send_messages(
+    struct aws_channel_slot *slot,
+    struct aws_linked_list *messages,
+    enum aws_channel_direction dir) {
+
+    if (aws_linked_list_empty(messages)) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (dir == AWS_CHANNEL_DIR_READ) {
+        size_t total_len = 0;
+        size_t message_count = 0;
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(messages); node != aws_linked_list_end(messages);
+             node = aws_linked_list_next(node)) {
+            total_len += AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle)->message_data.len;
+            ++message_count;
+        }
+
+        struct aws_channel_slot *destination = s_read_destination(slot, total_len);
+        if (!destination) {
+            return AWS_OP_ERR;
+        }
+
+        if (destination->handler->vtable->process_read_messages) {
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                slot->channel->trace_logging_enabled,
+                AWS_LS_IO_CHANNEL,
+                "id=%p: sending %zu read messages totalling %zu bytes, "
+                "from slot %p to slot %p with handler %p.",
+                (void *)slot->channel,
+                message_count,
+                total_len,
+                (void *)slot,
+                (void *)destination,
+                (void *)destination->handler);
+
+            s_charge_read_windows(slot, destination, total_len);
+            return destination->handler->vtable->process_read_messages(destination->handler, destination, messages);
+        }
+    } else {
+        struct aws_channel_slot *destination = s_write_destination(slot);
+        if (destination->handler->vtable->process_write_messages) {
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                slot->channel->trace_logging_enabled,
+                AWS_LS_IO_CHANNEL,
+                "id=%p: sending write messages from slot %p to slot %p with handler %p.",
+                (void *)slot->channel,
+                (void *)slot,
+                (void *)destination,
+                (void *)destination->handler);
+            return destination->handler->vtable->process_write_messages(destination->handler, destination, messages);
+        }
+    }
+
+    /* the handler takes them one at a time */
+    while (!aws_linked_list_empty(messages)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(messages);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        if (aws_channel_slot_send_message(slot, message, dir)) {
+            aws_linked_list_push_front(messages, node);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_channel_slot_acquire_read_buffer(
+    struct aws_channel_slot *slot,
+    size_t max_size,
+    struct aws_byte_buf *out_buffer) {
+    AWS_PRECONDITION(aws_channel_thread_is_callers_thread(slot->channel));
+
+    AWS_ZERO_STRUCT(*out_buffer);
+    struct aws_channel_slot *destination = s_read_destination(slot, 0);
+    if (!destination->handler->vtable->acquire_read_buffer) {
+        return;
+    }
+
+    destination->handler->vtable->acquire_read_buffer(destination->handler, destination, max_size, out_buffer);
+    AWS_ASSERT(out_buffer->capacity <= max_size);
+    out_buffer->len = 0;
+}
+
+int aws_channel_slot_read_buffer_filled(struct aws_channel_slot *slot, size_t bytes_read) {
+    AWS_PRECONDITION(aws_channel_thread_is_callers_thread(slot->channel));
+
+    struct aws_channel_slot *destination = s_read_destination(slot, bytes_read);
+    if (!destination) {
+        /* the provider still gets its buffer back, empty, or whatever it handed out is never released */
+        int error_code = aws_last_error();
+        struct aws_channel_slot *provider = s_read_destination(slot, 0);
+        AWS_ASSERT(provider->handler->vtable->read_buffer_filled);
+        provider->handler->vtable->read_buffer_filled(provider->handler, provider, 0);
+        return aws_raise_error(error_code);
+    }
+
+    AWS_ASSERT(destination->handler->vtable->read_buffer_filled);
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        slot->channel->trace_logging_enabled,
+        AWS_LS_IO_CHANNEL,
+        "id=%p: %zu bytes read straight into the buffer of slot %p with handler %p.",
+        (void *)slot->channel,
+        bytes_read,
+        (void *)destination,
+        (void *)destination->handler);
+
+    s_charge_read_windows(slot, destination, bytes_read);
+    return destination->handler->vtable->read_buffer_filled(destination->handler, destination, bytes_read);
 }
 
 struct aws_io_message *aws_channel_slot_acquire_max_message_for_write(struct aws_channel_slot *slot) {
@@ -808,6 +1615,10 @@ static void s_window_update_task(struct aws_channel_task *channel_task, void *ar
     struct aws_channel *channel = arg;
 
     if (status == AWS_TASK_STATUS_RUN_READY && channel->channel_state < AWS_CHANNEL_SHUTTING_DOWN) {
+        if (channel->window_update_min_interval_ns) {
+            aws_channel_current_clock_time(channel, &channel->last_window_update_ns);
+        }
+
         /* get the right-most slot to start the updates. */
         struct aws_channel_slot *slot = channel->first;
         while (slot->adj_right) {
@@ -845,10 +1656,21 @@ int aws_channel_slot_increment_read_window(struct aws_channel_slot *slot, size_t
 
         if (!slot->channel->window_update_in_progress &&
             slot->window_size <= slot->channel->window_update_batch_emit_threshold) {
-            slot->channel->window_update_in_progress = true;
-            aws_channel_task_init(
-                &slot->channel->window_update_task, s_window_update_task, slot->channel, "window update task");
-            aws_channel_schedule_task_now(slot->channel, &slot->channel->window_update_task);
+            struct aws_channel *channel = slot->channel;
+            channel->window_update_in_progress = true;
+            aws_channel_task_init(&channel->window_update_task, s_window_update_task, channel, "window update task");
+
+            /* too soon after the last update: let the increments that follow pile onto this one. */
+            uint64_t now_ns = 0;
+            if (channel->window_update_min_interval_ns && !aws_channel_current_clock_time(channel, &now_ns) &&
+                now_ns - channel->last_window_update_ns < channel->window_update_min_interval_ns) {
+                aws_channel_schedule_task_future(
+                    channel,
+                    &channel->window_update_task,
+                    channel->last_window_update_ns + channel->window_update_min_interval_ns);
+            } else {
+                aws_channel_schedule_task_now(channel, &channel->window_update_task);
+            }
         }
     }
 
@@ -895,7 +1717,8 @@ static void s_on_shutdown_completion_task(struct aws_task *task, void *arg, enum
 
     /* Cancel off-thread tasks, which haven't made it to the event-loop thread yet */
     aws_mutex_lock(&channel->cross_thread_tasks.lock);
-    bool cancel_cross_thread_tasks = !aws_linked_list_empty(&channel->cross_thread_tasks.list);
+    bool cancel_cross_thread_tasks = !aws_linked_list_empty(&channel->cross_thread_tasks.list) ||
+                                     !aws_linked_list_empty(&channel->cross_thread_tasks.writes);
     aws_mutex_unlock(&channel->cross_thread_tasks.lock);
 
     if (cancel_cross_thread_tasks) {
@@ -904,6 +1727,7 @@ static void s_on_shutdown_completion_task(struct aws_task *task, void *arg, enum
 
     AWS_ASSERT(aws_linked_list_empty(&channel->channel_thread_tasks.list));
     AWS_ASSERT(aws_linked_list_empty(&channel->cross_thread_tasks.list));
+    AWS_ASSERT(aws_linked_list_empty(&channel->cross_thread_tasks.writes));
 
     channel->on_shutdown_completed(channel, shutdown_notify->error_code, channel->shutdown_user_data);
 }
@@ -951,7 +1775,11 @@ int aws_channel_slot_on_handler_shutdown_complete(
         slot->channel->shutdown_notify_task.task.fn = s_run_shutdown_write_direction;
         slot->channel->shutdown_notify_task.task.arg = NULL;
 
-        aws_event_loop_schedule_task_now(slot->channel->loop, &slot->channel->shutdown_notify_task.task);
+        if (slot->channel->shutdown_batch) {
+            s_shutdown_batch_push(slot->channel);
+        } else {
+            aws_event_loop_schedule_task_now(slot->channel->loop, &slot->channel->shutdown_notify_task.task);
+        }
         return AWS_OP_SUCCESS;
     }
 
@@ -961,17 +1789,7 @@ int aws_channel_slot_on_handler_shutdown_complete(
     }
 
     if (slot->channel->first == slot) {
-        slot->channel->channel_state = AWS_CHANNEL_SHUT_DOWN;
-        aws_mutex_lock(&slot->channel->cross_thread_tasks.lock);
-        slot->channel->cross_thread_tasks.is_channel_shut_down = true;
-        aws_mutex_unlock(&slot->channel->cross_thread_tasks.lock);
-
-        if (slot->channel->on_shutdown_completed) {
-            slot->channel->shutdown_notify_task.task.fn = s_on_shutdown_completion_task;
-            slot->channel->shutdown_notify_task.task.arg = slot->channel;
-            slot->channel->shutdown_notify_task.error_code = err_code;
-            aws_event_loop_schedule_task_now(slot->channel->loop, &slot->channel->shutdown_notify_task.task);
-        }
+        s_on_channel_shut_down(slot->channel, err_code);
     }
 
     return AWS_OP_SUCCESS;
@@ -986,6 +1804,11 @@ size_t aws_channel_slot_upstream_message_overhead(struct aws_channel_slot *slot)
     return slot->upstream_message_overhead;
 }
 
+void aws_channel_update_message_overheads(struct aws_channel *channel) {
+    AWS_PRECONDITION(aws_channel_thread_is_callers_thread(channel));
+    s_update_channel_slot_message_overheads(channel);
+}
+
 void aws_channel_handler_destroy(struct aws_channel_handler *handler) {
     AWS_ASSERT(handler->vtable && handler->vtable->destroy);
     handler->vtable->destroy(handler);
@@ -1039,6 +1862,221 @@ struct aws_channel_slot *aws_channel_get_first_slot(struct aws_channel *channel)
     return channel->first;
 }
 
+void aws_channel_drain(struct aws_channel *channel) {
+    AWS_PRECONDITION(aws_channel_thread_is_callers_thread(channel));
+
+    if (channel->channel_state != AWS_CHANNEL_ACTIVE) {
+        return;
+    }
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL, "id=%p: draining channel.", (void *)channel);
+
+    struct aws_channel_slot *current_slot = channel->first;
+    while (current_slot && current_slot->adj_right) {
+        current_slot = current_slot->adj_right;
+    }
+
+    while (current_slot) {
+        /* look ahead, in case the handler removes its own slot. */
+        struct aws_channel_slot *next_slot = current_slot->adj_left;
+        struct aws_channel_handler *handler = current_slot->handler;
+        if (handler != NULL && handler->vtable->drain != NULL) {
+            handler->vtable->drain(handler, current_slot);
+        }
+        current_slot = next_slot;
+    }
+}
+
+/* Calls join_event_loop on the handlers from the first slot up to, not including, end. A handler failing to join
+ * shuts the channel down, the others still join so they can shut down properly. Returns the first error, or 0. */
+static int s_handlers_join_event_loop(struct aws_channel *channel, struct aws_channel_slot *end) {
+    int error_code = AWS_ERROR_SUCCESS;
+    for (struct aws_channel_slot *slot = channel->first; slot != end; slot = slot->adj_right) {
+        struct aws_channel_handler *handler = slot->handler;
+        if (handler != NULL && handler->vtable->join_event_loop != NULL &&
+            handler->vtable->join_event_loop(handler, slot)) {
+            int join_error = aws_last_error();
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL,
+                "id=%p: handler %p failed to join event loop %p with error %d (%s).",
+                (void *)channel,
+                (void *)handler,
+                (void *)channel->loop,
+                join_error,
+                aws_error_name(join_error));
+            if (!error_code) {
+                error_code = join_error;
+            }
+        }
+    }
+
+    if (error_code) {
+        aws_channel_shutdown(channel, error_code);
+    }
+    return error_code;
+}
+
+static void s_channel_migration_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct aws_channel *channel = arg;
+    struct channel_migration *migration = channel->migration;
+
+    /* from here on, new_loop's thread is the channel's */
+    aws_mutex_lock(&channel->cross_thread_tasks.lock);
+    channel->loop = migration->new_loop;
+    channel->cross_thread_tasks.is_migrating = false;
+    if (channel->cross_thread_tasks.schedule_after_migration) {
+        channel->cross_thread_tasks.schedule_after_migration = false;
+        aws_event_loop_schedule_task_now(channel->loop, &channel->cross_thread_tasks.scheduling_task);
+    }
+    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+
+    int error_code = AWS_ERROR_SUCCESS;
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        struct aws_message_pool *message_pool =
+            s_get_loop_message_pool(channel, channel->alloc, &g_aws_channel_message_pool_options);
+        if (message_pool) {
+            channel->msg_pool = message_pool;
+        } else {
+            error_code = aws_last_error();
+            aws_channel_shutdown(channel, error_code);
+        }
+
+        /* handlers might send messages as they join, so that waits for the pool */
+        if (!error_code) {
+            error_code = s_handlers_join_event_loop(channel, NULL);
+        }
+    } else {
+        error_code = AWS_IO_EVENT_LOOP_SHUTDOWN;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: arrived on event loop %p with error %d (%s).",
+        (void *)channel,
+        (void *)channel->loop,
+        error_code,
+        aws_error_name(error_code));
+
+    channel->migration = NULL;
+
+    while (!aws_linked_list_empty(&migration->tasks)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&migration->tasks);
+        struct aws_channel_task *channel_task = AWS_CONTAINER_OF(node, struct aws_channel_task, node);
+
+        if (status != AWS_TASK_STATUS_RUN_READY) {
+            channel_task->task_fn(channel_task, channel_task->arg, AWS_TASK_STATUS_CANCELED);
+            continue;
+        }
+
+        aws_linked_list_push_back(&channel->channel_thread_tasks.list, &channel_task->node);
+        if (channel_task->wrapper_task.timestamp == 0) {
+            aws_event_loop_schedule_task_now(channel->loop, &channel_task->wrapper_task);
+        } else {
+            aws_event_loop_schedule_task_future(
+                channel->loop, &channel_task->wrapper_task, channel_task->wrapper_task.timestamp);
+        }
+    }
+
+    if (migration->statistics_run_at_ns && status == AWS_TASK_STATUS_RUN_READY) {
+        aws_event_loop_schedule_task_future(channel->loop, &channel->statistics->task, migration->statistics_run_at_ns);
+    }
+
+    if (migration->on_migrated) {
+        migration->on_migrated(channel, error_code, migration->user_data);
+    }
+
+    aws_mem_release(channel->alloc, migration);
+    aws_channel_release_hold(channel);
+}
+
+int aws_channel_migrate(
+    struct aws_channel *channel,
+    struct aws_event_loop *new_loop,
+    aws_channel_on_migrated_fn *on_migrated,
+    void *user_data) {
+    AWS_FATAL_ASSERT(aws_channel_thread_is_callers_thread(channel));
+
+    if (new_loop == NULL || new_loop == channel->loop) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* a batch shutting the channel down is bound to the old loop */
+    if (channel->channel_state != AWS_CHANNEL_ACTIVE || channel->migration || channel->shutdown_batch) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_CHANNEL, "id=%p: only an active channel that isn't already moving can migrate.", (void *)channel);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct channel_migration *migration = aws_mem_calloc(channel->alloc, 1, sizeof(struct channel_migration));
+    if (!migration) {
+        return AWS_OP_ERR;
+    }
+
+    /* handlers let go of the loop before anything else moves, so one refusing leaves only those before it to undo */
+    struct aws_channel_slot *refused_slot = channel->first;
+    for (; refused_slot; refused_slot = refused_slot->adj_right) {
+        struct aws_channel_handler *handler = refused_slot->handler;
+        if (handler != NULL && handler->vtable->leave_event_loop != NULL &&
+            handler->vtable->leave_event_loop(handler, refused_slot)) {
+            break;
+        }
+    }
+
+    if (refused_slot) {
+        int error_code = aws_last_error();
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_CHANNEL,
+            "id=%p: handler %p refused to leave event loop %p with error %d (%s).",
+            (void *)channel,
+            (void *)refused_slot->handler,
+            (void *)channel->loop,
+            error_code,
+            aws_error_name(error_code));
+        s_handlers_join_event_loop(channel, refused_slot);
+        aws_mem_release(channel->alloc, migration);
+        return aws_raise_error(error_code);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL,
+        "id=%p: migrating from event loop %p to %p.",
+        (void *)channel,
+        (void *)channel->loop,
+        (void *)new_loop);
+
+    migration->new_loop = new_loop;
+    migration->on_migrated = on_migrated;
+    migration->user_data = user_data;
+    aws_linked_list_init(&migration->tasks);
+    aws_task_init(&migration->task, s_channel_migration_task, channel, "channel_migration");
+    channel->migration = migration;
+
+    aws_mutex_lock(&channel->cross_thread_tasks.lock);
+    channel->cross_thread_tasks.is_migrating = true;
+    aws_mutex_unlock(&channel->cross_thread_tasks.lock);
+
+    /* every task in the list is in the loop's scheduler, and canceling it hands it to the migration, see
+     * s_channel_task_run() */
+    migration->taking_tasks = true;
+    while (!aws_linked_list_empty(&channel->channel_thread_tasks.list)) {
+        struct aws_channel_task *channel_task =
+            AWS_CONTAINER_OF(aws_linked_list_front(&channel->channel_thread_tasks.list), struct aws_channel_task, node);
+        aws_event_loop_cancel_task(channel->loop, &channel_task->wrapper_task);
+    }
+    migration->taking_tasks = false;
+
+    if (channel->statistics && channel->statistics->handler) {
+        migration->statistics_run_at_ns = channel->statistics->task.timestamp;
+        aws_event_loop_cancel_task(channel->loop, &channel->statistics->task);
+    }
+
+    aws_channel_acquire_hold(channel);
+    aws_event_loop_schedule_task_now(new_loop, &migration->task);
+
+    return AWS_OP_SUCCESS;
+}
+
 static void s_reset_statistics(struct aws_channel *channel) {
     AWS_FATAL_ASSERT(aws_channel_thread_is_callers_thread(channel));
 
@@ -1058,7 +2096,8 @@ static void s_channel_gather_statistics_task(struct aws_task *task, void *arg, e
     }
 
     struct aws_channel *channel = arg;
-    if (channel->statistics_handler == NULL) {
+    struct channel_statistics *statistics = channel->statistics;
+    if (statistics->handler == NULL) {
         return;
     }
 
@@ -1073,7 +2112,7 @@ static void s_channel_gather_statistics_task(struct aws_task *task, void *arg, e
 
     uint64_t now_ms = aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
 
-    struct aws_array_list *statistics_list = &channel->statistic_list;
+    struct aws_array_list *statistics_list = &statistics->list;
     aws_array_list_clear(statistics_list);
 
     struct aws_channel_slot *current_slot = channel->first;
@@ -1086,35 +2125,65 @@ static void s_channel_gather_statistics_task(struct aws_task *task, void *arg, e
     }
 
     struct aws_crt_statistics_sample_interval sample_interval = {
-        .begin_time_ms = channel->statistics_interval_start_time_ms, .end_time_ms = now_ms};
+        .begin_time_ms = statistics->interval_start_time_ms, .end_time_ms = now_ms};
 
-    aws_crt_statistics_handler_process_statistics(
-        channel->statistics_handler, &sample_interval, statistics_list, channel);
+    aws_crt_statistics_handler_process_statistics(statistics->handler, &sample_interval, statistics_list, channel);
 
     s_reset_statistics(channel);
 
     uint64_t reschedule_interval_ns = aws_timestamp_convert(
-        aws_crt_statistics_handler_get_report_interval_ms(channel->statistics_handler),
+        aws_crt_statistics_handler_get_report_interval_ms(statistics->handler),
         AWS_TIMESTAMP_MILLIS,
         AWS_TIMESTAMP_NANOS,
         NULL);
 
     aws_event_loop_schedule_task_future(channel->loop, task, now_ns + reschedule_interval_ns);
 
-    channel->statistics_interval_start_time_ms = now_ms;
+    statistics->interval_start_time_ms = now_ms;
+}
+
+void aws_channel_set_window_update_policy(
+    struct aws_channel *channel,
+    size_t batch_emit_threshold,
+    uint64_t min_interval_us) {
+    AWS_FATAL_ASSERT(aws_channel_thread_is_callers_thread(channel));
+
+    if (batch_emit_threshold) {
+        channel->window_update_batch_emit_threshold = batch_emit_threshold;
+    }
+    channel->window_update_min_interval_ns =
+        aws_timestamp_convert(min_interval_us, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
 }
 
 int aws_channel_set_statistics_handler(struct aws_channel *channel, struct aws_crt_statistics_handler *handler) {
     AWS_FATAL_ASSERT(aws_channel_thread_is_callers_thread(channel));
 
-    if (channel->statistics_handler) {
-        aws_crt_statistics_handler_destroy(channel->statistics_handler);
-        aws_event_loop_cancel_task(channel->loop, &channel->statistics_task);
-        channel->statistics_handler = NULL;
+    struct channel_statistics *statistics = channel->statistics;
+    if (statistics && statistics->handler) {
+        aws_crt_statistics_handler_destroy(statistics->handler);
+        aws_event_loop_cancel_task(channel->loop, &statistics->task);
+        statistics->handler = NULL;
     }
 
     if (handler != NULL) {
-        aws_task_init(&channel->statistics_task, s_channel_gather_statistics_task, channel, "gather_statistics");
+        if (!statistics) {
+            statistics = aws_mem_calloc(channel->alloc, 1, sizeof(struct channel_statistics));
+            if (!statistics) {
+                return AWS_OP_ERR;
+            }
+
+            if (aws_array_list_init_dynamic(
+                    &statistics->list,
+                    channel->alloc,
+                    INITIAL_STATISTIC_LIST_SIZE,
+                    sizeof(struct aws_crt_statistics_base *))) {
+                aws_mem_release(channel->alloc, statistics);
+                return AWS_OP_ERR;
+            }
+            channel->statistics = statistics;
+        }
+
+        aws_task_init(&statistics->task, s_channel_gather_statistics_task, channel, "gather_statistics");
 
         uint64_t now_ns = 0;
         if (aws_channel_current_clock_time(channel, &now_ns)) {
@@ -1127,18 +2196,26 @@ int aws_channel_set_statistics_handler(struct aws_channel *channel, struct aws_c
                                                AWS_TIMESTAMP_NANOS,
                                                NULL);
 
-        channel->statistics_interval_start_time_ms =
+        statistics->interval_start_time_ms =
             aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL);
         s_reset_statistics(channel);
 
-        aws_event_loop_schedule_task_future(channel->loop, &channel->statistics_task, report_time_ns);
+        aws_event_loop_schedule_task_future(channel->loop, &statistics->task, report_time_ns);
+        statistics->handler = handler;
     }
 
-    channel->statistics_handler = handler;
-
     return AWS_OP_SUCCESS;
 }
 
+enum aws_channel_read_priority aws_channel_get_read_priority(const struct aws_channel *channel) {
+    return channel->read_priority;
+}
+
+void aws_channel_set_read_priority(struct aws_channel *channel, enum aws_channel_read_priority read_priority) {
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(channel));
+    channel->read_priority = read_priority;
+}
+
 struct aws_event_loop *aws_channel_get_event_loop(struct aws_channel *channel) {
     return channel->loop;
 }
@@ -4,12 +4,14 @@
  */
 #include <aws/io/channel_bootstrap.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/ref_count.h>
 #include <aws/common/string.h>
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 #include <aws/io/socket.h>
 #include <aws/io/socket_channel_handler.h>
+#include <aws/io/statistics.h>
 #include <aws/io/tls_channel_handler.h>
 
 #if _MSC_VER
@@ -22,6 +24,9 @@
 #endif
 
 #define DEFAULT_DNS_TTL 30
+#define DEFAULT_CONNECTION_ATTEMPT_DELAY_MS 250
+
+static void s_shut_down_warm_pools(struct aws_client_bootstrap *bootstrap);
 
 static void s_client_bootstrap_destroy_impl(struct aws_client_bootstrap *bootstrap) {
     AWS_ASSERT(bootstrap);
@@ -29,6 +34,14 @@ static void s_client_bootstrap_destroy_impl(struct aws_client_bootstrap *bootstr
     aws_client_bootstrap_shutdown_complete_fn *on_shutdown_complete = bootstrap->on_shutdown_complete;
     void *user_data = bootstrap->user_data;
 
+    s_shut_down_warm_pools(bootstrap);
+    aws_mutex_clean_up(&bootstrap->warm_pools_lock);
+
+    /* queued setups hold a reference to the bootstrap, so none can be left */
+    AWS_ASSERT(aws_linked_list_empty(&bootstrap->queued_connection_setups));
+    aws_hash_table_clean_up(&bootstrap->connection_setups_in_flight_per_host);
+    aws_mutex_clean_up(&bootstrap->setup_limit_lock);
+
     aws_event_loop_group_release(bootstrap->event_loop_group);
     aws_host_resolver_release(bootstrap->host_resolver);
 
@@ -80,6 +93,34 @@ struct aws_client_bootstrap *aws_client_bootstrap_new(
     bootstrap->host_resolver = aws_host_resolver_acquire(options->host_resolver);
     bootstrap->on_shutdown_complete = options->on_shutdown_complete;
     bootstrap->user_data = options->user_data;
+    bootstrap->connection_attempt_delay_ns = aws_timestamp_convert(
+        options->connection_attempt_delay_ms ? options->connection_attempt_delay_ms
+                                             : DEFAULT_CONNECTION_ATTEMPT_DELAY_MS,
+        AWS_TIMESTAMP_MILLIS,
+        AWS_TIMESTAMP_NANOS,
+        NULL);
+    aws_linked_list_init(&bootstrap->warm_pools);
+    aws_mutex_init(&bootstrap->warm_pools_lock);
+    bootstrap->max_connection_setups = options->max_connection_setups;
+    bootstrap->max_connection_setups_per_host = options->max_connection_setups_per_host;
+    aws_linked_list_init(&bootstrap->queued_connection_setups);
+    aws_mutex_init(&bootstrap->setup_limit_lock);
+
+    if (aws_hash_table_init(
+            &bootstrap->connection_setups_in_flight_per_host,
+            allocator,
+            8,
+            aws_hash_string,
+            aws_hash_callback_string_eq,
+            aws_hash_callback_string_destroy,
+            NULL)) {
+        aws_mutex_clean_up(&bootstrap->setup_limit_lock);
+        aws_mutex_clean_up(&bootstrap->warm_pools_lock);
+        aws_host_resolver_release(bootstrap->host_resolver);
+        aws_event_loop_group_release(bootstrap->event_loop_group);
+        aws_mem_release(allocator, bootstrap);
+        return NULL;
+    }
 
     if (options->host_resolution_config) {
         bootstrap->host_resolver_config = *options->host_resolution_config;
@@ -104,6 +145,43 @@ int aws_client_bootstrap_set_alpn_callback(
     return AWS_OP_SUCCESS;
 }
 
+void aws_client_bootstrap_set_tracer(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_connection_tracer *tracer) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: Setting connection tracer", (void *)bootstrap);
+    AWS_ZERO_STRUCT(bootstrap->tracer);
+    if (tracer) {
+        bootstrap->tracer = *tracer;
+    }
+}
+
+/* the only cost without a tracer is the branch on on_event, even the clock is only read with one. */
+static void s_trace_connection_event(
+    const struct aws_connection_tracer *tracer,
+    enum aws_connection_trace_event_type type,
+    const void *connection,
+    struct aws_channel *channel,
+    int error_code) {
+    if (!tracer->on_event) {
+        return;
+    }
+
+    struct aws_connection_trace_event event = {
+        .type = type,
+        .connection = connection,
+        .channel = channel,
+        .error_code = error_code,
+    };
+
+    if (channel) {
+        aws_channel_current_clock_time(channel, &event.timestamp_ns);
+    } else {
+        aws_high_res_clock_get_ticks(&event.timestamp_ns);
+    }
+
+    tracer->on_event(&event, tracer->user_data);
+}
+
 struct client_channel_data {
     struct aws_channel *channel;
     struct aws_socket *socket;
@@ -121,6 +199,7 @@ struct client_connection_args {
     aws_client_bootstrap_on_channel_event_fn *creation_callback;
     aws_client_bootstrap_on_channel_event_fn *setup_callback;
     aws_client_bootstrap_on_channel_event_fn *shutdown_callback;
+    aws_client_bootstrap_on_connection_timing_fn *timing_callback;
     struct client_channel_data channel_data;
     struct aws_socket_options outgoing_options;
     uint16_t outgoing_port;
@@ -131,6 +210,31 @@ struct client_connection_args {
     bool connection_chosen;
     bool setup_called;
     bool enable_read_back_pressure;
+    uint32_t idle_timeout_ms;
+    size_t write_coalescing_threshold;
+    size_t channel_arena_size;
+
+    /*
+     * Happy eyeballs (RFC 8305) state for connecting to a resolved host, only touched from connect_loop.
+     * Attempts are started one at a time, each one connection_attempt_delay after the previous one or as soon as
+     * the previous one fails. Once one connects, the rest are abandoned.
+     */
+    struct aws_event_loop *connect_loop;
+    /* struct connection_task_data, in the order they'll be attempted. Each holds a ref to these args. */
+    struct aws_linked_list pending_attempts;
+    /* struct aws_socket *, attempts still waiting on their connect. Each holds a ref to these args. */
+    struct aws_array_list connecting_sockets;
+    struct aws_task attempt_delay_task;
+    bool attempt_delay_task_scheduled;
+
+    /* connection setup limit state, see aws_client_bootstrap_options.max_connection_setups */
+    bool holds_setup_slot;
+    bool holds_host_setup_slot;
+    struct aws_linked_list_node queued_setup_node;
+    struct aws_task start_setup_task;
+
+    /* each phase is stamped by whichever thread runs it, and they run one after another */
+    struct aws_client_connection_timing timing;
 
     /*
      * It is likely that all reference adjustments to the connection args take place in a single event loop
@@ -149,9 +253,16 @@ static struct client_connection_args *s_client_connection_args_acquire(struct cl
     return args;
 }
 
+static void s_release_setup_slot(struct client_connection_args *args);
+
 static void s_client_connection_args_destroy(struct client_connection_args *args) {
     AWS_ASSERT(args);
 
+    /* setups that failed before their setup_callback could be called still hold their slot */
+    if (args->holds_setup_slot) {
+        s_release_setup_slot(args);
+    }
+
     struct aws_allocator *allocator = args->bootstrap->allocator;
     aws_client_bootstrap_release(args->bootstrap);
     if (args->host_name) {
@@ -162,6 +273,9 @@ static void s_client_connection_args_destroy(struct client_connection_args *args
         aws_tls_connection_options_clean_up(&args->channel_data.tls_options);
     }
 
+    AWS_ASSERT(aws_linked_list_empty(&args->pending_attempts));
+    aws_array_list_clean_up(&args->connecting_sockets);
+
     aws_mem_release(allocator, args);
 }
 
@@ -171,6 +285,152 @@ static void s_client_connection_args_release(struct client_connection_args *args
     }
 }
 
+static uint64_t s_timing_now_ns(void) {
+    uint64_t now_ns = 0;
+    aws_high_res_clock_get_ticks(&now_ns);
+    return now_ns;
+}
+
+static void s_trace_client_event(
+    struct client_connection_args *args,
+    enum aws_connection_trace_event_type type,
+    struct aws_channel *channel,
+    int error_code) {
+    s_trace_connection_event(&args->bootstrap->tracer, type, args, channel, error_code);
+}
+
+static void s_client_on_first_read(struct aws_channel_handler *handler, void *user_data) {
+    s_trace_client_event(user_data, AWS_CONNECTION_TRACE_FIRST_BYTE, handler->slot->channel, AWS_ERROR_SUCCESS);
+}
+
+static int s_start_connection_setup(struct client_connection_args *args);
+static void s_connection_args_setup_callback(
+    struct client_connection_args *args,
+    int error_code,
+    struct aws_channel *channel);
+
+/*
+ * Takes a setup slot for args if the bootstrap's limits have room for it. Called with setup_limit_lock held.
+ */
+static bool s_try_take_setup_slot(struct client_connection_args *args) {
+    struct aws_client_bootstrap *bootstrap = args->bootstrap;
+
+    if (bootstrap->max_connection_setups &&
+        bootstrap->connection_setups_in_flight >= bootstrap->max_connection_setups) {
+        return false;
+    }
+
+    if (bootstrap->max_connection_setups_per_host) {
+        struct aws_hash_element *element = NULL;
+        aws_hash_table_find(&bootstrap->connection_setups_in_flight_per_host, args->host_name, &element);
+        size_t host_in_flight = element ? (size_t)(uintptr_t)element->value : 0;
+        if (host_in_flight >= bootstrap->max_connection_setups_per_host) {
+            return false;
+        }
+
+        if (element) {
+            element->value = (void *)(uintptr_t)(host_in_flight + 1);
+            args->holds_host_setup_slot = true;
+        } else {
+            struct aws_string *host_name = aws_string_new_from_string(bootstrap->allocator, args->host_name);
+            if (host_name && !aws_hash_table_put(
+                                 &bootstrap->connection_setups_in_flight_per_host,
+                                 host_name,
+                                 (void *)(uintptr_t)1,
+                                 NULL)) {
+                args->holds_host_setup_slot = true;
+            } else {
+                /* if the host can't be tracked, the setup only counts against the bootstrap-wide limit */
+                aws_string_destroy(host_name);
+            }
+        }
+    }
+
+    bootstrap->connection_setups_in_flight++;
+    args->holds_setup_slot = true;
+    return true;
+}
+
+static void s_start_queued_setup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct client_connection_args *args = arg;
+
+    int error_code = AWS_IO_EVENT_LOOP_SHUTDOWN;
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        args->timing.started_ns = s_timing_now_ns();
+        if (!s_start_connection_setup(args)) {
+            return;
+        }
+        error_code = aws_last_error();
+    }
+
+    s_connection_args_setup_callback(args, error_code, NULL);
+}
+
+/*
+ * Returns args' setup slot and starts the oldest queued setups the freed room allows. Each starts from a task, so a
+ * run of failing setups doesn't recurse.
+ */
+static void s_release_setup_slot(struct client_connection_args *args) {
+    struct aws_client_bootstrap *bootstrap = args->bootstrap;
+
+    struct aws_linked_list to_start;
+    aws_linked_list_init(&to_start);
+
+    aws_mutex_lock(&bootstrap->setup_limit_lock);
+
+    bootstrap->connection_setups_in_flight--;
+    args->holds_setup_slot = false;
+
+    if (args->holds_host_setup_slot) {
+        struct aws_hash_element *element = NULL;
+        aws_hash_table_find(&bootstrap->connection_setups_in_flight_per_host, args->host_name, &element);
+        AWS_ASSERT(element);
+        size_t host_in_flight = (size_t)(uintptr_t)element->value - 1;
+        if (host_in_flight == 0) {
+            aws_hash_table_remove_element(&bootstrap->connection_setups_in_flight_per_host, element);
+        } else {
+            element->value = (void *)(uintptr_t)host_in_flight;
+        }
+        args->holds_host_setup_slot = false;
+    }
+
+    /* a queued setup whose host is at its limit doesn't hold up the ones behind it */
+    struct aws_linked_list_node *node = aws_linked_list_begin(&bootstrap->queued_connection_setups);
+    while (node != aws_linked_list_end(&bootstrap->queued_connection_setups)) {
+        if (bootstrap->max_connection_setups &&
+            bootstrap->connection_setups_in_flight >= bootstrap->max_connection_setups) {
+            break;
+        }
+
+        struct client_connection_args *queued =
+            AWS_CONTAINER_OF(node, struct client_connection_args, queued_setup_node);
+        node = aws_linked_list_next(node);
+
+        if (s_try_take_setup_slot(queued)) {
+            aws_linked_list_remove(&queued->queued_setup_node);
+            aws_linked_list_push_back(&to_start, &queued->queued_setup_node);
+        }
+    }
+
+    aws_mutex_unlock(&bootstrap->setup_limit_lock);
+
+    while (!aws_linked_list_empty(&to_start)) {
+        struct aws_linked_list_node *start_node = aws_linked_list_pop_front(&to_start);
+        struct client_connection_args *queued =
+            AWS_CONTAINER_OF(start_node, struct client_connection_args, queued_setup_node);
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: starting queued channel setup to %s",
+            (void *)bootstrap,
+            aws_string_c_str(queued->host_name));
+        aws_task_init(&queued->start_setup_task, s_start_queued_setup_task, queued, "start_queued_channel_setup");
+        aws_event_loop_schedule_task_now(
+            aws_event_loop_group_get_next_loop(bootstrap->event_loop_group), &queued->start_setup_task);
+    }
+}
+
 static void s_connection_args_setup_callback(
     struct client_connection_args *args,
     int error_code,
@@ -179,6 +439,22 @@ static void s_connection_args_setup_callback(
     AWS_ASSERT(!args->setup_called);
     if (!args->setup_called) {
         AWS_ASSERT((error_code == AWS_OP_SUCCESS) == (channel != NULL));
+        /* give up the slot first, so the next queued setup isn't held up by the user's callback */
+        if (args->holds_setup_slot) {
+            s_release_setup_slot(args);
+        }
+
+        args->timing.setup_complete_ns = s_timing_now_ns();
+        if (!error_code && args->timing.setup_complete_ns >= args->timing.requested_ns) {
+            aws_latency_histogram_record_ns(
+                aws_io_get_latency_histogram(AWS_IO_LATENCY_CHANNEL_SETUP),
+                args->timing.setup_complete_ns - args->timing.requested_ns);
+        }
+        s_trace_client_event(args, AWS_CONNECTION_TRACE_SETUP_COMPLETE, channel, error_code);
+        if (args->timing_callback) {
+            args->timing_callback(args->bootstrap, error_code, &args->timing, args->user_data);
+        }
+
         aws_client_bootstrap_on_channel_event_fn *setup_callback = args->setup_callback;
         setup_callback(args->bootstrap, error_code, channel, args->user_data);
         args->setup_called = true;
@@ -223,6 +499,8 @@ static void s_tls_client_on_negotiation_result(
     int err_code,
     void *user_data) {
     struct client_connection_args *connection_args = user_data;
+    connection_args->timing.tls_end_ns = s_timing_now_ns();
+    s_trace_client_event(connection_args, AWS_CONNECTION_TRACE_TLS_END, slot->channel, err_code);
 
     if (connection_args->channel_data.user_on_negotiation_result) {
         connection_args->channel_data.user_on_negotiation_result(
@@ -261,6 +539,16 @@ static void s_tls_client_on_data_read(
     }
 }
 
+/* the TLS handler installs the bootstrap's ALPN handler itself, so no ALPN slot or message is needed */
+static struct aws_channel_handler *s_tls_client_on_protocol_negotiated(
+    struct aws_channel_slot *new_slot,
+    struct aws_byte_buf *protocol,
+    void *user_data) {
+    struct client_connection_args *connection_args = user_data;
+
+    return connection_args->channel_data.on_protocol_negotiated(new_slot, protocol, connection_args->user_data);
+}
+
 /* in the context of a channel bootstrap, we don't care about these, but since we're hooking into these APIs we have to
  * provide a proxy for the user actually receiving their callbacks. */
 static void s_tls_client_on_error(
@@ -287,10 +575,10 @@ static inline int s_setup_client_tls(struct client_connection_args *connection_a
     }
 
     struct aws_channel_handler *tls_handler = aws_tls_client_handler_new(
-        connection_args->bootstrap->allocator, &connection_args->channel_data.tls_options, tls_slot);
+        aws_channel_get_arena_allocator(channel), &connection_args->channel_data.tls_options, tls_slot);
 
     if (!tls_handler) {
-        aws_mem_release(connection_args->bootstrap->allocator, (void *)tls_slot);
+        aws_channel_slot_remove(tls_slot);
         return AWS_OP_ERR;
     }
 
@@ -307,38 +595,8 @@ static inline int s_setup_client_tls(struct client_connection_args *connection_a
         return AWS_OP_ERR;
     }
 
-    if (connection_args->channel_data.on_protocol_negotiated) {
-        struct aws_channel_slot *alpn_slot = aws_channel_slot_new(channel);
-
-        if (!alpn_slot) {
-            return AWS_OP_ERR;
-        }
-
-        struct aws_channel_handler *alpn_handler = aws_tls_alpn_handler_new(
-            connection_args->bootstrap->allocator,
-            connection_args->channel_data.on_protocol_negotiated,
-            connection_args->user_data);
-
-        if (!alpn_handler) {
-            aws_mem_release(connection_args->bootstrap->allocator, (void *)alpn_slot);
-            return AWS_OP_ERR;
-        }
-
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_CHANNEL_BOOTSTRAP,
-            "id=%p: Setting up ALPN handler on channel "
-            "%p with handler %p on slot %p",
-            (void *)connection_args->bootstrap,
-            (void *)channel,
-            (void *)alpn_handler,
-            (void *)alpn_slot);
-
-        aws_channel_slot_insert_right(tls_slot, alpn_slot);
-        if (aws_channel_slot_set_handler(alpn_slot, alpn_handler) != AWS_OP_SUCCESS) {
-            return AWS_OP_ERR;
-        }
-    }
-
+    connection_args->timing.tls_start_ns = s_timing_now_ns();
+    s_trace_client_event(connection_args, AWS_CONNECTION_TRACE_TLS_START, channel, AWS_ERROR_SUCCESS);
     if (aws_tls_client_handler_start_negotiation(tls_handler) != AWS_OP_SUCCESS) {
         return AWS_OP_ERR;
     }
@@ -365,7 +623,7 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
         }
 
         struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
-            connection_args->bootstrap->allocator,
+            aws_channel_get_arena_allocator(channel),
             connection_args->channel_data.socket,
             socket_slot,
             g_aws_channel_max_fragment_size);
@@ -391,6 +649,16 @@ static void s_on_client_channel_on_setup_completed(struct aws_channel *channel,
             goto error;
         }
 
+        if (aws_socket_handler_set_idle_timeout(socket_channel_handler, connection_args->idle_timeout_ms)) {
+            err_code = aws_last_error();
+            goto error;
+        }
+
+        aws_socket_handler_set_write_coalescing(socket_channel_handler, connection_args->write_coalescing_threshold);
+        if (connection_args->bootstrap->tracer.on_event) {
+            aws_socket_handler_set_on_first_read(socket_channel_handler, s_client_on_first_read, connection_args);
+        }
+
         if (connection_args->channel_data.use_tls) {
             /* we don't want to notify the user that the channel is ready yet, since tls is still negotiating, wait
              * for the negotiation callback and handle it then.*/
@@ -428,7 +696,9 @@ static void s_on_client_channel_on_shutdown(struct aws_channel *channel, int err
 
     /* note it's not safe to reference the bootstrap after the callback. */
     struct aws_allocator *allocator = connection_args->bootstrap->allocator;
+    struct aws_connection_tracer tracer = connection_args->bootstrap->tracer;
     s_connection_args_shutdown_callback(connection_args, error_code, channel);
+    s_trace_connection_event(&tracer, AWS_CONNECTION_TRACE_CLOSE, connection_args, channel, error_code);
 
     aws_channel_destroy(channel);
     aws_socket_clean_up(connection_args->channel_data.socket);
@@ -440,6 +710,134 @@ static bool s_aws_socket_domain_uses_dns(enum aws_socket_domain domain) {
     return domain == AWS_SOCKET_IPV4 || domain == AWS_SOCKET_IPV6;
 }
 
+struct connection_task_data {
+    struct aws_task task;
+    struct aws_linked_list_node node;
+    struct aws_socket_endpoint endpoint;
+    struct aws_socket_options options;
+    struct aws_host_address host_address;
+    struct client_connection_args *args;
+    struct aws_event_loop *connect_loop;
+};
+
+static void s_attempt_connection(struct aws_task *task, void *arg, enum aws_task_status status);
+
+static void s_record_connect_attempt(struct client_connection_args *args) {
+    if (args->timing.connect_attempt_count++ == 0) {
+        args->timing.first_connect_start_ns = s_timing_now_ns();
+    }
+    s_trace_client_event(args, AWS_CONNECTION_TRACE_CONNECT_START, NULL, AWS_ERROR_SUCCESS);
+}
+
+static void s_on_connection_attempt_delay(struct aws_task *task, void *arg, enum aws_task_status status);
+
+static void s_schedule_connection_attempt_delay(struct client_connection_args *args, uint64_t delay_ns) {
+    AWS_ASSERT(!args->attempt_delay_task_scheduled);
+
+    uint64_t now = 0;
+    aws_event_loop_current_clock_time(args->connect_loop, &now);
+
+    args->attempt_delay_task_scheduled = true;
+    s_client_connection_args_acquire(args);
+    aws_task_init(&args->attempt_delay_task, s_on_connection_attempt_delay, args, "connection_attempt_delay");
+    aws_event_loop_schedule_task_future(args->connect_loop, &args->attempt_delay_task, now + delay_ns);
+}
+
+/*
+ * Kicks off the next pending attempt. When called because an attempt failed, a delay timer that's already running is
+ * left alone, so the attempt after this one may follow a little sooner than the full delay.
+ */
+static void s_start_next_connection_attempt(struct client_connection_args *args) {
+    if (aws_linked_list_empty(&args->pending_attempts)) {
+        return;
+    }
+
+    struct aws_linked_list_node *node = aws_linked_list_pop_front(&args->pending_attempts);
+    struct connection_task_data *task_data = AWS_CONTAINER_OF(node, struct connection_task_data, node);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: starting connection attempt to %s",
+        (void *)args->bootstrap,
+        task_data->endpoint.address);
+
+    aws_task_init(&task_data->task, s_attempt_connection, task_data, "attempt_connection");
+    aws_event_loop_schedule_task_now(args->connect_loop, &task_data->task);
+
+    if (!aws_linked_list_empty(&args->pending_attempts) && !args->attempt_delay_task_scheduled) {
+        s_schedule_connection_attempt_delay(args, args->bootstrap->connection_attempt_delay_ns);
+    }
+}
+
+static void s_on_connection_attempt_delay(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct client_connection_args *args = arg;
+    args->attempt_delay_task_scheduled = false;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        if (!args->connection_chosen) {
+            s_start_next_connection_attempt(args);
+        }
+    } else {
+        /* the event loop is shutting down, attempts that never started count as failures. If a connection was
+         * chosen, this task was cancelled after the pending attempts were already dropped. */
+        while (!aws_linked_list_empty(&args->pending_attempts)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&args->pending_attempts);
+            struct connection_task_data *task_data = AWS_CONTAINER_OF(node, struct connection_task_data, node);
+            s_attempt_connection(&task_data->task, task_data, AWS_TASK_STATUS_CANCELED);
+        }
+    }
+
+    s_client_connection_args_release(args);
+}
+
+static void s_untrack_connecting_socket(struct client_connection_args *args, struct aws_socket *socket) {
+    size_t count = aws_array_list_length(&args->connecting_sockets);
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_socket *connecting = NULL;
+        aws_array_list_get_at(&args->connecting_sockets, &connecting, i);
+        if (connecting == socket) {
+            aws_array_list_swap(&args->connecting_sockets, i, count - 1);
+            aws_array_list_pop_back(&args->connecting_sockets);
+            return;
+        }
+    }
+}
+
+/* a connection won, drop the attempts that haven't started and close the ones still connecting. */
+static void s_abandon_connection_attempts(struct client_connection_args *args) {
+    struct aws_allocator *allocator = args->bootstrap->allocator;
+
+    while (!aws_linked_list_empty(&args->pending_attempts)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&args->pending_attempts);
+        struct connection_task_data *task_data = AWS_CONTAINER_OF(node, struct connection_task_data, node);
+        aws_host_address_clean_up(&task_data->host_address);
+        aws_mem_release(allocator, task_data);
+        s_client_connection_args_release(args);
+    }
+
+    /* closing a socket mid-connect means its connect callback never fires, so release its ref here */
+    while (aws_array_list_length(&args->connecting_sockets) > 0) {
+        struct aws_socket *socket = NULL;
+        aws_array_list_back(&args->connecting_sockets, &socket);
+        aws_array_list_pop_back(&args->connecting_sockets);
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: abandoning slower connection attempt on socket %p",
+            (void *)args->bootstrap,
+            (void *)socket);
+        aws_socket_close(socket);
+        aws_socket_clean_up(socket);
+        aws_mem_release(allocator, socket);
+        s_client_connection_args_release(args);
+    }
+
+    if (args->attempt_delay_task_scheduled) {
+        aws_event_loop_cancel_task(args->connect_loop, &args->attempt_delay_task);
+    }
+}
+
 static void s_on_client_connection_established(struct aws_socket *socket, int error_code, void *user_data) {
     struct client_connection_args *connection_args = user_data;
 
@@ -450,6 +848,9 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
         (void *)socket,
         error_code);
 
+    s_untrack_connecting_socket(connection_args, socket);
+    s_trace_client_event(connection_args, AWS_CONNECTION_TRACE_CONNECT_END, NULL, error_code);
+
     if (error_code) {
         connection_args->failed_count++;
     }
@@ -495,6 +896,9 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
                 error_code);
             /* connection_args will be released after setup_callback */
             s_connection_args_setup_callback(connection_args, error_code, NULL);
+        } else if (error_code && !connection_args->connection_chosen) {
+            /* don't wait out the attempt delay when we already know this path is broken */
+            s_start_next_connection_attempt(connection_args);
         }
 
         /* every connection task adds a ref, so every failure or cancel needs to dec one */
@@ -504,6 +908,7 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
 
     connection_args->connection_chosen = true;
     connection_args->channel_data.socket = socket;
+    connection_args->timing.connected_ns = s_timing_now_ns();
 
     struct aws_channel_options args = {
         .on_setup_completed = s_on_client_channel_on_setup_completed,
@@ -513,6 +918,7 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
     };
 
     args.enable_read_back_pressure = connection_args->enable_read_back_pressure;
+    args.arena_size = connection_args->channel_arena_size;
     args.event_loop = aws_socket_get_event_loop(socket);
 
     AWS_LOGF_TRACE(
@@ -524,35 +930,42 @@ static void s_on_client_connection_established(struct aws_socket *socket, int er
     connection_args->channel_data.channel = aws_channel_new(connection_args->bootstrap->allocator, &args);
 
     if (!connection_args->channel_data.channel) {
+        int channel_err_code = aws_last_error();
+        aws_socket_close(socket);
         aws_socket_clean_up(socket);
         aws_mem_release(connection_args->bootstrap->allocator, connection_args->channel_data.socket);
+        connection_args->channel_data.socket = NULL;
+        connection_args->connection_chosen = false;
         connection_args->failed_count++;
 
         /* if this is the last attempted connection and it failed, notify the user */
         if (connection_args->failed_count == connection_args->addresses_count) {
-            s_connection_args_setup_callback(connection_args, error_code, NULL);
+            s_connection_args_setup_callback(connection_args, channel_err_code, NULL);
+        } else {
+            s_start_next_connection_attempt(connection_args);
         }
+
+        s_client_connection_args_release(connection_args);
     } else {
+        s_abandon_connection_attempts(connection_args);
         s_connection_args_creation_callback(connection_args, connection_args->channel_data.channel);
     }
 }
 
-struct connection_task_data {
-    struct aws_task task;
-    struct aws_socket_endpoint endpoint;
-    struct aws_socket_options options;
-    struct aws_host_address host_address;
-    struct client_connection_args *args;
-    struct aws_event_loop *connect_loop;
-};
-
 static void s_attempt_connection(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)task;
     struct connection_task_data *task_data = arg;
     struct aws_allocator *allocator = task_data->args->bootstrap->allocator;
     int err_code = 0;
 
+    if (task_data->args->connection_chosen) {
+        /* another attempt won while this one was queued */
+        s_client_connection_args_release(task_data->args);
+        goto cleanup_task;
+    }
+
     if (status != AWS_TASK_STATUS_RUN_READY) {
+        err_code = AWS_IO_EVENT_LOOP_SHUTDOWN;
         goto task_cancelled;
     }
 
@@ -565,6 +978,8 @@ static void s_attempt_connection(struct aws_task *task, void *arg, enum aws_task
         goto socket_init_failed;
     }
 
+    s_record_connect_attempt(task_data->args);
+
     if (aws_socket_connect(
             outgoing_socket,
             &task_data->endpoint,
@@ -575,6 +990,9 @@ static void s_attempt_connection(struct aws_task *task, void *arg, enum aws_task
         goto socket_connect_failed;
     }
 
+    /* capacity for every address was reserved up front, so this can't fail */
+    aws_array_list_push_back(&task_data->args->connecting_sockets, &outgoing_socket);
+
     goto cleanup_task;
 
 socket_connect_failed:
@@ -594,6 +1012,8 @@ task_cancelled:
     /* if this is the last attempted connection and it failed, notify the user */
     if (task_data->args->failed_count == task_data->args->addresses_count) {
         s_connection_args_setup_callback(task_data->args, err_code, NULL);
+    } else if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_start_next_connection_attempt(task_data->args);
     }
     s_client_connection_args_release(task_data->args);
 
@@ -613,6 +1033,8 @@ static void s_on_host_resolved(
 
     struct client_connection_args *client_connection_args = user_data;
     struct aws_allocator *allocator = client_connection_args->bootstrap->allocator;
+    client_connection_args->timing.dns_end_ns = s_timing_now_ns();
+    s_trace_client_event(client_connection_args, AWS_CONNECTION_TRACE_DNS_END, NULL, err_code);
 
     if (err_code) {
         AWS_LOGF_ERROR(
@@ -627,15 +1049,21 @@ static void s_on_host_resolved(
     AWS_FATAL_ASSERT(host_addresses_len > 0);
     AWS_LOGF_TRACE(
         AWS_LS_IO_CHANNEL_BOOTSTRAP,
-        "id=%p: dns resolution completed. Kicking off connections"
+        "id=%p: dns resolution completed. Racing connections"
         " on %llu addresses. First one back wins.",
         (void *)client_connection_args->bootstrap,
         (unsigned long long)host_addresses_len);
-    /* use this event loop for all outgoing connection attempts (only one will ultimately win). */
-    struct aws_event_loop *connect_loop =
-        aws_event_loop_group_get_next_loop(client_connection_args->bootstrap->event_loop_group);
+    /* the resolver answers on connect_loop, which every outgoing connection attempt uses (only one will win). */
+    struct aws_event_loop *connect_loop = client_connection_args->connect_loop;
     client_connection_args->addresses_count = (uint8_t)host_addresses_len;
 
+    if (aws_array_list_init_dynamic(
+            &client_connection_args->connecting_sockets, allocator, host_addresses_len, sizeof(struct aws_socket *))) {
+        int alloc_err_code = aws_last_error();
+        s_connection_args_setup_callback(client_connection_args, alloc_err_code, NULL);
+        return;
+    }
+
     /* allocate all the task data first, in case it fails... */
     AWS_VARIABLE_LENGTH_ARRAY(struct connection_task_data *, tasks, host_addresses_len);
     for (size_t i = 0; i < host_addresses_len; ++i) {
@@ -681,15 +1109,564 @@ static void s_on_host_resolved(
         }
     }
 
-    /* ...then schedule all the tasks, which cannot fail */
-    for (size_t i = 0; i < host_addresses_len; ++i) {
-        struct connection_task_data *task_data = tasks[i];
-        /* each task needs to hold a ref to the args until completed */
-        s_client_connection_args_acquire(task_data->args);
-
-        aws_task_init(&task_data->task, s_attempt_connection, task_data, "attempt_connection");
-        aws_event_loop_schedule_task_now(connect_loop, &task_data->task);
-    }
+    /* ...then queue them up, which cannot fail. Families are interleaved, IPv6 first, so a broken route for one family
+     * only costs an attempt delay rather than a connect timeout per address (RFC 8305 section 4). */
+    struct aws_linked_list ipv6_attempts;
+    struct aws_linked_list ipv4_attempts;
+    aws_linked_list_init(&ipv6_attempts);
+    aws_linked_list_init(&ipv4_attempts);
+
+    for (size_t i = 0; i < host_addresses_len; ++i) {
+        struct connection_task_data *task_data = tasks[i];
+        /* each task needs to hold a ref to the args until completed */
+        s_client_connection_args_acquire(task_data->args);
+
+        if (task_data->options.domain == AWS_SOCKET_IPV6) {
+            aws_linked_list_push_back(&ipv6_attempts, &task_data->node);
+        } else {
+            aws_linked_list_push_back(&ipv4_attempts, &task_data->node);
+        }
+    }
+
+    while (!aws_linked_list_empty(&ipv6_attempts) || !aws_linked_list_empty(&ipv4_attempts)) {
+        if (!aws_linked_list_empty(&ipv6_attempts)) {
+            aws_linked_list_push_back(
+                &client_connection_args->pending_attempts, aws_linked_list_pop_front(&ipv6_attempts));
+        }
+        if (!aws_linked_list_empty(&ipv4_attempts)) {
+            aws_linked_list_push_back(
+                &client_connection_args->pending_attempts, aws_linked_list_pop_front(&ipv4_attempts));
+        }
+    }
+
+    /* from here on the attempts are only touched from connect_loop, starting with the first one right away */
+    s_schedule_connection_attempt_delay(client_connection_args, 0);
+}
+
+/*
+ * A warm pool keeps connected sockets to one endpoint in standby. The bootstrap holds one reference, and so does every
+ * connection attempt in flight, so attempts finishing after the bootstrap is gone just close their socket.
+ */
+struct client_warm_pool {
+    struct aws_linked_list_node node;
+    struct aws_allocator *allocator;
+    struct aws_event_loop_group *event_loop_group;
+    struct aws_host_resolver *host_resolver;
+    struct aws_host_resolution_config host_resolution_config;
+    struct aws_string *host_name;
+    uint16_t port;
+    struct aws_socket_options socket_options;
+    size_t size;
+    uint64_t max_idle_ns;
+    struct aws_ref_count ref_count;
+
+    struct aws_mutex lock;
+    struct {
+        /* struct warm_socket, oldest first */
+        struct aws_linked_list standby;
+        size_t standby_count;
+        size_t connecting_count;
+        bool shut_down;
+    } synced_data;
+};
+
+struct warm_socket {
+    struct aws_linked_list_node node;
+    struct aws_task task;
+    struct aws_allocator *allocator;
+    struct aws_socket *socket;
+    /* only valid while connecting, when the attempt holds a pool ref. Close tasks can outlive the pool. */
+    struct client_warm_pool *pool;
+    uint64_t connected_at;
+};
+
+struct warm_socket_handoff {
+    struct aws_task task;
+    struct aws_socket *socket;
+    struct client_connection_args *args;
+};
+
+static void s_warm_pool_destroy(struct client_warm_pool *pool) {
+    AWS_ASSERT(aws_linked_list_empty(&pool->synced_data.standby));
+    aws_event_loop_group_release(pool->event_loop_group);
+    aws_host_resolver_release(pool->host_resolver);
+    aws_string_destroy(pool->host_name);
+    aws_mutex_clean_up(&pool->lock);
+    aws_mem_release(pool->allocator, pool);
+}
+
+static void s_warm_socket_destroy(struct warm_socket *warm_socket) {
+    struct aws_allocator *allocator = warm_socket->allocator;
+    if (warm_socket->socket) {
+        aws_socket_clean_up(warm_socket->socket);
+        aws_mem_release(allocator, warm_socket->socket);
+    }
+    aws_mem_release(allocator, warm_socket);
+}
+
+/* standby sockets may only be closed on their own event loop. */
+static void s_warm_socket_close_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct warm_socket *warm_socket = arg;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_socket_close(warm_socket->socket);
+    }
+
+    s_warm_socket_destroy(warm_socket);
+}
+
+static void s_schedule_warm_socket_close(struct warm_socket *warm_socket) {
+    aws_task_init(&warm_socket->task, s_warm_socket_close_task, warm_socket, "warm_socket_close");
+    aws_event_loop_schedule_task_now(aws_socket_get_event_loop(warm_socket->socket), &warm_socket->task);
+}
+
+static void s_warm_pool_on_attempt_finished(struct client_warm_pool *pool, struct warm_socket *connected) {
+    bool shut_down = false;
+
+    aws_mutex_lock(&pool->lock);
+    pool->synced_data.connecting_count--;
+    shut_down = pool->synced_data.shut_down;
+    if (connected && !shut_down) {
+        aws_linked_list_push_back(&pool->synced_data.standby, &connected->node);
+        pool->synced_data.standby_count++;
+    }
+    aws_mutex_unlock(&pool->lock);
+
+    if (connected && shut_down) {
+        /* we're on the socket's event loop, in its connect callback */
+        aws_socket_close(connected->socket);
+        s_warm_socket_destroy(connected);
+    }
+
+    aws_ref_count_release(&pool->ref_count);
+}
+
+static void s_warm_socket_on_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    struct warm_socket *warm_socket = user_data;
+    struct client_warm_pool *pool = warm_socket->pool;
+
+    if (error_code) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: warm pool connection to %s:%d failed with error %d.",
+            (void *)pool,
+            aws_string_c_str(pool->host_name),
+            (int)pool->port,
+            error_code);
+
+        struct aws_host_address host_address;
+        AWS_ZERO_STRUCT(host_address);
+        host_address.host = pool->host_name;
+        host_address.address = aws_string_new_from_c_str(pool->allocator, socket->remote_endpoint.address);
+        host_address.record_type = socket->options.domain == AWS_SOCKET_IPV6 ? AWS_ADDRESS_RECORD_TYPE_AAAA
+                                                                             : AWS_ADDRESS_RECORD_TYPE_A;
+        if (host_address.address) {
+            aws_host_resolver_record_connection_failure(pool->host_resolver, &host_address);
+            aws_string_destroy((void *)host_address.address);
+        }
+
+        aws_socket_close(socket);
+        s_warm_socket_destroy(warm_socket);
+        s_warm_pool_on_attempt_finished(pool, NULL);
+        return;
+    }
+
+    aws_high_res_clock_get_ticks(&warm_socket->connected_at);
+    s_warm_pool_on_attempt_finished(pool, warm_socket);
+}
+
+static void s_warm_pool_on_host_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+    (void)resolver;
+    (void)host_name;
+
+    struct client_warm_pool *pool = user_data;
+    struct warm_socket *warm_socket = NULL;
+    struct aws_host_address *host_address = NULL;
+
+    if (err_code) {
+        goto error;
+    }
+
+    aws_array_list_get_at_ptr(host_addresses, (void **)&host_address, 0);
+
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    endpoint.port = pool->port;
+    AWS_ASSERT(sizeof(endpoint.address) >= host_address->address->len + 1);
+    memcpy(endpoint.address, aws_string_bytes(host_address->address), host_address->address->len);
+
+    struct aws_socket_options options = pool->socket_options;
+    options.domain = host_address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? AWS_SOCKET_IPV6 : AWS_SOCKET_IPV4;
+
+    warm_socket = aws_mem_calloc(pool->allocator, 1, sizeof(struct warm_socket));
+    if (!warm_socket) {
+        goto error;
+    }
+    warm_socket->allocator = pool->allocator;
+    warm_socket->pool = pool;
+
+    struct aws_socket *socket = aws_mem_calloc(pool->allocator, 1, sizeof(struct aws_socket));
+    if (!socket) {
+        goto error;
+    }
+
+    if (aws_socket_init(socket, pool->allocator, &options)) {
+        aws_mem_release(pool->allocator, socket);
+        goto error;
+    }
+    warm_socket->socket = socket;
+
+    struct aws_event_loop *connect_loop = aws_event_loop_group_get_next_loop(pool->event_loop_group);
+    if (aws_socket_connect(socket, &endpoint, connect_loop, s_warm_socket_on_connected, warm_socket)) {
+        aws_host_resolver_record_connection_failure(pool->host_resolver, host_address);
+        goto error;
+    }
+
+    return;
+
+error:
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: warm pool couldn't start a connection to %s:%d, error %d.",
+        (void *)pool,
+        aws_string_c_str(pool->host_name),
+        (int)pool->port,
+        err_code ? err_code : aws_last_error());
+
+    if (warm_socket) {
+        s_warm_socket_destroy(warm_socket);
+    }
+    s_warm_pool_on_attempt_finished(pool, NULL);
+}
+
+/* starts enough connections to bring standby plus in-flight sockets back up to the pool's size. */
+static void s_warm_pool_top_up(struct client_warm_pool *pool) {
+    size_t to_connect = 0;
+
+    aws_mutex_lock(&pool->lock);
+    if (!pool->synced_data.shut_down) {
+        size_t have = pool->synced_data.standby_count + pool->synced_data.connecting_count;
+        to_connect = have < pool->size ? pool->size - have : 0;
+        pool->synced_data.connecting_count += to_connect;
+    }
+    aws_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < to_connect; ++i) {
+        aws_ref_count_acquire(&pool->ref_count);
+        if (aws_host_resolver_resolve_host(
+                pool->host_resolver,
+                pool->host_name,
+                s_warm_pool_on_host_resolved,
+                &pool->host_resolution_config,
+                pool)) {
+            s_warm_pool_on_attempt_finished(pool, NULL);
+        }
+    }
+}
+
+/* takes the freshest-enough standby socket for host_name:port, if the bootstrap pools that endpoint. */
+static struct aws_socket *s_warm_pools_take_socket(
+    struct aws_client_bootstrap *bootstrap,
+    const char *host_name,
+    uint16_t port,
+    const struct aws_socket_options *socket_options) {
+
+    if (socket_options->type != AWS_SOCKET_STREAM || !s_aws_socket_domain_uses_dns(socket_options->domain)) {
+        return NULL;
+    }
+
+    struct aws_byte_cursor host_name_cur = aws_byte_cursor_from_c_str(host_name);
+    struct client_warm_pool *pool = NULL;
+
+    aws_mutex_lock(&bootstrap->warm_pools_lock);
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&bootstrap->warm_pools);
+         node != aws_linked_list_end(&bootstrap->warm_pools);
+         node = aws_linked_list_next(node)) {
+        struct client_warm_pool *candidate = AWS_CONTAINER_OF(node, struct client_warm_pool, node);
+        if (candidate->port == port && aws_string_eq_byte_cursor(candidate->host_name, &host_name_cur)) {
+            pool = candidate;
+            aws_ref_count_acquire(&pool->ref_count);
+            break;
+        }
+    }
+    aws_mutex_unlock(&bootstrap->warm_pools_lock);
+
+    if (!pool) {
+        return NULL;
+    }
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+
+    struct aws_linked_list stale;
+    aws_linked_list_init(&stale);
+    struct warm_socket *taken = NULL;
+
+    aws_mutex_lock(&pool->lock);
+    while (!taken && !aws_linked_list_empty(&pool->synced_data.standby)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_back(&pool->synced_data.standby);
+        struct warm_socket *warm_socket = AWS_CONTAINER_OF(node, struct warm_socket, node);
+        pool->synced_data.standby_count--;
+
+        /* newest first, so once one is stale the rest are too and they all get closed */
+        if (pool->max_idle_ns && now - warm_socket->connected_at > pool->max_idle_ns) {
+            aws_linked_list_push_back(&stale, node);
+        } else {
+            taken = warm_socket;
+        }
+    }
+    aws_mutex_unlock(&pool->lock);
+
+    while (!aws_linked_list_empty(&stale)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&stale);
+        s_schedule_warm_socket_close(AWS_CONTAINER_OF(node, struct warm_socket, node));
+    }
+
+    s_warm_pool_top_up(pool);
+
+    struct aws_socket *socket = NULL;
+    if (taken) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_CHANNEL_BOOTSTRAP,
+            "id=%p: handing out warm socket %p for %s:%d",
+            (void *)bootstrap,
+            (void *)taken->socket,
+            host_name,
+            (int)port);
+        socket = taken->socket;
+        taken->socket = NULL;
+        s_warm_socket_destroy(taken);
+    }
+
+    aws_ref_count_release(&pool->ref_count);
+    return socket;
+}
+
+static void s_warm_socket_handoff_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct warm_socket_handoff *handoff = arg;
+    struct aws_allocator *allocator = handoff->args->bootstrap->allocator;
+
+    int error_code = status == AWS_TASK_STATUS_RUN_READY ? AWS_ERROR_SUCCESS : AWS_IO_EVENT_LOOP_SHUTDOWN;
+    s_on_client_connection_established(handoff->socket, error_code, handoff->args);
+
+    aws_mem_release(allocator, handoff);
+}
+
+/*
+ * continues a connection on a socket from a warm pool, on the socket's event loop just like a fresh connect would.
+ * Returns false if there's no warm socket to use, in which case the caller connects the usual way.
+ */
+static bool s_try_hand_off_warm_socket(
+    struct client_connection_args *args,
+    const char *host_name,
+    uint16_t port,
+    const struct aws_socket_options *socket_options) {
+
+    struct aws_client_bootstrap *bootstrap = args->bootstrap;
+    aws_mutex_lock(&bootstrap->warm_pools_lock);
+    bool has_warm_pools = !aws_linked_list_empty(&bootstrap->warm_pools);
+    aws_mutex_unlock(&bootstrap->warm_pools_lock);
+
+    if (!has_warm_pools) {
+        return false;
+    }
+
+    /* allocate up front, a taken socket can't be closed from this thread if we fail later */
+    struct warm_socket_handoff *handoff = aws_mem_calloc(bootstrap->allocator, 1, sizeof(struct warm_socket_handoff));
+    if (!handoff) {
+        return false;
+    }
+
+    handoff->socket = s_warm_pools_take_socket(bootstrap, host_name, port, socket_options);
+    if (!handoff->socket) {
+        aws_mem_release(bootstrap->allocator, handoff);
+        return false;
+    }
+
+    handoff->args = s_client_connection_args_acquire(args);
+    args->addresses_count = 1;
+
+    aws_task_init(&handoff->task, s_warm_socket_handoff_task, handoff, "warm_socket_handoff");
+    aws_event_loop_schedule_task_now(aws_socket_get_event_loop(handoff->socket), &handoff->task);
+
+    return true;
+}
+
+int aws_client_bootstrap_add_warm_pool(
+    struct aws_client_bootstrap *bootstrap,
+    const struct aws_client_bootstrap_warm_pool_options *options) {
+
+    AWS_FATAL_ASSERT(options->host_name);
+    AWS_FATAL_ASSERT(options->socket_options);
+
+    if (options->socket_options->type != AWS_SOCKET_STREAM ||
+        !s_aws_socket_domain_uses_dns(options->socket_options->domain) || options->size == 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct client_warm_pool *pool = aws_mem_calloc(bootstrap->allocator, 1, sizeof(struct client_warm_pool));
+    if (!pool) {
+        return AWS_OP_ERR;
+    }
+
+    pool->host_name = aws_string_new_from_c_str(bootstrap->allocator, options->host_name);
+    if (!pool->host_name) {
+        aws_mem_release(bootstrap->allocator, pool);
+        return AWS_OP_ERR;
+    }
+
+    pool->allocator = bootstrap->allocator;
+    pool->event_loop_group = aws_event_loop_group_acquire(bootstrap->event_loop_group);
+    pool->host_resolver = aws_host_resolver_acquire(bootstrap->host_resolver);
+    pool->host_resolution_config = bootstrap->host_resolver_config;
+    pool->port = options->port;
+    pool->socket_options = *options->socket_options;
+    pool->size = options->size;
+    pool->max_idle_ns = aws_timestamp_convert(options->max_idle_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    aws_ref_count_init(&pool->ref_count, pool, (aws_simple_completion_callback *)s_warm_pool_destroy);
+    aws_mutex_init(&pool->lock);
+    aws_linked_list_init(&pool->synced_data.standby);
+
+    struct aws_byte_cursor host_name_cur = aws_byte_cursor_from_c_str(options->host_name);
+    bool duplicate = false;
+
+    aws_mutex_lock(&bootstrap->warm_pools_lock);
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&bootstrap->warm_pools);
+         node != aws_linked_list_end(&bootstrap->warm_pools);
+         node = aws_linked_list_next(node)) {
+        struct client_warm_pool *existing = AWS_CONTAINER_OF(node, struct client_warm_pool, node);
+        if (existing->port == pool->port && aws_string_eq_byte_cursor(existing->host_name, &host_name_cur)) {
+            duplicate = true;
+            break;
+        }
+    }
+    if (!duplicate) {
+        aws_linked_list_push_back(&bootstrap->warm_pools, &pool->node);
+    }
+    aws_mutex_unlock(&bootstrap->warm_pools_lock);
+
+    if (duplicate) {
+        aws_ref_count_release(&pool->ref_count);
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: keeping %llu warm connections to %s:%d",
+        (void *)bootstrap,
+        (unsigned long long)pool->size,
+        options->host_name,
+        (int)options->port);
+
+    s_warm_pool_top_up(pool);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_shut_down_warm_pools(struct aws_client_bootstrap *bootstrap) {
+    /* the last reference to the bootstrap is gone, nobody else can touch its pool list */
+    while (!aws_linked_list_empty(&bootstrap->warm_pools)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&bootstrap->warm_pools);
+        struct client_warm_pool *pool = AWS_CONTAINER_OF(node, struct client_warm_pool, node);
+
+        struct aws_linked_list standby;
+        aws_linked_list_init(&standby);
+
+        aws_mutex_lock(&pool->lock);
+        pool->synced_data.shut_down = true;
+        aws_linked_list_swap_contents(&standby, &pool->synced_data.standby);
+        pool->synced_data.standby_count = 0;
+        aws_mutex_unlock(&pool->lock);
+
+        while (!aws_linked_list_empty(&standby)) {
+            struct aws_linked_list_node *socket_node = aws_linked_list_pop_front(&standby);
+            s_schedule_warm_socket_close(AWS_CONTAINER_OF(socket_node, struct warm_socket, node));
+        }
+
+        aws_ref_count_release(&pool->ref_count);
+    }
+}
+
+/*
+ * Resolves and connects, or connects directly for domains that don't use DNS. On failure the caller still owns the
+ * reference setup_callback would release.
+ */
+static int s_start_connection_setup(struct client_connection_args *client_connection_args) {
+    struct aws_client_bootstrap *bootstrap = client_connection_args->bootstrap;
+    const struct aws_socket_options *socket_options = &client_connection_args->outgoing_options;
+    const char *host_name = aws_string_c_str(client_connection_args->host_name);
+    uint16_t port = client_connection_args->outgoing_port;
+
+    if (s_aws_socket_domain_uses_dns(socket_options->domain)) {
+        if (s_try_hand_off_warm_socket(client_connection_args, host_name, port, socket_options)) {
+            s_client_connection_args_release(client_connection_args);
+            return AWS_OP_SUCCESS;
+        }
+
+        /* pick the loop the connection attempts will run on now, so the resolver can answer on it directly */
+        client_connection_args->connect_loop = aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
+        client_connection_args->timing.dns_start_ns = s_timing_now_ns();
+        s_trace_client_event(client_connection_args, AWS_CONNECTION_TRACE_DNS_START, NULL, AWS_ERROR_SUCCESS);
+        if (aws_host_resolver_resolve_host_on_event_loop(
+                bootstrap->host_resolver,
+                client_connection_args->host_name,
+                s_on_host_resolved,
+                &bootstrap->host_resolver_config,
+                client_connection_args->connect_loop,
+                client_connection_args)) {
+            return AWS_OP_ERR;
+        }
+    } else {
+        /* ensure that the pipe/domain socket name will fit in the endpoint address */
+        const size_t host_name_len = strlen(host_name);
+        if (host_name_len >= AWS_ADDRESS_MAX_LEN) {
+            aws_raise_error(AWS_IO_SOCKET_INVALID_ADDRESS);
+            return AWS_OP_ERR;
+        }
+
+        struct aws_socket_endpoint endpoint;
+        AWS_ZERO_STRUCT(endpoint);
+        memcpy(endpoint.address, host_name, host_name_len);
+        if (socket_options->domain == AWS_SOCKET_VSOCK) {
+            endpoint.port = port;
+        } else {
+            endpoint.port = 0;
+        }
+
+        struct aws_socket *outgoing_socket = aws_mem_acquire(bootstrap->allocator, sizeof(struct aws_socket));
+
+        if (!outgoing_socket) {
+            return AWS_OP_ERR;
+        }
+
+        if (aws_socket_init(outgoing_socket, bootstrap->allocator, socket_options)) {
+            aws_mem_release(bootstrap->allocator, outgoing_socket);
+            return AWS_OP_ERR;
+        }
+
+        client_connection_args->addresses_count = 1;
+
+        struct aws_event_loop *connect_loop = aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
+
+        s_client_connection_args_acquire(client_connection_args);
+        s_record_connect_attempt(client_connection_args);
+        if (aws_socket_connect(
+                outgoing_socket, &endpoint, connect_loop, s_on_client_connection_established, client_connection_args)) {
+            aws_socket_clean_up(outgoing_socket);
+            aws_mem_release(client_connection_args->bootstrap->allocator, outgoing_socket);
+            s_client_connection_args_release(client_connection_args);
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
 }
 
 int aws_client_bootstrap_new_socket_channel(struct aws_socket_channel_bootstrap_options *options) {
@@ -733,9 +1710,15 @@ int aws_client_bootstrap_new_socket_channel(struct aws_socket_channel_bootstrap_
     client_connection_args->creation_callback = options->creation_callback;
     client_connection_args->setup_callback = options->setup_callback;
     client_connection_args->shutdown_callback = options->shutdown_callback;
+    client_connection_args->timing_callback = options->timing_callback;
+    client_connection_args->timing.requested_ns = s_timing_now_ns();
     client_connection_args->outgoing_options = *socket_options;
     client_connection_args->outgoing_port = port;
     client_connection_args->enable_read_back_pressure = options->enable_read_back_pressure;
+    client_connection_args->idle_timeout_ms = options->idle_timeout_ms;
+    client_connection_args->write_coalescing_threshold = options->write_coalescing_threshold;
+    client_connection_args->channel_arena_size = options->channel_arena_size;
+    aws_linked_list_init(&client_connection_args->pending_attempts);
 
     if (tls_options) {
         if (aws_tls_connection_options_copy(&client_connection_args->channel_data.tls_options, tls_options)) {
@@ -743,13 +1726,18 @@ int aws_client_bootstrap_new_socket_channel(struct aws_socket_channel_bootstrap_
         }
         client_connection_args->channel_data.use_tls = true;
 
+        if (!client_connection_args->channel_data.tls_options.server_port) {
+            client_connection_args->channel_data.tls_options.server_port = port;
+        }
+
         client_connection_args->channel_data.on_protocol_negotiated = bootstrap->on_protocol_negotiated;
         client_connection_args->channel_data.tls_user_data = tls_options->user_data;
 
         /* in order to honor any callbacks a user may have installed on their tls_connection_options,
          * we need to wrap them if they were set.*/
         if (bootstrap->on_protocol_negotiated) {
-            client_connection_args->channel_data.tls_options.advertise_alpn_message = true;
+            client_connection_args->channel_data.tls_options.on_protocol_negotiated =
+                s_tls_client_on_protocol_negotiated;
         }
 
         if (tls_options->on_data_read) {
@@ -770,61 +1758,36 @@ int aws_client_bootstrap_new_socket_channel(struct aws_socket_channel_bootstrap_
         client_connection_args->channel_data.tls_options.user_data = client_connection_args;
     }
 
-    if (s_aws_socket_domain_uses_dns(socket_options->domain)) {
-        client_connection_args->host_name = aws_string_new_from_c_str(bootstrap->allocator, host_name);
-
-        if (!client_connection_args->host_name) {
-            goto error;
-        }
-
-        if (aws_host_resolver_resolve_host(
-                bootstrap->host_resolver,
-                client_connection_args->host_name,
-                s_on_host_resolved,
-                &bootstrap->host_resolver_config,
-                client_connection_args)) {
-            goto error;
-        }
-    } else {
-        /* ensure that the pipe/domain socket name will fit in the endpoint address */
-        const size_t host_name_len = strlen(host_name);
-        if (host_name_len >= AWS_ADDRESS_MAX_LEN) {
-            aws_raise_error(AWS_IO_SOCKET_INVALID_ADDRESS);
-            goto error;
-        }
-
-        struct aws_socket_endpoint endpoint;
-        AWS_ZERO_STRUCT(endpoint);
-        memcpy(endpoint.address, host_name, host_name_len);
-        if (socket_options->domain == AWS_SOCKET_VSOCK) {
-            endpoint.port = port;
-        } else {
-            endpoint.port = 0;
-        }
-
-        struct aws_socket *outgoing_socket = aws_mem_acquire(bootstrap->allocator, sizeof(struct aws_socket));
+    client_connection_args->host_name = aws_string_new_from_c_str(bootstrap->allocator, host_name);
+    if (!client_connection_args->host_name) {
+        goto error;
+    }
 
-        if (!outgoing_socket) {
-            goto error;
+    if (bootstrap->max_connection_setups || bootstrap->max_connection_setups_per_host) {
+        aws_mutex_lock(&bootstrap->setup_limit_lock);
+        /* nothing jumps the queue, queued setups on other hosts will be checked when a slot frees up */
+        bool queued = !aws_linked_list_empty(&bootstrap->queued_connection_setups) ||
+                      !s_try_take_setup_slot(client_connection_args);
+        if (queued) {
+            aws_linked_list_push_back(
+                &bootstrap->queued_connection_setups, &client_connection_args->queued_setup_node);
         }
+        aws_mutex_unlock(&bootstrap->setup_limit_lock);
 
-        if (aws_socket_init(outgoing_socket, bootstrap->allocator, socket_options)) {
-            aws_mem_release(bootstrap->allocator, outgoing_socket);
-            goto error;
+        if (queued) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_CHANNEL_BOOTSTRAP,
+                "id=%p: connection setup limit reached, queueing channel setup to %s:%d",
+                (void *)bootstrap,
+                host_name,
+                (int)port);
+            return AWS_OP_SUCCESS;
         }
+    }
 
-        client_connection_args->addresses_count = 1;
-
-        struct aws_event_loop *connect_loop = aws_event_loop_group_get_next_loop(bootstrap->event_loop_group);
-
-        s_client_connection_args_acquire(client_connection_args);
-        if (aws_socket_connect(
-                outgoing_socket, &endpoint, connect_loop, s_on_client_connection_established, client_connection_args)) {
-            aws_socket_clean_up(outgoing_socket);
-            aws_mem_release(client_connection_args->bootstrap->allocator, outgoing_socket);
-            s_client_connection_args_release(client_connection_args);
-            goto error;
-        }
+    client_connection_args->timing.started_ns = client_connection_args->timing.requested_ns;
+    if (s_start_connection_setup(client_connection_args)) {
+        goto error;
     }
 
     return AWS_OP_SUCCESS;
@@ -887,9 +1850,35 @@ struct aws_server_bootstrap *aws_server_bootstrap_new(
     return bootstrap;
 }
 
+struct server_connection_args;
+
+/* the channels accepted by one listener. With a listener per event loop, each loop only ever locks its own. */
+struct server_channel_shard {
+    struct aws_mutex lock;
+    /* server_channel_data of the channels whose incoming callback succeeded and that haven't shut down yet */
+    struct aws_linked_list ready_channels;
+    /* every channel from creation until it shuts down or fails to set up */
+    size_t open_channel_count;
+    bool draining;
+    /* had open channels when the drain started and hasn't emptied since, so it still counts in drain_pending */
+    bool drain_pending;
+};
+
+/* one of the additional SO_REUSEPORT listeners opened when listener_per_event_loop is set. */
+struct server_extra_listener {
+    struct aws_socket socket;
+    struct aws_task destroy_task;
+    struct server_connection_args *server_connection_args;
+};
+
 struct server_connection_args {
     struct aws_server_bootstrap *bootstrap;
     struct aws_socket listener;
+    /* the listeners on every loop but the first, each accepting only for its own loop. Empty unless
+     * listener_per_event_loop is set. Each listener that started accepting holds a reference. */
+    struct server_extra_listener *extra_listeners;
+    size_t extra_listener_count;
+    bool listener_per_event_loop;
     aws_server_bootstrap_on_accept_channel_setup_fn *incoming_callback;
     aws_server_bootstrap_on_accept_channel_shutdown_fn *shutdown_callback;
     aws_server_bootstrap_on_server_listener_destroy_fn *destroy_callback;
@@ -903,6 +1892,26 @@ struct server_connection_args {
     void *user_data;
     bool use_tls;
     bool enable_read_back_pressure;
+    uint32_t idle_timeout_ms;
+    size_t write_coalescing_threshold;
+    size_t channel_arena_size;
+    /* one per listener, the first for the main listener and the rest in the same order as extra_listeners */
+    struct server_channel_shard *shards;
+    size_t shard_count;
+    /* set once by aws_server_bootstrap_drain_socket_listener() */
+    struct aws_atomic_var drain_requested;
+    /* shards still waiting on channels to close, plus one held while the drain is being started. The drain is
+     * complete when it drops to zero. */
+    struct aws_atomic_var drain_pending;
+    /* set by aws_server_bootstrap_drain_socket_listener(). The tasks run on drain_event_loop, the listener's loop,
+     * which is also the only thread to touch drain_finished and drain_deadline_scheduled. */
+    struct aws_event_loop *drain_event_loop;
+    struct aws_server_bootstrap_drain_options drain_options;
+    struct aws_task drain_start_task;
+    struct aws_task drain_deadline_task;
+    struct aws_task drain_complete_task;
+    bool drain_deadline_scheduled;
+    bool drain_finished;
     struct aws_ref_count ref_count;
 };
 
@@ -910,6 +1919,12 @@ struct server_channel_data {
     struct aws_channel *channel;
     struct aws_socket *socket;
     struct server_connection_args *server_connection_args;
+    /* the shard of the listener that accepted the channel */
+    struct server_channel_shard *shard;
+    /* in shard->ready_channels while is_ready is set */
+    struct aws_linked_list_node ready_node;
+    struct aws_channel_task drain_task;
+    bool is_ready;
     bool incoming_called;
 };
 
@@ -937,6 +1952,17 @@ static void s_server_connection_args_destroy(struct server_connection_args *args
         aws_tls_connection_options_clean_up(&args->tls_options);
     }
 
+    if (args->extra_listeners) {
+        aws_mem_release(allocator, args->extra_listeners);
+    }
+
+    if (args->shards) {
+        for (size_t i = 0; i < args->shard_count; ++i) {
+            aws_mutex_clean_up(&args->shards[i].lock);
+        }
+        aws_mem_release(allocator, args->shards);
+    }
+
     aws_mem_release(allocator, args);
 }
 
@@ -946,6 +1972,29 @@ static void s_server_connection_args_release(struct server_connection_args *args
     }
 }
 
+/* call on the channel's thread, the drain only notifies handlers. */
+static void s_server_channel_drain_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct server_channel_data *channel_data = arg;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_channel_drain(channel_data->channel);
+    }
+}
+
+static void s_trace_server_event(
+    struct server_channel_data *channel_data,
+    enum aws_connection_trace_event_type type,
+    struct aws_channel *channel,
+    int error_code) {
+    s_trace_connection_event(
+        &channel_data->server_connection_args->bootstrap->tracer, type, channel_data, channel, error_code);
+}
+
+static void s_server_on_first_read(struct aws_channel_handler *handler, void *user_data) {
+    s_trace_server_event(user_data, AWS_CONNECTION_TRACE_FIRST_BYTE, handler->slot->channel, AWS_ERROR_SUCCESS);
+}
+
 static void s_server_incoming_callback(
     struct server_channel_data *channel_data,
     int error_code,
@@ -953,8 +2002,55 @@ static void s_server_incoming_callback(
     /* incoming_callback is always called exactly once for each channel */
     AWS_ASSERT(!channel_data->incoming_called);
     struct server_connection_args *args = channel_data->server_connection_args;
+    struct server_channel_shard *shard = channel_data->shard;
+    s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_SETUP_COMPLETE, channel, error_code);
+
+    /* a drain that starts after this sees the channel in the list, one that started before is picked up here. */
+    bool drain_now = false;
+    if (!error_code) {
+        aws_mutex_lock(&shard->lock);
+        aws_linked_list_push_back(&shard->ready_channels, &channel_data->ready_node);
+        channel_data->is_ready = true;
+        drain_now = shard->draining;
+        aws_mutex_unlock(&shard->lock);
+    }
+
     args->incoming_callback(args->bootstrap, error_code, channel, args->user_data);
     channel_data->incoming_called = true;
+
+    if (drain_now) {
+        aws_channel_drain(channel);
+    }
+}
+
+/* drops one of args->drain_pending, scheduling the drain's completion if it was the last. */
+static void s_drain_pending_release(struct server_connection_args *args) {
+    if (aws_atomic_fetch_sub(&args->drain_pending, 1) == 1) {
+        s_server_connection_args_acquire(args);
+        aws_event_loop_schedule_task_now(args->drain_event_loop, &args->drain_complete_task);
+    }
+}
+
+/* call when a counted channel is gone, before the channel's reference on args is released. */
+static void s_server_channel_closed(struct server_channel_data *channel_data) {
+    struct server_channel_shard *shard = channel_data->shard;
+
+    aws_mutex_lock(&shard->lock);
+    if (channel_data->is_ready) {
+        aws_linked_list_remove(&channel_data->ready_node);
+        channel_data->is_ready = false;
+    }
+    AWS_FATAL_ASSERT(shard->open_channel_count > 0);
+    --shard->open_channel_count;
+    bool shard_drained = shard->drain_pending && shard->open_channel_count == 0;
+    if (shard_drained) {
+        shard->drain_pending = false;
+    }
+    aws_mutex_unlock(&shard->lock);
+
+    if (shard_drained) {
+        s_drain_pending_release(channel_data->server_connection_args);
+    }
 }
 
 static void s_tls_server_on_negotiation_result(
@@ -964,6 +2060,7 @@ static void s_tls_server_on_negotiation_result(
     void *user_data) {
     struct server_channel_data *channel_data = user_data;
     struct server_connection_args *connection_args = channel_data->server_connection_args;
+    s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_TLS_END, slot->channel, err_code);
 
     if (connection_args->user_on_negotiation_result) {
         connection_args->user_on_negotiation_result(handler, slot, err_code, connection_args->tls_user_data);
@@ -999,6 +2096,16 @@ static void s_tls_server_on_data_read(
     }
 }
 
+static struct aws_channel_handler *s_tls_server_on_protocol_negotiated(
+    struct aws_channel_slot *new_slot,
+    struct aws_byte_buf *protocol,
+    void *user_data) {
+    struct server_channel_data *channel_data = user_data;
+    struct server_connection_args *connection_args = channel_data->server_connection_args;
+
+    return connection_args->on_protocol_negotiated(new_slot, protocol, connection_args->user_data);
+}
+
 /* in the context of a channel bootstrap, we don't care about these, but since we're hooking into these APIs we have to
  * provide a proxy for the user actually receiving their callbacks. */
 static void s_tls_server_on_error(
@@ -1031,10 +2138,10 @@ static inline int s_setup_server_tls(struct server_channel_data *channel_data, s
     /* Shallow-copy tls_options so we can override the user_data, making it specific to this channel */
     struct aws_tls_connection_options tls_options = connection_args->tls_options;
     tls_options.user_data = channel_data;
-    tls_handler = aws_tls_server_handler_new(connection_args->bootstrap->allocator, &tls_options, tls_slot);
+    tls_handler = aws_tls_server_handler_new(aws_channel_get_arena_allocator(channel), &tls_options, tls_slot);
 
     if (!tls_handler) {
-        aws_mem_release(connection_args->bootstrap->allocator, tls_slot);
+        aws_channel_slot_remove(tls_slot);
         return AWS_OP_ERR;
     }
 
@@ -1052,39 +2159,7 @@ static inline int s_setup_server_tls(struct server_channel_data *channel_data, s
         return AWS_OP_ERR;
     }
 
-    if (connection_args->on_protocol_negotiated) {
-        struct aws_channel_slot *alpn_slot = NULL;
-        struct aws_channel_handler *alpn_handler = NULL;
-        alpn_slot = aws_channel_slot_new(channel);
-
-        if (!alpn_slot) {
-            return AWS_OP_ERR;
-        }
-
-        alpn_handler = aws_tls_alpn_handler_new(
-            connection_args->bootstrap->allocator, connection_args->on_protocol_negotiated, connection_args->user_data);
-
-        if (!alpn_handler) {
-            aws_channel_slot_remove(alpn_slot);
-            return AWS_OP_ERR;
-        }
-
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_CHANNEL_BOOTSTRAP,
-            "id=%p: Setting up ALPN handler on channel "
-            "%p with handler %p on slot %p",
-            (void *)connection_args->bootstrap,
-            (void *)channel,
-            (void *)alpn_handler,
-            (void *)alpn_slot);
-
-        aws_channel_slot_insert_right(tls_slot, alpn_slot);
-
-        if (aws_channel_slot_set_handler(alpn_slot, alpn_handler)) {
-            return AWS_OP_ERR;
-        }
-    }
-
+    s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_TLS_START, channel, AWS_ERROR_SUCCESS);
     return AWS_OP_SUCCESS;
 }
 
@@ -1106,9 +2181,12 @@ static void s_on_server_channel_on_setup_completed(struct aws_channel *channel,
         aws_socket_clean_up(channel_data->socket);
         aws_mem_release(allocator, (void *)channel_data->socket);
         s_server_incoming_callback(channel_data, err_code, NULL);
-        aws_mem_release(channel_data->server_connection_args->bootstrap->allocator, channel_data);
+        s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_CLOSE, NULL, err_code);
+        struct server_connection_args *args = channel_data->server_connection_args;
+        s_server_channel_closed(channel_data);
+        aws_mem_release(args->bootstrap->allocator, channel_data);
         /* no shutdown call back will be fired, we release the ref_count of connection arg here */
-        s_server_connection_args_release(channel_data->server_connection_args);
+        s_server_connection_args_release(args);
         return;
     }
 
@@ -1126,7 +2204,7 @@ static void s_on_server_channel_on_setup_completed(struct aws_channel *channel,
     }
 
     struct aws_channel_handler *socket_channel_handler = aws_socket_handler_new(
-        channel_data->server_connection_args->bootstrap->allocator,
+        aws_channel_get_arena_allocator(channel),
         channel_data->socket,
         socket_slot,
         g_aws_channel_max_fragment_size);
@@ -1152,6 +2230,18 @@ static void s_on_server_channel_on_setup_completed(struct aws_channel *channel,
         goto error;
     }
 
+    if (aws_socket_handler_set_idle_timeout(
+            socket_channel_handler, channel_data->server_connection_args->idle_timeout_ms)) {
+        err_code = aws_last_error();
+        goto error;
+    }
+
+    aws_socket_handler_set_write_coalescing(
+        socket_channel_handler, channel_data->server_connection_args->write_coalescing_threshold);
+    if (channel_data->server_connection_args->bootstrap->tracer.on_event) {
+        aws_socket_handler_set_on_first_read(socket_channel_handler, s_server_on_first_read, channel_data);
+    }
+
     if (channel_data->server_connection_args->use_tls) {
         /* incoming callback will be invoked upon the negotiation completion so don't do it
          * here. */
@@ -1189,15 +2279,28 @@ static void s_on_server_channel_on_shutdown(struct aws_channel *channel, int err
     } else {
         args->shutdown_callback(server_bootstrap, error_code, channel, server_shutdown_user_data);
     }
+    s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_CLOSE, channel, error_code);
 
     aws_channel_destroy(channel);
     aws_socket_clean_up(channel_data->socket);
     aws_mem_release(allocator, channel_data->socket);
+    s_server_channel_closed(channel_data);
     s_server_connection_args_release(channel_data->server_connection_args);
 
     aws_mem_release(allocator, channel_data);
 }
 
+static struct server_channel_shard *s_listener_shard(
+    struct server_connection_args *args,
+    struct aws_socket *listener) {
+    if (listener == &args->listener) {
+        return &args->shards[0];
+    }
+
+    struct server_extra_listener *extra_listener = AWS_CONTAINER_OF(listener, struct server_extra_listener, socket);
+    return &args->shards[1 + (size_t)(extra_listener - args->extra_listeners)];
+}
+
 void s_on_server_connection_result(
     struct aws_socket *socket,
     int error_code,
@@ -1229,9 +2332,17 @@ void s_on_server_connection_result(
         channel_data->incoming_called = false;
         channel_data->socket = new_socket;
         channel_data->server_connection_args = connection_args;
+        channel_data->shard = s_listener_shard(connection_args, socket);
+        s_trace_server_event(channel_data, AWS_CONNECTION_TRACE_CONNECT_END, NULL, AWS_ERROR_SUCCESS);
+        aws_channel_task_init(
+            &channel_data->drain_task, s_server_channel_drain_task, channel_data, "server_channel_drain");
 
+        /* with a listener on every loop the kernel has already balanced the connections, keep each one where it
+         * was accepted. */
         struct aws_event_loop *event_loop =
-            aws_event_loop_group_get_next_loop(connection_args->bootstrap->event_loop_group);
+            connection_args->listener_per_event_loop
+                ? aws_socket_get_event_loop(socket)
+                : aws_event_loop_group_get_next_loop(connection_args->bootstrap->event_loop_group);
 
         struct aws_channel_options channel_args = {
             .on_setup_completed = s_on_server_channel_on_setup_completed,
@@ -1242,15 +2353,22 @@ void s_on_server_connection_result(
 
         channel_args.event_loop = event_loop;
         channel_args.enable_read_back_pressure = channel_data->server_connection_args->enable_read_back_pressure;
+        channel_args.arena_size = channel_data->server_connection_args->channel_arena_size;
 
         if (aws_socket_assign_to_event_loop(new_socket, event_loop)) {
             aws_mem_release(connection_args->bootstrap->allocator, (void *)channel_data);
             goto error_cleanup;
         }
 
+        /* counted first, since the channel's setup may fail on its own loop before aws_channel_new() returns. */
+        aws_mutex_lock(&channel_data->shard->lock);
+        ++channel_data->shard->open_channel_count;
+        aws_mutex_unlock(&channel_data->shard->lock);
+
         channel_data->channel = aws_channel_new(connection_args->bootstrap->allocator, &channel_args);
 
         if (!channel_data->channel) {
+            s_server_channel_closed(channel_data);
             aws_mem_release(connection_args->bootstrap->allocator, (void *)channel_data);
             goto error_cleanup;
         }
@@ -1272,16 +2390,154 @@ error_cleanup:
     s_server_connection_args_release(connection_args);
 }
 
+static void s_extra_listener_destroy_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)status;
+    (void)task;
+    struct server_extra_listener *extra_listener = arg;
+
+    aws_socket_stop_accept(&extra_listener->socket);
+    aws_socket_clean_up(&extra_listener->socket);
+    s_server_connection_args_release(extra_listener->server_connection_args);
+}
+
 static void s_listener_destroy_task(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)status;
     (void)task;
     struct server_connection_args *server_connection_args = arg;
 
+    /* every other listener is torn down on its own loop, so nobody blocks waiting on another loop's thread. */
+    for (size_t i = 0; i < server_connection_args->extra_listener_count; ++i) {
+        struct server_extra_listener *extra_listener = &server_connection_args->extra_listeners[i];
+        aws_event_loop_schedule_task_now(extra_listener->socket.event_loop, &extra_listener->destroy_task);
+    }
+
     aws_socket_stop_accept(&server_connection_args->listener);
     aws_socket_clean_up(&server_connection_args->listener);
     s_server_connection_args_release(server_connection_args);
 }
 
+/* runs on the listener's loop, and only once. */
+static void s_drain_finish(struct server_connection_args *args, int error_code) {
+    if (args->drain_finished) {
+        return;
+    }
+    args->drain_finished = true;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: listener drain finished with error %d.",
+        (void *)args->bootstrap,
+        error_code);
+
+    if (args->drain_options.on_drained) {
+        args->drain_options.on_drained(args->bootstrap, error_code, args->drain_options.user_data);
+    }
+}
+
+static void s_drain_start_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct server_connection_args *args = arg;
+
+    /* scheduled from this thread, so the complete task can cancel it. */
+    if (status == AWS_TASK_STATUS_RUN_READY && args->drain_options.timeout_ms && !args->drain_finished) {
+        uint64_t now = 0;
+        aws_event_loop_current_clock_time(args->drain_event_loop, &now);
+        uint64_t timeout_ns =
+            aws_timestamp_convert(args->drain_options.timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+        s_server_connection_args_acquire(args);
+        args->drain_deadline_scheduled = true;
+        aws_event_loop_schedule_task_future(
+            args->drain_event_loop, &args->drain_deadline_task, aws_add_u64_saturating(now, timeout_ns));
+    }
+
+    s_server_connection_args_release(args);
+}
+
+/* shutdown only schedules a task on each channel's loop, and channels leave the list before they're freed. */
+static void s_shard_shut_down_ready_channels(struct server_connection_args *args, struct server_channel_shard *shard) {
+    aws_mutex_lock(&shard->lock);
+    size_t channel_count = 0;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&shard->ready_channels);
+         node != aws_linked_list_end(&shard->ready_channels);
+         node = aws_linked_list_next(node)) {
+        ++channel_count;
+    }
+
+    /* everything still open goes at once, so shut it down as a batch. Without the memory, one at a time. */
+    struct aws_allocator *allocator = args->bootstrap->allocator;
+    struct aws_channel **channels =
+        channel_count ? aws_mem_calloc(allocator, channel_count, sizeof(struct aws_channel *)) : NULL;
+    size_t channel_index = 0;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&shard->ready_channels);
+         node != aws_linked_list_end(&shard->ready_channels);
+         node = aws_linked_list_next(node)) {
+        struct server_channel_data *channel_data = AWS_CONTAINER_OF(node, struct server_channel_data, ready_node);
+        if (channels) {
+            channels[channel_index++] = channel_data->channel;
+        } else {
+            aws_channel_shutdown(channel_data->channel, AWS_IO_CHANNEL_DRAIN_TIMEOUT);
+        }
+    }
+
+    if (channels) {
+        aws_channel_shutdown_many(channels, channel_count, AWS_IO_CHANNEL_DRAIN_TIMEOUT);
+        aws_mem_release(allocator, channels);
+    }
+    aws_mutex_unlock(&shard->lock);
+}
+
+static void s_drain_deadline_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct server_connection_args *args = arg;
+    args->drain_deadline_scheduled = false;
+
+    if (!args->drain_finished) {
+        int error_code =
+            status == AWS_TASK_STATUS_RUN_READY ? AWS_IO_CHANNEL_DRAIN_TIMEOUT : AWS_IO_EVENT_LOOP_SHUTDOWN;
+
+        for (size_t i = 0; i < args->shard_count; ++i) {
+            s_shard_shut_down_ready_channels(args, &args->shards[i]);
+        }
+
+        s_drain_finish(args, error_code);
+    }
+
+    s_server_connection_args_release(args);
+}
+
+static void s_drain_complete_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct server_connection_args *args = arg;
+
+    s_drain_finish(args, AWS_ERROR_SUCCESS);
+    if (args->drain_deadline_scheduled) {
+        /* runs the deadline task, which sees the drain finished and drops its reference. */
+        aws_event_loop_cancel_task(args->drain_event_loop, &args->drain_deadline_task);
+    }
+
+    s_server_connection_args_release(args);
+}
+
+/* init, bind and listen on one of the listener sockets, cleaning it up on failure. */
+static int s_server_listener_open(
+    struct aws_socket *listener,
+    struct aws_allocator *allocator,
+    const struct aws_socket_options *socket_options,
+    const struct aws_socket_endpoint *endpoint) {
+
+    if (aws_socket_init(listener, allocator, socket_options)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_socket_bind(listener, endpoint) || aws_socket_listen(listener, 1024)) {
+        aws_socket_clean_up(listener);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 struct aws_socket *aws_server_bootstrap_new_socket_listener(
     const struct aws_server_socket_channel_bootstrap_options *bootstrap_options) {
     AWS_PRECONDITION(bootstrap_options);
@@ -1307,6 +2563,8 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
         &server_connection_args->ref_count,
         server_connection_args,
         (aws_simple_completion_callback *)s_server_connection_args_destroy);
+    aws_atomic_init_int(&server_connection_args->drain_requested, 0);
+    aws_atomic_init_int(&server_connection_args->drain_pending, 0);
     server_connection_args->user_data = bootstrap_options->user_data;
     server_connection_args->bootstrap = aws_server_bootstrap_acquire(bootstrap_options->bootstrap);
     server_connection_args->shutdown_callback = bootstrap_options->shutdown_callback;
@@ -1314,12 +2572,27 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
     server_connection_args->destroy_callback = bootstrap_options->destroy_callback;
     server_connection_args->on_protocol_negotiated = bootstrap_options->bootstrap->on_protocol_negotiated;
     server_connection_args->enable_read_back_pressure = bootstrap_options->enable_read_back_pressure;
+    server_connection_args->idle_timeout_ms = bootstrap_options->idle_timeout_ms;
+    server_connection_args->write_coalescing_threshold = bootstrap_options->write_coalescing_threshold;
+    server_connection_args->channel_arena_size = bootstrap_options->channel_arena_size;
 
     aws_task_init(
         &server_connection_args->listener_destroy_task,
         s_listener_destroy_task,
         server_connection_args,
         "listener socket destroy");
+    aws_task_init(
+        &server_connection_args->drain_start_task, s_drain_start_task, server_connection_args, "listener drain start");
+    aws_task_init(
+        &server_connection_args->drain_deadline_task,
+        s_drain_deadline_task,
+        server_connection_args,
+        "listener drain deadline");
+    aws_task_init(
+        &server_connection_args->drain_complete_task,
+        s_drain_complete_task,
+        server_connection_args,
+        "listener drain complete");
 
     if (bootstrap_options->tls_options) {
         AWS_LOGF_INFO(
@@ -1335,7 +2608,7 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
         /* in order to honor any callbacks a user may have installed on their tls_connection_options,
          * we need to wrap them if they were set.*/
         if (bootstrap_options->bootstrap->on_protocol_negotiated) {
-            server_connection_args->tls_options.advertise_alpn_message = true;
+            server_connection_args->tls_options.on_protocol_negotiated = s_tls_server_on_protocol_negotiated;
         }
 
         if (bootstrap_options->tls_options->on_data_read) {
@@ -1356,15 +2629,50 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
         server_connection_args->tls_options.user_data = server_connection_args;
     }
 
-    struct aws_event_loop *connection_loop =
-        aws_event_loop_group_get_next_loop(bootstrap_options->bootstrap->event_loop_group);
+    struct aws_allocator *allocator = bootstrap_options->bootstrap->allocator;
+    struct aws_event_loop_group *el_group = bootstrap_options->bootstrap->event_loop_group;
+    struct aws_socket_options socket_options = *bootstrap_options->socket_options;
+    struct aws_event_loop *connection_loop = NULL;
+    size_t listener_count = 1;
+    size_t opened_count = 0;
+    size_t started_count = 0;
 
-    if (aws_socket_init(
-            &server_connection_args->listener,
-            bootstrap_options->bootstrap->allocator,
-            bootstrap_options->socket_options)) {
+    if (bootstrap_options->listener_per_event_loop) {
+        /* every listener has to bind the same port, so an ephemeral one won't do. */
+        if (socket_options.domain == AWS_SOCKET_LOCAL || bootstrap_options->port == 0) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_CHANNEL_BOOTSTRAP,
+                "id=%p: a listener per event loop needs a non-local socket and a fixed port",
+                (void *)bootstrap_options->bootstrap);
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            goto cleanup_server_connection_args;
+        }
+
+        socket_options.reuse_port = true;
+        server_connection_args->listener_per_event_loop = true;
+        listener_count = aws_event_loop_group_get_loop_count(el_group);
+        connection_loop = aws_event_loop_group_get_loop_at(el_group, 0);
+
+        if (listener_count > 1) {
+            server_connection_args->extra_listeners =
+                aws_mem_calloc(allocator, listener_count - 1, sizeof(struct server_extra_listener));
+            if (!server_connection_args->extra_listeners) {
+                goto cleanup_server_connection_args;
+            }
+        }
+    } else {
+        connection_loop = aws_event_loop_group_get_next_loop(el_group);
+    }
+
+    server_connection_args->shards = aws_mem_calloc(allocator, listener_count, sizeof(struct server_channel_shard));
+    if (!server_connection_args->shards) {
         goto cleanup_server_connection_args;
     }
+    server_connection_args->shard_count = listener_count;
+    for (size_t i = 0; i < listener_count; ++i) {
+        aws_mutex_init(&server_connection_args->shards[i].lock);
+        aws_linked_list_init(&server_connection_args->shards[i].ready_channels);
+    }
 
     struct aws_socket_endpoint endpoint;
     AWS_ZERO_STRUCT(endpoint);
@@ -1376,12 +2684,21 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
     memcpy(endpoint.address, bootstrap_options->host_name, host_name_len);
     endpoint.port = bootstrap_options->port;
 
-    if (aws_socket_bind(&server_connection_args->listener, &endpoint)) {
-        goto cleanup_listener;
+    if (s_server_listener_open(&server_connection_args->listener, allocator, &socket_options, &endpoint)) {
+        goto cleanup_server_connection_args;
     }
 
-    if (aws_socket_listen(&server_connection_args->listener, 1024)) {
-        goto cleanup_listener;
+    /* open them all before accepting on any, so a port we can't share fails the call before a connection lands. */
+    struct server_extra_listener *extra_listeners = server_connection_args->extra_listeners;
+    for (; opened_count < listener_count - 1; ++opened_count) {
+        struct server_extra_listener *extra_listener = &extra_listeners[opened_count];
+        extra_listener->server_connection_args = server_connection_args;
+        aws_task_init(
+            &extra_listener->destroy_task, s_extra_listener_destroy_task, extra_listener, "listener socket destroy");
+
+        if (s_server_listener_open(&extra_listener->socket, allocator, &socket_options, &endpoint)) {
+            goto cleanup_listeners;
+        }
     }
 
     if (aws_socket_start_accept(
@@ -1389,12 +2706,36 @@ struct aws_socket *aws_server_bootstrap_new_socket_listener(
             connection_loop,
             s_on_server_connection_result,
             server_connection_args)) {
-        goto cleanup_listener;
+        goto cleanup_listeners;
+    }
+
+    for (; started_count < listener_count - 1; ++started_count) {
+        s_server_connection_args_acquire(server_connection_args);
+        if (aws_socket_start_accept(
+                &extra_listeners[started_count].socket,
+                aws_event_loop_group_get_loop_at(el_group, started_count + 1),
+                s_on_server_connection_result,
+                server_connection_args)) {
+            s_server_connection_args_release(server_connection_args);
+            goto stop_listeners;
+        }
     }
 
+    server_connection_args->extra_listener_count = listener_count - 1;
+
     return &server_connection_args->listener;
 
-cleanup_listener:
+stop_listeners:
+    for (size_t i = 0; i < started_count; ++i) {
+        aws_socket_stop_accept(&extra_listeners[i].socket);
+        s_server_connection_args_release(server_connection_args);
+    }
+    aws_socket_stop_accept(&server_connection_args->listener);
+
+cleanup_listeners:
+    for (size_t i = 0; i < opened_count; ++i) {
+        aws_socket_clean_up(&extra_listeners[i].socket);
+    }
     aws_socket_clean_up(&server_connection_args->listener);
 
 cleanup_server_connection_args:
@@ -1411,6 +2752,72 @@ void aws_server_bootstrap_destroy_socket_listener(struct aws_server_bootstrap *b
     aws_event_loop_schedule_task_now(listener->event_loop, &server_connection_args->listener_destroy_task);
 }
 
+int aws_server_bootstrap_drain_socket_listener(
+    struct aws_server_bootstrap *bootstrap,
+    struct aws_socket *listener,
+    const struct aws_server_bootstrap_drain_options *options) {
+    AWS_PRECONDITION(options);
+    struct server_connection_args *server_connection_args =
+        AWS_CONTAINER_OF(listener, struct server_connection_args, listener);
+
+    if (aws_atomic_exchange_int(&server_connection_args->drain_requested, 1)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: listener is already draining.", (void *)bootstrap);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_CHANNEL_BOOTSTRAP,
+        "id=%p: draining listener with %zu open channels.",
+        (void *)bootstrap,
+        aws_server_bootstrap_get_open_channel_count(listener));
+
+    /* the listener is gone by the time the drain tasks run, keep its loop. Set before any completion can use it. */
+    server_connection_args->drain_event_loop = listener->event_loop;
+    server_connection_args->drain_options = *options;
+
+    /* held until every shard has been looked at, so one emptying meanwhile can't complete the drain early. */
+    aws_atomic_store_int(&server_connection_args->drain_pending, 1);
+    for (size_t i = 0; i < server_connection_args->shard_count; ++i) {
+        struct server_channel_shard *shard = &server_connection_args->shards[i];
+        aws_mutex_lock(&shard->lock);
+        shard->draining = true;
+        for (struct aws_linked_list_node *node = aws_linked_list_begin(&shard->ready_channels);
+             node != aws_linked_list_end(&shard->ready_channels);
+             node = aws_linked_list_next(node)) {
+            struct server_channel_data *channel_data = AWS_CONTAINER_OF(node, struct server_channel_data, ready_node);
+            aws_channel_schedule_task_now(channel_data->channel, &channel_data->drain_task);
+        }
+        if (shard->open_channel_count) {
+            shard->drain_pending = true;
+            aws_atomic_fetch_add(&server_connection_args->drain_pending, 1);
+        }
+        aws_mutex_unlock(&shard->lock);
+    }
+
+    struct aws_event_loop *event_loop = server_connection_args->drain_event_loop;
+    s_server_connection_args_acquire(server_connection_args);
+    aws_event_loop_schedule_task_now(event_loop, &server_connection_args->drain_start_task);
+    s_drain_pending_release(server_connection_args);
+
+    aws_server_bootstrap_destroy_socket_listener(bootstrap, listener);
+    return AWS_OP_SUCCESS;
+}
+
+size_t aws_server_bootstrap_get_open_channel_count(struct aws_socket *listener) {
+    struct server_connection_args *server_connection_args =
+        AWS_CONTAINER_OF(listener, struct server_connection_args, listener);
+
+    size_t open_channel_count = 0;
+    for (size_t i = 0; i < server_connection_args->shard_count; ++i) {
+        struct server_channel_shard *shard = &server_connection_args->shards[i];
+        aws_mutex_lock(&shard->lock);
+        open_channel_count += shard->open_channel_count;
+        aws_mutex_unlock(&shard->lock);
+    }
+
+    return open_channel_count;
+}
+
 int aws_server_bootstrap_set_alpn_callback(
     struct aws_server_bootstrap *bootstrap,
     aws_channel_on_protocol_negotiated_fn *on_protocol_negotiated) {
@@ -1419,3 +2826,13 @@ int aws_server_bootstrap_set_alpn_callback(
     bootstrap->on_protocol_negotiated = on_protocol_negotiated;
     return AWS_OP_SUCCESS;
 }
+
+void aws_server_bootstrap_set_tracer(
+    struct aws_server_bootstrap *bootstrap,
+    const struct aws_connection_tracer *tracer) {
+    AWS_LOGF_DEBUG(AWS_LS_IO_CHANNEL_BOOTSTRAP, "id=%p: Setting connection tracer", (void *)bootstrap);
+    AWS_ZERO_STRUCT(bootstrap->tracer);
+    if (tracer) {
+        bootstrap->tracer = *tracer;
+    }
+}
@@ -0,0 +1,187 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/crc.h>
+
+#include <aws/common/cpuid.h>
+#include <aws/common/thread.h>
+
+#include <string.h>
+
+/*
+ * x86-64 has an instruction for CRC32C only (SSE4.2, checked for at runtime), ARMv8 has them for both polynomials
+ * when the compiler is allowed to use them. Everything else, and CRC32 on x86, uses slicing-by-8 tables.
+ */
+#if defined(__x86_64__) || defined(_M_X64)
+#    define AWS_IO_CRC32C_SSE42
+#    include <nmmintrin.h>
+#    if defined(__GNUC__) || defined(__clang__)
+#        define AWS_IO_TARGET_SSE42 __attribute__((target("sse4.2")))
+#    else
+#        define AWS_IO_TARGET_SSE42
+#    endif
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+#    define AWS_IO_CRC_ARMV8
+#    include <arm_acle.h>
+#endif
+
+/* both bit-reflected */
+#define AWS_IO_CRC32_POLYNOMIAL 0xEDB88320u
+#define AWS_IO_CRC32C_POLYNOMIAL 0x82F63B78u
+
+#ifndef AWS_IO_CRC_ARMV8
+#    define AWS_IO_CRC_SLICES 8
+
+static uint32_t s_crc32_table[AWS_IO_CRC_SLICES][256];
+static uint32_t s_crc32c_table[AWS_IO_CRC_SLICES][256];
+#    ifdef AWS_IO_CRC32C_SSE42
+static bool s_has_sse42 = false;
+#    endif
+static aws_thread_once s_crc_init_once = AWS_THREAD_ONCE_STATIC_INIT;
+
+static void s_init_table(uint32_t table[AWS_IO_CRC_SLICES][256], uint32_t polynomial) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (polynomial & (0u - (crc & 1u)));
+        }
+        table[0][i] = crc;
+    }
+
+    /* table[n][i] is the CRC of byte i followed by n zero bytes */
+    for (size_t slice = 1; slice < AWS_IO_CRC_SLICES; ++slice) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t previous = table[slice - 1][i];
+            table[slice][i] = (previous >> 8) ^ table[0][previous & 0xFF];
+        }
+    }
+}
+
+static void s_crc_init(void *user_data) {
+    (void)user_data;
+
+    s_init_table(s_crc32_table, AWS_IO_CRC32_POLYNOMIAL);
+    s_init_table(s_crc32c_table, AWS_IO_CRC32C_POLYNOMIAL);
+#    ifdef AWS_IO_CRC32C_SSE42
+    s_has_sse42 = aws_cpu_has_feature(AWS_CPU_FEATURE_SSE_4_2);
+#    endif
+}
+
+static uint32_t s_load_le32(const uint8_t *input) {
+    return (uint32_t)input[0] | ((uint32_t)input[1] << 8) | ((uint32_t)input[2] << 16) | ((uint32_t)input[3] << 24);
+}
+
+/* eight table lookups per 8 bytes, rather than 8 dependent lookups one byte at a time */
+static uint32_t s_crc_sliced(
+    uint32_t table[AWS_IO_CRC_SLICES][256],
+    const uint8_t *input,
+    size_t length,
+    uint32_t crc) {
+
+    while (length >= 8) {
+        uint32_t low = crc ^ s_load_le32(input);
+        uint32_t high = s_load_le32(input + 4);
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^ table[1][(high >> 16) & 0xFF] ^
+              table[0][high >> 24];
+        input += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *input) & 0xFF];
+        ++input;
+        --length;
+    }
+
+    return crc;
+}
+#endif /* !AWS_IO_CRC_ARMV8 */
+
+#ifdef AWS_IO_CRC32C_SSE42
+AWS_IO_TARGET_SSE42
+static uint32_t s_crc32c_sse42(const uint8_t *input, size_t length, uint32_t crc) {
+    while (length > 0 && ((uintptr_t)input & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *input);
+        ++input;
+        --length;
+    }
+
+    uint64_t crc64 = crc;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        input += 8;
+        length -= 8;
+    }
+    crc = (uint32_t)crc64;
+
+    while (length > 0) {
+        crc = _mm_crc32_u8(crc, *input);
+        ++input;
+        --length;
+    }
+
+    return crc;
+}
+#endif /* AWS_IO_CRC32C_SSE42 */
+
+#ifdef AWS_IO_CRC_ARMV8
+static uint32_t s_crc_armv8(const uint8_t *input, size_t length, uint32_t crc, bool castagnoli) {
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        crc = castagnoli ? __crc32cd(crc, word) : __crc32d(crc, word);
+        input += 8;
+        length -= 8;
+    }
+
+    while (length > 0) {
+        crc = castagnoli ? __crc32cb(crc, *input) : __crc32b(crc, *input);
+        ++input;
+        --length;
+    }
+
+    return crc;
+}
+#endif /* AWS_IO_CRC_ARMV8 */
+
+uint32_t aws_io_crc32(const uint8_t *input, size_t length, uint32_t previous_crc32) {
+    AWS_ASSERT(input || length == 0);
+
+    uint32_t crc = ~previous_crc32;
+
+#ifdef AWS_IO_CRC_ARMV8
+    crc = s_crc_armv8(input, length, crc, false);
+#else
+    aws_thread_call_once(&s_crc_init_once, s_crc_init, NULL);
+    crc = s_crc_sliced(s_crc32_table, input, length, crc);
+#endif
+
+    return ~crc;
+}
+
+uint32_t aws_io_crc32c(const uint8_t *input, size_t length, uint32_t previous_crc32c) {
+    AWS_ASSERT(input || length == 0);
+
+    uint32_t crc = ~previous_crc32c;
+
+#ifdef AWS_IO_CRC_ARMV8
+    crc = s_crc_armv8(input, length, crc, true);
+#else
+    aws_thread_call_once(&s_crc_init_once, s_crc_init, NULL);
+#    ifdef AWS_IO_CRC32C_SSE42
+    if (s_has_sse42) {
+        return ~s_crc32c_sse42(input, length, crc);
+    }
+#    endif
+    crc = s_crc_sliced(s_crc32c_table, input, length, crc);
+#endif
+
+    return ~crc;
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/cross_thread_task_queue.h>
+
+#include <aws/common/task_scheduler.h>
+
+void aws_cross_thread_task_queue_init(struct aws_cross_thread_task_queue *queue) {
+    aws_atomic_init_ptr(&queue->head, NULL);
+}
+
+bool aws_cross_thread_task_queue_push(struct aws_cross_thread_task_queue *queue, struct aws_task *task) {
+    struct aws_linked_list_node *node = &task->node;
+    node->prev = NULL;
+
+    void *expected_head = aws_atomic_load_ptr(&queue->head);
+    do {
+        node->next = expected_head;
+        /* on failure expected_head is updated with the current head, so just try again */
+    } while (!aws_atomic_compare_exchange_ptr(&queue->head, &expected_head, node));
+
+    return expected_head == NULL;
+}
+
+bool aws_cross_thread_task_queue_is_empty(struct aws_cross_thread_task_queue *queue) {
+    return aws_atomic_load_ptr(&queue->head) == NULL;
+}
+
+void aws_cross_thread_task_queue_pop_all(
+    struct aws_cross_thread_task_queue *queue,
+    struct aws_linked_list *out_list) {
+
+    struct aws_linked_list_node *node = aws_atomic_exchange_ptr(&queue->head, NULL);
+    if (node == NULL) {
+        return;
+    }
+
+    /* The chain is newest-first, reverse it into a list so tasks run in the order they were scheduled. */
+    struct aws_linked_list reversed;
+    aws_linked_list_init(&reversed);
+
+    while (node != NULL) {
+        struct aws_linked_list_node *older = node->next;
+        aws_linked_list_push_front(&reversed, node);
+        node = older;
+    }
+
+    while (!aws_linked_list_empty(&reversed)) {
+        aws_linked_list_push_back(out_list, aws_linked_list_pop_front(&reversed));
+    }
+}
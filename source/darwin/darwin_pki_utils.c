@@ -4,9 +4,11 @@
  */
 #include <aws/io/pki_utils.h>
 
+#include <aws/common/hash_table.h>
 #include <aws/common/mutex.h>
 #include <aws/io/logging.h>
 
+#include <CommonCrypto/CommonDigest.h>
 #include <Security/SecCertificate.h>
 #include <Security/SecKey.h>
 #include <Security/Security.h>
@@ -15,9 +17,155 @@
 /* https://developer.apple.com/documentation/security/certificate_key_and_trust_services/working_with_concurrency */
 static struct aws_mutex s_sec_mutex = AWS_MUTEX_INIT;
 
+/*
+ * Process-wide cache of what has been imported, keyed by a digest of the bytes it was imported from, so that creating
+ * many TLS contexts from the same certificates doesn't go to the Keychain each time. The cache keeps a retain on every
+ * array and each caller gets one of its own. An entry counts the callers holding its array and goes away when the last
+ * of them releases it with aws_release_identity() or aws_release_certificates().
+ */
+enum pki_import_kind {
+    PKI_IMPORT_KEY_PAIR,
+    PKI_IMPORT_PKCS12,
+    PKI_IMPORT_TRUSTED_CERTIFICATES,
+};
+
+struct pki_import_cache_entry {
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    /* the table's key, over digest */
+    struct aws_byte_cursor key;
+    CFArrayRef imported;
+    size_t users;
+};
+
+static struct aws_allocator *s_import_cache_allocator = NULL;
+/* held across a lookup and the import it saves, so everyone importing the same bytes waits for one import */
+static struct aws_mutex s_import_cache_lock = AWS_MUTEX_INIT;
+/* struct aws_byte_cursor * -> struct pki_import_cache_entry * */
+static struct aws_hash_table s_import_cache;
+
+static bool s_import_cache_key_eq(const void *a, const void *b) {
+    return aws_byte_cursor_eq(a, b);
+}
+
+static void s_import_cache_destroy_entry(void *value) {
+    struct pki_import_cache_entry *entry = value;
+    CFRelease(entry->imported);
+    aws_mem_release(s_import_cache_allocator, entry);
+}
+
+void aws_pki_init_import_cache(struct aws_allocator *alloc) {
+    s_import_cache_allocator = alloc;
+    AWS_FATAL_ASSERT(
+        !aws_hash_table_init(
+            &s_import_cache,
+            alloc,
+            4,
+            aws_hash_byte_cursor_ptr,
+            s_import_cache_key_eq,
+            NULL,
+            s_import_cache_destroy_entry) &&
+        "failed to initialize the pki import cache");
+}
+
+void aws_pki_clean_up_import_cache(void) {
+    aws_mutex_lock(&s_import_cache_lock);
+    aws_hash_table_clean_up(&s_import_cache);
+    s_import_cache_allocator = NULL;
+    aws_mutex_unlock(&s_import_cache_lock);
+}
+
+/* The digest covers the kind and each input with its length in front, so no two different imports share it. Only the
+ * digest is kept, the private key and password it was taken from aren't. */
+static int s_import_cache_digest(
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH],
+    enum pki_import_kind kind,
+    const struct aws_byte_cursor *first,
+    const struct aws_byte_cursor *second) {
+
+    if (s_import_cache_allocator == NULL) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    uint8_t header[1 + sizeof(uint64_t)];
+    struct aws_byte_buf header_buf = aws_byte_buf_from_empty_array(header, sizeof(header));
+    aws_byte_buf_write_u8(&header_buf, (uint8_t)kind);
+    aws_byte_buf_write_be64(&header_buf, first->len);
+
+    uint8_t second_len[sizeof(uint64_t)];
+    struct aws_byte_buf second_len_buf = aws_byte_buf_from_empty_array(second_len, sizeof(second_len));
+    aws_byte_buf_write_be64(&second_len_buf, second ? second->len : 0);
+
+    CC_SHA256_CTX sha256;
+    CC_SHA256_Init(&sha256);
+    CC_SHA256_Update(&sha256, header, (CC_LONG)sizeof(header));
+    CC_SHA256_Update(&sha256, first->ptr, (CC_LONG)first->len);
+    CC_SHA256_Update(&sha256, second_len, (CC_LONG)sizeof(second_len));
+    if (second && second->len) {
+        CC_SHA256_Update(&sha256, second->ptr, (CC_LONG)second->len);
+    }
+    CC_SHA256_Final(digest, &sha256);
+    aws_secure_zero(&sha256, sizeof(sha256));
+
+    return AWS_OP_SUCCESS;
+}
+
+/* on a hit, *imported gets a retain of its own */
+static bool s_import_cache_find(const uint8_t digest[CC_SHA256_DIGEST_LENGTH], CFArrayRef *imported) {
+    struct aws_byte_cursor key = aws_byte_cursor_from_array(digest, CC_SHA256_DIGEST_LENGTH);
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&s_import_cache, &key, &element);
+    if (element == NULL) {
+        return false;
+    }
+
+    struct pki_import_cache_entry *entry = element->value;
+    *imported = entry->imported;
+    CFRetain(*imported);
+    ++entry->users;
+    return true;
+}
+
+/* failing to cache only costs the next caller another import */
+static void s_import_cache_put(const uint8_t digest[CC_SHA256_DIGEST_LENGTH], CFArrayRef imported) {
+    struct pki_import_cache_entry *entry =
+        aws_mem_calloc(s_import_cache_allocator, 1, sizeof(struct pki_import_cache_entry));
+    if (entry == NULL) {
+        return;
+    }
+
+    memcpy(entry->digest, digest, CC_SHA256_DIGEST_LENGTH);
+    entry->key = aws_byte_cursor_from_array(entry->digest, CC_SHA256_DIGEST_LENGTH);
+    entry->imported = imported;
+    entry->users = 1;
+    CFRetain(imported);
+    if (aws_hash_table_put(&s_import_cache, &entry->key, entry, NULL)) {
+        s_import_cache_destroy_entry(entry);
+    }
+}
+
+/* one caller is done with imported: drops its entry once nobody else holds it */
+static void s_import_cache_release(CFArrayRef imported) {
+    aws_mutex_lock(&s_import_cache_lock);
+    if (s_import_cache_allocator != NULL) {
+        for (struct aws_hash_iter iter = aws_hash_iter_begin(&s_import_cache); !aws_hash_iter_done(&iter);
+             aws_hash_iter_next(&iter)) {
+            struct pki_import_cache_entry *entry = iter.element.value;
+            if (entry->imported == imported) {
+                if (--entry->users == 0) {
+                    aws_hash_iter_delete(&iter, true);
+                }
+                break;
+            }
+        }
+    }
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    CFRelease(imported);
+}
+
 #if !defined(AWS_OS_IOS)
 
-int aws_import_public_and_private_keys_to_identity(
+static int s_import_public_and_private_keys_to_identity(
     struct aws_allocator *alloc,
     CFAllocatorRef cf_alloc,
     const struct aws_byte_cursor *public_cert_chain,
@@ -143,9 +291,34 @@ done:
     return result;
 }
 
+int aws_import_public_and_private_keys_to_identity(
+    struct aws_allocator *alloc,
+    CFAllocatorRef cf_alloc,
+    const struct aws_byte_cursor *public_cert_chain,
+    const struct aws_byte_cursor *private_key,
+    CFArrayRef *identity) {
+
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    aws_mutex_lock(&s_import_cache_lock);
+
+    int result = AWS_OP_SUCCESS;
+    bool cacheable = !s_import_cache_digest(digest, PKI_IMPORT_KEY_PAIR, public_cert_chain, private_key);
+    if (!cacheable || !s_import_cache_find(digest, identity)) {
+        result =
+            s_import_public_and_private_keys_to_identity(alloc, cf_alloc, public_cert_chain, private_key, identity);
+        if (cacheable && result == AWS_OP_SUCCESS) {
+            s_import_cache_put(digest, *identity);
+        }
+    }
+
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    return result;
+}
+
 #endif /* AWS_OS_IOS */
 
-int aws_import_pkcs12_to_identity(
+static int s_import_pkcs12_to_identity(
     CFAllocatorRef cf_alloc,
     const struct aws_byte_cursor *pkcs12_cursor,
     const struct aws_byte_cursor *password,
@@ -191,7 +364,7 @@ int aws_import_pkcs12_to_identity(
     return AWS_OP_ERR;
 }
 
-int aws_import_trusted_certificates(
+static int s_import_trusted_certificates(
     struct aws_allocator *alloc,
     CFAllocatorRef cf_alloc,
     const struct aws_byte_cursor *certificates_blob,
@@ -236,10 +409,56 @@ int aws_import_trusted_certificates(
     return err;
 }
 
+int aws_import_pkcs12_to_identity(
+    CFAllocatorRef cf_alloc,
+    const struct aws_byte_cursor *pkcs12_cursor,
+    const struct aws_byte_cursor *password,
+    CFArrayRef *identity) {
+
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    aws_mutex_lock(&s_import_cache_lock);
+
+    int result = AWS_OP_SUCCESS;
+    bool cacheable = !s_import_cache_digest(digest, PKI_IMPORT_PKCS12, pkcs12_cursor, password);
+    if (!cacheable || !s_import_cache_find(digest, identity)) {
+        result = s_import_pkcs12_to_identity(cf_alloc, pkcs12_cursor, password, identity);
+        if (cacheable && result == AWS_OP_SUCCESS) {
+            s_import_cache_put(digest, *identity);
+        }
+    }
+
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    return result;
+}
+
+int aws_import_trusted_certificates(
+    struct aws_allocator *alloc,
+    CFAllocatorRef cf_alloc,
+    const struct aws_byte_cursor *certificates_blob,
+    CFArrayRef *certs) {
+
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH];
+    aws_mutex_lock(&s_import_cache_lock);
+
+    int result = AWS_OP_SUCCESS;
+    bool cacheable = !s_import_cache_digest(digest, PKI_IMPORT_TRUSTED_CERTIFICATES, certificates_blob, NULL);
+    if (!cacheable || !s_import_cache_find(digest, certs)) {
+        result = s_import_trusted_certificates(alloc, cf_alloc, certificates_blob, certs);
+        if (cacheable && result == AWS_OP_SUCCESS) {
+            s_import_cache_put(digest, *certs);
+        }
+    }
+
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    return result;
+}
+
 void aws_release_identity(CFArrayRef identity) {
-    CFRelease(identity);
+    s_import_cache_release(identity);
 }
 
 void aws_release_certificates(CFArrayRef certs) {
-    CFRelease(certs);
+    s_import_cache_release(certs);
 }
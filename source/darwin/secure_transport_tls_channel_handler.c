@@ -8,10 +8,12 @@
 #include <aws/io/file_utils.h>
 #include <aws/io/pki_utils.h>
 #include <aws/io/private/tls_channel_handler_shared.h>
+#include <aws/io/private/tls_session_cache.h>
 #include <aws/io/statistics.h>
 
 #include <aws/io/logging.h>
 
+#include <aws/common/atomics.h>
 #include <aws/common/encoding.h>
 #include <aws/common/string.h>
 #include <aws/common/task_scheduler.h>
@@ -23,6 +25,7 @@
 #include <Security/Security.h>
 #include <dlfcn.h>
 #include <math.h>
+#include <stdio.h>
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-variable"
@@ -68,7 +71,8 @@ bool aws_tls_is_cipher_pref_supported(enum aws_tls_cipher_pref cipher_pref) {
 }
 
 void aws_tls_init_static_state(struct aws_allocator *alloc) {
-    (void)alloc;
+    aws_pki_init_import_cache(alloc);
+
     /* keep from breaking users that built on later versions of the mac os sdk but deployed
      * to an older version. */
     s_SSLSetALPNProtocols = (OSStatus(*)(SSLContextRef, CFArrayRef))dlsym(RTLD_DEFAULT, "SSLSetALPNProtocols");
@@ -85,7 +89,8 @@ void aws_tls_init_static_state(struct aws_allocator *alloc) {
     }
 }
 
-void aws_tls_clean_up_static_state(void) { /* no op */
+void aws_tls_clean_up_static_state(void) {
+    aws_pki_clean_up_import_cache();
 }
 
 struct secure_transport_handler {
@@ -108,6 +113,7 @@ struct secure_transport_handler {
     aws_tls_on_error_fn *on_error;
     void *user_data;
     bool advertise_alpn_message;
+    aws_tls_on_protocol_negotiated on_protocol_negotiated;
     bool negotiation_finished;
     bool verify_peer;
     bool read_task_pending;
@@ -378,7 +384,17 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
                 secure_transport_handler->server_name_array);
         }
 
-        if (secure_transport_handler->parent_slot->adj_right && secure_transport_handler->advertise_alpn_message &&
+        if (secure_transport_handler->on_protocol_negotiated && protocol) {
+            if (aws_tls_install_negotiated_protocol_handler(
+                    secure_transport_handler->parent_slot,
+                    &secure_transport_handler->protocol,
+                    secure_transport_handler->on_protocol_negotiated,
+                    secure_transport_handler->user_data)) {
+                aws_channel_shutdown(secure_transport_handler->parent_slot->channel, aws_last_error());
+                return AWS_OP_SUCCESS;
+            }
+        } else if (
+            secure_transport_handler->parent_slot->adj_right && secure_transport_handler->advertise_alpn_message &&
             protocol) {
             struct aws_io_message *message = aws_channel_acquire_message_from_pool(
                 secure_transport_handler->parent_slot->channel,
@@ -523,6 +539,13 @@ static int s_process_write_message(
 
     struct secure_transport_handler *secure_transport_handler = handler->impl;
 
+    if (message->message_type == AWS_IO_MESSAGE_BORROWED_DATA) {
+        return aws_raise_error(AWS_IO_CHANNEL_UNKNOWN_MESSAGE_TYPE);
+    }
+
+    /* whoever releases it, this message holds plaintext */
+    message->is_sensitive = true;
+
     if (AWS_UNLIKELY(!secure_transport_handler->negotiation_finished)) {
         return aws_raise_error(AWS_IO_TLS_ERROR_NOT_NEGOTIATED);
     }
@@ -615,6 +638,7 @@ static int s_process_read_message(
         if (!outgoing_read_message) {
             return AWS_OP_ERR;
         }
+        outgoing_read_message->is_sensitive = true;
 
         size_t read = 0;
         status = SSLRead(
@@ -778,8 +802,43 @@ struct secure_transport_ctx {
     enum aws_tls_versions minimum_version;
     struct aws_string *alpn_list;
     bool veriify_peer;
+    bool session_cache_enabled;
+    /* process-unique, unlike the ctx's address which a later ctx could reuse. */
+    size_t session_cache_id;
 };
 
+static struct aws_atomic_var s_next_session_cache_id = AWS_ATOMIC_INIT_INT(1);
+
+/*
+ * Secure Transport resumes any session it cached under the same peer id. Scope the id to the aws_tls_ctx as well as
+ * server_name:port, so connections from ctxs with different identities or trust settings never share sessions.
+ */
+static void s_set_peer_id(
+    struct secure_transport_handler *handler,
+    struct aws_allocator *allocator,
+    struct aws_tls_connection_options *options) {
+    struct secure_transport_ctx *secure_transport_ctx = options->ctx->impl;
+
+    struct aws_string *key = aws_tls_session_cache_key_new(allocator, options->server_name, options->server_port);
+    if (!key) {
+        return;
+    }
+
+    char peer_id[512];
+    int peer_id_len = snprintf(
+        peer_id, sizeof(peer_id), "%zu/%s", secure_transport_ctx->session_cache_id, aws_string_c_str(key));
+    aws_string_destroy(key);
+
+    if (peer_id_len <= 0 || (size_t)peer_id_len >= sizeof(peer_id)) {
+        return;
+    }
+
+    if (SSLSetPeerID(handler->ctx, peer_id, (size_t)peer_id_len) != noErr) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS, "id=%p: failed to set peer id, session resumption is off.", (void *)&handler->handler);
+    }
+}
+
 static struct aws_channel_handler *s_tls_handler_new(
     struct aws_allocator *allocator,
     struct aws_tls_connection_options *options,
@@ -800,6 +859,7 @@ static struct aws_channel_handler *s_tls_handler_new(
     secure_transport_handler->handler.slot = slot;
     secure_transport_handler->wrapped_allocator = secure_transport_ctx->wrapped_allocator;
     secure_transport_handler->advertise_alpn_message = options->advertise_alpn_message;
+    secure_transport_handler->on_protocol_negotiated = options->on_protocol_negotiated;
     secure_transport_handler->on_data_read = options->on_data_read;
     secure_transport_handler->on_error = options->on_error;
     secure_transport_handler->on_negotiation_result = options->on_negotiation_result;
@@ -901,6 +961,10 @@ static struct aws_channel_handler *s_tls_handler_new(
     if (options->server_name) {
         size_t server_name_len = options->server_name->len;
         SSLSetPeerDomainName(secure_transport_handler->ctx, aws_string_c_str(options->server_name), server_name_len);
+
+        if (protocol_side == kSSLClientSide && secure_transport_ctx->session_cache_enabled) {
+            s_set_peer_id(secure_transport_handler, allocator, options);
+        }
     }
 
     struct aws_string *alpn_list = NULL;
@@ -994,6 +1058,8 @@ static struct aws_tls_ctx *s_tls_ctx_new(struct aws_allocator *alloc, const stru
     }
 
     secure_transport_ctx->veriify_peer = options->verify_peer;
+    secure_transport_ctx->session_cache_enabled = options->session_cache_max_entries > 0;
+    secure_transport_ctx->session_cache_id = aws_atomic_fetch_add(&s_next_session_cache_id, 1);
     secure_transport_ctx->ca_cert = NULL;
     secure_transport_ctx->certs = NULL;
     secure_transport_ctx->ctx.alloc = alloc;
@@ -0,0 +1,435 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/dns_message.h>
+
+#include <aws/common/math.h>
+
+#include <stdio.h>
+
+#define DNS_CLASS_IN 1
+#define DNS_MAX_LABEL_LEN 63
+/* wire size of a name, including every length octet and the terminating root label. */
+#define DNS_MAX_NAME_WIRE_LEN 255
+#define DNS_MAX_NAME_LEN 253
+/* no legitimate response needs more than this; it also bounds the work a hostile one can make us do. */
+#define DNS_MAX_CNAME_HOPS 8
+#define DNS_MAX_COMPRESSION_JUMPS 32
+
+#define DNS_FLAG_QR 0x8000
+#define DNS_FLAG_TC 0x0200
+#define DNS_FLAG_RD 0x0100
+#define DNS_OPCODE_MASK 0x7800
+#define DNS_RCODE_MASK 0x000F
+
+struct dns_record {
+    char name[DNS_MAX_NAME_LEN + 1];
+    size_t name_len;
+    uint16_t type;
+    uint16_t class;
+    uint32_t ttl;
+    /* offset of rdata within the message, names inside rdata may point back into it. */
+    size_t rdata_offset;
+    struct aws_byte_cursor rdata;
+};
+
+int aws_dns_message_encode_query(
+    struct aws_byte_buf *out,
+    uint16_t id,
+    struct aws_byte_cursor host_name,
+    enum aws_dns_record_type record_type) {
+
+    /* a single trailing dot just means the name is fully qualified, which every name we send is. */
+    if (host_name.len > 0 && host_name.ptr[host_name.len - 1] == '.') {
+        host_name.len -= 1;
+    }
+
+    if (host_name.len == 0 || host_name.len > DNS_MAX_NAME_LEN) {
+        return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+    }
+
+    /* header + name (one length octet per label, plus root) + qtype/qclass + an empty OPT record. */
+    size_t query_len = AWS_DNS_HEADER_SIZE + host_name.len + 2 + 4 + 11;
+    if (aws_byte_buf_reserve(out, out->len + query_len)) {
+        return AWS_OP_ERR;
+    }
+
+    size_t starting_len = out->len;
+    aws_byte_buf_write_be16(out, id);
+    aws_byte_buf_write_be16(out, DNS_FLAG_RD);
+    aws_byte_buf_write_be16(out, 1);
+    aws_byte_buf_write_be16(out, 0);
+    aws_byte_buf_write_be16(out, 0);
+    aws_byte_buf_write_be16(out, 1);
+
+    struct aws_byte_cursor label;
+    AWS_ZERO_STRUCT(label);
+    while (aws_byte_cursor_next_split(&host_name, '.', &label)) {
+        if (label.len == 0 || label.len > DNS_MAX_LABEL_LEN) {
+            out->len = starting_len;
+            return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+        }
+
+        aws_byte_buf_write_u8(out, (uint8_t)label.len);
+        aws_byte_buf_write_from_whole_cursor(out, label);
+    }
+    aws_byte_buf_write_u8(out, 0);
+
+    aws_byte_buf_write_be16(out, (uint16_t)record_type);
+    aws_byte_buf_write_be16(out, DNS_CLASS_IN);
+
+    /* OPT pseudo-record: root owner, the class field carries our udp payload size, ttl and rdata are empty. */
+    aws_byte_buf_write_u8(out, 0);
+    aws_byte_buf_write_be16(out, AWS_DNS_RECORD_TYPE_OPT);
+    aws_byte_buf_write_be16(out, AWS_DNS_EDNS_UDP_PAYLOAD_SIZE);
+    aws_byte_buf_write_be32(out, 0);
+    aws_byte_buf_write_be16(out, 0);
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_dns_response_init(struct aws_dns_response *response, struct aws_allocator *allocator) {
+    AWS_ZERO_STRUCT(*response);
+    return aws_array_list_init_dynamic(&response->addresses, allocator, 4, sizeof(struct aws_dns_address_record));
+}
+
+void aws_dns_response_clean_up(struct aws_dns_response *response) {
+    aws_array_list_clean_up(&response->addresses);
+    AWS_ZERO_STRUCT(*response);
+}
+
+int aws_dns_message_read_id(struct aws_byte_cursor message, uint16_t *out_id) {
+    if (message.len < AWS_DNS_HEADER_SIZE || !aws_byte_cursor_read_be16(&message, out_id)) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Decodes the (possibly compressed) name starting at *offset into out as dotted text and moves *offset past it.
+ * Compression pointers must point strictly backwards, so a hostile message can't send us around in circles.
+ */
+static int s_read_name(struct aws_byte_cursor message, size_t *offset, char *out, size_t *out_len) {
+    size_t position = *offset;
+    size_t name_len = 0;
+    size_t wire_len = 0;
+    size_t jumps = 0;
+    bool jumped = false;
+
+    while (true) {
+        if (position >= message.len) {
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+
+        uint8_t label_len = message.ptr[position];
+        if ((label_len & 0xC0) == 0xC0) {
+            if (position + 1 >= message.len || ++jumps > DNS_MAX_COMPRESSION_JUMPS) {
+                return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+            }
+
+            size_t target = ((size_t)(label_len & 0x3F) << 8) | message.ptr[position + 1];
+            if (target >= position) {
+                return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+            }
+
+            if (!jumped) {
+                *offset = position + 2;
+                jumped = true;
+            }
+            position = target;
+            continue;
+        }
+
+        if (label_len & 0xC0) {
+            /* the 01 and 10 prefixes were never deployed. */
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+
+        position += 1;
+        wire_len += 1 + label_len;
+        if (wire_len > DNS_MAX_NAME_WIRE_LEN) {
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+
+        if (label_len == 0) {
+            break;
+        }
+
+        if (position + label_len > message.len) {
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+
+        if (name_len > 0) {
+            out[name_len++] = '.';
+        }
+        if (name_len + label_len > DNS_MAX_NAME_LEN) {
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+        memcpy(out + name_len, message.ptr + position, label_len);
+        name_len += label_len;
+        position += label_len;
+    }
+
+    if (!jumped) {
+        *offset = position;
+    }
+
+    out[name_len] = 0;
+    *out_len = name_len;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_read_be16_at(struct aws_byte_cursor message, size_t *offset, uint16_t *out) {
+    if (*offset + 2 > message.len) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    *out = (uint16_t)((message.ptr[*offset] << 8) | message.ptr[*offset + 1]);
+    *offset += 2;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_read_be32_at(struct aws_byte_cursor message, size_t *offset, uint32_t *out) {
+    uint16_t high = 0;
+    uint16_t low = 0;
+    if (s_read_be16_at(message, offset, &high) || s_read_be16_at(message, offset, &low)) {
+        return AWS_OP_ERR;
+    }
+
+    *out = ((uint32_t)high << 16) | low;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_read_record(struct aws_byte_cursor message, size_t *offset, struct dns_record *record) {
+    uint16_t rdata_len = 0;
+    if (s_read_name(message, offset, record->name, &record->name_len) ||
+        s_read_be16_at(message, offset, &record->type) || s_read_be16_at(message, offset, &record->class) ||
+        s_read_be32_at(message, offset, &record->ttl) || s_read_be16_at(message, offset, &rdata_len)) {
+        return AWS_OP_ERR;
+    }
+
+    if (*offset + rdata_len > message.len) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    record->rdata_offset = *offset;
+    record->rdata = aws_byte_cursor_from_array(message.ptr + *offset, rdata_len);
+    *offset += rdata_len;
+
+    /* the top bit of a ttl is reserved, RFC 2181 says to treat such values as zero. */
+    if (record->ttl & 0x80000000) {
+        record->ttl = 0;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_name_eq(const char *name, size_t name_len, struct aws_byte_cursor other) {
+    struct aws_byte_cursor name_cur = aws_byte_cursor_from_array(name, name_len);
+    return aws_byte_cursor_eq_ignore_case(&name_cur, &other);
+}
+
+static void s_format_ipv4(const uint8_t *bytes, struct aws_dns_address_record *record) {
+    int written = snprintf(
+        record->address, sizeof(record->address), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    record->address_len = (size_t)written;
+}
+
+/* RFC 5952 form: lowercase, no leading zeros, and the longest run of two or more zero groups collapsed to "::". */
+static void s_format_ipv6(const uint8_t *bytes, struct aws_dns_address_record *record) {
+    uint16_t groups[8];
+    for (size_t i = 0; i < 8; ++i) {
+        groups[i] = (uint16_t)((bytes[i * 2] << 8) | bytes[i * 2 + 1]);
+    }
+
+    size_t best_start = 8;
+    size_t best_len = 0;
+    for (size_t i = 0; i < 8;) {
+        if (groups[i] != 0) {
+            ++i;
+            continue;
+        }
+
+        size_t run_start = i;
+        while (i < 8 && groups[i] == 0) {
+            ++i;
+        }
+        if (i - run_start > best_len) {
+            best_start = run_start;
+            best_len = i - run_start;
+        }
+    }
+
+    if (best_len < 2) {
+        best_start = 8;
+        best_len = 0;
+    }
+
+    size_t len = 0;
+    size_t capacity = sizeof(record->address);
+    for (size_t i = 0; i < 8; ++i) {
+        if (i == best_start) {
+            len += (size_t)snprintf(record->address + len, capacity - len, "::");
+            i += best_len - 1;
+            continue;
+        }
+
+        if (i > 0 && i != best_start + best_len) {
+            len += (size_t)snprintf(record->address + len, capacity - len, ":");
+        }
+        len += (size_t)snprintf(record->address + len, capacity - len, "%x", groups[i]);
+    }
+
+    record->address_len = len;
+}
+
+/* advances offset past count resource records, validating each one on the way. */
+static int s_skip_records(struct aws_byte_cursor message, size_t *offset, uint16_t count) {
+    struct dns_record record;
+    for (uint16_t i = 0; i < count; ++i) {
+        if (s_read_record(message, offset, &record)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_dns_message_decode_response(
+    struct aws_byte_cursor message,
+    struct aws_byte_cursor host_name,
+    enum aws_dns_record_type record_type,
+    struct aws_dns_response *response) {
+
+    if (host_name.len > 0 && host_name.ptr[host_name.len - 1] == '.') {
+        host_name.len -= 1;
+    }
+
+    size_t offset = 0;
+    uint16_t flags = 0;
+    uint16_t question_count = 0;
+    uint16_t answer_count = 0;
+    if (s_read_be16_at(message, &offset, &response->id) || s_read_be16_at(message, &offset, &flags) ||
+        s_read_be16_at(message, &offset, &question_count) || s_read_be16_at(message, &offset, &answer_count)) {
+        return AWS_OP_ERR;
+    }
+
+    if (!(flags & DNS_FLAG_QR) || (flags & DNS_OPCODE_MASK)) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    response->truncated = (flags & DNS_FLAG_TC) != 0;
+    response->rcode = (uint8_t)(flags & DNS_RCODE_MASK);
+    offset = AWS_DNS_HEADER_SIZE;
+
+    /* a truncated answer section is useless to us, the caller will retry over tcp. */
+    if (response->truncated) {
+        return AWS_OP_SUCCESS;
+    }
+
+    /* some servers drop the question from error responses, otherwise it has to be the one we asked. */
+    if (question_count == 0 && response->rcode != AWS_DNS_RCODE_NOERROR) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (question_count != 1) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    char name[DNS_MAX_NAME_LEN + 1];
+    size_t name_len = 0;
+    uint16_t question_type = 0;
+    uint16_t question_class = 0;
+    if (s_read_name(message, &offset, name, &name_len) || s_read_be16_at(message, &offset, &question_type) ||
+        s_read_be16_at(message, &offset, &question_class)) {
+        return AWS_OP_ERR;
+    }
+
+    if (!s_name_eq(name, name_len, host_name) || question_type != record_type || question_class != DNS_CLASS_IN) {
+        return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+    }
+
+    if (response->rcode != AWS_DNS_RCODE_NOERROR) {
+        return AWS_OP_SUCCESS;
+    }
+
+    size_t answers_offset = offset;
+    if (s_skip_records(message, &offset, answer_count)) {
+        return AWS_OP_ERR;
+    }
+
+    /* walk the CNAME chain from the name we asked about to the name that actually owns the addresses. */
+    char target[DNS_MAX_NAME_LEN + 1];
+    memcpy(target, host_name.ptr, host_name.len);
+    size_t target_len = host_name.len;
+    uint32_t chain_ttl = UINT32_MAX;
+    struct dns_record record;
+
+    for (size_t hop = 0; hop <= DNS_MAX_CNAME_HOPS; ++hop) {
+        bool followed = false;
+        offset = answers_offset;
+
+        for (uint16_t i = 0; i < answer_count; ++i) {
+            s_read_record(message, &offset, &record);
+            if (record.type != AWS_DNS_RECORD_TYPE_CNAME || record.class != DNS_CLASS_IN ||
+                !s_name_eq(record.name, record.name_len, aws_byte_cursor_from_array(target, target_len))) {
+                continue;
+            }
+
+            if (hop == DNS_MAX_CNAME_HOPS) {
+                return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+            }
+
+            size_t rdata_offset = record.rdata_offset;
+            if (s_read_name(message, &rdata_offset, target, &target_len)) {
+                return AWS_OP_ERR;
+            }
+
+            chain_ttl = aws_min_u32(chain_ttl, record.ttl);
+            followed = true;
+            break;
+        }
+
+        if (!followed) {
+            break;
+        }
+    }
+
+    enum aws_address_record_type address_type =
+        record_type == AWS_DNS_RECORD_TYPE_AAAA ? AWS_ADDRESS_RECORD_TYPE_AAAA : AWS_ADDRESS_RECORD_TYPE_A;
+    size_t address_len = record_type == AWS_DNS_RECORD_TYPE_AAAA ? 16 : 4;
+
+    offset = answers_offset;
+    for (uint16_t i = 0; i < answer_count; ++i) {
+        s_read_record(message, &offset, &record);
+        if (record.type != record_type || record.class != DNS_CLASS_IN ||
+            !s_name_eq(record.name, record.name_len, aws_byte_cursor_from_array(target, target_len))) {
+            continue;
+        }
+
+        if (record.rdata.len != address_len) {
+            return aws_raise_error(AWS_IO_DNS_QUERY_FAILED);
+        }
+
+        struct aws_dns_address_record address;
+        AWS_ZERO_STRUCT(address);
+        address.record_type = address_type;
+        /* an address can't outlive the aliases that led us to it. */
+        address.ttl_secs = aws_min_u32(chain_ttl, record.ttl);
+
+        if (address_type == AWS_ADDRESS_RECORD_TYPE_AAAA) {
+            s_format_ipv6(record.rdata.ptr, &address);
+        } else {
+            s_format_ipv4(record.rdata.ptr, &address);
+        }
+
+        if (aws_array_list_push_back(&response->addresses, &address)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
@@ -5,16 +5,29 @@
 
 #include <aws/io/event_loop.h>
 
+#include <aws/io/logging.h>
+#include <aws/io/private/metrics.h>
+
 #include <aws/common/clock.h>
+#include <aws/common/math.h>
 #include <aws/common/system_info.h>
 #include <aws/common/thread.h>
 
+struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    return aws_event_loop_new_default_with_options(alloc, &options);
+}
+
 static void s_event_loop_group_thread_exit(void *user_data) {
     struct aws_event_loop_group *el_group = user_data;
 
     aws_simple_completion_callback *completion_callback = el_group->shutdown_options.shutdown_callback_fn;
     void *completion_user_data = el_group->shutdown_options.shutdown_callback_user_data;
 
+    aws_mutex_clean_up(&el_group->lazy_start_lock);
     aws_mem_release(el_group->allocator, el_group);
 
     if (completion_callback != NULL) {
@@ -28,7 +41,7 @@ static void s_aws_event_loop_group_shutdown_sync(struct aws_event_loop_group *el
     while (aws_array_list_length(&el_group->event_loops) > 0) {
         struct aws_event_loop *loop = NULL;
 
-        if (!aws_array_list_back(&el_group->event_loops, &loop)) {
+        if (!aws_array_list_back(&el_group->event_loops, &loop) && loop) {
             aws_event_loop_destroy(loop);
         }
 
@@ -67,12 +80,89 @@ static void s_aws_event_loop_group_shutdown_async(struct aws_event_loop_group *e
     aws_thread_clean_up(&cleanup_thread);
 }
 
-struct aws_event_loop_group *aws_event_loop_group_new(
+typedef struct aws_event_loop *(s_new_event_loop_with_options_fn)(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options,
+    void *new_loop_user_data);
+
+/* Creates and runs the loop at index, whose entry must still be NULL. If cpu_ids is non-NULL, its thread is pinned to
+ * cpu_ids[index]. */
+static int s_event_loop_group_start_loop(
+    struct aws_event_loop_group *el_group,
+    size_t index,
+    aws_io_clock_fn *clock,
+    const int32_t *cpu_ids,
+    s_new_event_loop_with_options_fn *new_loop_fn,
+    void *new_loop_user_data) {
+
+    struct aws_thread_options thread_options = *aws_default_thread_options();
+    struct aws_event_loop_options options = {
+        .clock = clock,
+    };
+
+    if (cpu_ids) {
+        thread_options.cpu_id = cpu_ids[index];
+        options.thread_options = &thread_options;
+    }
+
+    struct aws_event_loop *loop = new_loop_fn(el_group->allocator, &options, new_loop_user_data);
+    if (!loop) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_event_loop_run(loop)) {
+        aws_event_loop_destroy(loop);
+        return AWS_OP_ERR;
+    }
+
+    aws_array_list_set_at(&el_group->event_loops, (const void *)&loop, index);
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_event_loop *s_default_new_event_loop(
+    struct aws_allocator *allocator,
+    const struct aws_event_loop_options *options,
+    void *user_data);
+
+/* Starts a lazy group's loops until wanted_count of them run. Returns how many run, fewer if one failed to start. */
+static size_t s_event_loop_group_start_lazily(struct aws_event_loop_group *el_group, size_t wanted_count) {
+    size_t started_count = aws_atomic_load_int(&el_group->started_loop_count);
+    if (!el_group->is_lazy || started_count >= wanted_count) {
+        return started_count;
+    }
+
+    aws_mutex_lock(&el_group->lazy_start_lock);
+    started_count = aws_atomic_load_int(&el_group->started_loop_count);
+    while (started_count < wanted_count) {
+        if (s_event_loop_group_start_loop(
+                el_group, started_count, aws_high_res_clock_get_ticks, NULL, s_default_new_event_loop, NULL)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to start event loop %zu of a lazy group, error %s",
+                (void *)el_group,
+                started_count,
+                aws_error_debug_str(aws_last_error()));
+            break;
+        }
+
+        /* published only once its entry is set, readers never look past started_loop_count */
+        aws_atomic_store_int(&el_group->started_loop_count, ++started_count);
+    }
+    aws_mutex_unlock(&el_group->lazy_start_lock);
+
+    return started_count;
+}
+
+/* If cpu_ids is non-NULL it holds el_count entries, and the thread of loop i is pinned to cpu_ids[i]. A lazy group
+ * starts none of its loops here. */
+static struct aws_event_loop_group *s_event_loop_group_new(
     struct aws_allocator *alloc,
     aws_io_clock_fn *clock,
     uint16_t el_count,
-    aws_new_event_loop_fn *new_loop_fn,
+    const int32_t *cpu_ids,
+    s_new_event_loop_with_options_fn *new_loop_fn,
     void *new_loop_user_data,
+    bool is_lazy,
     const struct aws_shutdown_callback_options *shutdown_options) {
 
     AWS_ASSERT(new_loop_fn);
@@ -86,26 +176,32 @@ struct aws_event_loop_group *aws_event_loop_group_new(
     aws_ref_count_init(
         &el_group->ref_count, el_group, (aws_simple_completion_callback *)s_aws_event_loop_group_shutdown_async);
     aws_atomic_init_int(&el_group->current_index, 0);
+    aws_atomic_init_int(&el_group->selection_policy, AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN);
+    aws_atomic_init_int(&el_group->selection_seed, 0);
+    aws_atomic_init_int(&el_group->started_loop_count, 0);
+    el_group->is_lazy = is_lazy;
+    if (aws_mutex_init(&el_group->lazy_start_lock)) {
+        aws_mem_release(alloc, el_group);
+        return NULL;
+    }
 
     if (aws_array_list_init_dynamic(&el_group->event_loops, alloc, el_count, sizeof(struct aws_event_loop *))) {
         goto on_error;
     }
 
+    /* every entry exists from the start, so a lazy group fills them in without the list ever moving */
+    struct aws_event_loop *no_loop = NULL;
     for (uint16_t i = 0; i < el_count; ++i) {
-        struct aws_event_loop *loop = new_loop_fn(alloc, clock, new_loop_user_data);
-
-        if (!loop) {
-            goto on_error;
-        }
-
-        if (aws_array_list_push_back(&el_group->event_loops, (const void *)&loop)) {
-            aws_event_loop_destroy(loop);
-            goto on_error;
-        }
+        aws_array_list_push_back(&el_group->event_loops, (const void *)&no_loop);
+    }
 
-        if (aws_event_loop_run(loop)) {
-            goto on_error;
+    if (!is_lazy) {
+        for (uint16_t i = 0; i < el_count; ++i) {
+            if (s_event_loop_group_start_loop(el_group, i, clock, cpu_ids, new_loop_fn, new_loop_user_data)) {
+                goto on_error;
+            }
         }
+        aws_atomic_store_int(&el_group->started_loop_count, el_count);
     }
 
     if (shutdown_options != NULL) {
@@ -124,13 +220,47 @@ on_error:
     return NULL;
 }
 
-static struct aws_event_loop *default_new_event_loop(
-    struct aws_allocator *allocator,
+struct new_loop_fn_adapter {
+    aws_new_event_loop_fn *new_loop_fn;
+    void *new_loop_user_data;
+};
+
+static struct aws_event_loop *s_adapted_new_event_loop(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options,
+    void *new_loop_user_data) {
+
+    struct new_loop_fn_adapter *adapter = new_loop_user_data;
+    return adapter->new_loop_fn(alloc, options->clock, adapter->new_loop_user_data);
+}
+
+struct aws_event_loop_group *aws_event_loop_group_new(
+    struct aws_allocator *alloc,
     aws_io_clock_fn *clock,
+    uint16_t el_count,
+    aws_new_event_loop_fn *new_loop_fn,
+    void *new_loop_user_data,
+    const struct aws_shutdown_callback_options *shutdown_options) {
+
+    AWS_ASSERT(new_loop_fn);
+
+    /* loops are created synchronously, so the adapter can live on the stack */
+    struct new_loop_fn_adapter adapter = {
+        .new_loop_fn = new_loop_fn,
+        .new_loop_user_data = new_loop_user_data,
+    };
+
+    return s_event_loop_group_new(
+        alloc, clock, el_count, NULL, s_adapted_new_event_loop, &adapter, false, shutdown_options);
+}
+
+static struct aws_event_loop *s_default_new_event_loop(
+    struct aws_allocator *allocator,
+    const struct aws_event_loop_options *options,
     void *user_data) {
 
     (void)user_data;
-    return aws_event_loop_new_default(allocator, clock);
+    return aws_event_loop_new_default_with_options(allocator, options);
 }
 
 struct aws_event_loop_group *aws_event_loop_group_new_default(
@@ -141,8 +271,105 @@ struct aws_event_loop_group *aws_event_loop_group_new_default(
         max_threads = (uint16_t)aws_system_info_processor_count();
     }
 
-    return aws_event_loop_group_new(
-        alloc, aws_high_res_clock_get_ticks, max_threads, default_new_event_loop, NULL, shutdown_options);
+    return s_event_loop_group_new(
+        alloc,
+        aws_high_res_clock_get_ticks,
+        max_threads,
+        NULL,
+        s_default_new_event_loop,
+        NULL,
+        false,
+        shutdown_options);
+}
+
+struct aws_event_loop_group *aws_event_loop_group_new_default_lazy(
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    const struct aws_shutdown_callback_options *shutdown_options) {
+    if (!max_threads) {
+        max_threads = (uint16_t)aws_system_info_processor_count();
+    }
+
+    return s_event_loop_group_new(
+        alloc, aws_high_res_clock_get_ticks, max_threads, NULL, s_default_new_event_loop, NULL, true, shutdown_options);
+}
+
+struct aws_event_loop_group *aws_event_loop_group_new_default_pinned_to_cpu_group(
+    struct aws_allocator *alloc,
+    uint16_t max_threads,
+    uint16_t cpu_group,
+    const struct aws_shutdown_callback_options *shutdown_options) {
+
+    size_t cpu_count = aws_get_cpu_count_for_group(cpu_group);
+    if (cpu_count == 0 || cpu_count > UINT16_MAX) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_cpu_info *cpu_infos = aws_mem_calloc(alloc, cpu_count, sizeof(struct aws_cpu_info));
+    if (!cpu_infos) {
+        return NULL;
+    }
+
+    int32_t *cpu_ids = aws_mem_calloc(alloc, cpu_count, sizeof(int32_t));
+    if (!cpu_ids) {
+        aws_mem_release(alloc, cpu_infos);
+        return NULL;
+    }
+
+    aws_get_cpu_ids_for_group(cpu_group, cpu_infos, cpu_count);
+
+    /* Two loops sharing a physical core just fight over it, so prefer one loop per core. */
+    uint16_t el_count = 0;
+    for (size_t i = 0; i < cpu_count && (max_threads == 0 || el_count < max_threads); ++i) {
+        if (!cpu_infos[i].suspected_hyper_thread) {
+            cpu_ids[el_count++] = cpu_infos[i].cpu_id;
+        }
+    }
+
+    /* if every cpu looked like a hyper-thread, the detection is not helping; use them all */
+    if (el_count == 0) {
+        for (size_t i = 0; i < cpu_count && (max_threads == 0 || el_count < max_threads); ++i) {
+            cpu_ids[el_count++] = cpu_infos[i].cpu_id;
+        }
+    }
+
+    struct aws_event_loop_group *el_group = s_event_loop_group_new(
+        alloc,
+        aws_high_res_clock_get_ticks,
+        el_count,
+        cpu_ids,
+        s_default_new_event_loop,
+        NULL,
+        false,
+        shutdown_options);
+
+    aws_mem_release(alloc, cpu_ids);
+    aws_mem_release(alloc, cpu_infos);
+
+    return el_group;
+}
+
+struct aws_event_loop_group *aws_event_loop_group_new_default_pinned_to_cpus(
+    struct aws_allocator *alloc,
+    const int32_t *cpu_ids,
+    uint16_t cpu_count,
+    const struct aws_shutdown_callback_options *shutdown_options) {
+
+    if (!cpu_ids || cpu_count == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    return s_event_loop_group_new(
+        alloc,
+        aws_high_res_clock_get_ticks,
+        cpu_count,
+        cpu_ids,
+        s_default_new_event_loop,
+        NULL,
+        false,
+        shutdown_options);
 }
 
 struct aws_event_loop_group *aws_event_loop_group_acquire(struct aws_event_loop_group *el_group) {
@@ -163,19 +390,29 @@ size_t aws_event_loop_group_get_loop_count(struct aws_event_loop_group *el_group
     return aws_array_list_length(&el_group->event_loops);
 }
 
+size_t aws_event_loop_group_get_started_loop_count(struct aws_event_loop_group *el_group) {
+    return aws_atomic_load_int(&el_group->started_loop_count);
+}
+
 struct aws_event_loop *aws_event_loop_group_get_loop_at(struct aws_event_loop_group *el_group, size_t index) {
+    if (s_event_loop_group_start_lazily(el_group, index + 1) <= index) {
+        return NULL;
+    }
+
     struct aws_event_loop *el = NULL;
     aws_array_list_get_at(&el_group->event_loops, &el, index);
     return el;
 }
 
-struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group) {
-    size_t loop_count = aws_array_list_length(&el_group->event_loops);
-    AWS_ASSERT(loop_count > 0);
-    if (loop_count == 0) {
-        return NULL;
-    }
+void aws_event_loop_group_set_selection_policy(
+    struct aws_event_loop_group *el_group,
+    enum aws_event_loop_selection_policy policy) {
+
+    AWS_ASSERT(el_group);
+    aws_atomic_store_int(&el_group->selection_policy, (size_t)policy);
+}
 
+static struct aws_event_loop *s_get_next_loop_round_robin(struct aws_event_loop_group *el_group, size_t loop_count) {
     /* thread safety: atomic CAS to ensure we got the best loop, and that the index is within bounds */
     size_t old_index = 0;
     size_t new_index = 0;
@@ -191,6 +428,240 @@ struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_
     return loop;
 }
 
+/* Returns true if loop `a` should be preferred over loop `b`. Busy time is the primary signal; the subscribed handle
+ * count breaks ties, which matters mostly for idle loops whose busy time rounds to 0. */
+static bool s_is_less_loaded(struct aws_event_loop *a, struct aws_event_loop *b) {
+    size_t load_a = aws_event_loop_get_load_factor(a);
+    size_t load_b = aws_event_loop_get_load_factor(b);
+    if (load_a != load_b) {
+        return load_a < load_b;
+    }
+
+    return aws_atomic_load_int(&a->load.subscribed_handle_count) <
+           aws_atomic_load_int(&b->load.subscribed_handle_count);
+}
+
+/* A splitmix64 step over a shared counter: cheap, lock-free, and plenty random for picking loops. Avoids hitting the
+ * OS entropy source on every connection. */
+static uint64_t s_next_selection_random(struct aws_event_loop_group *el_group) {
+    uint64_t x = (uint64_t)aws_atomic_fetch_add(&el_group->selection_seed, 1) + 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static struct aws_event_loop *s_get_next_loop_power_of_two_choices(
+    struct aws_event_loop_group *el_group,
+    size_t loop_count) {
+
+    uint64_t random_num = s_next_selection_random(el_group);
+    size_t index_a = (size_t)((random_num & 0xFFFFFFFF) % loop_count);
+    size_t index_b = (size_t)((random_num >> 32) % loop_count);
+
+    struct aws_event_loop *loop_a = NULL;
+    struct aws_event_loop *loop_b = NULL;
+    aws_array_list_get_at(&el_group->event_loops, &loop_a, index_a);
+    aws_array_list_get_at(&el_group->event_loops, &loop_b, index_b);
+
+    return s_is_less_loaded(loop_b, loop_a) ? loop_b : loop_a;
+}
+
+static struct aws_event_loop *s_get_next_loop_least_loaded(struct aws_event_loop_group *el_group, size_t loop_count) {
+    /* start the scan at a rotating offset so ties don't all land on the first loop */
+    size_t start = (size_t)(s_next_selection_random(el_group) % loop_count);
+
+    struct aws_event_loop *best_loop = NULL;
+    aws_array_list_get_at(&el_group->event_loops, &best_loop, start);
+
+    for (size_t i = 1; i < loop_count; ++i) {
+        struct aws_event_loop *loop = NULL;
+        aws_array_list_get_at(&el_group->event_loops, &loop, (start + i) % loop_count);
+        if (s_is_less_loaded(loop, best_loop)) {
+            best_loop = loop;
+        }
+    }
+
+    return best_loop;
+}
+
+struct aws_event_loop *aws_event_loop_group_get_next_loop(struct aws_event_loop_group *el_group) {
+    size_t loop_count = aws_atomic_load_int(&el_group->started_loop_count);
+
+    /* until all its loops run, a lazy group hands out a new one each time rather than adding to an existing one */
+    if (el_group->is_lazy && loop_count < aws_array_list_length(&el_group->event_loops)) {
+        size_t started_count = s_event_loop_group_start_lazily(el_group, loop_count + 1);
+        if (started_count > loop_count) {
+            struct aws_event_loop *loop = NULL;
+            aws_array_list_get_at(&el_group->event_loops, &loop, started_count - 1);
+            return loop;
+        }
+    }
+
+    if (loop_count == 0) {
+        /* only a lazy group whose first loop failed to start has none, and that failure's error is still raised */
+        AWS_ASSERT(el_group->is_lazy);
+        return NULL;
+    }
+
+    switch ((enum aws_event_loop_selection_policy)aws_atomic_load_int(&el_group->selection_policy)) {
+        case AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES:
+            return s_get_next_loop_power_of_two_choices(el_group, loop_count);
+        case AWS_EVENT_LOOP_SELECTION_LEAST_LOADED:
+            return s_get_next_loop_least_loaded(el_group, loop_count);
+        case AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN:
+        default:
+            return s_get_next_loop_round_robin(el_group, loop_count);
+    }
+}
+
+struct aws_event_loop_profiler {
+    struct aws_allocator *allocator;
+    struct aws_event_loop_profiler_options options;
+    /* type_tag (by content, the same tag is often several string literals) -> struct aws_event_loop_task_type_stats */
+    struct aws_hash_table type_stats;
+    /* the slowest work of the current tick, slowest first */
+    struct aws_event_loop_profiler_entry slowest[AWS_EVENT_LOOP_PROFILER_SLOWEST_COUNT];
+    size_t slowest_count;
+};
+
+static void s_profiler_clear_type_stats(struct aws_event_loop_profiler *profiler) {
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&profiler->type_stats); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        aws_mem_release(profiler->allocator, iter.element.value);
+    }
+
+    aws_hash_table_clear(&profiler->type_stats);
+}
+
+int aws_event_loop_enable_profiler(
+    struct aws_event_loop *event_loop,
+    const struct aws_event_loop_profiler_options *options) {
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
+    AWS_ASSERT(options);
+
+    struct aws_event_loop_profiler *profiler = event_loop->profiler;
+    if (profiler) {
+        s_profiler_clear_type_stats(profiler);
+    } else {
+        profiler = aws_mem_calloc(event_loop->alloc, 1, sizeof(struct aws_event_loop_profiler));
+        if (!profiler) {
+            return AWS_OP_ERR;
+        }
+
+        profiler->allocator = event_loop->alloc;
+        if (aws_hash_table_init(
+                &profiler->type_stats,
+                event_loop->alloc,
+                16,
+                aws_hash_c_string,
+                aws_hash_callback_c_str_eq,
+                NULL,
+                NULL)) {
+            aws_mem_release(event_loop->alloc, profiler);
+            return AWS_OP_ERR;
+        }
+    }
+
+    profiler->options = *options;
+    profiler->slowest_count = 0;
+    event_loop->profiler = profiler;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_event_loop_disable_profiler(struct aws_event_loop *event_loop) {
+    struct aws_event_loop_profiler *profiler = event_loop->profiler;
+    if (!profiler) {
+        return;
+    }
+
+    event_loop->profiler = NULL;
+    s_profiler_clear_type_stats(profiler);
+    aws_hash_table_clean_up(&profiler->type_stats);
+    aws_mem_release(profiler->allocator, profiler);
+}
+
+void aws_event_loop_profiler_for_each_type(
+    struct aws_event_loop *event_loop,
+    aws_event_loop_on_task_type_stats_fn *on_stats,
+    void *user_data) {
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
+
+    struct aws_event_loop_profiler *profiler = event_loop->profiler;
+    if (!profiler) {
+        return;
+    }
+
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&profiler->type_stats); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        on_stats(iter.element.value, user_data);
+    }
+}
+
+uint64_t aws_event_loop_profiler_begin(struct aws_event_loop *event_loop) {
+    if (AWS_LIKELY(!event_loop->profiler)) {
+        return 0;
+    }
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    return now;
+}
+
+void aws_event_loop_profiler_end(struct aws_event_loop *event_loop, const char *type_tag, uint64_t start_ns) {
+    struct aws_event_loop_profiler *profiler = event_loop->profiler;
+    /* a start of 0 means the profiler was enabled by the work itself */
+    if (AWS_LIKELY(!profiler) || start_ns == 0) {
+        return;
+    }
+
+    uint64_t now = 0;
+    aws_high_res_clock_get_ticks(&now);
+    uint64_t duration_ns = now > start_ns ? now - start_ns : 0;
+    if (!type_tag) {
+        type_tag = "untagged";
+    }
+
+    struct aws_hash_element *element = NULL;
+    int was_created = 0;
+    if (aws_hash_table_create(&profiler->type_stats, type_tag, &element, &was_created)) {
+        return;
+    }
+
+    if (was_created) {
+        struct aws_event_loop_task_type_stats *new_stats =
+            aws_mem_calloc(profiler->allocator, 1, sizeof(struct aws_event_loop_task_type_stats));
+        if (!new_stats) {
+            aws_hash_table_remove_element(&profiler->type_stats, element);
+            return;
+        }
+        new_stats->type_tag = type_tag;
+        element->value = new_stats;
+    }
+
+    struct aws_event_loop_task_type_stats *stats = element->value;
+    stats->run_count++;
+    stats->total_duration_ns += duration_ns;
+    stats->max_duration_ns = aws_max_u64(stats->max_duration_ns, duration_ns);
+
+    /* insertion into the short, sorted list of the tick's slowest work */
+    size_t position = profiler->slowest_count;
+    while (position > 0 && profiler->slowest[position - 1].duration_ns < duration_ns) {
+        if (position < AWS_EVENT_LOOP_PROFILER_SLOWEST_COUNT) {
+            profiler->slowest[position] = profiler->slowest[position - 1];
+        }
+        --position;
+    }
+
+    if (position < AWS_EVENT_LOOP_PROFILER_SLOWEST_COUNT) {
+        profiler->slowest[position].type_tag = type_tag;
+        profiler->slowest[position].duration_ns = duration_ns;
+        if (profiler->slowest_count < AWS_EVENT_LOOP_PROFILER_SLOWEST_COUNT) {
+            profiler->slowest_count++;
+        }
+    }
+}
+
 static void s_object_removed(void *value) {
     struct aws_event_loop_local_object *object = (struct aws_event_loop_local_object *)value;
     if (object->on_object_removed) {
@@ -204,15 +675,120 @@ int aws_event_loop_init_base(struct aws_event_loop *event_loop, struct aws_alloc
     event_loop->alloc = alloc;
     event_loop->clock = clock;
 
+    aws_atomic_init_int(&event_loop->load.load_factor, 0);
+    aws_atomic_init_int(&event_loop->load.next_flush_time_secs, 0);
+    aws_atomic_init_int(&event_loop->load.last_tick_duration_ns, 0);
+    aws_atomic_init_int(&event_loop->load.last_wait_duration_ns, 0);
+    aws_atomic_init_int(&event_loop->load.last_tick_io_event_count, 0);
+    aws_atomic_init_int(&event_loop->load.subscribed_handle_count, 0);
+
+    event_loop->metrics_shard = aws_io_metrics_shard_new(alloc);
+    if (!event_loop->metrics_shard) {
+        return AWS_OP_ERR;
+    }
+
     if (aws_hash_table_init(&event_loop->local_data, alloc, 20, aws_hash_ptr, aws_ptr_eq, NULL, s_object_removed)) {
+        aws_io_metrics_shard_destroy(event_loop->metrics_shard);
+        event_loop->metrics_shard = NULL;
         return AWS_OP_ERR;
     }
 
     return AWS_OP_SUCCESS;
 }
 
+void aws_event_loop_register_tick_start(struct aws_event_loop *event_loop) {
+    uint64_t start_tick = 0;
+    aws_high_res_clock_get_ticks(&start_tick);
+
+    /* the first tick has no preceding wait */
+    if (event_loop->load.latest_tick_end != 0 && start_tick >= event_loop->load.latest_tick_end) {
+        uint64_t waited = start_tick - event_loop->load.latest_tick_end;
+        aws_atomic_store_int(&event_loop->load.last_wait_duration_ns, (size_t)aws_min_u64(waited, SIZE_MAX));
+    }
+
+    event_loop->load.latest_tick_start = start_tick;
+
+    /* every implementation ticks on its own thread, this is the one place they all call that runs there */
+    aws_io_metrics_set_thread_shard(event_loop->metrics_shard);
+
+    if (event_loop->profiler) {
+        event_loop->profiler->slowest_count = 0;
+    }
+}
+
+void aws_event_loop_register_tick_end(struct aws_event_loop *event_loop, size_t io_event_count) {
+    uint64_t end_tick = 0;
+    aws_high_res_clock_get_ticks(&end_tick);
+
+    uint64_t tick_start = event_loop->load.latest_tick_start;
+    size_t elapsed = (size_t)aws_min_u64(end_tick > tick_start ? end_tick - tick_start : 0, SIZE_MAX);
+    event_loop->load.current_tick_latency_sum =
+        aws_add_size_saturating(event_loop->load.current_tick_latency_sum, elapsed);
+    event_loop->load.latest_tick_end = end_tick;
+
+    aws_atomic_store_int(&event_loop->load.last_tick_duration_ns, elapsed);
+    aws_atomic_store_int(&event_loop->load.last_tick_io_event_count, io_event_count);
+
+    /* publish the busy time once per second, so readers see a whole window rather than a partial one */
+    size_t next_flush_time_secs = aws_atomic_load_int(&event_loop->load.next_flush_time_secs);
+    uint64_t end_tick_secs = aws_timestamp_convert(end_tick, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+    if (end_tick_secs > next_flush_time_secs) {
+        aws_atomic_store_int(&event_loop->load.load_factor, event_loop->load.current_tick_latency_sum);
+        event_loop->load.current_tick_latency_sum = 0;
+        aws_atomic_store_int(&event_loop->load.next_flush_time_secs, (size_t)end_tick_secs + 1);
+    }
+
+    struct aws_event_loop_profiler *profiler = event_loop->profiler;
+    if (profiler && profiler->options.on_slow_tick && profiler->options.slow_tick_threshold_ns &&
+        elapsed >= profiler->options.slow_tick_threshold_ns) {
+        struct aws_event_loop_slow_tick_report report = {
+            .tick_duration_ns = elapsed,
+            .io_event_count = io_event_count,
+            .slowest = profiler->slowest,
+            .slowest_count = profiler->slowest_count,
+        };
+
+        /* last thing here: the callback may disable the profiler */
+        profiler->options.on_slow_tick(event_loop, &report, profiler->options.user_data);
+    }
+}
+
+size_t aws_event_loop_get_load_factor(struct aws_event_loop *event_loop) {
+    uint64_t current_time = 0;
+    aws_high_res_clock_get_ticks(&current_time);
+    uint64_t current_time_secs = aws_timestamp_convert(current_time, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+    size_t next_flush_time_secs = aws_atomic_load_int(&event_loop->load.next_flush_time_secs);
+
+    /* a loop that was busy and then went quiet (blocked in a long wait) hasn't flushed; don't keep reporting it busy */
+    if (current_time_secs > (uint64_t)next_flush_time_secs + 1) {
+        return 0;
+    }
+
+    return aws_atomic_load_int(&event_loop->load.load_factor);
+}
+
+void aws_event_loop_get_load_metrics(struct aws_event_loop *event_loop, struct aws_event_loop_load_metrics *metrics) {
+    AWS_ASSERT(metrics);
+
+    metrics->last_tick_duration_ns = aws_atomic_load_int(&event_loop->load.last_tick_duration_ns);
+    metrics->last_wait_duration_ns = aws_atomic_load_int(&event_loop->load.last_wait_duration_ns);
+    metrics->last_tick_io_event_count = aws_atomic_load_int(&event_loop->load.last_tick_io_event_count);
+    metrics->subscribed_handle_count = aws_atomic_load_int(&event_loop->load.subscribed_handle_count);
+    metrics->load_factor = aws_event_loop_get_load_factor(event_loop);
+}
+
 void aws_event_loop_clean_up_base(struct aws_event_loop *event_loop) {
+    aws_event_loop_disable_profiler(event_loop);
     aws_hash_table_clean_up(&event_loop->local_data);
+    for (size_t i = 0; i < AWS_EVENT_LOOP_LOCAL_SLOT_COUNT; ++i) {
+        struct aws_event_loop_local_object *object = event_loop->local_slots[i];
+        event_loop->local_slots[i] = NULL;
+        if (object) {
+            s_object_removed(object);
+        }
+    }
+    aws_io_metrics_shard_destroy(event_loop->metrics_shard);
+    event_loop->metrics_shard = NULL;
 }
 
 void aws_event_loop_destroy(struct aws_event_loop *event_loop) {
@@ -282,6 +858,27 @@ int aws_event_loop_remove_local_object(
     return AWS_OP_ERR;
 }
 
+struct aws_event_loop_local_object *aws_event_loop_get_local_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_slot slot) {
+
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
+    AWS_ASSERT(slot < AWS_EVENT_LOOP_LOCAL_SLOT_COUNT);
+
+    return event_loop->local_slots[slot];
+}
+
+void aws_event_loop_set_local_slot(
+    struct aws_event_loop *event_loop,
+    enum aws_event_loop_local_slot slot,
+    struct aws_event_loop_local_object *obj) {
+
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
+    AWS_ASSERT(slot < AWS_EVENT_LOOP_LOCAL_SLOT_COUNT);
+
+    event_loop->local_slots[slot] = obj;
+}
+
 int aws_event_loop_run(struct aws_event_loop *event_loop) {
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->run);
     return event_loop->vtable->run(event_loop);
@@ -328,7 +925,12 @@ int aws_event_loop_connect_handle_to_io_completion_port(
     struct aws_io_handle *handle) {
 
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->connect_to_io_completion_port);
-    return event_loop->vtable->connect_to_io_completion_port(event_loop, handle);
+    if (event_loop->vtable->connect_to_io_completion_port(event_loop, handle)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_atomic_fetch_add(&event_loop->load.subscribed_handle_count, 1);
+    return AWS_OP_SUCCESS;
 }
 
 #else  /* !AWS_USE_IO_COMPLETION_PORTS */
@@ -341,14 +943,24 @@ int aws_event_loop_subscribe_to_io_events(
     void *user_data) {
 
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->subscribe_to_io_events);
-    return event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data);
+    if (event_loop->vtable->subscribe_to_io_events(event_loop, handle, events, on_event, user_data)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_atomic_fetch_add(&event_loop->load.subscribed_handle_count, 1);
+    return AWS_OP_SUCCESS;
 }
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 int aws_event_loop_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     AWS_ASSERT(aws_event_loop_thread_is_callers_thread(event_loop));
     AWS_ASSERT(event_loop->vtable && event_loop->vtable->unsubscribe_from_io_events);
-    return event_loop->vtable->unsubscribe_from_io_events(event_loop, handle);
+    if (event_loop->vtable->unsubscribe_from_io_events(event_loop, handle)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_atomic_fetch_sub(&event_loop->load.subscribed_handle_count, 1);
+    return AWS_OP_SUCCESS;
 }
 
 void aws_event_loop_free_io_event_resources(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
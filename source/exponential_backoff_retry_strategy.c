@@ -9,15 +9,26 @@
 
 #include <aws/common/clock.h>
 #include <aws/common/device_random.h>
+#include <aws/common/linked_list.h>
 #include <aws/common/logging.h>
 #include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
 
 #include <inttypes.h>
 
+/* released tokens kept around to be handed out again, so acquiring a token usually doesn't allocate */
+static const size_t s_max_pooled_tokens = 256;
+
 struct exponential_backoff_strategy {
     struct aws_retry_strategy base;
     struct aws_exponential_backoff_retry_options config;
+
+    struct {
+        struct aws_mutex lock;
+        /* exponential_backoff_retry_token.pool_node */
+        struct aws_linked_list pooled_tokens;
+        size_t pooled_token_count;
+    } synced_data;
 };
 
 struct exponential_backoff_retry_token {
@@ -31,6 +42,7 @@ struct exponential_backoff_retry_token {
     struct aws_event_loop *bound_loop;
     uint64_t (*generate_random)(void);
     struct aws_task retry_task;
+    struct aws_linked_list_node pool_node;
 
     struct {
         struct aws_mutex mutex;
@@ -42,10 +54,58 @@ struct exponential_backoff_retry_token {
 
 static void s_exponential_retry_destroy(struct aws_retry_strategy *retry_strategy) {
     if (retry_strategy) {
+        struct exponential_backoff_strategy *exponential_backoff_strategy = retry_strategy->impl;
+
+        /* every token holds a reference, so only pooled ones can be left */
+        while (!aws_linked_list_empty(&exponential_backoff_strategy->synced_data.pooled_tokens)) {
+            struct aws_linked_list_node *node =
+                aws_linked_list_pop_front(&exponential_backoff_strategy->synced_data.pooled_tokens);
+            struct exponential_backoff_retry_token *backoff_retry_token =
+                AWS_CONTAINER_OF(node, struct exponential_backoff_retry_token, pool_node);
+            aws_mutex_clean_up(&backoff_retry_token->thread_data.mutex);
+            aws_mem_release(retry_strategy->allocator, backoff_retry_token);
+        }
+
+        aws_mutex_clean_up(&exponential_backoff_strategy->synced_data.lock);
         aws_mem_release(retry_strategy->allocator, retry_strategy);
     }
 }
 
+/* Hands out a pooled token if there is one, its mutex is still initialized and everything else is up to the caller. */
+static struct exponential_backoff_retry_token *s_exponential_retry_token_new(
+    struct exponential_backoff_strategy *exponential_backoff_strategy) {
+    struct aws_linked_list_node *node = NULL;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&exponential_backoff_strategy->synced_data.lock) &&
+            "Retry strategy mutex acquisition failed");
+        if (!aws_linked_list_empty(&exponential_backoff_strategy->synced_data.pooled_tokens)) {
+            node = aws_linked_list_pop_front(&exponential_backoff_strategy->synced_data.pooled_tokens);
+            exponential_backoff_strategy->synced_data.pooled_token_count--;
+        }
+        AWS_FATAL_ASSERT(
+            !aws_mutex_unlock(&exponential_backoff_strategy->synced_data.lock) &&
+            "Retry strategy mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    if (node) {
+        return AWS_CONTAINER_OF(node, struct exponential_backoff_retry_token, pool_node);
+    }
+
+    struct exponential_backoff_retry_token *backoff_retry_token = aws_mem_calloc(
+        exponential_backoff_strategy->base.allocator, 1, sizeof(struct exponential_backoff_retry_token));
+
+    if (!backoff_retry_token) {
+        return NULL;
+    }
+
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&backoff_retry_token->thread_data.mutex) && "Retry strategy mutex initialization failed");
+
+    return backoff_retry_token;
+}
+
 static void s_exponential_retry_task(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)task;
 
@@ -99,8 +159,9 @@ static int s_exponential_retry_acquire_token(
     /* no resource contention here so no timeouts. */
     (void)timeout_ms;
 
+    struct exponential_backoff_strategy *exponential_backoff_strategy = retry_strategy->impl;
     struct exponential_backoff_retry_token *backoff_retry_token =
-        aws_mem_calloc(retry_strategy->allocator, 1, sizeof(struct exponential_backoff_retry_token));
+        s_exponential_retry_token_new(exponential_backoff_strategy);
 
     if (!backoff_retry_token) {
         return AWS_OP_ERR;
@@ -117,7 +178,6 @@ static int s_exponential_retry_acquire_token(
     aws_retry_strategy_acquire(retry_strategy);
     backoff_retry_token->base.impl = backoff_retry_token;
 
-    struct exponential_backoff_strategy *exponential_backoff_strategy = retry_strategy->impl;
     backoff_retry_token->bound_loop = aws_event_loop_group_get_next_loop(exponential_backoff_strategy->config.el_group);
     backoff_retry_token->max_retries = exponential_backoff_strategy->config.max_retries;
     backoff_retry_token->backoff_scale_factor_ns = aws_timestamp_convert(
@@ -127,10 +187,10 @@ static int s_exponential_retry_acquire_token(
     aws_atomic_init_int(&backoff_retry_token->current_retry_count, 0);
     aws_atomic_init_int(&backoff_retry_token->last_backoff, 0);
 
+    /* no other thread can have a pooled token, so there's no need to lock */
     backoff_retry_token->thread_data.acquired_fn = on_acquired;
+    backoff_retry_token->thread_data.retry_ready_fn = NULL;
     backoff_retry_token->thread_data.user_data = user_data;
-    AWS_FATAL_ASSERT(
-        !aws_mutex_init(&backoff_retry_token->thread_data.mutex) && "Retry strategy mutex initialization failed");
 
     aws_task_init(
         &backoff_retry_token->retry_task,
@@ -273,10 +333,33 @@ static int s_exponential_backoff_record_success(struct aws_retry_token *token) {
 
 static void s_exponential_backoff_release_token(struct aws_retry_token *token) {
     if (token) {
-        aws_retry_strategy_release(token->retry_strategy);
+        struct aws_retry_strategy *retry_strategy = token->retry_strategy;
+        struct exponential_backoff_strategy *exponential_backoff_strategy = retry_strategy->impl;
         struct exponential_backoff_retry_token *backoff_retry_token = token->impl;
-        aws_mutex_clean_up(&backoff_retry_token->thread_data.mutex);
-        aws_mem_release(token->allocator, backoff_retry_token);
+        bool pooled = false;
+
+        { /***** BEGIN CRITICAL SECTION *********/
+            AWS_FATAL_ASSERT(
+                !aws_mutex_lock(&exponential_backoff_strategy->synced_data.lock) &&
+                "Retry strategy mutex acquisition failed");
+            if (exponential_backoff_strategy->synced_data.pooled_token_count < s_max_pooled_tokens) {
+                aws_linked_list_push_back(
+                    &exponential_backoff_strategy->synced_data.pooled_tokens, &backoff_retry_token->pool_node);
+                exponential_backoff_strategy->synced_data.pooled_token_count++;
+                pooled = true;
+            }
+            AWS_FATAL_ASSERT(
+                !aws_mutex_unlock(&exponential_backoff_strategy->synced_data.lock) &&
+                "Retry strategy mutex release failed");
+        } /**** END CRITICAL SECTION ***********/
+
+        if (!pooled) {
+            aws_mutex_clean_up(&backoff_retry_token->thread_data.mutex);
+            aws_mem_release(token->allocator, backoff_retry_token);
+        }
+
+        /* last, this may destroy the strategy and with it the pool */
+        aws_retry_strategy_release(retry_strategy);
     }
 }
 
@@ -329,6 +412,10 @@ struct aws_retry_strategy *aws_retry_strategy_new_exponential_backoff(
     exponential_backoff_strategy->base.vtable = &s_exponential_retry_vtable;
     aws_atomic_init_int(&exponential_backoff_strategy->base.ref_count, 1);
     exponential_backoff_strategy->config = *config;
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&exponential_backoff_strategy->synced_data.lock) &&
+        "Retry strategy mutex initialization failed");
+    aws_linked_list_init(&exponential_backoff_strategy->synced_data.pooled_tokens);
 
     if (!exponential_backoff_strategy->config.generate_random) {
         exponential_backoff_strategy->config.generate_random = s_default_gen_rand;
@@ -5,9 +5,14 @@
 
 #include <aws/io/file_utils.h>
 
+#include <aws/common/atomics.h>
 #include <aws/common/environment.h>
+#include <aws/common/math.h>
 #include <aws/common/string.h>
+#include <aws/common/system_info.h>
+#include <aws/common/thread.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/positional_file.h>
 
 #include <errno.h>
 #include <stdio.h>
@@ -66,3 +71,168 @@ int aws_byte_buf_init_from_file(struct aws_byte_buf *out_buf, struct aws_allocat
 bool aws_is_any_directory_separator(char value) {
     return value == '\\' || value == '/';
 }
+
+/* reads the whole file into a buffer sized for it up front, null terminated like aws_byte_buf_init_from_file() */
+static int s_byte_buf_init_from_positional_file(
+    struct aws_byte_buf *out_buf,
+    struct aws_allocator *alloc,
+    const char *file_name) {
+
+    struct aws_positional_file file;
+    if (aws_positional_file_open(&file, file_name)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to open file %s.", file_name);
+        return AWS_OP_ERR;
+    }
+
+    if ((uint64_t)file.length >= SIZE_MAX) {
+        aws_positional_file_close(&file);
+        return aws_raise_error(AWS_ERROR_OVERFLOW_DETECTED);
+    }
+
+    size_t length = (size_t)file.length;
+    if (aws_byte_buf_init(out_buf, alloc, length + 1)) {
+        aws_positional_file_close(&file);
+        return AWS_OP_ERR;
+    }
+
+    /* reads can come back short, so keep going until the file is in or it ends early */
+    struct aws_byte_buf contents = *out_buf;
+    contents.capacity = length;
+    while (contents.len < length) {
+        size_t read_so_far = contents.len;
+        if (aws_positional_file_read(&file, read_so_far, &contents)) {
+            goto on_error;
+        }
+
+        if (contents.len == read_so_far) {
+            AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: File %s got shorter while it was read.", file_name);
+            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+            goto on_error;
+        }
+    }
+
+    aws_positional_file_close(&file);
+    out_buf->len = length;
+    out_buf->buffer[length] = 0;
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    AWS_LOGF_ERROR(AWS_LS_IO_FILE_UTILS, "static: Failed to read file %s.", file_name);
+    aws_positional_file_close(&file);
+    aws_byte_buf_clean_up_secure(out_buf);
+    return AWS_OP_ERR;
+}
+
+struct bulk_file_read {
+    struct aws_allocator *allocator;
+    const char *const *file_names;
+    size_t count;
+    struct aws_byte_buf *out_bufs;
+    int *error_codes;
+    /* each reader takes the next unread file, so one slow file doesn't hold up a share of the others */
+    struct aws_atomic_var next_index;
+};
+
+static void s_bulk_file_reader(void *arg) {
+    struct bulk_file_read *bulk_read = arg;
+
+    for (;;) {
+        size_t index = aws_atomic_fetch_add(&bulk_read->next_index, 1);
+        if (index >= bulk_read->count) {
+            return;
+        }
+
+        /* errors are per thread, so each file's is picked up here */
+        bulk_read->error_codes[index] = AWS_ERROR_SUCCESS;
+        if (s_byte_buf_init_from_positional_file(
+                &bulk_read->out_bufs[index], bulk_read->allocator, bulk_read->file_names[index])) {
+            bulk_read->error_codes[index] = aws_last_error();
+        }
+    }
+}
+
+int aws_byte_bufs_init_from_files(
+    struct aws_allocator *allocator,
+    const char *const *file_names,
+    size_t count,
+    size_t thread_count,
+    struct aws_byte_buf *out_bufs,
+    int *out_error_codes) {
+
+    AWS_PRECONDITION(count == 0 || (file_names && out_bufs));
+
+    for (size_t i = 0; i < count; ++i) {
+        AWS_ZERO_STRUCT(out_bufs[i]);
+    }
+
+    if (count == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    int *error_codes = out_error_codes;
+    if (error_codes == NULL) {
+        error_codes = aws_mem_calloc(allocator, count, sizeof(int));
+        if (error_codes == NULL) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    struct bulk_file_read bulk_read = {
+        .allocator = allocator,
+        .file_names = file_names,
+        .count = count,
+        .out_bufs = out_bufs,
+        .error_codes = error_codes,
+    };
+    aws_atomic_init_int(&bulk_read.next_index, 0);
+
+    if (thread_count == 0) {
+        thread_count = aws_system_info_processor_count();
+    }
+    thread_count = aws_min_size(aws_max_size(thread_count, 1), count);
+
+    /* the calling thread reads too, so it takes one fewer new thread. Any that can't start just leave more to read. */
+    size_t threads_launched = 0;
+    struct aws_thread *threads = NULL;
+    if (thread_count > 1) {
+        threads = aws_mem_calloc(allocator, thread_count - 1, sizeof(struct aws_thread));
+    }
+
+    if (threads) {
+        for (; threads_launched < thread_count - 1; ++threads_launched) {
+            struct aws_thread *thread = &threads[threads_launched];
+            if (aws_thread_init(thread, allocator)) {
+                break;
+            }
+
+            if (aws_thread_launch(thread, s_bulk_file_reader, &bulk_read, NULL)) {
+                aws_thread_clean_up(thread);
+                break;
+            }
+        }
+    }
+
+    s_bulk_file_reader(&bulk_read);
+
+    for (size_t i = 0; i < threads_launched; ++i) {
+        aws_thread_join(&threads[i]);
+        aws_thread_clean_up(&threads[i]);
+    }
+    aws_mem_release(allocator, threads);
+
+    int first_error = AWS_ERROR_SUCCESS;
+    for (size_t i = 0; i < count && first_error == AWS_ERROR_SUCCESS; ++i) {
+        first_error = error_codes[i];
+    }
+
+    if (error_codes != out_error_codes) {
+        aws_mem_release(allocator, error_codes);
+    }
+
+    if (first_error != AWS_ERROR_SUCCESS) {
+        return aws_raise_error(first_error);
+    }
+
+    return AWS_OP_SUCCESS;
+}
@@ -9,25 +9,122 @@
 #include <aws/common/condition_variable.h>
 #include <aws/common/hash_table.h>
 #include <aws/common/lru_cache.h>
+#include <aws/common/math.h>
 #include <aws/common/mutex.h>
+#include <aws/common/priority_queue.h>
+#include <aws/common/rw_lock.h>
 #include <aws/common/string.h>
 #include <aws/common/thread.h>
 
+#include <aws/io/event_loop.h>
+#include <aws/io/file_utils.h>
 #include <aws/io/logging.h>
+#include <aws/io/statistics.h>
 
+#include <errno.h>
 #include <inttypes.h>
+#include <stdio.h>
+
+#ifdef _MSC_VER
+#    pragma warning(disable : 4996) /* fopen */
+#endif
 
 const uint64_t NS_PER_SEC = 1000000000;
 
+/* upper bound on the threads a default resolver runs blocking resolutions on, no matter how many hosts it tracks */
+#define DEFAULT_RESOLVER_MAX_WORKER_THREADS 8
+
+/*
+ * The host names and addresses the default resolver caches are shared rather than copied: copying an address that
+ * holds them, for a callback or a snapshot, takes a reference instead of allocating. Each shared string sits right
+ * after a shared_string_header and names s_shared_string_allocator as its allocator, so the aws_string_destroy() a
+ * callback's copy eventually gets drops a reference without anyone having to know.
+ */
+struct shared_string_header {
+    struct aws_allocator *allocator;
+    struct aws_atomic_var ref_count;
+};
+
+static void *s_shared_string_mem_acquire(struct aws_allocator *allocator, size_t size);
+static void s_shared_string_mem_release(struct aws_allocator *allocator, void *ptr);
+
+static struct aws_allocator s_shared_string_allocator = {
+    .mem_acquire = s_shared_string_mem_acquire,
+    .mem_release = s_shared_string_mem_release,
+};
+
+static void *s_shared_string_acquire_from(struct aws_allocator *backing_allocator, size_t size) {
+    struct shared_string_header *header =
+        aws_mem_acquire(backing_allocator, sizeof(struct shared_string_header) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->allocator = backing_allocator;
+    aws_atomic_init_int(&header->ref_count, 1);
+    return header + 1;
+}
+
+/* only reached by someone copying a shared string with its own allocator, that copy gets a count of its own */
+static void *s_shared_string_mem_acquire(struct aws_allocator *allocator, size_t size) {
+    (void)allocator;
+    return s_shared_string_acquire_from(aws_default_allocator(), size);
+}
+
+static void s_shared_string_mem_release(struct aws_allocator *allocator, void *ptr) {
+    (void)allocator;
+    struct shared_string_header *header = (struct shared_string_header *)ptr - 1;
+    if (aws_atomic_fetch_sub(&header->ref_count, 1) == 1) {
+        aws_mem_release(header->allocator, header);
+    }
+}
+
+/* returns a shared copy of str backed by allocator, or another reference to str if it's shared already */
+static const struct aws_string *s_shared_string_new(struct aws_allocator *allocator, const struct aws_string *str) {
+    if (str->allocator == &s_shared_string_allocator) {
+        aws_atomic_fetch_add(&((struct shared_string_header *)str - 1)->ref_count, 1);
+        return str;
+    }
+
+    /* laid out the way aws_string_new_from_array() lays them out, bytes[1] has room for the terminator */
+    struct aws_string *copy = s_shared_string_acquire_from(allocator, sizeof(struct aws_string) + str->len);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    *(struct aws_allocator **)(&copy->allocator) = &s_shared_string_allocator;
+    *(size_t *)(&copy->len) = str->len;
+    memcpy((void *)copy->bytes, str->bytes, str->len);
+    *(uint8_t *)&copy->bytes[str->len] = '\0';
+    return copy;
+}
+
+/* swaps *str for a shared copy, keeping it as it is if one can't be made */
+static void s_share_string(struct aws_allocator *allocator, const struct aws_string **str) {
+    const struct aws_string *shared = s_shared_string_new(allocator, *str);
+    if (shared != NULL) {
+        aws_string_destroy((void *)*str);
+        *str = shared;
+    }
+}
+
+static const struct aws_string *s_copy_string(struct aws_allocator *allocator, const struct aws_string *str) {
+    if (str->allocator == &s_shared_string_allocator) {
+        return s_shared_string_new(allocator, str);
+    }
+
+    return aws_string_new_from_string(allocator, str);
+}
+
 int aws_host_address_copy(const struct aws_host_address *from, struct aws_host_address *to) {
     to->allocator = from->allocator;
-    to->address = aws_string_new_from_string(to->allocator, from->address);
+    to->address = s_copy_string(to->allocator, from->address);
 
     if (!to->address) {
         return AWS_OP_ERR;
     }
 
-    to->host = aws_string_new_from_string(to->allocator, from->host);
+    to->host = s_copy_string(to->allocator, from->host);
 
     if (!to->host) {
         aws_string_destroy((void *)to->address);
@@ -37,6 +134,7 @@ int aws_host_address_copy(const struct aws_host_address *from, struct aws_host_a
     to->record_type = from->record_type;
     to->use_count = from->use_count;
     to->connection_failure_count = from->connection_failure_count;
+    to->connect_latency_ns = from->connect_latency_ns;
     to->expiry = from->expiry;
     to->weight = from->weight;
 
@@ -50,6 +148,7 @@ void aws_host_address_move(struct aws_host_address *from, struct aws_host_addres
     to->record_type = from->record_type;
     to->use_count = from->use_count;
     to->connection_failure_count = from->connection_failure_count;
+    to->connect_latency_ns = from->connect_latency_ns;
     to->expiry = from->expiry;
     to->weight = from->weight;
     AWS_ZERO_STRUCT(*from);
@@ -85,6 +184,21 @@ int aws_host_resolver_record_connection_failure(struct aws_host_resolver *resolv
     return resolver->vtable->record_connection_failure(resolver, address);
 }
 
+int aws_host_resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_latency_ns) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(address);
+
+    if (resolver->vtable->record_connection_success) {
+        return resolver->vtable->record_connection_success(resolver, address, connect_latency_ns);
+    }
+
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 struct aws_host_listener *aws_host_resolver_add_host_listener(
     struct aws_host_resolver *resolver,
     const struct aws_host_listener_options *options) {
@@ -111,6 +225,340 @@ int aws_host_resolver_remove_host_listener(struct aws_host_resolver *resolver, s
     return AWS_OP_ERR;
 }
 
+int aws_host_resolver_get_stats(struct aws_host_resolver *resolver, struct aws_host_resolver_stats *out_stats) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(out_stats);
+
+    if (resolver->vtable->get_stats) {
+        return resolver->vtable->get_stats(resolver, out_stats);
+    }
+
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_host_resolver_resolve_host_on_event_loop(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    struct aws_event_loop *event_loop,
+    void *user_data) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(event_loop);
+
+    if (resolver->vtable->resolve_host_on_event_loop) {
+        return resolver->vtable->resolve_host_on_event_loop(resolver, host_name, res, config, event_loop, user_data);
+    }
+
+    return aws_host_resolver_resolve_host(resolver, host_name, res, config, user_data);
+}
+
+int aws_host_resolver_resolve_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(host_names || host_count == 0);
+
+    if (host_count == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    if (resolver->vtable->resolve_hosts) {
+        return resolver->vtable->resolve_hosts(resolver, host_names, host_count, res, config, user_data);
+    }
+
+    for (size_t i = 0; i < host_count; ++i) {
+        if (aws_host_resolver_resolve_host(resolver, host_names[i], res, config, user_data)) {
+            res(resolver, host_names[i], aws_last_error(), NULL, user_data);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_host_resolver_seed_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    const struct aws_array_list *addresses,
+    struct aws_host_resolution_config *config) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(host_name);
+    AWS_PRECONDITION(addresses);
+    AWS_PRECONDITION(config);
+
+    if (resolver->vtable->seed_host) {
+        return resolver->vtable->seed_host(resolver, host_name, addresses, config);
+    }
+
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+/*
+ * Saved cache layout, all integers big endian:
+ *
+ *   "ADNS" | version (u8) | host block*
+ *   host block: host name length (u16) | host name | address count (u16) | address*
+ *   address:    record type (u8, enum aws_address_record_type) | address length (u8) | address
+ *
+ * Expiry times aren't saved: everything loaded is stale until a fresh resolution confirms it.
+ */
+static const uint8_t s_host_cache_magic[] = {'A', 'D', 'N', 'S'};
+static const uint8_t s_host_cache_version = 1;
+
+static int s_write_host_cache_block(
+    struct aws_byte_buf *out_buf,
+    const struct aws_array_list *addresses,
+    size_t first_index,
+    size_t end_index) {
+
+    struct aws_host_address *address = NULL;
+    aws_array_list_get_at_ptr(addresses, (void **)&address, first_index);
+
+    if (address->host->len > UINT16_MAX || end_index - first_index > UINT16_MAX) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (aws_byte_buf_reserve_relative(out_buf, sizeof(uint16_t) * 2 + address->host->len) ||
+        !aws_byte_buf_write_be16(out_buf, (uint16_t)address->host->len) ||
+        !aws_byte_buf_write_from_whole_cursor(out_buf, aws_byte_cursor_from_string(address->host)) ||
+        !aws_byte_buf_write_be16(out_buf, (uint16_t)(end_index - first_index))) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = first_index; i < end_index; ++i) {
+        aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+        if (address->address->len > UINT8_MAX) {
+            return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        }
+
+        if (aws_byte_buf_reserve_relative(out_buf, 2 + address->address->len) ||
+            !aws_byte_buf_write_u8(out_buf, (uint8_t)address->record_type) ||
+            !aws_byte_buf_write_u8(out_buf, (uint8_t)address->address->len) ||
+            !aws_byte_buf_write_from_whole_cursor(out_buf, aws_byte_cursor_from_string(address->address))) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_host_resolver_save_cache(struct aws_host_resolver *resolver, struct aws_byte_buf *out_buf) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(resolver->vtable);
+    AWS_PRECONDITION(aws_byte_buf_is_valid(out_buf));
+
+    if (!resolver->vtable->copy_cached_addresses) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    struct aws_array_list addresses;
+    if (aws_array_list_init_dynamic(&addresses, resolver->allocator, 16, sizeof(struct aws_host_address))) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    if (resolver->vtable->copy_cached_addresses(resolver, &addresses)) {
+        goto done;
+    }
+
+    if (aws_byte_buf_reserve_relative(out_buf, sizeof(s_host_cache_magic) + 1) ||
+        !aws_byte_buf_write(out_buf, s_host_cache_magic, sizeof(s_host_cache_magic)) ||
+        !aws_byte_buf_write_u8(out_buf, s_host_cache_version)) {
+        goto done;
+    }
+
+    /* addresses come grouped by host, so each run of the same host becomes one block */
+    size_t address_count = aws_array_list_length(&addresses);
+    size_t block_start = 0;
+    for (size_t i = 1; i <= address_count; ++i) {
+        struct aws_host_address *block_address = NULL;
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(&addresses, (void **)&block_address, block_start);
+        if (i < address_count) {
+            aws_array_list_get_at_ptr(&addresses, (void **)&address, i);
+            if (aws_string_eq(block_address->host, address->host)) {
+                continue;
+            }
+        }
+
+        if (s_write_host_cache_block(out_buf, &addresses, block_start, i)) {
+            goto done;
+        }
+        block_start = i;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+done:
+    for (size_t i = 0; i < aws_array_list_length(&addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(&addresses, (void **)&address, i);
+        aws_host_address_clean_up(address);
+    }
+    aws_array_list_clean_up(&addresses);
+
+    return result;
+}
+
+static int s_load_host_cache_block(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor *cache,
+    struct aws_array_list *addresses,
+    struct aws_host_resolution_config *config) {
+
+    uint16_t host_name_len = 0;
+    uint16_t address_count = 0;
+    struct aws_byte_cursor host_name_cur;
+    if (!aws_byte_cursor_read_be16(cache, &host_name_len) || host_name_len == 0 || cache->len < host_name_len) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+    host_name_cur = aws_byte_cursor_advance(cache, host_name_len);
+    if (!aws_byte_cursor_read_be16(cache, &address_count)) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    struct aws_string *host_name = aws_string_new_from_cursor(resolver->allocator, &host_name_cur);
+    if (host_name == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    for (uint16_t i = 0; i < address_count; ++i) {
+        uint8_t record_type = 0;
+        uint8_t address_len = 0;
+        if (!aws_byte_cursor_read_u8(cache, &record_type) || !aws_byte_cursor_read_u8(cache, &address_len) ||
+            address_len == 0 || cache->len < address_len ||
+            (record_type != AWS_ADDRESS_RECORD_TYPE_A && record_type != AWS_ADDRESS_RECORD_TYPE_AAAA)) {
+            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+            goto done;
+        }
+
+        struct aws_byte_cursor address_cur = aws_byte_cursor_advance(cache, address_len);
+        struct aws_host_address address = {
+            .allocator = resolver->allocator,
+            .host = host_name,
+            .address = aws_string_new_from_cursor(resolver->allocator, &address_cur),
+            .record_type = (enum aws_address_record_type)record_type,
+        };
+        if (address.address == NULL) {
+            goto done;
+        }
+
+        if (aws_array_list_push_back(addresses, &address)) {
+            aws_string_destroy((void *)address.address);
+            goto done;
+        }
+    }
+
+    result = aws_host_resolver_seed_host(resolver, host_name, addresses, config);
+
+done:
+    /* the addresses borrow host_name, so only their address strings are ours to free */
+    for (size_t i = 0; i < aws_array_list_length(addresses); ++i) {
+        struct aws_host_address *address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+        aws_string_destroy((void *)address->address);
+    }
+    aws_array_list_clear(addresses);
+    aws_string_destroy(host_name);
+
+    return result;
+}
+
+int aws_host_resolver_load_cache(
+    struct aws_host_resolver *resolver,
+    struct aws_byte_cursor cache,
+    struct aws_host_resolution_config *config) {
+    AWS_PRECONDITION(resolver);
+    AWS_PRECONDITION(config);
+
+    struct aws_byte_cursor magic;
+    uint8_t version = 0;
+    if (cache.len < sizeof(s_host_cache_magic) + 1) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+    magic = aws_byte_cursor_advance(&cache, sizeof(s_host_cache_magic));
+    aws_byte_cursor_read_u8(&cache, &version);
+    if (memcmp(magic.ptr, s_host_cache_magic, sizeof(s_host_cache_magic)) != 0 || version != s_host_cache_version) {
+        AWS_LOGF_ERROR(AWS_LS_IO_DNS, "id=%p: not a host cache this resolver can load.", (void *)resolver);
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    struct aws_array_list addresses;
+    if (aws_array_list_init_dynamic(&addresses, resolver->allocator, 8, sizeof(struct aws_host_address))) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_SUCCESS;
+    while (cache.len > 0) {
+        if (s_load_host_cache_block(resolver, &cache, &addresses, config)) {
+            result = AWS_OP_ERR;
+            break;
+        }
+    }
+
+    aws_array_list_clean_up(&addresses);
+
+    return result;
+}
+
+int aws_host_resolver_save_cache_to_file(struct aws_host_resolver *resolver, const char *file_path) {
+    struct aws_byte_buf cache;
+    if (aws_byte_buf_init(&cache, resolver->allocator, 1024)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_ERR;
+    if (aws_host_resolver_save_cache(resolver, &cache)) {
+        goto done;
+    }
+
+    FILE *fp = fopen(file_path, "wb");
+    if (fp == NULL) {
+        AWS_LOGF_ERROR(AWS_LS_IO_DNS, "static: Failed to open file %s with errno %d", file_path, errno);
+        aws_translate_and_raise_io_error(errno);
+        goto done;
+    }
+
+    size_t written = fwrite(cache.buffer, 1, cache.len, fp);
+    int close_result = fclose(fp);
+    if (written < cache.len || close_result != 0) {
+        AWS_LOGF_ERROR(AWS_LS_IO_DNS, "static: Failed to write file %s with errno %d", file_path, errno);
+        aws_translate_and_raise_io_error(errno);
+        goto done;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+done:
+    aws_byte_buf_clean_up(&cache);
+    return result;
+}
+
+int aws_host_resolver_load_cache_from_file(
+    struct aws_host_resolver *resolver,
+    const char *file_path,
+    struct aws_host_resolution_config *config) {
+
+    struct aws_byte_buf cache;
+    if (aws_byte_buf_init_from_file(&cache, resolver->allocator, file_path)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = aws_host_resolver_load_cache(resolver, aws_byte_cursor_from_buf(&cache), config);
+    aws_byte_buf_clean_up(&cache);
+
+    return result;
+}
+
 /*
  * Used by both the resolver for its lifetime state as well as individual host entries for theirs.
  */
@@ -132,6 +580,13 @@ struct default_host_resolver {
     /* host_name (aws_string*) -> host_entry* */
     struct aws_hash_table host_entry_table;
 
+    /*
+     * Lets cache hits look an entry up and read its published address snapshot without resolver_lock. Every change
+     * to host_entry_table and every snapshot swap takes it for writing; the table changes do so with resolver_lock
+     * already held. It's a leaf lock: nothing else is ever locked while it's held.
+     */
+    struct aws_rw_lock host_entry_table_lock;
+
     /* Hash table of listener entries per host name. We keep this decoupled from the host entry table to allow for
      * listeners to be added/removed regardless of whether or not a corresponding host entry exists.
      *
@@ -144,10 +599,35 @@ struct default_host_resolver {
     enum default_resolver_state state;
 
     /*
-     * Tracks the number of launched resolution threads that have not yet invoked their shutdown completion
-     * callback.
+     * Tracks the number of host entries that have not yet invoked their shutdown completion callback.
      */
     uint32_t pending_host_entry_shutdown_completion_callbacks;
+
+    /*
+     * Tracks the number of host_resolved_delivery tasks still to run on other event loops. They pass the resolver to
+     * the callbacks they invoke, so it isn't cleaned up until they're done.
+     */
+    size_t pending_delivery_count;
+
+    /*
+     * Host entries don't get a thread each. Instead every entry waiting for its next resolution sits in
+     * scheduled_entries (host_entry * ordered by next_resolve_time_ns) and a bounded pool of worker threads pops
+     * entries as they come due, runs one resolution pass and puts them back. Protected by resolver_lock.
+     */
+    struct aws_priority_queue scheduled_entries;
+    struct aws_condition_variable worker_signal;
+    size_t worker_count;
+    size_t idle_worker_count;
+
+    /* see struct aws_host_resolver_stats. Bumped off the cache-hit path, so they don't slow hits down. */
+    struct aws_atomic_var fresh_resolutions;
+    struct aws_atomic_var coalesced_resolutions;
+    struct aws_atomic_var negative_cache_hits;
+};
+
+struct resolver_worker {
+    struct aws_thread thread;
+    struct aws_host_resolver *resolver;
 };
 
 /* Default host resolver implementation for listener. */
@@ -199,18 +679,49 @@ struct host_listener_entry {
     struct aws_linked_list listeners;
 };
 
+/*
+ * Copies of an entry's good AAAA and A records, published for cache hits to vend from without taking entry_lock. The
+ * addresses never change once published; only the round robin cursors and the connect latencies move.
+ */
+struct host_address_snapshot {
+    struct aws_allocator *allocator;
+    enum aws_host_address_selection selection;
+    /* the aaaa_count AAAA addresses, followed by the a_count A addresses, in LRU order */
+    struct aws_host_address *addresses;
+    /* connect_latency_ns of each address, kept up to date by record_connection_success between resolution passes */
+    struct aws_atomic_var *connect_latencies_ns;
+    size_t aaaa_count;
+    size_t a_count;
+    struct aws_atomic_var next_aaaa;
+    struct aws_atomic_var next_a;
+};
+
+/* one in this many AWS_HOST_ADDRESS_SELECTION_LOWEST_LATENCY picks takes the next address in rotation instead */
+#define HOST_ADDRESS_EXPLORATION_INTERVAL 8
+
 struct host_entry {
     /* immutable post-creation */
     struct aws_allocator *allocator;
     struct aws_host_resolver *resolver;
-    struct aws_thread resolver_thread;
     const struct aws_string *host_name;
     int64_t resolve_frequency_ns;
     struct aws_host_resolution_config resolution_config;
 
+    /* scheduling data, protected by the resolver lock */
+    uint64_t next_resolve_time_ns;
+    struct aws_priority_queue_node scheduled_node;
+    bool scheduled;
+
+    /*
+     * Only touched by the worker running this entry's resolution pass. An entry is out of scheduled_entries while a
+     * pass runs, so there's never more than one such worker.
+     */
+    bool resolved_once;
+    struct aws_array_list new_address_list;
+    struct aws_linked_list listener_list;
+
     /* synchronized data and its lock */
     struct aws_mutex entry_lock;
-    struct aws_condition_variable entry_signal;
     struct aws_cache *aaaa_records;
     struct aws_cache *a_records;
     struct aws_cache *failed_connection_aaaa_records;
@@ -219,53 +730,171 @@ struct host_entry {
     uint32_t resolves_since_last_request;
     uint64_t last_resolve_request_timestamp_ns;
     enum default_resolver_state state;
+    /* error of the last failed resolution while there were no addresses to fall back on, 0 if the last one worked */
+    int negative_error_code;
+    uint64_t negative_expiry_ns;
+    /* bumped each time a snapshot is built, so a slow publisher never replaces a newer snapshot with an older one */
+    uint64_t address_snapshot_version;
+
+    /* protected by the resolver's host_entry_table_lock. NULL sends queries down the locked path. */
+    struct host_address_snapshot *address_snapshot;
+    uint64_t published_address_snapshot_version;
+
+    /* set by hits served from the snapshot, folded into the request bookkeeping above by the next resolution pass */
+    struct aws_atomic_var requested_since_last_pass;
 };
 
-static void s_shutdown_host_entry(struct host_entry *entry) {
-    aws_mutex_lock(&entry->entry_lock);
-    entry->state = DRS_SHUTTING_DOWN;
-    aws_mutex_unlock(&entry->entry_lock);
-}
-
-static struct aws_host_listener *default_add_host_listener(
-    struct aws_host_resolver *host_resolver,
-    const struct aws_host_listener_options *options);
-
-static int default_remove_host_listener(
-    struct aws_host_resolver *host_resolver,
-    struct aws_host_listener *listener_opaque);
-
-static void s_host_listener_entry_destroy(void *listener_entry_void);
+static int s_compare_host_entry_resolve_times(const void *a, const void *b) {
+    const struct host_entry *entry_a = *(const struct host_entry **)a;
+    const struct host_entry *entry_b = *(const struct host_entry **)b;
 
-static struct host_listener *s_pop_host_listener_from_entry(
-    struct default_host_resolver *resolver,
-    const struct aws_string *host_name,
-    struct host_listener_entry **in_out_listener_entry);
+    if (entry_a->next_resolve_time_ns == entry_b->next_resolve_time_ns) {
+        return 0;
+    }
 
-static int s_add_host_listener_to_listener_entry(
-    struct default_host_resolver *resolver,
-    const struct aws_string *host_name,
-    struct host_listener *listener);
+    return entry_a->next_resolve_time_ns > entry_b->next_resolve_time_ns ? 1 : -1;
+}
 
-static void s_remove_host_listener_from_entry(
-    struct default_host_resolver *resolver,
-    const struct aws_string *host_name,
-    struct host_listener *listener);
+static void s_resolver_worker_thread_fn(void *arg);
 
-static void s_host_listener_destroy(struct host_listener *listener);
+static void s_on_resolver_worker_exit(void *user_data);
 
 /*
- * resolver lock must be held before calling this function
+ * Makes sure a worker will pick up newly scheduled work, launching one if they're all busy and we're below the cap.
+ * Fails only if there are no workers at all and one couldn't be launched.
+ * The resolver lock must be held before calling this function.
  */
-static void s_clear_default_resolver_entry_table(struct default_host_resolver *resolver) {
-    struct aws_hash_table *table = &resolver->host_entry_table;
+static int s_wake_resolver_worker(struct aws_host_resolver *resolver) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    if (default_host_resolver->idle_worker_count > 0 ||
+        default_host_resolver->worker_count >= DEFAULT_RESOLVER_MAX_WORKER_THREADS) {
+        aws_condition_variable_notify_one(&default_host_resolver->worker_signal);
+        return AWS_OP_SUCCESS;
+    }
+
+    struct resolver_worker *worker = aws_mem_calloc(resolver->allocator, 1, sizeof(struct resolver_worker));
+    if (!worker) {
+        goto on_error;
+    }
+
+    worker->resolver = resolver;
+    if (aws_thread_init(&worker->thread, resolver->allocator)) {
+        aws_mem_release(resolver->allocator, worker);
+        goto on_error;
+    }
+
+    if (aws_thread_launch(&worker->thread, s_resolver_worker_thread_fn, worker, NULL)) {
+        aws_thread_clean_up(&worker->thread);
+        aws_mem_release(resolver->allocator, worker);
+        goto on_error;
+    }
+
+    ++default_host_resolver->worker_count;
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: launched resolver worker thread, %llu running",
+        (void *)resolver,
+        (unsigned long long)default_host_resolver->worker_count);
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    /* a busy worker will get to it eventually */
+    if (default_host_resolver->worker_count > 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    return AWS_OP_ERR;
+}
+
+/*
+ * Queues the entry's next resolution pass for resolve_time_ns.
+ * The resolver lock must be held before calling this function.
+ */
+static int s_schedule_host_entry(struct host_entry *entry, uint64_t resolve_time_ns) {
+    struct default_host_resolver *default_host_resolver = entry->resolver->impl;
+
+    AWS_ASSERT(!entry->scheduled);
+    entry->next_resolve_time_ns = resolve_time_ns;
+    if (aws_priority_queue_push_ref(&default_host_resolver->scheduled_entries, &entry, &entry->scheduled_node)) {
+        return AWS_OP_ERR;
+    }
+    entry->scheduled = true;
+
+    if (s_wake_resolver_worker(entry->resolver)) {
+        struct host_entry *removed = NULL;
+        aws_priority_queue_remove(&default_host_resolver->scheduled_entries, &removed, &entry->scheduled_node);
+        entry->scheduled = false;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * The resolver lock must be held before calling this function
+ */
+static void s_shutdown_host_entry(struct host_entry *entry) {
+    aws_mutex_lock(&entry->entry_lock);
+    entry->state = DRS_SHUTTING_DOWN;
+    aws_mutex_unlock(&entry->entry_lock);
+
+    /* don't make shutdown wait out the resolve frequency, have a worker retire the entry right away */
+    if (entry->scheduled) {
+        struct default_host_resolver *default_host_resolver = entry->resolver->impl;
+        struct host_entry *removed = NULL;
+        aws_priority_queue_remove(&default_host_resolver->scheduled_entries, &removed, &entry->scheduled_node);
+        entry->scheduled = false;
+
+        /* the queue just shrank, so pushing back can't fail */
+        AWS_FATAL_ASSERT(s_schedule_host_entry(entry, 0) == AWS_OP_SUCCESS);
+    }
+}
+
+static struct aws_host_listener *default_add_host_listener(
+    struct aws_host_resolver *host_resolver,
+    const struct aws_host_listener_options *options);
+
+static int default_remove_host_listener(
+    struct aws_host_resolver *host_resolver,
+    struct aws_host_listener *listener_opaque);
+
+static void s_host_listener_entry_destroy(void *listener_entry_void);
+
+static struct host_listener *s_pop_host_listener_from_entry(
+    struct default_host_resolver *resolver,
+    const struct aws_string *host_name,
+    struct host_listener_entry **in_out_listener_entry);
+
+static int s_add_host_listener_to_listener_entry(
+    struct default_host_resolver *resolver,
+    const struct aws_string *host_name,
+    struct host_listener *listener);
+
+static void s_remove_host_listener_from_entry(
+    struct default_host_resolver *resolver,
+    const struct aws_string *host_name,
+    struct host_listener *listener);
+
+static void s_host_listener_destroy(struct host_listener *listener);
+
+static void s_clear_address_list(struct aws_array_list *address_list);
+
+/*
+ * resolver lock must be held before calling this function
+ */
+static void s_clear_default_resolver_entry_table(struct default_host_resolver *resolver) {
+    struct aws_hash_table *table = &resolver->host_entry_table;
     for (struct aws_hash_iter iter = aws_hash_iter_begin(table); !aws_hash_iter_done(&iter);
          aws_hash_iter_next(&iter)) {
         struct host_entry *entry = iter.element.value;
         s_shutdown_host_entry(entry);
     }
 
+    aws_rw_lock_wlock(&resolver->host_entry_table_lock);
     aws_hash_table_clear(table);
+    aws_rw_lock_wunlock(&resolver->host_entry_table_lock);
 }
 
 static int resolver_purge_cache(struct aws_host_resolver *resolver) {
@@ -282,7 +911,10 @@ static void s_cleanup_default_resolver(struct aws_host_resolver *resolver) {
 
     aws_hash_table_clean_up(&default_host_resolver->host_entry_table);
     aws_hash_table_clean_up(&default_host_resolver->listener_entry_table);
+    aws_priority_queue_clean_up(&default_host_resolver->scheduled_entries);
 
+    aws_condition_variable_clean_up(&default_host_resolver->worker_signal);
+    aws_rw_lock_clean_up(&default_host_resolver->host_entry_table_lock);
     aws_mutex_clean_up(&default_host_resolver->resolver_lock);
 
     aws_simple_completion_callback *shutdown_callback = resolver->shutdown_options.shutdown_callback_fn;
@@ -309,8 +941,15 @@ static void resolver_destroy(struct aws_host_resolver *resolver) {
 
     s_clear_default_resolver_entry_table(default_host_resolver);
     default_host_resolver->state = DRS_SHUTTING_DOWN;
-    if (default_host_resolver->pending_host_entry_shutdown_completion_callbacks == 0) {
+    if (default_host_resolver->pending_host_entry_shutdown_completion_callbacks == 0 &&
+        default_host_resolver->worker_count == 0 && default_host_resolver->pending_delivery_count == 0) {
         cleanup_resolver = true;
+    } else {
+        /*
+         * workers exit once every entry is retired, and the last one out, or the last delivery task after it, cleans
+         * up the resolver
+         */
+        aws_condition_variable_notify_all(&default_host_resolver->worker_signal);
     }
     aws_mutex_unlock(&default_host_resolver->resolver_lock);
 
@@ -322,9 +961,208 @@ static void resolver_destroy(struct aws_host_resolver *resolver) {
 struct pending_callback {
     aws_on_host_resolved_result_fn *callback;
     void *user_data;
+    /* where the query wants to hear back, NULL for wherever the answer happens to be ready */
+    struct aws_event_loop *event_loop;
+    struct aws_linked_list_node node;
+};
+
+/* One query's answer, waiting in a host_resolved_delivery until the delivery's task runs. */
+struct host_resolved_result {
     struct aws_linked_list_node node;
+    aws_on_host_resolved_result_fn *callback;
+    void *user_data;
+    int error_code;
+    struct aws_host_address address_array[2];
+    struct aws_array_list addresses;
+};
+
+/*
+ * Every answer for one host bound for the same event loop, handed over with a single task instead of one per query.
+ * Counted in the resolver's pending_delivery_count until it has run.
+ */
+struct host_resolved_delivery {
+    struct aws_allocator *allocator;
+    struct aws_task task;
+    struct aws_event_loop *event_loop;
+    struct aws_host_resolver *resolver;
+    const struct aws_string *host_name;
+    struct aws_linked_list results;
+};
+
+/*
+ * Collects the answers for one host and delivers them, each on the event loop its query asked for. resolver_lock must
+ * not be held while adding to it.
+ */
+struct host_resolved_batch {
+    struct aws_host_resolver *resolver;
+    const struct aws_string *host_name;
+    /* struct host_resolved_delivery *, one per event loop */
+    struct aws_array_list deliveries;
 };
 
+static void s_host_resolved_delivery_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct host_resolved_delivery *delivery = arg;
+
+    /* even if the loop is shutting down, every query still gets exactly one answer */
+    while (!aws_linked_list_empty(&delivery->results)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&delivery->results);
+        struct host_resolved_result *result = AWS_CONTAINER_OF(node, struct host_resolved_result, node);
+
+        result->callback(
+            delivery->resolver,
+            delivery->host_name,
+            result->error_code,
+            result->error_code ? NULL : &result->addresses,
+            result->user_data);
+
+        s_clear_address_list(&result->addresses);
+        aws_mem_release(delivery->allocator, result);
+    }
+
+    struct aws_host_resolver *resolver = delivery->resolver;
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+    aws_string_destroy((void *)delivery->host_name);
+    aws_mem_release(delivery->allocator, delivery);
+
+    bool cleanup_resolver = false;
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+    --default_host_resolver->pending_delivery_count;
+    if (default_host_resolver->state == DRS_SHUTTING_DOWN && default_host_resolver->pending_delivery_count == 0 &&
+        default_host_resolver->pending_host_entry_shutdown_completion_callbacks == 0 &&
+        default_host_resolver->worker_count == 0) {
+        cleanup_resolver = true;
+    }
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    if (cleanup_resolver) {
+        s_cleanup_default_resolver(resolver);
+    }
+}
+
+static void s_host_resolved_batch_init(
+    struct host_resolved_batch *batch,
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name) {
+
+    batch->resolver = resolver;
+    batch->host_name = host_name;
+    /* no allocation until some query actually asks for an event loop */
+    aws_array_list_init_dynamic(&batch->deliveries, resolver->allocator, 0, sizeof(struct host_resolved_delivery *));
+}
+
+static struct host_resolved_delivery *s_host_resolved_batch_get_delivery(
+    struct host_resolved_batch *batch,
+    struct aws_event_loop *event_loop) {
+
+    for (size_t i = 0; i < aws_array_list_length(&batch->deliveries); ++i) {
+        struct host_resolved_delivery *delivery = NULL;
+        aws_array_list_get_at(&batch->deliveries, &delivery, i);
+        if (delivery->event_loop == event_loop) {
+            return delivery;
+        }
+    }
+
+    struct aws_allocator *allocator = batch->resolver->allocator;
+    struct host_resolved_delivery *delivery = aws_mem_calloc(allocator, 1, sizeof(struct host_resolved_delivery));
+    if (delivery == NULL) {
+        return NULL;
+    }
+
+    delivery->allocator = allocator;
+    delivery->event_loop = event_loop;
+    delivery->host_name = s_copy_string(allocator, batch->host_name);
+    aws_linked_list_init(&delivery->results);
+    if (delivery->host_name == NULL || aws_array_list_push_back(&batch->deliveries, &delivery)) {
+        aws_string_destroy((void *)delivery->host_name);
+        aws_mem_release(allocator, delivery);
+        return NULL;
+    }
+
+    struct default_host_resolver *default_host_resolver = batch->resolver->impl;
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+    ++default_host_resolver->pending_delivery_count;
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    delivery->resolver = batch->resolver;
+    aws_task_init(&delivery->task, s_host_resolved_delivery_task, delivery, "host_resolved_delivery");
+
+    return delivery;
+}
+
+/*
+ * Answers one query. It's answered right here if it didn't ask for an event loop, or if we're already on that loop;
+ * otherwise addresses are copied and the answer waits for s_host_resolved_batch_flush(). No locks may be held, since
+ * the callback may reentrantly call us.
+ */
+static void s_host_resolved_batch_add(
+    struct host_resolved_batch *batch,
+    struct aws_event_loop *event_loop,
+    aws_on_host_resolved_result_fn *callback,
+    void *user_data,
+    int error_code,
+    const struct aws_array_list *addresses) {
+
+    if (event_loop != NULL && !aws_event_loop_thread_is_callers_thread(event_loop)) {
+        struct host_resolved_delivery *delivery = s_host_resolved_batch_get_delivery(batch, event_loop);
+        struct host_resolved_result *result =
+            delivery ? aws_mem_calloc(batch->resolver->allocator, 1, sizeof(struct host_resolved_result)) : NULL;
+
+        if (result != NULL) {
+            result->callback = callback;
+            result->user_data = user_data;
+            result->error_code = error_code;
+            aws_array_list_init_static(
+                &result->addresses, result->address_array, 2, sizeof(struct aws_host_address));
+
+            for (size_t i = 0; !error_code && i < aws_array_list_length(addresses); ++i) {
+                struct aws_host_address *address = NULL;
+                struct aws_host_address address_copy;
+                aws_array_list_get_at_ptr(addresses, (void **)&address, i);
+                if (aws_host_address_copy(address, &address_copy) ||
+                    aws_array_list_push_back(&result->addresses, &address_copy)) {
+                    result->error_code = aws_last_error();
+                }
+            }
+
+            aws_linked_list_push_back(&delivery->results, &result->node);
+            return;
+        }
+
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS,
+            "id=%p: could not queue the result for %s onto its event loop, invoking its callback here instead.",
+            (void *)batch->resolver,
+            batch->host_name->bytes);
+    }
+
+    callback(batch->resolver, batch->host_name, error_code, error_code ? NULL : addresses, user_data);
+}
+
+/* Schedules a task for every event loop with answers waiting and cleans up the batch. */
+static void s_host_resolved_batch_flush(struct host_resolved_batch *batch) {
+    for (size_t i = 0; i < aws_array_list_length(&batch->deliveries); ++i) {
+        struct host_resolved_delivery *delivery = NULL;
+        aws_array_list_get_at(&batch->deliveries, &delivery, i);
+        aws_event_loop_schedule_task_now(delivery->event_loop, &delivery->task);
+    }
+
+    aws_array_list_clean_up(&batch->deliveries);
+}
+
+static void s_host_address_snapshot_destroy(struct host_address_snapshot *snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < snapshot->aaaa_count + snapshot->a_count; ++i) {
+        aws_host_address_clean_up(&snapshot->addresses[i]);
+    }
+
+    aws_mem_release(snapshot->allocator, snapshot);
+}
+
 static void s_clean_up_host_entry(struct host_entry *entry) {
     if (entry == NULL) {
         return;
@@ -340,26 +1178,43 @@ static void s_clean_up_host_entry(struct host_entry *entry) {
         aws_raise_error(AWS_IO_DNS_HOST_REMOVED_FROM_CACHE);
     }
 
+    struct host_resolved_batch batch;
+    s_host_resolved_batch_init(&batch, entry->resolver, entry->host_name);
+
     while (!aws_linked_list_empty(&entry->pending_resolution_callbacks)) {
         struct aws_linked_list_node *resolution_callback_node =
             aws_linked_list_pop_front(&entry->pending_resolution_callbacks);
         struct pending_callback *pending_callback =
             AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
 
-        pending_callback->callback(
-            entry->resolver, entry->host_name, AWS_IO_DNS_HOST_REMOVED_FROM_CACHE, NULL, pending_callback->user_data);
+        s_host_resolved_batch_add(
+            &batch,
+            pending_callback->event_loop,
+            pending_callback->callback,
+            pending_callback->user_data,
+            AWS_IO_DNS_HOST_REMOVED_FROM_CACHE,
+            NULL);
 
         aws_mem_release(entry->allocator, pending_callback);
     }
 
+    s_host_resolved_batch_flush(&batch);
+
+    AWS_ASSERT(aws_linked_list_empty(&entry->listener_list));
+
     aws_cache_destroy(entry->aaaa_records);
     aws_cache_destroy(entry->a_records);
     aws_cache_destroy(entry->failed_connection_a_records);
     aws_cache_destroy(entry->failed_connection_aaaa_records);
+    s_host_address_snapshot_destroy(entry->address_snapshot);
+    s_clear_address_list(&entry->new_address_list);
+    aws_array_list_clean_up(&entry->new_address_list);
+    aws_mutex_clean_up(&entry->entry_lock);
     aws_string_destroy((void *)entry->host_name);
     aws_mem_release(entry->allocator, entry);
 }
 
+/* Always runs on a worker thread, that worker is what keeps the resolver alive until it exits. */
 static void s_on_host_entry_shutdown_completion(void *user_data) {
     struct host_entry *entry = user_data;
     struct aws_host_resolver *resolver = entry->resolver;
@@ -367,18 +1222,165 @@ static void s_on_host_entry_shutdown_completion(void *user_data) {
 
     s_clean_up_host_entry(entry);
 
-    bool cleanup_resolver = false;
-
     aws_mutex_lock(&default_host_resolver->resolver_lock);
     --default_host_resolver->pending_host_entry_shutdown_completion_callbacks;
     if (default_host_resolver->state == DRS_SHUTTING_DOWN &&
         default_host_resolver->pending_host_entry_shutdown_completion_callbacks == 0) {
-        cleanup_resolver = true;
+        aws_condition_variable_notify_all(&default_host_resolver->worker_signal);
     }
     aws_mutex_unlock(&default_host_resolver->resolver_lock);
+}
 
-    if (cleanup_resolver) {
-        s_cleanup_default_resolver(resolver);
+/* entry_lock must be held. Returns NULL when there's nothing to vend or the copy fails. */
+static struct host_address_snapshot *s_host_address_snapshot_new(struct host_entry *entry) {
+    size_t aaaa_count = aws_cache_get_element_count(entry->aaaa_records);
+    size_t a_count = aws_cache_get_element_count(entry->a_records);
+    if (aaaa_count + a_count == 0) {
+        return NULL;
+    }
+
+    struct host_address_snapshot *snapshot = NULL;
+    struct aws_host_address *addresses = NULL;
+    struct aws_atomic_var *connect_latencies_ns = NULL;
+    if (!aws_mem_acquire_many(
+            entry->allocator,
+            3,
+            &snapshot,
+            sizeof(struct host_address_snapshot),
+            &addresses,
+            sizeof(struct aws_host_address) * (aaaa_count + a_count),
+            &connect_latencies_ns,
+            sizeof(struct aws_atomic_var) * (aaaa_count + a_count))) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*snapshot);
+    AWS_ZERO_ARRAY_PTR(addresses, aaaa_count + a_count);
+    snapshot->allocator = entry->allocator;
+    snapshot->selection = entry->resolution_config.address_selection;
+    snapshot->addresses = addresses;
+    snapshot->connect_latencies_ns = connect_latencies_ns;
+    aws_atomic_init_int(&snapshot->next_aaaa, 0);
+    aws_atomic_init_int(&snapshot->next_a, 0);
+
+    /* using each element once walks the whole cache in LRU order and leaves that order as it was */
+    for (size_t i = 0; i < aaaa_count; ++i) {
+        struct aws_host_address *address = aws_lru_cache_use_lru_element(entry->aaaa_records);
+        if (aws_host_address_copy(address, &addresses[snapshot->aaaa_count])) {
+            goto on_error;
+        }
+        aws_atomic_init_int(&connect_latencies_ns[snapshot->aaaa_count], (size_t)address->connect_latency_ns);
+        ++snapshot->aaaa_count;
+    }
+
+    for (size_t i = 0; i < a_count; ++i) {
+        struct aws_host_address *address = aws_lru_cache_use_lru_element(entry->a_records);
+        if (aws_host_address_copy(address, &addresses[aaaa_count + snapshot->a_count])) {
+            goto on_error;
+        }
+        aws_atomic_init_int(&connect_latencies_ns[aaaa_count + snapshot->a_count], (size_t)address->connect_latency_ns);
+        ++snapshot->a_count;
+    }
+
+    return snapshot;
+
+on_error:
+    /* addresses past what we copied are still zeroed, so cleaning up all of them is safe */
+    snapshot->aaaa_count = aaaa_count;
+    snapshot->a_count = a_count;
+    s_host_address_snapshot_destroy(snapshot);
+    return NULL;
+}
+
+/*
+ * Publishes the entry's current good records for cache hits. Must be called without entry_lock held, by something that
+ * keeps the entry alive: the worker running its resolution pass, or a holder of resolver_lock that found it in the
+ * table.
+ */
+static void s_publish_host_address_snapshot(struct host_entry *entry) {
+    struct default_host_resolver *resolver = entry->resolver->impl;
+
+    aws_mutex_lock(&entry->entry_lock);
+    uint64_t version = ++entry->address_snapshot_version;
+    struct host_address_snapshot *snapshot = s_host_address_snapshot_new(entry);
+    aws_mutex_unlock(&entry->entry_lock);
+
+    struct host_address_snapshot *stale_snapshot = snapshot;
+
+    aws_rw_lock_wlock(&resolver->host_entry_table_lock);
+    if (version > entry->published_address_snapshot_version) {
+        stale_snapshot = entry->address_snapshot;
+        if (stale_snapshot != NULL && snapshot != NULL) {
+            /* keep the rotation going rather than restarting it at the same address every pass */
+            aws_atomic_store_int(&snapshot->next_aaaa, aws_atomic_load_int(&stale_snapshot->next_aaaa));
+            aws_atomic_store_int(&snapshot->next_a, aws_atomic_load_int(&stale_snapshot->next_a));
+        }
+        entry->address_snapshot = snapshot;
+        entry->published_address_snapshot_version = version;
+    }
+    aws_rw_lock_wunlock(&resolver->host_entry_table_lock);
+
+    /* no reader can still be looking at it once we've held the lock for writing */
+    s_host_address_snapshot_destroy(stale_snapshot);
+}
+
+/*
+ * Picks one of the count addresses starting at first in the snapshot, advancing the family's cursor next. Returns
+ * its index in snapshot->addresses.
+ */
+static size_t s_pick_snapshot_address(
+    struct host_address_snapshot *snapshot,
+    struct aws_atomic_var *next,
+    size_t first,
+    size_t count) {
+
+    size_t pick = aws_atomic_fetch_add(next, 1);
+    if (snapshot->selection != AWS_HOST_ADDRESS_SELECTION_LOWEST_LATENCY) {
+        return first + pick % count;
+    }
+
+    /* spread the exploring picks over every address, pick % count alone could keep landing on the same one */
+    size_t rotation = (pick / HOST_ADDRESS_EXPLORATION_INTERVAL) % count;
+    if (pick % HOST_ADDRESS_EXPLORATION_INTERVAL == 0) {
+        return first + rotation;
+    }
+
+    /* starting the scan at the rotation breaks ties between equally fast addresses, a 0 (never measured) wins */
+    size_t best = first + rotation;
+    size_t best_latency_ns = aws_atomic_load_int(&snapshot->connect_latencies_ns[best]);
+    for (size_t i = 1; i < count && best_latency_ns != 0; ++i) {
+        size_t index = first + (rotation + i) % count;
+        size_t latency_ns = aws_atomic_load_int(&snapshot->connect_latencies_ns[index]);
+        if (latency_ns < best_latency_ns) {
+            best = index;
+            best_latency_ns = latency_ns;
+        }
+    }
+
+    return best;
+}
+
+/*
+ * host_entry_table_lock must be held for reading. Copies the next AAAA and A address the entry's selection picks into
+ * callback_address_list, skipping any copy that fails.
+ */
+static void s_copy_addresses_from_snapshot(
+    struct host_address_snapshot *snapshot,
+    struct aws_array_list *callback_address_list) {
+
+    struct aws_host_address address_copy;
+    if (snapshot->aaaa_count > 0) {
+        size_t index = s_pick_snapshot_address(snapshot, &snapshot->next_aaaa, 0, snapshot->aaaa_count);
+        if (!aws_host_address_copy(&snapshot->addresses[index], &address_copy)) {
+            aws_array_list_push_back(callback_address_list, &address_copy);
+        }
+    }
+
+    if (snapshot->a_count > 0) {
+        size_t index = s_pick_snapshot_address(snapshot, &snapshot->next_a, snapshot->aaaa_count, snapshot->a_count);
+        if (!aws_host_address_copy(&snapshot->addresses[index], &address_copy)) {
+            aws_array_list_push_back(callback_address_list, &address_copy);
+        }
     }
 }
 
@@ -474,9 +1476,13 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
 
     if (host_entry) {
         struct aws_host_address *cached_address = NULL;
+        bool moved_to_failed_table = false;
 
+        /*
+         * Unlike resolve_host we keep the resolver lock: it's what keeps the entry from being retired and freed
+         * while we publish the entry's new snapshot below.
+         */
         aws_mutex_lock(&host_entry->entry_lock);
-        aws_mutex_unlock(&default_host_resolver->resolver_lock);
         struct aws_cache *address_table =
             address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? host_entry->aaaa_records : host_entry->a_records;
 
@@ -503,6 +1509,7 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
             if (aws_cache_put(failed_table, address_copy->address, address_copy)) {
                 goto error_host_entry_cleanup;
             }
+            moved_to_failed_table = true;
         } else {
             if (aws_cache_find(failed_table, address->address, (void **)&cached_address)) {
                 goto error_host_entry_cleanup;
@@ -513,6 +1520,12 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
             }
         }
         aws_mutex_unlock(&host_entry->entry_lock);
+
+        /* stop vending the failed address to cache hits */
+        if (moved_to_failed_table) {
+            s_publish_host_address_snapshot(host_entry);
+        }
+        aws_mutex_unlock(&default_host_resolver->resolver_lock);
         return AWS_OP_SUCCESS;
 
     error_host_entry_cleanup:
@@ -521,6 +1534,7 @@ static int resolver_record_connection_failure(struct aws_host_resolver *resolver
             aws_mem_release(resolver->allocator, address_copy);
         }
         aws_mutex_unlock(&host_entry->entry_lock);
+        aws_mutex_unlock(&default_host_resolver->resolver_lock);
         return AWS_OP_ERR;
     }
 
@@ -567,28 +1581,97 @@ static struct aws_host_address *s_find_cached_address(
     }
 }
 
-static struct aws_host_address *s_get_lru_address_aux(
-    struct aws_cache *primary_records,
-    struct aws_cache *fallback_records) {
+static int resolver_record_connection_success(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address,
+    uint64_t connect_latency_ns) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
 
-    struct aws_host_address *address = aws_lru_cache_use_lru_element(primary_records);
-    if (address == NULL) {
-        aws_lru_cache_use_lru_element(fallback_records);
-    }
+    /* the snapshots keep latencies in size_t atomics */
+    connect_latency_ns = aws_min_u64(connect_latency_ns, SIZE_MAX);
 
-    return address;
-}
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
 
-/*
- * Looks in both the good and failed connection record sets for the LRU host record
- */
-static struct aws_host_address *s_get_lru_address(struct host_entry *entry, enum aws_address_record_type record_type) {
-    switch (record_type) {
-        case AWS_ADDRESS_RECORD_TYPE_AAAA:
-            return s_get_lru_address_aux(entry->aaaa_records, entry->failed_connection_aaaa_records);
+    struct aws_hash_element *element = NULL;
+    if (aws_hash_table_find(&default_host_resolver->host_entry_table, address->host, &element)) {
+        aws_mutex_unlock(&default_host_resolver->resolver_lock);
+        return AWS_OP_ERR;
+    }
 
-        case AWS_ADDRESS_RECORD_TYPE_A:
-            return s_get_lru_address_aux(entry->a_records, entry->failed_connection_a_records);
+    if (element == NULL) {
+        aws_mutex_unlock(&default_host_resolver->resolver_lock);
+        return AWS_OP_SUCCESS;
+    }
+
+    struct host_entry *host_entry = element->value;
+    AWS_FATAL_ASSERT(host_entry);
+
+    /* the cached record carries the latency into the snapshots of later resolution passes */
+    uint64_t smoothed_latency_ns = 0;
+    aws_mutex_lock(&host_entry->entry_lock);
+    struct aws_host_address *cached_address =
+        s_find_cached_address(host_entry, address->address, address->record_type);
+    if (cached_address) {
+        if (cached_address->connect_latency_ns == 0) {
+            cached_address->connect_latency_ns = connect_latency_ns;
+        } else {
+            cached_address->connect_latency_ns =
+                cached_address->connect_latency_ns - cached_address->connect_latency_ns / 4 + connect_latency_ns / 4;
+        }
+        smoothed_latency_ns = cached_address->connect_latency_ns;
+    }
+    aws_mutex_unlock(&host_entry->entry_lock);
+
+    /* and the published snapshot lets cache hits pick by it right away */
+    aws_rw_lock_rlock(&default_host_resolver->host_entry_table_lock);
+    struct host_address_snapshot *snapshot = host_entry->address_snapshot;
+    if (cached_address && snapshot) {
+        size_t first = address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? 0 : snapshot->aaaa_count;
+        size_t count = address->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA ? snapshot->aaaa_count : snapshot->a_count;
+        for (size_t i = first; i < first + count; ++i) {
+            if (aws_string_eq(snapshot->addresses[i].address, address->address)) {
+                aws_atomic_store_int(&snapshot->connect_latencies_ns[i], (size_t)smoothed_latency_ns);
+                break;
+            }
+        }
+    }
+    aws_rw_lock_runlock(&default_host_resolver->host_entry_table_lock);
+
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_DNS,
+        "id=%p: recording connect latency of %llu ns for record %s for %s",
+        (void *)resolver,
+        (unsigned long long)connect_latency_ns,
+        address->address->bytes,
+        address->host->bytes);
+
+    return AWS_OP_SUCCESS;
+}
+
+static struct aws_host_address *s_get_lru_address_aux(
+    struct aws_cache *primary_records,
+    struct aws_cache *fallback_records) {
+
+    struct aws_host_address *address = aws_lru_cache_use_lru_element(primary_records);
+    if (address == NULL) {
+        aws_lru_cache_use_lru_element(fallback_records);
+    }
+
+    return address;
+}
+
+/*
+ * Looks in both the good and failed connection record sets for the LRU host record
+ */
+static struct aws_host_address *s_get_lru_address(struct host_entry *entry, enum aws_address_record_type record_type) {
+    switch (record_type) {
+        case AWS_ADDRESS_RECORD_TYPE_AAAA:
+            return s_get_lru_address_aux(entry->aaaa_records, entry->failed_connection_aaaa_records);
+
+        case AWS_ADDRESS_RECORD_TYPE_A:
+            return s_get_lru_address_aux(entry->a_records, entry->failed_connection_a_records);
 
         default:
             return NULL;
@@ -636,6 +1719,11 @@ static void s_update_address_cache(
             aws_host_address_move(fresh_resolved_address, address_to_cache);
             address_to_cache->expiry = new_expiration;
 
+            /* every copy made from here on, for callbacks, snapshots and listeners, shares these */
+            s_share_string(host_entry->allocator, &address_to_cache->address);
+            aws_string_destroy((void *)address_to_cache->host);
+            address_to_cache->host = s_shared_string_new(host_entry->allocator, host_entry->host_name);
+
             struct aws_cache *address_table = address_to_cache->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
                                                   ? host_entry->aaaa_records
                                                   : host_entry->a_records;
@@ -725,12 +1813,6 @@ static void s_copy_address_into_callback_set(
     }
 }
 
-static bool s_host_entry_finished_pred(void *user_data) {
-    struct host_entry *entry = user_data;
-
-    return entry->state == DRS_SHUTTING_DOWN;
-}
-
 /* Move all of the listeners in the host-resolver-owned listener entry to the resolver thread owned list. */
 /* Assumes resolver_lock is held so that we can pop from the listener entry and access the listener's synced_data. */
 static void s_resolver_thread_move_listeners_from_listener_entry(
@@ -862,9 +1944,12 @@ static void s_resolver_thread_notify_listeners(
     }
 }
 
-static void resolver_thread_fn(void *arg) {
-    struct host_entry *host_entry = arg;
-
+/*
+ * The second half of a resolution pass, run when an entry comes due again: picks up listener changes, decides
+ * whether the entry has been idle long enough to retire and tells listeners about addresses the previous pass found.
+ * Returns false if the entry was retired, in which case it has been removed from the host entry table.
+ */
+static bool s_host_entry_refresh_listeners(struct host_entry *host_entry) {
     size_t unsolicited_resolve_max = host_entry->resolution_config.max_ttl;
     if (unsolicited_resolve_max == 0) {
         unsolicited_resolve_max = 1;
@@ -873,201 +1958,327 @@ static void resolver_thread_fn(void *arg) {
     uint64_t max_no_solicitation_interval =
         aws_timestamp_convert(unsolicited_resolve_max, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
 
-    struct aws_array_list address_list;
-    if (aws_array_list_init_dynamic(&address_list, host_entry->allocator, 4, sizeof(struct aws_host_address))) {
-        return;
+    struct aws_linked_list listener_destroy_list;
+    aws_linked_list_init(&listener_destroy_list);
+
+    /*
+     * In order to maintain the consistent view of the resolver table (entry exist => entry is alive and can be
+     * queried) we have the resolver lock as well before making the decision to remove the entry from the table.
+     */
+    struct default_host_resolver *resolver = host_entry->resolver->impl;
+    aws_mutex_lock(&resolver->resolver_lock);
+
+    /* Remove any listeners from our listener list that have been marked pending destroy, moving them into the
+     * destroy list. */
+    s_resolver_thread_cull_pending_destroy_listeners(&host_entry->listener_list, &listener_destroy_list);
+
+    /* Grab any listeners on the listener entry, moving them into the local list. */
+    s_resolver_thread_move_listeners_from_listener_entry(resolver, host_entry->host_name, &host_entry->listener_list);
+
+    aws_mutex_lock(&host_entry->entry_lock);
+
+    uint64_t now = 0;
+    aws_sys_clock_get_ticks(&now);
+
+    /* hits served from the snapshot count as requests made some time during the last pass */
+    if (aws_atomic_exchange_int(&host_entry->requested_since_last_pass, 0)) {
+        host_entry->last_resolve_request_timestamp_ns = now;
+        host_entry->resolves_since_last_request = 0;
     }
 
-    struct aws_array_list new_address_list;
-    if (aws_array_list_init_dynamic(&new_address_list, host_entry->allocator, 4, sizeof(struct aws_host_address))) {
-        aws_array_list_clean_up(&address_list);
-        return;
+    /*
+     * Ideally this should just be time-based, but given the non-determinism of scheduling and clock time, I feel much
+     * more comfortable keeping an additional constraint in terms of iterations.
+     *
+     * Note that we have the entry lock now and if any queries have arrived since our last resolution,
+     * resolves_since_last_request will be 0 or 1 (depending on timing) and so this check will always fail in that
+     * case leading to another pass to satisfy the pending query(ies).
+     *
+     * The only way we retire the entry with pending queries is if the resolver itself has no more references
+     * to it and is going away.  In that case, the pending queries will be completed (with failure) by the
+     * final clean up of this entry.
+     */
+    if (host_entry->resolves_since_last_request > unsolicited_resolve_max &&
+        host_entry->last_resolve_request_timestamp_ns + max_no_solicitation_interval < now) {
+        host_entry->state = DRS_SHUTTING_DOWN;
+    }
+
+    bool keep_going = host_entry->state == DRS_ACTIVE;
+    if (!keep_going) {
+        /* a purged entry is already out of the table, and a new entry for the same host may have taken its place */
+        struct aws_hash_element *element = NULL;
+        aws_hash_table_find(&resolver->host_entry_table, host_entry->host_name, &element);
+        if (element != NULL && element->value == host_entry) {
+            aws_rw_lock_wlock(&resolver->host_entry_table_lock);
+            aws_hash_table_remove_element(&resolver->host_entry_table, element);
+            aws_rw_lock_wunlock(&resolver->host_entry_table_lock);
+        }
+
+        /* Move any local listeners we have back to the listener entry */
+        if (s_resolver_thread_move_listeners_to_listener_entry(
+                resolver, host_entry->host_name, &host_entry->listener_list)) {
+            AWS_LOGF_ERROR(AWS_LS_IO_DNS, "static: could not clean up all listeners from resolver thread.");
+        }
     }
 
-    struct aws_linked_list listener_list;
-    aws_linked_list_init(&listener_list);
+    aws_mutex_unlock(&host_entry->entry_lock);
+    aws_mutex_unlock(&resolver->resolver_lock);
 
-    struct aws_linked_list listener_destroy_list;
-    aws_linked_list_init(&listener_destroy_list);
+    /* Destroy any listeners in our destroy list. */
+    s_resolver_thread_destroy_listeners(&listener_destroy_list);
 
-    bool keep_going = true;
-    while (keep_going) {
+    /* Notify our local listeners of new addresses. */
+    s_resolver_thread_notify_listeners(&host_entry->new_address_list, &host_entry->listener_list);
 
-        AWS_LOGF_TRACE(AWS_LS_IO_DNS, "static, resolving %s", aws_string_c_str(host_entry->host_name));
+    s_clear_address_list(&host_entry->new_address_list);
 
-        /* resolve and then process each record */
-        int err_code = AWS_ERROR_SUCCESS;
-        if (host_entry->resolution_config.impl(
-                host_entry->allocator, host_entry->host_name, &address_list, host_entry->resolution_config.impl_data)) {
+    return keep_going;
+}
 
-            err_code = aws_last_error();
-        }
-        uint64_t timestamp = 0;
-        aws_sys_clock_get_ticks(&timestamp);
-        uint64_t new_expiry = timestamp + (host_entry->resolution_config.max_ttl * NS_PER_SEC);
+/* Resolves the host once, updates the cache and answers every query that was waiting on it. */
+static void s_host_entry_resolve(struct host_entry *host_entry, struct aws_array_list *address_list) {
+    AWS_LOGF_TRACE(AWS_LS_IO_DNS, "static, resolving %s", aws_string_c_str(host_entry->host_name));
 
-        struct aws_linked_list pending_resolve_copy;
-        aws_linked_list_init(&pending_resolve_copy);
+    /* resolve and then process each record */
+    int err_code = AWS_ERROR_SUCCESS;
+    uint64_t resolve_start_ns = 0;
+    aws_high_res_clock_get_ticks(&resolve_start_ns);
+    if (host_entry->resolution_config.impl(
+            host_entry->allocator, host_entry->host_name, address_list, host_entry->resolution_config.impl_data)) {
 
-        /*
-         * Within the lock we
-         *  (1) Update the cache with the newly resolved addresses
-         *  (2) Process all held addresses looking for expired or promotable ones
-         *  (3) Prep for callback invocations
-         */
-        aws_mutex_lock(&host_entry->entry_lock);
+        err_code = aws_last_error();
+    }
+    uint64_t resolve_end_ns = 0;
+    aws_high_res_clock_get_ticks(&resolve_end_ns);
+    if (resolve_end_ns >= resolve_start_ns) {
+        aws_latency_histogram_record_ns(
+            aws_io_get_latency_histogram(AWS_IO_LATENCY_DNS_RESOLVE), resolve_end_ns - resolve_start_ns);
+    }
 
-        if (!err_code) {
-            s_update_address_cache(host_entry, &address_list, new_expiry, &new_address_list);
-        }
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
+    uint64_t new_expiry = timestamp + (host_entry->resolution_config.max_ttl * NS_PER_SEC);
 
-        /*
-         * process and clean_up records in the entry. occasionally, failed connect records will be upgraded
-         * for retry.
-         */
-        process_records(host_entry->allocator, host_entry->aaaa_records, host_entry->failed_connection_aaaa_records);
-        process_records(host_entry->allocator, host_entry->a_records, host_entry->failed_connection_a_records);
+    struct aws_linked_list pending_resolve_copy;
+    aws_linked_list_init(&pending_resolve_copy);
 
-        aws_linked_list_swap_contents(&pending_resolve_copy, &host_entry->pending_resolution_callbacks);
+    /*
+     * Within the lock we
+     *  (1) Update the cache with the newly resolved addresses
+     *  (2) Process all held addresses looking for expired or promotable ones
+     *  (3) Prep for callback invocations
+     */
+    aws_mutex_lock(&host_entry->entry_lock);
 
-        aws_mutex_unlock(&host_entry->entry_lock);
+    if (!err_code) {
+        s_update_address_cache(host_entry, address_list, new_expiry, &host_entry->new_address_list);
+    }
 
-        /*
-         * Clean up resolved addressed outside of the lock
-         */
-        s_clear_address_list(&address_list);
+    /*
+     * process and clean_up records in the entry. occasionally, failed connect records will be upgraded
+     * for retry.
+     */
+    process_records(host_entry->allocator, host_entry->aaaa_records, host_entry->failed_connection_aaaa_records);
+    process_records(host_entry->allocator, host_entry->a_records, host_entry->failed_connection_a_records);
 
-        struct aws_host_address address_array[2];
-        AWS_ZERO_ARRAY(address_array);
+    if (!err_code) {
+        host_entry->negative_error_code = AWS_ERROR_SUCCESS;
+    } else if (
+        host_entry->resolution_config.negative_ttl > 0 && aws_cache_get_element_count(host_entry->aaaa_records) == 0 &&
+        aws_cache_get_element_count(host_entry->a_records) == 0) {
+        host_entry->negative_error_code = err_code;
+        host_entry->negative_expiry_ns = timestamp + (host_entry->resolution_config.negative_ttl * NS_PER_SEC);
+    }
 
-        /*
-         * Perform the actual subscriber notifications
-         */
-        while (!aws_linked_list_empty(&pending_resolve_copy)) {
-            struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
-            struct pending_callback *pending_callback =
-                AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
+    aws_linked_list_swap_contents(&pending_resolve_copy, &host_entry->pending_resolution_callbacks);
 
-            struct aws_array_list callback_address_list;
-            aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+    aws_mutex_unlock(&host_entry->entry_lock);
 
-            aws_mutex_lock(&host_entry->entry_lock);
-            s_copy_address_into_callback_set(
-                s_get_lru_address(host_entry, AWS_ADDRESS_RECORD_TYPE_AAAA),
-                &callback_address_list,
-                host_entry->host_name);
-            s_copy_address_into_callback_set(
-                s_get_lru_address(host_entry, AWS_ADDRESS_RECORD_TYPE_A),
-                &callback_address_list,
-                host_entry->host_name);
-            aws_mutex_unlock(&host_entry->entry_lock);
+    s_publish_host_address_snapshot(host_entry);
 
-            AWS_ASSERT(err_code != AWS_ERROR_SUCCESS || aws_array_list_length(&callback_address_list) > 0);
+    /*
+     * Clean up resolved addressed outside of the lock
+     */
+    s_clear_address_list(address_list);
 
-            if (aws_array_list_length(&callback_address_list) > 0) {
-                pending_callback->callback(
-                    host_entry->resolver,
-                    host_entry->host_name,
-                    AWS_OP_SUCCESS,
-                    &callback_address_list,
-                    pending_callback->user_data);
+    struct aws_host_address address_array[2];
+    AWS_ZERO_ARRAY(address_array);
 
-            } else {
-                pending_callback->callback(
-                    host_entry->resolver, host_entry->host_name, err_code, NULL, pending_callback->user_data);
-            }
+    /*
+     * Perform the actual subscriber notifications, batching the ones bound for each event loop into one task
+     */
+    struct host_resolved_batch batch;
+    s_host_resolved_batch_init(&batch, host_entry->resolver, host_entry->host_name);
 
-            s_clear_address_list(&callback_address_list);
+    while (!aws_linked_list_empty(&pending_resolve_copy)) {
+        struct aws_linked_list_node *resolution_callback_node = aws_linked_list_pop_front(&pending_resolve_copy);
+        struct pending_callback *pending_callback =
+            AWS_CONTAINER_OF(resolution_callback_node, struct pending_callback, node);
 
-            aws_mem_release(host_entry->allocator, pending_callback);
-        }
+        struct aws_array_list callback_address_list;
+        aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
 
         aws_mutex_lock(&host_entry->entry_lock);
+        s_copy_address_into_callback_set(
+            s_get_lru_address(host_entry, AWS_ADDRESS_RECORD_TYPE_AAAA),
+            &callback_address_list,
+            host_entry->host_name);
+        s_copy_address_into_callback_set(
+            s_get_lru_address(host_entry, AWS_ADDRESS_RECORD_TYPE_A), &callback_address_list, host_entry->host_name);
+        aws_mutex_unlock(&host_entry->entry_lock);
+
+        AWS_ASSERT(err_code != AWS_ERROR_SUCCESS || aws_array_list_length(&callback_address_list) > 0);
+
+        s_host_resolved_batch_add(
+            &batch,
+            pending_callback->event_loop,
+            pending_callback->callback,
+            pending_callback->user_data,
+            aws_array_list_length(&callback_address_list) > 0 ? AWS_OP_SUCCESS : err_code,
+            &callback_address_list);
+
+        s_clear_address_list(&callback_address_list);
+
+        aws_mem_release(host_entry->allocator, pending_callback);
+    }
+
+    s_host_resolved_batch_flush(&batch);
+
+    aws_mutex_lock(&host_entry->entry_lock);
+    ++host_entry->resolves_since_last_request;
+    aws_mutex_unlock(&host_entry->entry_lock);
+}
+
+/*
+ * One resolution pass for an entry that came due. Afterwards the entry is either scheduled again resolve_frequency_ns
+ * from now or retired.
+ */
+static void s_run_host_entry_resolution(struct host_entry *host_entry, struct aws_array_list *address_list) {
+    struct default_host_resolver *resolver = host_entry->resolver->impl;
+
+    while (true) {
+        if (host_entry->resolved_once && !s_host_entry_refresh_listeners(host_entry)) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_DNS,
+                "static: Either no requests have been made for an address for %s for the duration "
+                "of the ttl, or this entry is being forcibly shutdown. Retiring entry.",
+                host_entry->host_name->bytes);
 
-        ++host_entry->resolves_since_last_request;
+            s_on_host_entry_shutdown_completion(host_entry);
+            return;
+        }
 
-        /* wait for a quit notification or the base resolve frequency time interval */
-        aws_condition_variable_wait_for_pred(
-            &host_entry->entry_signal,
-            &host_entry->entry_lock,
-            host_entry->resolve_frequency_ns,
-            s_host_entry_finished_pred,
-            host_entry);
+        s_host_entry_resolve(host_entry, address_list);
+        host_entry->resolved_once = true;
 
+        aws_mutex_lock(&host_entry->entry_lock);
+        bool shutting_down = host_entry->state == DRS_SHUTTING_DOWN;
         aws_mutex_unlock(&host_entry->entry_lock);
 
-        /*
-         * This is a bit awkward that we unlock the entry and then relock both the resolver and the entry, but it
-         * is mandatory that -- in order to maintain the consistent view of the resolver table (entry exist => entry
-         * is alive and can be queried) -- we have the resolver lock as well before making the decision to remove
-         * the entry from the table and terminate the thread.
-         */
-        struct default_host_resolver *resolver = host_entry->resolver->impl;
+        if (shutting_down) {
+            /* shut down while resolving, retire it now instead of after another resolve_frequency_ns */
+            continue;
+        }
+
+        uint64_t now = 0;
+        aws_sys_clock_get_ticks(&now);
+
         aws_mutex_lock(&resolver->resolver_lock);
+        int schedule_result = s_schedule_host_entry(host_entry, now + (uint64_t)host_entry->resolve_frequency_ns);
+        aws_mutex_unlock(&resolver->resolver_lock);
 
-        /* Remove any listeners from our listener list that have been marked pending destroy, moving them into the
-         * destroy list. */
-        s_resolver_thread_cull_pending_destroy_listeners(&listener_list, &listener_destroy_list);
+        if (schedule_result == AWS_OP_SUCCESS) {
+            return;
+        }
 
-        /* Grab any listeners on the listener entry, moving them into the local list. */
-        s_resolver_thread_move_listeners_from_listener_entry(resolver, host_entry->host_name, &listener_list);
+        /* nowhere to put the entry, so retire it now. Queries will just create a new one. */
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_DNS,
+            "static: could not schedule the next resolution for %s, error %d",
+            host_entry->host_name->bytes,
+            aws_last_error());
 
         aws_mutex_lock(&host_entry->entry_lock);
+        host_entry->state = DRS_SHUTTING_DOWN;
+        aws_mutex_unlock(&host_entry->entry_lock);
+    }
+}
 
+static void s_resolver_worker_thread_fn(void *arg) {
+    struct resolver_worker *worker = arg;
+    struct default_host_resolver *resolver = worker->resolver->impl;
+
+    /* scratch space for resolution results, reused across passes. Nothing is allocated up front, so this can't fail. */
+    struct aws_array_list address_list;
+    aws_array_list_init_dynamic(&address_list, resolver->allocator, 0, sizeof(struct aws_host_address));
+
+    aws_mutex_lock(&resolver->resolver_lock);
+
+    while (true) {
         uint64_t now = 0;
         aws_sys_clock_get_ticks(&now);
 
-        /*
-         * Ideally this should just be time-based, but given the non-determinism of waits (and spurious wake ups) and
-         * clock time, I feel much more comfortable keeping an additional constraint in terms of iterations.
-         *
-         * Note that we have the entry lock now and if any queries have arrived since our last resolution,
-         * resolves_since_last_request will be 0 or 1 (depending on timing) and so, regardless of wait and wake up
-         * timings, this check will always fail in that case leading to another iteration to satisfy the pending
-         * query(ies).
-         *
-         * The only way we terminate the loop with pending queries is if the resolver itself has no more references
-         * to it and is going away.  In that case, the pending queries will be completed (with failure) by the
-         * final clean up of this entry.
-         */
-        if (host_entry->resolves_since_last_request > unsolicited_resolve_max &&
-            host_entry->last_resolve_request_timestamp_ns + max_no_solicitation_interval < now) {
-            host_entry->state = DRS_SHUTTING_DOWN;
-        }
+        if (aws_priority_queue_size(&resolver->scheduled_entries) > 0) {
+            struct host_entry **next_entry = NULL;
+            aws_priority_queue_top(&resolver->scheduled_entries, (void **)&next_entry);
 
-        keep_going = host_entry->state == DRS_ACTIVE;
-        if (!keep_going) {
-            aws_hash_table_remove(&resolver->host_entry_table, host_entry->host_name, NULL, NULL);
+            if ((*next_entry)->next_resolve_time_ns <= now) {
+                struct host_entry *host_entry = NULL;
+                aws_priority_queue_pop(&resolver->scheduled_entries, &host_entry);
+                host_entry->scheduled = false;
 
-            /* Move any local listeners we have back to the listener entry */
-            if (s_resolver_thread_move_listeners_to_listener_entry(resolver, host_entry->host_name, &listener_list)) {
-                AWS_LOGF_ERROR(AWS_LS_IO_DNS, "static: could not clean up all listeners from resolver thread.");
+                aws_mutex_unlock(&resolver->resolver_lock);
+                s_run_host_entry_resolution(host_entry, &address_list);
+                aws_mutex_lock(&resolver->resolver_lock);
+                continue;
             }
-        }
-
-        aws_mutex_unlock(&host_entry->entry_lock);
-        aws_mutex_unlock(&resolver->resolver_lock);
 
-        /* Destroy any listeners in our destroy list. */
-        s_resolver_thread_destroy_listeners(&listener_destroy_list);
+            ++resolver->idle_worker_count;
+            aws_condition_variable_wait_for(
+                &resolver->worker_signal,
+                &resolver->resolver_lock,
+                (int64_t)((*next_entry)->next_resolve_time_ns - now));
+            --resolver->idle_worker_count;
+            continue;
+        }
 
-        /* Notify our local listeners of new addresses. */
-        s_resolver_thread_notify_listeners(&new_address_list, &listener_list);
+        if (resolver->state == DRS_SHUTTING_DOWN && resolver->pending_host_entry_shutdown_completion_callbacks == 0) {
+            break;
+        }
 
-        s_clear_address_list(&new_address_list);
+        ++resolver->idle_worker_count;
+        aws_condition_variable_wait(&resolver->worker_signal, &resolver->resolver_lock);
+        --resolver->idle_worker_count;
     }
 
-    AWS_LOGF_DEBUG(
-        AWS_LS_IO_DNS,
-        "static: Either no requests have been made for an address for %s for the duration "
-        "of the ttl, or this thread is being forcibly shutdown. Killing thread.",
-        host_entry->host_name->bytes)
+    aws_mutex_unlock(&resolver->resolver_lock);
 
     aws_array_list_clean_up(&address_list);
-    aws_array_list_clean_up(&new_address_list);
 
     /* please don't fail */
-    aws_thread_current_at_exit(s_on_host_entry_shutdown_completion, host_entry);
+    aws_thread_current_at_exit(s_on_resolver_worker_exit, worker);
+}
+
+static void s_on_resolver_worker_exit(void *user_data) {
+    struct resolver_worker *worker = user_data;
+    struct aws_host_resolver *resolver = worker->resolver;
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    aws_mem_release(resolver->allocator, worker);
+
+    bool cleanup_resolver = false;
+
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+    --default_host_resolver->worker_count;
+    if (default_host_resolver->state == DRS_SHUTTING_DOWN && default_host_resolver->worker_count == 0 &&
+        default_host_resolver->pending_delivery_count == 0) {
+        cleanup_resolver = true;
+    }
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    if (cleanup_resolver) {
+        s_cleanup_default_resolver(resolver);
+    }
 }
 
 static void on_address_value_removed(void *value) {
@@ -1094,7 +2305,9 @@ static inline int create_and_init_host_entry(
     aws_on_host_resolved_result_fn *res,
     struct aws_host_resolution_config *config,
     uint64_t timestamp,
+    struct aws_event_loop *event_loop,
     void *user_data) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
     struct host_entry *new_host_entry = aws_mem_calloc(resolver->allocator, 1, sizeof(struct host_entry));
     if (!new_host_entry) {
         return AWS_OP_ERR;
@@ -1106,10 +2319,14 @@ static inline int create_and_init_host_entry(
     new_host_entry->resolves_since_last_request = 0;
     new_host_entry->resolve_frequency_ns = NS_PER_SEC;
     new_host_entry->state = DRS_ACTIVE;
+    aws_atomic_init_int(&new_host_entry->requested_since_last_pass, 0);
+    aws_linked_list_init(&new_host_entry->listener_list);
+    aws_linked_list_init(&new_host_entry->pending_resolution_callbacks);
 
-    bool thread_init = false;
+    bool added_to_table = false;
     struct pending_callback *pending_callback = NULL;
-    const struct aws_string *host_string_copy = aws_string_new_from_string(resolver->allocator, host_name);
+    /* shared, so the entry's addresses and the deliveries for it can all point at this one copy */
+    const struct aws_string *host_string_copy = s_shared_string_new(resolver->allocator, host_name);
     if (AWS_UNLIKELY(!host_string_copy)) {
         goto setup_host_entry_error;
     }
@@ -1159,43 +2376,59 @@ static inline int create_and_init_host_entry(
         goto setup_host_entry_error;
     }
 
-    aws_linked_list_init(&new_host_entry->pending_resolution_callbacks);
-
-    pending_callback = aws_mem_acquire(resolver->allocator, sizeof(struct pending_callback));
-
-    if (AWS_UNLIKELY(!pending_callback)) {
+    if (aws_array_list_init_dynamic(
+            &new_host_entry->new_address_list, new_host_entry->allocator, 4, sizeof(struct aws_host_address))) {
         goto setup_host_entry_error;
     }
 
-    /*add the current callback here */
-    pending_callback->user_data = user_data;
-    pending_callback->callback = res;
-    aws_linked_list_push_back(&new_host_entry->pending_resolution_callbacks, &pending_callback->node);
+    /* seeding creates entries nobody is waiting on yet */
+    if (res != NULL) {
+        pending_callback = aws_mem_acquire(resolver->allocator, sizeof(struct pending_callback));
+
+        if (AWS_UNLIKELY(!pending_callback)) {
+            goto setup_host_entry_error;
+        }
+
+        /*add the current callback here */
+        pending_callback->user_data = user_data;
+        pending_callback->callback = res;
+        pending_callback->event_loop = event_loop;
+        aws_linked_list_push_back(&new_host_entry->pending_resolution_callbacks, &pending_callback->node);
+    }
 
     aws_mutex_init(&new_host_entry->entry_lock);
     new_host_entry->resolution_config = *config;
-    aws_condition_variable_init(&new_host_entry->entry_signal);
 
-    if (aws_thread_init(&new_host_entry->resolver_thread, resolver->allocator)) {
+    aws_rw_lock_wlock(&default_host_resolver->host_entry_table_lock);
+    int put_result =
+        aws_hash_table_put(&default_host_resolver->host_entry_table, host_string_copy, new_host_entry, NULL);
+    aws_rw_lock_wunlock(&default_host_resolver->host_entry_table_lock);
+    if (AWS_UNLIKELY(put_result)) {
         goto setup_host_entry_error;
     }
+    added_to_table = true;
 
-    thread_init = true;
-    struct default_host_resolver *default_host_resolver = resolver->impl;
-    if (AWS_UNLIKELY(
-            aws_hash_table_put(&default_host_resolver->host_entry_table, host_string_copy, new_host_entry, NULL))) {
+    /* first resolution is due right away */
+    if (s_schedule_host_entry(new_host_entry, 0)) {
         goto setup_host_entry_error;
     }
 
-    aws_thread_launch(&new_host_entry->resolver_thread, resolver_thread_fn, new_host_entry, NULL);
     ++default_host_resolver->pending_host_entry_shutdown_completion_callbacks;
 
     return AWS_OP_SUCCESS;
 
 setup_host_entry_error:
 
-    if (thread_init) {
-        aws_thread_clean_up(&new_host_entry->resolver_thread);
+    if (added_to_table) {
+        aws_rw_lock_wlock(&default_host_resolver->host_entry_table_lock);
+        aws_hash_table_remove(&default_host_resolver->host_entry_table, host_string_copy, NULL, NULL);
+        aws_rw_lock_wunlock(&default_host_resolver->host_entry_table_lock);
+    }
+
+    /* the caller reports the error, don't also hand it to the callback */
+    if (pending_callback) {
+        aws_linked_list_remove(&pending_callback->node);
+        aws_mem_release(resolver->allocator, pending_callback);
     }
 
     s_clean_up_host_entry(new_host_entry);
@@ -1203,11 +2436,163 @@ setup_host_entry_error:
     return AWS_OP_ERR;
 }
 
-static int default_resolve_host(
+enum host_query_outcome {
+    /* answer with the addresses copied out of the cache */
+    HOST_QUERY_CACHED,
+    /* answer with the error the host recently failed with */
+    HOST_QUERY_NEGATIVE,
+    /* the query waits on the entry's next resolution pass */
+    HOST_QUERY_PENDING,
+    /* the query couldn't be taken, aws_last_error() says why */
+    HOST_QUERY_FAILED,
+};
+
+/*
+ * entry_lock must be held. Looks the query up in an existing entry: cache hits and negative cache hits are copied out
+ * for s_finish_host_query() to answer once every lock is dropped, anything else is parked on the entry's pending
+ * callbacks.
+ */
+static enum host_query_outcome s_host_entry_take_query(
+    struct host_entry *host_entry,
+    uint64_t timestamp,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_event_loop *event_loop,
+    void *user_data,
+    struct aws_array_list *callback_address_list,
+    int *out_error_code) {
+
+    struct default_host_resolver *default_host_resolver = host_entry->resolver->impl;
+
+    host_entry->last_resolve_request_timestamp_ns = timestamp;
+    host_entry->resolves_since_last_request = 0;
+
+    struct aws_host_address *aaaa_record = aws_lru_cache_use_lru_element(host_entry->aaaa_records);
+    struct aws_host_address *a_record = aws_lru_cache_use_lru_element(host_entry->a_records);
+
+    if ((aaaa_record || a_record)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: cached entries found for %s returning to caller.",
+            (void *)host_entry->resolver,
+            host_entry->host_name->bytes);
+
+        /* these will all need to be copied so that we don't hold the lock during the callback. */
+        if (aaaa_record) {
+            struct aws_host_address aaaa_record_cpy;
+            if (!aws_host_address_copy(aaaa_record, &aaaa_record_cpy)) {
+                aws_array_list_push_back(callback_address_list, &aaaa_record_cpy);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "id=%p: vending address %s for host %s to caller",
+                    (void *)host_entry->resolver,
+                    aaaa_record->address->bytes,
+                    host_entry->host_name->bytes);
+            }
+        }
+        if (a_record) {
+            struct aws_host_address a_record_cpy;
+            if (!aws_host_address_copy(a_record, &a_record_cpy)) {
+                aws_array_list_push_back(callback_address_list, &a_record_cpy);
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_DNS,
+                    "id=%p: vending address %s for host %s to caller",
+                    (void *)host_entry->resolver,
+                    a_record->address->bytes,
+                    host_entry->host_name->bytes);
+            }
+        }
+
+        if (aws_array_list_length(callback_address_list) == 0) {
+            *out_error_code = aws_last_error();
+        }
+
+        return HOST_QUERY_CACHED;
+    }
+
+    if (host_entry->negative_error_code != AWS_ERROR_SUCCESS && timestamp < host_entry->negative_expiry_ns) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: %s failed to resolve recently with error %d, failing without waiting for another attempt.",
+            (void *)host_entry->resolver,
+            host_entry->host_name->bytes,
+            host_entry->negative_error_code);
+
+        aws_atomic_fetch_add(&default_host_resolver->negative_cache_hits, 1);
+        *out_error_code = host_entry->negative_error_code;
+        return HOST_QUERY_NEGATIVE;
+    }
+
+    bool coalesced = !aws_linked_list_empty(&host_entry->pending_resolution_callbacks);
+    struct pending_callback *pending_callback =
+        aws_mem_acquire(default_host_resolver->allocator, sizeof(struct pending_callback));
+    if (pending_callback == NULL) {
+        *out_error_code = aws_last_error();
+        return HOST_QUERY_FAILED;
+    }
+
+    pending_callback->user_data = user_data;
+    pending_callback->callback = res;
+    pending_callback->event_loop = event_loop;
+    aws_linked_list_push_back(&host_entry->pending_resolution_callbacks, &pending_callback->node);
+
+    aws_atomic_fetch_add(
+        coalesced ? &default_host_resolver->coalesced_resolutions : &default_host_resolver->fresh_resolutions, 1);
+
+    return HOST_QUERY_PENDING;
+}
+
+/*
+ * Answers a query taken by s_host_entry_take_query(), with no locks held since someone may reentrantly call us from
+ * the callback, on event_loop if the query asked for one. Returns what resolve_host should.
+ */
+static int s_finish_host_query(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    enum host_query_outcome outcome,
+    int error_code,
+    struct aws_array_list *callback_address_list,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_event_loop *event_loop,
+    void *user_data) {
+
+    struct host_resolved_batch batch;
+    s_host_resolved_batch_init(&batch, resolver, host_name);
+
+    int result = AWS_OP_SUCCESS;
+    switch (outcome) {
+        case HOST_QUERY_CACHED:
+            if (aws_array_list_length(callback_address_list)) {
+                s_host_resolved_batch_add(&batch, event_loop, res, user_data, AWS_OP_SUCCESS, callback_address_list);
+            } else {
+                s_host_resolved_batch_add(&batch, event_loop, res, user_data, error_code, NULL);
+                result = aws_raise_error(error_code);
+            }
+            break;
+
+        case HOST_QUERY_NEGATIVE:
+            s_host_resolved_batch_add(&batch, event_loop, res, user_data, error_code, NULL);
+            break;
+
+        case HOST_QUERY_PENDING:
+            break;
+
+        case HOST_QUERY_FAILED:
+            result = aws_raise_error(error_code);
+            break;
+    }
+
+    s_host_resolved_batch_flush(&batch);
+    s_clear_address_list(callback_address_list);
+
+    return result;
+}
+
+static int s_default_resolve_host(
     struct aws_host_resolver *resolver,
     const struct aws_string *host_name,
     aws_on_host_resolved_result_fn *res,
     struct aws_host_resolution_config *config,
+    struct aws_event_loop *event_loop,
     void *user_data) {
     int result = AWS_OP_SUCCESS;
 
@@ -1217,9 +2602,48 @@ static int default_resolve_host(
     aws_sys_clock_get_ticks(&timestamp);
 
     struct default_host_resolver *default_host_resolver = resolver->impl;
-    aws_mutex_lock(&default_host_resolver->resolver_lock);
 
+    struct aws_host_address address_array[2];
+    AWS_ZERO_ARRAY(address_array);
+    struct aws_array_list callback_address_list;
+    aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+
+    /*
+     * Cache hits, by far the common case, are served from the entry's published snapshot under a shared lock so
+     * queries from every event loop don't queue up behind resolver_lock and entry_lock.
+     */
+    bool cache_hit = false;
+    aws_rw_lock_rlock(&default_host_resolver->host_entry_table_lock);
     struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&default_host_resolver->host_entry_table, host_name, &element);
+    if (element != NULL) {
+        struct host_entry *cached_entry = element->value;
+        if (cached_entry->address_snapshot != NULL) {
+            cache_hit = true;
+            /* skip the store when already set, so hits from many threads don't keep bouncing the cache line */
+            if (aws_atomic_load_int(&cached_entry->requested_since_last_pass) == 0) {
+                aws_atomic_store_int(&cached_entry->requested_since_last_pass, 1);
+            }
+            s_copy_addresses_from_snapshot(cached_entry->address_snapshot, &callback_address_list);
+        }
+    }
+    aws_rw_lock_runlock(&default_host_resolver->host_entry_table_lock);
+
+    if (cache_hit) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: cached entries found for %s returning to caller.",
+            (void *)resolver,
+            host_name->bytes);
+
+        int error_code = aws_array_list_length(&callback_address_list) > 0 ? AWS_ERROR_SUCCESS : aws_last_error();
+        return s_finish_host_query(
+            resolver, host_name, HOST_QUERY_CACHED, error_code, &callback_address_list, res, event_loop, user_data);
+    }
+
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+
+    element = NULL;
     /* we don't care about the error code here, only that the host_entry was found or not. */
     aws_hash_table_find(&default_host_resolver->host_entry_table, host_name, &element);
 
@@ -1236,9 +2660,13 @@ static int default_resolve_host(
             (void *)resolver,
             host_name->bytes);
 
-        result = create_and_init_host_entry(resolver, host_name, res, config, timestamp, user_data);
+        result = create_and_init_host_entry(resolver, host_name, res, config, timestamp, event_loop, user_data);
         aws_mutex_unlock(&default_host_resolver->resolver_lock);
 
+        if (result == AWS_OP_SUCCESS) {
+            aws_atomic_fetch_add(&default_host_resolver->fresh_resolutions, 1);
+        }
+
         return result;
     }
 
@@ -1250,80 +2678,238 @@ static int default_resolve_host(
      * things query other entries.
      */
     aws_mutex_unlock(&default_host_resolver->resolver_lock);
-    host_entry->last_resolve_request_timestamp_ns = timestamp;
-    host_entry->resolves_since_last_request = 0;
 
-    struct aws_host_address *aaaa_record = aws_lru_cache_use_lru_element(host_entry->aaaa_records);
-    struct aws_host_address *a_record = aws_lru_cache_use_lru_element(host_entry->a_records);
+    int error_code = AWS_ERROR_SUCCESS;
+    enum host_query_outcome outcome = s_host_entry_take_query(
+        host_entry, timestamp, res, event_loop, user_data, &callback_address_list, &error_code);
+    aws_mutex_unlock(&host_entry->entry_lock);
+
+    return s_finish_host_query(
+        resolver, host_name, outcome, error_code, &callback_address_list, res, event_loop, user_data);
+}
+
+static int default_resolve_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
+    return s_default_resolve_host(resolver, host_name, res, config, NULL, user_data);
+}
+
+static int default_resolve_host_on_event_loop(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    struct aws_event_loop *event_loop,
+    void *user_data) {
+    return s_default_resolve_host(resolver, host_name, res, config, event_loop, user_data);
+}
+
+struct batch_host_query {
     struct aws_host_address address_array[2];
-    AWS_ZERO_ARRAY(address_array);
     struct aws_array_list callback_address_list;
-    aws_array_list_init_static(&callback_address_list, address_array, 2, sizeof(struct aws_host_address));
+    enum host_query_outcome outcome;
+    int error_code;
+};
 
-    if ((aaaa_record || a_record)) {
-        AWS_LOGF_DEBUG(
-            AWS_LS_IO_DNS,
-            "id=%p: cached entries found for %s returning to caller.",
-            (void *)resolver,
-            host_name->bytes);
+/*
+ * Takes resolver_lock once for the whole batch, so a warm-up burst doesn't contend with itself, and answers whatever
+ * it can from the cache only after dropping it.
+ */
+static int default_resolve_hosts(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *const *host_names,
+    size_t host_count,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
 
-        /* these will all need to be copied so that we don't hold the lock during the callback. */
-        if (aaaa_record) {
-            struct aws_host_address aaaa_record_cpy;
-            if (!aws_host_address_copy(aaaa_record, &aaaa_record_cpy)) {
-                aws_array_list_push_back(&callback_address_list, &aaaa_record_cpy);
-                AWS_LOGF_TRACE(
-                    AWS_LS_IO_DNS,
-                    "id=%p: vending address %s for host %s to caller",
-                    (void *)resolver,
-                    aaaa_record->address->bytes,
-                    host_entry->host_name->bytes);
-            }
-        }
-        if (a_record) {
-            struct aws_host_address a_record_cpy;
-            if (!aws_host_address_copy(a_record, &a_record_cpy)) {
-                aws_array_list_push_back(&callback_address_list, &a_record_cpy);
-                AWS_LOGF_TRACE(
-                    AWS_LS_IO_DNS,
-                    "id=%p: vending address %s for host %s to caller",
-                    (void *)resolver,
-                    a_record->address->bytes,
-                    host_entry->host_name->bytes);
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_DNS,
+        "id=%p: Host resolution requested for a batch of %llu hosts",
+        (void *)resolver,
+        (unsigned long long)host_count);
+
+    struct batch_host_query *queries = aws_mem_calloc(resolver->allocator, host_count, sizeof(struct batch_host_query));
+    if (queries == NULL) {
+        return AWS_OP_ERR;
+    }
+
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
+
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+
+    for (size_t i = 0; i < host_count; ++i) {
+        struct batch_host_query *query = &queries[i];
+        aws_array_list_init_static(
+            &query->callback_address_list, query->address_array, 2, sizeof(struct aws_host_address));
+
+        struct aws_hash_element *element = NULL;
+        aws_hash_table_find(&default_host_resolver->host_entry_table, host_names[i], &element);
+        if (element == NULL) {
+            if (create_and_init_host_entry(resolver, host_names[i], res, config, timestamp, NULL, user_data)) {
+                query->outcome = HOST_QUERY_FAILED;
+                query->error_code = aws_last_error();
+            } else {
+                query->outcome = HOST_QUERY_PENDING;
+                aws_atomic_fetch_add(&default_host_resolver->fresh_resolutions, 1);
             }
+            continue;
         }
+
+        struct host_entry *host_entry = element->value;
+        aws_mutex_lock(&host_entry->entry_lock);
+        query->outcome = s_host_entry_take_query(
+            host_entry, timestamp, res, NULL, user_data, &query->callback_address_list, &query->error_code);
         aws_mutex_unlock(&host_entry->entry_lock);
+    }
 
-        /* we don't want to do the callback WHILE we hold the lock someone may reentrantly call us. */
-        if (aws_array_list_length(&callback_address_list)) {
-            res(resolver, host_name, AWS_OP_SUCCESS, &callback_address_list, user_data);
-        } else {
-            res(resolver, host_name, aws_last_error(), NULL, user_data);
-            result = AWS_OP_ERR;
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    for (size_t i = 0; i < host_count; ++i) {
+        struct batch_host_query *query = &queries[i];
+
+        /* unlike a single resolve_host, every host in a batch hears back through its callback */
+        if (query->outcome == HOST_QUERY_FAILED) {
+            res(resolver, host_names[i], query->error_code, NULL, user_data);
+            continue;
         }
 
-        for (size_t i = 0; i < aws_array_list_length(&callback_address_list); ++i) {
-            struct aws_host_address *address_ptr = NULL;
-            aws_array_list_get_at_ptr(&callback_address_list, (void **)&address_ptr, i);
-            aws_host_address_clean_up(address_ptr);
+        s_finish_host_query(
+            resolver,
+            host_names[i],
+            query->outcome,
+            query->error_code,
+            &query->callback_address_list,
+            res,
+            NULL,
+            user_data);
+    }
+
+    aws_mem_release(resolver->allocator, queries);
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Seeded addresses are stale from the start: they're vended like any other until the entry's first resolution pass,
+ * which refreshes the ones dns confirms and purges the rest (all but one, if dns gives us nothing).
+ */
+static int default_seed_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    const struct aws_array_list *addresses,
+    struct aws_host_resolution_config *config) {
+
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    uint64_t timestamp = 0;
+    aws_sys_clock_get_ticks(&timestamp);
+
+    int result = AWS_OP_SUCCESS;
+    aws_mutex_lock(&default_host_resolver->resolver_lock);
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&default_host_resolver->host_entry_table, host_name, &element);
+    if (element == NULL) {
+        if (create_and_init_host_entry(resolver, host_name, NULL, config, timestamp, NULL, NULL)) {
+            aws_mutex_unlock(&default_host_resolver->resolver_lock);
+            return AWS_OP_ERR;
         }
 
-        aws_array_list_clean_up(&callback_address_list);
+        aws_hash_table_find(&default_host_resolver->host_entry_table, host_name, &element);
+        AWS_FATAL_ASSERT(element != NULL);
+    }
+
+    struct host_entry *host_entry = element->value;
 
-        return result;
+    aws_mutex_lock(&host_entry->entry_lock);
+    for (size_t i = 0; i < aws_array_list_length(addresses); ++i) {
+        struct aws_host_address *seed_address = NULL;
+        aws_array_list_get_at_ptr(addresses, (void **)&seed_address, i);
+
+        if (s_find_cached_address(host_entry, seed_address->address, seed_address->record_type) != NULL) {
+            continue;
+        }
+
+        struct aws_host_address *address_to_cache =
+            aws_mem_calloc(host_entry->allocator, 1, sizeof(struct aws_host_address));
+        if (address_to_cache == NULL) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        address_to_cache->allocator = host_entry->allocator;
+        address_to_cache->host = s_shared_string_new(host_entry->allocator, host_entry->host_name);
+        address_to_cache->address = s_shared_string_new(host_entry->allocator, seed_address->address);
+        address_to_cache->record_type = seed_address->record_type;
+        address_to_cache->expiry = timestamp;
+
+        struct aws_cache *address_table = address_to_cache->record_type == AWS_ADDRESS_RECORD_TYPE_AAAA
+                                              ? host_entry->aaaa_records
+                                              : host_entry->a_records;
+
+        if (address_to_cache->host == NULL || address_to_cache->address == NULL ||
+            aws_cache_put(address_table, address_to_cache->address, address_to_cache)) {
+            aws_host_address_clean_up(address_to_cache);
+            aws_mem_release(host_entry->allocator, address_to_cache);
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_DNS,
+            "id=%p: seeded address %s for host %s",
+            (void *)resolver,
+            address_to_cache->address->bytes,
+            host_entry->host_name->bytes);
     }
+    aws_mutex_unlock(&host_entry->entry_lock);
 
-    struct pending_callback *pending_callback =
-        aws_mem_acquire(default_host_resolver->allocator, sizeof(struct pending_callback));
-    if (pending_callback != NULL) {
-        pending_callback->user_data = user_data;
-        pending_callback->callback = res;
-        aws_linked_list_push_back(&host_entry->pending_resolution_callbacks, &pending_callback->node);
-    } else {
-        result = AWS_OP_ERR;
+    /* the resolver lock keeps the entry in the table, and so alive, while we publish */
+    s_publish_host_address_snapshot(host_entry);
+    aws_mutex_unlock(&default_host_resolver->resolver_lock);
+
+    return result;
+}
+
+/* Reads every entry's published snapshot, so this doesn't compete with resolution passes for the entry locks. */
+static int default_copy_cached_addresses(struct aws_host_resolver *resolver, struct aws_array_list *out_addresses) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    int result = AWS_OP_SUCCESS;
+    aws_rw_lock_rlock(&default_host_resolver->host_entry_table_lock);
+
+    struct aws_hash_table *table = &default_host_resolver->host_entry_table;
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(table); !aws_hash_iter_done(&iter) && result == AWS_OP_SUCCESS;
+         aws_hash_iter_next(&iter)) {
+        struct host_entry *host_entry = iter.element.value;
+        struct host_address_snapshot *snapshot = host_entry->address_snapshot;
+        if (snapshot == NULL) {
+            continue;
+        }
+
+        for (size_t i = 0; i < snapshot->aaaa_count + snapshot->a_count; ++i) {
+            struct aws_host_address address_copy;
+            if (aws_host_address_copy(&snapshot->addresses[i], &address_copy)) {
+                result = AWS_OP_ERR;
+                break;
+            }
+
+            if (aws_array_list_push_back(out_addresses, &address_copy)) {
+                aws_host_address_clean_up(&address_copy);
+                result = AWS_OP_ERR;
+                break;
+            }
+        }
     }
 
-    aws_mutex_unlock(&host_entry->entry_lock);
+    aws_rw_lock_runlock(&default_host_resolver->host_entry_table_lock);
 
     return result;
 }
@@ -1361,13 +2947,30 @@ static size_t default_get_host_address_count(
     return address_count;
 }
 
+static int default_get_stats(struct aws_host_resolver *resolver, struct aws_host_resolver_stats *out_stats) {
+    struct default_host_resolver *default_host_resolver = resolver->impl;
+
+    AWS_ZERO_STRUCT(*out_stats);
+    out_stats->fresh_resolutions = aws_atomic_load_int(&default_host_resolver->fresh_resolutions);
+    out_stats->coalesced_resolutions = aws_atomic_load_int(&default_host_resolver->coalesced_resolutions);
+    out_stats->negative_cache_hits = aws_atomic_load_int(&default_host_resolver->negative_cache_hits);
+
+    return AWS_OP_SUCCESS;
+}
+
 static struct aws_host_resolver_vtable s_vtable = {
     .purge_cache = resolver_purge_cache,
     .resolve_host = default_resolve_host,
+    .resolve_host_on_event_loop = default_resolve_host_on_event_loop,
     .record_connection_failure = resolver_record_connection_failure,
+    .record_connection_success = resolver_record_connection_success,
     .get_host_address_count = default_get_host_address_count,
     .add_host_listener = default_add_host_listener,
     .remove_host_listener = default_remove_host_listener,
+    .get_stats = default_get_stats,
+    .resolve_hosts = default_resolve_hosts,
+    .seed_host = default_seed_host,
+    .copy_cached_addresses = default_copy_cached_addresses,
     .destroy = resolver_destroy,
 };
 
@@ -1416,9 +3019,23 @@ struct aws_host_resolver *aws_host_resolver_new_default(
     default_host_resolver->pending_host_entry_shutdown_completion_callbacks = 0;
     default_host_resolver->state = DRS_ACTIVE;
     aws_mutex_init(&default_host_resolver->resolver_lock);
+    aws_rw_lock_init(&default_host_resolver->host_entry_table_lock);
+    aws_condition_variable_init(&default_host_resolver->worker_signal);
+    aws_atomic_init_int(&default_host_resolver->fresh_resolutions, 0);
+    aws_atomic_init_int(&default_host_resolver->coalesced_resolutions, 0);
+    aws_atomic_init_int(&default_host_resolver->negative_cache_hits, 0);
 
     aws_global_thread_creator_increment();
 
+    if (aws_priority_queue_init_dynamic(
+            &default_host_resolver->scheduled_entries,
+            allocator,
+            max_entries,
+            sizeof(struct host_entry *),
+            s_compare_host_entry_resolve_times)) {
+        goto on_error;
+    }
+
     if (aws_hash_table_init(
             &default_host_resolver->host_entry_table,
             allocator,
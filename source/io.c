@@ -154,6 +154,12 @@ static struct aws_error_info s_errors[] = {
     AWS_DEFINE_ERROR_INFO_IO(
        AWS_IO_RETRY_PERMISSION_DENIED,
        "Retry cannot be attempted because the retry strategy has prevented the operation."),
+    AWS_DEFINE_ERROR_INFO_IO(
+       AWS_IO_CHANNEL_IDLE_TIMEOUT,
+       "Channel shutdown because no data was read or written within the idle timeout."),
+    AWS_DEFINE_ERROR_INFO_IO(
+       AWS_IO_CHANNEL_DRAIN_TIMEOUT,
+       "Channel shutdown because it was still open when its listener's drain deadline passed."),
 };
 /* clang-format on */
 
@@ -184,7 +190,11 @@ static struct aws_log_subject_info s_io_log_subject_infos[] = {
     DEFINE_LOG_SUBJECT_INFO(
         AWS_LS_IO_EXPONENTIAL_BACKOFF_RETRY_STRATEGY,
         "exp-backoff-strategy",
-        "Subject for exponential backoff retry strategy")};
+        "Subject for exponential backoff retry strategy"),
+    DEFINE_LOG_SUBJECT_INFO(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "standard-retry-strategy",
+        "Subject for standard retry strategy and retry quota")};
 
 static struct aws_log_subject_info_list s_io_log_subject_list = {
     .subject_list = s_io_log_subject_infos,
@@ -194,6 +204,8 @@ static struct aws_log_subject_info_list s_io_log_subject_list = {
 static bool s_io_library_initialized = false;
 
 void aws_tls_init_static_state(struct aws_allocator *alloc);
+void aws_pki_init_static_state(struct aws_allocator *alloc);
+void aws_pki_clean_up_static_state(void);
 void aws_tls_clean_up_static_state(void);
 
 void aws_io_library_init(struct aws_allocator *allocator) {
@@ -203,12 +215,14 @@ void aws_io_library_init(struct aws_allocator *allocator) {
         aws_register_error_info(&s_list);
         aws_register_log_subject_info_list(&s_io_log_subject_list);
         aws_tls_init_static_state(allocator);
+        aws_pki_init_static_state(allocator);
     }
 }
 
 void aws_io_library_clean_up(void) {
     if (s_io_library_initialized) {
         s_io_library_initialized = false;
+        aws_pki_clean_up_static_state();
         aws_tls_clean_up_static_state();
         aws_unregister_error_info(&s_list);
         aws_unregister_log_subject_info_list(&s_io_log_subject_list);
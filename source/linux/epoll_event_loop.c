@@ -7,11 +7,12 @@
 
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
-#include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/cross_thread_task_queue.h>
+#include <aws/io/private/timer_wheel.h>
 
 #include <sys/epoll.h>
 
@@ -79,15 +80,31 @@ static struct aws_event_loop_vtable s_vtable = {
 struct epoll_loop {
     struct aws_task_scheduler scheduler;
     struct aws_thread thread_created_on;
+    struct aws_thread_options thread_options;
     aws_thread_id_t thread_joined_to;
     struct aws_atomic_var running_thread_id;
     struct aws_io_handle read_task_handle;
     struct aws_io_handle write_task_handle;
-    struct aws_mutex task_pre_queue_mutex;
-    struct aws_linked_list task_pre_queue;
+    struct aws_cross_thread_task_queue task_pre_queue;
     struct aws_task stop_task;
     struct aws_atomic_var stop_task_ptr;
     int epoll_fd;
+    /* buffer epoll_wait() fills in, only touched by the event-thread. */
+    struct epoll_event *events;
+    size_t events_capacity;
+    /* bounds the events buffer moves between in adaptive mode. Equal if adaptive mode is off */
+    size_t min_events_capacity;
+    size_t max_events_capacity;
+    /* consecutive ticks that used a small fraction of the events buffer */
+    size_t underused_tick_count;
+    /* how long to busy-poll before blocking in epoll_wait(), 0 if busy-polling is off */
+    uint64_t busy_poll_spin_ns;
+    /* cleared before the event-thread blocks in epoll_wait() and set again once it wakes up. Cross-thread producers
+     * only write to the eventfd while it's clear. */
+    struct aws_atomic_var is_awake;
+    /* coarse future tasks, if use_timer_wheel is set. Only touched by the event-thread. */
+    struct aws_timer_wheel timer_wheel;
+    bool use_timer_wheel;
     bool should_process_task_pre_queue;
     bool should_continue;
 };
@@ -104,13 +121,27 @@ struct epoll_event_data {
 /* default timeout is 100 seconds */
 enum {
     DEFAULT_TIMEOUT = 100 * 1000,
-    MAX_EVENTS = 100,
+    DEFAULT_MAX_EVENTS = 100,
+    DEFAULT_ADAPTIVE_MAX_EVENTS = 1024,
+    /* in adaptive mode, the buffer shrinks after this many ticks in a row used a quarter of it or less */
+    ADAPTIVE_SHRINK_TICKS = 64,
 };
 
+/* with use_timer_wheel, tasks due at least this far out go into the wheel, which ticks in milliseconds */
+#define TIMER_WHEEL_MIN_DELAY_NS (10 * AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS)
+#define TIMER_WHEEL_TICK_NS (AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS)
+
 int aws_open_nonblocking_posix_pipe(int pipe_fds[2]);
 
 /* Setup edge triggered epoll with a scheduler. */
-struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+struct aws_event_loop *aws_event_loop_new_default_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
+    AWS_ASSERT(options);
+    AWS_ASSERT(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
+
     struct aws_event_loop *loop = aws_mem_calloc(alloc, 1, sizeof(struct aws_event_loop));
     if (!loop) {
         return NULL;
@@ -129,9 +160,18 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
     /* initialize thread id to NULL, it should be updated when the event loop thread starts. */
     aws_atomic_init_ptr(&epoll_loop->running_thread_id, NULL);
 
-    aws_linked_list_init(&epoll_loop->task_pre_queue);
-    epoll_loop->task_pre_queue_mutex = (struct aws_mutex)AWS_MUTEX_INIT;
+    aws_cross_thread_task_queue_init(&epoll_loop->task_pre_queue);
     aws_atomic_init_ptr(&epoll_loop->stop_task_ptr, NULL);
+    aws_atomic_init_int(&epoll_loop->is_awake, 0);
+    epoll_loop->busy_poll_spin_ns =
+        aws_timestamp_convert(options->busy_poll_spin_us, AWS_TIMESTAMP_MICROS, AWS_TIMESTAMP_NANOS, NULL);
+
+    epoll_loop->use_timer_wheel = options->use_timer_wheel;
+    if (epoll_loop->use_timer_wheel) {
+        uint64_t now_ns = 0;
+        clock(&now_ns);
+        aws_timer_wheel_init(&epoll_loop->timer_wheel, TIMER_WHEEL_TICK_NS, now_ns);
+    }
 
     epoll_loop->epoll_fd = epoll_create(100);
     if (epoll_loop->epoll_fd < 0) {
@@ -140,9 +180,32 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
         goto clean_up_epoll;
     }
 
+    epoll_loop->min_events_capacity = options->events_per_tick ? options->events_per_tick : DEFAULT_MAX_EVENTS;
+    epoll_loop->max_events_capacity = epoll_loop->min_events_capacity;
+    if (options->adaptive_events_per_tick) {
+        epoll_loop->max_events_capacity =
+            options->max_events_per_tick ? options->max_events_per_tick : DEFAULT_ADAPTIVE_MAX_EVENTS;
+        if (epoll_loop->max_events_capacity < epoll_loop->min_events_capacity) {
+            epoll_loop->max_events_capacity = epoll_loop->min_events_capacity;
+        }
+    }
+
+    /* epoll_wait() takes the buffer size as an int */
+    if (epoll_loop->max_events_capacity > INT_MAX) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        goto clean_up_epoll;
+    }
+
+    epoll_loop->events_capacity = epoll_loop->min_events_capacity;
+    epoll_loop->events = aws_mem_calloc(alloc, epoll_loop->events_capacity, sizeof(struct epoll_event));
+    if (!epoll_loop->events) {
+        goto clean_up_epoll;
+    }
+
     if (aws_thread_init(&epoll_loop->thread_created_on, alloc)) {
         goto clean_up_epoll;
     }
+    epoll_loop->thread_options = options->thread_options ? *options->thread_options : *aws_default_thread_options();
 
 #if USE_EFD
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Using eventfd for cross-thread notifications.", (void *)loop);
@@ -205,6 +268,10 @@ clean_up_epoll:
         close(epoll_loop->epoll_fd);
     }
 
+    if (epoll_loop->events) {
+        aws_mem_release(alloc, epoll_loop->events);
+    }
+
     aws_mem_release(alloc, epoll_loop);
 
 cleanup_base_loop:
@@ -229,10 +296,30 @@ static void s_destroy(struct aws_event_loop *event_loop) {
     /* setting this so that canceled tasks don't blow up when asking if they're on the event-loop thread. */
     epoll_loop->thread_joined_to = aws_thread_current_thread_id();
     aws_atomic_store_ptr(&epoll_loop->running_thread_id, &epoll_loop->thread_joined_to);
+
+    if (epoll_loop->use_timer_wheel) {
+        /* anything these schedule from their cancellation goes to the scheduler, which is cleaned up next */
+        epoll_loop->use_timer_wheel = false;
+
+        struct aws_linked_list wheel_tasks;
+        aws_linked_list_init(&wheel_tasks);
+        aws_timer_wheel_pop_all(&epoll_loop->timer_wheel, &wheel_tasks);
+
+        while (!aws_linked_list_empty(&wheel_tasks)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&wheel_tasks);
+            struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+            task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+        }
+    }
+
     aws_task_scheduler_clean_up(&epoll_loop->scheduler);
 
-    while (!aws_linked_list_empty(&epoll_loop->task_pre_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&epoll_loop->task_pre_queue);
+    struct aws_linked_list task_pre_queue;
+    aws_linked_list_init(&task_pre_queue);
+    aws_cross_thread_task_queue_pop_all(&epoll_loop->task_pre_queue, &task_pre_queue);
+
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
         struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
         task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
     }
@@ -248,6 +335,7 @@ static void s_destroy(struct aws_event_loop *event_loop) {
 #endif
 
     close(epoll_loop->epoll_fd);
+    aws_mem_release(event_loop->alloc, epoll_loop->events);
     aws_mem_release(event_loop->alloc, epoll_loop);
     aws_event_loop_clean_up_base(event_loop);
     aws_mem_release(event_loop->alloc, event_loop);
@@ -259,7 +347,7 @@ static int s_run(struct aws_event_loop *event_loop) {
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Starting event-loop thread.", (void *)event_loop);
 
     epoll_loop->should_continue = true;
-    if (aws_thread_launch(&epoll_loop->thread_created_on, &s_main_loop, event_loop, NULL)) {
+    if (aws_thread_launch(&epoll_loop->thread_created_on, &s_main_loop, event_loop, &epoll_loop->thread_options)) {
         AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
         epoll_loop->should_continue = false;
         return AWS_OP_ERR;
@@ -306,6 +394,20 @@ static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
     return aws_thread_join(&epoll_loop->thread_created_on);
 }
 
+/* Event-thread only. Coarse enough timers go into the timer wheel, measured against the wheel's notion of now, which
+ * is refreshed at the start of every tick. */
+static void s_schedule_future_in_thread(struct epoll_loop *epoll_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    if (epoll_loop->use_timer_wheel) {
+        uint64_t wheel_now_ns = epoll_loop->timer_wheel.current_tick * epoll_loop->timer_wheel.tick_ns;
+        if (run_at_nanos >= wheel_now_ns + TIMER_WHEEL_MIN_DELAY_NS) {
+            aws_timer_wheel_schedule(&epoll_loop->timer_wheel, task, run_at_nanos);
+            return;
+        }
+    }
+
+    aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
+}
+
 static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
     struct epoll_loop *epoll_loop = event_loop->impl_data;
 
@@ -321,7 +423,7 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
             /* zero denotes "now" task */
             aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
         } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, run_at_nanos);
+            s_schedule_future_in_thread(epoll_loop, task, run_at_nanos);
         }
         return;
     }
@@ -333,16 +435,16 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         (void *)task,
         (unsigned long long)run_at_nanos);
     task->timestamp = run_at_nanos;
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
 
     uint64_t counter = 1;
 
-    bool is_first_task = aws_linked_list_empty(&epoll_loop->task_pre_queue);
+    bool is_first_task = aws_cross_thread_task_queue_push(&epoll_loop->task_pre_queue, task);
 
-    aws_linked_list_push_back(&epoll_loop->task_pre_queue, &task->node);
-
-    /* if the list was not empty, we already have a pending read on the pipe/eventfd, no need to write again. */
-    if (is_first_task) {
+    /* if the queue was not empty, we already have a pending read on the pipe/eventfd, no need to write again.
+     * Nor if the event-thread is awake, running a tick or busy-polling: it checks the queue once more before it
+     * blocks, and since it clears is_awake before that check, seeing it set here means the check will see our
+     * task. */
+    if (is_first_task && !aws_atomic_load_int(&epoll_loop->is_awake)) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
 
         /* If the write fails because the buffer is full, we don't actually care because that means there's a pending
@@ -350,8 +452,6 @@ static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws
         ssize_t do_not_care = write(epoll_loop->write_task_handle.data.fd, (void *)&counter, sizeof(counter));
         (void)do_not_care;
     }
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
 }
 
 static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
@@ -365,6 +465,7 @@ static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws
 static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
     AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
     struct epoll_loop *epoll_loop = event_loop->impl_data;
+    /* this also unlinks tasks sitting in the timer wheel, see aws_timer_wheel */
     aws_task_scheduler_cancel_task(&epoll_loop->scheduler, task);
 }
 
@@ -503,16 +604,13 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
 
     uint64_t count_ignore = 0;
 
-    aws_mutex_lock(&epoll_loop->task_pre_queue_mutex);
-
     /* several tasks could theoretically have been written (though this should never happen), make sure we drain the
-     * eventfd/pipe. */
+     * eventfd/pipe. This must happen before the queue is emptied: a producer that finds the queue empty after we
+     * take its contents will write again, and that write must not be swallowed here. */
     while (read(epoll_loop->read_task_handle.data.fd, &count_ignore, sizeof(count_ignore)) > -1) {
     }
 
-    aws_linked_list_swap_contents(&epoll_loop->task_pre_queue, &task_pre_queue);
-
-    aws_mutex_unlock(&epoll_loop->task_pre_queue_mutex);
+    aws_cross_thread_task_queue_pop_all(&epoll_loop->task_pre_queue, &task_pre_queue);
 
     while (!aws_linked_list_empty(&task_pre_queue)) {
         struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
@@ -526,9 +624,122 @@ static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
         if (task->timestamp == 0) {
             aws_task_scheduler_schedule_now(&epoll_loop->scheduler, task);
         } else {
-            aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+            s_schedule_future_in_thread(epoll_loop, task, task->timestamp);
+        }
+    }
+}
+
+/* Hands the timer wheel's tasks that fell due over to the scheduler, which runs them in timestamp order this tick. */
+static void s_advance_timer_wheel(struct aws_event_loop *event_loop) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    uint64_t now_ns = 0;
+    if (event_loop->clock(&now_ns)) {
+        return;
+    }
+
+    struct aws_linked_list due;
+    aws_linked_list_init(&due);
+    aws_timer_wheel_advance(&epoll_loop->timer_wheel, now_ns, &due);
+
+    while (!aws_linked_list_empty(&due)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&due);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        aws_task_scheduler_schedule_future(&epoll_loop->scheduler, task, task->timestamp);
+    }
+}
+
+/* In adaptive mode, grows the events buffer when epoll_wait() filled it, and shrinks it after a stretch of ticks that
+ * barely used it. This only runs on the event-thread, between calls to epoll_wait(). */
+static void s_adapt_events_capacity(struct aws_event_loop *event_loop, int event_count) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+
+    if (epoll_loop->min_events_capacity == epoll_loop->max_events_capacity) {
+        return;
+    }
+
+    size_t new_capacity = epoll_loop->events_capacity;
+    size_t used = event_count > 0 ? (size_t)event_count : 0;
+
+    if (used == epoll_loop->events_capacity) {
+        epoll_loop->underused_tick_count = 0;
+        new_capacity = aws_min_size(epoll_loop->events_capacity * 2, epoll_loop->max_events_capacity);
+    } else if (used <= epoll_loop->events_capacity / 4) {
+        if (++epoll_loop->underused_tick_count >= ADAPTIVE_SHRINK_TICKS) {
+            epoll_loop->underused_tick_count = 0;
+            new_capacity = aws_max_size(epoll_loop->events_capacity / 2, epoll_loop->min_events_capacity);
         }
+    } else {
+        epoll_loop->underused_tick_count = 0;
+    }
+
+    if (new_capacity == epoll_loop->events_capacity) {
+        return;
     }
+
+    /* the old contents have been processed already, no need to preserve them */
+    struct epoll_event *new_events = aws_mem_calloc(event_loop->alloc, new_capacity, sizeof(struct epoll_event));
+    if (!new_events) {
+        /* not fatal, keep going with the buffer we have. */
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: resizing events per tick from %zu to %zu",
+        (void *)event_loop,
+        epoll_loop->events_capacity,
+        new_capacity);
+
+    aws_mem_release(event_loop->alloc, epoll_loop->events);
+    epoll_loop->events = new_events;
+    epoll_loop->events_capacity = new_capacity;
+}
+
+/* Waits for events like epoll_wait(), but busy-polls for up to busy_poll_spin_ns first, also watching the cross-thread
+ * task queue since producers don't wake us while we spin. Returns the number of events, which may be 0 if tasks
+ * showed up instead. */
+static int s_busy_poll_wait(struct aws_event_loop *event_loop, int timeout) {
+    struct epoll_loop *epoll_loop = event_loop->impl_data;
+    struct epoll_event *events = epoll_loop->events;
+    int max_events = (int)epoll_loop->events_capacity;
+
+    /* never spin past the point we'd have woken up for a scheduled task anyway */
+    uint64_t spin_ns = aws_min_u64(
+        epoll_loop->busy_poll_spin_ns,
+        aws_timestamp_convert((uint64_t)timeout, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+
+    uint64_t now_ns = 0;
+    if (spin_ns == 0 || event_loop->clock(&now_ns)) {
+        return epoll_wait(epoll_loop->epoll_fd, events, max_events, timeout);
+    }
+    uint64_t spin_until_ns = aws_add_u64_saturating(now_ns, spin_ns);
+
+    int event_count = 0;
+    aws_atomic_store_int(&epoll_loop->is_awake, 1);
+    do {
+        event_count = epoll_wait(epoll_loop->epoll_fd, events, max_events, 0);
+        if (event_count != 0) {
+            break;
+        }
+
+        if (!aws_cross_thread_task_queue_is_empty(&epoll_loop->task_pre_queue)) {
+            break;
+        }
+    } while (!event_loop->clock(&now_ns) && now_ns < spin_until_ns);
+    aws_atomic_store_int(&epoll_loop->is_awake, 0);
+
+    if (event_count != 0) {
+        return event_count;
+    }
+
+    /* a producer that saw us awake didn't write to the eventfd, so its task must be picked up from here. */
+    if (!aws_cross_thread_task_queue_is_empty(&epoll_loop->task_pre_queue)) {
+        epoll_loop->should_process_task_pre_queue = true;
+        return 0;
+    }
+
+    return epoll_wait(epoll_loop->epoll_fd, events, max_events, timeout);
 }
 
 static void s_main_loop(void *args) {
@@ -547,14 +758,14 @@ static void s_main_loop(void *args) {
 
     int timeout = DEFAULT_TIMEOUT;
 
-    struct epoll_event events[MAX_EVENTS];
-
     AWS_LOGF_INFO(
         AWS_LS_IO_EVENT_LOOP,
-        "id=%p: default timeout %d, and max events to process per tick %d",
+        "id=%p: default timeout %d, max events per tick %zu (adaptive up to %zu), busy-poll for %llu ns",
         (void *)event_loop,
         timeout,
-        MAX_EVENTS);
+        epoll_loop->events_capacity,
+        epoll_loop->max_events_capacity,
+        (unsigned long long)epoll_loop->busy_poll_spin_ns);
 
     /*
      * until stop is called,
@@ -569,7 +780,30 @@ static void s_main_loop(void *args) {
      */
     while (epoll_loop->should_continue) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout);
-        int event_count = epoll_wait(epoll_loop->epoll_fd, events, MAX_EVENTS, timeout);
+        struct epoll_event *events = epoll_loop->events;
+
+        /* from here on producers write to the eventfd. One that still saw us awake left its task for this check,
+         * in which case only poll, so a steady stream of cross-thread tasks can't starve io events. */
+        int wait_timeout = timeout;
+        aws_atomic_store_int(&epoll_loop->is_awake, 0);
+        if (!aws_cross_thread_task_queue_is_empty(&epoll_loop->task_pre_queue)) {
+            epoll_loop->should_process_task_pre_queue = true;
+            wait_timeout = 0;
+        }
+
+        int event_count = 0;
+        if (epoll_loop->busy_poll_spin_ns) {
+            event_count = s_busy_poll_wait(event_loop, wait_timeout);
+        } else {
+            event_count = epoll_wait(epoll_loop->epoll_fd, events, (int)epoll_loop->events_capacity, wait_timeout);
+        }
+        aws_atomic_store_int(&epoll_loop->is_awake, 1);
+
+        aws_event_loop_register_tick_start(event_loop);
+
+        if (epoll_loop->use_timer_wheel) {
+            s_advance_timer_wheel(event_loop);
+        }
 
         AWS_LOGF_TRACE(
             AWS_LS_IO_EVENT_LOOP, "id=%p: wake up with %d events to process.", (void *)event_loop, event_count);
@@ -603,10 +837,14 @@ static void s_main_loop(void *args) {
                     "id=%p: activity on fd %d, invoking handler.",
                     (void *)event_loop,
                     event_data->handle->data.fd);
+                uint64_t start_ns = aws_event_loop_profiler_begin(event_loop);
                 event_data->on_event(event_loop, event_data->handle, event_mask, event_data->user_data);
+                aws_event_loop_profiler_end(event_loop, "io_event", start_ns);
             }
         }
 
+        s_adapt_events_capacity(event_loop, event_count);
+
         /* run scheduled tasks */
         s_process_task_pre_queue(event_loop);
 
@@ -616,6 +854,8 @@ static void s_main_loop(void *args) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&epoll_loop->scheduler, now_ns);
 
+        aws_event_loop_register_tick_end(event_loop, event_count > 0 ? (size_t)event_count : 0);
+
         /* set timeout for next epoll_wait() call.
          * if clock fails, or scheduler has no tasks, use default timeout */
         bool use_default_timeout = false;
@@ -624,8 +864,21 @@ static void s_main_loop(void *args) {
             use_default_timeout = true;
         }
 
-        uint64_t next_run_time_ns;
-        if (!aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns)) {
+        uint64_t next_run_time_ns = 0;
+        bool has_tasks = aws_task_scheduler_has_tasks(&epoll_loop->scheduler, &next_run_time_ns);
+
+        uint64_t wheel_deadline_ns = 0;
+        if (epoll_loop->use_timer_wheel &&
+            aws_timer_wheel_next_deadline(&epoll_loop->timer_wheel, &wheel_deadline_ns)) {
+            /* the deadline is a tick boundary, round up so the millisecond timeout below doesn't wake us just short */
+            wheel_deadline_ns += TIMER_WHEEL_TICK_NS - 1;
+            if (!has_tasks || wheel_deadline_ns < next_run_time_ns) {
+                next_run_time_ns = wheel_deadline_ns;
+            }
+            has_tasks = true;
+        }
+
+        if (!has_tasks) {
             use_default_timeout = true;
         }
 
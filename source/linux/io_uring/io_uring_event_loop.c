@@ -0,0 +1,1042 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/event_loop.h>
+
+#include <aws/common/atomics.h>
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+#include <aws/common/thread.h>
+
+#include <aws/io/logging.h>
+#include <aws/io/private/cross_thread_task_queue.h>
+
+#include <linux/io_uring.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <endian.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+
+#ifndef EPOLLRDHUP
+#    define EPOLLRDHUP 0x2000
+#endif
+
+/*
+ * io_uring based event loop.
+ *
+ * This loop honors the same readiness-based contract as the epoll loop: every subscribed handle gets a multishot
+ * IORING_OP_POLL_ADD, which behaves like an edge-triggered epoll registration. The win over epoll is batching:
+ * subscription changes made on the event-thread are queued as SQEs and handed to the kernel in the same
+ * io_uring_enter() call that waits for completions, so a tick costs a single syscall no matter how many handles were
+ * (un)subscribed during it.
+ *
+ * The submission queue has a single producer: the event-thread. Subscriptions requested from other threads are
+ * forwarded to the event-thread with a task, the same way the kqueue loop does it.
+ */
+
+static void s_destroy(struct aws_event_loop *event_loop);
+static int s_run(struct aws_event_loop *event_loop);
+static int s_stop(struct aws_event_loop *event_loop);
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop);
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task);
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos);
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task);
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data);
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle);
+static void s_free_io_event_resources(void *user_data);
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop);
+
+static void s_main_loop(void *args);
+
+static struct aws_event_loop_vtable s_vtable = {
+    .destroy = s_destroy,
+    .run = s_run,
+    .stop = s_stop,
+    .wait_for_stop_completion = s_wait_for_stop_completion,
+    .schedule_task_now = s_schedule_task_now,
+    .schedule_task_future = s_schedule_task_future,
+    .cancel_task = s_cancel_task,
+    .subscribe_to_io_events = s_subscribe_to_io_events,
+    .unsubscribe_from_io_events = s_unsubscribe_from_io_events,
+    .free_io_event_resources = s_free_io_event_resources,
+    .is_on_callers_thread = s_is_on_callers_thread,
+};
+
+/* user_data of SQEs whose completions we don't care about (e.g. POLL_REMOVE). */
+#define IGNORED_CQE_USER_DATA 0
+
+struct uring_submission_queue {
+    unsigned *head;
+    unsigned *tail;
+    unsigned *ring_mask;
+    unsigned *ring_entries;
+    unsigned *array;
+    struct io_uring_sqe *sqes;
+    /* SQEs filled in, but not yet handed to the kernel */
+    unsigned pending;
+    void *ring_ptr;
+    size_t ring_size;
+    size_t sqes_size;
+};
+
+struct uring_completion_queue {
+    unsigned *head;
+    unsigned *tail;
+    unsigned *ring_mask;
+    unsigned *ring_entries;
+    struct io_uring_cqe *cqes;
+    void *ring_ptr;
+    size_t ring_size;
+};
+
+struct io_uring_loop {
+    struct aws_task_scheduler scheduler;
+    struct aws_thread thread_created_on;
+    aws_thread_id_t thread_joined_to;
+    struct aws_atomic_var running_thread_id;
+    int ring_fd;
+    struct uring_submission_queue sq;
+    struct uring_completion_queue cq;
+    /* eventfd used to wake the event-thread for cross-thread tasks. It's polled with a loop-owned multishot poll */
+    int wakeup_fd;
+    bool wakeup_poll_armed;
+    struct aws_cross_thread_task_queue task_pre_queue;
+    struct aws_task stop_task;
+    struct aws_atomic_var stop_task_ptr;
+    /* handles unsubscribed whose poll hasn't been torn down by the kernel yet. Freed in destroy if still pending. */
+    struct aws_linked_list pending_removal_list;
+    /* handles with events this tick, so that several CQEs for one handle are delivered in a single callback */
+    struct io_uring_handle_data **handles_with_events;
+    size_t handles_with_events_capacity;
+    int connected_handle_count;
+    bool should_process_task_pre_queue;
+    bool should_continue;
+};
+
+struct io_uring_handle_data {
+    struct aws_allocator *alloc;
+    struct aws_io_handle *handle;
+    struct aws_event_loop *event_loop;
+    aws_event_loop_on_event_fn *on_event;
+    void *user_data;
+    int events_subscribed;
+    int events_this_loop;
+    struct aws_task subscribe_task;
+    struct aws_task cleanup_task;
+    struct aws_linked_list_node pending_removal_node;
+    enum { HANDLE_STATE_SUBSCRIBING, HANDLE_STATE_SUBSCRIBED, HANDLE_STATE_UNSUBSCRIBED } state;
+    /* true while the kernel holds a multishot poll whose completions reference this struct */
+    bool poll_armed;
+};
+
+/* default timeout is 100 seconds */
+enum {
+    DEFAULT_TIMEOUT_SEC = 100,
+    SQ_ENTRIES = 256,
+    CQ_ENTRIES = 4096,
+};
+
+static int s_io_uring_setup(unsigned entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int s_io_uring_enter(
+    int ring_fd,
+    unsigned to_submit,
+    unsigned min_complete,
+    unsigned flags,
+    void *arg,
+    size_t arg_size) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, arg_size);
+}
+
+static int s_map_rings(struct io_uring_loop *impl, struct io_uring_params *params) {
+    impl->sq.ring_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    impl->cq.ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    impl->sq.sqes_size = params->sq_entries * sizeof(struct io_uring_sqe);
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP) {
+        if (impl->cq.ring_size > impl->sq.ring_size) {
+            impl->sq.ring_size = impl->cq.ring_size;
+        }
+        impl->cq.ring_size = impl->sq.ring_size;
+    }
+
+    impl->sq.ring_ptr = mmap(
+        NULL,
+        impl->sq.ring_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        impl->ring_fd,
+        IORING_OFF_SQ_RING);
+    if (impl->sq.ring_ptr == MAP_FAILED) {
+        impl->sq.ring_ptr = NULL;
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    if (params->features & IORING_FEAT_SINGLE_MMAP) {
+        impl->cq.ring_ptr = impl->sq.ring_ptr;
+    } else {
+        impl->cq.ring_ptr = mmap(
+            NULL,
+            impl->cq.ring_size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            impl->ring_fd,
+            IORING_OFF_CQ_RING);
+        if (impl->cq.ring_ptr == MAP_FAILED) {
+            impl->cq.ring_ptr = NULL;
+            return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+        }
+    }
+
+    impl->sq.sqes = mmap(
+        NULL,
+        impl->sq.sqes_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        impl->ring_fd,
+        IORING_OFF_SQES);
+    if (impl->sq.sqes == MAP_FAILED) {
+        impl->sq.sqes = NULL;
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    uint8_t *sq_ptr = impl->sq.ring_ptr;
+    impl->sq.head = (unsigned *)(sq_ptr + params->sq_off.head);
+    impl->sq.tail = (unsigned *)(sq_ptr + params->sq_off.tail);
+    impl->sq.ring_mask = (unsigned *)(sq_ptr + params->sq_off.ring_mask);
+    impl->sq.ring_entries = (unsigned *)(sq_ptr + params->sq_off.ring_entries);
+    impl->sq.array = (unsigned *)(sq_ptr + params->sq_off.array);
+
+    uint8_t *cq_ptr = impl->cq.ring_ptr;
+    impl->cq.head = (unsigned *)(cq_ptr + params->cq_off.head);
+    impl->cq.tail = (unsigned *)(cq_ptr + params->cq_off.tail);
+    impl->cq.ring_mask = (unsigned *)(cq_ptr + params->cq_off.ring_mask);
+    impl->cq.ring_entries = (unsigned *)(cq_ptr + params->cq_off.ring_entries);
+    impl->cq.cqes = (struct io_uring_cqe *)(cq_ptr + params->cq_off.cqes);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_unmap_rings(struct io_uring_loop *impl) {
+    if (impl->sq.sqes) {
+        munmap(impl->sq.sqes, impl->sq.sqes_size);
+    }
+    if (impl->cq.ring_ptr && impl->cq.ring_ptr != impl->sq.ring_ptr) {
+        munmap(impl->cq.ring_ptr, impl->cq.ring_size);
+    }
+    if (impl->sq.ring_ptr) {
+        munmap(impl->sq.ring_ptr, impl->sq.ring_size);
+    }
+}
+
+struct aws_event_loop *aws_event_loop_new_io_uring(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+    struct aws_event_loop *loop = aws_mem_calloc(alloc, 1, sizeof(struct aws_event_loop));
+    if (!loop) {
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Initializing io_uring", (void *)loop);
+    if (aws_event_loop_init_base(loop, alloc, clock)) {
+        goto clean_up_loop;
+    }
+
+    struct io_uring_loop *impl = aws_mem_calloc(alloc, 1, sizeof(struct io_uring_loop));
+    if (!impl) {
+        goto clean_up_base_loop;
+    }
+
+    impl->ring_fd = -1;
+    impl->wakeup_fd = -1;
+
+    /* initialize thread id to NULL, it should be updated when the event loop thread starts. */
+    aws_atomic_init_ptr(&impl->running_thread_id, NULL);
+
+    aws_cross_thread_task_queue_init(&impl->task_pre_queue);
+    aws_linked_list_init(&impl->pending_removal_list);
+    aws_atomic_init_ptr(&impl->stop_task_ptr, NULL);
+
+    struct io_uring_params params;
+    AWS_ZERO_STRUCT(params);
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = CQ_ENTRIES;
+
+    impl->ring_fd = s_io_uring_setup(SQ_ENTRIES, &params);
+    if (impl->ring_fd < 0) {
+        int errno_value = errno; /* logging can change errno */
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "id=%p: io_uring_setup failed with errno %d.", (void *)loop, errno_value);
+        /* an old kernel lacks the syscall, a seccomp profile or kernel.io_uring_disabled refuses it */
+        bool unsupported = errno_value == ENOSYS || errno_value == EPERM || errno_value == EACCES;
+        aws_raise_error(unsupported ? AWS_ERROR_PLATFORM_NOT_SUPPORTED : AWS_ERROR_SYS_CALL_FAILURE);
+        goto clean_up_impl;
+    }
+
+    /* We need the timeout argument of io_uring_enter(), which came along with multishot poll's generation of kernels */
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_EVENT_LOOP, "id=%p: kernel lacks IORING_FEAT_EXT_ARG support.", (void *)loop);
+        aws_raise_error(AWS_ERROR_PLATFORM_NOT_SUPPORTED);
+        goto clean_up_ring;
+    }
+
+    if (s_map_rings(impl, &params)) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: failed to map io_uring queues.", (void *)loop);
+        goto clean_up_ring;
+    }
+
+    impl->handles_with_events_capacity = params.cq_entries;
+    impl->handles_with_events =
+        aws_mem_calloc(alloc, impl->handles_with_events_capacity, sizeof(struct io_uring_handle_data *));
+    if (!impl->handles_with_events) {
+        goto clean_up_ring;
+    }
+
+    if (aws_thread_init(&impl->thread_created_on, alloc)) {
+        goto clean_up_ring;
+    }
+
+    impl->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (impl->wakeup_fd < 0) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: Failed to open eventfd handle.", (void *)loop);
+        aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+        goto clean_up_thread;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: ring fd %d, eventfd %d.", (void *)loop, impl->ring_fd, impl->wakeup_fd);
+
+    if (aws_task_scheduler_init(&impl->scheduler, alloc)) {
+        goto clean_up_wakeup_fd;
+    }
+
+    impl->should_continue = false;
+
+    loop->impl_data = impl;
+    loop->vtable = &s_vtable;
+
+    return loop;
+
+clean_up_wakeup_fd:
+    close(impl->wakeup_fd);
+
+clean_up_thread:
+    aws_thread_clean_up(&impl->thread_created_on);
+
+clean_up_ring:
+    if (impl->handles_with_events) {
+        aws_mem_release(alloc, impl->handles_with_events);
+    }
+    s_unmap_rings(impl);
+    close(impl->ring_fd);
+
+clean_up_impl:
+    aws_mem_release(alloc, impl);
+
+clean_up_base_loop:
+    aws_event_loop_clean_up_base(loop);
+
+clean_up_loop:
+    aws_mem_release(alloc, loop);
+
+    return NULL;
+}
+
+static void s_destroy(struct aws_event_loop *event_loop) {
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Destroying event_loop", (void *)event_loop);
+
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    /* we don't know if stop() has been called by someone else,
+     * just call stop() again and wait for event-loop to finish. */
+    aws_event_loop_stop(event_loop);
+    s_wait_for_stop_completion(event_loop);
+
+    /* setting this so that canceled tasks don't blow up when asking if they're on the event-loop thread. */
+    impl->thread_joined_to = aws_thread_current_thread_id();
+    aws_atomic_store_ptr(&impl->running_thread_id, &impl->thread_joined_to);
+    aws_task_scheduler_clean_up(&impl->scheduler);
+
+    struct aws_linked_list task_pre_queue;
+    aws_linked_list_init(&task_pre_queue);
+    aws_cross_thread_task_queue_pop_all(&impl->task_pre_queue, &task_pre_queue);
+
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        task->fn(task, task->arg, AWS_TASK_STATUS_CANCELED);
+    }
+
+    /* closing the ring tears down any poll still held by the kernel, so it's now safe to free these. */
+    s_unmap_rings(impl);
+    close(impl->ring_fd);
+
+    while (!aws_linked_list_empty(&impl->pending_removal_list)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&impl->pending_removal_list);
+        struct io_uring_handle_data *handle_data =
+            AWS_CONTAINER_OF(node, struct io_uring_handle_data, pending_removal_node);
+        s_free_io_event_resources(handle_data);
+    }
+
+    /* Warn user if aws_io_handle was subscribed, but never unsubscribed. This would cause memory leaks. */
+    AWS_ASSERT(impl->connected_handle_count == 0);
+
+    aws_thread_clean_up(&impl->thread_created_on);
+    close(impl->wakeup_fd);
+
+    aws_mem_release(event_loop->alloc, impl->handles_with_events);
+    aws_mem_release(event_loop->alloc, impl);
+    aws_event_loop_clean_up_base(event_loop);
+    aws_mem_release(event_loop->alloc, event_loop);
+}
+
+static int s_run(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Starting event-loop thread.", (void *)event_loop);
+
+    impl->should_continue = true;
+    if (aws_thread_launch(&impl->thread_created_on, &s_main_loop, event_loop, NULL)) {
+        AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
+        impl->should_continue = false;
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_stop_task(struct aws_task *task, void *args, enum aws_task_status status) {
+
+    (void)task;
+    struct aws_event_loop *event_loop = args;
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    /* now okay to reschedule stop tasks. */
+    aws_atomic_store_ptr(&impl->stop_task_ptr, NULL);
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        /*
+         * this allows the event loop to invoke the callback once the event loop has completed.
+         */
+        impl->should_continue = false;
+    }
+}
+
+static int s_stop(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    void *expected_ptr = NULL;
+    bool update_succeeded = aws_atomic_compare_exchange_ptr(&impl->stop_task_ptr, &expected_ptr, &impl->stop_task);
+    if (!update_succeeded) {
+        /* the stop task is already scheduled. */
+        return AWS_OP_SUCCESS;
+    }
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Stopping event-loop thread.", (void *)event_loop);
+    aws_task_init(&impl->stop_task, s_stop_task, event_loop, "io_uring_event_loop_stop");
+    s_schedule_task_now(event_loop, &impl->stop_task);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_wait_for_stop_completion(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+    return aws_thread_join(&impl->thread_created_on);
+}
+
+static void s_schedule_task_common(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    /* if event loop and the caller are the same thread, just schedule and be done with it. */
+    if (s_is_on_callers_thread(event_loop)) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: scheduling task %p in-thread for timestamp %llu",
+            (void *)event_loop,
+            (void *)task,
+            (unsigned long long)run_at_nanos);
+        if (run_at_nanos == 0) {
+            /* zero denotes "now" task */
+            aws_task_scheduler_schedule_now(&impl->scheduler, task);
+        } else {
+            aws_task_scheduler_schedule_future(&impl->scheduler, task, run_at_nanos);
+        }
+        return;
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: Scheduling task %p cross-thread for timestamp %llu",
+        (void *)event_loop,
+        (void *)task,
+        (unsigned long long)run_at_nanos);
+    task->timestamp = run_at_nanos;
+
+    uint64_t counter = 1;
+
+    bool is_first_task = aws_cross_thread_task_queue_push(&impl->task_pre_queue, task);
+
+    /* if the queue was not empty, we already have a pending wakeup on the eventfd, no need to write again. */
+    if (is_first_task) {
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: Waking up event-loop thread", (void *)event_loop);
+
+        /* If the write fails because the counter is saturated, there's a pending wakeup anyway. */
+        ssize_t do_not_care = write(impl->wakeup_fd, (void *)&counter, sizeof(counter));
+        (void)do_not_care;
+    }
+}
+
+static void s_schedule_task_now(struct aws_event_loop *event_loop, struct aws_task *task) {
+    s_schedule_task_common(event_loop, task, 0 /* zero denotes "now" task */);
+}
+
+static void s_schedule_task_future(struct aws_event_loop *event_loop, struct aws_task *task, uint64_t run_at_nanos) {
+    s_schedule_task_common(event_loop, task, run_at_nanos);
+}
+
+static void s_cancel_task(struct aws_event_loop *event_loop, struct aws_task *task) {
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: cancelling task %p", (void *)event_loop, (void *)task);
+    struct io_uring_loop *impl = event_loop->impl_data;
+    aws_task_scheduler_cancel_task(&impl->scheduler, task);
+}
+
+/* Hands every SQE filled in so far to the kernel, optionally waiting (up to timeout) for at least one completion.
+ * Only called from the event-thread. */
+static int s_submit_and_wait(struct io_uring_loop *impl, struct __kernel_timespec *timeout) {
+    unsigned to_submit = impl->sq.pending;
+    int submitted = 0;
+
+    if (timeout) {
+        struct io_uring_getevents_arg arg;
+        AWS_ZERO_STRUCT(arg);
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = (uint64_t)(uintptr_t)timeout;
+
+        submitted = s_io_uring_enter(
+            impl->ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    } else {
+        submitted = s_io_uring_enter(impl->ring_fd, to_submit, 0, 0, NULL, 0);
+    }
+
+    if (submitted < 0) {
+        /* timeouts and signals aren't errors from our point of view */
+        if (errno == ETIME || errno == EINTR) {
+            return AWS_OP_SUCCESS;
+        }
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    impl->sq.pending -= (unsigned)submitted;
+    return AWS_OP_SUCCESS;
+}
+
+/* Returns the next free SQE, flushing the queue to the kernel if it's full. Only called from the event-thread. */
+static struct io_uring_sqe *s_get_sqe(struct io_uring_loop *impl) {
+    unsigned head = __atomic_load_n(impl->sq.head, __ATOMIC_ACQUIRE);
+    unsigned tail = *impl->sq.tail;
+
+    if (tail - head >= *impl->sq.ring_entries) {
+        if (s_submit_and_wait(impl, NULL)) {
+            return NULL;
+        }
+        head = __atomic_load_n(impl->sq.head, __ATOMIC_ACQUIRE);
+        if (tail - head >= *impl->sq.ring_entries) {
+            aws_raise_error(AWS_ERROR_OOM);
+            return NULL;
+        }
+    }
+
+    unsigned index = tail & *impl->sq.ring_mask;
+    struct io_uring_sqe *sqe = &impl->sq.sqes[index];
+    AWS_ZERO_STRUCT(*sqe);
+    impl->sq.array[index] = index;
+
+    /* publish the new tail, the kernel won't look at it until the next io_uring_enter() */
+    __atomic_store_n(impl->sq.tail, tail + 1, __ATOMIC_RELEASE);
+    impl->sq.pending++;
+    return sqe;
+}
+
+static uint32_t s_poll_mask_for_sqe(uint32_t mask) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+    /* poll32_events is word-reversed on big endian */
+    mask = (mask << 16) | (mask >> 16);
+#endif
+    return mask;
+}
+
+static int s_arm_poll(struct io_uring_loop *impl, int fd, int events, uint64_t user_data) {
+    struct io_uring_sqe *sqe = s_get_sqe(impl);
+    if (!sqe) {
+        return AWS_OP_ERR;
+    }
+
+    /* everyone is always registered for hang up, remote hang up, errors. */
+    uint32_t event_mask = EPOLLHUP | EPOLLRDHUP | EPOLLERR;
+
+    if (events & AWS_IO_EVENT_TYPE_READABLE) {
+        event_mask |= EPOLLIN;
+    }
+
+    if (events & AWS_IO_EVENT_TYPE_WRITABLE) {
+        event_mask |= EPOLLOUT;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    /* multishot polls keep posting a completion per wakeup, which gives us edge-triggered semantics */
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = s_poll_mask_for_sqe(event_mask);
+    sqe->user_data = user_data;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_queue_poll_remove(struct io_uring_loop *impl, uint64_t user_data) {
+    struct io_uring_sqe *sqe = s_get_sqe(impl);
+    if (!sqe) {
+        return AWS_OP_ERR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = user_data;
+    sqe->user_data = IGNORED_CQE_USER_DATA;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_arm_handle_poll(struct io_uring_handle_data *handle_data) {
+    struct aws_event_loop *event_loop = handle_data->event_loop;
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: subscribing to events on fd %d",
+        (void *)event_loop,
+        handle_data->handle->data.fd);
+
+    if (s_arm_poll(
+            impl, handle_data->handle->data.fd, handle_data->events_subscribed, (uint64_t)(uintptr_t)handle_data)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: failed to subscribe to events on fd %d",
+            (void *)event_loop,
+            handle_data->handle->data.fd);
+        /* We can't return an error code from here, notify the user of the failed subscription via the callback. */
+        handle_data->on_event(event_loop, handle_data->handle, AWS_IO_EVENT_TYPE_ERROR, handle_data->user_data);
+        return;
+    }
+
+    handle_data->poll_armed = true;
+    handle_data->state = HANDLE_STATE_SUBSCRIBED;
+}
+
+/* Scheduled task that arms the poll when subscribe was called from outside the event-thread */
+static void s_subscribe_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct io_uring_handle_data *handle_data = arg;
+    struct io_uring_loop *impl = handle_data->event_loop->impl_data;
+
+    impl->connected_handle_count++;
+
+    /* if task was cancelled, nothing to do */
+    if (status == AWS_TASK_STATUS_CANCELED) {
+        return;
+    }
+
+    /* If handle was unsubscribed before this task could execute, nothing to do */
+    if (handle_data->state == HANDLE_STATE_UNSUBSCRIBED) {
+        return;
+    }
+
+    s_arm_handle_poll(handle_data);
+}
+
+static int s_subscribe_to_io_events(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    aws_event_loop_on_event_fn *on_event,
+    void *user_data) {
+
+    AWS_ASSERT(handle->additional_data == NULL);
+    AWS_ASSERT(on_event);
+
+    struct io_uring_handle_data *handle_data =
+        aws_mem_calloc(event_loop->alloc, 1, sizeof(struct io_uring_handle_data));
+    if (!handle_data) {
+        return AWS_OP_ERR;
+    }
+
+    struct io_uring_loop *impl = event_loop->impl_data;
+    handle_data->alloc = event_loop->alloc;
+    handle_data->event_loop = event_loop;
+    handle_data->user_data = user_data;
+    handle_data->handle = handle;
+    handle_data->on_event = on_event;
+    handle_data->events_subscribed = events;
+    handle_data->state = HANDLE_STATE_SUBSCRIBING;
+
+    handle->additional_data = handle_data;
+
+    /* The submission queue only has one producer: the event-thread. */
+    if (s_is_on_callers_thread(event_loop)) {
+        impl->connected_handle_count++;
+        s_arm_handle_poll(handle_data);
+    } else {
+        aws_task_init(&handle_data->subscribe_task, s_subscribe_task, handle_data, "io_uring_event_loop_subscribe");
+        s_schedule_task_now(event_loop, &handle_data->subscribe_task);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_free_io_event_resources(void *user_data) {
+    struct io_uring_handle_data *handle_data = user_data;
+    struct io_uring_loop *impl = handle_data->event_loop->impl_data;
+
+    impl->connected_handle_count--;
+
+    aws_mem_release(handle_data->alloc, (void *)handle_data);
+}
+
+static void s_unsubscribe_cleanup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct io_uring_handle_data *handle_data = arg;
+    s_free_io_event_resources(handle_data);
+}
+
+static void s_schedule_handle_data_cleanup(struct io_uring_handle_data *handle_data) {
+    aws_task_init(
+        &handle_data->cleanup_task,
+        s_unsubscribe_cleanup_task,
+        handle_data,
+        "io_uring_event_loop_unsubscribe_cleanup");
+    s_schedule_task_now(handle_data->event_loop, &handle_data->cleanup_task);
+}
+
+static int s_unsubscribe_from_io_events(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_EVENT_LOOP, "id=%p: un-subscribing from events on fd %d", (void *)event_loop, handle->data.fd);
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    AWS_ASSERT(handle->additional_data);
+    struct io_uring_handle_data *handle_data = handle->additional_data;
+
+    if (handle_data->poll_armed) {
+        if (AWS_UNLIKELY(s_queue_poll_remove(impl, (uint64_t)(uintptr_t)handle_data))) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: failed to un-subscribe from events on fd %d",
+                (void *)event_loop,
+                handle->data.fd);
+            return AWS_OP_ERR;
+        }
+
+        /* The kernel may still post completions referencing handle_data until the poll's final CQE arrives.
+         * The memory is released once that happens (or when the loop is destroyed). */
+        aws_linked_list_push_back(&impl->pending_removal_list, &handle_data->pending_removal_node);
+    } else {
+        /* nothing in the kernel references this, but a subscribe task or this tick's events might. */
+        s_schedule_handle_data_cleanup(handle_data);
+    }
+
+    handle_data->state = HANDLE_STATE_UNSUBSCRIBED;
+    handle->additional_data = NULL;
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_is_on_callers_thread(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    aws_thread_id_t *thread_id = aws_atomic_load_ptr(&impl->running_thread_id);
+    return thread_id && aws_thread_thread_id_equal(*thread_id, aws_thread_current_thread_id());
+}
+
+static void s_process_task_pre_queue(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    if (!impl->should_process_task_pre_queue) {
+        return;
+    }
+
+    AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: processing cross-thread tasks", (void *)event_loop);
+    impl->should_process_task_pre_queue = false;
+
+    struct aws_linked_list task_pre_queue;
+    aws_linked_list_init(&task_pre_queue);
+
+    uint64_t count_ignore = 0;
+
+    /* reading the eventfd resets its counter. It has to happen before the queue is emptied, see
+     * aws_cross_thread_task_queue_pop_all() */
+    while (read(impl->wakeup_fd, &count_ignore, sizeof(count_ignore)) > -1) {
+    }
+
+    aws_cross_thread_task_queue_pop_all(&impl->task_pre_queue, &task_pre_queue);
+
+    while (!aws_linked_list_empty(&task_pre_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&task_pre_queue);
+        struct aws_task *task = AWS_CONTAINER_OF(node, struct aws_task, node);
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: task %p pulled to event-loop, scheduling now.",
+            (void *)event_loop,
+            (void *)task);
+        /* Timestamp 0 is used to denote "now" tasks */
+        if (task->timestamp == 0) {
+            aws_task_scheduler_schedule_now(&impl->scheduler, task);
+        } else {
+            aws_task_scheduler_schedule_future(&impl->scheduler, task, task->timestamp);
+        }
+    }
+}
+
+static int s_aws_event_flags_from_poll_mask(uint32_t poll_mask) {
+    int event_mask = 0;
+    if (poll_mask & EPOLLIN) {
+        event_mask |= AWS_IO_EVENT_TYPE_READABLE;
+    }
+
+    if (poll_mask & EPOLLOUT) {
+        event_mask |= AWS_IO_EVENT_TYPE_WRITABLE;
+    }
+
+    if (poll_mask & EPOLLRDHUP) {
+        event_mask |= AWS_IO_EVENT_TYPE_REMOTE_HANG_UP;
+    }
+
+    if (poll_mask & EPOLLHUP) {
+        event_mask |= AWS_IO_EVENT_TYPE_CLOSED;
+    }
+
+    if (poll_mask & EPOLLERR) {
+        event_mask |= AWS_IO_EVENT_TYPE_ERROR;
+    }
+
+    return event_mask;
+}
+
+/* Drains the completion queue, accumulating events per handle. Returns the number of handles with events. */
+static size_t s_reap_completions(struct aws_event_loop *event_loop) {
+    struct io_uring_loop *impl = event_loop->impl_data;
+    size_t num_handles_with_events = 0;
+
+    unsigned head = *impl->cq.head;
+    unsigned tail = __atomic_load_n(impl->cq.tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; ++head) {
+        struct io_uring_cqe *cqe = &impl->cq.cqes[head & *impl->cq.ring_mask];
+        uint64_t user_data = cqe->user_data;
+        int32_t res = cqe->res;
+        bool poll_terminated = !(cqe->flags & IORING_CQE_F_MORE);
+
+        if (user_data == IGNORED_CQE_USER_DATA) {
+            continue;
+        }
+
+        if (user_data == (uint64_t)(uintptr_t)&impl->wakeup_fd) {
+            impl->should_process_task_pre_queue = true;
+            if (poll_terminated) {
+                impl->wakeup_poll_armed = false;
+            }
+            continue;
+        }
+
+        struct io_uring_handle_data *handle_data = (struct io_uring_handle_data *)(uintptr_t)user_data;
+
+        if (poll_terminated) {
+            handle_data->poll_armed = false;
+
+            if (handle_data->state == HANDLE_STATE_UNSUBSCRIBED) {
+                /* this is the last completion the kernel will ever post for it. */
+                aws_linked_list_remove(&handle_data->pending_removal_node);
+                s_schedule_handle_data_cleanup(handle_data);
+                continue;
+            }
+        }
+
+        if (handle_data->state != HANDLE_STATE_SUBSCRIBED) {
+            continue;
+        }
+
+        int event_flags = 0;
+        if (res < 0) {
+            event_flags = AWS_IO_EVENT_TYPE_ERROR;
+        } else {
+            event_flags = s_aws_event_flags_from_poll_mask((uint32_t)res);
+        }
+
+        /* the kernel can end a multishot poll on its own (e.g. completion queue overflow), re-arm it. */
+        if (poll_terminated && res >= 0) {
+            s_arm_handle_poll(handle_data);
+        }
+
+        if (event_flags == 0) {
+            continue;
+        }
+
+        if (handle_data->events_this_loop == 0 && num_handles_with_events < impl->handles_with_events_capacity) {
+            impl->handles_with_events[num_handles_with_events++] = handle_data;
+        }
+        handle_data->events_this_loop |= event_flags;
+    }
+
+    __atomic_store_n(impl->cq.head, head, __ATOMIC_RELEASE);
+
+    return num_handles_with_events;
+}
+
+static void s_main_loop(void *args) {
+    struct aws_event_loop *event_loop = args;
+    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: main loop started", (void *)event_loop);
+    struct io_uring_loop *impl = event_loop->impl_data;
+
+    /* set thread id to the thread of the event loop */
+    aws_atomic_store_ptr(&impl->running_thread_id, &impl->thread_created_on.thread_id);
+
+    struct __kernel_timespec timeout = {
+        .tv_sec = DEFAULT_TIMEOUT_SEC,
+        .tv_nsec = 0,
+    };
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: default timeout %ds, and max completions to process per tick %zu",
+        (void *)event_loop,
+        DEFAULT_TIMEOUT_SEC,
+        impl->handles_with_events_capacity);
+
+    /*
+     * until stop is called,
+     * submit queued SQEs and wait for completions in a single io_uring_enter(); a scheduled task or a file
+     * descriptor with activity will make it return.
+     *
+     * process all completions,
+     *
+     * run all scheduled tasks.
+     */
+    while (impl->should_continue) {
+        /* The wakeup poll lives for the lifetime of the ring, it's re-armed on the off chance the kernel ended it. */
+        if (!impl->wakeup_poll_armed) {
+            if (s_arm_poll(impl, impl->wakeup_fd, AWS_IO_EVENT_TYPE_READABLE, (uint64_t)(uintptr_t)&impl->wakeup_fd)) {
+                AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: failed to arm the wakeup poll.", (void *)event_loop);
+                break;
+            }
+            impl->wakeup_poll_armed = true;
+        }
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: submitting %u entries and waiting for a maximum of %ds %lluns",
+            (void *)event_loop,
+            impl->sq.pending,
+            (int)timeout.tv_sec,
+            (unsigned long long)timeout.tv_nsec);
+
+        if (s_submit_and_wait(impl, &timeout)) {
+            /* We can't process completions, but we can still process scheduled tasks.
+             * Force the cross-thread tasks to be processed, the stop task may be in there. */
+            impl->should_process_task_pre_queue = true;
+        }
+
+        aws_event_loop_register_tick_start(event_loop);
+
+        size_t num_handles_with_events = s_reap_completions(event_loop);
+
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_EVENT_LOOP,
+            "id=%p: wake up with %zu handles to process.",
+            (void *)event_loop,
+            num_handles_with_events);
+
+        for (size_t i = 0; i < num_handles_with_events; ++i) {
+            struct io_uring_handle_data *handle_data = impl->handles_with_events[i];
+            int event_flags = handle_data->events_this_loop;
+            handle_data->events_this_loop = 0;
+
+            if (handle_data->state == HANDLE_STATE_SUBSCRIBED) {
+                AWS_LOGF_TRACE(
+                    AWS_LS_IO_EVENT_LOOP,
+                    "id=%p: activity on fd %d, invoking handler.",
+                    (void *)event_loop,
+                    handle_data->handle->data.fd);
+                uint64_t start_ns = aws_event_loop_profiler_begin(event_loop);
+                handle_data->on_event(event_loop, handle_data->handle, event_flags, handle_data->user_data);
+                aws_event_loop_profiler_end(event_loop, "io_event", start_ns);
+            }
+        }
+
+        /* run scheduled tasks */
+        s_process_task_pre_queue(event_loop);
+
+        uint64_t now_ns = 0;
+        event_loop->clock(&now_ns); /* if clock fails, now_ns will be 0 and tasks scheduled for a specific time
+                                       will not be run. That's ok, we'll handle them next time around. */
+        AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
+        aws_task_scheduler_run_all(&impl->scheduler, now_ns);
+
+        aws_event_loop_register_tick_end(event_loop, num_handles_with_events);
+
+        /* set timeout for next io_uring_enter() call.
+         * if clock fails, or scheduler has no tasks, use default timeout */
+        bool use_default_timeout = false;
+
+        if (event_loop->clock(&now_ns)) {
+            use_default_timeout = true;
+        }
+
+        uint64_t next_run_time_ns;
+        if (!aws_task_scheduler_has_tasks(&impl->scheduler, &next_run_time_ns)) {
+            use_default_timeout = true;
+        }
+
+        if (use_default_timeout) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP, "id=%p: no more scheduled tasks using default timeout.", (void *)event_loop);
+            timeout.tv_sec = DEFAULT_TIMEOUT_SEC;
+            timeout.tv_nsec = 0;
+        } else {
+            /* Convert from timestamp in nanoseconds, to timeout in seconds with nanosecond remainder */
+            uint64_t timeout_ns = (next_run_time_ns > now_ns) ? (next_run_time_ns - now_ns) : 0;
+            uint64_t timeout_remainder_ns = 0;
+            uint64_t timeout_sec =
+                aws_timestamp_convert(timeout_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, &timeout_remainder_ns);
+
+            if (timeout_sec > LONG_MAX) {
+                timeout_sec = LONG_MAX;
+                timeout_remainder_ns = 0;
+            }
+
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_EVENT_LOOP,
+                "id=%p: detected more scheduled tasks with the next occurring at "
+                "%llu, using timeout of %ds %lluns.",
+                (void *)event_loop,
+                (unsigned long long)timeout_ns,
+                (int)timeout_sec,
+                (unsigned long long)timeout_remainder_ns);
+            timeout.tv_sec = (long long)timeout_sec;
+            timeout.tv_nsec = (long long)timeout_remainder_ns;
+        }
+    }
+
+    /* hand any remaining SQEs (e.g. poll removals) to the kernel before going idle */
+    s_submit_and_wait(impl, NULL);
+
+    AWS_LOGF_DEBUG(AWS_LS_IO_EVENT_LOOP, "id=%p: exiting main loop", (void *)event_loop);
+    /* set thread id back to NULL. This should be updated again in destroy, before tasks are canceled. */
+    aws_atomic_store_ptr(&impl->running_thread_id, NULL);
+}
@@ -5,25 +5,49 @@
 
 #include <aws/io/message_pool.h>
 
+#include <aws/io/private/huge_pages.h>
+#include <aws/io/statistics.h>
+
+#include <aws/common/math.h>
 #include <aws/common/thread.h>
 
-int aws_memory_pool_init(
+/* Sets up an empty pool with room for ideal_segment_count segments. */
+static int s_memory_pool_init_empty(
     struct aws_memory_pool *mempool,
     struct aws_allocator *alloc,
-    uint16_t ideal_segment_count,
+    size_t ideal_segment_count,
     size_t segment_size) {
 
     mempool->alloc = alloc;
     mempool->ideal_segment_count = ideal_segment_count;
     mempool->segment_size = segment_size;
+    mempool->max_segment_count = ideal_segment_count;
+    mempool->outstanding_count = 0;
+    mempool->high_water_mark = 0;
+    mempool->depot = NULL;
+    mempool->depot_batch_count = 0;
+    mempool->slab = NULL;
+    mempool->slab_length = 0;
     mempool->data_ptr = aws_mem_calloc(alloc, ideal_segment_count, sizeof(void *));
     if (!mempool->data_ptr) {
         return AWS_OP_ERR;
     }
 
     aws_array_list_init_static(&mempool->stack, mempool->data_ptr, ideal_segment_count, sizeof(void *));
+    return AWS_OP_SUCCESS;
+}
 
-    for (uint16_t i = 0; i < ideal_segment_count; ++i) {
+int aws_memory_pool_init(
+    struct aws_memory_pool *mempool,
+    struct aws_allocator *alloc,
+    size_t ideal_segment_count,
+    size_t segment_size) {
+
+    if (s_memory_pool_init_empty(mempool, alloc, ideal_segment_count, segment_size)) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < ideal_segment_count; ++i) {
         void *memory = aws_mem_acquire(alloc, segment_size);
         if (memory) {
             aws_array_list_push_back(&mempool->stack, &memory);
@@ -39,6 +63,59 @@ clean_up:
     return AWS_OP_ERR;
 }
 
+/* segments carved from a slab start on this boundary, which suits anything a message holds */
+#define SLAB_SEGMENT_ALIGNMENT 16
+
+int aws_memory_pool_init_from_huge_pages(
+    struct aws_memory_pool *mempool,
+    struct aws_allocator *alloc,
+    size_t ideal_segment_count,
+    size_t segment_size) {
+
+    if (s_memory_pool_init_empty(mempool, alloc, ideal_segment_count, segment_size)) {
+        return AWS_OP_ERR;
+    }
+
+    if (ideal_segment_count == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_huge_page_slab slab;
+    size_t stride = 0;
+    size_t slab_size = 0;
+    if (aws_add_size_checked(segment_size, SLAB_SEGMENT_ALIGNMENT - 1, &stride)) {
+        goto clean_up;
+    }
+    stride -= stride % SLAB_SEGMENT_ALIGNMENT;
+    if (aws_mul_size_checked(stride, ideal_segment_count, &slab_size)) {
+        goto clean_up;
+    }
+
+    if (aws_huge_page_slab_init(&slab, slab_size)) {
+        goto clean_up;
+    }
+
+    mempool->slab = slab.address;
+    mempool->slab_length = slab.length;
+
+    /* pushed last to first, so the pool hands them out in address order */
+    for (size_t i = ideal_segment_count; i > 0; --i) {
+        void *segment = (uint8_t *)slab.address + (i - 1) * stride;
+        aws_array_list_push_back(&mempool->stack, &segment);
+    }
+
+    return AWS_OP_SUCCESS;
+
+clean_up:
+    aws_memory_pool_clean_up(mempool);
+    return AWS_OP_ERR;
+}
+
+static bool s_is_slab_segment(const struct aws_memory_pool *mempool, const void *segment) {
+    return mempool->slab && (const uint8_t *)segment >= (const uint8_t *)mempool->slab &&
+           (const uint8_t *)segment < (const uint8_t *)mempool->slab + mempool->slab_length;
+}
+
 void aws_memory_pool_clean_up(struct aws_memory_pool *mempool) {
     void *cur = NULL;
 
@@ -46,40 +123,289 @@ void aws_memory_pool_clean_up(struct aws_memory_pool *mempool) {
         /* the only way this fails is not possible since I already checked the length. */
         aws_array_list_back(&mempool->stack, &cur);
         aws_array_list_pop_back(&mempool->stack);
-        aws_mem_release(mempool->alloc, cur);
+        if (!s_is_slab_segment(mempool, cur)) {
+            aws_mem_release(mempool->alloc, cur);
+        }
     }
 
     aws_array_list_clean_up(&mempool->stack);
     aws_mem_release(mempool->alloc, mempool->data_ptr);
+
+    if (mempool->slab) {
+        struct aws_huge_page_slab slab = {
+            .address = mempool->slab,
+            .length = mempool->slab_length,
+        };
+        aws_huge_page_slab_clean_up(&slab);
+        mempool->slab = NULL;
+        mempool->slab_length = 0;
+    }
+}
+
+struct aws_memory_pool_depot {
+    struct aws_mutex lock;
+    size_t segment_size;
+    /* void *, never more than the owning aws_message_pool_depot's max_segment_count */
+    struct aws_array_list segments;
+};
+
+/* Takes a batch of segments from the depot, as many as it has up to the free room in the pool. */
+static void s_memory_pool_refill(struct aws_memory_pool *mempool) {
+    struct aws_memory_pool_depot *depot = mempool->depot;
+    size_t room = mempool->ideal_segment_count - aws_array_list_length(&mempool->stack);
+
+    aws_mutex_lock(&depot->lock);
+    size_t count =
+        aws_min_size(aws_min_size(aws_array_list_length(&depot->segments), mempool->depot_batch_count), room);
+    for (size_t i = 0; i < count; ++i) {
+        void *segment = NULL;
+        aws_array_list_back(&depot->segments, &segment);
+        aws_array_list_pop_back(&depot->segments);
+        aws_array_list_push_back(&mempool->stack, &segment);
+    }
+    aws_mutex_unlock(&depot->lock);
+}
+
+/* Hands to_release to the depot along with a batch from the full pool, so the next few releases needn't come back.
+ * Returns false if the depot is full as well. */
+static bool s_memory_pool_spill(struct aws_memory_pool *mempool, void *to_release) {
+    struct aws_memory_pool_depot *depot = mempool->depot;
+
+    aws_mutex_lock(&depot->lock);
+    size_t room = aws_array_list_capacity(&depot->segments) - aws_array_list_length(&depot->segments);
+    if (room == 0) {
+        aws_mutex_unlock(&depot->lock);
+        return false;
+    }
+
+    aws_array_list_push_back(&depot->segments, &to_release);
+    size_t count = aws_min_size(
+        aws_min_size(room - 1, mempool->depot_batch_count - 1), aws_array_list_length(&mempool->stack));
+    for (size_t i = 0; i < count; ++i) {
+        void *segment = NULL;
+        aws_array_list_back(&mempool->stack, &segment);
+        /* slab segments would outlive their slab in the depot */
+        if (s_is_slab_segment(mempool, segment)) {
+            break;
+        }
+        aws_array_list_pop_back(&mempool->stack);
+        aws_array_list_push_back(&depot->segments, &segment);
+    }
+    aws_mutex_unlock(&depot->lock);
+
+    return true;
 }
 
 void *aws_memory_pool_acquire(struct aws_memory_pool *mempool) {
     void *back = NULL;
+    if (aws_array_list_length(&mempool->stack) == 0 && mempool->depot) {
+        s_memory_pool_refill(mempool);
+    }
+
     if (aws_array_list_length(&mempool->stack) > 0) {
         aws_array_list_back(&mempool->stack, &back);
         aws_array_list_pop_back(&mempool->stack);
+        aws_io_metrics_add(AWS_IO_METRIC_MESSAGE_POOL_HITS, 1);
+    } else {
+        aws_io_metrics_add(AWS_IO_METRIC_MESSAGE_POOL_MISSES, 1);
+        back = aws_mem_acquire(mempool->alloc, mempool->segment_size);
+        if (!back) {
+            return NULL;
+        }
+    }
+
+    mempool->outstanding_count++;
+    if (mempool->outstanding_count > mempool->high_water_mark) {
+        mempool->high_water_mark = mempool->outstanding_count;
+    }
+
+    return back;
+}
 
-        return back;
+/* Raises ideal_segment_count towards the high-water mark (bounded by max_segment_count), re-homing the stack in a
+ * larger buffer. Returns false if the pool shouldn't or couldn't grow. */
+static bool s_memory_pool_try_grow(struct aws_memory_pool *mempool) {
+    size_t target_count = aws_min_size(mempool->high_water_mark, mempool->max_segment_count);
+    if (target_count <= mempool->ideal_segment_count) {
+        return false;
     }
 
-    void *mem = aws_mem_acquire(mempool->alloc, mempool->segment_size);
-    return mem;
+    void *new_data_ptr = aws_mem_calloc(mempool->alloc, target_count, sizeof(void *));
+    if (!new_data_ptr) {
+        return false;
+    }
+
+    struct aws_array_list new_stack;
+    aws_array_list_init_static(&new_stack, new_data_ptr, target_count, sizeof(void *));
+
+    size_t pool_size = aws_array_list_length(&mempool->stack);
+    for (size_t i = 0; i < pool_size; ++i) {
+        void *segment = NULL;
+        aws_array_list_get_at(&mempool->stack, &segment, i);
+        aws_array_list_push_back(&new_stack, &segment);
+    }
+
+    aws_mem_release(mempool->alloc, mempool->data_ptr);
+    mempool->data_ptr = new_data_ptr;
+    mempool->stack = new_stack;
+    mempool->ideal_segment_count = target_count;
+
+    return true;
+}
+
+/* Makes room in a full pool for one of its slab segments by freeing a segment that came from the allocator instead.
+ * There always is one: the slab holds no more segments than the pool retains, and this one isn't in the pool. */
+static void s_memory_pool_keep_slab_segment(struct aws_memory_pool *mempool, void *slab_segment) {
+    size_t pool_size = aws_array_list_length(&mempool->stack);
+    for (size_t i = pool_size; i > 0; --i) {
+        void *segment = NULL;
+        aws_array_list_get_at(&mempool->stack, &segment, i - 1);
+        if (!s_is_slab_segment(mempool, segment)) {
+            aws_mem_release(mempool->alloc, segment);
+            aws_array_list_set_at(&mempool->stack, &slab_segment, i - 1);
+            return;
+        }
+    }
+
+    AWS_ASSERT(false);
 }
 
 void aws_memory_pool_release(struct aws_memory_pool *mempool, void *to_release) {
     size_t pool_size = aws_array_list_length(&mempool->stack);
 
-    if (pool_size >= mempool->ideal_segment_count) {
-        aws_mem_release(mempool->alloc, to_release);
+    if (mempool->outstanding_count > 0) {
+        mempool->outstanding_count--;
+    }
+
+    if (pool_size >= mempool->ideal_segment_count && !s_memory_pool_try_grow(mempool)) {
+        if (s_is_slab_segment(mempool, to_release)) {
+            s_memory_pool_keep_slab_segment(mempool, to_release);
+            return;
+        }
+        if (!mempool->depot || !s_memory_pool_spill(mempool, to_release)) {
+            aws_mem_release(mempool->alloc, to_release);
+        }
         return;
     }
 
     aws_array_list_push_back(&mempool->stack, &to_release);
 }
 
+int aws_message_pool_depot_init(
+    struct aws_message_pool_depot *depot,
+    struct aws_allocator *alloc,
+    size_t max_segment_count) {
+
+    AWS_ZERO_STRUCT(*depot);
+    depot->alloc = alloc;
+    depot->max_segment_count = max_segment_count;
+    if (aws_mutex_init(&depot->lock)) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_array_list_init_dynamic(&depot->tiers, alloc, 4, sizeof(struct aws_memory_pool_depot *))) {
+        aws_mutex_clean_up(&depot->lock);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_message_pool_depot_clean_up(struct aws_message_pool_depot *depot) {
+    for (size_t i = 0; i < aws_array_list_length(&depot->tiers); ++i) {
+        struct aws_memory_pool_depot *tier = NULL;
+        aws_array_list_get_at(&depot->tiers, &tier, i);
+
+        while (aws_array_list_length(&tier->segments) > 0) {
+            void *segment = NULL;
+            aws_array_list_back(&tier->segments, &segment);
+            aws_array_list_pop_back(&tier->segments);
+            aws_mem_release(depot->alloc, segment);
+        }
+
+        aws_array_list_clean_up(&tier->segments);
+        aws_mutex_clean_up(&tier->lock);
+        aws_mem_release(depot->alloc, tier);
+    }
+
+    aws_array_list_clean_up(&depot->tiers);
+    aws_mutex_clean_up(&depot->lock);
+    AWS_ZERO_STRUCT(*depot);
+}
+
+/* Finds the depot's tier for the pool's segment size, adding it if this is the first pool of that size. */
+static int s_memory_pool_attach_depot(struct aws_memory_pool *mempool, struct aws_message_pool_depot *depot) {
+    struct aws_memory_pool_depot *found = NULL;
+
+    aws_mutex_lock(&depot->lock);
+    for (size_t i = 0; i < aws_array_list_length(&depot->tiers); ++i) {
+        struct aws_memory_pool_depot *tier = NULL;
+        aws_array_list_get_at(&depot->tiers, &tier, i);
+        if (tier->segment_size == mempool->segment_size) {
+            found = tier;
+            break;
+        }
+    }
+
+    if (!found) {
+        found = aws_mem_calloc(depot->alloc, 1, sizeof(struct aws_memory_pool_depot));
+        if (!found) {
+            goto error;
+        }
+
+        found->segment_size = mempool->segment_size;
+        if (aws_mutex_init(&found->lock)) {
+            goto free_tier;
+        }
+        /* reserved up front, so pushing segments under the lock never allocates */
+        if (aws_array_list_init_dynamic(&found->segments, depot->alloc, depot->max_segment_count, sizeof(void *))) {
+            goto clean_up_tier_lock;
+        }
+        if (aws_array_list_push_back(&depot->tiers, &found)) {
+            goto clean_up_tier_segments;
+        }
+    }
+    aws_mutex_unlock(&depot->lock);
+
+    mempool->depot = found;
+    mempool->depot_batch_count = aws_max_size(1, mempool->ideal_segment_count / 2);
+    return AWS_OP_SUCCESS;
+
+clean_up_tier_segments:
+    aws_array_list_clean_up(&found->segments);
+clean_up_tier_lock:
+    aws_mutex_clean_up(&found->lock);
+free_tier:
+    aws_mem_release(depot->alloc, found);
+error:
+    aws_mutex_unlock(&depot->lock);
+    return AWS_OP_ERR;
+}
+
+static int s_message_pool_attach_depot(struct aws_message_pool *msg_pool, struct aws_message_pool_depot *depot) {
+    if (depot->alloc != msg_pool->alloc) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (s_memory_pool_attach_depot(&msg_pool->application_data_pool, depot) ||
+        s_memory_pool_attach_depot(&msg_pool->small_block_pool, depot)) {
+        return AWS_OP_ERR;
+    }
+
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        if (s_memory_pool_attach_depot(&msg_pool->size_class_pools[i], depot)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 struct message_pool_allocator {
     struct aws_allocator base_allocator;
     struct aws_message_pool *msg_pool;
+    /* the size class this message's memory came from, and returns to */
+    struct aws_memory_pool *owning_pool;
 };
 
 void *s_message_pool_mem_acquire(struct aws_allocator *allocator, size_t size) {
@@ -105,10 +431,16 @@ int aws_message_pool_init(
     struct aws_message_pool_creation_args *args) {
 
     msg_pool->alloc = alloc;
+    msg_pool->zero_policy = args->zero_policy;
+    msg_pool->size_class_pools = NULL;
+    msg_pool->size_class_count = 0;
 
     size_t msg_data_size = args->application_data_msg_data_size + MSG_OVERHEAD;
 
-    if (aws_memory_pool_init(
+    /* only the large messages go on huge pages, a slab for each small size would mostly sit empty */
+    int (*application_data_pool_init)(struct aws_memory_pool *, struct aws_allocator *, size_t, size_t) =
+        args->use_huge_pages ? aws_memory_pool_init_from_huge_pages : aws_memory_pool_init;
+    if (application_data_pool_init(
             &msg_pool->application_data_pool, alloc, args->application_data_msg_count, msg_data_size)) {
         return AWS_OP_ERR;
     }
@@ -116,19 +448,100 @@ int aws_message_pool_init(
     size_t small_blk_data_size = args->small_block_msg_data_size + MSG_OVERHEAD;
 
     if (aws_memory_pool_init(&msg_pool->small_block_pool, alloc, args->small_block_msg_count, small_blk_data_size)) {
-        aws_memory_pool_clean_up(&msg_pool->application_data_pool);
-        return AWS_OP_ERR;
+        goto clean_up_application_data_pool;
+    }
+
+    msg_pool->application_data_pool.max_segment_count =
+        aws_max_size(args->application_data_msg_count, args->application_data_msg_max_count);
+    msg_pool->small_block_pool.max_segment_count =
+        aws_max_size(args->small_block_msg_count, args->small_block_msg_max_count);
+
+    if (args->size_class_msg_count == 0) {
+        goto attach_depot;
+    }
+
+    size_t class_count = 0;
+    for (size_t class_size = 1; class_size < args->application_data_msg_data_size && class_size <= SIZE_MAX / 2;
+         class_size <<= 1) {
+        if (class_size > args->small_block_msg_data_size) {
+            ++class_count;
+        }
+    }
+
+    if (class_count == 0) {
+        goto attach_depot;
+    }
+
+    msg_pool->size_class_pools = aws_mem_calloc(alloc, class_count, sizeof(struct aws_memory_pool));
+    if (!msg_pool->size_class_pools) {
+        goto clean_up_small_block_pool;
+    }
+
+    for (size_t class_size = 1; msg_pool->size_class_count < class_count; class_size <<= 1) {
+        if (class_size <= args->small_block_msg_data_size) {
+            continue;
+        }
+
+        struct aws_memory_pool *class_pool = &msg_pool->size_class_pools[msg_pool->size_class_count];
+        if (aws_memory_pool_init(class_pool, alloc, args->size_class_msg_count, class_size + MSG_OVERHEAD)) {
+            goto clean_up_size_class_pools;
+        }
+        class_pool->max_segment_count = aws_max_size(args->size_class_msg_count, args->size_class_msg_max_count);
+        msg_pool->size_class_count++;
+    }
+
+attach_depot:
+    if (args->depot && s_message_pool_attach_depot(msg_pool, args->depot)) {
+        goto clean_up_size_class_pools;
     }
 
     return AWS_OP_SUCCESS;
+
+clean_up_size_class_pools:
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        aws_memory_pool_clean_up(&msg_pool->size_class_pools[i]);
+    }
+    if (msg_pool->size_class_pools) {
+        aws_mem_release(alloc, msg_pool->size_class_pools);
+    }
+
+clean_up_small_block_pool:
+    aws_memory_pool_clean_up(&msg_pool->small_block_pool);
+
+clean_up_application_data_pool:
+    aws_memory_pool_clean_up(&msg_pool->application_data_pool);
+
+    return AWS_OP_ERR;
 }
 
 void aws_message_pool_clean_up(struct aws_message_pool *msg_pool) {
     aws_memory_pool_clean_up(&msg_pool->application_data_pool);
     aws_memory_pool_clean_up(&msg_pool->small_block_pool);
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        aws_memory_pool_clean_up(&msg_pool->size_class_pools[i]);
+    }
+    if (msg_pool->size_class_pools) {
+        aws_mem_release(msg_pool->alloc, msg_pool->size_class_pools);
+    }
     AWS_ZERO_STRUCT(*msg_pool);
 }
 
+/* Picks the smallest pool whose messages fit size_hint, falling back to the application data pool. */
+static struct aws_memory_pool *s_select_pool(struct aws_message_pool *msg_pool, size_t size_hint) {
+    if (size_hint <= msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
+        return &msg_pool->small_block_pool;
+    }
+
+    for (size_t i = 0; i < msg_pool->size_class_count; ++i) {
+        struct aws_memory_pool *class_pool = &msg_pool->size_class_pools[i];
+        if (size_hint <= class_pool->segment_size - MSG_OVERHEAD) {
+            return class_pool;
+        }
+    }
+
+    return &msg_pool->application_data_pool;
+}
+
 struct message_wrapper {
     struct aws_io_message message;
     struct message_pool_allocator msg_allocator;
@@ -141,16 +554,13 @@ struct aws_io_message *aws_message_pool_acquire(
     size_t size_hint) {
 
     struct message_wrapper *message_wrapper = NULL;
+    struct aws_memory_pool *owning_pool = NULL;
     size_t max_size = 0;
     switch (message_type) {
         case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (size_hint > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->application_data_pool);
-                max_size = msg_pool->application_data_pool.segment_size - MSG_OVERHEAD;
-            } else {
-                message_wrapper = aws_memory_pool_acquire(&msg_pool->small_block_pool);
-                max_size = msg_pool->small_block_pool.segment_size - MSG_OVERHEAD;
-            }
+            owning_pool = s_select_pool(msg_pool, size_hint);
+            message_wrapper = aws_memory_pool_acquire(owning_pool);
+            max_size = owning_pool->segment_size - MSG_OVERHEAD;
             break;
         default:
             AWS_ASSERT(0);
@@ -166,6 +576,7 @@ struct aws_io_message *aws_message_pool_acquire(
     message_wrapper->message.message_tag = 0;
     message_wrapper->message.user_data = NULL;
     message_wrapper->message.copy_mark = 0;
+    message_wrapper->message.is_sensitive = false;
     message_wrapper->message.on_completion = NULL;
     /* the buffer shares the allocation with the message. It's the bit at the end. */
     message_wrapper->message.message_data.buffer = message_wrapper->buffer_start;
@@ -178,6 +589,7 @@ struct aws_io_message *aws_message_pool_acquire(
     message_wrapper->msg_allocator.base_allocator.mem_realloc = NULL;
     message_wrapper->msg_allocator.base_allocator.mem_release = s_message_pool_mem_release;
     message_wrapper->msg_allocator.msg_pool = msg_pool;
+    message_wrapper->msg_allocator.owning_pool = owning_pool;
 
     message_wrapper->message.allocator = &message_wrapper->msg_allocator.base_allocator;
     return &message_wrapper->message;
@@ -185,18 +597,17 @@ struct aws_io_message *aws_message_pool_acquire(
 
 void aws_message_pool_release(struct aws_message_pool *msg_pool, struct aws_io_message *message) {
 
-    memset(message->message_data.buffer, 0, message->message_data.len);
+    if (msg_pool->zero_policy == AWS_MESSAGE_POOL_ZERO_ALWAYS ||
+        (msg_pool->zero_policy == AWS_MESSAGE_POOL_ZERO_SENSITIVE && message->is_sensitive)) {
+        memset(message->message_data.buffer, 0, message->message_data.len);
+    }
     message->allocator = NULL;
 
     struct message_wrapper *wrapper = AWS_CONTAINER_OF(message, struct message_wrapper, message);
 
     switch (message->message_type) {
         case AWS_IO_MESSAGE_APPLICATION_DATA:
-            if (message->message_data.capacity > msg_pool->small_block_pool.segment_size - MSG_OVERHEAD) {
-                aws_memory_pool_release(&msg_pool->application_data_pool, wrapper);
-            } else {
-                aws_memory_pool_release(&msg_pool->small_block_pool, wrapper);
-            }
+            aws_memory_pool_release(wrapper->msg_allocator.owning_pool, wrapper);
             break;
         default:
             AWS_ASSERT(0);
@@ -0,0 +1,267 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/retry_strategy.h>
+
+#include <aws/io/logging.h>
+
+#include <aws/common/hash_table.h>
+#include <aws/common/logging.h>
+#include <aws/common/rw_lock.h>
+#include <aws/common/string.h>
+
+#include <inttypes.h>
+
+static const size_t s_default_max_partitions = 64;
+
+struct retry_partition {
+    struct aws_allocator *allocator;
+    struct aws_string *partition_id;
+    /* hash table key, points into partition_id */
+    struct aws_byte_cursor partition_id_cur;
+    struct aws_retry_strategy *retry_strategy;
+    /* value of the strategy's use counter the last time this partition was used, for picking an eviction victim */
+    struct aws_atomic_var last_used;
+};
+
+/*
+ * Rather than keeping the partitions on an LRU list, which would need the write lock on every acquisition to move one
+ * to the front, a hit only stamps the partition with a counter under the read lock. The least recently used partition
+ * is found by scanning the stamps, which only happens when a new partition is added to a full table.
+ */
+struct partitioned_retry_strategy {
+    struct aws_retry_strategy base;
+    struct aws_standard_retry_options partition_config;
+    size_t max_partitions;
+    struct aws_atomic_var use_counter;
+    struct aws_rw_lock partitions_lock;
+    /* aws_byte_cursor * -> struct retry_partition * */
+    struct aws_hash_table partitions;
+};
+
+static bool s_byte_cursor_eq(const void *a, const void *b) {
+    return aws_byte_cursor_eq(a, b);
+}
+
+static void s_retry_partition_destroy(void *value) {
+    struct retry_partition *partition = value;
+    aws_retry_strategy_release(partition->retry_strategy);
+    aws_string_destroy(partition->partition_id);
+    aws_mem_release(partition->allocator, partition);
+}
+
+static struct retry_partition *s_retry_partition_new(
+    struct partitioned_retry_strategy *partitioned_strategy,
+    const struct aws_byte_cursor *partition_id) {
+    struct aws_allocator *allocator = partitioned_strategy->base.allocator;
+
+    struct retry_partition *partition = aws_mem_calloc(allocator, 1, sizeof(struct retry_partition));
+    if (!partition) {
+        return NULL;
+    }
+
+    partition->allocator = allocator;
+    partition->partition_id = aws_string_new_from_cursor(allocator, partition_id);
+    if (!partition->partition_id) {
+        goto on_error;
+    }
+
+    partition->partition_id_cur = aws_byte_cursor_from_string(partition->partition_id);
+    partition->retry_strategy = aws_retry_strategy_new_standard(allocator, &partitioned_strategy->partition_config);
+    if (!partition->retry_strategy) {
+        goto on_error;
+    }
+
+    return partition;
+
+on_error:
+    aws_string_destroy(partition->partition_id);
+    aws_mem_release(allocator, partition);
+    return NULL;
+}
+
+/* Write lock must be held. */
+static void s_evict_least_recently_used(struct partitioned_retry_strategy *partitioned_strategy) {
+    struct retry_partition *victim = NULL;
+    size_t victim_last_used = SIZE_MAX;
+
+    for (struct aws_hash_iter iter = aws_hash_iter_begin(&partitioned_strategy->partitions); !aws_hash_iter_done(&iter);
+         aws_hash_iter_next(&iter)) {
+        struct retry_partition *partition = iter.element.value;
+        size_t last_used = aws_atomic_load_int(&partition->last_used);
+        if (last_used < victim_last_used) {
+            victim = partition;
+            victim_last_used = last_used;
+        }
+    }
+
+    if (victim) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+            "id=%p: Evicting retry partition \"" PRInSTR "\"",
+            (void *)&partitioned_strategy->base,
+            AWS_BYTE_CURSOR_PRI(victim->partition_id_cur));
+        aws_hash_table_remove(&partitioned_strategy->partitions, &victim->partition_id_cur, NULL, NULL);
+    }
+}
+
+/* Returns the partition's strategy with a reference acquired on it, creating the partition if needed. */
+static struct aws_retry_strategy *s_acquire_partition_strategy(
+    struct partitioned_retry_strategy *partitioned_strategy,
+    const struct aws_byte_cursor *partition_id) {
+    size_t now = aws_atomic_fetch_add(&partitioned_strategy->use_counter, 1);
+    struct aws_retry_strategy *retry_strategy = NULL;
+    struct aws_hash_element *element = NULL;
+
+    /* the common case: the partition exists and this only shares the read lock with other acquisitions */
+    aws_rw_lock_rlock(&partitioned_strategy->partitions_lock);
+    aws_hash_table_find(&partitioned_strategy->partitions, partition_id, &element);
+    if (element) {
+        struct retry_partition *partition = element->value;
+        aws_atomic_store_int(&partition->last_used, now);
+        retry_strategy = partition->retry_strategy;
+        aws_retry_strategy_acquire(retry_strategy);
+    }
+    aws_rw_lock_runlock(&partitioned_strategy->partitions_lock);
+
+    if (retry_strategy) {
+        return retry_strategy;
+    }
+
+    /* build the new partition outside of the lock, another thread may beat us to it in the mean time */
+    struct retry_partition *new_partition = s_retry_partition_new(partitioned_strategy, partition_id);
+    if (!new_partition) {
+        return NULL;
+    }
+    aws_atomic_init_int(&new_partition->last_used, now);
+
+    bool put_failed = false;
+    aws_rw_lock_wlock(&partitioned_strategy->partitions_lock);
+    aws_hash_table_find(&partitioned_strategy->partitions, partition_id, &element);
+    if (element) {
+        struct retry_partition *partition = element->value;
+        aws_atomic_store_int(&partition->last_used, now);
+        retry_strategy = partition->retry_strategy;
+    } else {
+        if (aws_hash_table_get_entry_count(&partitioned_strategy->partitions) >= partitioned_strategy->max_partitions) {
+            s_evict_least_recently_used(partitioned_strategy);
+        }
+
+        if (aws_hash_table_put(
+                &partitioned_strategy->partitions, &new_partition->partition_id_cur, new_partition, NULL)) {
+            put_failed = true;
+        } else {
+            retry_strategy = new_partition->retry_strategy;
+            new_partition = NULL;
+        }
+    }
+
+    if (retry_strategy) {
+        aws_retry_strategy_acquire(retry_strategy);
+    }
+    aws_rw_lock_wunlock(&partitioned_strategy->partitions_lock);
+
+    if (new_partition) {
+        s_retry_partition_destroy(new_partition);
+    }
+
+    if (put_failed) {
+        return NULL;
+    }
+
+    return retry_strategy;
+}
+
+static int s_partitioned_retry_acquire_token(
+    struct aws_retry_strategy *retry_strategy,
+    const struct aws_byte_cursor *partition_id,
+    aws_retry_strategy_on_retry_token_acquired_fn *on_acquired,
+    void *user_data,
+    uint64_t timeout_ms) {
+    struct partitioned_retry_strategy *partitioned_strategy = retry_strategy->impl;
+
+    struct aws_byte_cursor partition_key = partition_id ? *partition_id : aws_byte_cursor_from_c_str("");
+
+    struct aws_retry_strategy *partition_strategy = s_acquire_partition_strategy(partitioned_strategy, &partition_key);
+    if (!partition_strategy) {
+        return AWS_OP_ERR;
+    }
+
+    /* the token keeps its partition's strategy alive, even if the partition gets evicted */
+    int result =
+        aws_retry_strategy_acquire_retry_token(partition_strategy, partition_id, on_acquired, user_data, timeout_ms);
+    aws_retry_strategy_release(partition_strategy);
+
+    return result;
+}
+
+static void s_partitioned_retry_destroy(struct aws_retry_strategy *retry_strategy) {
+    if (retry_strategy) {
+        struct partitioned_retry_strategy *partitioned_strategy = retry_strategy->impl;
+        aws_hash_table_clean_up(&partitioned_strategy->partitions);
+        aws_rw_lock_clean_up(&partitioned_strategy->partitions_lock);
+        aws_mem_release(retry_strategy->allocator, partitioned_strategy);
+    }
+}
+
+/* Tokens are vended by the partitions' strategies, so their functions are the ones that get invoked on them. */
+static struct aws_retry_strategy_vtable s_partitioned_retry_vtable = {
+    .destroy = s_partitioned_retry_destroy,
+    .acquire_token = s_partitioned_retry_acquire_token,
+    .schedule_retry = NULL,
+    .record_success = NULL,
+    .release_token = NULL,
+};
+
+struct aws_retry_strategy *aws_retry_strategy_new_partitioned(
+    struct aws_allocator *allocator,
+    const struct aws_partitioned_retry_options *config) {
+    AWS_PRECONDITION(config);
+    AWS_PRECONDITION(config->partition_options.backoff_retry_options.el_group);
+
+    if (!config->partition_options.backoff_retry_options.el_group) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct partitioned_retry_strategy *partitioned_strategy =
+        aws_mem_calloc(allocator, 1, sizeof(struct partitioned_retry_strategy));
+
+    if (!partitioned_strategy) {
+        return NULL;
+    }
+
+    partitioned_strategy->max_partitions = config->max_partitions;
+    if (!partitioned_strategy->max_partitions) {
+        partitioned_strategy->max_partitions = s_default_max_partitions;
+    }
+
+    if (aws_hash_table_init(
+            &partitioned_strategy->partitions,
+            allocator,
+            partitioned_strategy->max_partitions,
+            aws_hash_byte_cursor_ptr,
+            s_byte_cursor_eq,
+            NULL,
+            s_retry_partition_destroy)) {
+        aws_mem_release(allocator, partitioned_strategy);
+        return NULL;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Initializing partitioned retry strategy with max partitions %zu",
+        (void *)&partitioned_strategy->base,
+        partitioned_strategy->max_partitions);
+
+    partitioned_strategy->base.allocator = allocator;
+    partitioned_strategy->base.impl = partitioned_strategy;
+    partitioned_strategy->base.vtable = &s_partitioned_retry_vtable;
+    aws_atomic_init_int(&partitioned_strategy->base.ref_count, 1);
+    partitioned_strategy->partition_config = config->partition_options;
+    aws_atomic_init_int(&partitioned_strategy->use_counter, 0);
+    aws_rw_lock_init(&partitioned_strategy->partitions_lock);
+
+    return &partitioned_strategy->base;
+}
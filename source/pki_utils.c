@@ -1,228 +1,493 @@
-/**
- * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
- * SPDX-License-Identifier: Apache-2.0.
- */
-#include <aws/io/pki_utils.h>
-
-#include <aws/common/encoding.h>
-
-#include <aws/io/file_utils.h>
-#include <aws/io/logging.h>
-
-#include <ctype.h>
-#include <errno.h>
-#include <string.h>
-
-enum PEM_PARSE_STATE {
-    BEGIN,
-    ON_DATA,
-};
-
-void aws_cert_chain_clean_up(struct aws_array_list *cert_chain) {
-    for (size_t i = 0; i < aws_array_list_length(cert_chain); ++i) {
-        struct aws_byte_buf *decoded_buffer_ptr = NULL;
-        aws_array_list_get_at_ptr(cert_chain, (void **)&decoded_buffer_ptr, i);
-
-        if (decoded_buffer_ptr) {
-            aws_secure_zero(decoded_buffer_ptr->buffer, decoded_buffer_ptr->len);
-            aws_byte_buf_clean_up(decoded_buffer_ptr);
-        }
-    }
-
-    /* remember, we don't own it so we don't free it, just undo whatever mutations we've done at this point. */
-    aws_array_list_clear(cert_chain);
-}
-
-static int s_convert_pem_to_raw_base64(
-    struct aws_allocator *allocator,
-    const struct aws_byte_cursor *pem,
-    struct aws_array_list *cert_chain_or_key) {
-    enum PEM_PARSE_STATE state = BEGIN;
-
-    struct aws_byte_buf current_cert;
-    const char *begin_header = "-----BEGIN";
-    const char *end_header = "-----END";
-    size_t begin_header_len = strlen(begin_header);
-    size_t end_header_len = strlen(end_header);
-    bool on_length_calc = true;
-
-    struct aws_array_list split_buffers;
-    if (aws_array_list_init_dynamic(&split_buffers, allocator, 16, sizeof(struct aws_byte_cursor))) {
-        return AWS_OP_ERR;
-    }
-
-    if (aws_byte_cursor_split_on_char(pem, '\n', &split_buffers)) {
-        aws_array_list_clean_up(&split_buffers);
-        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer: failed to split on newline");
-        return AWS_OP_ERR;
-    }
-
-    size_t split_count = aws_array_list_length(&split_buffers);
-    size_t i = 0;
-    size_t index_of_current_cert_start = 0;
-    size_t current_cert_len = 0;
-
-    while (i < split_count) {
-        struct aws_byte_cursor *current_cur_ptr = NULL;
-        aws_array_list_get_at_ptr(&split_buffers, (void **)&current_cur_ptr, i);
-
-        /* burn off the padding in the buffer first.
-         * Worst case we'll only have to do this once per line in the buffer. */
-        while (current_cur_ptr->len && aws_isspace(*current_cur_ptr->ptr)) {
-            aws_byte_cursor_advance(current_cur_ptr, 1);
-        }
-
-        /* handle CRLF on Windows by burning '\r' off the end of the buffer */
-        if (current_cur_ptr->len && (current_cur_ptr->ptr[current_cur_ptr->len - 1] == '\r')) {
-            current_cur_ptr->len--;
-        }
-
-        switch (state) {
-            case BEGIN:
-                if (current_cur_ptr->len > begin_header_len &&
-                    !strncmp((const char *)current_cur_ptr->ptr, begin_header, begin_header_len)) {
-                    state = ON_DATA;
-                    index_of_current_cert_start = i + 1;
-                }
-                ++i;
-                break;
-            /* this loops through the lines containing data twice. First to figure out the length, a second
-             * time to actually copy the data. */
-            case ON_DATA:
-                /* Found end tag. */
-                if (current_cur_ptr->len > end_header_len &&
-                    !strncmp((const char *)current_cur_ptr->ptr, end_header, end_header_len)) {
-                    if (on_length_calc) {
-                        on_length_calc = false;
-                        state = ON_DATA;
-                        i = index_of_current_cert_start;
-
-                        if (aws_byte_buf_init(&current_cert, allocator, current_cert_len)) {
-                            goto end_of_loop;
-                        }
-
-                    } else {
-                        if (aws_array_list_push_back(cert_chain_or_key, &current_cert)) {
-                            aws_secure_zero(&current_cert.buffer, current_cert.len);
-                            aws_byte_buf_clean_up(&current_cert);
-                            goto end_of_loop;
-                        }
-                        state = BEGIN;
-                        on_length_calc = true;
-                        current_cert_len = 0;
-                        ++i;
-                    }
-                    /* actually on a line with data in it. */
-                } else {
-                    if (!on_length_calc) {
-                        aws_byte_buf_write(&current_cert, current_cur_ptr->ptr, current_cur_ptr->len);
-                    } else {
-                        current_cert_len += current_cur_ptr->len;
-                    }
-                    ++i;
-                }
-                break;
-        }
-    }
-
-end_of_loop:
-    aws_array_list_clean_up(&split_buffers);
-
-    if (state == BEGIN && aws_array_list_length(cert_chain_or_key) > 0) {
-        return AWS_OP_SUCCESS;
-    }
-
-    AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer.");
-    aws_cert_chain_clean_up(cert_chain_or_key);
-    return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
-}
-
-int aws_decode_pem_to_buffer_list(
-    struct aws_allocator *alloc,
-    const struct aws_byte_cursor *pem_cursor,
-    struct aws_array_list *cert_chain_or_key) {
-    AWS_ASSERT(aws_array_list_length(cert_chain_or_key) == 0);
-    struct aws_array_list base_64_buffer_list;
-
-    if (aws_array_list_init_dynamic(&base_64_buffer_list, alloc, 2, sizeof(struct aws_byte_buf))) {
-        return AWS_OP_ERR;
-    }
-
-    int err_code = AWS_OP_ERR;
-
-    if (s_convert_pem_to_raw_base64(alloc, pem_cursor, &base_64_buffer_list)) {
-        goto cleanup_base64_buffer_list;
-    }
-
-    for (size_t i = 0; i < aws_array_list_length(&base_64_buffer_list); ++i) {
-        size_t decoded_len = 0;
-        struct aws_byte_buf *byte_buf_ptr = NULL;
-        aws_array_list_get_at_ptr(&base_64_buffer_list, (void **)&byte_buf_ptr, i);
-        struct aws_byte_cursor byte_cur = aws_byte_cursor_from_buf(byte_buf_ptr);
-
-        if (aws_base64_compute_decoded_len(&byte_cur, &decoded_len)) {
-            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
-            goto cleanup_output_due_to_error;
-        }
-
-        struct aws_byte_buf decoded_buffer;
-
-        if (aws_byte_buf_init(&decoded_buffer, alloc, decoded_len)) {
-            goto cleanup_output_due_to_error;
-        }
-
-        if (aws_base64_decode(&byte_cur, &decoded_buffer)) {
-            aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
-            aws_byte_buf_clean_up(&decoded_buffer);
-            goto cleanup_output_due_to_error;
-        }
-
-        if (aws_array_list_push_back(cert_chain_or_key, &decoded_buffer)) {
-            aws_byte_buf_clean_up(&decoded_buffer);
-            goto cleanup_output_due_to_error;
-        }
-    }
-
-    err_code = AWS_OP_SUCCESS;
-
-cleanup_base64_buffer_list:
-    aws_cert_chain_clean_up(&base_64_buffer_list);
-    aws_array_list_clean_up(&base_64_buffer_list);
-
-    return err_code;
-
-cleanup_output_due_to_error:
-    AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer.");
-    aws_cert_chain_clean_up(&base_64_buffer_list);
-    aws_array_list_clean_up(&base_64_buffer_list);
-
-    aws_cert_chain_clean_up(cert_chain_or_key);
-
-    return AWS_OP_ERR;
-}
-
-int aws_read_and_decode_pem_file_to_buffer_list(
-    struct aws_allocator *alloc,
-    const char *filename,
-    struct aws_array_list *cert_chain_or_key) {
-
-    struct aws_byte_buf raw_file_buffer;
-    if (aws_byte_buf_init_from_file(&raw_file_buffer, alloc, filename)) {
-        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to read file %s.", filename);
-        return AWS_OP_ERR;
-    }
-    AWS_ASSERT(raw_file_buffer.buffer);
-
-    struct aws_byte_cursor file_cursor = aws_byte_cursor_from_buf(&raw_file_buffer);
-    if (aws_decode_pem_to_buffer_list(alloc, &file_cursor, cert_chain_or_key)) {
-        aws_secure_zero(raw_file_buffer.buffer, raw_file_buffer.len);
-        aws_byte_buf_clean_up(&raw_file_buffer);
-        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to decode PEM file %s.", filename);
-        return AWS_OP_ERR;
-    }
-
-    aws_secure_zero(raw_file_buffer.buffer, raw_file_buffer.len);
-    aws_byte_buf_clean_up(&raw_file_buffer);
-
-    return AWS_OP_SUCCESS;
-}
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/pki_utils.h>
+
+#include <aws/common/encoding.h>
+#include <aws/common/hash_table.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+#include <aws/common/string.h>
+
+#include <aws/io/file_utils.h>
+#include <aws/io/logging.h>
+#include <aws/io/private/positional_file.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+
+enum PEM_PARSE_STATE {
+    BEGIN,
+    ON_DATA,
+};
+
+void aws_cert_chain_clean_up(struct aws_array_list *cert_chain) {
+    for (size_t i = 0; i < aws_array_list_length(cert_chain); ++i) {
+        struct aws_byte_buf *decoded_buffer_ptr = NULL;
+        aws_array_list_get_at_ptr(cert_chain, (void **)&decoded_buffer_ptr, i);
+
+        if (decoded_buffer_ptr) {
+            aws_secure_zero(decoded_buffer_ptr->buffer, decoded_buffer_ptr->len);
+            aws_byte_buf_clean_up(decoded_buffer_ptr);
+        }
+    }
+
+    /* remember, we don't own it so we don't free it, just undo whatever mutations we've done at this point. */
+    aws_array_list_clear(cert_chain);
+}
+
+/*
+ * Single pass PEM decoder. Input can arrive in chunks of any size: whole lines are handled straight out of the chunk
+ * and only a line split across two chunks is copied aside. Base64 is decoded as it is seen, straight into the object
+ * being decoded, so there is no intermediate base64 buffer.
+ */
+struct pem_decoder {
+    struct aws_allocator *allocator;
+    struct aws_array_list *cert_chain_or_key;
+    enum PEM_PARSE_STATE state;
+    /* the start of a line that the previous chunk ended in the middle of */
+    struct aws_byte_buf partial_line;
+    struct aws_byte_buf current_object;
+    /* sextets of the base64 quantum being decoded */
+    uint32_t quantum;
+    size_t quantum_len;
+    size_t padding_len;
+    /* once a quantum ends in padding the object can have no more data */
+    bool seen_padding;
+};
+
+/* decoded objects rarely grow past this, so most are decoded without reallocating */
+#define PEM_DECODER_INITIAL_OBJECT_SIZE 2048
+
+static const char *s_pem_begin_header = "-----BEGIN";
+static const char *s_pem_end_header = "-----END";
+
+static void s_pem_decoder_init(
+    struct pem_decoder *decoder,
+    struct aws_allocator *allocator,
+    struct aws_array_list *cert_chain_or_key) {
+
+    AWS_ZERO_STRUCT(*decoder);
+    decoder->allocator = allocator;
+    decoder->cert_chain_or_key = cert_chain_or_key;
+    decoder->state = BEGIN;
+}
+
+static void s_pem_decoder_clean_up(struct pem_decoder *decoder) {
+    aws_byte_buf_clean_up_secure(&decoder->partial_line);
+    aws_byte_buf_clean_up_secure(&decoder->current_object);
+}
+
+static int s_base64_sextet(uint8_t value) {
+    if (value >= 'A' && value <= 'Z') {
+        return value - 'A';
+    }
+    if (value >= 'a' && value <= 'z') {
+        return value - 'a' + 26;
+    }
+    if (value >= '0' && value <= '9') {
+        return value - '0' + 52;
+    }
+    if (value == '+') {
+        return 62;
+    }
+    if (value == '/') {
+        return 63;
+    }
+
+    return -1;
+}
+
+static int s_pem_decoder_decode_base64(struct pem_decoder *decoder, struct aws_byte_cursor data) {
+    for (size_t i = 0; i < data.len; ++i) {
+        int sextet = 0;
+        if (data.ptr[i] == '=') {
+            /* padding can only fill the last one or two places of a quantum */
+            if (decoder->seen_padding || decoder->quantum_len < 2) {
+                return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+            }
+            decoder->padding_len++;
+        } else {
+            sextet = s_base64_sextet(data.ptr[i]);
+            if (sextet < 0 || decoder->seen_padding || decoder->padding_len) {
+                return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+            }
+        }
+
+        decoder->quantum = (decoder->quantum << 6) | (uint32_t)sextet;
+        if (++decoder->quantum_len < 4) {
+            continue;
+        }
+
+        uint8_t decoded[3] = {
+            (uint8_t)(decoder->quantum >> 16),
+            (uint8_t)(decoder->quantum >> 8),
+            (uint8_t)decoder->quantum,
+        };
+        struct aws_byte_cursor decoded_cur = aws_byte_cursor_from_array(decoded, 3 - decoder->padding_len);
+        if (aws_byte_buf_append_dynamic_secure(&decoder->current_object, &decoded_cur)) {
+            return AWS_OP_ERR;
+        }
+
+        decoder->seen_padding = decoder->padding_len > 0;
+        decoder->quantum = 0;
+        decoder->quantum_len = 0;
+        decoder->padding_len = 0;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_pem_decoder_process_line(struct pem_decoder *decoder, struct aws_byte_cursor line) {
+    /* burn off the padding in the line first */
+    while (line.len && aws_isspace(*line.ptr)) {
+        aws_byte_cursor_advance(&line, 1);
+    }
+
+    /* handle CRLF on Windows by burning '\r' off the end of the line */
+    if (line.len && line.ptr[line.len - 1] == '\r') {
+        line.len--;
+    }
+
+    switch (decoder->state) {
+        case BEGIN: {
+            size_t begin_header_len = strlen(s_pem_begin_header);
+            if (line.len > begin_header_len && !strncmp((const char *)line.ptr, s_pem_begin_header, begin_header_len)) {
+                if (aws_byte_buf_init(&decoder->current_object, decoder->allocator, PEM_DECODER_INITIAL_OBJECT_SIZE)) {
+                    return AWS_OP_ERR;
+                }
+                decoder->state = ON_DATA;
+            }
+            return AWS_OP_SUCCESS;
+        }
+        case ON_DATA: {
+            size_t end_header_len = strlen(s_pem_end_header);
+            if (line.len > end_header_len && !strncmp((const char *)line.ptr, s_pem_end_header, end_header_len)) {
+                /* the base64 has to come in whole quanta */
+                if (decoder->quantum_len) {
+                    return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+                }
+                if (aws_array_list_push_back(decoder->cert_chain_or_key, &decoder->current_object)) {
+                    return AWS_OP_ERR;
+                }
+                AWS_ZERO_STRUCT(decoder->current_object);
+                decoder->seen_padding = false;
+                decoder->state = BEGIN;
+                return AWS_OP_SUCCESS;
+            }
+            return s_pem_decoder_decode_base64(decoder, line);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_pem_decoder_process(struct pem_decoder *decoder, struct aws_byte_cursor chunk) {
+    while (chunk.len) {
+        uint8_t *newline = memchr(chunk.ptr, '\n', chunk.len);
+        if (!newline) {
+            return aws_byte_buf_append_dynamic_secure(&decoder->partial_line, &chunk);
+        }
+
+        struct aws_byte_cursor line = aws_byte_cursor_advance(&chunk, newline - chunk.ptr);
+        aws_byte_cursor_advance(&chunk, 1);
+
+        if (decoder->partial_line.len) {
+            if (aws_byte_buf_append_dynamic_secure(&decoder->partial_line, &line)) {
+                return AWS_OP_ERR;
+            }
+            line = aws_byte_cursor_from_buf(&decoder->partial_line);
+            decoder->partial_line.len = 0;
+        }
+
+        if (s_pem_decoder_process_line(decoder, line)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_pem_decoder_finish(struct pem_decoder *decoder) {
+    /* the last line doesn't need a newline */
+    if (decoder->partial_line.len) {
+        struct aws_byte_cursor line = aws_byte_cursor_from_buf(&decoder->partial_line);
+        decoder->partial_line.len = 0;
+        if (s_pem_decoder_process_line(decoder, line)) {
+            return AWS_OP_ERR;
+        }
+    }
+
+    if (decoder->state != BEGIN || aws_array_list_length(decoder->cert_chain_or_key) == 0) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_decode_pem_to_buffer_list(
+    struct aws_allocator *alloc,
+    const struct aws_byte_cursor *pem_cursor,
+    struct aws_array_list *cert_chain_or_key) {
+    AWS_ASSERT(aws_array_list_length(cert_chain_or_key) == 0);
+
+    struct pem_decoder decoder;
+    s_pem_decoder_init(&decoder, alloc, cert_chain_or_key);
+
+    int result = AWS_OP_SUCCESS;
+    if (s_pem_decoder_process(&decoder, *pem_cursor) || s_pem_decoder_finish(&decoder)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Invalid PEM buffer.");
+        aws_cert_chain_clean_up(cert_chain_or_key);
+        result = AWS_OP_ERR;
+    }
+
+    s_pem_decoder_clean_up(&decoder);
+    return result;
+}
+
+/* PEM files are read and decoded this much at a time */
+#define PEM_FILE_READ_CHUNK_SIZE (16 * 1024)
+
+static int s_decode_pem_file(
+    struct aws_allocator *alloc,
+    const struct aws_positional_file *file,
+    struct aws_array_list *cert_chain_or_key) {
+
+    struct aws_byte_buf chunk;
+    if (aws_byte_buf_init(&chunk, alloc, PEM_FILE_READ_CHUNK_SIZE)) {
+        return AWS_OP_ERR;
+    }
+
+    struct pem_decoder decoder;
+    s_pem_decoder_init(&decoder, alloc, cert_chain_or_key);
+
+    int result = AWS_OP_ERR;
+    uint64_t offset = 0;
+    while (offset < (uint64_t)file->length) {
+        chunk.len = 0;
+        if (aws_positional_file_read(file, offset, &chunk)) {
+            goto done;
+        }
+        if (chunk.len == 0) {
+            /* the file shrank under us, decode what there was */
+            break;
+        }
+        offset += chunk.len;
+
+        if (s_pem_decoder_process(&decoder, aws_byte_cursor_from_buf(&chunk))) {
+            goto done;
+        }
+    }
+
+    if (s_pem_decoder_finish(&decoder)) {
+        goto done;
+    }
+
+    result = AWS_OP_SUCCESS;
+
+done:
+    if (result) {
+        aws_cert_chain_clean_up(cert_chain_or_key);
+    }
+    s_pem_decoder_clean_up(&decoder);
+    aws_byte_buf_clean_up_secure(&chunk);
+
+    return result;
+}
+
+int aws_read_and_decode_pem_file_to_buffer_list(
+    struct aws_allocator *alloc,
+    const char *filename,
+    struct aws_array_list *cert_chain_or_key) {
+    AWS_ASSERT(aws_array_list_length(cert_chain_or_key) == 0);
+
+    struct aws_positional_file file;
+    if (aws_positional_file_open(&file, filename)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to read file %s.", filename);
+        return AWS_OP_ERR;
+    }
+
+    int result = s_decode_pem_file(alloc, &file, cert_chain_or_key);
+    aws_positional_file_close(&file);
+
+    if (result) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to decode PEM file %s.", filename);
+    }
+
+    return result;
+}
+
+/*
+ * Process-wide cache of decoded trust stores, keyed by file path. An entry is only reused while the file still has
+ * the modification time and length it had when it was decoded.
+ */
+struct aws_trust_store {
+    struct aws_allocator *allocator;
+    struct aws_ref_count ref_count;
+    /* struct aws_byte_buf, DER */
+    struct aws_array_list certificates;
+};
+
+struct trust_store_cache_entry {
+    struct aws_trust_store *trust_store;
+    uint64_t modification_time_ns;
+    int64_t length;
+};
+
+static struct aws_allocator *s_trust_store_cache_allocator = NULL;
+static struct aws_mutex s_trust_store_cache_lock = AWS_MUTEX_INIT;
+/* struct aws_string * -> struct trust_store_cache_entry * */
+static struct aws_hash_table s_trust_store_cache;
+
+static void s_trust_store_destroy(void *user_data) {
+    struct aws_trust_store *trust_store = user_data;
+
+    aws_cert_chain_clean_up(&trust_store->certificates);
+    aws_array_list_clean_up(&trust_store->certificates);
+    aws_mem_release(trust_store->allocator, trust_store);
+}
+
+static void s_trust_store_cache_destroy_key(void *key) {
+    aws_string_destroy(key);
+}
+
+static void s_trust_store_cache_destroy_entry(void *value) {
+    struct trust_store_cache_entry *entry = value;
+
+    aws_trust_store_release(entry->trust_store);
+    aws_mem_release(s_trust_store_cache_allocator, entry);
+}
+
+void aws_pki_init_static_state(struct aws_allocator *alloc) {
+    s_trust_store_cache_allocator = alloc;
+    AWS_FATAL_ASSERT(
+        !aws_hash_table_init(
+            &s_trust_store_cache,
+            alloc,
+            4,
+            aws_hash_string,
+            aws_hash_callback_string_eq,
+            s_trust_store_cache_destroy_key,
+            s_trust_store_cache_destroy_entry) &&
+        "failed to initialize the trust store cache");
+}
+
+void aws_pki_clean_up_static_state(void) {
+    aws_hash_table_clean_up(&s_trust_store_cache);
+    s_trust_store_cache_allocator = NULL;
+}
+
+static struct aws_trust_store *s_trust_store_new_from_file(
+    struct aws_allocator *alloc,
+    const struct aws_positional_file *file) {
+
+    struct aws_trust_store *trust_store = aws_mem_calloc(alloc, 1, sizeof(struct aws_trust_store));
+    if (!trust_store) {
+        return NULL;
+    }
+
+    trust_store->allocator = alloc;
+    aws_ref_count_init(&trust_store->ref_count, trust_store, s_trust_store_destroy);
+
+    if (aws_array_list_init_dynamic(&trust_store->certificates, alloc, 16, sizeof(struct aws_byte_buf))) {
+        aws_mem_release(alloc, trust_store);
+        return NULL;
+    }
+
+    if (s_decode_pem_file(alloc, file, &trust_store->certificates)) {
+        aws_trust_store_release(trust_store);
+        return NULL;
+    }
+
+    return trust_store;
+}
+
+struct aws_trust_store *aws_trust_store_acquire_from_file(const char *file_path) {
+    AWS_ASSERT(file_path);
+    aws_io_fatal_assert_library_initialized();
+
+    struct aws_positional_file file;
+    if (aws_positional_file_open(&file, file_path)) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to open trust store %s.", file_path);
+        return NULL;
+    }
+
+    struct aws_trust_store *trust_store = NULL;
+    struct trust_store_cache_entry *entry = NULL;
+    struct aws_string *key = aws_string_new_from_c_str(s_trust_store_cache_allocator, file_path);
+    if (!key) {
+        aws_positional_file_close(&file);
+        return NULL;
+    }
+
+    aws_mutex_lock(&s_trust_store_cache_lock);
+
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&s_trust_store_cache, key, &element);
+    if (element) {
+        struct trust_store_cache_entry *cached = element->value;
+        if (cached->modification_time_ns == file.modification_time_ns && cached->length == file.length) {
+            trust_store = aws_trust_store_acquire(cached->trust_store);
+            goto cache_hit;
+        }
+        AWS_LOGF_DEBUG(AWS_LS_IO_PKI, "static: Trust store %s changed on disk, decoding it again.", file_path);
+    }
+
+    /* decoding under the lock means everyone asking for the same file waits for a single decode of it */
+    trust_store = s_trust_store_new_from_file(s_trust_store_cache_allocator, &file);
+    if (!trust_store) {
+        AWS_LOGF_ERROR(AWS_LS_IO_PKI, "static: Failed to decode trust store %s.", file_path);
+        goto cache_failed;
+    }
+
+    entry = aws_mem_calloc(s_trust_store_cache_allocator, 1, sizeof(struct trust_store_cache_entry));
+    if (!entry) {
+        goto cache_failed;
+    }
+
+    entry->trust_store = aws_trust_store_acquire(trust_store);
+    entry->modification_time_ns = file.modification_time_ns;
+    entry->length = file.length;
+    if (aws_hash_table_put(&s_trust_store_cache, key, entry, NULL)) {
+        aws_trust_store_release(entry->trust_store);
+        goto cache_failed;
+    }
+
+    /* the table owns the key now */
+    goto done;
+
+cache_failed:
+    /* if it decoded, the caller still gets the trust store, it just isn't shared */
+    aws_mem_release(s_trust_store_cache_allocator, entry);
+
+cache_hit:
+    aws_string_destroy(key);
+
+done:
+    aws_mutex_unlock(&s_trust_store_cache_lock);
+    aws_positional_file_close(&file);
+
+    return trust_store;
+}
+
+struct aws_trust_store *aws_trust_store_acquire(struct aws_trust_store *trust_store) {
+    if (trust_store != NULL) {
+        aws_ref_count_acquire(&trust_store->ref_count);
+    }
+
+    return trust_store;
+}
+
+void aws_trust_store_release(struct aws_trust_store *trust_store) {
+    if (trust_store != NULL) {
+        aws_ref_count_release(&trust_store->ref_count);
+    }
+}
+
+const struct aws_array_list *aws_trust_store_get_certificates(const struct aws_trust_store *trust_store) {
+    AWS_ASSERT(trust_store);
+
+    return &trust_store->certificates;
+}
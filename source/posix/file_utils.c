@@ -4,11 +4,18 @@
  */
 
 #include <aws/io/file_utils.h>
+#include <aws/io/private/file_mapping.h>
+#include <aws/io/private/positional_file.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/environment.h>
 #include <aws/common/string.h>
 
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -67,3 +74,189 @@ int aws_file_get_length(FILE *file, int64_t *length) {
 
     return AWS_OP_SUCCESS;
 }
+
+int aws_directory_for_each_entry(
+    struct aws_allocator *allocator,
+    const char *path,
+    aws_directory_entry_fn *on_entry,
+    void *user_data) {
+
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return aws_translate_and_raise_io_error(errno);
+    }
+
+    struct aws_byte_buf entry_path;
+    if (aws_byte_buf_init(&entry_path, allocator, strlen(path) + 64)) {
+        closedir(dir);
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor dir_cursor = aws_byte_cursor_from_c_str(path);
+    struct aws_byte_cursor separator = aws_byte_cursor_from_c_str("/");
+    int result = AWS_OP_SUCCESS;
+
+    for (;;) {
+        errno = 0;
+        struct dirent *dir_entry = readdir(dir);
+        if (!dir_entry) {
+            if (errno != 0) {
+                result = aws_translate_and_raise_io_error(errno);
+            }
+            break;
+        }
+
+        if (!strcmp(dir_entry->d_name, ".") || !strcmp(dir_entry->d_name, "..")) {
+            continue;
+        }
+
+        struct aws_directory_entry entry;
+        AWS_ZERO_STRUCT(entry);
+        entry.name = aws_byte_cursor_from_c_str(dir_entry->d_name);
+
+        /* the path is rebuilt in the same buffer for every entry, it only grows for the longest name */
+        entry_path.len = 0;
+        if (aws_byte_buf_append_dynamic(&entry_path, &dir_cursor) ||
+            aws_byte_buf_append_dynamic(&entry_path, &separator) ||
+            aws_byte_buf_append_dynamic(&entry_path, &entry.name) || aws_byte_buf_append_byte_dynamic(&entry_path, 0)) {
+            result = AWS_OP_ERR;
+            break;
+        }
+        entry.path = aws_byte_cursor_from_array(entry_path.buffer, entry_path.len - 1);
+
+        /* symlinks and file systems that don't fill in the type need a stat, which follows the link */
+        bool needs_stat = true;
+#ifdef DT_DIR
+        if (dir_entry->d_type != DT_UNKNOWN && dir_entry->d_type != DT_LNK) {
+            entry.is_directory = dir_entry->d_type == DT_DIR;
+            entry.is_file = dir_entry->d_type == DT_REG;
+            needs_stat = false;
+        }
+#endif
+        struct stat entry_stats;
+        if (needs_stat && stat((const char *)entry_path.buffer, &entry_stats) == 0) {
+            entry.is_directory = S_ISDIR(entry_stats.st_mode);
+            entry.is_file = S_ISREG(entry_stats.st_mode);
+        }
+
+        if (!on_entry(&entry, user_data)) {
+            break;
+        }
+    }
+
+    aws_byte_buf_clean_up(&entry_path);
+    closedir(dir);
+
+    return result;
+}
+
+int aws_file_mapping_init(struct aws_file_mapping *mapping, const char *file_name, bool advise_sequential) {
+    AWS_ZERO_STRUCT(*mapping);
+
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return aws_translate_and_raise_io_error(errno);
+    }
+
+    struct stat file_stats;
+    if (fstat(fd, &file_stats)) {
+        goto on_error;
+    }
+
+#if SIZE_MAX < UINT64_MAX
+    if ((uint64_t)file_stats.st_size > SIZE_MAX) {
+        close(fd);
+        return aws_raise_error(AWS_ERROR_OVERFLOW_DETECTED);
+    }
+#endif
+
+    /* mmap() refuses empty mappings */
+    if (file_stats.st_size > 0) {
+        void *address = mmap(NULL, (size_t)file_stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            goto on_error;
+        }
+
+        mapping->address = address;
+        mapping->length = (size_t)file_stats.st_size;
+
+        /* hints only, a kernel or file system that doesn't take them changes nothing */
+        if (advise_sequential) {
+            madvise(mapping->address, mapping->length, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            madvise(mapping->address, mapping->length, MADV_HUGEPAGE);
+#endif
+        }
+    }
+
+    /* the mapping keeps the file open on its own */
+    close(fd);
+    return AWS_OP_SUCCESS;
+
+on_error:
+    aws_translate_and_raise_io_error(errno);
+    close(fd);
+    return AWS_OP_ERR;
+}
+
+void aws_file_mapping_clean_up(struct aws_file_mapping *mapping) {
+    if (mapping->address) {
+        munmap(mapping->address, mapping->length);
+    }
+
+    AWS_ZERO_STRUCT(*mapping);
+}
+
+int aws_positional_file_open(struct aws_positional_file *file, const char *file_name) {
+    AWS_ZERO_STRUCT(*file);
+
+    int fd = open(file_name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return aws_translate_and_raise_io_error(errno);
+    }
+
+    struct stat file_stats;
+    if (fstat(fd, &file_stats)) {
+        aws_translate_and_raise_io_error(errno);
+        close(fd);
+        return AWS_OP_ERR;
+    }
+
+    file->length = file_stats.st_size;
+#if defined(AWS_OS_APPLE)
+    file->modification_time_ns =
+        (uint64_t)file_stats.st_mtimespec.tv_sec * AWS_TIMESTAMP_NANOS + (uint64_t)file_stats.st_mtimespec.tv_nsec;
+#else
+    file->modification_time_ns =
+        (uint64_t)file_stats.st_mtim.tv_sec * AWS_TIMESTAMP_NANOS + (uint64_t)file_stats.st_mtim.tv_nsec;
+#endif
+    file->os_handle = fd;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_positional_file_read(const struct aws_positional_file *file, uint64_t offset, struct aws_byte_buf *dest) {
+    if (offset > INT64_MAX) {
+        return aws_raise_error(AWS_ERROR_OVERFLOW_DETECTED);
+    }
+
+    size_t max_read = dest->capacity - dest->len;
+    ssize_t actually_read = 0;
+    do {
+        actually_read = pread((int)file->os_handle, dest->buffer + dest->len, max_read, (off_t)offset);
+    } while (actually_read == -1 && errno == EINTR);
+
+    if (actually_read == -1) {
+        return aws_translate_and_raise_io_error(errno);
+    }
+
+    dest->len += (size_t)actually_read;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_positional_file_close(struct aws_positional_file *file) {
+    close((int)file->os_handle);
+
+    AWS_ZERO_STRUCT(*file);
+}
@@ -6,11 +6,13 @@
 #include <aws/io/host_resolver.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/dns_message.h>
 
 #include <aws/common/string.h>
 
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <stdio.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -116,3 +118,53 @@ clean_up:
 
     return AWS_OP_ERR;
 }
+
+static bool s_is_resolv_conf_space(uint8_t value) {
+    return value == ' ' || value == '\t' || value == '\r' || value == '\n';
+}
+
+int aws_dns_load_system_nameservers(struct aws_array_list *out_nameservers) {
+    size_t starting_count = aws_array_list_length(out_nameservers);
+
+    FILE *resolv_conf = fopen("/etc/resolv.conf", "r");
+    if (resolv_conf) {
+        char line[256];
+        while (fgets(line, sizeof(line), resolv_conf)) {
+            struct aws_byte_cursor line_cur = aws_byte_cursor_from_c_str(line);
+            line_cur = aws_byte_cursor_trim_pred(&line_cur, s_is_resolv_conf_space);
+
+            struct aws_byte_cursor keyword = aws_byte_cursor_from_c_str("nameserver");
+            if (!aws_byte_cursor_starts_with(&line_cur, &keyword)) {
+                continue;
+            }
+
+            aws_byte_cursor_advance(&line_cur, keyword.len);
+            struct aws_byte_cursor address = aws_byte_cursor_trim_pred(&line_cur, s_is_resolv_conf_space);
+            /* skip link-local addresses with a zone id, we have no way to connect to those. */
+            if (address.len == 0 || address.len >= AWS_ADDRESS_MAX_LEN || memchr(address.ptr, '%', address.len)) {
+                continue;
+            }
+
+            struct aws_socket_endpoint nameserver;
+            AWS_ZERO_STRUCT(nameserver);
+            memcpy(nameserver.address, address.ptr, address.len);
+            nameserver.port = 53;
+            if (aws_array_list_push_back(out_nameservers, &nameserver)) {
+                fclose(resolv_conf);
+                return AWS_OP_ERR;
+            }
+        }
+
+        fclose(resolv_conf);
+    } else {
+        AWS_LOGF_WARN(AWS_LS_IO_DNS, "static: unable to open /etc/resolv.conf, falling back to a local nameserver.");
+    }
+
+    /* same fallback as the libc resolver: with nothing configured, ask whatever is listening locally. */
+    if (aws_array_list_length(out_nameservers) == starting_count) {
+        struct aws_socket_endpoint nameserver = {.address = "127.0.0.1", .port = 53};
+        return aws_array_list_push_back(out_nameservers, &nameserver);
+    }
+
+    return AWS_OP_SUCCESS;
+}
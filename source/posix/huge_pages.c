@@ -0,0 +1,48 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/huge_pages.h>
+
+#include <errno.h>
+#include <sys/mman.h>
+
+int aws_huge_page_slab_init(struct aws_huge_page_slab *slab, size_t size) {
+    AWS_ZERO_STRUCT(*slab);
+
+    if (size == 0 || size > SIZE_MAX - AWS_HUGE_PAGE_SIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+    size_t length = (size + AWS_HUGE_PAGE_SIZE - 1) / AWS_HUGE_PAGE_SIZE * AWS_HUGE_PAGE_SIZE;
+
+    void *address = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    /* only succeeds if the system has reserved huge pages to spare (vm.nr_hugepages) */
+    address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    slab->is_reserved = address != MAP_FAILED;
+#endif
+
+    if (address == MAP_FAILED) {
+        address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+#ifdef MADV_HUGEPAGE
+        /* a hint, where transparent huge pages are off this changes nothing */
+        madvise(address, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    slab->address = address;
+    slab->length = length;
+    return AWS_OP_SUCCESS;
+}
+
+void aws_huge_page_slab_clean_up(struct aws_huge_page_slab *slab) {
+    if (slab->address) {
+        munmap(slab->address, slab->length);
+    }
+
+    AWS_ZERO_STRUCT(*slab);
+}
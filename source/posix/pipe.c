@@ -6,6 +6,9 @@
 #include <aws/io/pipe.h>
 
 #include <aws/io/event_loop.h>
+#include <aws/io/socket.h>
+
+#include <aws/common/math.h>
 
 #ifdef __GLIBC__
 #    define __USE_GNU
@@ -20,8 +23,17 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+/* a pipe's buffer is 64KiB by default, so there's little point gathering more requests than this per writev() */
+#if defined(IOV_MAX) && IOV_MAX < 64
+#    define MAX_IOVECS IOV_MAX
+#else
+#    define MAX_IOVECS 64
+#endif
+
 /* This isn't defined on ancient linux distros (breaking the builds).
  * However, if this is a prebuild, we purposely build on an ancient system, but
  * we want the kernel calls to still be the same as a modern build since that's likely the target of the application
@@ -292,6 +304,60 @@ int aws_pipe_read(struct aws_pipe_read_end *read_end, struct aws_byte_buf *dst_b
     return AWS_OP_SUCCESS;
 }
 
+int aws_pipe_splice_to_socket(
+    struct aws_pipe_read_end *read_end,
+    struct aws_socket *socket,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+
+    AWS_ASSERT(socket);
+
+    struct read_end_impl *read_impl = read_end->impl_data;
+    if (!read_impl) {
+        return aws_raise_error(AWS_IO_BROKEN_PIPE);
+    }
+
+    if (num_bytes_spliced) {
+        *num_bytes_spliced = 0;
+    }
+
+    if (!aws_event_loop_thread_is_callers_thread(read_impl->event_loop) ||
+        !aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!aws_socket_is_open(socket)) {
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+#if defined(__linux__) && defined(SPLICE_F_MOVE)
+    /* the pages move from the pipe's buffer to the socket's, without passing through userspace */
+    ssize_t splice_val = splice(
+        read_impl->handle.data.fd,
+        NULL,
+        socket->io_handle.data.fd,
+        NULL,
+        max_bytes,
+        SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+    if (splice_val < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+        }
+        return s_raise_posix_error(errno);
+    }
+
+    if (num_bytes_spliced) {
+        *num_bytes_spliced = (size_t)splice_val;
+    }
+
+    return AWS_OP_SUCCESS;
+#else
+    (void)max_bytes;
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+}
+
 static void s_read_end_on_event(
     struct aws_event_loop *event_loop,
     struct aws_io_handle *handle,
@@ -439,6 +505,8 @@ static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
     struct write_end_impl *write_impl = write_end->impl_data;
     AWS_ASSERT(write_impl);
 
+    struct iovec iovecs[MAX_IOVECS];
+
     while (!aws_linked_list_empty(&write_impl->write_list)) {
         struct aws_linked_list_node *node = aws_linked_list_front(&write_impl->write_list);
         struct write_request *request = AWS_CONTAINER_OF(node, struct write_request, list_node);
@@ -446,7 +514,18 @@ static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
         int completed_error_code = AWS_ERROR_SUCCESS;
 
         if (request->cursor.len > 0) {
-            ssize_t write_val = write(write_impl->handle.data.fd, request->cursor.ptr, request->cursor.len);
+            /* gather the front request and as many queued behind it as fit, so they go out in one system call */
+            int iovec_count = 0;
+            for (struct aws_linked_list_node *iter = node;
+                 iter != aws_linked_list_end(&write_impl->write_list) && iovec_count < MAX_IOVECS;
+                 iter = aws_linked_list_next(iter)) {
+                struct write_request *queued_request = AWS_CONTAINER_OF(iter, struct write_request, list_node);
+                iovecs[iovec_count].iov_base = queued_request->cursor.ptr;
+                iovecs[iovec_count].iov_len = queued_request->cursor.len;
+                ++iovec_count;
+            }
+
+            ssize_t write_val = writev(write_impl->handle.data.fd, iovecs, iovec_count);
 
             if (write_val < 0) {
                 if (errno == EAGAIN || errno == EWOULDBLOCK) {
@@ -459,7 +538,16 @@ static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
                 completed_error_code = s_translate_posix_error(errno);
 
             } else {
-                aws_byte_cursor_advance(&request->cursor, write_val);
+                /* the bytes went out in queue order, hand them out the same way */
+                size_t remaining = (size_t)write_val;
+                for (struct aws_linked_list_node *iter = node;
+                     iter != aws_linked_list_end(&write_impl->write_list) && remaining > 0;
+                     iter = aws_linked_list_next(iter)) {
+                    struct write_request *queued_request = AWS_CONTAINER_OF(iter, struct write_request, list_node);
+                    size_t written = aws_min_size(remaining, queued_request->cursor.len);
+                    aws_byte_cursor_advance(&queued_request->cursor, written);
+                    remaining -= written;
+                }
 
                 if (request->cursor.len > 0) {
                     /* There was a partial write, loop again to try and write the rest. */
@@ -468,7 +556,8 @@ static void s_write_end_process_requests(struct aws_pipe_write_end *write_end) {
             }
         }
 
-        /* If we got this far in the loop, then the write request is complete.
+        /* If we got this far in the loop, then the write request is complete. Requests behind it that the same
+         * writev() finished complete on the following iterations.
          * Note that the callback may result in the pipe being cleaned up. */
         bool write_end_cleaned_up = s_write_end_complete_front_write_request(write_end, completed_error_code);
         if (write_end_cleaned_up) {
@@ -3,25 +3,51 @@
  * SPDX-License-Identifier: Apache-2.0.
  */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* for accept4() */
+#    define _GNU_SOURCE
+#endif
+
 #include <aws/io/socket.h>
 
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/math.h>
 #include <aws/common/mutex.h>
 #include <aws/common/string.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/hot_path_logging.h>
+#include <aws/io/statistics.h>
 
 #include <arpa/inet.h>
 #include <aws/io/io.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <netinet/tcp.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#    include <linux/errqueue.h>
+#    include <netinet/udp.h>
+#    include <sys/sendfile.h>
+#    define HAS_SENDFILE
+#    define HAS_MMSG
+#    define HAS_UDP_OFFLOAD
+#    if defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+#        define HAS_ACCEPT4
+#    endif
+#    if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#        define HAS_ZEROCOPY
+#    endif
+#endif
+
 #if defined(__MACH__)
 #    define NO_SIGNAL SO_NOSIGPIPE
 #    define TCP_KEEPIDLE TCP_KEEPALIVE
@@ -29,6 +55,25 @@
 #    define NO_SIGNAL MSG_NOSIGNAL
 #endif
 
+/* Most buffers gathered into a single sendmsg() or readv() call. Bounded to keep the iovec array a modest size. */
+#if defined(IOV_MAX) && IOV_MAX < 1024
+#    define MAX_IOVECS IOV_MAX
+#else
+#    define MAX_IOVECS 1024
+#endif
+
+/* Most MSG_ZEROCOPY sends waiting on the kernel at once. Also the width of the out of order release mask. */
+#define MAX_ZEROCOPY_SENDS_IN_FLIGHT 64
+
+/* Bounce buffer for file writes on platforms without sendfile(). */
+#define FILE_WRITE_CHUNK_SIZE (16 * 1024)
+
+/* Connections accepted per readable event when the socket options don't say otherwise. */
+#define DEFAULT_MAX_ACCEPTS_PER_EVENT 128
+
+/* Most datagrams moved by a single sendmmsg() or recvmmsg() call. Bigger batches just loop. */
+#define MAX_DATAGRAMS_PER_CALL 32
+
 /* This isn't defined on ancient linux distros (breaking the builds).
  * However, if this is a prebuild, we purposely build on an ancient system, but
  * we want the kernel calls to still be the same as a modern build since that's likely the target of the application
@@ -39,6 +84,16 @@
 #    define O_CLOEXEC 02000000
 #endif
 
+/* Same for the UDP segmentation offload options (Linux 4.18 and 5.0); the running kernel decides whether they work. */
+#if defined(HAS_UDP_OFFLOAD)
+#    ifndef UDP_SEGMENT
+#        define UDP_SEGMENT 103
+#    endif
+#    ifndef UDP_GRO
+#        define UDP_GRO 104
+#    endif
+#endif
+
 #ifdef USE_VSOCK
 #    if defined(__linux__) && defined(AF_VSOCK)
 #        include <linux/vm_sockets.h>
@@ -152,20 +207,52 @@ static int s_create_socket(struct aws_socket *sock, const struct aws_socket_opti
     return aws_raise_error(aws_error);
 }
 
+/*
+ * Connects started from the event loop's own thread use the args embedded in their posix_socket: allocator is NULL,
+ * and event_loop is set because their task went straight into the loop's scheduler, so it is cancelled the moment the
+ * connect is decided rather than left to run out. Other connects can't cancel a task that may still be on its way to
+ * the loop, so their args are allocated to outlive the socket and freed by the task.
+ */
 struct posix_socket_connect_args {
     struct aws_task task;
     struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
     struct aws_socket *socket;
 };
 
+enum zerocopy_state {
+    ZEROCOPY_UNTRIED = 0,
+    ZEROCOPY_ENABLED,
+    ZEROCOPY_DISABLED,
+};
+
 struct posix_socket {
     struct aws_linked_list write_queue;
+    /* Requests that are fully sent but whose buffers the kernel may still be sending from (MSG_ZEROCOPY), plus any
+     * requests queued behind them, so completion callbacks still fire in order. */
+    struct aws_linked_list zerocopy_pending_queue;
+    /* id the kernel gives the next MSG_ZEROCOPY send. */
+    uint32_t zerocopy_next_seq;
+    /* every MSG_ZEROCOPY send before this id has been released by the kernel. */
+    uint32_t zerocopy_released_seq;
+    /* releases that arrived out of order, bit n stands for zerocopy_released_seq + n. */
+    uint64_t zerocopy_released_mask;
+    enum zerocopy_state zerocopy_state;
     struct posix_socket_connect_args *connect_args;
+    struct posix_socket_connect_args local_connect_args;
+    /* high res clock time of the connect() call, for AWS_IO_LATENCY_SOCKET_CONNECT */
+    uint64_t connect_start_ns;
     bool write_in_progress;
+    /* set by aws_socket_cork_writes(), writes only queue until it's cleared. */
+    bool writes_corked;
     bool currently_subscribed;
     bool continue_accept;
+    /* picks up the connections left queued once a readable event has accepted max_accepts_per_event of them. */
+    struct aws_task accept_task;
+    bool accept_task_scheduled;
     bool currently_in_event;
     bool clean_yourself_up;
+    bool trace_logging_enabled;
     bool *close_happened;
 };
 
@@ -204,13 +291,16 @@ static int s_socket_init(
     }
 
     aws_linked_list_init(&posix_socket->write_queue);
+    aws_linked_list_init(&posix_socket->zerocopy_pending_queue);
     posix_socket->write_in_progress = false;
+    posix_socket->writes_corked = false;
     posix_socket->currently_subscribed = false;
     posix_socket->continue_accept = false;
     posix_socket->currently_in_event = false;
     posix_socket->clean_yourself_up = false;
     posix_socket->connect_args = NULL;
     posix_socket->close_happened = NULL;
+    posix_socket->trace_logging_enabled = aws_io_hot_path_trace_enabled(AWS_LS_IO_SOCKET);
     socket->impl = posix_socket;
     return AWS_OP_SUCCESS;
 }
@@ -220,6 +310,73 @@ int aws_socket_init(struct aws_socket *socket, struct aws_allocator *alloc, cons
     return s_socket_init(socket, alloc, options, -1);
 }
 
+static void s_endpoint_from_address(const struct sockaddr_storage *address, struct aws_socket_endpoint *endpoint) {
+    if (address->ss_family == AF_INET) {
+        const struct sockaddr_in *s = (const struct sockaddr_in *)address;
+        endpoint->port = ntohs(s->sin_port);
+        inet_ntop(AF_INET, &s->sin_addr, endpoint->address, sizeof(endpoint->address));
+    } else if (address->ss_family == AF_INET6) {
+        const struct sockaddr_in6 *s = (const struct sockaddr_in6 *)address;
+        endpoint->port = ntohs(s->sin6_port);
+        inet_ntop(AF_INET6, &s->sin6_addr, endpoint->address, sizeof(endpoint->address));
+    } else if (address->ss_family == AF_UNIX) {
+        const struct sockaddr_un *s = (const struct sockaddr_un *)address;
+        size_t path_len = strnlen(s->sun_path, sizeof(s->sun_path));
+        path_len = aws_min_size(path_len, sizeof(endpoint->address) - 1);
+        memcpy(endpoint->address, s->sun_path, path_len);
+        endpoint->address[path_len] = '\0';
+    }
+}
+
+int aws_socket_init_from_handle(
+    struct aws_socket *socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    const struct aws_io_handle *handle) {
+    AWS_ASSERT(options);
+    AWS_ASSERT(handle);
+
+    int fd = handle->data.fd;
+    if (fd < 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* however it arrived, the loop needs it non-blocking */
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return aws_raise_error(s_determine_socket_error(errno));
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    if (s_socket_init(socket, alloc, options, fd)) {
+        return AWS_OP_ERR;
+    }
+
+    struct sockaddr_storage address;
+    AWS_ZERO_STRUCT(address);
+    socklen_t address_size = sizeof(address);
+    if (!getsockname(fd, (struct sockaddr *)&address, &address_size)) {
+        s_endpoint_from_address(&address, &socket->local_endpoint);
+    }
+
+    AWS_ZERO_STRUCT(address);
+    address_size = sizeof(address);
+    if (!getpeername(fd, (struct sockaddr *)&address, &address_size)) {
+        s_endpoint_from_address(&address, &socket->remote_endpoint);
+    }
+
+    socket->state = CONNECTED_READ | CONNECTED_WRITE;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: adopted connection to %s:%u",
+        (void *)socket,
+        fd,
+        socket->remote_endpoint.address,
+        (unsigned)socket->remote_endpoint.port);
+    return AWS_OP_SUCCESS;
+}
+
 void aws_socket_clean_up(struct aws_socket *socket) {
     if (!socket->impl) {
         /* protect from double clean */
@@ -292,6 +449,13 @@ static int s_on_connection_success(struct aws_socket *socket) {
 
     AWS_LOGF_INFO(AWS_LS_IO_SOCKET, "id=%p fd=%d: connection success", (void *)socket, socket->io_handle.data.fd);
 
+    uint64_t connected_ns = 0;
+    if (socket_impl->connect_start_ns && !aws_high_res_clock_get_ticks(&connected_ns) &&
+        connected_ns >= socket_impl->connect_start_ns) {
+        aws_latency_histogram_record_ns(
+            aws_io_get_latency_histogram(AWS_IO_LATENCY_SOCKET_CONNECT), connected_ns - socket_impl->connect_start_ns);
+    }
+
     struct sockaddr_storage address;
     AWS_ZERO_STRUCT(address);
     socklen_t address_size = sizeof(address);
@@ -385,10 +549,26 @@ static void s_on_connection_error(struct aws_socket *socket, int error) {
     }
 }
 
+/* call once socket_args->socket is NULL, so the task sees the connect is decided and does nothing. */
+static void s_cancel_local_connect_task(struct posix_socket_connect_args *socket_args) {
+    if (socket_args->event_loop) {
+        struct aws_event_loop *event_loop = socket_args->event_loop;
+        socket_args->event_loop = NULL;
+        aws_event_loop_cancel_task(event_loop, &socket_args->task);
+    }
+}
+
+static void s_release_connect_args(struct posix_socket_connect_args *socket_args) {
+    if (socket_args->allocator) {
+        aws_mem_release(socket_args->allocator, socket_args);
+    }
+}
+
 /* the next two callbacks compete based on which one runs first. if s_socket_connect_event
  * comes back first, then we set socket_args->socket = NULL and continue on with the connection.
  * if s_handle_socket_timeout() runs first, is sees socket_args->socket is NULL and just cleans up its memory.
- * s_handle_socket_timeout() will always run so the memory for socket_connect_args is always cleaned up there. */
+ * s_handle_socket_timeout() runs, or is cancelled, either way, so allocated socket_connect_args are always cleaned up
+ * there. */
 static void s_socket_connect_event(
     struct aws_event_loop *event_loop,
     struct aws_io_handle *handle,
@@ -414,6 +594,7 @@ static void s_socket_connect_event(
             struct aws_socket *socket = socket_args->socket;
             socket_args->socket = NULL;
             socket_impl->connect_args = NULL;
+            s_cancel_local_connect_task(socket_args);
             s_on_connection_success(socket);
             return;
         }
@@ -432,6 +613,7 @@ static void s_socket_connect_event(
         struct aws_socket *socket = socket_args->socket;
         socket_args->socket = NULL;
         socket_impl->connect_args = NULL;
+        s_cancel_local_connect_task(socket_args);
         aws_raise_error(aws_error);
         s_on_connection_error(socket, aws_error);
     }
@@ -466,13 +648,15 @@ static void s_handle_socket_timeout(struct aws_task *task, void *args, aws_task_
         socket_impl->currently_subscribed = false;
         aws_raise_error(error_code);
         struct aws_socket *socket = socket_args->socket;
-        /*socket close sets socket_args->socket to NULL and
-         * socket_impl->connect_args to NULL. */
+        /* this task is running, so there's nothing left for socket close to cancel. */
+        socket_args->socket = NULL;
+        socket_args->event_loop = NULL;
+        socket_impl->connect_args = NULL;
         aws_socket_close(socket);
         s_on_connection_error(socket, error_code);
     }
 
-    aws_mem_release(socket_args->allocator, socket_args);
+    s_release_connect_args(socket_args);
 }
 
 /* this is used simply for moving a connect_success callback when the connect finished immediately
@@ -483,18 +667,21 @@ static void s_run_connect_success(struct aws_task *task, void *arg, enum aws_tas
     struct posix_socket_connect_args *socket_args = arg;
 
     if (socket_args->socket) {
-        struct posix_socket *socket_impl = socket_args->socket->impl;
+        struct aws_socket *socket = socket_args->socket;
+        struct posix_socket *socket_impl = socket->impl;
+        socket_args->socket = NULL;
+        socket_args->event_loop = NULL;
+        socket_impl->connect_args = NULL;
         if (status == AWS_TASK_STATUS_RUN_READY) {
-            s_on_connection_success(socket_args->socket);
+            s_on_connection_success(socket);
         } else {
             aws_raise_error(AWS_IO_SOCKET_CONNECT_ABORTED);
-            socket_args->socket->event_loop = NULL;
-            s_on_connection_error(socket_args->socket, AWS_IO_SOCKET_CONNECT_ABORTED);
+            socket->event_loop = NULL;
+            s_on_connection_error(socket, AWS_IO_SOCKET_CONNECT_ABORTED);
         }
-        socket_impl->connect_args = NULL;
     }
 
-    aws_mem_release(socket_args->allocator, socket_args);
+    s_release_connect_args(socket_args);
 }
 
 static inline int s_convert_pton_error(int pton_code) {
@@ -550,6 +737,28 @@ static int parse_cid(const char *cid_str, unsigned int *value) {
 }
 #endif
 
+/* the first write carries the SYN, connect() only succeeds right away once there's a cookie for the server. */
+static void s_enable_tcp_fast_open_connect(struct aws_socket *socket) {
+#ifdef TCP_FASTOPEN_CONNECT
+    int fast_open = 1;
+    if (AWS_UNLIKELY(setsockopt(
+            socket->io_handle.data.fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, &fast_open, sizeof(fast_open)))) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: setsockopt() for TCP_FASTOPEN_CONNECT failed with errno %d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            errno);
+    }
+#else
+    AWS_LOGF_WARN(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: TCP_FASTOPEN_CONNECT is not supported on this platform, ignoring tcp_fast_open.",
+        (void *)socket,
+        socket->io_handle.data.fd);
+#endif
+}
+
 int aws_socket_connect(
     struct aws_socket *socket,
     const struct aws_socket_endpoint *remote_endpoint,
@@ -638,17 +847,29 @@ int aws_socket_connect(
 
     struct posix_socket *socket_impl = socket->impl;
 
-    socket_impl->connect_args = aws_mem_calloc(socket->allocator, 1, sizeof(struct posix_socket_connect_args));
-    if (!socket_impl->connect_args) {
-        return AWS_OP_ERR;
+    if (aws_event_loop_thread_is_callers_thread(event_loop)) {
+        AWS_ZERO_STRUCT(socket_impl->local_connect_args);
+        socket_impl->connect_args = &socket_impl->local_connect_args;
+        socket_impl->connect_args->event_loop = event_loop;
+    } else {
+        socket_impl->connect_args = aws_mem_calloc(socket->allocator, 1, sizeof(struct posix_socket_connect_args));
+        if (!socket_impl->connect_args) {
+            return AWS_OP_ERR;
+        }
+        socket_impl->connect_args->allocator = socket->allocator;
     }
 
     socket_impl->connect_args->socket = socket;
-    socket_impl->connect_args->allocator = socket->allocator;
 
     socket_impl->connect_args->task.fn = s_handle_socket_timeout;
     socket_impl->connect_args->task.arg = socket_impl->connect_args;
 
+    if (socket->options.tcp_fast_open && socket->options.type == AWS_SOCKET_STREAM &&
+        socket->options.domain != AWS_SOCKET_LOCAL) {
+        s_enable_tcp_fast_open_connect(socket);
+    }
+
+    aws_high_res_clock_get_ticks(&socket_impl->connect_start_ns);
     int error_code = connect(socket->io_handle.data.fd, (struct sockaddr *)&address.sock_addr_types, sock_size);
     socket->event_loop = event_loop;
 
@@ -725,7 +946,8 @@ int aws_socket_connect(
     return AWS_OP_SUCCESS;
 
 err_clean_up:
-    aws_mem_release(socket->allocator, socket_impl->connect_args);
+    /* nothing was scheduled, so there's no task to cancel. */
+    s_release_connect_args(socket_impl->connect_args);
     socket_impl->connect_args = NULL;
     return AWS_OP_ERR;
 }
@@ -824,6 +1046,8 @@ int aws_socket_bind(struct aws_socket *socket, const struct aws_socket_endpoint
     return aws_raise_error(aws_error);
 }
 
+static void s_set_listener_tcp_options(struct aws_socket *socket, int backlog_size);
+
 int aws_socket_listen(struct aws_socket *socket, int backlog_size) {
     if (socket->state != BOUND) {
         AWS_LOGF_ERROR(
@@ -834,6 +1058,10 @@ int aws_socket_listen(struct aws_socket *socket, int backlog_size) {
         return aws_raise_error(AWS_IO_SOCKET_ILLEGAL_OPERATION_FOR_STATE);
     }
 
+    if (socket->options.type == AWS_SOCKET_STREAM && socket->options.domain != AWS_SOCKET_LOCAL) {
+        s_set_listener_tcp_options(socket, backlog_size);
+    }
+
     int error_code = listen(socket->io_handle.data.fd, backlog_size);
 
     if (!error_code) {
@@ -855,129 +1083,222 @@ int aws_socket_listen(struct aws_socket *socket, int backlog_size) {
     return aws_raise_error(s_determine_socket_error(error_code));
 }
 
-/* this is called by the event loop handler that was installed in start_accept(). It runs once the FD goes readable,
- * accepts as many as it can and then returns control to the event loop. */
-static void s_socket_accept_event(
-    struct aws_event_loop *event_loop,
-    struct aws_io_handle *handle,
-    int events,
-    void *user_data) {
+/* TCP Fast Open and TCP_DEFER_ACCEPT only mean anything on the listening socket, and must be set before listen(). */
+static void s_set_listener_tcp_options(struct aws_socket *socket, int backlog_size) {
+    if (socket->options.tcp_fast_open) {
+#ifdef TCP_FASTOPEN
+        /* the queue of connections whose SYN data has been accepted ahead of the handshake */
+        int queue_length = backlog_size > 0 ? backlog_size : SOMAXCONN;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, IPPROTO_TCP, TCP_FASTOPEN, &queue_length, sizeof(queue_length)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for TCP_FASTOPEN failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: TCP_FASTOPEN is not supported on this platform, ignoring tcp_fast_open.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+#endif
+    }
 
-    (void)event_loop;
+    if (socket->options.tcp_defer_accept_sec) {
+#ifdef TCP_DEFER_ACCEPT
+        int defer_sec = socket->options.tcp_defer_accept_sec > INT_MAX ? INT_MAX
+                                                                       : (int)socket->options.tcp_defer_accept_sec;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_sec, sizeof(defer_sec)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for TCP_DEFER_ACCEPT failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: TCP_DEFER_ACCEPT is not supported on this platform, ignoring tcp_defer_accept_sec.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+#endif
+    }
+}
 
-    struct aws_socket *socket = user_data;
+/* this is called by the event loop handler that was installed in start_accept(). It runs once the FD goes readable,
+ * accepts as many as it can and then returns control to the event loop. */
+/* accepts whatever is queued on the listening socket, up to the socket's per event limit. */
+static void s_socket_accept_pending(struct aws_socket *socket) {
     struct posix_socket *socket_impl = socket->impl;
 
-    AWS_LOGF_DEBUG(
-        AWS_LS_IO_SOCKET, "id=%p fd=%d: listening event received", (void *)socket, socket->io_handle.data.fd);
+    size_t max_accepts =
+        socket->options.max_accepts_per_event ? socket->options.max_accepts_per_event : DEFAULT_MAX_ACCEPTS_PER_EVENT;
+    size_t accepted_count = 0;
 
-    if (socket_impl->continue_accept && events & AWS_IO_EVENT_TYPE_READABLE) {
-        int in_fd = 0;
-        while (socket_impl->continue_accept && in_fd != -1) {
-            struct sockaddr_storage in_addr;
-            socklen_t in_len = sizeof(struct sockaddr_storage);
+    int in_fd = 0;
+    while (socket_impl->continue_accept && in_fd != -1) {
+        if (accepted_count == max_accepts) {
+            /* the loop is edge triggered, nothing will wake us for what's still queued. Come back for it in a task
+             * so the loop gets to serve everyone else first. */
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: accepted %zu connections, deferring the rest",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                accepted_count);
+            socket_impl->accept_task_scheduled = true;
+            aws_event_loop_schedule_task_now(socket->event_loop, &socket_impl->accept_task);
+            return;
+        }
 
-            in_fd = accept(handle->data.fd, (struct sockaddr *)&in_addr, &in_len);
-            if (in_fd == -1) {
-                int error = errno;
+        struct sockaddr_storage in_addr;
+        socklen_t in_len = sizeof(struct sockaddr_storage);
 
-                if (error == EAGAIN || error == EWOULDBLOCK) {
-                    break;
-                }
+#if defined(HAS_ACCEPT4)
+        in_fd = accept4(
+            socket->io_handle.data.fd, (struct sockaddr *)&in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        in_fd = accept(socket->io_handle.data.fd, (struct sockaddr *)&in_addr, &in_len);
+#endif
+        if (in_fd == -1) {
+            int error = errno;
 
-                int aws_error = aws_socket_get_error(socket);
-                aws_raise_error(aws_error);
-                s_on_connection_error(socket, aws_error);
+            if (error == EAGAIN || error == EWOULDBLOCK) {
                 break;
             }
 
-            AWS_LOGF_DEBUG(
-                AWS_LS_IO_SOCKET, "id=%p fd=%d: incoming connection", (void *)socket, socket->io_handle.data.fd);
+            int aws_error = aws_socket_get_error(socket);
+            aws_raise_error(aws_error);
+            s_on_connection_error(socket, aws_error);
+            break;
+        }
+
+        ++accepted_count;
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: incoming connection", (void *)socket, socket->io_handle.data.fd);
 
-            struct aws_socket *new_sock = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
+        struct aws_socket *new_sock = aws_mem_acquire(socket->allocator, sizeof(struct aws_socket));
 
-            if (!new_sock) {
-                close(in_fd);
-                s_on_connection_error(socket, aws_last_error());
-                continue;
-            }
+        if (!new_sock) {
+            close(in_fd);
+            s_on_connection_error(socket, aws_last_error());
+            continue;
+        }
 
-            if (s_socket_init(new_sock, socket->allocator, &socket->options, in_fd)) {
-                aws_mem_release(socket->allocator, new_sock);
-                s_on_connection_error(socket, aws_last_error());
-                continue;
-            }
+        if (s_socket_init(new_sock, socket->allocator, &socket->options, in_fd)) {
+            aws_mem_release(socket->allocator, new_sock);
+            s_on_connection_error(socket, aws_last_error());
+            continue;
+        }
 
-            new_sock->local_endpoint = socket->local_endpoint;
-            new_sock->state = CONNECTED_READ | CONNECTED_WRITE;
-            uint16_t port = 0;
-
-            /* get the info on the incoming socket's address */
-            if (in_addr.ss_family == AF_INET) {
-                struct sockaddr_in *s = (struct sockaddr_in *)&in_addr;
-                port = ntohs(s->sin_port);
-                /* this came from the kernel, a.) it won't fail. b.) even if it does
-                 * its not fatal. come back and add logging later. */
-                if (!inet_ntop(
-                        AF_INET,
-                        &s->sin_addr,
-                        new_sock->remote_endpoint.address,
-                        sizeof(new_sock->remote_endpoint.address))) {
-                    AWS_LOGF_WARN(
-                        AWS_LS_IO_SOCKET,
-                        "id=%p fd=%d:. Failed to determine remote address.",
-                        (void *)socket,
-                        socket->io_handle.data.fd)
-                }
-                new_sock->options.domain = AWS_SOCKET_IPV4;
-            } else if (in_addr.ss_family == AF_INET6) {
-                /* this came from the kernel, a.) it won't fail. b.) even if it does
-                 * its not fatal. come back and add logging later. */
-                struct sockaddr_in6 *s = (struct sockaddr_in6 *)&in_addr;
-                port = ntohs(s->sin6_port);
-                if (!inet_ntop(
-                        AF_INET6,
-                        &s->sin6_addr,
-                        new_sock->remote_endpoint.address,
-                        sizeof(new_sock->remote_endpoint.address))) {
-                    AWS_LOGF_WARN(
-                        AWS_LS_IO_SOCKET,
-                        "id=%p fd=%d:. Failed to determine remote address.",
-                        (void *)socket,
-                        socket->io_handle.data.fd)
-                }
-                new_sock->options.domain = AWS_SOCKET_IPV6;
-            } else if (in_addr.ss_family == AF_UNIX) {
-                new_sock->remote_endpoint = socket->local_endpoint;
-                new_sock->options.domain = AWS_SOCKET_LOCAL;
+        new_sock->local_endpoint = socket->local_endpoint;
+        new_sock->state = CONNECTED_READ | CONNECTED_WRITE;
+        uint16_t port = 0;
+
+        /* get the info on the incoming socket's address */
+        if (in_addr.ss_family == AF_INET) {
+            struct sockaddr_in *s = (struct sockaddr_in *)&in_addr;
+            port = ntohs(s->sin_port);
+            /* this came from the kernel, a.) it won't fail. b.) even if it does
+             * its not fatal. come back and add logging later. */
+            if (!inet_ntop(
+                    AF_INET,
+                    &s->sin_addr,
+                    new_sock->remote_endpoint.address,
+                    sizeof(new_sock->remote_endpoint.address))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d:. Failed to determine remote address.",
+                    (void *)socket,
+                    socket->io_handle.data.fd)
+            }
+            new_sock->options.domain = AWS_SOCKET_IPV4;
+        } else if (in_addr.ss_family == AF_INET6) {
+            /* this came from the kernel, a.) it won't fail. b.) even if it does
+             * its not fatal. come back and add logging later. */
+            struct sockaddr_in6 *s = (struct sockaddr_in6 *)&in_addr;
+            port = ntohs(s->sin6_port);
+            if (!inet_ntop(
+                    AF_INET6,
+                    &s->sin6_addr,
+                    new_sock->remote_endpoint.address,
+                    sizeof(new_sock->remote_endpoint.address))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d:. Failed to determine remote address.",
+                    (void *)socket,
+                    socket->io_handle.data.fd)
             }
+            new_sock->options.domain = AWS_SOCKET_IPV6;
+        } else if (in_addr.ss_family == AF_UNIX) {
+            new_sock->remote_endpoint = socket->local_endpoint;
+            new_sock->options.domain = AWS_SOCKET_LOCAL;
+        }
 
-            new_sock->remote_endpoint.port = port;
+        new_sock->remote_endpoint.port = port;
 
-            AWS_LOGF_INFO(
-                AWS_LS_IO_SOCKET,
-                "id=%p fd=%d: connected to %s:%d, incoming fd %d",
-                (void *)socket,
-                socket->io_handle.data.fd,
-                new_sock->remote_endpoint.address,
-                new_sock->remote_endpoint.port,
-                in_fd);
+        AWS_LOGF_INFO(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: connected to %s:%d, incoming fd %d",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            new_sock->remote_endpoint.address,
+            new_sock->remote_endpoint.port,
+            in_fd);
+
+#if !defined(HAS_ACCEPT4)
+        int flags = fcntl(in_fd, F_GETFL, 0);
+        fcntl(in_fd, F_SETFL, flags | O_NONBLOCK);
+        fcntl(in_fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+        bool close_occurred = false;
+        socket_impl->close_happened = &close_occurred;
+        socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, new_sock, socket->connect_accept_user_data);
+
+        if (close_occurred) {
+            return;
+        }
 
-            int flags = fcntl(in_fd, F_GETFL, 0);
+        socket_impl->close_happened = NULL;
+    }
+}
 
-            flags |= O_NONBLOCK | O_CLOEXEC;
-            fcntl(in_fd, F_SETFL, flags);
+static void s_socket_accept_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
 
-            bool close_occurred = false;
-            socket_impl->close_happened = &close_occurred;
-            socket->accept_result_fn(socket, AWS_ERROR_SUCCESS, new_sock, socket->connect_accept_user_data);
+    struct aws_socket *socket = arg;
+    struct posix_socket *socket_impl = socket->impl;
+    socket_impl->accept_task_scheduled = false;
 
-            if (close_occurred) {
-                return;
-            }
+    if (status == AWS_TASK_STATUS_RUN_READY && socket_impl->continue_accept) {
+        s_socket_accept_pending(socket);
+    }
+}
 
-            socket_impl->close_happened = NULL;
-        }
+static void s_socket_accept_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
+
+    (void)event_loop;
+    (void)handle;
+
+    struct aws_socket *socket = user_data;
+    struct posix_socket *socket_impl = socket->impl;
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET, "id=%p fd=%d: listening event received", (void *)socket, socket->io_handle.data.fd);
+
+    /* with the accept task pending, it will get to these connections anyway. */
+    if (socket_impl->continue_accept && !socket_impl->accept_task_scheduled && events & AWS_IO_EVENT_TYPE_READABLE) {
+        s_socket_accept_pending(socket);
     }
 
     AWS_LOGF_TRACE(
@@ -1019,6 +1340,7 @@ int aws_socket_start_accept(
     socket->connect_accept_user_data = user_data;
     socket->event_loop = accept_loop;
     struct posix_socket *socket_impl = socket->impl;
+    aws_task_init(&socket_impl->accept_task, s_socket_accept_task, socket, "socket_accept_deferred");
     socket_impl->continue_accept = true;
     socket_impl->currently_subscribed = true;
 
@@ -1117,6 +1439,10 @@ int aws_socket_stop_accept(struct aws_socket *socket) {
 
     int ret_val = AWS_OP_SUCCESS;
     struct posix_socket *socket_impl = socket->impl;
+    if (socket_impl->accept_task_scheduled) {
+        aws_event_loop_cancel_task(socket->event_loop, &socket_impl->accept_task);
+    }
+
     if (socket_impl->currently_subscribed) {
         ret_val = aws_event_loop_unsubscribe_from_io_events(socket->event_loop, &socket->io_handle);
         socket_impl->currently_subscribed = false;
@@ -1168,14 +1494,181 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
             errno);
     }
 
+    if (options->reuse_port && options->domain != AWS_SOCKET_LOCAL) {
+#ifdef SO_REUSEPORT
+        /* unlike the options above this one is load bearing: without it the next listener's bind would fail. */
+        if (setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(int))) {
+            int errno_value = errno;
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_REUSEPORT failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno_value);
+            return aws_raise_error(s_determine_socket_error(errno_value));
+        }
+#else
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: SO_REUSEPORT is not supported on this platform.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+    }
+
+    if (options->busy_poll_us && options->domain != AWS_SOCKET_LOCAL) {
+#ifdef SO_BUSY_POLL
+        int busy_poll_us = options->busy_poll_us > INT_MAX ? INT_MAX : (int)options->busy_poll_us;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us, sizeof(busy_poll_us)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_BUSY_POLL failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: SO_BUSY_POLL is not supported on this platform, ignoring busy_poll_us.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+#endif
+    }
+
+    if (options->udp_gro && options->type == AWS_SOCKET_DGRAM) {
+#ifdef HAS_UDP_OFFLOAD
+        int gro = 1;
+        if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, IPPROTO_UDP, UDP_GRO, &gro, sizeof(gro)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for UDP_GRO failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+#else
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: UDP_GRO is not supported on this platform, ignoring udp_gro.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+#endif
+    }
+
+    if (options->send_buffer_size) {
+        int send_buffer_size = options->send_buffer_size > INT_MAX ? INT_MAX : (int)options->send_buffer_size;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, SOL_SOCKET, SO_SNDBUF, &send_buffer_size, sizeof(send_buffer_size)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_SNDBUF failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+    }
+
+    if (options->recv_buffer_size) {
+        int recv_buffer_size = options->recv_buffer_size > INT_MAX ? INT_MAX : (int)options->recv_buffer_size;
+        if (AWS_UNLIKELY(setsockopt(
+                socket->io_handle.data.fd, SOL_SOCKET, SO_RCVBUF, &recv_buffer_size, sizeof(recv_buffer_size)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_RCVBUF failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+        }
+    }
+
     if (options->type == AWS_SOCKET_STREAM && options->domain != AWS_SOCKET_LOCAL) {
-        if (socket->options.keepalive) {
-            int keep_alive = 1;
+        if (socket->options.tcp_notsent_lowat) {
+#ifdef TCP_NOTSENT_LOWAT
+            int lowat = socket->options.tcp_notsent_lowat > INT_MAX ? INT_MAX : (int)socket->options.tcp_notsent_lowat;
             if (AWS_UNLIKELY(
-                    setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_KEEPALIVE, &keep_alive, sizeof(int)))) {
+                    setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &lowat, sizeof(lowat)))) {
                 AWS_LOGF_WARN(
                     AWS_LS_IO_SOCKET,
-                    "id=%p fd=%d: setsockopt() for enabling SO_KEEPALIVE failed with errno %d.",
+                    "id=%p fd=%d: setsockopt() for TCP_NOTSENT_LOWAT failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+#else
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: TCP_NOTSENT_LOWAT is not supported on this platform, ignoring tcp_notsent_lowat.",
+                (void *)socket,
+                socket->io_handle.data.fd);
+#endif
+        }
+
+        size_t congestion_control_len =
+            strnlen(socket->options.tcp_congestion_control, AWS_SOCKET_CONGESTION_CONTROL_NAME_MAX);
+        if (congestion_control_len == AWS_SOCKET_CONGESTION_CONTROL_NAME_MAX) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: tcp_congestion_control is not NUL terminated, ignoring it.",
+                (void *)socket,
+                socket->io_handle.data.fd);
+        } else if (congestion_control_len) {
+#ifdef TCP_CONGESTION
+            if (AWS_UNLIKELY(setsockopt(
+                    socket->io_handle.data.fd,
+                    IPPROTO_TCP,
+                    TCP_CONGESTION,
+                    socket->options.tcp_congestion_control,
+                    (socklen_t)congestion_control_len))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for setting TCP_CONGESTION to %s failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    socket->options.tcp_congestion_control,
+                    errno);
+            }
+#else
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: TCP_CONGESTION is not supported on this platform, ignoring tcp_congestion_control.",
+                (void *)socket,
+                socket->io_handle.data.fd);
+#endif
+        }
+
+        if (socket->options.tcp_nodelay) {
+            int no_delay = 1;
+            if (AWS_UNLIKELY(
+                    setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for enabling TCP_NODELAY failed with errno %d.",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    errno);
+            }
+        }
+
+#ifndef TCP_CORK
+        if (socket->options.tcp_cork) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: TCP_CORK is not supported on this platform, ignoring tcp_cork.",
+                (void *)socket,
+                socket->io_handle.data.fd);
+        }
+#endif
+
+        if (socket->options.keepalive) {
+            int keep_alive = 1;
+            if (AWS_UNLIKELY(
+                    setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_KEEPALIVE, &keep_alive, sizeof(int)))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: setsockopt() for enabling SO_KEEPALIVE failed with errno %d.",
                     (void *)socket,
                     socket->io_handle.data.fd,
                     errno);
@@ -1229,6 +1722,12 @@ struct write_request {
     void *write_user_data;
     struct aws_linked_list_node node;
     size_t original_buffer_len;
+    /* file writes send cursor_cpy.len more bytes from file_fd at file_offset, cursor_cpy.ptr is unused. */
+    bool is_file;
+    int file_fd;
+    uint64_t file_offset;
+    /* once fully sent, a request completes after every MSG_ZEROCOPY send before this id is released. */
+    uint32_t zerocopy_release_seq;
 };
 
 struct posix_socket_close_args {
@@ -1325,8 +1824,10 @@ int aws_socket_close(struct aws_socket *socket) {
     }
 
     if (socket_impl->connect_args) {
-        socket_impl->connect_args->socket = NULL;
+        struct posix_socket_connect_args *connect_args = socket_impl->connect_args;
+        connect_args->socket = NULL;
         socket_impl->connect_args = NULL;
+        s_cancel_local_connect_task(connect_args);
     }
 
     if (aws_socket_is_open(socket)) {
@@ -1344,6 +1845,17 @@ int aws_socket_close(struct aws_socket *socket) {
                 socket, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len, write_request->write_user_data);
             aws_mem_release(socket->allocator, write_request);
         }
+
+        /* these were handed to the kernel, but its notice that it's done reading their buffers will never arrive
+         * now, and it may still be sending from them. Don't claim they completed. */
+        while (!aws_linked_list_empty(&socket_impl->zerocopy_pending_queue)) {
+            struct aws_linked_list_node *node = aws_linked_list_pop_front(&socket_impl->zerocopy_pending_queue);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+            write_request->written_fn(
+                socket, AWS_IO_SOCKET_CLOSED, write_request->original_buffer_len, write_request->write_user_data);
+            aws_mem_release(socket->allocator, write_request);
+        }
     }
 
     return AWS_OP_SUCCESS;
@@ -1367,6 +1879,170 @@ int aws_socket_shutdown_dir(struct aws_socket *socket, enum aws_channel_directio
     return AWS_OP_SUCCESS;
 }
 
+/* Decides whether a send of `send_size` bytes should go out with MSG_ZEROCOPY. SO_ZEROCOPY is turned on the first
+ * time a send qualifies, and if the kernel refuses it the socket just keeps copying. */
+static bool s_use_zerocopy_for_send(struct aws_socket *socket, size_t send_size) {
+#if defined(HAS_ZEROCOPY)
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (!socket->options.zerocopy_write_threshold || send_size < socket->options.zerocopy_write_threshold ||
+        socket->options.type != AWS_SOCKET_STREAM ||
+        (socket->options.domain != AWS_SOCKET_IPV4 && socket->options.domain != AWS_SOCKET_IPV6)) {
+        return false;
+    }
+
+    if (socket_impl->zerocopy_next_seq - socket_impl->zerocopy_released_seq >= MAX_ZEROCOPY_SENDS_IN_FLIGHT) {
+        return false;
+    }
+
+    if (socket_impl->zerocopy_state == ZEROCOPY_UNTRIED) {
+        int enable = 1;
+        if (setsockopt(socket->io_handle.data.fd, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable))) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for SO_ZEROCOPY failed with errno %d, copying writes instead.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                errno);
+            socket_impl->zerocopy_state = ZEROCOPY_DISABLED;
+        } else {
+            socket_impl->zerocopy_state = ZEROCOPY_ENABLED;
+        }
+    }
+
+    return socket_impl->zerocopy_state == ZEROCOPY_ENABLED;
+#else
+    (void)socket;
+    (void)send_size;
+    return false;
+#endif
+}
+
+/* Runs the completion callback for a fully sent request, unless the kernel may still be sending from a zero copy
+ * buffer, in which case the request waits in zerocopy_pending_queue. */
+static void s_on_write_request_sent(struct aws_socket *socket, struct write_request *write_request) {
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (socket_impl->zerocopy_released_seq != socket_impl->zerocopy_next_seq ||
+        !aws_linked_list_empty(&socket_impl->zerocopy_pending_queue)) {
+        write_request->zerocopy_release_seq = socket_impl->zerocopy_next_seq;
+        aws_linked_list_push_back(&socket_impl->zerocopy_pending_queue, &write_request->node);
+        return;
+    }
+
+    write_request->written_fn(
+        socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
+    aws_mem_release(socket->allocator, write_request);
+}
+
+#if defined(HAS_ZEROCOPY)
+static void s_mark_zerocopy_released(struct posix_socket *socket_impl, uint32_t first_seq, uint32_t last_seq) {
+    for (uint32_t seq = first_seq;; ++seq) {
+        uint32_t offset = seq - socket_impl->zerocopy_released_seq;
+        if (offset < MAX_ZEROCOPY_SENDS_IN_FLIGHT) {
+            socket_impl->zerocopy_released_mask |= (uint64_t)1 << offset;
+        }
+
+        if (seq == last_seq) {
+            break;
+        }
+    }
+
+    while (socket_impl->zerocopy_released_mask & 1) {
+        socket_impl->zerocopy_released_mask >>= 1;
+        socket_impl->zerocopy_released_seq++;
+    }
+}
+#endif
+
+/* The kernel reports released zero copy buffers on the socket's error queue, which also raises the error event.
+ * Drains those notifications and completes any writes they free up. Returns true if zero copy sends were in flight,
+ * meaning the error event may have been nothing but notifications. */
+static bool s_process_zerocopy_notifications(struct aws_socket *socket) {
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (socket_impl->zerocopy_released_seq == socket_impl->zerocopy_next_seq) {
+        return false;
+    }
+
+#if defined(HAS_ZEROCOPY)
+    for (;;) {
+        union {
+            char buf[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+            struct cmsghdr align;
+        } control;
+
+        struct msghdr msg;
+        AWS_ZERO_STRUCT(msg);
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        if (recvmsg(socket->io_handle.data.fd, &msg, MSG_ERRQUEUE) < 0) {
+            break;
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+
+            struct sock_extended_err *extended_err = (struct sock_extended_err *)CMSG_DATA(cmsg);
+            if (extended_err->ee_errno != 0 || extended_err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            /* the kernel fell back to copying (loopback always does), so zero copy only adds overhead here. */
+            if (extended_err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED &&
+                socket_impl->zerocopy_state == ZEROCOPY_ENABLED) {
+                AWS_LOGF_DEBUG(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: kernel copied zero copy sends, switching back to copying writes.",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                socket_impl->zerocopy_state = ZEROCOPY_DISABLED;
+            }
+
+            s_mark_zerocopy_released(socket_impl, extended_err->ee_info, extended_err->ee_data);
+        }
+    }
+#endif
+
+    /* completion callbacks may close the socket, which empties the queue out from under us. */
+    while (!aws_linked_list_empty(&socket_impl->zerocopy_pending_queue)) {
+        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->zerocopy_pending_queue);
+        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+
+        if ((int32_t)(socket_impl->zerocopy_released_seq - write_request->zerocopy_release_seq) < 0) {
+            break;
+        }
+
+        aws_linked_list_remove(node);
+        write_request->written_fn(
+            socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
+        aws_mem_release(socket->allocator, write_request);
+    }
+
+    return true;
+}
+
+/* Sends the next chunk of a file write request, returning the bytes sent like send() does. */
+static ssize_t s_send_from_file(struct aws_socket *socket, struct write_request *write_request) {
+#if defined(HAS_SENDFILE)
+    off_t offset = (off_t)write_request->file_offset;
+    return sendfile(socket->io_handle.data.fd, write_request->file_fd, &offset, write_request->cursor_cpy.len);
+#else
+    uint8_t chunk[FILE_WRITE_CHUNK_SIZE];
+    size_t to_read = aws_min_size(sizeof(chunk), write_request->cursor_cpy.len);
+    ssize_t read_val = pread(write_request->file_fd, chunk, to_read, (off_t)write_request->file_offset);
+    if (read_val <= 0) {
+        return read_val;
+    }
+
+    return send(socket->io_handle.data.fd, chunk, (size_t)read_val, NO_SIGNAL);
+#endif
+}
+
 /* this gets called in two scenarios.
  * 1st scenario, someone called aws_socket_write() and we want to try writing now, so an error can be returned
  * immediately if something bad has happened to the socket. In this case, `parent_request` is set.
@@ -1375,8 +2051,12 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     struct posix_socket *socket_impl = socket->impl;
     struct aws_allocator *allocator = socket->allocator;
 
-    AWS_LOGF_TRACE(
-        AWS_LS_IO_SOCKET, "id=%p fd=%d: processing write requests.", (void *)socket, socket->io_handle.data.fd);
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_impl->trace_logging_enabled,
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: processing write requests.",
+        (void *)socket,
+        socket->io_handle.data.fd);
 
     /* there's a potential deadlock where we notify the user that we wrote some data, the user
      * says, "cool, now I can write more and then immediately calls aws_socket_write(). We need to make sure
@@ -1384,14 +2064,16 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     socket_impl->write_in_progress = true;
 
     if (parent_request) {
-        AWS_LOGF_TRACE(
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
             AWS_LS_IO_SOCKET,
             "id=%p fd=%d: processing write requests, called from aws_socket_write",
             (void *)socket,
             socket->io_handle.data.fd);
         socket_impl->currently_in_event = true;
     } else {
-        AWS_LOGF_TRACE(
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
             AWS_LS_IO_SOCKET,
             "id=%p fd=%d: processing write requests, invoked by the event-loop",
             (void *)socket,
@@ -1402,34 +2084,125 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
     int aws_error = AWS_OP_SUCCESS;
     bool parent_request_failed = false;
 
+    /* stream sockets gather as many queued requests as fit in one sendmsg() call. Datagram sockets must not, since
+     * each request is its own datagram. */
+    size_t max_batch = socket->options.type == AWS_SOCKET_STREAM ? MAX_IOVECS : 1;
+    struct iovec iovecs[MAX_IOVECS];
+    bool allow_zerocopy = true;
+
     /* if a close call happens in the middle, this queue will have been cleaned out from under us. */
     while (!aws_linked_list_empty(&socket_impl->write_queue)) {
-        struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
-        struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+        struct write_request *front_request =
+            AWS_CONTAINER_OF(aws_linked_list_front(&socket_impl->write_queue), struct write_request, node);
+
+        size_t batch_count = 0;
+        ssize_t written = 0;
+
+        if (front_request->is_file) {
+            /* file writes go out on their own, straight from the file. */
+            batch_count = 1;
+            written = s_send_from_file(socket, front_request);
+            aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+            if (socket->statistics) {
+                ++socket->statistics->write_syscalls;
+            }
 
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: dequeued write request of size %llu, remaining to write %llu",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (unsigned long long)write_request->original_buffer_len,
-            (unsigned long long)write_request->cursor_cpy.len);
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: file send written size %d",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (int)written);
+
+            if (written == 0 && front_request->cursor_cpy.len > 0) {
+                AWS_LOGF_ERROR(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: file ended with %llu bytes of the write left to send",
+                    (void *)socket,
+                    socket->io_handle.data.fd,
+                    (unsigned long long)front_request->cursor_cpy.len);
+                aws_error = AWS_IO_STREAM_READ_FAILED;
+                aws_raise_error(aws_error);
+                purge = true;
+                break;
+            }
+        } else {
+            size_t batch_size = 0;
+            for (struct aws_linked_list_node *node = aws_linked_list_begin(&socket_impl->write_queue);
+                 node != aws_linked_list_end(&socket_impl->write_queue) && batch_count < max_batch;
+                 node = aws_linked_list_next(node)) {
+                struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
+                if (write_request->is_file) {
+                    break;
+                }
 
-        ssize_t written =
-            send(socket->io_handle.data.fd, write_request->cursor_cpy.ptr, write_request->cursor_cpy.len, NO_SIGNAL);
+                iovecs[batch_count].iov_base = write_request->cursor_cpy.ptr;
+                iovecs[batch_count].iov_len = write_request->cursor_cpy.len;
+                batch_size += write_request->cursor_cpy.len;
+                batch_count++;
+            }
 
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: send written size %d",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (int)written);
+            bool zerocopy = allow_zerocopy && s_use_zerocopy_for_send(socket, batch_size);
+
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: gathered %zu write requests into one send, zero copy %d",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                batch_count,
+                (int)zerocopy);
+
+            struct msghdr msg;
+            AWS_ZERO_STRUCT(msg);
+            msg.msg_iov = iovecs;
+            msg.msg_iovlen = batch_count;
+
+            int send_flags = NO_SIGNAL;
+#if defined(HAS_ZEROCOPY)
+            if (zerocopy) {
+                send_flags |= MSG_ZEROCOPY;
+            }
+#endif
+            written = sendmsg(socket->io_handle.data.fd, &msg, send_flags);
+            aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+            if (socket->statistics) {
+                ++socket->statistics->write_syscalls;
+            }
+
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: send written size %d",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (int)written);
+
+            if (zerocopy) {
+                if (written >= 0) {
+                    socket_impl->zerocopy_next_seq++;
+                } else if (errno == ENOBUFS) {
+                    /* out of locked memory for pinned pages, copy for the rest of this pass instead */
+                    allow_zerocopy = false;
+                    continue;
+                }
+            }
+        }
 
         if (written < 0) {
             int error = errno;
             if (error == EAGAIN) {
-                AWS_LOGF_TRACE(
-                    AWS_LS_IO_SOCKET, "id=%p fd=%d: returned would block", (void *)socket, socket->io_handle.data.fd);
+                AWS_IO_HOT_PATH_LOGF_TRACE(
+                    socket_impl->trace_logging_enabled,
+                    AWS_LS_IO_SOCKET,
+                    "id=%p fd=%d: returned would block",
+                    (void *)socket,
+                    socket->io_handle.data.fd);
+                aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+                if (socket->statistics) {
+                    ++socket->statistics->write_would_block;
+                }
                 break;
             }
 
@@ -1457,24 +2230,55 @@ static int s_process_write_requests(struct aws_socket *socket, struct write_requ
             break;
         }
 
-        size_t remaining_to_write = write_request->cursor_cpy.len;
+        /* Map the bytes written back onto the requests, in order. Completion callbacks may close the socket (which
+         * empties the queue) or queue more writes behind the batch, so re-fetch the front each time and never look
+         * past the requests that were part of this send. */
+        size_t remaining_written = (size_t)written;
+        aws_io_metrics_add(AWS_IO_METRIC_BYTES_WRITTEN, (int64_t)written);
+        bool partial_write = false;
+        for (size_t i = 0; i < batch_count && !aws_linked_list_empty(&socket_impl->write_queue); ++i) {
+            struct aws_linked_list_node *node = aws_linked_list_front(&socket_impl->write_queue);
+            struct write_request *write_request = AWS_CONTAINER_OF(node, struct write_request, node);
 
-        aws_byte_cursor_advance(&write_request->cursor_cpy, (size_t)written);
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET,
-            "id=%p fd=%d: remaining write request to write %llu",
-            (void *)socket,
-            socket->io_handle.data.fd,
-            (unsigned long long)write_request->cursor_cpy.len);
+            size_t consumed = aws_min_size(remaining_written, write_request->cursor_cpy.len);
+            if (write_request->is_file) {
+                write_request->file_offset += consumed;
+                write_request->cursor_cpy.len -= consumed;
+            } else {
+                aws_byte_cursor_advance(&write_request->cursor_cpy, consumed);
+            }
+            remaining_written -= consumed;
 
-        if ((size_t)written == remaining_to_write) {
-            AWS_LOGF_TRACE(
-                AWS_LS_IO_SOCKET, "id=%p fd=%d: write request completed", (void *)socket, socket->io_handle.data.fd);
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: remaining write request to write %llu",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                (unsigned long long)write_request->cursor_cpy.len);
+
+            if (write_request->cursor_cpy.len > 0) {
+                partial_write = true;
+                break;
+            }
+
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: write request completed",
+                (void *)socket,
+                socket->io_handle.data.fd);
 
             aws_linked_list_remove(node);
-            write_request->written_fn(
-                socket, AWS_OP_SUCCESS, write_request->original_buffer_len, write_request->write_user_data);
-            aws_mem_release(allocator, write_request);
+            s_on_write_request_sent(socket, write_request);
+        }
+
+        /* the kernel took less than offered: its buffer is full, wait to be told the socket is writable again */
+        if (partial_write) {
+            if (socket->statistics) {
+                ++socket->statistics->partial_writes;
+            }
+            break;
         }
     }
 
@@ -1533,7 +2337,12 @@ static void s_on_socket_io_event(
 
     if (events & AWS_IO_EVENT_TYPE_REMOTE_HANG_UP || events & AWS_IO_EVENT_TYPE_CLOSED) {
         aws_raise_error(AWS_IO_SOCKET_CLOSED);
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: closed remotely", (void *)socket, socket->io_handle.data.fd);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: closed remotely",
+            (void *)socket,
+            socket->io_handle.data.fd);
         if (socket->readable_fn) {
             socket->readable_fn(socket, AWS_IO_SOCKET_CLOSED, socket->readable_user_data);
         }
@@ -1541,18 +2350,34 @@ static void s_on_socket_io_event(
     }
 
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_ERROR) {
+        bool zerocopy_in_flight = s_process_zerocopy_notifications(socket);
+        if (!socket_impl->currently_subscribed) {
+            goto end_check;
+        }
+
         int aws_error = aws_socket_get_error(socket);
-        aws_raise_error(aws_error);
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET, "id=%p fd=%d: error event occurred", (void *)socket, socket->io_handle.data.fd);
-        if (socket->readable_fn) {
-            socket->readable_fn(socket, aws_error, socket->readable_user_data);
+        if (aws_error || !zerocopy_in_flight) {
+            aws_raise_error(aws_error);
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_impl->trace_logging_enabled,
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: error event occurred",
+                (void *)socket,
+                socket->io_handle.data.fd);
+            if (socket->readable_fn) {
+                socket->readable_fn(socket, aws_error, socket->readable_user_data);
+            }
+            goto end_check;
         }
-        goto end_check;
     }
 
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_READABLE) {
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: is readable", (void *)socket, socket->io_handle.data.fd);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: is readable",
+            (void *)socket,
+            socket->io_handle.data.fd);
         if (socket->readable_fn) {
             socket->readable_fn(socket, AWS_OP_SUCCESS, socket->readable_user_data);
         }
@@ -1560,7 +2385,12 @@ static void s_on_socket_io_event(
     /* if socket closed in between these branches, the currently_subscribed will be false and socket_impl will not
      * have been cleaned up, so this next branch is safe. */
     if (socket_impl->currently_subscribed && events & AWS_IO_EVENT_TYPE_WRITABLE) {
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: is writable", (void *)socket, socket->io_handle.data.fd);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: is writable",
+            (void *)socket,
+            socket->io_handle.data.fd);
         s_process_write_requests(socket, NULL);
     }
 
@@ -1607,6 +2437,40 @@ int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_
     return aws_raise_error(AWS_IO_EVENT_LOOP_ALREADY_ASSIGNED);
 }
 
+int aws_socket_unassign_from_event_loop(struct aws_socket *socket) {
+    AWS_ASSERT(socket->event_loop && aws_event_loop_thread_is_callers_thread(socket->event_loop));
+    struct posix_socket *socket_impl = socket->impl;
+
+    if ((socket->state & LISTENING) || socket_impl->connect_args || socket_impl->write_in_progress ||
+        !aws_linked_list_empty(&socket_impl->write_queue) ||
+        !aws_linked_list_empty(&socket_impl->zerocopy_pending_queue)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: can't unassign from event loop %p while it's listening, connecting or writing",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: unassigning from event loop %p",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (void *)socket->event_loop);
+
+    if (socket_impl->currently_subscribed) {
+        if (aws_event_loop_unsubscribe_from_io_events(socket->event_loop, &socket->io_handle)) {
+            return AWS_OP_ERR;
+        }
+        socket_impl->currently_subscribed = false;
+    }
+
+    socket->event_loop = NULL;
+    return AWS_OP_SUCCESS;
+}
+
 struct aws_event_loop *aws_socket_get_event_loop(struct aws_socket *socket) {
     return socket->event_loop;
 }
@@ -1643,7 +2507,14 @@ int aws_socket_subscribe_to_readable_events(
     return AWS_OP_SUCCESS;
 }
 
-int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read) {
+/* Shared by the single and vectored read paths. `space` is the total capacity described by `iovecs`; it decides
+ * whether a zero read is reported as a closed socket. */
+static int s_socket_readv(
+    struct aws_socket *socket,
+    struct iovec *iovecs,
+    int iovec_count,
+    size_t space,
+    size_t *amount_read) {
     AWS_ASSERT(amount_read);
 
     if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
@@ -1665,13 +2536,24 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
         return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
     }
 
-    ssize_t read_val = read(socket->io_handle.data.fd, buffer->buffer + buffer->len, buffer->capacity - buffer->len);
-    AWS_LOGF_TRACE(
-        AWS_LS_IO_SOCKET, "id=%p fd=%d: read of %d", (void *)socket, socket->io_handle.data.fd, (int)read_val);
-
-    if (read_val > 0) {
+    struct posix_socket *socket_impl = socket->impl;
+    ssize_t read_val = readv(socket->io_handle.data.fd, iovecs, iovec_count);
+    aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_impl->trace_logging_enabled,
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: read of %d into %d buffers",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        (int)read_val,
+        iovec_count);
+
+    if (read_val > 0) {
+        aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, (int64_t)read_val);
         *amount_read = (size_t)read_val;
-        buffer->len += *amount_read;
         return AWS_OP_SUCCESS;
     }
 
@@ -1681,7 +2563,7 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
             AWS_LS_IO_SOCKET, "id=%p fd=%d: zero read, socket is closed", (void *)socket, socket->io_handle.data.fd);
         *amount_read = 0;
 
-        if (buffer->capacity - buffer->len > 0) {
+        if (space > 0) {
             return aws_raise_error(AWS_IO_SOCKET_CLOSED);
         }
 
@@ -1694,7 +2576,16 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
 #else
     if (error == EAGAIN) {
 #endif
-        AWS_LOGF_TRACE(AWS_LS_IO_SOCKET, "id=%p fd=%d: read would block", (void *)socket, socket->io_handle.data.fd);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: read would block",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+        if (socket->statistics) {
+            ++socket->statistics->read_would_block;
+        }
         return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
     }
 
@@ -1717,6 +2608,52 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
     return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
 }
 
+int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read) {
+    struct iovec iov = {
+        .iov_base = buffer->buffer + buffer->len,
+        .iov_len = buffer->capacity - buffer->len,
+    };
+
+    if (s_socket_readv(socket, &iov, 1, iov.iov_len, amount_read)) {
+        return AWS_OP_ERR;
+    }
+
+    buffer->len += *amount_read;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+    AWS_ASSERT(buffers || buffer_count == 0);
+
+    struct iovec iovecs[MAX_IOVECS];
+    size_t iovec_count = aws_min_size(buffer_count, MAX_IOVECS);
+    size_t space = 0;
+
+    for (size_t i = 0; i < iovec_count; ++i) {
+        iovecs[i].iov_base = buffers[i]->buffer + buffers[i]->len;
+        iovecs[i].iov_len = buffers[i]->capacity - buffers[i]->len;
+        space += iovecs[i].iov_len;
+    }
+
+    if (s_socket_readv(socket, iovecs, (int)iovec_count, space, amount_read)) {
+        return AWS_OP_ERR;
+    }
+
+    /* the kernel fills the iovecs in order, so hand the bytes out the same way. */
+    size_t remaining = *amount_read;
+    for (size_t i = 0; i < iovec_count && remaining > 0; ++i) {
+        size_t filled = aws_min_size(remaining, iovecs[i].iov_len);
+        buffers[i]->len += filled;
+        remaining -= filled;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
 int aws_socket_write(
     struct aws_socket *socket,
     const struct aws_byte_cursor *cursor,
@@ -1750,13 +2687,805 @@ int aws_socket_write(
     aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
 
     /* avoid reentrancy when a user calls write after receiving their completion callback. */
-    if (!socket_impl->write_in_progress) {
+    if (!socket_impl->write_in_progress && !socket_impl->writes_corked) {
         return s_process_write_requests(socket, write_request);
     }
 
     return AWS_OP_SUCCESS;
 }
 
+int aws_socket_write_from_file(
+    struct aws_socket *socket,
+    FILE *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!(socket->state & CONNECTED_WRITE)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot write to because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    AWS_ASSERT(file);
+    AWS_ASSERT(written_fn);
+    int file_fd = fileno(file);
+    if (file_fd < 0) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    struct write_request *write_request = aws_mem_calloc(socket->allocator, 1, sizeof(struct write_request));
+
+    if (!write_request) {
+        return AWS_OP_ERR;
+    }
+
+    write_request->original_buffer_len = length;
+    write_request->written_fn = written_fn;
+    write_request->write_user_data = user_data;
+    write_request->cursor_cpy.len = length;
+    write_request->is_file = true;
+    write_request->file_fd = file_fd;
+    write_request->file_offset = offset;
+    aws_linked_list_push_back(&socket_impl->write_queue, &write_request->node);
+
+    if (!socket_impl->write_in_progress && !socket_impl->writes_corked) {
+        return s_process_write_requests(socket, write_request);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* only TCP_CORK's own failure is logged, the writes it wraps go ahead either way. */
+static void s_set_tcp_cork(struct aws_socket *socket, int corked) {
+#ifdef TCP_CORK
+    if (socket->options.tcp_cork && socket->options.type == AWS_SOCKET_STREAM &&
+        socket->options.domain != AWS_SOCKET_LOCAL) {
+        if (AWS_UNLIKELY(setsockopt(socket->io_handle.data.fd, IPPROTO_TCP, TCP_CORK, &corked, sizeof(corked)))) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: setsockopt() for setting TCP_CORK to %d failed with errno %d.",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                corked,
+                errno);
+        }
+    }
+#else
+    (void)socket;
+    (void)corked;
+#endif
+}
+
+void aws_socket_cork_writes(struct aws_socket *socket) {
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(socket->event_loop));
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (socket_impl->writes_corked || !aws_socket_is_open(socket)) {
+        return;
+    }
+
+    socket_impl->writes_corked = true;
+    s_set_tcp_cork(socket, 1);
+}
+
+void aws_socket_uncork_writes(struct aws_socket *socket) {
+    AWS_ASSERT(aws_event_loop_thread_is_callers_thread(socket->event_loop));
+    struct posix_socket *socket_impl = socket->impl;
+
+    if (!socket_impl->writes_corked) {
+        return;
+    }
+
+    socket_impl->writes_corked = false;
+
+    /* a write in progress is already working through the queue, and picks up what was held back. */
+    if (!socket_impl->write_in_progress && !aws_linked_list_empty(&socket_impl->write_queue)) {
+        s_process_write_requests(socket, NULL);
+    }
+
+    /* a completion callback may have closed the socket while the queue was sent */
+    if (aws_socket_is_open(socket)) {
+        s_set_tcp_cork(socket, 0);
+    }
+}
+
+#ifdef HAS_MMSG
+#    define datagram_mmsghdr mmsghdr
+#else
+/* laid out like Linux's struct mmsghdr, so both paths fill in the same headers */
+struct datagram_mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+#endif
+
+/* everything one datagram's msghdr points at */
+struct datagram_slot {
+    struct iovec iov;
+    struct sockaddr_storage address;
+    union {
+        uint8_t buffer[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+};
+
+/* sendmmsg() where it exists, else one sendmsg() per datagram. Either way returns how many went out, or -1 with errno
+ * set if the first one didn't. */
+static int s_send_datagrams(struct aws_socket *socket, struct datagram_mmsghdr *headers, unsigned int count) {
+#ifdef HAS_MMSG
+    int sent = sendmmsg(socket->io_handle.data.fd, headers, count, 0);
+    aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+    if (socket->statistics) {
+        ++socket->statistics->write_syscalls;
+    }
+    return sent;
+#else
+    unsigned int sent = 0;
+    for (; sent < count; ++sent) {
+        ssize_t written = sendmsg(socket->io_handle.data.fd, &headers[sent].msg_hdr, 0);
+        aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+        if (socket->statistics) {
+            ++socket->statistics->write_syscalls;
+        }
+        if (written < 0) {
+            return sent > 0 ? (int)sent : -1;
+        }
+        headers[sent].msg_len = (unsigned int)written;
+    }
+    return (int)sent;
+#endif
+}
+
+/* recvmmsg() where it exists, else recvmsg() until the socket is drained. Same return convention as above. */
+static int s_recv_datagrams(struct aws_socket *socket, struct datagram_mmsghdr *headers, unsigned int count) {
+#ifdef HAS_MMSG
+    int received = recvmmsg(socket->io_handle.data.fd, headers, count, 0, NULL);
+    aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
+    return received;
+#else
+    unsigned int received = 0;
+    for (; received < count; ++received) {
+        ssize_t read_val = recvmsg(socket->io_handle.data.fd, &headers[received].msg_hdr, 0);
+        aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+        if (socket->statistics) {
+            ++socket->statistics->read_syscalls;
+        }
+        if (read_val < 0) {
+            return received > 0 ? (int)received : -1;
+        }
+        headers[received].msg_len = (unsigned int)read_val;
+    }
+    return (int)received;
+#endif
+}
+
+static int s_validate_datagram_io(struct aws_socket *socket, int required_state) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot send or receive datagrams from a different thread than event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.type != AWS_SOCKET_DGRAM) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: not a datagram socket", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & required_state)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot send or receive datagrams because it is not bound or connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_datagram_address_from_endpoint(
+    struct aws_socket *socket,
+    const struct aws_socket_endpoint *endpoint,
+    struct sockaddr_storage *address,
+    socklen_t *address_size) {
+
+    int pton_err = 1;
+    if (socket->options.domain == AWS_SOCKET_IPV4) {
+        struct sockaddr_in *addr_in = (struct sockaddr_in *)address;
+        AWS_ZERO_STRUCT(*addr_in);
+        pton_err = inet_pton(AF_INET, endpoint->address, &addr_in->sin_addr);
+        addr_in->sin_port = htons(endpoint->port);
+        addr_in->sin_family = AF_INET;
+        *address_size = sizeof(*addr_in);
+    } else {
+        AWS_ASSERT(socket->options.domain == AWS_SOCKET_IPV6);
+        struct sockaddr_in6 *addr_in6 = (struct sockaddr_in6 *)address;
+        AWS_ZERO_STRUCT(*addr_in6);
+        pton_err = inet_pton(AF_INET6, endpoint->address, &addr_in6->sin6_addr);
+        addr_in6->sin6_port = htons(endpoint->port);
+        addr_in6->sin6_family = AF_INET6;
+        *address_size = sizeof(*addr_in6);
+    }
+
+    if (pton_err != 1) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: failed to parse datagram address %s:%d.",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            endpoint->address,
+            (int)endpoint->port);
+        return aws_raise_error(s_convert_pton_error(pton_err));
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_datagram_endpoint_from_address(
+    const struct sockaddr_storage *address,
+    socklen_t address_size,
+    struct aws_socket_endpoint *endpoint) {
+
+    endpoint->address[0] = '\0';
+    endpoint->port = 0;
+
+    if (address_size >= sizeof(struct sockaddr_in) && address->ss_family == AF_INET) {
+        const struct sockaddr_in *addr_in = (const struct sockaddr_in *)address;
+        if (inet_ntop(AF_INET, &addr_in->sin_addr, endpoint->address, sizeof(endpoint->address))) {
+            endpoint->port = ntohs(addr_in->sin_port);
+        }
+    } else if (address_size >= sizeof(struct sockaddr_in6) && address->ss_family == AF_INET6) {
+        const struct sockaddr_in6 *addr_in6 = (const struct sockaddr_in6 *)address;
+        if (inet_ntop(AF_INET6, &addr_in6->sin6_addr, endpoint->address, sizeof(endpoint->address))) {
+            endpoint->port = ntohs(addr_in6->sin6_port);
+        }
+    }
+}
+
+static int s_prepare_datagram_send(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagram,
+    struct datagram_mmsghdr *header,
+    struct datagram_slot *slot) {
+
+    AWS_ZERO_STRUCT(*header);
+    slot->iov.iov_base = datagram->buffer.buffer;
+    slot->iov.iov_len = datagram->buffer.len;
+    header->msg_hdr.msg_iov = &slot->iov;
+    header->msg_hdr.msg_iovlen = 1;
+
+    /* an empty address goes to the connected peer */
+    if (datagram->endpoint.address[0] != '\0') {
+        socklen_t address_size = 0;
+        if (s_datagram_address_from_endpoint(socket, &datagram->endpoint, &slot->address, &address_size)) {
+            return AWS_OP_ERR;
+        }
+        header->msg_hdr.msg_name = &slot->address;
+        header->msg_hdr.msg_namelen = address_size;
+    }
+
+    if (datagram->segment_size) {
+#ifdef HAS_UDP_OFFLOAD
+        header->msg_hdr.msg_control = slot->control.buffer;
+        header->msg_hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header->msg_hdr);
+        cmsg->cmsg_level = IPPROTO_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        uint16_t segment_size = datagram->segment_size;
+        memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+#else
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: UDP segmentation offload is not supported on this platform.",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+#endif
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_prepare_datagram_recv(
+    struct aws_socket_datagram *datagram,
+    struct datagram_mmsghdr *header,
+    struct datagram_slot *slot) {
+
+    AWS_ZERO_STRUCT(*header);
+    slot->iov.iov_base = datagram->buffer.buffer + datagram->buffer.len;
+    slot->iov.iov_len = datagram->buffer.capacity - datagram->buffer.len;
+    header->msg_hdr.msg_iov = &slot->iov;
+    header->msg_hdr.msg_iovlen = 1;
+    header->msg_hdr.msg_name = &slot->address;
+    header->msg_hdr.msg_namelen = sizeof(slot->address);
+    header->msg_hdr.msg_control = slot->control.buffer;
+    header->msg_hdr.msg_controllen = sizeof(slot->control.buffer);
+}
+
+static void s_finish_datagram_recv(
+    struct aws_socket_datagram *datagram,
+    struct datagram_mmsghdr *header,
+    struct datagram_slot *slot) {
+
+    datagram->buffer.len += aws_min_size(header->msg_len, slot->iov.iov_len);
+    datagram->truncated = (header->msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    datagram->segment_size = 0;
+    s_datagram_endpoint_from_address(&slot->address, header->msg_hdr.msg_namelen, &datagram->endpoint);
+
+#ifdef HAS_UDP_OFFLOAD
+    if (header->msg_hdr.msg_controllen > 0) {
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header->msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&header->msg_hdr, cmsg)) {
+            if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO) {
+                int segment_size = 0;
+                memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+                datagram->segment_size = (uint16_t)segment_size;
+            }
+        }
+    }
+#endif
+}
+
+int aws_socket_send_to_batch(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_sent) {
+    AWS_ASSERT(datagrams || count == 0);
+    AWS_ASSERT(datagrams_sent);
+
+    *datagrams_sent = 0;
+    if (s_validate_datagram_io(socket, CONNECTED_READ | CONNECTED_WRITE)) {
+        return AWS_OP_ERR;
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    struct datagram_mmsghdr headers[MAX_DATAGRAMS_PER_CALL];
+    struct datagram_slot slots[MAX_DATAGRAMS_PER_CALL];
+
+    while (*datagrams_sent < count) {
+        const struct aws_socket_datagram *batch = datagrams + *datagrams_sent;
+        size_t batch_count = aws_min_size(count - *datagrams_sent, MAX_DATAGRAMS_PER_CALL);
+
+        /* a datagram that can't be sent cuts the batch short, and fails the call once everything before it is out */
+        size_t prepared = 0;
+        while (prepared < batch_count &&
+               !s_prepare_datagram_send(socket, &batch[prepared], &headers[prepared], &slots[prepared])) {
+            ++prepared;
+        }
+        if (prepared == 0) {
+            return AWS_OP_ERR;
+        }
+
+        int sent = s_send_datagrams(socket, headers, (unsigned int)prepared);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: sent %d of %zu datagrams",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            sent,
+            prepared);
+
+        if (sent < 0) {
+            int error = errno;
+#if defined(EWOULDBLOCK)
+            if (error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS) {
+#else
+            if (error == EAGAIN || error == ENOBUFS) {
+#endif
+                aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+                if (socket->statistics) {
+                    ++socket->statistics->write_would_block;
+                }
+                return AWS_OP_SUCCESS;
+            }
+
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: datagram send failed with error code %d",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                error);
+            return aws_raise_error(s_determine_socket_error(error));
+        }
+
+        for (int i = 0; i < sent; ++i) {
+            aws_io_metrics_add(AWS_IO_METRIC_BYTES_WRITTEN, (int64_t)headers[i].msg_len);
+        }
+        *datagrams_sent += (size_t)sent;
+
+        if ((size_t)sent < prepared) {
+            /* the send buffer filled up, another call now would only hit EAGAIN */
+            if (socket->statistics) {
+                ++socket->statistics->partial_writes;
+            }
+            return AWS_OP_SUCCESS;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_send_to(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_socket_endpoint *destination,
+    size_t *amount_written) {
+    AWS_ASSERT(data);
+    AWS_ASSERT(amount_written);
+
+    struct aws_socket_datagram datagram;
+    AWS_ZERO_STRUCT(datagram);
+    datagram.buffer.buffer = data->ptr;
+    datagram.buffer.len = data->len;
+    datagram.buffer.capacity = data->len;
+    if (destination) {
+        datagram.endpoint = *destination;
+    }
+
+    size_t datagrams_sent = 0;
+    *amount_written = 0;
+    if (aws_socket_send_to_batch(socket, &datagram, 1, &datagrams_sent)) {
+        return AWS_OP_ERR;
+    }
+
+    if (datagrams_sent == 1) {
+        *amount_written = data->len;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_recv_from_batch(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_received) {
+    AWS_ASSERT(datagrams || count == 0);
+    AWS_ASSERT(datagrams_received);
+
+    *datagrams_received = 0;
+    if (s_validate_datagram_io(socket, CONNECTED_READ)) {
+        return AWS_OP_ERR;
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    struct datagram_mmsghdr headers[MAX_DATAGRAMS_PER_CALL];
+    struct datagram_slot slots[MAX_DATAGRAMS_PER_CALL];
+
+    while (*datagrams_received < count) {
+        struct aws_socket_datagram *batch = datagrams + *datagrams_received;
+        size_t batch_count = aws_min_size(count - *datagrams_received, MAX_DATAGRAMS_PER_CALL);
+        for (size_t i = 0; i < batch_count; ++i) {
+            s_prepare_datagram_recv(&batch[i], &headers[i], &slots[i]);
+        }
+
+        int received = s_recv_datagrams(socket, headers, (unsigned int)batch_count);
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_impl->trace_logging_enabled,
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: received %d of up to %zu datagrams",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            received,
+            batch_count);
+
+        if (received < 0) {
+            int error = errno;
+#if defined(EWOULDBLOCK)
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+#else
+            if (error == EAGAIN) {
+#endif
+                aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+                if (socket->statistics) {
+                    ++socket->statistics->read_would_block;
+                }
+                if (*datagrams_received > 0) {
+                    return AWS_OP_SUCCESS;
+                }
+                return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+            }
+
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_SOCKET,
+                "id=%p fd=%d: datagram receive failed with error code %d",
+                (void *)socket,
+                socket->io_handle.data.fd,
+                error);
+            return aws_raise_error(s_determine_socket_error(error));
+        }
+
+        for (int i = 0; i < received; ++i) {
+            s_finish_datagram_recv(&batch[i], &headers[i], &slots[i]);
+            aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, (int64_t)headers[i].msg_len);
+        }
+        *datagrams_received += (size_t)received;
+
+        if ((size_t)received < batch_count) {
+            /* drained, another call now would only hit EAGAIN */
+            break;
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_recv_from(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_socket_endpoint *source,
+    size_t *amount_read) {
+    AWS_ASSERT(buffer);
+    AWS_ASSERT(amount_read);
+
+    struct aws_socket_datagram datagram;
+    AWS_ZERO_STRUCT(datagram);
+    datagram.buffer = *buffer;
+
+    size_t datagrams_received = 0;
+    *amount_read = 0;
+    if (aws_socket_recv_from_batch(socket, &datagram, 1, &datagrams_received)) {
+        return AWS_OP_ERR;
+    }
+
+    *amount_read = datagram.buffer.len - buffer->len;
+    buffer->len = datagram.buffer.len;
+    if (source) {
+        *source = datagram.endpoint;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_validate_handle_passing(struct aws_socket *socket, int required_state) {
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot pass handles from a different thread than event loop %p",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            (void *)socket->event_loop);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (socket->options.domain != AWS_SOCKET_LOCAL || socket->options.type != AWS_SOCKET_STREAM) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: handles can only be passed over local stream sockets",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_INVALID_OPERATION_FOR_TYPE);
+    }
+
+    if (!(socket->state & required_state)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot pass handles because it is not connected",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_send_handle(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_io_handle *handle,
+    size_t *amount_written) {
+    AWS_ASSERT(data);
+    AWS_ASSERT(handle);
+    AWS_ASSERT(amount_written);
+
+    *amount_written = 0;
+    if (s_validate_handle_passing(socket, CONNECTED_WRITE)) {
+        return AWS_OP_ERR;
+    }
+
+    if (data->len == 0) {
+        /* the descriptor rides on the first byte, a stream has nowhere to put it without one */
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct posix_socket *socket_impl = socket->impl;
+    if (!aws_linked_list_empty(&socket_impl->write_queue)) {
+        /* going ahead of queued writes would reorder the stream */
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: cannot pass a handle while writes are outstanding",
+            (void *)socket,
+            socket->io_handle.data.fd);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    struct iovec iov = {
+        .iov_base = data->ptr,
+        .iov_len = data->len,
+    };
+
+    union {
+        struct cmsghdr header;
+        uint8_t space[CMSG_SPACE(sizeof(int))];
+    } control;
+    AWS_ZERO_STRUCT(control);
+
+    struct msghdr msg;
+    AWS_ZERO_STRUCT(msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.space;
+    msg.msg_controllen = sizeof(control.space);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &handle->data.fd, sizeof(int));
+
+    ssize_t written = sendmsg(socket->io_handle.data.fd, &msg, NO_SIGNAL);
+    aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+    if (written < 0) {
+        int error = errno;
+#if defined(EWOULDBLOCK)
+        if (error == EAGAIN || error == EWOULDBLOCK) {
+#else
+        if (error == EAGAIN) {
+#endif
+            aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+            return AWS_OP_SUCCESS;
+        }
+
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: passing fd %d failed with error code %d",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            handle->data.fd,
+            error);
+        return aws_raise_error(s_determine_socket_error(error));
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: passed fd %d with %zd bytes",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        handle->data.fd,
+        written);
+    aws_io_metrics_add(AWS_IO_METRIC_BYTES_WRITTEN, (int64_t)written);
+    *amount_written = (size_t)written;
+    return AWS_OP_SUCCESS;
+}
+
+int aws_socket_recv_handle(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_io_handle *out_handle,
+    size_t *amount_read) {
+    AWS_ASSERT(buffer);
+    AWS_ASSERT(out_handle);
+    AWS_ASSERT(amount_read);
+
+    *amount_read = 0;
+    out_handle->data.fd = -1;
+    out_handle->additional_data = NULL;
+    if (s_validate_handle_passing(socket, CONNECTED_READ)) {
+        return AWS_OP_ERR;
+    }
+
+    struct iovec iov = {
+        .iov_base = buffer->buffer + buffer->len,
+        .iov_len = buffer->capacity - buffer->len,
+    };
+
+    /* room for a few, so a peer sending more than one at once can't leave any open in this process unnoticed */
+    union {
+        struct cmsghdr header;
+        uint8_t space[CMSG_SPACE(sizeof(int) * 4)];
+    } control;
+    AWS_ZERO_STRUCT(control);
+
+    struct msghdr msg;
+    AWS_ZERO_STRUCT(msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.space;
+    msg.msg_controllen = sizeof(control.space);
+
+    int recv_flags = 0;
+#if defined(MSG_CMSG_CLOEXEC)
+    recv_flags |= MSG_CMSG_CLOEXEC;
+#endif
+    ssize_t read_val = recvmsg(socket->io_handle.data.fd, &msg, recv_flags);
+    aws_io_metrics_add(AWS_IO_METRIC_SOCKET_SYSCALLS, 1);
+    if (read_val < 0) {
+        int error = errno;
+#if defined(EWOULDBLOCK)
+        if (error == EAGAIN || error == EWOULDBLOCK) {
+#else
+        if (error == EAGAIN) {
+#endif
+            aws_io_metrics_add(AWS_IO_METRIC_SOCKET_WOULD_BLOCK, 1);
+            return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+        }
+
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: receiving a handle failed with error code %d",
+            (void *)socket,
+            socket->io_handle.data.fd,
+            error);
+        return aws_raise_error(s_determine_socket_error(error));
+    }
+
+    if (read_val == 0) {
+        AWS_LOGF_INFO(
+            AWS_LS_IO_SOCKET, "id=%p fd=%d: zero read, socket is closed", (void *)socket, socket->io_handle.data.fd);
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    /* keep the first descriptor, close any others */
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        size_t fd_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < fd_count; ++i) {
+            int fd = -1;
+            memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (out_handle->data.fd < 0) {
+                out_handle->data.fd = fd;
+#if !defined(MSG_CMSG_CLOEXEC)
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+            } else {
+                close(fd);
+            }
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p fd=%d: peer passed more handles than fit, the kernel closed the rest",
+            (void *)socket,
+            socket->io_handle.data.fd);
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET,
+        "id=%p fd=%d: received %zd bytes and fd %d",
+        (void *)socket,
+        socket->io_handle.data.fd,
+        read_val,
+        out_handle->data.fd);
+    aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, (int64_t)read_val);
+    *amount_read = (size_t)read_val;
+    buffer->len += (size_t)read_val;
+    return AWS_OP_SUCCESS;
+}
+
 int aws_socket_get_error(struct aws_socket *socket) {
     int connect_result;
     socklen_t result_length = sizeof(connect_result);
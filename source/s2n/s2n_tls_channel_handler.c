@@ -10,9 +10,15 @@
 #include <aws/io/logging.h>
 #include <aws/io/pki_utils.h>
 #include <aws/io/private/tls_channel_handler_shared.h>
+#include <aws/io/private/tls_session_cache.h>
 #include <aws/io/statistics.h>
 
+#include <aws/common/clock.h>
+#include <aws/common/device_random.h>
 #include <aws/common/encoding.h>
+#include <aws/common/mutex.h>
+#include <aws/common/ref_count.h>
+#include <aws/common/ring_buffer.h>
 #include <aws/common/string.h>
 #include <aws/common/task_scheduler.h>
 #include <aws/common/thread.h>
@@ -26,10 +32,18 @@
 
 #include <openssl/crypto.h>
 
+#if defined(AWS_USE_KTLS)
+#    include <aws/io/socket.h>
+#    include <aws/io/socket_channel_handler.h>
+#    include <s2n/unstable/ktls.h>
+#endif
+
 #define EST_TLS_RECORD_OVERHEAD 53 /* 5 byte header + 32 + 16 bytes for padding */
 #define KB_1 1024
 #define MAX_RECORD_SIZE (KB_1 * 16)
 #define EST_HANDSHAKE_SIZE (7 * KB_1)
+/* most segments of a borrowed message handed to one s2n_sendv_with_offset() call */
+#define MAX_BORROWED_SEND_IOVECS 16
 
 static const char *s_default_ca_dir = NULL;
 static const char *s_default_ca_file = NULL;
@@ -65,15 +79,23 @@ static unsigned long s_id_fn(void) {
 }
 #endif
 
+/* socket reads that can sit in the input ring at once, and the smallest worth handing out */
+#define MAX_INPUT_RING_CHUNKS 16
+#define MIN_INPUT_RING_CHUNK_SIZE 2048
+
 struct s2n_handler {
     struct aws_channel_handler handler;
     struct aws_tls_channel_handler_shared shared_state;
     struct s2n_connection *connection;
     struct aws_channel_slot *slot;
     struct aws_linked_list input_queue;
+    /* writes that arrived before negotiation finished, see queue_writes_before_negotiation */
+    struct aws_linked_list queued_writes;
     struct aws_byte_buf protocol;
     struct aws_byte_buf server_name;
     aws_channel_on_message_write_completed_fn *latest_message_on_completion;
+    /* ciphertext s2n produced during the current s2n call that hasn't gone downstream yet, see s_generic_send */
+    struct aws_io_message *pending_write;
     struct aws_channel_task sequential_tasks;
     void *latest_message_completion_user_data;
     aws_tls_on_negotiation_result_fn *on_negotiation_result;
@@ -81,12 +103,46 @@ struct s2n_handler {
     aws_tls_on_error_fn *on_error;
     void *user_data;
     bool advertise_alpn_message;
+    aws_tls_on_protocol_negotiated on_protocol_negotiated;
     bool negotiation_finished;
+    bool queue_writes_before_negotiation;
+    /* kernel TLS was asked for and hasn't been ruled out yet. */
+    bool ktls_requested;
+    /* the kernel encrypts outgoing records, this handler passes writes straight through. */
+    bool ktls_send_enabled;
+    /* held so the session cache and private key outlive us */
+    struct aws_tls_ctx *ctx;
+    /* our server_name:port, set when the ctx has a session cache */
+    struct aws_string *session_cache_key;
+    /* the loop whose pool the connection goes back to, set when the ctx pools connections */
+    struct aws_event_loop *connection_pool_loop;
+    /* see aws_tls_ctx_options.release_idle_buffers */
+    bool release_idle_buffers;
+    /* see aws_tls_ctx_options.input_ring_size. Each socket read into the ring is a chunk; chunks wait in order in
+     * input_chunks, input_chunk_offset bytes into the oldest have been decrypted, and each goes back to the ring once
+     * s2n is done with it. */
+    struct aws_ring_buffer input_ring;
+    struct aws_byte_buf input_chunks[MAX_INPUT_RING_CHUNKS];
+    size_t input_chunk_start;
+    size_t input_chunk_count;
+    size_t input_chunk_offset;
+    /* handed to the socket handler and not filled yet */
+    struct aws_byte_buf input_chunk_acquired;
 };
 
 struct s2n_ctx {
     struct aws_tls_ctx ctx;
     struct s2n_config *s2n_config;
+    struct s2n_cert_chain_and_key *cert_chain_and_key;
+    /* private key operations run here when set, see aws_tls_ctx_options.private_key_offload_elg */
+    struct aws_event_loop_group *private_key_offload_elg;
+    bool enable_ktls;
+    bool release_idle_buffers;
+    size_t input_ring_size;
+    bool session_cache_enabled;
+    struct aws_tls_session_cache session_cache;
+    /* set when aws_tls_ctx_options.connection_pool_size is, see s_acquire_connection */
+    struct s2n_connection_pools *connection_pools;
 };
 
 static const char *s_determine_default_pki_dir(void) {
@@ -225,31 +281,47 @@ bool aws_tls_is_cipher_pref_supported(enum aws_tls_cipher_pref cipher_pref) {
     }
 }
 
+static void s_pop_input_chunk(struct s2n_handler *handler) {
+    aws_ring_buffer_release(&handler->input_ring, &handler->input_chunks[handler->input_chunk_start]);
+    handler->input_chunk_start = (handler->input_chunk_start + 1) % MAX_INPUT_RING_CHUNKS;
+    --handler->input_chunk_count;
+    handler->input_chunk_offset = 0;
+}
+
 static int s_generic_read(struct s2n_handler *handler, struct aws_byte_buf *buf) {
 
     size_t written = 0;
 
+    /* the ring only fills while input_queue is empty, so whatever it holds arrived first */
+    while (handler->input_chunk_count && written < buf->len) {
+        struct aws_byte_buf *chunk = &handler->input_chunks[handler->input_chunk_start];
+        size_t to_write = aws_min_size(chunk->len - handler->input_chunk_offset, buf->len - written);
+
+        memcpy(buf->buffer + written, chunk->buffer + handler->input_chunk_offset, to_write);
+        written += to_write;
+        handler->input_chunk_offset += to_write;
+
+        if (handler->input_chunk_offset == chunk->len) {
+            s_pop_input_chunk(handler);
+        }
+    }
+
+    /* s2n asks for a record header and then its body, so a message usually serves several calls: leave it queued
+     * until it's used up instead of popping and pushing it back every time. */
     while (!aws_linked_list_empty(&handler->input_queue) && written < buf->len) {
-        struct aws_linked_list_node *node = aws_linked_list_pop_front(&handler->input_queue);
+        struct aws_linked_list_node *node = aws_linked_list_front(&handler->input_queue);
         struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
 
         size_t remaining_message_len = message->message_data.len - message->copy_mark;
-        size_t remaining_buf_len = buf->len - written;
-
-        size_t to_write = remaining_message_len < remaining_buf_len ? remaining_message_len : remaining_buf_len;
-
-        struct aws_byte_cursor message_cursor = aws_byte_cursor_from_buf(&message->message_data);
-        aws_byte_cursor_advance(&message_cursor, message->copy_mark);
-        aws_byte_cursor_read(&message_cursor, buf->buffer + written, to_write);
+        size_t to_write = aws_min_size(remaining_message_len, buf->len - written);
 
+        memcpy(buf->buffer + written, message->message_data.buffer + message->copy_mark, to_write);
         written += to_write;
-
         message->copy_mark += to_write;
 
         if (message->copy_mark == message->message_data.len) {
+            aws_linked_list_pop_front(&handler->input_queue);
             aws_mem_release(message->allocator, message);
-        } else {
-            aws_linked_list_push_front(&handler->input_queue, &message->queueing_handle);
         }
     }
 
@@ -268,54 +340,102 @@ static int s_s2n_handler_recv(void *io_context, uint8_t *buf, uint32_t len) {
     return s_generic_read(handler, &read_buffer);
 }
 
+/*
+ * s2n hands over every record it produces through here, several of them for a handshake flight or a large write.
+ * They're packed back to back into pending_write, which goes downstream once it's full or when the s2n call that
+ * produced them returns (see s_flush_pending_write). A full size record is a little bigger than a message, so sending
+ * a message per record would cost two messages, and two socket writes, for each record of a large write.
+ */
 static int s_generic_send(struct s2n_handler *handler, struct aws_byte_buf *buf) {
 
     struct aws_byte_cursor buffer_cursor = aws_byte_cursor_from_buf(buf);
-
-    size_t processed = 0;
-    while (processed < buf->len) {
-        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
-            handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, buf->len - processed);
+    const size_t overhead = aws_channel_slot_upstream_message_overhead(handler->slot);
+
+    while (buffer_cursor.len) {
+        struct aws_io_message *message = handler->pending_write;
+
+        /* a full message waits here for more data rather than going out right away, so the last one of an s2n call
+         * is always left for s_flush_pending_write to attach the write completion to */
+        if (message && message->message_data.len + overhead >= message->message_data.capacity) {
+            handler->pending_write = NULL;
+            if (aws_channel_slot_send_message(handler->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+                aws_mem_release(message->allocator, message);
+                errno = EPIPE;
+                return -1;
+            }
+            message = NULL;
+        }
 
         if (!message) {
-            errno = ENOMEM;
-            return -1;
+            message = aws_channel_acquire_message_from_pool(
+                handler->slot->channel,
+                AWS_IO_MESSAGE_APPLICATION_DATA,
+                aws_max_size(buffer_cursor.len, g_aws_channel_max_fragment_size));
+
+            if (!message) {
+                errno = ENOMEM;
+                return -1;
+            }
+
+            if (message->message_data.capacity <= overhead) {
+                aws_mem_release(message->allocator, message);
+                errno = ENOMEM;
+                return -1;
+            }
+            handler->pending_write = message;
         }
 
-        const size_t overhead = aws_channel_slot_upstream_message_overhead(handler->slot);
-        const size_t available_msg_write_capacity = buffer_cursor.len - overhead;
+        const size_t available_msg_write_capacity =
+            message->message_data.capacity - overhead - message->message_data.len;
+        struct aws_byte_cursor chunk =
+            aws_byte_cursor_advance(&buffer_cursor, aws_min_size(available_msg_write_capacity, buffer_cursor.len));
+        aws_byte_buf_write_from_whole_cursor(&message->message_data, chunk);
+    }
 
-        const size_t to_write = message->message_data.capacity > available_msg_write_capacity
-                                    ? available_msg_write_capacity
-                                    : message->message_data.capacity;
+    if (buf->len) {
+        return (int)buf->len;
+    }
 
-        struct aws_byte_cursor chunk = aws_byte_cursor_advance(&buffer_cursor, to_write);
-        if (aws_byte_buf_append(&message->message_data, &chunk)) {
-            aws_mem_release(message->allocator, message);
-            return -1;
-        }
-        processed += message->message_data.len;
+    errno = EAGAIN;
+    return -1;
+}
 
-        if (processed == buf->len) {
-            message->on_completion = handler->latest_message_on_completion;
-            message->user_data = handler->latest_message_completion_user_data;
-            handler->latest_message_on_completion = NULL;
-            handler->latest_message_completion_user_data = NULL;
-        }
+/*
+ * Sends whatever the last s2n call left in pending_write. The write completion callback, if there is one, goes with
+ * it: it holds the end of the last record of that write. If it can't go downstream, the completion fires here with
+ * the error, once, and the caller shuts the channel down.
+ */
+static int s_flush_pending_write(struct s2n_handler *handler) {
+    struct aws_io_message *message = handler->pending_write;
+    if (!message) {
+        return AWS_OP_SUCCESS;
+    }
 
-        if (aws_channel_slot_send_message(handler->slot, message, AWS_CHANNEL_DIR_WRITE)) {
-            aws_mem_release(message->allocator, message);
-            errno = EPIPE;
-            return -1;
+    handler->pending_write = NULL;
+    message->on_completion = handler->latest_message_on_completion;
+    message->user_data = handler->latest_message_completion_user_data;
+    handler->latest_message_on_completion = NULL;
+    handler->latest_message_completion_user_data = NULL;
+
+    if (aws_channel_slot_send_message(handler->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+        int error_code = aws_last_error();
+        /* the write this finishes was taken from its sender already, so its completion is the only way to tell them */
+        if (message->on_completion) {
+            message->on_completion(handler->slot->channel, message, error_code, message->user_data);
         }
+        aws_mem_release(message->allocator, message);
+        return aws_raise_error(error_code);
     }
 
-    if (processed) {
-        return (int)processed;
-    }
+    return AWS_OP_SUCCESS;
+}
 
-    errno = EAGAIN;
-    return -1;
+/* for callers with nothing to hand back an error to: ciphertext that can't go downstream means the connection is
+ * broken, so shut it down. */
+static void s_flush_pending_write_or_shut_down(struct s2n_handler *handler) {
+    if (s_flush_pending_write(handler)) {
+        aws_channel_shutdown(handler->slot->channel, aws_last_error());
+    }
 }
 
 static int s_s2n_handler_send(void *io_context, const uint8_t *buf, uint32_t len) {
@@ -325,11 +445,257 @@ static int s_s2n_handler_send(void *io_context, const uint8_t *buf, uint32_t len
     return s_generic_send(handler, &send_buf);
 }
 
+/*
+ * Idle connections of a ctx, kept per event loop so a new handler can pick up a wiped connection instead of paying for
+ * s2n_connection_new(). Each loop's pool lives in that loop's local objects, like s_tl_cleanup_object, and is only
+ * used from that loop's thread. The pools of a ctx share this block so that whichever of the ctx or a loop goes away
+ * first can free the connections: pooled connections still point at the ctx's s2n_config. The lock is only contended
+ * by connections being set up on several loops at the same moment, or by that tear down.
+ */
+struct s2n_connection_pools {
+    struct aws_allocator *allocator;
+    struct aws_ref_count ref_count;
+    struct aws_mutex lock;
+    /* struct s2n_connection_pool, through node */
+    struct aws_linked_list pools;
+    size_t max_connections_per_loop;
+};
+
+struct s2n_connection_pool {
+    struct aws_event_loop_local_object local_object;
+    struct s2n_connection_pools *pools;
+    struct aws_event_loop *loop;
+    struct aws_linked_list_node node;
+    /* struct s2n_connection * */
+    struct aws_array_list connections;
+};
+
+static void s_connection_pool_free_connections(struct s2n_connection_pool *pool) {
+    struct s2n_connection *connection = NULL;
+    while (aws_array_list_length(&pool->connections)) {
+        aws_array_list_back(&pool->connections, &connection);
+        aws_array_list_pop_back(&pool->connections);
+        s2n_connection_free(connection);
+    }
+}
+
+static void s_connection_pools_destroy(void *user_data) {
+    struct s2n_connection_pools *pools = user_data;
+
+    AWS_ASSERT(aws_linked_list_empty(&pools->pools));
+    aws_mutex_clean_up(&pools->lock);
+    aws_mem_release(pools->allocator, pools);
+}
+
+static struct s2n_connection_pools *s_connection_pools_new(struct aws_allocator *allocator, size_t max_per_loop) {
+    struct s2n_connection_pools *pools = aws_mem_calloc(allocator, 1, sizeof(struct s2n_connection_pools));
+    if (!pools) {
+        return NULL;
+    }
+
+    if (aws_mutex_init(&pools->lock)) {
+        aws_mem_release(allocator, pools);
+        return NULL;
+    }
+
+    pools->allocator = allocator;
+    aws_ref_count_init(&pools->ref_count, pools, s_connection_pools_destroy);
+    aws_linked_list_init(&pools->pools);
+    pools->max_connections_per_loop = max_per_loop;
+
+    return pools;
+}
+
+struct s2n_connection_pool_remove_task {
+    struct aws_task task;
+    struct aws_event_loop *loop;
+    struct s2n_connection_pools *pools;
+};
+
+/* runs on the pool's loop: dropping the local object frees that loop's pool, see s_on_connection_pool_removed */
+static void s_connection_pool_remove_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct s2n_connection_pool_remove_task *remove_task = arg;
+    struct s2n_connection_pools *pools = remove_task->pools;
+
+    /* a canceled task means the loop is being destroyed, which removes its local objects itself */
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_event_loop_remove_local_object(remove_task->loop, pools, NULL);
+    }
+
+    aws_mem_release(pools->allocator, remove_task);
+    aws_ref_count_release(&pools->ref_count);
+}
+
+/*
+ * The ctx is going away. Every loop's idle connections go with it right now, and each loop is asked to drop its pool,
+ * so the pools don't outlive the ctx until the loops themselves are destroyed.
+ */
+static void s_connection_pools_release_from_ctx(struct s2n_connection_pools *pools) {
+    if (!pools) {
+        return;
+    }
+
+    aws_mutex_lock(&pools->lock);
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&pools->pools);
+         node != aws_linked_list_end(&pools->pools);
+         node = aws_linked_list_next(node)) {
+        struct s2n_connection_pool *pool = AWS_CONTAINER_OF(node, struct s2n_connection_pool, node);
+        s_connection_pool_free_connections(pool);
+
+        struct s2n_connection_pool_remove_task *remove_task =
+            aws_mem_calloc(pools->allocator, 1, sizeof(struct s2n_connection_pool_remove_task));
+        if (!remove_task) {
+            /* the empty pool stays until its loop is destroyed */
+            continue;
+        }
+
+        /* the key of the local object is the pools block, it has to stay alive until the task is done with it */
+        remove_task->loop = pool->loop;
+        remove_task->pools = pools;
+        aws_ref_count_acquire(&pools->ref_count);
+        aws_task_init(&remove_task->task, s_connection_pool_remove_task, remove_task, "s2n_connection_pool_remove");
+        aws_event_loop_schedule_task_now(pool->loop, &remove_task->task);
+    }
+    aws_mutex_unlock(&pools->lock);
+
+    aws_ref_count_release(&pools->ref_count);
+}
+
+/* the loop is going away (or never took the pool), its idle connections go with it */
+static void s_on_connection_pool_removed(struct aws_event_loop_local_object *object) {
+    struct s2n_connection_pool *pool = object->object;
+    struct s2n_connection_pools *pools = pool->pools;
+
+    aws_mutex_lock(&pools->lock);
+    s_connection_pool_free_connections(pool);
+    aws_linked_list_remove(&pool->node);
+    aws_mutex_unlock(&pools->lock);
+
+    aws_array_list_clean_up(&pool->connections);
+    aws_mem_release(pools->allocator, pool);
+    aws_ref_count_release(&pools->ref_count);
+}
+
+static struct s2n_connection_pool *s_connection_pool_get_or_create(
+    struct s2n_connection_pools *pools,
+    struct aws_channel *channel) {
+
+    struct aws_event_loop_local_object local_object;
+    if (!aws_channel_fetch_local_object(channel, pools, &local_object)) {
+        return local_object.object;
+    }
+
+    struct s2n_connection_pool *pool = aws_mem_calloc(pools->allocator, 1, sizeof(struct s2n_connection_pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (aws_array_list_init_dynamic(
+            &pool->connections, pools->allocator, pools->max_connections_per_loop, sizeof(struct s2n_connection *))) {
+        aws_mem_release(pools->allocator, pool);
+        return NULL;
+    }
+
+    pool->pools = pools;
+    aws_ref_count_acquire(&pools->ref_count);
+    pool->loop = channel->loop;
+    pool->local_object.key = pools;
+    pool->local_object.object = pool;
+    pool->local_object.on_object_removed = s_on_connection_pool_removed;
+
+    aws_mutex_lock(&pools->lock);
+    aws_linked_list_push_back(&pools->pools, &pool->node);
+    aws_mutex_unlock(&pools->lock);
+
+    if (aws_channel_put_local_object(channel, pools, &pool->local_object)) {
+        s_on_connection_pool_removed(&pool->local_object);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/* Hands out an idle connection from this loop's pool if there is one, a new one otherwise. */
+static struct s2n_connection *s_acquire_connection(struct s2n_handler *s2n_handler, s2n_mode mode) {
+    struct s2n_ctx *s2n_ctx = s2n_handler->ctx->impl;
+    if (!s2n_ctx->connection_pools) {
+        return s2n_connection_new(mode);
+    }
+
+    struct s2n_connection *connection = NULL;
+    struct s2n_connection_pool *pool =
+        s_connection_pool_get_or_create(s2n_ctx->connection_pools, s2n_handler->slot->channel);
+    if (pool) {
+        s2n_handler->connection_pool_loop = pool->loop;
+
+        aws_mutex_lock(&pool->pools->lock);
+        if (aws_array_list_length(&pool->connections)) {
+            aws_array_list_back(&pool->connections, &connection);
+            aws_array_list_pop_back(&pool->connections);
+        }
+        aws_mutex_unlock(&pool->pools->lock);
+    }
+
+    if (connection) {
+        aws_io_metrics_add(AWS_IO_METRIC_TLS_CONNECTIONS_REUSED, 1);
+        return connection;
+    }
+
+    return s2n_connection_new(mode);
+}
+
+/* Wipes the handler's connection and puts it back in its loop's pool, or frees it if it can't be reused. */
+static void s_release_connection(struct s2n_handler *s2n_handler) {
+    struct s2n_connection *connection = s2n_handler->connection;
+    s2n_handler->connection = NULL;
+    if (!connection) {
+        return;
+    }
+
+    struct s2n_ctx *s2n_ctx = s2n_handler->ctx ? s2n_handler->ctx->impl : NULL;
+    /* the kernel holds a kTLS connection's keys and socket state, don't try to reuse one */
+    if (!s2n_ctx || !s2n_ctx->connection_pools || !s2n_handler->connection_pool_loop ||
+        s2n_handler->ktls_send_enabled || s2n_connection_wipe(connection)) {
+        s2n_connection_free(connection);
+        return;
+    }
+
+    struct s2n_connection_pools *pools = s2n_ctx->connection_pools;
+    bool pooled = false;
+
+    aws_mutex_lock(&pools->lock);
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&pools->pools);
+         node != aws_linked_list_end(&pools->pools);
+         node = aws_linked_list_next(node)) {
+        struct s2n_connection_pool *pool = AWS_CONTAINER_OF(node, struct s2n_connection_pool, node);
+        if (pool->loop == s2n_handler->connection_pool_loop) {
+            if (aws_array_list_length(&pool->connections) < pools->max_connections_per_loop) {
+                pooled = !aws_array_list_push_back(&pool->connections, &connection);
+            }
+            break;
+        }
+    }
+    aws_mutex_unlock(&pools->lock);
+
+    if (!pooled) {
+        s2n_connection_free(connection);
+    }
+}
+
 static void s_s2n_handler_destroy(struct aws_channel_handler *handler) {
     if (handler) {
         struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
         aws_tls_channel_handler_shared_clean_up(&s2n_handler->shared_state);
-        s2n_connection_free(s2n_handler->connection);
+        if (s2n_handler->pending_write) {
+            aws_mem_release(s2n_handler->pending_write->allocator, s2n_handler->pending_write);
+        }
+        s_release_connection(s2n_handler);
+        if (s2n_handler->input_ring.allocation) {
+            aws_ring_buffer_clean_up(&s2n_handler->input_ring);
+        }
+        aws_string_destroy(s2n_handler->session_cache_key);
+        aws_tls_ctx_release(s2n_handler->ctx);
         aws_mem_release(handler->alloc, (void *)s2n_handler);
     }
 }
@@ -349,6 +715,197 @@ static void s_on_negotiation_result(
     }
 }
 
+#if defined(AWS_USE_KTLS)
+/* Hands the write keys to the kernel so records from here on are encrypted by kernel TLS. s2n will only do that when it
+ * owns the file descriptor, so it gets pointed at the socket first, and put back on the channel if s2n, the kernel or
+ * the negotiated cipher says no. Everything already queued on the socket was encrypted here, so this waits until
+ * those writes have left userspace, otherwise the kernel would encrypt them a second time. */
+static void s_try_enable_ktls_send(struct s2n_handler *s2n_handler) {
+    if (!s2n_handler->ktls_requested || s2n_handler->ktls_send_enabled) {
+        return;
+    }
+
+    struct aws_channel_slot *socket_slot = s2n_handler->slot->adj_left;
+    struct aws_socket *socket = socket_slot ? aws_socket_handler_get_socket(socket_slot->handler) : NULL;
+    if (!socket) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: kernel TLS needs the socket handler directly below the TLS handler, encrypting in userspace.",
+            (void *)&s2n_handler->handler);
+        s2n_handler->ktls_requested = false;
+        return;
+    }
+
+    if (aws_socket_handler_has_pending_writes(socket_slot->handler)) {
+        /* tried again on the next write */
+        return;
+    }
+
+    if (s2n_connection_set_write_fd(s2n_handler->connection, socket->io_handle.data.fd) ||
+        s2n_connection_ktls_enable_send(s2n_handler->connection)) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: kernel TLS is unavailable for this connection, encrypting in userspace. %s (%s)",
+            (void *)&s2n_handler->handler,
+            s2n_strerror(s2n_errno, "EN"),
+            s2n_strerror_debug(s2n_errno, "EN"));
+        s2n_connection_set_send_cb(s2n_handler->connection, s_s2n_handler_send);
+        s2n_connection_set_send_ctx(s2n_handler->connection, s2n_handler);
+        s2n_handler->ktls_requested = false;
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_TLS, "id=%p: outgoing records are now encrypted by kernel TLS.", (void *)&s2n_handler->handler);
+    s2n_handler->ktls_send_enabled = true;
+    /* the record overhead leaves with the framing, see s_s2n_handler_message_overhead */
+    aws_channel_update_message_overheads(s2n_handler->slot->channel);
+}
+#endif
+
+static int s_s2n_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message);
+
+static int s_drive_negotiation(struct aws_channel_handler *handler);
+
+/*
+ * A private key operation s2n handed us. It's performed on an offload event loop, then applied to the connection
+ * and negotiation resumed back on the channel's thread. The channel is held until then, which keeps the handler, and
+ * through it the ctx that owns the key, alive.
+ */
+struct private_key_offload {
+    struct aws_allocator *allocator;
+    struct s2n_handler *s2n_handler;
+    struct s2n_async_pkey_op *op;
+    struct aws_task perform_task;
+    struct aws_channel_task resume_task;
+    bool perform_failed;
+};
+
+static void s_private_key_offload_resume_task(struct aws_channel_task *task, void *arg, aws_task_status status) {
+    (void)task;
+    struct private_key_offload *offload = arg;
+    struct s2n_handler *s2n_handler = offload->s2n_handler;
+    struct aws_channel *channel = s2n_handler->slot->channel;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        if (offload->perform_failed || s2n_async_pkey_op_apply(offload->op, s2n_handler->connection)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_TLS,
+                "id=%p: offloaded private key operation failed %s (%s)",
+                (void *)&s2n_handler->handler,
+                s2n_strerror(s2n_errno, "EN"),
+                s2n_strerror_debug(s2n_errno, "EN"));
+            s_on_negotiation_result(
+                &s2n_handler->handler, s2n_handler->slot, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE, s2n_handler->user_data);
+            aws_channel_shutdown(channel, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        } else if (s_drive_negotiation(&s2n_handler->handler)) {
+            aws_channel_shutdown(channel, aws_last_error());
+        }
+    }
+
+    s2n_async_pkey_op_free(offload->op);
+    aws_mem_release(offload->allocator, offload);
+    aws_channel_release_hold(channel);
+}
+
+static void s_private_key_offload_perform_task(struct aws_task *task, void *arg, aws_task_status status) {
+    (void)task;
+    struct private_key_offload *offload = arg;
+    struct s2n_ctx *s2n_ctx = offload->s2n_handler->ctx->impl;
+
+    /* even if the offload loop is going away, the channel thread still needs to hear back */
+    offload->perform_failed = status != AWS_TASK_STATUS_RUN_READY ||
+                              s2n_async_pkey_op_perform(
+                                  offload->op, s2n_cert_chain_and_key_get_private_key(s2n_ctx->cert_chain_and_key));
+
+    aws_channel_schedule_task_now(offload->s2n_handler->slot->channel, &offload->resume_task);
+}
+
+/* s2n calls this from inside s2n_negotiate, which then reports itself blocked until the operation is applied. */
+static int s_async_pkey_callback(struct s2n_connection *conn, struct s2n_async_pkey_op *op) {
+    struct s2n_handler *s2n_handler = s2n_connection_get_ctx(conn);
+    struct private_key_offload *offload =
+        aws_mem_calloc(s2n_handler->handler.alloc, 1, sizeof(struct private_key_offload));
+    if (!offload) {
+        return S2N_FAILURE;
+    }
+
+    offload->allocator = s2n_handler->handler.alloc;
+    offload->s2n_handler = s2n_handler;
+    offload->op = op;
+    aws_task_init(&offload->perform_task, s_private_key_offload_perform_task, offload, "tls_private_key_offload");
+    aws_channel_task_init(
+        &offload->resume_task, s_private_key_offload_resume_task, offload, "tls_private_key_offload_resume");
+
+    struct s2n_ctx *s2n_ctx = s2n_handler->ctx->impl;
+    struct aws_event_loop *loop = aws_event_loop_group_get_next_loop(s2n_ctx->private_key_offload_elg);
+
+    aws_channel_acquire_hold(s2n_handler->slot->channel);
+    aws_event_loop_schedule_task_now(loop, &offload->perform_task);
+
+    return S2N_SUCCESS;
+}
+
+static void s_fail_queued_writes(struct s2n_handler *s2n_handler, int error_code) {
+    while (!aws_linked_list_empty(&s2n_handler->queued_writes)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&s2n_handler->queued_writes);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        if (message->on_completion) {
+            message->on_completion(s2n_handler->slot->channel, message, error_code, message->user_data);
+        }
+        aws_mem_release(message->allocator, message);
+    }
+}
+
+/* sends what was written during negotiation, in order, before anyone gets to react to the negotiation result. */
+static int s_flush_queued_writes(struct s2n_handler *s2n_handler) {
+    while (!aws_linked_list_empty(&s2n_handler->queued_writes)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&s2n_handler->queued_writes);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        if (s_s2n_handler_process_write_message(&s2n_handler->handler, s2n_handler->slot, message)) {
+            int error_code = aws_last_error();
+            aws_linked_list_push_front(&s2n_handler->queued_writes, &message->queueing_handle);
+            s_fail_queued_writes(s2n_handler, error_code);
+            return aws_raise_error(error_code);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_store_session(struct s2n_handler *s2n_handler) {
+    struct s2n_ctx *s2n_ctx = s2n_handler->ctx->impl;
+
+    int session_len = s2n_connection_get_session_length(s2n_handler->connection);
+    if (session_len <= 0) {
+        /* the server didn't hand out a ticket or session id. */
+        return;
+    }
+
+    struct aws_byte_buf session;
+    if (aws_byte_buf_init(&session, s2n_handler->handler.alloc, (size_t)session_len)) {
+        return;
+    }
+
+    int written = s2n_connection_get_session(s2n_handler->connection, session.buffer, session.capacity);
+    if (written > 0) {
+        session.len = (size_t)written;
+        if (aws_tls_session_cache_put(
+                &s2n_ctx->session_cache, s2n_handler->session_cache_key, aws_byte_cursor_from_buf(&session))) {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_TLS,
+                "id=%p: failed to cache session with error %s",
+                (void *)&s2n_handler->handler,
+                aws_error_name(aws_last_error()));
+        }
+    }
+
+    aws_byte_buf_clean_up_secure(&session);
+}
+
 static int s_drive_negotiation(struct aws_channel_handler *handler) {
     struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
 
@@ -357,6 +914,7 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
     s2n_blocked_status blocked = S2N_NOT_BLOCKED;
     do {
         int negotiation_code = s2n_negotiate(s2n_handler->connection, &blocked);
+        s_flush_pending_write_or_shut_down(s2n_handler);
 
         int s2n_error = s2n_errno;
         if (negotiation_code == S2N_ERR_T_OK) {
@@ -375,7 +933,16 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
                 s2n_handler->server_name = aws_byte_buf_from_c_str(server_name);
             }
 
-            if (s2n_handler->slot->adj_right && s2n_handler->advertise_alpn_message && protocol) {
+            if (s2n_handler->on_protocol_negotiated && protocol) {
+                if (aws_tls_install_negotiated_protocol_handler(
+                        s2n_handler->slot,
+                        &s2n_handler->protocol,
+                        s2n_handler->on_protocol_negotiated,
+                        s2n_handler->user_data)) {
+                    aws_channel_shutdown(s2n_handler->slot->channel, aws_last_error());
+                    return AWS_OP_SUCCESS;
+                }
+            } else if (s2n_handler->slot->adj_right && s2n_handler->advertise_alpn_message && protocol) {
                 struct aws_io_message *message = aws_channel_acquire_message_from_pool(
                     s2n_handler->slot->channel,
                     AWS_IO_MESSAGE_APPLICATION_DATA,
@@ -393,6 +960,19 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
                 }
             }
 
+            if (s2n_handler->session_cache_key) {
+                s_store_session(s2n_handler);
+            }
+
+#if defined(AWS_USE_KTLS)
+            s_try_enable_ktls_send(s2n_handler);
+#endif
+
+            if (s_flush_queued_writes(s2n_handler)) {
+                aws_channel_shutdown(s2n_handler->slot->channel, aws_last_error());
+                return AWS_OP_SUCCESS;
+            }
+
             s_on_negotiation_result(handler, s2n_handler->slot, AWS_OP_SUCCESS, s2n_handler->user_data);
 
             break;
@@ -417,6 +997,13 @@ static int s_drive_negotiation(struct aws_channel_handler *handler) {
             (void)err_str;
             s2n_handler->negotiation_finished = false;
 
+            if (s2n_handler->session_cache_key) {
+                /* don't make the next connection offer whatever we tried to resume with. */
+                struct s2n_ctx *s2n_ctx = s2n_handler->ctx->impl;
+                aws_tls_session_cache_remove(&s2n_ctx->session_cache, s2n_handler->session_cache_key);
+            }
+
+            s_fail_queued_writes(s2n_handler, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
             aws_raise_error(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
 
             s_on_negotiation_result(
@@ -454,6 +1041,17 @@ int aws_tls_client_handler_start_negotiation(struct aws_channel_handler *handler
     return AWS_OP_SUCCESS;
 }
 
+/*
+ * Gives s2n's record buffers back while the connection has nothing queued either way. s2n itself refuses while a
+ * buffer still holds part of a record, in which case the next read or write gets another go.
+ */
+static void s_release_idle_buffers(struct s2n_handler *s2n_handler) {
+    if (s2n_handler->release_idle_buffers && aws_linked_list_empty(&s2n_handler->input_queue) &&
+        !s2n_handler->input_chunk_count && !s2n_handler->pending_write) {
+        s2n_connection_release_buffers(s2n_handler->connection);
+    }
+}
+
 static int s_s2n_handler_process_read_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -492,12 +1090,15 @@ static int s_s2n_handler_process_read_message(
         if (!outgoing_read_message) {
             return AWS_OP_ERR;
         }
+        outgoing_read_message->is_sensitive = true;
 
         ssize_t read = s2n_recv(
             s2n_handler->connection,
             outgoing_read_message->message_data.buffer,
             outgoing_read_message->message_data.capacity,
             &blocked);
+        /* reading can make s2n answer, e.g. with an alert */
+        s_flush_pending_write_or_shut_down(s2n_handler);
 
         AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: Bytes read %lld", (void *)handler, (long long)read);
 
@@ -543,9 +1144,52 @@ static int s_s2n_handler_process_read_message(
         (void *)handler,
         (unsigned long long)downstream_window - processed);
 
+    if (blocked == S2N_BLOCKED_ON_READ) {
+        s_release_idle_buffers(s2n_handler);
+    }
+
     return AWS_OP_SUCCESS;
 }
 
+/* Encrypts an AWS_IO_MESSAGE_BORROWED_DATA message straight from its segments, filling whole records across segment
+ * boundaries. Returns how much went in, which is short of *payload_len if s2n didn't take all of it. */
+static ssize_t s_send_borrowed_segments(
+    struct s2n_handler *s2n_handler,
+    struct aws_io_message *message,
+    ssize_t *payload_len,
+    s2n_blocked_status *blocked) {
+
+    const struct aws_byte_cursor *segments = NULL;
+    size_t segment_count = aws_io_message_get_borrowed_segments(message, &segments);
+
+    *payload_len = 0;
+    for (size_t i = 0; i < segment_count; ++i) {
+        *payload_len += (ssize_t)segments[i].len;
+    }
+
+    ssize_t sent = 0;
+    struct iovec iovecs[MAX_BORROWED_SEND_IOVECS];
+    for (size_t i = 0; i < segment_count;) {
+        size_t chunk_count = aws_min_size(segment_count - i, MAX_BORROWED_SEND_IOVECS);
+        ssize_t chunk_len = 0;
+        for (size_t j = 0; j < chunk_count; ++j) {
+            iovecs[j].iov_base = segments[i + j].ptr;
+            iovecs[j].iov_len = segments[i + j].len;
+            chunk_len += (ssize_t)segments[i + j].len;
+        }
+
+        ssize_t written = s2n_sendv_with_offset(s2n_handler->connection, iovecs, (ssize_t)chunk_count, 0, blocked);
+        if (written < chunk_len) {
+            return written > 0 ? sent + written : sent;
+        }
+
+        sent += written;
+        i += chunk_count;
+    }
+
+    return sent;
+}
+
 static int s_s2n_handler_process_write_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -553,27 +1197,53 @@ static int s_s2n_handler_process_write_message(
     (void)slot;
     struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
 
+    /* whoever releases it, this message holds plaintext */
+    message->is_sensitive = true;
+
     if (AWS_UNLIKELY(!s2n_handler->negotiation_finished)) {
-        return aws_raise_error(AWS_IO_TLS_ERROR_NOT_NEGOTIATED);
+        if (!s2n_handler->queue_writes_before_negotiation) {
+            return aws_raise_error(AWS_IO_TLS_ERROR_NOT_NEGOTIATED);
+        }
+
+        aws_linked_list_push_back(&s2n_handler->queued_writes, &message->queueing_handle);
+        return AWS_OP_SUCCESS;
+    }
+
+#if defined(AWS_USE_KTLS)
+    s_try_enable_ktls_send(s2n_handler);
+    if (s2n_handler->ktls_send_enabled) {
+        /* the kernel encrypts it on the way out */
+        return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
     }
+#endif
 
     s2n_handler->latest_message_on_completion = message->on_completion;
     s2n_handler->latest_message_completion_user_data = message->user_data;
 
     s2n_blocked_status blocked;
-    ssize_t write_code =
-        s2n_send(s2n_handler->connection, message->message_data.buffer, (ssize_t)message->message_data.len, &blocked);
+    ssize_t message_len = (ssize_t)message->message_data.len;
+    ssize_t write_code = 0;
+    if (message->message_type == AWS_IO_MESSAGE_BORROWED_DATA) {
+        write_code = s_send_borrowed_segments(s2n_handler, message, &message_len, &blocked);
+    } else {
+        write_code = s2n_send(s2n_handler->connection, message->message_data.buffer, message_len, &blocked);
+    }
 
     AWS_LOGF_TRACE(AWS_LS_IO_TLS, "id=%p: Bytes written: %llu", (void *)handler, (unsigned long long)write_code);
 
-    ssize_t message_len = (ssize_t)message->message_data.len;
-
     if (write_code < message_len) {
+        /* the message goes back to its sender, so its completion must not fire from here as well */
+        s2n_handler->latest_message_on_completion = NULL;
+        s2n_handler->latest_message_completion_user_data = NULL;
+        s_flush_pending_write_or_shut_down(s2n_handler);
         return aws_raise_error(AWS_IO_TLS_ERROR_WRITE_FAILURE);
     }
 
+    /* the message is ours from here on, so a failure can't be returned to the sender */
     aws_mem_release(message->allocator, message);
+    s_flush_pending_write_or_shut_down(s2n_handler);
 
+    s_release_idle_buffers(s2n_handler);
     return AWS_OP_SUCCESS;
 }
 
@@ -586,12 +1256,23 @@ static int s_s2n_handler_shutdown(
     struct s2n_handler *s2n_handler = (struct s2n_handler *)handler->impl;
 
     if (dir == AWS_CHANNEL_DIR_WRITE) {
-        if (!abort_immediately && error_code != AWS_IO_SOCKET_CLOSED) {
+        bool send_close_notify = !abort_immediately && error_code != AWS_IO_SOCKET_CLOSED;
+#if defined(AWS_USE_KTLS)
+        /* with kernel TLS the alert goes straight to the socket, it must not overtake writes still queued there */
+        if (s2n_handler->ktls_send_enabled && slot->adj_left &&
+            aws_socket_handler_has_pending_writes(slot->adj_left->handler)) {
+            send_close_notify = false;
+        }
+#endif
+        if (send_close_notify) {
             AWS_LOGF_DEBUG(AWS_LS_IO_TLS, "id=%p: Shutting down write direction", (void *)handler)
             s2n_blocked_status blocked;
             /* make a best effort, but the channel is going away after this run, so.... you only get one shot anyways */
             s2n_shutdown(s2n_handler->connection, &blocked);
+            s_flush_pending_write_or_shut_down(s2n_handler);
         }
+
+        s_fail_queued_writes(s2n_handler, error_code ? error_code : AWS_IO_TLS_ERROR_NOT_NEGOTIATED);
     } else {
         AWS_LOGF_DEBUG(
             AWS_LS_IO_TLS, "id=%p: Shutting down read direction with error code %d", (void *)handler, error_code);
@@ -601,6 +1282,10 @@ static int s_s2n_handler_shutdown(
             struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
             aws_mem_release(message->allocator, message);
         }
+
+        while (s2n_handler->input_chunk_count) {
+            s_pop_input_chunk(s2n_handler);
+        }
     }
 
     return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, abort_immediately);
@@ -660,7 +1345,13 @@ static int s_s2n_handler_increment_read_window(
 }
 
 static size_t s_s2n_handler_message_overhead(struct aws_channel_handler *handler) {
-    (void)handler;
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    /* record framing is added in the kernel, past the socket handler's messages */
+    if (s2n_handler->ktls_send_enabled) {
+        return 0;
+    }
+
     return EST_TLS_RECORD_OVERHEAD;
 }
 
@@ -693,6 +1384,113 @@ struct aws_byte_buf aws_tls_handler_server_name(struct aws_channel_handler *hand
     return s2n_handler->server_name;
 }
 
+/* queues everything a single socket read produced before decrypting, so s2n works through it in one pass */
+static int s_s2n_handler_process_read_messages(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_linked_list *messages) {
+
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    size_t total_len = 0;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(messages); node != aws_linked_list_end(messages);
+         node = aws_linked_list_next(node)) {
+        total_len += AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle)->message_data.len;
+    }
+    aws_linked_list_move_all_back(&s2n_handler->input_queue, messages);
+
+    if (!s2n_handler->negotiation_finished) {
+        if (!s_drive_negotiation(handler)) {
+            aws_channel_slot_increment_read_window(slot, total_len);
+        } else {
+            aws_channel_shutdown(s2n_handler->slot->channel, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_s2n_handler_process_read_message(handler, slot, NULL);
+}
+
+/* lends the socket handler a stretch of the input ring to read ciphertext into, see
+ * aws_tls_ctx_options.input_ring_size. Reads come as messages instead while the ring is full or messages are already
+ * queued ahead of it. */
+static void s_s2n_handler_acquire_read_buffer(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t max_size,
+    struct aws_byte_buf *out_buffer) {
+    (void)slot;
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    if (!s2n_handler->input_ring.allocation || !aws_linked_list_empty(&s2n_handler->input_queue) ||
+        s2n_handler->input_chunk_count == MAX_INPUT_RING_CHUNKS) {
+        return;
+    }
+
+    size_t minimum_size = aws_min_size(max_size, MIN_INPUT_RING_CHUNK_SIZE);
+    if (aws_ring_buffer_acquire_up_to(
+            &s2n_handler->input_ring, minimum_size, max_size, &s2n_handler->input_chunk_acquired)) {
+        return;
+    }
+
+    *out_buffer = s2n_handler->input_chunk_acquired;
+}
+
+static int s_s2n_handler_read_buffer_filled(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t bytes_read) {
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    size_t index = (s2n_handler->input_chunk_start + s2n_handler->input_chunk_count) % MAX_INPUT_RING_CHUNKS;
+    s2n_handler->input_chunks[index] = s2n_handler->input_chunk_acquired;
+    s2n_handler->input_chunks[index].len = bytes_read;
+    AWS_ZERO_STRUCT(s2n_handler->input_chunk_acquired);
+    ++s2n_handler->input_chunk_count;
+
+    if (!bytes_read) {
+        /* nothing to decrypt. The chunk still goes back to the ring in order, right away if nothing is ahead of it */
+        if (s2n_handler->input_chunk_count == 1) {
+            s_pop_input_chunk(s2n_handler);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    if (!s2n_handler->negotiation_finished) {
+        if (!s_drive_negotiation(handler)) {
+            aws_channel_slot_increment_read_window(slot, bytes_read);
+        } else {
+            aws_channel_shutdown(s2n_handler->slot->channel, AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE);
+        }
+        return AWS_OP_SUCCESS;
+    }
+
+    return s_s2n_handler_process_read_message(handler, slot, NULL);
+}
+
+static int s_s2n_tls_channel_handler_schedule_thread_local_cleanup(struct aws_channel_slot *slot);
+
+static int s_s2n_handler_leave_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct s2n_handler *s2n_handler = handler->impl;
+
+    /* those messages came from the old loop's pool */
+    if (!aws_linked_list_empty(&s2n_handler->input_queue)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_TLS, "id=%p: can't leave the event loop with buffered input still to decrypt", (void *)handler);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_s2n_handler_join_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)handler;
+
+    /* s2n's thread-local state on the new loop's thread needs cleaning up too */
+    return s_s2n_tls_channel_handler_schedule_thread_local_cleanup(slot);
+}
+
 static struct aws_channel_handler_vtable s_handler_vtable = {
     .destroy = s_s2n_handler_destroy,
     .process_read_message = s_s2n_handler_process_read_message,
@@ -703,6 +1501,11 @@ static struct aws_channel_handler_vtable s_handler_vtable = {
     .message_overhead = s_s2n_handler_message_overhead,
     .reset_statistics = s_s2n_handler_reset_statistics,
     .gather_statistics = s_s2n_handler_gather_statistics,
+    .process_read_messages = s_s2n_handler_process_read_messages,
+    .leave_event_loop = s_s2n_handler_leave_event_loop,
+    .join_event_loop = s_s2n_handler_join_event_loop,
+    .acquire_read_buffer = s_s2n_handler_acquire_read_buffer,
+    .read_buffer_filled = s_s2n_handler_read_buffer_filled,
 };
 
 static int s_parse_protocol_preferences(
@@ -745,13 +1548,11 @@ static int s_parse_protocol_preferences(
     return AWS_OP_SUCCESS;
 }
 
-static size_t s_tl_cleanup_key = 0; /* Address of variable serves as key in hash table */
-
 /*
- * This local object is added to the table of every event loop that has a (s2n) tls connection
+ * This local object is put in the reserved slot of every event loop that has a (s2n) tls connection
  * added to it at some point in time
  */
-static struct aws_event_loop_local_object s_tl_cleanup_object = {.key = &s_tl_cleanup_key,
+static struct aws_event_loop_local_object s_tl_cleanup_object = {.key = NULL,
                                                                  .object = NULL,
                                                                  .on_object_removed = NULL};
 
@@ -765,17 +1566,14 @@ static void s_aws_cleanup_s2n_thread_local_state(void *user_data) {
 static int s_s2n_tls_channel_handler_schedule_thread_local_cleanup(struct aws_channel_slot *slot) {
     struct aws_channel *channel = slot->channel;
 
-    struct aws_event_loop_local_object existing_marker;
-    AWS_ZERO_STRUCT(existing_marker);
+    struct aws_event_loop *event_loop = aws_channel_get_event_loop(channel);
 
     /*
      * Check whether another s2n_tls_channel_handler has already scheduled the cleanup task.
      */
-    if (aws_channel_fetch_local_object(channel, &s_tl_cleanup_key, &existing_marker)) {
-        /* Doesn't exist in event loop table: add it and add the at-exit cleanup callback */
-        if (aws_channel_put_local_object(channel, &s_tl_cleanup_key, &s_tl_cleanup_object)) {
-            return AWS_OP_ERR;
-        }
+    if (!aws_event_loop_get_local_slot(event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_TLS_THREAD_CLEANUP)) {
+        /* Not marked on this event loop yet: mark it and add the at-exit cleanup callback */
+        aws_event_loop_set_local_slot(event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_TLS_THREAD_CLEANUP, &s_tl_cleanup_object);
 
         aws_thread_current_at_exit(s_aws_cleanup_s2n_thread_local_state, NULL);
     }
@@ -783,6 +1581,43 @@ static int s_s2n_tls_channel_handler_schedule_thread_local_cleanup(struct aws_ch
     return AWS_OP_SUCCESS;
 }
 
+static int s_setup_session_resumption(struct s2n_handler *s2n_handler, struct aws_tls_connection_options *options) {
+    struct s2n_ctx *s2n_ctx = options->ctx->impl;
+
+    s2n_handler->session_cache_key =
+        aws_tls_session_cache_key_new(s2n_handler->handler.alloc, options->server_name, options->server_port);
+    if (!s2n_handler->session_cache_key) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_buf session;
+    if (aws_byte_buf_init(&session, s2n_handler->handler.alloc, 0)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = aws_tls_session_cache_get(&s2n_ctx->session_cache, s2n_handler->session_cache_key, &session);
+    if (result == AWS_OP_SUCCESS && session.len) {
+        if (s2n_connection_set_session(s2n_handler->connection, session.buffer, session.len)) {
+            /* not fatal, we just do a full handshake. */
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_TLS,
+                "id=%p: cached session was rejected: %s",
+                (void *)&s2n_handler->handler,
+                s2n_strerror(s2n_errno, "EN"));
+            aws_tls_session_cache_remove(&s2n_ctx->session_cache, s2n_handler->session_cache_key);
+        } else {
+            AWS_LOGF_DEBUG(
+                AWS_LS_IO_TLS,
+                "id=%p: offering cached session for %s",
+                (void *)&s2n_handler->handler,
+                aws_string_c_str(s2n_handler->session_cache_key));
+        }
+    }
+
+    aws_byte_buf_clean_up_secure(&session);
+    return result;
+}
+
 static struct aws_channel_handler *s_new_tls_handler(
     struct aws_allocator *allocator,
     struct aws_tls_connection_options *options,
@@ -796,7 +1631,9 @@ static struct aws_channel_handler *s_new_tls_handler(
     }
 
     struct s2n_ctx *s2n_ctx = (struct s2n_ctx *)options->ctx->impl;
-    s2n_handler->connection = s2n_connection_new(mode);
+    s2n_handler->ctx = aws_tls_ctx_acquire(options->ctx);
+    s2n_handler->slot = slot;
+    s2n_handler->connection = s_acquire_connection(s2n_handler, mode);
 
     if (!s2n_handler->connection) {
         goto cleanup_s2n_handler;
@@ -813,11 +1650,14 @@ static struct aws_channel_handler *s_new_tls_handler(
     s2n_handler->on_error = options->on_error;
     s2n_handler->on_negotiation_result = options->on_negotiation_result;
     s2n_handler->advertise_alpn_message = options->advertise_alpn_message;
+    s2n_handler->on_protocol_negotiated = options->on_protocol_negotiated;
 
     s2n_handler->latest_message_completion_user_data = NULL;
     s2n_handler->latest_message_on_completion = NULL;
     s2n_handler->slot = slot;
     aws_linked_list_init(&s2n_handler->input_queue);
+    aws_linked_list_init(&s2n_handler->queued_writes);
+    s2n_handler->queue_writes_before_negotiation = options->queue_writes_before_negotiation;
 
     s2n_handler->protocol = aws_byte_buf_from_array(NULL, 0);
 
@@ -830,12 +1670,44 @@ static struct aws_channel_handler *s_new_tls_handler(
     }
 
     s2n_handler->negotiation_finished = false;
+    s2n_handler->ktls_requested = s2n_ctx->enable_ktls;
+    s2n_handler->ktls_send_enabled = false;
+    s2n_handler->release_idle_buffers = s2n_ctx->release_idle_buffers;
+
+    if (s2n_ctx->input_ring_size &&
+        aws_ring_buffer_init(&s2n_handler->input_ring, allocator, s2n_ctx->input_ring_size)) {
+        goto cleanup_conn;
+    }
 
     s2n_connection_set_recv_cb(s2n_handler->connection, s_s2n_handler_recv);
     s2n_connection_set_recv_ctx(s2n_handler->connection, s2n_handler);
     s2n_connection_set_send_cb(s2n_handler->connection, s_s2n_handler_send);
     s2n_connection_set_send_ctx(s2n_handler->connection, s2n_handler);
     s2n_connection_set_blinding(s2n_handler->connection, S2N_SELF_SERVICE_BLINDING);
+    s2n_connection_set_ctx(s2n_handler->connection, s2n_handler);
+
+    if (options->dynamic_record_threshold) {
+        AWS_LOGF_DEBUG(
+            AWS_LS_IO_TLS,
+            "id=%p: Using small records for the first %" PRIu32 " bytes, reset after %" PRIu16 "s idle",
+            (void *)&s2n_handler->handler,
+            options->dynamic_record_threshold,
+            options->dynamic_record_reset_timeout_secs);
+
+        if (s2n_connection_set_dynamic_record_threshold(
+                s2n_handler->connection,
+                options->dynamic_record_threshold,
+                options->dynamic_record_reset_timeout_secs)) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_TLS,
+                "id=%p: dynamic record sizing error %s (%s)",
+                (void *)&s2n_handler->handler,
+                s2n_strerror(s2n_errno, "EN"),
+                s2n_strerror_debug(s2n_errno, "EN"));
+            aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+            goto cleanup_conn;
+        }
+    }
 
     if (options->alpn_list) {
         AWS_LOGF_DEBUG(
@@ -876,6 +1748,12 @@ static struct aws_channel_handler *s_new_tls_handler(
         goto cleanup_conn;
     }
 
+    if (mode == S2N_CLIENT && s2n_ctx->session_cache_enabled && options->server_name) {
+        if (s_setup_session_resumption(s2n_handler, options)) {
+            goto cleanup_conn;
+        }
+    }
+
     if (s_s2n_tls_channel_handler_schedule_thread_local_cleanup(slot)) {
         goto cleanup_conn;
     }
@@ -883,9 +1761,14 @@ static struct aws_channel_handler *s_new_tls_handler(
     return &s2n_handler->handler;
 
 cleanup_conn:
+    if (s2n_handler->input_ring.allocation) {
+        aws_ring_buffer_clean_up(&s2n_handler->input_ring);
+    }
+    aws_string_destroy(s2n_handler->session_cache_key);
     s2n_connection_free(s2n_handler->connection);
 
 cleanup_s2n_handler:
+    aws_tls_ctx_release(s2n_handler->ctx);
     aws_mem_release(allocator, s2n_handler);
 
     return NULL;
@@ -909,11 +1792,75 @@ struct aws_channel_handler *aws_tls_server_handler_new(
 
 static void s_s2n_ctx_destroy(struct s2n_ctx *s2n_ctx) {
     if (s2n_ctx != NULL) {
+        /* pooled connections point at the config, so they go first */
+        s_connection_pools_release_from_ctx(s2n_ctx->connection_pools);
         s2n_config_free(s2n_ctx->s2n_config);
+        if (s2n_ctx->cert_chain_and_key) {
+            s2n_cert_chain_and_key_free(s2n_ctx->cert_chain_and_key);
+        }
+        if (s2n_ctx->private_key_offload_elg) {
+            aws_event_loop_group_release(s2n_ctx->private_key_offload_elg);
+        }
+        aws_tls_session_cache_clean_up(&s2n_ctx->session_cache);
         aws_mem_release(s2n_ctx->ctx.alloc, s2n_ctx);
     }
 }
 
+/*
+ * s2n encrypts new tickets with the newest key whose intro time has passed and keeps it around for decrypting for
+ * the decrypt lifetime after that. Scheduling a run of random keys, one per period, is what rotates them.
+ */
+static int s_setup_session_ticket_keys(struct s2n_config *config, uint32_t rotation_secs) {
+    uint64_t now_ns = 0;
+    if (aws_sys_clock_get_ticks(&now_ns)) {
+        return AWS_OP_ERR;
+    }
+    uint64_t now_secs = aws_timestamp_convert(now_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_SECS, NULL);
+
+    if (s2n_config_set_session_tickets_onoff(config, 1) ||
+        s2n_config_set_ticket_encrypt_decrypt_key_lifetime(config, rotation_secs) ||
+        s2n_config_set_ticket_decrypt_key_lifetime(config, rotation_secs)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_TLS,
+            "ctx: failed to enable session tickets %s (%s)",
+            s2n_strerror(s2n_errno, "EN"),
+            s2n_strerror_debug(s2n_errno, "EN"));
+        return aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+    }
+
+    int result = AWS_OP_SUCCESS;
+    uint8_t key_data[32];
+    for (uint32_t i = 0; i < AWS_TLS_SESSION_TICKET_KEY_COUNT; ++i) {
+        struct aws_byte_buf key_buf = aws_byte_buf_from_empty_array(key_data, sizeof(key_data));
+        if (aws_device_random_buffer(&key_buf)) {
+            result = AWS_OP_ERR;
+            break;
+        }
+
+        char key_name[16];
+        int key_name_len = snprintf(key_name, sizeof(key_name), "aws-key-%" PRIu32, i);
+
+        if (s2n_config_add_ticket_crypto_key(
+                config,
+                (const uint8_t *)key_name,
+                (uint32_t)key_name_len,
+                key_data,
+                sizeof(key_data),
+                now_secs + (uint64_t)i * rotation_secs)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_TLS,
+                "ctx: failed to add session ticket key %s (%s)",
+                s2n_strerror(s2n_errno, "EN"),
+                s2n_strerror_debug(s2n_errno, "EN"));
+            result = aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            break;
+        }
+    }
+
+    aws_secure_zero(key_data, sizeof(key_data));
+    return result;
+}
+
 static struct aws_tls_ctx *s_tls_ctx_new(
     struct aws_allocator *alloc,
     const struct aws_tls_ctx_options *options,
@@ -939,6 +1886,15 @@ static struct aws_tls_ctx *s_tls_ctx_new(
         goto cleanup_s2n_ctx;
     }
 
+    s2n_ctx->enable_ktls = options->enable_ktls;
+    s2n_ctx->release_idle_buffers = options->release_idle_buffers;
+    s2n_ctx->input_ring_size = options->input_ring_size;
+#if !defined(AWS_USE_KTLS)
+    if (options->enable_ktls) {
+        AWS_LOGF_INFO(AWS_LS_IO_TLS, "static: kernel TLS was requested, but this build doesn't support it.");
+    }
+#endif
+
     switch (options->minimum_tls_version) {
         case AWS_IO_SSLv3:
             s2n_config_set_cipher_preferences(s2n_ctx->s2n_config, "CloudFront-SSL-v-3");
@@ -1002,8 +1958,16 @@ static struct aws_tls_ctx *s_tls_ctx_new(
             goto cleanup_s2n_ctx;
         }
 
-        int err_code = s2n_config_add_cert_chain_and_key(
-            s2n_ctx->s2n_config, (const char *)options->certificate.buffer, (const char *)options->private_key.buffer);
+        /* kept by the ctx rather than the config, offloaded private key operations need to get at the key */
+        s2n_ctx->cert_chain_and_key = s2n_cert_chain_and_key_new();
+        int err_code = S2N_FAILURE;
+        if (s2n_ctx->cert_chain_and_key &&
+            s2n_cert_chain_and_key_load_pem(
+                s2n_ctx->cert_chain_and_key,
+                (const char *)options->certificate.buffer,
+                (const char *)options->private_key.buffer) == S2N_SUCCESS) {
+            err_code = s2n_config_add_cert_chain_and_key_to_store(s2n_ctx->s2n_config, s2n_ctx->cert_chain_and_key);
+        }
 
         if (mode == S2N_CLIENT) {
             s2n_config_set_client_auth_type(s2n_ctx->s2n_config, S2N_CERT_AUTH_REQUIRED);
@@ -1138,10 +2102,54 @@ static struct aws_tls_ctx *s_tls_ctx_new(
         s2n_config_send_max_fragment_length(s2n_ctx->s2n_config, S2N_TLS_MAX_FRAG_LEN_4096);
     }
 
+    if (mode == S2N_CLIENT && options->session_cache_max_entries) {
+        if (s2n_config_set_session_tickets_onoff(s2n_ctx->s2n_config, 1)) {
+            aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            goto cleanup_s2n_config;
+        }
+
+        if (aws_tls_session_cache_init(
+                &s2n_ctx->session_cache, alloc, options->session_cache_max_entries, options->session_cache_ttl_secs)) {
+            goto cleanup_s2n_config;
+        }
+        s2n_ctx->session_cache_enabled = true;
+    }
+
+    if (mode == S2N_SERVER && options->session_ticket_key_rotation_secs) {
+        if (s_setup_session_ticket_keys(s2n_ctx->s2n_config, options->session_ticket_key_rotation_secs)) {
+            goto cleanup_s2n_config;
+        }
+    }
+
+    if (options->private_key_offload_elg && s2n_ctx->cert_chain_and_key) {
+        if (s2n_config_set_async_pkey_callback(s2n_ctx->s2n_config, s_async_pkey_callback)) {
+            AWS_LOGF_ERROR(
+                AWS_LS_IO_TLS,
+                "ctx: failed to enable private key offload %s (%s)",
+                s2n_strerror(s2n_errno, "EN"),
+                s2n_strerror_debug(s2n_errno, "EN"));
+            aws_raise_error(AWS_IO_TLS_CTX_ERROR);
+            goto cleanup_s2n_config;
+        }
+        s2n_ctx->private_key_offload_elg = aws_event_loop_group_acquire(options->private_key_offload_elg);
+    }
+
+    if (options->connection_pool_size) {
+        s2n_ctx->connection_pools = s_connection_pools_new(alloc, options->connection_pool_size);
+        if (!s2n_ctx->connection_pools) {
+            aws_event_loop_group_release(s2n_ctx->private_key_offload_elg);
+            aws_tls_session_cache_clean_up(&s2n_ctx->session_cache);
+            goto cleanup_s2n_config;
+        }
+    }
+
     return &s2n_ctx->ctx;
 
 cleanup_s2n_config:
     s2n_config_free(s2n_ctx->s2n_config);
+    if (s2n_ctx->cert_chain_and_key) {
+        s2n_cert_chain_and_key_free(s2n_ctx->cert_chain_and_key);
+    }
 
 cleanup_s2n_ctx:
     aws_mem_release(alloc, s2n_ctx);
@@ -4,11 +4,16 @@
  */
 #include <aws/io/socket_channel_handler.h>
 
+#include <aws/common/clock.h>
 #include <aws/common/error.h>
+#include <aws/common/linked_list.h>
+#include <aws/common/math.h>
 #include <aws/common/task_scheduler.h>
 
+#include <aws/io/channel.h>
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/hot_path_logging.h>
 #include <aws/io/socket.h>
 #include <aws/io/statistics.h>
 
@@ -16,17 +21,125 @@
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
 #endif
 
+enum {
+    /* most pooled messages filled by a single vectored socket read. */
+    MAX_MESSAGES_PER_READ = 8,
+};
+
+/* quarters of max_rw_size a socket handler reads per turn, by its channel's read priority */
+static const size_t s_read_quantum_quarters[] = {
+    [AWS_CHANNEL_READ_PRIORITY_NORMAL] = 4,
+    [AWS_CHANNEL_READ_PRIORITY_HIGH] = 16,
+    [AWS_CHANNEL_READ_PRIORITY_LOW] = 1,
+};
+
+/*
+ * One per event loop, made the first time one of its socket handlers has more to read than it may read at once. Such
+ * handlers get in line here instead of each scheduling its own re-read, and once per tick they take turns reading a
+ * quantum weighted by their channel's read priority, until g_aws_channel_read_budget_per_tick is spent. This is
+ * deficit round robin, except that a socket read can stop at any byte, so a turn either spends its whole quantum or
+ * empties the socket and nothing is ever left to carry over.
+ */
+struct socket_read_scheduler {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
+    struct aws_event_loop_local_object local_object;
+    struct aws_linked_list waiting_handlers;
+    struct aws_task serve_task;
+    bool serve_task_scheduled;
+};
+
 struct socket_handler {
     struct aws_socket *socket;
     struct aws_channel_slot *slot;
     size_t max_rw_size;
     struct aws_channel_task read_task_storage;
     struct aws_channel_task shutdown_task_storage;
+    struct aws_channel_task idle_task_storage;
+    struct aws_channel_task uncork_task_storage;
     struct aws_crt_statistics_socket stats;
+    /* in the loop's socket_read_scheduler.waiting_handlers while read_turn_queued is set */
+    struct aws_linked_list_node read_turn_node;
+    size_t pending_write_count;
+    /* 0 if idle connections are left alone */
+    uint64_t idle_timeout_ns;
+    /* when data last went through the socket, only kept up to date while idle_timeout_ns is set */
+    uint64_t last_activity_ns;
+    /* 0 if every write goes straight to the socket */
+    size_t write_coalescing_threshold;
+    /* written since the socket was last corked */
+    size_t corked_bytes;
+    /* cleared once it's been invoked */
+    aws_socket_handler_on_first_read_fn *on_first_read;
+    void *on_first_read_user_data;
     int shutdown_err_code;
     bool shutdown_in_progress;
+    bool idle_task_scheduled;
+    bool writes_corked;
+    bool uncork_task_scheduled;
+    bool read_turn_queued;
+    bool trace_logging_enabled;
 };
 
+/* A single clock read, and only with an idle timeout set. The idle task compares against this when it fires rather
+ * than being rescheduled on every read and write. */
+static void s_note_activity(struct socket_handler *socket_handler) {
+    if (socket_handler->idle_timeout_ns) {
+        aws_channel_current_clock_time(socket_handler->slot->channel, &socket_handler->last_activity_ns);
+    }
+}
+
+static void s_uncork_writes(struct socket_handler *socket_handler) {
+    if (!socket_handler->writes_corked) {
+        return;
+    }
+
+    socket_handler->writes_corked = false;
+    socket_handler->corked_bytes = 0;
+    aws_socket_uncork_writes(socket_handler->socket);
+}
+
+static void s_uncork_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct socket_handler *socket_handler = arg;
+    socket_handler->uncork_task_scheduled = false;
+
+    /* a cancelled task comes after shutdown, which has already sent whatever was held back. */
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        s_uncork_writes(socket_handler);
+    }
+}
+
+/* The first write of a tick corks the socket and schedules a task to uncork it once the tick's other tasks and events
+ * have run, so everything written in between leaves in one go. */
+static void s_cork_writes(struct socket_handler *socket_handler) {
+    if (!socket_handler->write_coalescing_threshold || socket_handler->writes_corked) {
+        return;
+    }
+
+    aws_socket_cork_writes(socket_handler->socket);
+    socket_handler->writes_corked = true;
+
+    if (!socket_handler->uncork_task_scheduled) {
+        aws_channel_task_init(
+            &socket_handler->uncork_task_storage, s_uncork_task, socket_handler, "socket_handler_uncork");
+        socket_handler->uncork_task_scheduled = true;
+        aws_channel_schedule_task_now(socket_handler->slot->channel, &socket_handler->uncork_task_storage);
+    }
+}
+
+/* doesn't wait for the end of the tick once enough is held back to fill a big write anyway. */
+static void s_note_corked_write(struct socket_handler *socket_handler, size_t size) {
+    if (!socket_handler->writes_corked) {
+        return;
+    }
+
+    socket_handler->corked_bytes = aws_add_size_saturating(socket_handler->corked_bytes, size);
+    if (socket_handler->corked_bytes >= socket_handler->write_coalescing_threshold) {
+        s_uncork_writes(socket_handler);
+    }
+}
+
 static int s_socket_process_read_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -57,11 +170,6 @@ static void s_on_socket_write_complete(
     if (user_data) {
         struct aws_io_message *message = user_data;
         struct aws_channel *channel = message->owning_channel;
-        AWS_LOGF_TRACE(
-            AWS_LS_IO_SOCKET_HANDLER,
-            "static: write of size %llu, completed on channel %p",
-            (unsigned long long)amount_written,
-            (void *)channel);
 
         if (message->on_completion) {
             message->on_completion(channel, message, error_code, message->user_data);
@@ -69,7 +177,14 @@ static void s_on_socket_write_complete(
 
         if (socket && socket->handler) {
             struct socket_handler *socket_handler = socket->handler->impl;
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_handler->trace_logging_enabled,
+                AWS_LS_IO_SOCKET_HANDLER,
+                "static: write of size %llu, completed on channel %p",
+                (unsigned long long)amount_written,
+                (void *)channel);
             socket_handler->stats.bytes_written += amount_written;
+            socket_handler->pending_write_count--;
         }
 
         aws_mem_release(message->allocator, message);
@@ -80,6 +195,65 @@ static void s_on_socket_write_complete(
     }
 }
 
+/* completion of a borrowed message's segment other than its last, which carries the message itself. */
+static void s_on_borrowed_segment_written(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)error_code;
+    (void)user_data;
+
+    if (socket && socket->handler) {
+        struct socket_handler *socket_handler = socket->handler->impl;
+        socket_handler->stats.bytes_written += amount_written;
+    }
+}
+
+/*
+ * Each segment becomes its own socket write, which the socket gathers with whatever else is queued into as few
+ * system calls as it can. Writes complete in order, so the message completes with its last segment.
+ */
+static int s_socket_write_borrowed_message(struct socket_handler *socket_handler, struct aws_io_message *message) {
+    const struct aws_byte_cursor *segments = NULL;
+    size_t segment_count = aws_io_message_get_borrowed_segments(message, &segments);
+    if (!segment_count) {
+        /* nothing to send, but the sender still expects completion */
+        s_on_socket_write_complete(NULL, AWS_OP_SUCCESS, 0, message);
+        return AWS_OP_SUCCESS;
+    }
+
+    s_cork_writes(socket_handler);
+    socket_handler->pending_write_count++;
+    for (size_t i = 0; i < segment_count; ++i) {
+        bool last = i + 1 == segment_count;
+        if (aws_socket_write(
+                socket_handler->socket,
+                &segments[i],
+                last ? s_on_socket_write_complete : s_on_borrowed_segment_written,
+                last ? message : NULL)) {
+            socket_handler->pending_write_count--;
+            if (i > 0) {
+                /* the queued segments still point at buffers the sender may reuse once this fails. Closing the
+                 * socket completes them now; the channel can't carry on without them anyway. */
+                int error_code = aws_last_error();
+                aws_socket_close(socket_handler->socket);
+                aws_channel_shutdown(socket_handler->slot->channel, error_code);
+                aws_raise_error(error_code);
+            }
+            return AWS_OP_ERR;
+        }
+    }
+
+    size_t size = 0;
+    for (size_t i = 0; i < segment_count; ++i) {
+        size = aws_add_size_saturating(size, segments[i].len);
+    }
+    s_note_corked_write(socket_handler, size);
+
+    return AWS_OP_SUCCESS;
+}
+
 static int s_socket_process_write_message(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -87,7 +261,8 @@ static int s_socket_process_write_message(
     (void)slot;
     struct socket_handler *socket_handler = handler->impl;
 
-    AWS_LOGF_TRACE(
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_handler->trace_logging_enabled,
         AWS_LS_IO_SOCKET_HANDLER,
         "id=%p: writing message of size %llu",
         (void *)handler,
@@ -97,36 +272,174 @@ static int s_socket_process_write_message(
         return aws_raise_error(AWS_IO_SOCKET_CLOSED);
     }
 
+    s_note_activity(socket_handler);
+
+    if (message->message_type == AWS_IO_MESSAGE_BORROWED_DATA) {
+        return s_socket_write_borrowed_message(socket_handler, message);
+    }
+
     struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&message->message_data);
+    s_cork_writes(socket_handler);
+    /* counted first, since the write can complete before aws_socket_write() returns. */
+    socket_handler->pending_write_count++;
     if (aws_socket_write(socket_handler->socket, &cursor, s_on_socket_write_complete, message)) {
+        socket_handler->pending_write_count--;
         return AWS_OP_ERR;
     }
 
+    s_note_corked_write(socket_handler, cursor.len);
     return AWS_OP_SUCCESS;
 }
 
+static void s_release_messages(struct aws_io_message **messages, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        aws_mem_release(messages[i]->allocator, messages[i]);
+    }
+}
+
 static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_status status);
 
 static void s_on_readable_notification(struct aws_socket *socket, int error_code, void *user_data);
 
+static size_t s_do_read(struct socket_handler *socket_handler, size_t max_read);
+
+static void s_on_read_scheduler_removed(struct aws_event_loop_local_object *object) {
+    struct socket_read_scheduler *scheduler = object->object;
+    aws_mem_release(scheduler->allocator, scheduler);
+}
+
+static size_t s_read_quantum(struct socket_handler *socket_handler) {
+    enum aws_channel_read_priority read_priority = aws_channel_get_read_priority(socket_handler->slot->channel);
+    size_t quarters = (size_t)read_priority < AWS_ARRAY_SIZE(s_read_quantum_quarters)
+                          ? s_read_quantum_quarters[read_priority]
+                          : s_read_quantum_quarters[AWS_CHANNEL_READ_PRIORITY_NORMAL];
+
+    size_t quantum = aws_mul_size_saturating(socket_handler->max_rw_size / 4, quarters);
+    return quantum ? quantum : 1;
+}
+
+static void s_read_scheduler_serve_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct socket_read_scheduler *scheduler = arg;
+    scheduler->serve_task_scheduled = false;
+
+    /* the loop is going away, and its channels, with their handlers, are already gone */
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        return;
+    }
+
+    /* handlers that get back in line during this tick wait behind everyone that was already waiting */
+    struct aws_linked_list serving;
+    aws_linked_list_init(&serving);
+    aws_linked_list_swap_contents(&serving, &scheduler->waiting_handlers);
+
+    size_t budget_spent = 0;
+    while (!aws_linked_list_empty(&serving)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&serving);
+        struct socket_handler *socket_handler = AWS_CONTAINER_OF(node, struct socket_handler, read_turn_node);
+        socket_handler->read_turn_queued = false;
+
+        budget_spent += s_do_read(socket_handler, s_read_quantum(socket_handler));
+        if (budget_spent >= g_aws_channel_read_budget_per_tick) {
+            break;
+        }
+    }
+
+    /* the ones that missed out on this tick go first on the next */
+    aws_linked_list_move_all_back(&serving, &scheduler->waiting_handlers);
+    aws_linked_list_swap_contents(&serving, &scheduler->waiting_handlers);
+
+    if (!aws_linked_list_empty(&scheduler->waiting_handlers) && !scheduler->serve_task_scheduled) {
+        scheduler->serve_task_scheduled = true;
+        aws_event_loop_schedule_task_now(scheduler->event_loop, &scheduler->serve_task);
+    }
+}
+
+static struct socket_read_scheduler *s_get_read_scheduler(struct aws_event_loop *event_loop) {
+    struct aws_event_loop_local_object *local_object =
+        aws_event_loop_get_local_slot(event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_SOCKET_READ_SCHEDULER);
+    if (local_object) {
+        return local_object->object;
+    }
+
+    struct socket_read_scheduler *scheduler =
+        aws_mem_calloc(event_loop->alloc, 1, sizeof(struct socket_read_scheduler));
+    if (!scheduler) {
+        return NULL;
+    }
+
+    scheduler->allocator = event_loop->alloc;
+    scheduler->event_loop = event_loop;
+    scheduler->local_object.object = scheduler;
+    scheduler->local_object.on_object_removed = s_on_read_scheduler_removed;
+    aws_linked_list_init(&scheduler->waiting_handlers);
+    aws_task_init(&scheduler->serve_task, s_read_scheduler_serve_task, scheduler, "socket_read_scheduler_serve");
+    aws_event_loop_set_local_slot(
+        event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_SOCKET_READ_SCHEDULER, &scheduler->local_object);
+
+    return scheduler;
+}
+
+static void s_queue_read_turn(struct socket_handler *socket_handler) {
+    if (socket_handler->read_turn_queued) {
+        return;
+    }
+
+    struct socket_read_scheduler *scheduler =
+        s_get_read_scheduler(aws_channel_get_event_loop(socket_handler->slot->channel));
+    if (!scheduler) {
+        /* no scheduler to wait on, so just come back on the next tick */
+        aws_channel_task_init(
+            &socket_handler->read_task_storage, s_read_task, socket_handler, "socket_handler_re_read");
+        aws_channel_schedule_task_now(socket_handler->slot->channel, &socket_handler->read_task_storage);
+        return;
+    }
+
+    aws_linked_list_push_back(&scheduler->waiting_handlers, &socket_handler->read_turn_node);
+    socket_handler->read_turn_queued = true;
+
+    if (!scheduler->serve_task_scheduled) {
+        scheduler->serve_task_scheduled = true;
+        aws_event_loop_schedule_task_now(scheduler->event_loop, &scheduler->serve_task);
+    }
+}
+
+static void s_dequeue_read_turn(struct socket_handler *socket_handler) {
+    if (socket_handler->read_turn_queued) {
+        aws_linked_list_remove(&socket_handler->read_turn_node);
+        socket_handler->read_turn_queued = false;
+    }
+}
+
+/* fires the first-read hook once the socket has handed over its first bytes. */
+static void s_on_data_read(struct socket_handler *socket_handler, size_t read) {
+    if (read && socket_handler->on_first_read) {
+        aws_socket_handler_on_first_read_fn *on_first_read = socket_handler->on_first_read;
+        socket_handler->on_first_read = NULL;
+        on_first_read(socket_handler->slot->handler, socket_handler->on_first_read_user_data);
+    }
+}
+
 /* Ok this next function is VERY important for how back pressure works. Here's what it's supposed to be doing:
  *
  * See how much data downstream is willing to accept.
- * See how much we're actually willing to read per event loop tick (usually 16 kb).
+ * See how much we're actually willing to read right now (max_read: usually 16 kb, or our quantum on a read turn).
  * Take the minimum of those two.
  * Try and read as much as possible up to the calculated max read.
  * If we didn't read up to the max_read, we go back to waiting on the event loop to tell us we can read more.
  * If we did read up to the max_read, we stop reading immediately and wait for either for a window update,
- * or schedule a task to enforce fairness for other sockets in the event loop if we read up to the max
- * read per event loop tick.
+ * or, if we read all of max_read, get in line on the loop's read scheduler to enforce fairness for other sockets in
+ * the event loop.
+ *
+ * Returns how much was read.
  */
-static void s_do_read(struct socket_handler *socket_handler) {
+static size_t s_do_read(struct socket_handler *socket_handler, size_t max_read) {
 
     size_t downstream_window = aws_channel_slot_downstream_read_window(socket_handler->slot);
-    size_t max_to_read =
-        downstream_window > socket_handler->max_rw_size ? socket_handler->max_rw_size : downstream_window;
+    size_t max_to_read = downstream_window > max_read ? max_read : downstream_window;
 
-    AWS_LOGF_TRACE(
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_handler->trace_logging_enabled,
         AWS_LS_IO_SOCKET_HANDLER,
         "id=%p: invoking read. Downstream window %llu, max_to_read %llu",
         (void *)socket_handler->slot->handler,
@@ -134,7 +447,7 @@ static void s_do_read(struct socket_handler *socket_handler) {
         (unsigned long long)max_to_read);
 
     if (max_to_read == 0) {
-        return;
+        return 0;
     }
 
     size_t total_read = 0;
@@ -142,38 +455,109 @@ static void s_do_read(struct socket_handler *socket_handler) {
     while (total_read < max_to_read && !socket_handler->shutdown_in_progress) {
         size_t iter_max_read = max_to_read - total_read;
 
-        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
-            socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, iter_max_read);
+        /* a downstream handler that offers its own memory gets the read there, saving it a copy out of a message. */
+        struct aws_byte_buf direct_buffer;
+        aws_channel_slot_acquire_read_buffer(socket_handler->slot, iter_max_read, &direct_buffer);
+        if (direct_buffer.capacity) {
+            read = 0;
+            int read_error = AWS_ERROR_SUCCESS;
+            if (aws_socket_read(socket_handler->socket, &direct_buffer, &read)) {
+                read_error = aws_last_error();
+                read = 0;
+            }
+
+            total_read += read;
+            s_on_data_read(socket_handler, read);
+            AWS_IO_HOT_PATH_LOGF_TRACE(
+                socket_handler->trace_logging_enabled,
+                AWS_LS_IO_SOCKET_HANDLER,
+                "id=%p: read %llu from socket into a downstream buffer",
+                (void *)socket_handler->slot->handler,
+                (unsigned long long)read);
+
+            if (aws_channel_slot_read_buffer_filled(socket_handler->slot, read)) {
+                break;
+            }
+            if (read_error) {
+                aws_raise_error(read_error);
+                break;
+            }
+            continue;
+        }
+
+        /* grab enough pooled messages to cover what's left of the budget, then fill them all with one read. */
+        struct aws_io_message *messages[MAX_MESSAGES_PER_READ];
+        struct aws_byte_buf *buffers[MAX_MESSAGES_PER_READ];
+        size_t message_count = 0;
+        size_t batch_capacity = 0;
+
+        while (message_count < MAX_MESSAGES_PER_READ && batch_capacity < iter_max_read) {
+            struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+                socket_handler->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, iter_max_read - batch_capacity);
 
-        if (!message) {
+            if (!message) {
+                break;
+            }
+
+            messages[message_count] = message;
+            buffers[message_count] = &message->message_data;
+            batch_capacity += message->message_data.capacity;
+            ++message_count;
+        }
+
+        if (!message_count) {
             break;
         }
 
-        if (aws_socket_read(socket_handler->socket, &message->message_data, &read)) {
-            aws_mem_release(message->allocator, message);
+        if (aws_socket_read_vectored(socket_handler->socket, buffers, message_count, &read)) {
+            s_release_messages(messages, 0, message_count);
             break;
         }
 
         total_read += read;
-        AWS_LOGF_TRACE(
+        s_on_data_read(socket_handler, read);
+
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_handler->trace_logging_enabled,
             AWS_LS_IO_SOCKET_HANDLER,
-            "id=%p: read %llu from socket",
+            "id=%p: read %llu from socket into %llu messages",
             (void *)socket_handler->slot->handler,
-            (unsigned long long)read);
+            (unsigned long long)read,
+            (unsigned long long)message_count);
+
+        /* messages are filled in order, so everything after the first empty one is unused. The filled ones go
+         * downstream in one call, so a handler with process_read_messages sees the whole read at once. */
+        struct aws_linked_list filled;
+        aws_linked_list_init(&filled);
+        size_t filled_count = 0;
+        while (filled_count < message_count && messages[filled_count]->message_data.len) {
+            aws_linked_list_push_back(&filled, &messages[filled_count]->queueing_handle);
+            ++filled_count;
+        }
 
-        if (aws_channel_slot_send_message(socket_handler->slot, message, AWS_CHANNEL_DIR_READ)) {
-            aws_mem_release(message->allocator, message);
+        s_release_messages(messages, filled_count, message_count);
+
+        if (aws_channel_slot_send_messages(socket_handler->slot, &filled, AWS_CHANNEL_DIR_READ)) {
+            while (!aws_linked_list_empty(&filled)) {
+                struct aws_linked_list_node *node = aws_linked_list_pop_front(&filled);
+                struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+                aws_mem_release(message->allocator, message);
+            }
             break;
         }
     }
 
-    AWS_LOGF_TRACE(
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_handler->trace_logging_enabled,
         AWS_LS_IO_SOCKET_HANDLER,
         "id=%p: total read on this tick %llu",
         (void *)&socket_handler->slot->handler,
         (unsigned long long)total_read);
 
     socket_handler->stats.bytes_read += total_read;
+    if (total_read > 0) {
+        s_note_activity(socket_handler);
+    }
 
     /* resubscribe as long as there's no error, just return if we're in a would block scenario. */
     if (total_read < max_to_read) {
@@ -183,27 +567,28 @@ static void s_do_read(struct socket_handler *socket_handler) {
             aws_channel_shutdown(socket_handler->slot->channel, last_error);
         }
 
-        AWS_LOGF_TRACE(
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_handler->trace_logging_enabled,
             AWS_LS_IO_SOCKET_HANDLER,
             "id=%p: out of data to read on socket. "
             "Waiting on event-loop notification.",
             (void *)socket_handler->slot->handler);
-        return;
+        return total_read;
     }
-    /* in this case, everything was fine, but there's still pending reads. We need to schedule a task to do the read
-     * again. */
-    if (!socket_handler->shutdown_in_progress && total_read == socket_handler->max_rw_size &&
-        !socket_handler->read_task_storage.task_fn) {
+    /* in this case, everything was fine, but there's still pending reads. We need to wait for our turn to do the read
+     * again. A pending read task will do it anyway. */
+    if (!socket_handler->shutdown_in_progress && total_read == max_read && !socket_handler->read_task_storage.task_fn) {
 
-        AWS_LOGF_TRACE(
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_handler->trace_logging_enabled,
             AWS_LS_IO_SOCKET_HANDLER,
             "id=%p: more data is pending read, but we've exceeded "
-            "the max read on this tick. Scheduling a task to read on next tick.",
+            "the max read on this tick. Waiting for a read turn.",
             (void *)socket_handler->slot->handler);
-        aws_channel_task_init(
-            &socket_handler->read_task_storage, s_read_task, socket_handler, "socket_handler_re_read");
-        aws_channel_schedule_task_now(socket_handler->slot->channel, &socket_handler->read_task_storage);
+        s_queue_read_turn(socket_handler);
     }
+
+    return total_read;
 }
 
 /* the socket is either readable or errored out. If it's readable, kick off s_do_read() to do its thing.
@@ -212,13 +597,20 @@ static void s_on_readable_notification(struct aws_socket *socket, int error_code
     (void)socket;
 
     struct socket_handler *socket_handler = user_data;
-    AWS_LOGF_TRACE(AWS_LS_IO_SOCKET_HANDLER, "id=%p: socket is now readable", (void *)socket_handler->slot->handler);
+    AWS_IO_HOT_PATH_LOGF_TRACE(
+        socket_handler->trace_logging_enabled,
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: socket is now readable",
+        (void *)socket_handler->slot->handler);
 
     /* read regardless so we can pick up data that was sent prior to the close. For example, peer sends a TLS ALERT
      * then immediately closes the socket. On some platforms, we'll never see the readable flag. So we want to make
      * sure we read the ALERT, otherwise, we'll end up telling the user that the channel shutdown because of a socket
-     * closure, when in reality it was a TLS error */
-    s_do_read(socket_handler);
+     * closure, when in reality it was a TLS error. The exception is a handler waiting on its read turn: it picks
+     * the new data up then, so that the data arriving doesn't let it jump the line. */
+    if (!socket_handler->read_turn_queued || error_code) {
+        s_do_read(socket_handler, socket_handler->max_rw_size);
+    }
 
     if (error_code && !socket_handler->shutdown_in_progress) {
         aws_channel_shutdown(socket_handler->slot->channel, error_code);
@@ -232,7 +624,7 @@ static void s_read_task(struct aws_channel_task *task, void *arg, aws_task_statu
 
     if (status == AWS_TASK_STATUS_RUN_READY) {
         struct socket_handler *socket_handler = arg;
-        s_do_read(socket_handler);
+        s_do_read(socket_handler, socket_handler->max_rw_size);
     }
 }
 
@@ -244,8 +636,11 @@ static int s_socket_increment_read_window(
 
     struct socket_handler *socket_handler = handler->impl;
 
-    if (!socket_handler->shutdown_in_progress && !socket_handler->read_task_storage.task_fn) {
-        AWS_LOGF_TRACE(
+    /* a handler waiting on its read turn reads into the new window then */
+    if (!socket_handler->shutdown_in_progress && !socket_handler->read_task_storage.task_fn &&
+        !socket_handler->read_turn_queued) {
+        AWS_IO_HOT_PATH_LOGF_TRACE(
+            socket_handler->trace_logging_enabled,
             AWS_LS_IO_SOCKET_HANDLER,
             "id=%p: increment read window message received, scheduling"
             " task for another read operation.",
@@ -287,6 +682,7 @@ static int s_socket_shutdown(
     struct socket_handler *socket_handler = (struct socket_handler *)handler->impl;
 
     socket_handler->shutdown_in_progress = true;
+    s_dequeue_read_turn(socket_handler);
     if (dir == AWS_CHANNEL_DIR_READ) {
         AWS_LOGF_TRACE(
             AWS_LS_IO_SOCKET_HANDLER,
@@ -307,9 +703,13 @@ static int s_socket_shutdown(
         "id=%p: shutting down write direction with error_code %d",
         (void *)handler,
         error_code);
+    /* writes held back for the end of the tick go out ahead of the close, like any other write issued before it. */
+    s_uncork_writes(socket_handler);
     if (aws_socket_is_open(socket_handler->socket)) {
         aws_socket_close(socket_handler->socket);
     }
+    /* the socket may outlive this handler, and its stats with it */
+    socket_handler->socket->statistics = NULL;
 
     /* Schedule a task to complete the shutdown, in case a do_read task is currently pending.
      * It's OK to delay the shutdown, even when free_scarce_resources_immediately is true,
@@ -335,6 +735,7 @@ static void s_socket_destroy(struct aws_channel_handler *handler) {
     if (handler != NULL) {
         struct socket_handler *socket_handler = (struct socket_handler *)handler->impl;
         if (socket_handler != NULL) {
+            s_dequeue_read_turn(socket_handler);
             aws_crt_statistics_socket_cleanup(&socket_handler->stats);
         }
 
@@ -346,6 +747,11 @@ static void s_reset_statistics(struct aws_channel_handler *handler) {
     struct socket_handler *socket_handler = (struct socket_handler *)handler->impl;
 
     aws_crt_statistics_socket_reset(&socket_handler->stats);
+
+    /* the first reset is the channel starting to gather statistics, the socket only counts syscalls from then on */
+    if (!socket_handler->shutdown_in_progress) {
+        socket_handler->socket->statistics = &socket_handler->stats;
+    }
 }
 
 void s_gather_statistics(struct aws_channel_handler *handler, struct aws_array_list *stats_list) {
@@ -355,6 +761,43 @@ void s_gather_statistics(struct aws_channel_handler *handler, struct aws_array_l
     aws_array_list_push_back(stats_list, &stats_base);
 }
 
+static int s_socket_leave_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    (void)slot;
+    struct socket_handler *socket_handler = handler->impl;
+
+    if (socket_handler->pending_write_count) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET_HANDLER,
+            "id=%p: can't leave the event loop with %zu writes in flight",
+            (void *)handler,
+            socket_handler->pending_write_count);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    if (aws_socket_unassign_from_event_loop(socket_handler->socket)) {
+        return AWS_OP_ERR;
+    }
+
+    /* the read turn is on this loop's scheduler, a read task moves with the channel and gets back in line there */
+    if (socket_handler->read_turn_queued) {
+        s_dequeue_read_turn(socket_handler);
+        if (!socket_handler->read_task_storage.task_fn) {
+            aws_channel_task_init(
+                &socket_handler->read_task_storage, s_read_task, socket_handler, "socket_handler_read_after_move");
+            aws_channel_schedule_task_now(socket_handler->slot->channel, &socket_handler->read_task_storage);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_socket_join_event_loop(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    struct socket_handler *socket_handler = handler->impl;
+
+    /* anything that arrived in between is reported by the new loop straight away */
+    return aws_socket_assign_to_event_loop(socket_handler->socket, aws_channel_get_event_loop(slot->channel));
+}
+
 static struct aws_channel_handler_vtable s_vtable = {
     .process_read_message = s_socket_process_read_message,
     .destroy = s_socket_destroy,
@@ -365,6 +808,8 @@ static struct aws_channel_handler_vtable s_vtable = {
     .message_overhead = s_message_overhead,
     .reset_statistics = s_reset_statistics,
     .gather_statistics = s_gather_statistics,
+    .leave_event_loop = s_socket_leave_event_loop,
+    .join_event_loop = s_socket_join_event_loop,
 };
 
 struct aws_channel_handler *aws_socket_handler_new(
@@ -389,8 +834,21 @@ struct aws_channel_handler *aws_socket_handler_new(
     impl->socket = socket;
     impl->slot = slot;
     impl->max_rw_size = max_read_size;
+    impl->trace_logging_enabled = aws_io_hot_path_trace_enabled(AWS_LS_IO_SOCKET_HANDLER);
+    impl->pending_write_count = 0;
     AWS_ZERO_STRUCT(impl->read_task_storage);
     AWS_ZERO_STRUCT(impl->shutdown_task_storage);
+    AWS_ZERO_STRUCT(impl->idle_task_storage);
+    AWS_ZERO_STRUCT(impl->uncork_task_storage);
+    AWS_ZERO_STRUCT(impl->read_turn_node);
+    impl->idle_timeout_ns = 0;
+    impl->last_activity_ns = 0;
+    impl->write_coalescing_threshold = 0;
+    impl->corked_bytes = 0;
+    impl->idle_task_scheduled = false;
+    impl->writes_corked = false;
+    impl->uncork_task_scheduled = false;
+    impl->read_turn_queued = false;
     impl->shutdown_in_progress = false;
     if (aws_crt_statistics_socket_init(&impl->stats)) {
         goto cleanup_handler;
@@ -419,3 +877,103 @@ cleanup_handler:
 
     return NULL;
 }
+
+struct aws_socket *aws_socket_handler_get_socket(const struct aws_channel_handler *handler) {
+    if (handler == NULL || handler->vtable != &s_vtable) {
+        return NULL;
+    }
+
+    struct socket_handler *socket_handler = handler->impl;
+    return socket_handler->socket;
+}
+
+bool aws_socket_handler_has_pending_writes(const struct aws_channel_handler *handler) {
+    AWS_ASSERT(handler->vtable == &s_vtable);
+
+    struct socket_handler *socket_handler = handler->impl;
+    return socket_handler->pending_write_count > 0;
+}
+
+static void s_idle_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct socket_handler *socket_handler = arg;
+    socket_handler->idle_task_scheduled = false;
+
+    if (status != AWS_TASK_STATUS_RUN_READY || socket_handler->shutdown_in_progress ||
+        !socket_handler->idle_timeout_ns) {
+        return;
+    }
+
+    struct aws_channel *channel = socket_handler->slot->channel;
+    uint64_t now = 0;
+    if (aws_channel_current_clock_time(channel, &now)) {
+        return;
+    }
+
+    uint64_t deadline = aws_add_u64_saturating(socket_handler->last_activity_ns, socket_handler->idle_timeout_ns);
+    if (now < deadline) {
+        socket_handler->idle_task_scheduled = true;
+        aws_channel_schedule_task_future(channel, &socket_handler->idle_task_storage, deadline);
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_SOCKET_HANDLER,
+        "id=%p: no data read or written for %llu ms, shutting down the channel.",
+        (void *)socket_handler->slot->handler,
+        (unsigned long long)aws_timestamp_convert(
+            socket_handler->idle_timeout_ns, AWS_TIMESTAMP_NANOS, AWS_TIMESTAMP_MILLIS, NULL));
+    aws_channel_shutdown(channel, AWS_IO_CHANNEL_IDLE_TIMEOUT);
+}
+
+int aws_socket_handler_set_idle_timeout(struct aws_channel_handler *handler, uint32_t idle_timeout_ms) {
+    AWS_ASSERT(handler->vtable == &s_vtable);
+
+    struct socket_handler *socket_handler = handler->impl;
+    struct aws_channel *channel = socket_handler->slot->channel;
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(channel));
+
+    uint64_t now = 0;
+    if (idle_timeout_ms && aws_channel_current_clock_time(channel, &now)) {
+        return AWS_OP_ERR;
+    }
+
+    /* a pending idle task picks the new timeout up when it fires, or stops if it is now 0 */
+    socket_handler->idle_timeout_ns =
+        aws_timestamp_convert(idle_timeout_ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    socket_handler->last_activity_ns = now;
+
+    if (socket_handler->idle_timeout_ns && !socket_handler->idle_task_scheduled) {
+        aws_channel_task_init(&socket_handler->idle_task_storage, s_idle_task, socket_handler, "socket_handler_idle");
+        socket_handler->idle_task_scheduled = true;
+        aws_channel_schedule_task_future(
+            channel, &socket_handler->idle_task_storage, now + socket_handler->idle_timeout_ns);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_socket_handler_set_write_coalescing(struct aws_channel_handler *handler, size_t flush_threshold) {
+    AWS_ASSERT(handler->vtable == &s_vtable);
+
+    struct socket_handler *socket_handler = handler->impl;
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(socket_handler->slot->channel));
+
+    socket_handler->write_coalescing_threshold = flush_threshold;
+    if (!flush_threshold) {
+        s_uncork_writes(socket_handler);
+    }
+}
+
+void aws_socket_handler_set_on_first_read(
+    struct aws_channel_handler *handler,
+    aws_socket_handler_on_first_read_fn *on_first_read,
+    void *user_data) {
+    AWS_ASSERT(handler->vtable == &s_vtable);
+
+    struct socket_handler *socket_handler = handler->impl;
+    AWS_ASSERT(aws_channel_thread_is_callers_thread(socket_handler->slot->channel));
+
+    socket_handler->on_first_read = on_first_read;
+    socket_handler->on_first_read_user_data = user_data;
+}
@@ -0,0 +1,350 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/retry_strategy.h>
+
+#include <aws/io/logging.h>
+
+#include <aws/common/logging.h>
+#include <aws/common/mutex.h>
+
+static const size_t s_default_bucket_capacity = 500;
+static const size_t s_transient_retry_cost = 10;
+static const size_t s_retry_cost = 5;
+static const size_t s_no_retry_increment = 1;
+
+struct retry_quota_strategy {
+    struct aws_retry_strategy base;
+    struct aws_retry_strategy *wrapped_strategy;
+    size_t max_capacity;
+
+    struct {
+        struct aws_mutex lock;
+        size_t available_capacity;
+    } synced_data;
+};
+
+struct retry_quota_token {
+    struct aws_retry_token base;
+    struct aws_retry_token *wrapped_token;
+    /* what the last retry took from the bucket, 0 if the token hasn't retried */
+    size_t last_retry_cost;
+    aws_retry_strategy_on_retry_token_acquired_fn *acquired_fn;
+    void *acquired_user_data;
+
+    struct {
+        struct aws_mutex mutex;
+        aws_retry_strategy_on_retry_ready_fn *retry_ready_fn;
+        void *user_data;
+    } thread_data;
+};
+
+static void s_retry_quota_destroy(struct aws_retry_strategy *retry_strategy) {
+    if (retry_strategy) {
+        struct retry_quota_strategy *quota_strategy = retry_strategy->impl;
+        aws_retry_strategy_release(quota_strategy->wrapped_strategy);
+        aws_mutex_clean_up(&quota_strategy->synced_data.lock);
+        aws_mem_release(retry_strategy->allocator, quota_strategy);
+    }
+}
+
+/* takes cost out of the bucket if it holds that much, returns false otherwise */
+static bool s_bucket_withdraw(struct retry_quota_strategy *quota_strategy, size_t cost) {
+    bool withdrawn = false;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&quota_strategy->synced_data.lock) && "Retry quota mutex acquisition failed");
+        if (quota_strategy->synced_data.available_capacity >= cost) {
+            quota_strategy->synced_data.available_capacity -= cost;
+            withdrawn = true;
+        }
+        AWS_FATAL_ASSERT(!aws_mutex_unlock(&quota_strategy->synced_data.lock) && "Retry quota mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    return withdrawn;
+}
+
+static void s_bucket_deposit(struct retry_quota_strategy *quota_strategy, size_t amount) {
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(
+            !aws_mutex_lock(&quota_strategy->synced_data.lock) && "Retry quota mutex acquisition failed");
+        quota_strategy->synced_data.available_capacity = aws_min_size(
+            aws_add_size_saturating(quota_strategy->synced_data.available_capacity, amount),
+            quota_strategy->max_capacity);
+        AWS_FATAL_ASSERT(!aws_mutex_unlock(&quota_strategy->synced_data.lock) && "Retry quota mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+}
+
+static void s_retry_quota_token_destroy(struct retry_quota_token *quota_token) {
+    aws_retry_strategy_release(quota_token->base.retry_strategy);
+    aws_mutex_clean_up(&quota_token->thread_data.mutex);
+    aws_mem_release(quota_token->base.allocator, quota_token);
+}
+
+static void s_on_wrapped_token_acquired(
+    struct aws_retry_strategy *wrapped_strategy,
+    int error_code,
+    struct aws_retry_token *wrapped_token,
+    void *user_data) {
+    (void)wrapped_strategy;
+
+    struct retry_quota_token *quota_token = user_data;
+    struct aws_retry_strategy *retry_strategy = quota_token->base.retry_strategy;
+
+    if (error_code) {
+        quota_token->acquired_fn(retry_strategy, error_code, NULL, quota_token->acquired_user_data);
+        s_retry_quota_token_destroy(quota_token);
+        return;
+    }
+
+    quota_token->wrapped_token = wrapped_token;
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Vending retry_token %p",
+        (void *)retry_strategy,
+        (void *)&quota_token->base);
+    quota_token->acquired_fn(retry_strategy, AWS_OP_SUCCESS, &quota_token->base, quota_token->acquired_user_data);
+}
+
+static int s_retry_quota_acquire_token(
+    struct aws_retry_strategy *retry_strategy,
+    const struct aws_byte_cursor *partition_id,
+    aws_retry_strategy_on_retry_token_acquired_fn *on_acquired,
+    void *user_data,
+    uint64_t timeout_ms) {
+    struct retry_quota_strategy *quota_strategy = retry_strategy->impl;
+
+    struct retry_quota_token *quota_token =
+        aws_mem_calloc(retry_strategy->allocator, 1, sizeof(struct retry_quota_token));
+
+    if (!quota_token) {
+        return AWS_OP_ERR;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Initializing retry token %p",
+        (void *)retry_strategy,
+        (void *)&quota_token->base);
+
+    quota_token->base.allocator = retry_strategy->allocator;
+    quota_token->base.retry_strategy = retry_strategy;
+    aws_retry_strategy_acquire(retry_strategy);
+    quota_token->base.impl = quota_token;
+    quota_token->acquired_fn = on_acquired;
+    quota_token->acquired_user_data = user_data;
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&quota_token->thread_data.mutex) && "Retry token mutex initialization failed");
+
+    /* the wrapped strategy already guarantees on_acquired is invoked asynchronously, and only on success */
+    if (aws_retry_strategy_acquire_retry_token(
+            quota_strategy->wrapped_strategy, partition_id, s_on_wrapped_token_acquired, quota_token, timeout_ms)) {
+        s_retry_quota_token_destroy(quota_token);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_on_wrapped_retry_ready(struct aws_retry_token *wrapped_token, int error_code, void *user_data) {
+    (void)wrapped_token;
+
+    struct retry_quota_token *quota_token = user_data;
+    aws_retry_strategy_on_retry_ready_fn *retry_ready_fn = NULL;
+    void *retry_user_data = NULL;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(!aws_mutex_lock(&quota_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        retry_ready_fn = quota_token->thread_data.retry_ready_fn;
+        retry_user_data = quota_token->thread_data.user_data;
+        quota_token->thread_data.retry_ready_fn = NULL;
+        quota_token->thread_data.user_data = NULL;
+        AWS_FATAL_ASSERT(!aws_mutex_unlock(&quota_token->thread_data.mutex) && "Retry token mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Invoking retry_ready for token %p",
+        (void *)quota_token->base.retry_strategy,
+        (void *)&quota_token->base);
+    retry_ready_fn(&quota_token->base, error_code, retry_user_data);
+}
+
+static size_t s_compute_retry_cost(enum aws_retry_error_type error_type) {
+    switch (error_type) {
+        case AWS_RETRY_ERROR_TYPE_TRANSIENT:
+            return s_transient_retry_cost;
+        case AWS_RETRY_ERROR_TYPE_CLIENT_ERROR:
+            /* doesn't count against any budgets */
+            return 0;
+        default:
+            return s_retry_cost;
+    }
+}
+
+static int s_retry_quota_schedule_retry(
+    struct aws_retry_token *token,
+    enum aws_retry_error_type error_type,
+    aws_retry_strategy_on_retry_ready_fn *retry_ready,
+    void *user_data) {
+    AWS_PRECONDITION(retry_ready);
+
+    struct retry_quota_token *quota_token = token->impl;
+    struct retry_quota_strategy *quota_strategy = token->retry_strategy->impl;
+
+    size_t cost = s_compute_retry_cost(error_type);
+    if (cost && !s_bucket_withdraw(quota_strategy, cost)) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+            "id=%p: retry quota can't cover a retry of cost %zu on token %p",
+            (void *)token->retry_strategy,
+            cost,
+            (void *)token);
+        return aws_raise_error(AWS_IO_RETRY_PERMISSION_DENIED);
+    }
+
+    bool already_scheduled = false;
+
+    { /***** BEGIN CRITICAL SECTION *********/
+        AWS_FATAL_ASSERT(!aws_mutex_lock(&quota_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        if (quota_token->thread_data.retry_ready_fn) {
+            already_scheduled = true;
+        } else {
+            quota_token->thread_data.retry_ready_fn = retry_ready;
+            quota_token->thread_data.user_data = user_data;
+        }
+        AWS_FATAL_ASSERT(!aws_mutex_unlock(&quota_token->thread_data.mutex) && "Retry token mutex release failed");
+    } /**** END CRITICAL SECTION ***********/
+
+    if (already_scheduled) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+            "id=%p: retry token %p is already scheduled.",
+            (void *)token->retry_strategy,
+            (void *)token);
+        s_bucket_deposit(quota_strategy, cost);
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    /* set before scheduling, retry_ready may run (and record success) before the wrapped strategy returns */
+    size_t previous_retry_cost = quota_token->last_retry_cost;
+    if (cost) {
+        quota_token->last_retry_cost = cost;
+    }
+
+    if (aws_retry_strategy_schedule_retry(
+            quota_token->wrapped_token, error_type, s_on_wrapped_retry_ready, quota_token)) {
+        /* e.g. out of retries, the quota didn't get spent after all */
+        quota_token->last_retry_cost = previous_retry_cost;
+        s_bucket_deposit(quota_strategy, cost);
+
+        AWS_FATAL_ASSERT(!aws_mutex_lock(&quota_token->thread_data.mutex) && "Retry token mutex acquisition failed");
+        quota_token->thread_data.retry_ready_fn = NULL;
+        quota_token->thread_data.user_data = NULL;
+        AWS_FATAL_ASSERT(!aws_mutex_unlock(&quota_token->thread_data.mutex) && "Retry token mutex release failed");
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_retry_quota_record_success(struct aws_retry_token *token) {
+    struct retry_quota_token *quota_token = token->impl;
+    struct retry_quota_strategy *quota_strategy = token->retry_strategy->impl;
+
+    /* a success after retrying gives back what the last retry took, one that needed no retries adds a little */
+    size_t refill = quota_token->last_retry_cost ? quota_token->last_retry_cost : s_no_retry_increment;
+    quota_token->last_retry_cost = 0;
+    s_bucket_deposit(quota_strategy, refill);
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: token %p recorded success, refilling retry quota by %zu",
+        (void *)token->retry_strategy,
+        (void *)token,
+        refill);
+
+    return aws_retry_strategy_token_record_success(quota_token->wrapped_token);
+}
+
+static void s_retry_quota_release_token(struct aws_retry_token *token) {
+    if (token) {
+        struct retry_quota_token *quota_token = token->impl;
+        aws_retry_strategy_release_retry_token(quota_token->wrapped_token);
+        s_retry_quota_token_destroy(quota_token);
+    }
+}
+
+static struct aws_retry_strategy_vtable s_retry_quota_vtable = {
+    .destroy = s_retry_quota_destroy,
+    .acquire_token = s_retry_quota_acquire_token,
+    .schedule_retry = s_retry_quota_schedule_retry,
+    .record_success = s_retry_quota_record_success,
+    .release_token = s_retry_quota_release_token,
+};
+
+struct aws_retry_strategy *aws_retry_strategy_new_retry_quota(
+    struct aws_allocator *allocator,
+    struct aws_retry_strategy *wrapped_strategy,
+    const struct aws_retry_quota_options *config) {
+    AWS_PRECONDITION(wrapped_strategy);
+    AWS_PRECONDITION(config);
+
+    if (!wrapped_strategy) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct retry_quota_strategy *quota_strategy = aws_mem_calloc(allocator, 1, sizeof(struct retry_quota_strategy));
+
+    if (!quota_strategy) {
+        return NULL;
+    }
+
+    quota_strategy->max_capacity = config->initial_bucket_capacity;
+    if (!quota_strategy->max_capacity) {
+        quota_strategy->max_capacity = s_default_bucket_capacity;
+    }
+
+    AWS_LOGF_INFO(
+        AWS_LS_IO_STANDARD_RETRY_STRATEGY,
+        "id=%p: Initializing retry quota with bucket capacity %zu over retry strategy %p",
+        (void *)&quota_strategy->base,
+        quota_strategy->max_capacity,
+        (void *)wrapped_strategy);
+
+    quota_strategy->base.allocator = allocator;
+    quota_strategy->base.impl = quota_strategy;
+    quota_strategy->base.vtable = &s_retry_quota_vtable;
+    aws_atomic_init_int(&quota_strategy->base.ref_count, 1);
+    quota_strategy->wrapped_strategy = wrapped_strategy;
+    aws_retry_strategy_acquire(wrapped_strategy);
+    quota_strategy->synced_data.available_capacity = quota_strategy->max_capacity;
+    AWS_FATAL_ASSERT(
+        !aws_mutex_init(&quota_strategy->synced_data.lock) && "Retry quota mutex initialization failed");
+
+    return &quota_strategy->base;
+}
+
+struct aws_retry_strategy *aws_retry_strategy_new_standard(
+    struct aws_allocator *allocator,
+    const struct aws_standard_retry_options *config) {
+    AWS_PRECONDITION(config);
+
+    struct aws_retry_strategy *backoff_strategy =
+        aws_retry_strategy_new_exponential_backoff(allocator, &config->backoff_retry_options);
+
+    if (!backoff_strategy) {
+        return NULL;
+    }
+
+    struct aws_retry_strategy *standard_strategy =
+        aws_retry_strategy_new_retry_quota(allocator, backoff_strategy, &config->retry_quota_options);
+
+    /* the quota holds its own reference on success, on failure this cleans up the backoff strategy */
+    aws_retry_strategy_release(backoff_strategy);
+
+    return standard_strategy;
+}
@@ -7,6 +7,12 @@
 
 #include <aws/io/channel.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/metrics.h>
+
+#include <aws/common/linked_list.h>
+#include <aws/common/math.h>
+#include <aws/common/mutex.h>
+#include <aws/common/thread.h>
 
 int aws_crt_statistics_socket_init(struct aws_crt_statistics_socket *stats) {
     AWS_ZERO_STRUCT(*stats);
@@ -22,6 +28,11 @@ void aws_crt_statistics_socket_cleanup(struct aws_crt_statistics_socket *stats)
 void aws_crt_statistics_socket_reset(struct aws_crt_statistics_socket *stats) {
     stats->bytes_read = 0;
     stats->bytes_written = 0;
+    stats->read_syscalls = 0;
+    stats->write_syscalls = 0;
+    stats->read_would_block = 0;
+    stats->write_would_block = 0;
+    stats->partial_writes = 0;
 }
 
 int aws_crt_statistics_tls_init(struct aws_crt_statistics_tls *stats) {
@@ -42,3 +53,245 @@ void aws_crt_statistics_tls_reset(struct aws_crt_statistics_tls *stats) {
      */
     (void)stats;
 }
+
+#define AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT ((size_t)1 << AWS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+static struct aws_latency_histogram s_io_latency_histograms[AWS_IO_LATENCY_METRIC_COUNT];
+
+/*
+ * Values below the sub-bucket count get a bucket each. Above that, a value's top SUB_BUCKET_BITS + 1 bits pick its
+ * bucket: the position of the highest one selects a group of SUB_BUCKET_COUNT buckets, the bits after it one of them.
+ */
+static size_t s_bucket_index(uint64_t value_us) {
+    if (value_us < AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (size_t)value_us;
+    }
+
+    size_t exponent = AWS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    while (exponent < 63 && (value_us >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+
+    size_t shift = exponent - AWS_LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    size_t sub_bucket = (size_t)(value_us >> shift) - AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+    size_t index = (shift + 1) * AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket;
+
+    return aws_min_size(index, AWS_LATENCY_HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+static void s_bucket_range_us(size_t index, uint64_t *lower_us, uint64_t *upper_us) {
+    if (index < AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT) {
+        *lower_us = index;
+        *upper_us = index + 1;
+        return;
+    }
+
+    size_t shift = index / AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1;
+    uint64_t sub_bucket = AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + index % AWS_LATENCY_HISTOGRAM_SUB_BUCKET_COUNT;
+    *lower_us = sub_bucket << shift;
+    *upper_us = index == AWS_LATENCY_HISTOGRAM_BUCKET_COUNT - 1 ? UINT64_MAX : (sub_bucket + 1) << shift;
+}
+
+void aws_latency_histogram_reset(struct aws_latency_histogram *histogram) {
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        aws_atomic_store_int_explicit(&histogram->buckets[i], 0, aws_memory_order_relaxed);
+    }
+}
+
+void aws_latency_histogram_record_ns(struct aws_latency_histogram *histogram, uint64_t duration_ns) {
+    size_t index = s_bucket_index(duration_ns / 1000);
+    aws_atomic_fetch_add_explicit(&histogram->buckets[index], 1, aws_memory_order_relaxed);
+}
+
+void aws_latency_histogram_merge(struct aws_latency_histogram *to, const struct aws_latency_histogram *from) {
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        size_t count = aws_atomic_load_int_explicit(&from->buckets[i], aws_memory_order_relaxed);
+        if (count) {
+            aws_atomic_fetch_add_explicit(&to->buckets[i], count, aws_memory_order_relaxed);
+        }
+    }
+}
+
+void aws_latency_histogram_take(struct aws_latency_histogram *to, struct aws_latency_histogram *from) {
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        size_t count = aws_atomic_exchange_int_explicit(&from->buckets[i], 0, aws_memory_order_relaxed);
+        if (count) {
+            aws_atomic_fetch_add_explicit(&to->buckets[i], count, aws_memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t aws_latency_histogram_get_count(const struct aws_latency_histogram *histogram) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        count += aws_atomic_load_int_explicit(&histogram->buckets[i], aws_memory_order_relaxed);
+    }
+
+    return count;
+}
+
+uint64_t aws_latency_histogram_get_percentile_ns(const struct aws_latency_histogram *histogram, double percentile) {
+    size_t counts[AWS_LATENCY_HISTOGRAM_BUCKET_COUNT];
+    uint64_t total = 0;
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        counts[i] = aws_atomic_load_int_explicit(&histogram->buckets[i], aws_memory_order_relaxed);
+        total += counts[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    /* the rank of the value asked for, counting from 1 */
+    double exact_rank = percentile / 100.0 * (double)total;
+    uint64_t rank = (uint64_t)exact_rank;
+    if ((double)rank < exact_rank) {
+        ++rank;
+    }
+    if (rank == 0) {
+        rank = 1;
+    } else if (rank > total) {
+        rank = total;
+    }
+
+    uint64_t seen = 0;
+    size_t index = 0;
+    for (; index < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT - 1; ++index) {
+        seen += counts[index];
+        if (seen >= rank) {
+            break;
+        }
+    }
+
+    uint64_t lower_ns = 0;
+    uint64_t upper_ns = 0;
+    aws_latency_histogram_get_bucket_range_ns(index, &lower_ns, &upper_ns);
+    return upper_ns;
+}
+
+void aws_latency_histogram_get_bucket_range_ns(size_t index, uint64_t *lower_ns, uint64_t *upper_ns) {
+    AWS_FATAL_ASSERT(index < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT);
+
+    uint64_t lower_us = 0;
+    uint64_t upper_us = 0;
+    s_bucket_range_us(index, &lower_us, &upper_us);
+
+    *lower_ns = lower_us * 1000;
+    *upper_ns = upper_us == UINT64_MAX ? UINT64_MAX : upper_us * 1000;
+}
+
+struct aws_latency_histogram *aws_io_get_latency_histogram(enum aws_io_latency_metric metric) {
+    AWS_FATAL_ASSERT(metric < AWS_IO_LATENCY_METRIC_COUNT);
+
+    return &s_io_latency_histograms[metric];
+}
+
+struct aws_io_metrics_shard {
+    struct aws_allocator *allocator;
+    struct aws_linked_list_node node;
+    struct aws_atomic_var counters[AWS_IO_METRIC_COUNT];
+};
+
+static struct aws_atomic_var s_metrics_enabled;
+/* counts made off any event loop thread */
+static struct aws_io_metrics_shard s_shared_shard;
+static AWS_THREAD_LOCAL struct aws_io_metrics_shard *tl_metrics_shard = NULL;
+
+/*
+ * Protects the shard list and the counts of destroyed shards, never taken while counting. All of it is statically
+ * initialized: event loops can be created without aws_io_library_init().
+ */
+static struct aws_mutex s_metrics_lock = AWS_MUTEX_INIT;
+static struct aws_linked_list s_metrics_shards = {
+    .head = {.next = &s_metrics_shards.tail, .prev = NULL},
+    .tail = {.next = NULL, .prev = &s_metrics_shards.head},
+};
+static uint64_t s_retired_metrics[AWS_IO_METRIC_COUNT];
+
+/* shards hold size_t wide counts, a negative gauge delta wraps and is brought back when adding up */
+static uint64_t s_shard_value(const struct aws_io_metrics_shard *shard, size_t metric) {
+    size_t value = aws_atomic_load_int_explicit(&shard->counters[metric], aws_memory_order_relaxed);
+    if (metric == AWS_IO_METRIC_OPEN_CHANNELS) {
+        return (uint64_t)(int64_t)(intptr_t)value;
+    }
+
+    return value;
+}
+
+struct aws_io_metrics_shard *aws_io_metrics_shard_new(struct aws_allocator *allocator) {
+    struct aws_io_metrics_shard *shard = aws_mem_calloc(allocator, 1, sizeof(struct aws_io_metrics_shard));
+    if (!shard) {
+        return NULL;
+    }
+
+    shard->allocator = allocator;
+
+    aws_mutex_lock(&s_metrics_lock);
+    aws_linked_list_push_back(&s_metrics_shards, &shard->node);
+    aws_mutex_unlock(&s_metrics_lock);
+
+    return shard;
+}
+
+void aws_io_metrics_shard_destroy(struct aws_io_metrics_shard *shard) {
+    if (!shard) {
+        return;
+    }
+
+    aws_mutex_lock(&s_metrics_lock);
+    aws_linked_list_remove(&shard->node);
+    for (size_t i = 0; i < AWS_IO_METRIC_COUNT; ++i) {
+        s_retired_metrics[i] += s_shard_value(shard, i);
+    }
+    aws_mutex_unlock(&s_metrics_lock);
+
+    aws_mem_release(shard->allocator, shard);
+}
+
+void aws_io_metrics_set_thread_shard(struct aws_io_metrics_shard *shard) {
+    tl_metrics_shard = shard;
+}
+
+void aws_io_metrics_set_enabled(bool enabled) {
+    aws_atomic_store_int(&s_metrics_enabled, enabled ? 1 : 0);
+}
+
+bool aws_io_metrics_is_enabled(void) {
+    return aws_atomic_load_int_explicit(&s_metrics_enabled, aws_memory_order_relaxed) != 0;
+}
+
+void aws_io_metrics_add(enum aws_io_metric metric, int64_t delta) {
+    AWS_ASSERT(metric < AWS_IO_METRIC_COUNT);
+
+    if (!aws_io_metrics_is_enabled()) {
+        return;
+    }
+
+    struct aws_io_metrics_shard *shard = tl_metrics_shard ? tl_metrics_shard : &s_shared_shard;
+    aws_atomic_fetch_add_explicit(&shard->counters[metric], (size_t)delta, aws_memory_order_relaxed);
+}
+
+void aws_io_metrics_snapshot(struct aws_io_metrics_snapshot *snapshot) {
+    AWS_ZERO_STRUCT(*snapshot);
+
+    aws_mutex_lock(&s_metrics_lock);
+    for (size_t i = 0; i < AWS_IO_METRIC_COUNT; ++i) {
+        snapshot->values[i] = s_retired_metrics[i] + s_shard_value(&s_shared_shard, i);
+    }
+
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(&s_metrics_shards);
+         node != aws_linked_list_end(&s_metrics_shards);
+         node = aws_linked_list_next(node)) {
+        struct aws_io_metrics_shard *shard = AWS_CONTAINER_OF(node, struct aws_io_metrics_shard, node);
+        for (size_t i = 0; i < AWS_IO_METRIC_COUNT; ++i) {
+            snapshot->values[i] += s_shard_value(shard, i);
+        }
+    }
+    aws_mutex_unlock(&s_metrics_lock);
+}
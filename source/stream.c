@@ -6,6 +6,11 @@
 #include <aws/io/stream.h>
 
 #include <aws/io/file_utils.h>
+#include <aws/io/private/crc.h>
+#include <aws/io/private/file_mapping.h>
+#include <aws/io/private/positional_file.h>
+
+#include <aws/common/ref_count.h>
 
 #include <errno.h>
 
@@ -237,6 +242,76 @@ struct aws_input_stream *aws_input_stream_new_from_cursor(
     return input_stream;
 }
 
+/*
+ * memory mapped file input stream, a cursor stream over the mapping
+ */
+struct aws_input_stream_mmap_impl {
+    /* first, so the byte cursor stream functions work on it as is */
+    struct aws_input_stream_byte_cursor_impl cursor_impl;
+    struct aws_file_mapping mapping;
+};
+
+static void s_aws_input_stream_mmap_destroy(struct aws_input_stream *stream) {
+    struct aws_input_stream_mmap_impl *impl = stream->impl;
+
+    aws_file_mapping_clean_up(&impl->mapping);
+
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_aws_input_stream_mmap_vtable = {
+    .seek = s_aws_input_stream_byte_cursor_seek,
+    .read = s_aws_input_stream_byte_cursor_read,
+    .get_status = s_aws_input_stream_byte_cursor_get_status,
+    .get_length = s_aws_input_stream_byte_cursor_get_length,
+    .destroy = s_aws_input_stream_mmap_destroy};
+
+struct aws_input_stream *aws_input_stream_new_from_mmap(struct aws_allocator *allocator, const char *file_name) {
+
+    struct aws_input_stream *input_stream = NULL;
+    struct aws_input_stream_mmap_impl *impl = NULL;
+
+    aws_mem_acquire_many(
+        allocator, 2, &input_stream, sizeof(struct aws_input_stream), &impl, sizeof(struct aws_input_stream_mmap_impl));
+
+    if (!input_stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*input_stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    if (aws_file_mapping_init(&impl->mapping, file_name, true)) {
+        aws_mem_release(allocator, input_stream);
+        return NULL;
+    }
+
+    input_stream->allocator = allocator;
+    input_stream->vtable = &s_aws_input_stream_mmap_vtable;
+    input_stream->impl = impl;
+
+    impl->cursor_impl.original_cursor = aws_byte_cursor_from_array(impl->mapping.address, impl->mapping.length);
+    impl->cursor_impl.current_cursor = impl->cursor_impl.original_cursor;
+
+    return input_stream;
+}
+
+int aws_input_stream_read_borrowed(
+    struct aws_input_stream *stream,
+    size_t max_len,
+    struct aws_byte_cursor *out_cursor) {
+    AWS_ASSERT(stream && out_cursor);
+
+    if (stream->vtable != &s_aws_input_stream_byte_cursor_vtable && stream->vtable != &s_aws_input_stream_mmap_vtable) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    struct aws_input_stream_byte_cursor_impl *impl = stream->impl;
+    *out_cursor = aws_byte_cursor_advance(&impl->current_cursor, aws_min_size(max_len, impl->current_cursor.len));
+
+    return AWS_OP_SUCCESS;
+}
+
 /*
  * file-based input stream
  */
@@ -366,3 +441,480 @@ struct aws_input_stream *aws_input_stream_new_from_open_file(struct aws_allocato
 
     return input_stream;
 }
+
+FILE *aws_input_stream_get_file(struct aws_input_stream *stream) {
+    if (stream == NULL || stream->vtable != &s_aws_input_stream_file_vtable) {
+        return NULL;
+    }
+
+    struct aws_input_stream_file_impl *impl = stream->impl;
+    return impl->file;
+}
+
+/*
+ * file opened once for positional reads, shared by any number of file region streams
+ */
+struct aws_shared_file {
+    struct aws_allocator *allocator;
+    struct aws_ref_count ref_count;
+    struct aws_positional_file file;
+};
+
+static void s_aws_shared_file_destroy(void *user_data) {
+    struct aws_shared_file *shared_file = user_data;
+
+    aws_positional_file_close(&shared_file->file);
+    aws_mem_release(shared_file->allocator, shared_file);
+}
+
+struct aws_shared_file *aws_shared_file_new(struct aws_allocator *allocator, const char *file_name) {
+    struct aws_shared_file *shared_file = aws_mem_calloc(allocator, 1, sizeof(struct aws_shared_file));
+    if (!shared_file) {
+        return NULL;
+    }
+
+    if (aws_positional_file_open(&shared_file->file, file_name)) {
+        aws_mem_release(allocator, shared_file);
+        return NULL;
+    }
+
+    shared_file->allocator = allocator;
+    aws_ref_count_init(&shared_file->ref_count, shared_file, s_aws_shared_file_destroy);
+
+    return shared_file;
+}
+
+struct aws_shared_file *aws_shared_file_acquire(struct aws_shared_file *shared_file) {
+    if (shared_file != NULL) {
+        aws_ref_count_acquire(&shared_file->ref_count);
+    }
+
+    return shared_file;
+}
+
+void aws_shared_file_release(struct aws_shared_file *shared_file) {
+    if (shared_file != NULL) {
+        aws_ref_count_release(&shared_file->ref_count);
+    }
+}
+
+int64_t aws_shared_file_get_length(const struct aws_shared_file *shared_file) {
+    return shared_file->file.length;
+}
+
+/*
+ * file region input stream, a view of [offset, offset + length) of a shared file
+ */
+struct aws_input_stream_file_region_impl {
+    struct aws_shared_file *shared_file;
+    uint64_t offset;
+    uint64_t length;
+    /* relative to offset */
+    uint64_t position;
+};
+
+static int s_aws_input_stream_file_region_seek(
+    struct aws_input_stream *stream,
+    aws_off_t offset,
+    enum aws_stream_seek_basis basis) {
+    struct aws_input_stream_file_region_impl *impl = stream->impl;
+
+    int64_t checked_offset = offset;
+
+    /* same rules as the cursor stream: within the region, counted from whichever end the basis names */
+    switch (basis) {
+        case AWS_SSB_BEGIN:
+            if (checked_offset < 0 || (uint64_t)checked_offset > impl->length) {
+                return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+            }
+
+            impl->position = (uint64_t)checked_offset;
+            break;
+
+        case AWS_SSB_END:
+            if (checked_offset > 0 || checked_offset == INT64_MIN || (uint64_t)(-checked_offset) > impl->length) {
+                return aws_raise_error(AWS_IO_STREAM_INVALID_SEEK_POSITION);
+            }
+
+            impl->position = impl->length - (uint64_t)(-checked_offset);
+            break;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_file_region_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_input_stream_file_region_impl *impl = stream->impl;
+
+    uint64_t remaining = impl->length - impl->position;
+    if (remaining == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    /* never read past the end of the region, whatever room dest has */
+    size_t max_read = dest->capacity - dest->len;
+    if ((uint64_t)max_read > remaining) {
+        max_read = (size_t)remaining;
+    }
+
+    struct aws_byte_buf region_buf = aws_byte_buf_from_empty_array(dest->buffer + dest->len, max_read);
+    if (aws_positional_file_read(&impl->shared_file->file, impl->offset + impl->position, &region_buf)) {
+        return AWS_OP_ERR;
+    }
+
+    /* nothing at all before the end of the region means the file got truncated */
+    if (region_buf.len == 0) {
+        return aws_raise_error(AWS_IO_STREAM_READ_FAILED);
+    }
+
+    dest->len += region_buf.len;
+    impl->position += region_buf.len;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_file_region_get_status(
+    struct aws_input_stream *stream,
+    struct aws_stream_status *status) {
+    struct aws_input_stream_file_region_impl *impl = stream->impl;
+
+    status->is_end_of_stream = impl->position == impl->length;
+    status->is_valid = true;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_file_region_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_input_stream_file_region_impl *impl = stream->impl;
+
+    /* bounded by the file length at creation, which is an int64_t */
+    *out_length = (int64_t)impl->length;
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_aws_input_stream_file_region_destroy(struct aws_input_stream *stream) {
+    struct aws_input_stream_file_region_impl *impl = stream->impl;
+
+    aws_shared_file_release(impl->shared_file);
+
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_aws_input_stream_file_region_vtable = {
+    .seek = s_aws_input_stream_file_region_seek,
+    .read = s_aws_input_stream_file_region_read,
+    .get_status = s_aws_input_stream_file_region_get_status,
+    .get_length = s_aws_input_stream_file_region_get_length,
+    .destroy = s_aws_input_stream_file_region_destroy};
+
+struct aws_input_stream *aws_input_stream_new_from_file_region(
+    struct aws_allocator *allocator,
+    struct aws_shared_file *shared_file,
+    uint64_t offset,
+    uint64_t length) {
+    AWS_ASSERT(shared_file);
+
+    uint64_t file_length = (uint64_t)shared_file->file.length;
+    if (offset > file_length || length > file_length - offset) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_input_stream *input_stream = NULL;
+    struct aws_input_stream_file_region_impl *impl = NULL;
+
+    aws_mem_acquire_many(
+        allocator,
+        2,
+        &input_stream,
+        sizeof(struct aws_input_stream),
+        &impl,
+        sizeof(struct aws_input_stream_file_region_impl));
+
+    if (!input_stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*input_stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    input_stream->allocator = allocator;
+    input_stream->vtable = &s_aws_input_stream_file_region_vtable;
+    input_stream->impl = impl;
+
+    impl->shared_file = aws_shared_file_acquire(shared_file);
+    impl->offset = offset;
+    impl->length = length;
+
+    return input_stream;
+}
+
+/*
+ * checksumming input stream, decorates another stream
+ */
+struct aws_input_stream_checksum_impl {
+    struct aws_input_stream *source;
+    enum aws_stream_checksum_algorithm algorithm;
+    uint32_t checksum;
+};
+
+static int s_aws_input_stream_checksum_seek(
+    struct aws_input_stream *stream,
+    aws_off_t offset,
+    enum aws_stream_seek_basis basis) {
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+
+    if (offset != 0 || basis != AWS_SSB_BEGIN) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    if (aws_input_stream_seek(impl->source, offset, basis)) {
+        return AWS_OP_ERR;
+    }
+
+    impl->checksum = 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_checksum_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+
+    size_t starting_len = dest->len;
+    if (aws_input_stream_read(impl->source, dest)) {
+        return AWS_OP_ERR;
+    }
+
+    /* checksum the bytes while they're still in cache */
+    const uint8_t *read_bytes = dest->buffer + starting_len;
+    size_t read_len = dest->len - starting_len;
+    switch (impl->algorithm) {
+        case AWS_SCA_CRC32:
+            impl->checksum = aws_io_crc32(read_bytes, read_len, impl->checksum);
+            break;
+
+        case AWS_SCA_CRC32C:
+            impl->checksum = aws_io_crc32c(read_bytes, read_len, impl->checksum);
+            break;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_checksum_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+
+    return aws_input_stream_get_status(impl->source, status);
+}
+
+static int s_aws_input_stream_checksum_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+
+    return aws_input_stream_get_length(impl->source, out_length);
+}
+
+static void s_aws_input_stream_checksum_destroy(struct aws_input_stream *stream) {
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+
+    aws_input_stream_destroy(impl->source);
+
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_aws_input_stream_checksum_vtable = {
+    .seek = s_aws_input_stream_checksum_seek,
+    .read = s_aws_input_stream_checksum_read,
+    .get_status = s_aws_input_stream_checksum_get_status,
+    .get_length = s_aws_input_stream_checksum_get_length,
+    .destroy = s_aws_input_stream_checksum_destroy};
+
+struct aws_input_stream *aws_input_stream_new_checksum(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    enum aws_stream_checksum_algorithm algorithm) {
+    AWS_ASSERT(source);
+
+    if (algorithm != AWS_SCA_CRC32 && algorithm != AWS_SCA_CRC32C) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_input_stream *input_stream = NULL;
+    struct aws_input_stream_checksum_impl *impl = NULL;
+
+    aws_mem_acquire_many(
+        allocator,
+        2,
+        &input_stream,
+        sizeof(struct aws_input_stream),
+        &impl,
+        sizeof(struct aws_input_stream_checksum_impl));
+
+    if (!input_stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*input_stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    input_stream->allocator = allocator;
+    input_stream->vtable = &s_aws_input_stream_checksum_vtable;
+    input_stream->impl = impl;
+
+    impl->source = source;
+    impl->algorithm = algorithm;
+
+    return input_stream;
+}
+
+/*
+ * read-ahead input stream, decorates another stream
+ */
+struct aws_input_stream_read_ahead_impl {
+    struct aws_input_stream *source;
+    /* holds what the last read of the source brought in, of which unread is what the consumer hasn't had yet */
+    struct aws_byte_buf buffer;
+    struct aws_byte_cursor unread;
+};
+
+static int s_aws_input_stream_read_ahead_seek(
+    struct aws_input_stream *stream,
+    aws_off_t offset,
+    enum aws_stream_seek_basis basis) {
+    struct aws_input_stream_read_ahead_impl *impl = stream->impl;
+
+    if (aws_input_stream_seek(impl->source, offset, basis)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_byte_buf_reset(&impl->buffer, false);
+    impl->unread = aws_byte_cursor_from_buf(&impl->buffer);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_read_ahead_copy_unread(struct aws_input_stream_read_ahead_impl *impl, struct aws_byte_buf *dest) {
+    size_t copy_len = aws_min_size(impl->unread.len, dest->capacity - dest->len);
+    struct aws_byte_cursor chunk = aws_byte_cursor_advance(&impl->unread, copy_len);
+    aws_byte_buf_write_from_whole_cursor(dest, chunk);
+}
+
+static int s_aws_input_stream_read_ahead_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct aws_input_stream_read_ahead_impl *impl = stream->impl;
+
+    s_read_ahead_copy_unread(impl, dest);
+    size_t room = dest->capacity - dest->len;
+    if (room == 0) {
+        return AWS_OP_SUCCESS;
+    }
+
+    /* a read at least as large as the read-ahead gains nothing from going through the buffer */
+    if (room >= impl->buffer.capacity) {
+        return aws_input_stream_read(impl->source, dest);
+    }
+
+    aws_byte_buf_reset(&impl->buffer, false);
+    impl->unread = aws_byte_cursor_from_buf(&impl->buffer);
+    if (aws_input_stream_read(impl->source, &impl->buffer)) {
+        aws_byte_buf_reset(&impl->buffer, false);
+        return AWS_OP_ERR;
+    }
+
+    impl->unread = aws_byte_cursor_from_buf(&impl->buffer);
+    s_read_ahead_copy_unread(impl, dest);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_read_ahead_get_status(
+    struct aws_input_stream *stream,
+    struct aws_stream_status *status) {
+    struct aws_input_stream_read_ahead_impl *impl = stream->impl;
+
+    if (aws_input_stream_get_status(impl->source, status)) {
+        return AWS_OP_ERR;
+    }
+
+    /* the source may be done while the buffer isn't */
+    status->is_end_of_stream = status->is_end_of_stream && impl->unread.len == 0;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_aws_input_stream_read_ahead_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct aws_input_stream_read_ahead_impl *impl = stream->impl;
+
+    return aws_input_stream_get_length(impl->source, out_length);
+}
+
+static void s_aws_input_stream_read_ahead_destroy(struct aws_input_stream *stream) {
+    struct aws_input_stream_read_ahead_impl *impl = stream->impl;
+
+    aws_input_stream_destroy(impl->source);
+
+    aws_mem_release(stream->allocator, stream);
+}
+
+static struct aws_input_stream_vtable s_aws_input_stream_read_ahead_vtable = {
+    .seek = s_aws_input_stream_read_ahead_seek,
+    .read = s_aws_input_stream_read_ahead_read,
+    .get_status = s_aws_input_stream_read_ahead_get_status,
+    .get_length = s_aws_input_stream_read_ahead_get_length,
+    .destroy = s_aws_input_stream_read_ahead_destroy};
+
+struct aws_input_stream *aws_input_stream_new_read_ahead(
+    struct aws_allocator *allocator,
+    struct aws_input_stream *source,
+    size_t read_ahead_size) {
+    AWS_ASSERT(source);
+
+    if (read_ahead_size == 0) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        return NULL;
+    }
+
+    struct aws_input_stream *input_stream = NULL;
+    struct aws_input_stream_read_ahead_impl *impl = NULL;
+    uint8_t *buffer = NULL;
+
+    aws_mem_acquire_many(
+        allocator,
+        3,
+        &input_stream,
+        sizeof(struct aws_input_stream),
+        &impl,
+        sizeof(struct aws_input_stream_read_ahead_impl),
+        &buffer,
+        read_ahead_size);
+
+    if (!input_stream) {
+        return NULL;
+    }
+
+    AWS_ZERO_STRUCT(*input_stream);
+    AWS_ZERO_STRUCT(*impl);
+
+    input_stream->allocator = allocator;
+    input_stream->vtable = &s_aws_input_stream_read_ahead_vtable;
+    input_stream->impl = impl;
+
+    impl->source = source;
+    impl->buffer = aws_byte_buf_from_empty_array(buffer, read_ahead_size);
+    impl->unread = aws_byte_cursor_from_buf(&impl->buffer);
+
+    return input_stream;
+}
+
+int aws_input_stream_get_checksum(struct aws_input_stream *stream, uint32_t *out_checksum) {
+    AWS_ASSERT(stream && out_checksum);
+
+    if (stream->vtable != &s_aws_input_stream_checksum_vtable) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    struct aws_input_stream_checksum_impl *impl = stream->impl;
+    *out_checksum = impl->checksum;
+
+    return AWS_OP_SUCCESS;
+}
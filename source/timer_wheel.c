@@ -0,0 +1,166 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/timer_wheel.h>
+
+#include <aws/common/task_scheduler.h>
+
+/* log2(AWS_TIMER_WHEEL_SLOTS) */
+#define LEVEL_BITS 6
+#define SLOT_MASK ((uint64_t)AWS_TIMER_WHEEL_SLOTS - 1)
+#define NO_TICK UINT64_MAX
+
+/* number of ticks one slot of level spans */
+static uint64_t s_level_granularity(size_t level) {
+    return (uint64_t)1 << (LEVEL_BITS * level);
+}
+
+/*
+ * Puts task in the slot that gets reached at expires_tick, or at the last tick before it where a coarser slot is spread
+ * over the levels below. base_tick is the tick the wheel is at; expires_tick must not be before it, and if it is that
+ * same tick the caller must still be about to hand out the current level 0 slot.
+ */
+static void s_place(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t expires_tick, uint64_t base_tick) {
+    AWS_ASSERT(expires_tick >= base_tick);
+
+    uint64_t delta = expires_tick - base_tick;
+    size_t level = 0;
+    while (level < AWS_TIMER_WHEEL_LEVELS - 1 && delta >= s_level_granularity(level + 1)) {
+        ++level;
+    }
+
+    if (delta >= s_level_granularity(AWS_TIMER_WHEEL_LEVELS)) {
+        /* beyond what the wheel spans, park it in the furthest slot. It gets placed again from there. */
+        expires_tick = base_tick + s_level_granularity(AWS_TIMER_WHEEL_LEVELS) - 1;
+    }
+
+    size_t index = (size_t)((expires_tick >> (LEVEL_BITS * level)) & SLOT_MASK);
+    aws_linked_list_push_back(&wheel->slots[level][index], &task->node);
+    wheel->occupied[level] |= (uint64_t)1 << index;
+}
+
+static uint64_t s_expires_tick(const struct aws_timer_wheel *wheel, const struct aws_task *task) {
+    /* round up, so a task is never handed out before its timestamp */
+    return task->timestamp / wheel->tick_ns + (task->timestamp % wheel->tick_ns != 0);
+}
+
+/* First tick after current_tick at which some occupied slot is reached, or NO_TICK if nothing is occupied. */
+static uint64_t s_next_event_tick(const struct aws_timer_wheel *wheel) {
+    uint64_t next_tick = NO_TICK;
+
+    for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+        if (!wheel->occupied[level]) {
+            continue;
+        }
+
+        /* slots of this level are reached at multiples of its granularity, in index order */
+        uint64_t position = wheel->current_tick >> (LEVEL_BITS * level);
+        for (uint64_t step = 1; step <= AWS_TIMER_WHEEL_SLOTS; ++step) {
+            if (wheel->occupied[level] & ((uint64_t)1 << ((position + step) & SLOT_MASK))) {
+                uint64_t tick = (position + step) << (LEVEL_BITS * level);
+                next_tick = tick < next_tick ? tick : next_tick;
+                break;
+            }
+        }
+    }
+
+    return next_tick;
+}
+
+static void s_process_tick(struct aws_timer_wheel *wheel, uint64_t tick, struct aws_linked_list *out_due) {
+    /* coarsest first, a slot spread over the levels below may land tasks in a slot that is also reached now */
+    for (size_t level = AWS_TIMER_WHEEL_LEVELS - 1; level > 0; --level) {
+        if (tick & (s_level_granularity(level) - 1)) {
+            continue;
+        }
+
+        size_t index = (size_t)((tick >> (LEVEL_BITS * level)) & SLOT_MASK);
+        if (!(wheel->occupied[level] & ((uint64_t)1 << index))) {
+            continue;
+        }
+        wheel->occupied[level] &= ~((uint64_t)1 << index);
+
+        struct aws_linked_list to_place;
+        aws_linked_list_init(&to_place);
+        aws_linked_list_swap_contents(&to_place, &wheel->slots[level][index]);
+
+        while (!aws_linked_list_empty(&to_place)) {
+            struct aws_task *task = AWS_CONTAINER_OF(aws_linked_list_pop_front(&to_place), struct aws_task, node);
+            uint64_t expires_tick = s_expires_tick(wheel, task);
+            s_place(wheel, task, expires_tick > tick ? expires_tick : tick, tick);
+        }
+    }
+
+    size_t index = (size_t)(tick & SLOT_MASK);
+    if (wheel->occupied[0] & ((uint64_t)1 << index)) {
+        wheel->occupied[0] &= ~((uint64_t)1 << index);
+        while (!aws_linked_list_empty(&wheel->slots[0][index])) {
+            aws_linked_list_push_back(out_due, aws_linked_list_pop_front(&wheel->slots[0][index]));
+        }
+    }
+}
+
+void aws_timer_wheel_init(struct aws_timer_wheel *wheel, uint64_t tick_ns, uint64_t now_ns) {
+    AWS_ASSERT(tick_ns > 0);
+
+    AWS_ZERO_STRUCT(*wheel);
+    wheel->tick_ns = tick_ns;
+    wheel->current_tick = now_ns / tick_ns;
+
+    for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+        for (size_t index = 0; index < AWS_TIMER_WHEEL_SLOTS; ++index) {
+            aws_linked_list_init(&wheel->slots[level][index]);
+        }
+    }
+}
+
+void aws_timer_wheel_schedule(struct aws_timer_wheel *wheel, struct aws_task *task, uint64_t run_at_nanos) {
+    task->timestamp = run_at_nanos;
+
+    /* the current tick's slot has been handed out already, anything due by now goes out on the next one */
+    uint64_t expires_tick = s_expires_tick(wheel, task);
+    if (expires_tick <= wheel->current_tick) {
+        expires_tick = wheel->current_tick + 1;
+    }
+
+    s_place(wheel, task, expires_tick, wheel->current_tick);
+}
+
+void aws_timer_wheel_advance(struct aws_timer_wheel *wheel, uint64_t now_ns, struct aws_linked_list *out_due) {
+    uint64_t now_tick = now_ns / wheel->tick_ns;
+
+    /* jump straight from one occupied slot to the next rather than walking every tick in between */
+    while (wheel->current_tick < now_tick) {
+        uint64_t next_tick = s_next_event_tick(wheel);
+        if (next_tick > now_tick) {
+            wheel->current_tick = now_tick;
+            break;
+        }
+
+        s_process_tick(wheel, next_tick, out_due);
+        wheel->current_tick = next_tick;
+    }
+}
+
+bool aws_timer_wheel_next_deadline(const struct aws_timer_wheel *wheel, uint64_t *out_ns) {
+    uint64_t next_tick = s_next_event_tick(wheel);
+    if (next_tick == NO_TICK) {
+        return false;
+    }
+
+    *out_ns = next_tick * wheel->tick_ns;
+    return true;
+}
+
+void aws_timer_wheel_pop_all(struct aws_timer_wheel *wheel, struct aws_linked_list *out_tasks) {
+    for (size_t level = 0; level < AWS_TIMER_WHEEL_LEVELS; ++level) {
+        for (size_t index = 0; index < AWS_TIMER_WHEEL_SLOTS; ++index) {
+            while (!aws_linked_list_empty(&wheel->slots[level][index])) {
+                aws_linked_list_push_back(out_tasks, aws_linked_list_pop_front(&wheel->slots[level][index]));
+            }
+        }
+        wheel->occupied[level] = 0;
+    }
+}
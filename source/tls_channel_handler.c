@@ -273,6 +273,37 @@ void aws_tls_ctx_options_set_verify_peer(struct aws_tls_ctx_options *options, bo
     options->verify_peer = verify_peer;
 }
 
+void aws_tls_ctx_options_set_ktls_enabled(struct aws_tls_ctx_options *options, bool enable_ktls) {
+    options->enable_ktls = enable_ktls;
+}
+
+void aws_tls_ctx_options_set_session_cache(struct aws_tls_ctx_options *options, size_t max_entries, uint32_t ttl_secs) {
+    options->session_cache_max_entries = max_entries;
+    options->session_cache_ttl_secs = ttl_secs;
+}
+
+void aws_tls_ctx_options_set_session_ticket_key_rotation(struct aws_tls_ctx_options *options, uint32_t rotation_secs) {
+    options->session_ticket_key_rotation_secs = rotation_secs;
+}
+
+void aws_tls_ctx_options_set_private_key_offload(
+    struct aws_tls_ctx_options *options,
+    struct aws_event_loop_group *el_group) {
+    options->private_key_offload_elg = el_group;
+}
+
+void aws_tls_ctx_options_set_connection_pool_size(struct aws_tls_ctx_options *options, size_t pool_size) {
+    options->connection_pool_size = pool_size;
+}
+
+void aws_tls_ctx_options_set_release_idle_buffers(struct aws_tls_ctx_options *options, bool release) {
+    options->release_idle_buffers = release;
+}
+
+void aws_tls_ctx_options_set_input_ring_size(struct aws_tls_ctx_options *options, size_t ring_size) {
+    options->input_ring_size = ring_size;
+}
+
 void aws_tls_ctx_options_set_minimum_tls_version(
     struct aws_tls_ctx_options *options,
     enum aws_tls_versions minimum_tls_version) {
@@ -404,6 +435,14 @@ int aws_tls_connection_options_set_alpn_list(
     return AWS_OP_SUCCESS;
 }
 
+void aws_tls_connection_options_set_dynamic_record_sizing(
+    struct aws_tls_connection_options *conn_options,
+    uint32_t threshold,
+    uint16_t reset_timeout_secs) {
+    conn_options->dynamic_record_threshold = threshold;
+    conn_options->dynamic_record_reset_timeout_secs = reset_timeout_secs;
+}
+
 int aws_channel_setup_client_tls(
     struct aws_channel_slot *right_of_slot,
     struct aws_tls_connection_options *tls_options) {
@@ -422,7 +461,7 @@ int aws_channel_setup_client_tls(
 
     struct aws_channel_handler *tls_handler = aws_tls_client_handler_new(allocator, tls_options, tls_slot);
     if (!tls_handler) {
-        aws_mem_release(allocator, tls_slot);
+        aws_channel_slot_remove(tls_slot);
         return AWS_OP_ERR;
     }
 
@@ -6,6 +6,7 @@
 #include <aws/io/private/tls_channel_handler_shared.h>
 
 #include <aws/common/clock.h>
+#include <aws/io/statistics.h>
 #include <aws/io/tls_channel_handler.h>
 
 static void s_tls_timeout_task_fn(struct aws_channel_task *channel_task, void *arg, enum aws_task_status status) {
@@ -62,4 +63,36 @@ void aws_on_tls_negotiation_completed(struct aws_tls_channel_handler_shared *tls
         (error_code == AWS_ERROR_SUCCESS) ? AWS_TLS_NEGOTIATION_STATUS_SUCCESS : AWS_TLS_NEGOTIATION_STATUS_FAILURE;
     aws_channel_current_clock_time(
         tls_handler_shared->handler->slot->channel, &tls_handler_shared->stats.handshake_end_ns);
+
+    if (error_code == AWS_ERROR_SUCCESS &&
+        tls_handler_shared->stats.handshake_end_ns >= tls_handler_shared->stats.handshake_start_ns) {
+        aws_latency_histogram_record_ns(
+            aws_io_get_latency_histogram(AWS_IO_LATENCY_TLS_HANDSHAKE),
+            tls_handler_shared->stats.handshake_end_ns - tls_handler_shared->stats.handshake_start_ns);
+    }
+}
+
+int aws_tls_install_negotiated_protocol_handler(
+    struct aws_channel_slot *tls_slot,
+    struct aws_byte_buf *protocol,
+    aws_tls_on_protocol_negotiated on_protocol_negotiated,
+    void *user_data) {
+
+    struct aws_channel_slot *new_slot = aws_channel_slot_new(tls_slot->channel);
+    if (!new_slot) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_channel_slot_insert_right(tls_slot, new_slot)) {
+        aws_channel_slot_remove(new_slot);
+        return AWS_OP_ERR;
+    }
+
+    struct aws_channel_handler *new_handler = on_protocol_negotiated(new_slot, protocol, user_data);
+    if (!new_handler) {
+        aws_channel_slot_remove(new_slot);
+        return aws_raise_error(AWS_IO_UNHANDLED_ALPN_PROTOCOL_MESSAGE);
+    }
+
+    return aws_channel_slot_set_handler(new_slot, new_handler);
 }
@@ -0,0 +1,176 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/tls_session_cache.h>
+
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/lru_cache.h>
+#include <aws/common/math.h>
+#include <aws/common/string.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+struct aws_tls_cached_session {
+    struct aws_allocator *allocator;
+    struct aws_byte_buf session;
+    uint64_t expiry;
+};
+
+static void s_destroy_key(void *key) {
+    aws_string_destroy(key);
+}
+
+static void s_destroy_session(void *value) {
+    struct aws_tls_cached_session *cached_session = value;
+    /* sessions hold key material, don't leave it lying around in freed memory. */
+    aws_byte_buf_clean_up_secure(&cached_session->session);
+    aws_mem_release(cached_session->allocator, cached_session);
+}
+
+int aws_tls_session_cache_init(
+    struct aws_tls_session_cache *cache,
+    struct aws_allocator *allocator,
+    size_t max_entries,
+    uint32_t ttl_secs) {
+    AWS_ZERO_STRUCT(*cache);
+
+    cache->sessions = aws_cache_new_lru(
+        allocator, aws_hash_string, aws_hash_callback_string_eq, s_destroy_key, s_destroy_session, max_entries);
+    if (!cache->sessions) {
+        return AWS_OP_ERR;
+    }
+
+    if (aws_mutex_init(&cache->lock)) {
+        aws_cache_destroy(cache->sessions);
+        cache->sessions = NULL;
+        return AWS_OP_ERR;
+    }
+
+    cache->allocator = allocator;
+    /* a ttl of 0 would expire every session as it's stored */
+    if (ttl_secs == 0) {
+        ttl_secs = AWS_TLS_SESSION_CACHE_DEFAULT_TTL_SECS;
+    }
+    cache->ttl_ns = aws_timestamp_convert(ttl_secs, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    cache->clock_fn = aws_high_res_clock_get_ticks;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_tls_session_cache_clean_up(struct aws_tls_session_cache *cache) {
+    if (!cache->sessions) {
+        return;
+    }
+
+    aws_cache_destroy(cache->sessions);
+    aws_mutex_clean_up(&cache->lock);
+    AWS_ZERO_STRUCT(*cache);
+}
+
+struct aws_string *aws_tls_session_cache_key_new(
+    struct aws_allocator *allocator,
+    const struct aws_string *server_name,
+    uint16_t port) {
+
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), ":%" PRIu16, port);
+
+    struct aws_byte_buf key_buf;
+    if (aws_byte_buf_init(&key_buf, allocator, server_name->len + sizeof(port_str))) {
+        return NULL;
+    }
+
+    struct aws_byte_cursor server_name_cur = aws_byte_cursor_from_string(server_name);
+    struct aws_byte_cursor port_cur = aws_byte_cursor_from_c_str(port_str);
+    aws_byte_buf_append(&key_buf, &server_name_cur);
+    aws_byte_buf_append(&key_buf, &port_cur);
+
+    struct aws_string *key = aws_string_new_from_array(allocator, key_buf.buffer, key_buf.len);
+    aws_byte_buf_clean_up(&key_buf);
+
+    return key;
+}
+
+int aws_tls_session_cache_put(
+    struct aws_tls_session_cache *cache,
+    const struct aws_string *key,
+    struct aws_byte_cursor session) {
+
+    uint64_t now = 0;
+    if (cache->clock_fn(&now)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_tls_cached_session *cached_session =
+        aws_mem_calloc(cache->allocator, 1, sizeof(struct aws_tls_cached_session));
+    if (!cached_session) {
+        return AWS_OP_ERR;
+    }
+
+    cached_session->allocator = cache->allocator;
+    cached_session->expiry = aws_add_u64_saturating(now, cache->ttl_ns);
+    if (aws_byte_buf_init_copy_from_cursor(&cached_session->session, cache->allocator, session)) {
+        goto on_error;
+    }
+
+    struct aws_string *key_copy = aws_string_new_from_string(cache->allocator, key);
+    if (!key_copy) {
+        goto on_error;
+    }
+
+    aws_mutex_lock(&cache->lock);
+    aws_cache_remove(cache->sessions, key_copy);
+    int err = aws_cache_put(cache->sessions, key_copy, cached_session);
+    aws_mutex_unlock(&cache->lock);
+
+    if (err) {
+        aws_string_destroy(key_copy);
+        goto on_error;
+    }
+
+    return AWS_OP_SUCCESS;
+
+on_error:
+    s_destroy_session(cached_session);
+    return AWS_OP_ERR;
+}
+
+int aws_tls_session_cache_get(
+    struct aws_tls_session_cache *cache,
+    const struct aws_string *key,
+    struct aws_byte_buf *out_session) {
+
+    uint64_t now = 0;
+    if (cache->clock_fn(&now)) {
+        return AWS_OP_ERR;
+    }
+
+    int result = AWS_OP_SUCCESS;
+
+    aws_mutex_lock(&cache->lock);
+    struct aws_tls_cached_session *cached_session = NULL;
+    aws_cache_find(cache->sessions, key, (void **)&cached_session);
+
+    if (cached_session) {
+        if (cached_session->expiry <= now) {
+            aws_cache_remove(cache->sessions, key);
+        } else {
+            struct aws_byte_cursor session_cur = aws_byte_cursor_from_buf(&cached_session->session);
+            result = aws_byte_buf_append_dynamic(out_session, &session_cur);
+        }
+    }
+    aws_mutex_unlock(&cache->lock);
+
+    return result;
+}
+
+void aws_tls_session_cache_remove(struct aws_tls_session_cache *cache, const struct aws_string *key) {
+    aws_mutex_lock(&cache->lock);
+    aws_cache_remove(cache->sessions, key);
+    aws_mutex_unlock(&cache->lock);
+}
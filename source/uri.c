@@ -11,6 +11,12 @@
 #include <stdio.h>
 #include <string.h>
 
+/* SSE2 is part of x86-64, so its fast path needs no runtime detection */
+#if defined(__x86_64__) || defined(_M_X64)
+#    define AWS_URI_SSE2
+#    include <emmintrin.h>
+#endif
+
 #if _MSC_VER
 #    pragma warning(disable : 4221) /* aggregate initializer using local variable addresses */
 #    pragma warning(disable : 4204) /* non-constant aggregate initializer */
@@ -27,7 +33,7 @@ enum parser_state {
 };
 
 struct uri_parser {
-    struct aws_uri *uri;
+    struct aws_uri_view *view;
     enum parser_state state;
 };
 
@@ -45,14 +51,14 @@ static parse_fn *s_states[] = {
     [ON_QUERY_STRING] = s_parse_query_string,
 };
 
-static int s_init_from_uri_str(struct aws_uri *uri) {
+static int s_parse_view(struct aws_uri_view *view, struct aws_byte_cursor uri_cur) {
+    AWS_ZERO_STRUCT(*view);
+
     struct uri_parser parser = {
         .state = ON_SCHEME,
-        .uri = uri,
+        .view = view,
     };
 
-    struct aws_byte_cursor uri_cur = aws_byte_cursor_from_buf(&uri->uri_str);
-
     while (parser.state < FINISHED) {
         s_states[parser.state](&parser, &uri_cur);
     }
@@ -62,11 +68,35 @@ static int s_init_from_uri_str(struct aws_uri *uri) {
         return AWS_OP_SUCCESS;
     }
 
-    aws_byte_buf_clean_up(&uri->uri_str);
-    AWS_ZERO_STRUCT(*uri);
+    AWS_ZERO_STRUCT(*view);
     return AWS_OP_ERR;
 }
 
+static int s_init_from_uri_str(struct aws_uri *uri) {
+    struct aws_uri_view view;
+    if (s_parse_view(&view, aws_byte_cursor_from_buf(&uri->uri_str))) {
+        aws_byte_buf_clean_up(&uri->uri_str);
+        AWS_ZERO_STRUCT(*uri);
+        return AWS_OP_ERR;
+    }
+
+    uri->scheme = view.scheme;
+    uri->authority = view.authority;
+    uri->host_name = view.host_name;
+    uri->port = view.port;
+    uri->path = view.path;
+    uri->query_string = view.query_string;
+    uri->path_and_query = view.path_and_query;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_uri_view_parse(struct aws_uri_view *view, struct aws_byte_cursor uri_str) {
+    AWS_ASSERT(view);
+
+    return s_parse_view(view, uri_str);
+}
+
 int aws_uri_init_parse(struct aws_uri *uri, struct aws_allocator *allocator, const struct aws_byte_cursor *uri_str) {
     AWS_ZERO_STRUCT(*uri);
     uri->self_size = sizeof(struct aws_uri);
@@ -212,7 +242,7 @@ uint16_t aws_uri_port(const struct aws_uri *uri) {
     return uri->port;
 }
 
-bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_param *param) {
+static bool s_query_string_next_param(const struct aws_byte_cursor *query_string, struct aws_uri_param *param) {
     /* If param is zeroed, then this is the first run. */
     bool first_run = param->value.ptr == NULL;
 
@@ -230,7 +260,7 @@ bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_p
 
     /* The do-while is to skip over any empty substrings */
     do {
-        if (!aws_byte_cursor_next_split(&uri->query_string, '&', &substr)) {
+        if (!aws_byte_cursor_next_split(query_string, '&', &substr)) {
             /* no more splits, done iterating */
             return false;
         }
@@ -252,6 +282,14 @@ bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_p
     return true;
 }
 
+bool aws_uri_query_string_next_param(const struct aws_uri *uri, struct aws_uri_param *param) {
+    return s_query_string_next_param(&uri->query_string, param);
+}
+
+bool aws_uri_view_query_string_next_param(const struct aws_uri_view *view, struct aws_uri_param *param) {
+    return s_query_string_next_param(&view->query_string, param);
+}
+
 int aws_uri_query_string_params(const struct aws_uri *uri, struct aws_array_list *out_params) {
     struct aws_uri_param param;
     AWS_ZERO_STRUCT(param);
@@ -279,7 +317,7 @@ static void s_parse_scheme(struct uri_parser *parser, struct aws_byte_cursor *st
     }
 
     const size_t scheme_len = location_of_colon - str->ptr;
-    parser->uri->scheme = aws_byte_cursor_advance(str, scheme_len);
+    parser->view->scheme = aws_byte_cursor_advance(str, scheme_len);
 
     if (str->len < 3 || str->ptr[0] != ':' || str->ptr[1] != '/' || str->ptr[2] != '/') {
         aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
@@ -299,14 +337,14 @@ static void s_parse_authority(struct uri_parser *parser, struct aws_byte_cursor
     uint8_t *location_of_qmark = memchr(str->ptr, '?', str->len);
 
     if (!location_of_slash && !location_of_qmark && str->len) {
-        parser->uri->authority.ptr = str->ptr;
-        parser->uri->authority.len = str->len;
+        parser->view->authority.ptr = str->ptr;
+        parser->view->authority.len = str->len;
 
-        parser->uri->path.ptr = (uint8_t *)s_default_path;
-        parser->uri->path.len = 1;
-        parser->uri->path_and_query = parser->uri->path;
+        parser->view->path.ptr = (uint8_t *)s_default_path;
+        parser->view->path.len = 1;
+        parser->view->path_and_query = parser->view->path;
         parser->state = FINISHED;
-        aws_byte_cursor_advance(str, parser->uri->authority.len);
+        aws_byte_cursor_advance(str, parser->view->authority.len);
     } else if (!str->len) {
         parser->state = ERROR;
         aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
@@ -321,24 +359,24 @@ static void s_parse_authority(struct uri_parser *parser, struct aws_byte_cursor
             end = location_of_qmark;
         }
 
-        parser->uri->authority = aws_byte_cursor_advance(str, end - str->ptr);
+        parser->view->authority = aws_byte_cursor_advance(str, end - str->ptr);
     }
 
-    struct aws_byte_cursor authority_parse_csr = parser->uri->authority;
+    struct aws_byte_cursor authority_parse_csr = parser->view->authority;
 
     if (authority_parse_csr.len) {
         uint8_t *port_delim = memchr(authority_parse_csr.ptr, ':', authority_parse_csr.len);
 
         if (!port_delim) {
-            parser->uri->port = 0;
-            parser->uri->host_name = parser->uri->authority;
+            parser->view->port = 0;
+            parser->view->host_name = parser->view->authority;
             return;
         }
 
-        parser->uri->host_name.ptr = authority_parse_csr.ptr;
-        parser->uri->host_name.len = port_delim - authority_parse_csr.ptr;
+        parser->view->host_name.ptr = authority_parse_csr.ptr;
+        parser->view->host_name.len = port_delim - authority_parse_csr.ptr;
 
-        size_t port_len = parser->uri->authority.len - parser->uri->host_name.len - 1;
+        size_t port_len = parser->view->authority.len - parser->view->host_name.len - 1;
         port_delim += 1;
         for (size_t i = 0; i < port_len; ++i) {
             if (!aws_isdigit(port_delim[i])) {
@@ -364,20 +402,20 @@ static void s_parse_authority(struct uri_parser *parser, struct aws_byte_cursor
             return;
         }
 
-        parser->uri->port = (uint16_t)port_int;
+        parser->view->port = (uint16_t)port_int;
     }
 }
 
 static void s_parse_path(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    parser->uri->path_and_query = *str;
+    parser->view->path_and_query = *str;
 
     uint8_t *location_of_q_mark = memchr(str->ptr, '?', str->len);
 
     if (!location_of_q_mark) {
-        parser->uri->path.ptr = str->ptr;
-        parser->uri->path.len = str->len;
+        parser->view->path.ptr = str->ptr;
+        parser->view->path.len = str->len;
         parser->state = FINISHED;
-        aws_byte_cursor_advance(str, parser->uri->path.len);
+        aws_byte_cursor_advance(str, parser->view->path.len);
         return;
     }
 
@@ -387,127 +425,116 @@ static void s_parse_path(struct uri_parser *parser, struct aws_byte_cursor *str)
         return;
     }
 
-    parser->uri->path.ptr = str->ptr;
-    parser->uri->path.len = location_of_q_mark - str->ptr;
-    aws_byte_cursor_advance(str, parser->uri->path.len);
+    parser->view->path.ptr = str->ptr;
+    parser->view->path.len = location_of_q_mark - str->ptr;
+    aws_byte_cursor_advance(str, parser->view->path.len);
     parser->state = ON_QUERY_STRING;
 }
 
 static void s_parse_query_string(struct uri_parser *parser, struct aws_byte_cursor *str) {
-    if (!parser->uri->path_and_query.ptr) {
-        parser->uri->path_and_query = *str;
+    if (!parser->view->path_and_query.ptr) {
+        parser->view->path_and_query = *str;
     }
     /* we don't want the '?' character. */
     if (str->len) {
-        parser->uri->query_string.ptr = str->ptr + 1;
-        parser->uri->query_string.len = str->len - 1;
+        parser->view->query_string.ptr = str->ptr + 1;
+        parser->view->query_string.len = str->len - 1;
     }
 
-    aws_byte_cursor_advance(str, parser->uri->query_string.len + 1);
+    aws_byte_cursor_advance(str, parser->view->query_string.len + 1);
     parser->state = FINISHED;
 }
 
-static uint8_t s_to_uppercase_hex(uint8_t value) {
-    AWS_ASSERT(value < 16);
+/* characters that are copied as is rather than %-encoded, per encoding */
+enum uri_unreserved_flag {
+    URI_PATH_UNRESERVED = 0x01,
+    URI_PARAM_UNRESERVED = 0x02,
+};
 
-    if (value < 10) {
-        return (uint8_t)('0' + value);
-    }
+/*
+ * Path: alphanumerics and -_.~$&,/:;=@
+ * Param: alphanumerics and -_.~
+ */
+static const uint8_t s_uri_unreserved_table[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x00 */
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, /* 0x10 */
+    0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 3, 3, 1, /* 0x20 */
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 1, 0, 1, 0, 0, /* 0x30 */
+    1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, /* 0x40 */
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 0, 0, 0, 0, 3, /* 0x50 */
+    0, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, /* 0x60 */
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 0, 0, 0, 3, 0, /* 0x70 */
+    /* 0x80 - 0xFF are all encoded */
+};
+
+static const uint8_t s_uppercase_hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
 
-    return (uint8_t)('A' + value - 10);
+#ifdef AWS_URI_SSE2
+/* mask of the bytes of chunk that are within [lo, hi], all ASCII */
+static __m128i s_sse2_in_range(__m128i chunk, char lo, char hi) {
+    /* signed compares, which is fine since bytes >= 0x80 are negative and no range includes them */
+    return _mm_and_si128(
+        _mm_cmpgt_epi8(chunk, _mm_set1_epi8((char)(lo - 1))), _mm_cmpgt_epi8(_mm_set1_epi8((char)(hi + 1)), chunk));
 }
 
-typedef void(unchecked_append_canonicalized_character_fn)(struct aws_byte_buf *buffer, uint8_t value);
+static __m128i s_sse2_equals(__m128i chunk, char value) {
+    return _mm_cmpeq_epi8(chunk, _mm_set1_epi8(value));
+}
 
-/*
- * Appends a character or its hex encoding to the buffer.  We reserve enough space up front so that
- * we can do this with raw pointers rather than multiple function calls/cursors/etc...
- *
- * This function is for the uri path
- */
-static void s_unchecked_append_canonicalized_path_character(struct aws_byte_buf *buffer, uint8_t value) {
-    AWS_ASSERT(buffer->len + 3 <= buffer->capacity);
+/* 16 bits, one per byte of chunk, set for the bytes that don't need encoding */
+static int s_sse2_unreserved_mask(__m128i chunk, enum uri_unreserved_flag flag) {
+    /* folding case makes the letters one range, and moves nothing else into it */
+    __m128i unreserved = _mm_or_si128(
+        s_sse2_in_range(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), 'a', 'z'), s_sse2_in_range(chunk, '0', '9'));
 
-    uint8_t *dest_ptr = buffer->buffer + buffer->len;
+    unreserved = _mm_or_si128(unreserved, _mm_or_si128(s_sse2_equals(chunk, '-'), s_sse2_equals(chunk, '_')));
+    unreserved = _mm_or_si128(unreserved, _mm_or_si128(s_sse2_equals(chunk, '.'), s_sse2_equals(chunk, '~')));
 
-    if (aws_isalnum(value)) {
-        ++buffer->len;
-        *dest_ptr = value;
-        return;
+    if (flag == URI_PATH_UNRESERVED) {
+        /* $&,/ are 0x24, 0x26, 0x2C, 0x2F and :;=@ are 0x3A, 0x3B, 0x3D, 0x40 */
+        unreserved = _mm_or_si128(unreserved, _mm_or_si128(s_sse2_equals(chunk, '$'), s_sse2_equals(chunk, '&')));
+        unreserved = _mm_or_si128(unreserved, _mm_or_si128(s_sse2_equals(chunk, ','), s_sse2_equals(chunk, '/')));
+        unreserved = _mm_or_si128(unreserved, s_sse2_in_range(chunk, ':', ';'));
+        unreserved = _mm_or_si128(unreserved, _mm_or_si128(s_sse2_equals(chunk, '='), s_sse2_equals(chunk, '@')));
     }
 
-    switch (value) {
-        case '-':
-        case '_':
-        case '.':
-        case '~':
-        case '$':
-        case '&':
-        case ',':
-        case '/':
-        case ':':
-        case ';':
-        case '=':
-        case '@': {
-            ++buffer->len;
-            *dest_ptr = value;
-            return;
-        }
-
-        default:
-            buffer->len += 3;
-            *dest_ptr++ = '%';
-            *dest_ptr++ = s_to_uppercase_hex(value >> 4);
-            *dest_ptr = s_to_uppercase_hex(value & 0x0F);
-            return;
-    }
+    return _mm_movemask_epi8(unreserved);
 }
+#endif /* AWS_URI_SSE2 */
 
 /*
- * Appends a character or its hex encoding to the buffer.  We reserve enough space up front so that
- * we can do this with raw pointers rather than multiple function calls/cursors/etc...
- *
- * This function is for query params
+ * Returns how many bytes from the start of input can be copied as is. Most of a typical path or param is
+ * alphanumeric, so this is where encoding spends its time.
  */
-static void s_raw_append_canonicalized_param_character(struct aws_byte_buf *buffer, uint8_t value) {
-    AWS_ASSERT(buffer->len + 3 <= buffer->capacity);
-
-    uint8_t *dest_ptr = buffer->buffer + buffer->len;
-
-    if (aws_isalnum(value)) {
-        ++buffer->len;
-        *dest_ptr = value;
-        return;
-    }
-
-    switch (value) {
-        case '-':
-        case '_':
-        case '.':
-        case '~': {
-            ++buffer->len;
-            *dest_ptr = value;
-            return;
+static size_t s_unreserved_run_length(const uint8_t *input, size_t length, enum uri_unreserved_flag flag) {
+    size_t run = 0;
+
+#ifdef AWS_URI_SSE2
+    /* 16 at a time, until a chunk has something to encode in it, then finish that chunk a byte at a time */
+    while (length - run >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(input + run));
+        if (s_sse2_unreserved_mask(chunk, flag) != 0xFFFF) {
+            break;
         }
+        run += 16;
+    }
+#endif
 
-        default:
-            buffer->len += 3;
-            *dest_ptr++ = '%';
-            *dest_ptr++ = s_to_uppercase_hex(value >> 4);
-            *dest_ptr = s_to_uppercase_hex(value & 0x0F);
-            return;
+    while (run < length && (s_uri_unreserved_table[input[run]] & flag)) {
+        ++run;
     }
+
+    return run;
 }
 
 /*
- * Writes a cursor to a buffer using the supplied encoding function.
+ * Writes a cursor to a buffer, copying runs of unreserved characters in bulk and %-encoding everything else.
  */
 static int s_encode_cursor_to_buffer(
     struct aws_byte_buf *buffer,
     const struct aws_byte_cursor *cursor,
-    unchecked_append_canonicalized_character_fn *append_canonicalized_character) {
-    uint8_t *current_ptr = cursor->ptr;
-    uint8_t *end_ptr = cursor->ptr + cursor->len;
+    enum uri_unreserved_flag flag) {
 
     /*
      * reserve room up front for the worst possible case: everything gets % encoded
@@ -521,20 +548,42 @@ static int s_encode_cursor_to_buffer(
         return AWS_OP_ERR;
     }
 
-    while (current_ptr < end_ptr) {
-        append_canonicalized_character(buffer, *current_ptr);
-        ++current_ptr;
+    /* with room for the worst case reserved, write through raw pointers */
+    const uint8_t *current_ptr = cursor->ptr;
+    size_t remaining = cursor->len;
+    uint8_t *dest_ptr = buffer->buffer + buffer->len;
+
+    while (remaining > 0) {
+        size_t run = s_unreserved_run_length(current_ptr, remaining, flag);
+        if (run > 0) {
+            memcpy(dest_ptr, current_ptr, run);
+            dest_ptr += run;
+            current_ptr += run;
+            remaining -= run;
+            if (remaining == 0) {
+                break;
+            }
+        }
+
+        uint8_t value = *current_ptr++;
+        --remaining;
+        *dest_ptr++ = '%';
+        *dest_ptr++ = s_uppercase_hex_digits[value >> 4];
+        *dest_ptr++ = s_uppercase_hex_digits[value & 0x0F];
     }
 
+    buffer->len = (size_t)(dest_ptr - buffer->buffer);
+    AWS_ASSERT(buffer->len <= buffer->capacity);
+
     return AWS_OP_SUCCESS;
 }
 
 int aws_byte_buf_append_encoding_uri_path(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor) {
-    return s_encode_cursor_to_buffer(buffer, cursor, s_unchecked_append_canonicalized_path_character);
+    return s_encode_cursor_to_buffer(buffer, cursor, URI_PATH_UNRESERVED);
 }
 
 int aws_byte_buf_append_encoding_uri_param(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor) {
-    return s_encode_cursor_to_buffer(buffer, cursor, s_raw_append_canonicalized_param_character);
+    return s_encode_cursor_to_buffer(buffer, cursor, URI_PARAM_UNRESERVED);
 }
 
 int aws_byte_buf_append_decoding_uri(struct aws_byte_buf *buffer, const struct aws_byte_cursor *cursor) {
@@ -543,16 +592,26 @@ int aws_byte_buf_append_decoding_uri(struct aws_byte_buf *buffer, const struct a
         return AWS_OP_ERR;
     }
 
-    /* advance over cursor */
+    /* advance over cursor, copying everything up to the next % in bulk. memchr() is vectorized by any libc worth
+     * using, so there's no need for a hand-written scan here */
     struct aws_byte_cursor advancing = *cursor;
-    uint8_t c;
-    while (aws_byte_cursor_read_u8(&advancing, &c)) {
+    while (advancing.len > 0) {
+        const uint8_t *percent_ptr = memchr(advancing.ptr, '%', advancing.len);
+        size_t run = percent_ptr ? (size_t)(percent_ptr - advancing.ptr) : advancing.len;
 
-        if (c == '%') {
-            /* two hex characters following '%' are the byte's value */
-            if (AWS_UNLIKELY(aws_byte_cursor_read_hex_u8(&advancing, &c) == false)) {
-                return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
-            }
+        memcpy(buffer->buffer + buffer->len, advancing.ptr, run);
+        buffer->len += run;
+        aws_byte_cursor_advance(&advancing, run);
+
+        if (advancing.len == 0) {
+            break;
+        }
+
+        /* two hex characters following '%' are the byte's value */
+        aws_byte_cursor_advance(&advancing, 1);
+        uint8_t c;
+        if (AWS_UNLIKELY(aws_byte_cursor_read_hex_u8(&advancing, &c) == false)) {
+            return aws_raise_error(AWS_ERROR_MALFORMED_INPUT_STRING);
         }
 
         buffer->buffer[buffer->len++] = c;
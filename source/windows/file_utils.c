@@ -4,12 +4,15 @@
  */
 
 #include <aws/io/file_utils.h>
+#include <aws/io/private/file_mapping.h>
+#include <aws/io/private/positional_file.h>
 
 #include <aws/common/environment.h>
 #include <aws/common/string.h>
 
 #include <Shlwapi.h>
 #include <io.h>
+#include <string.h>
 
 char aws_get_platform_directory_separator(void) {
     return '\\';
@@ -113,3 +116,191 @@ int aws_file_get_length(FILE *file, int64_t *length) {
 
     return AWS_OP_SUCCESS;
 }
+
+int aws_directory_for_each_entry(
+    struct aws_allocator *allocator,
+    const char *path,
+    aws_directory_entry_fn *on_entry,
+    void *user_data) {
+
+    struct aws_byte_buf entry_path;
+    if (aws_byte_buf_init(&entry_path, allocator, strlen(path) + MAX_PATH)) {
+        return AWS_OP_ERR;
+    }
+
+    struct aws_byte_cursor dir_cursor = aws_byte_cursor_from_c_str(path);
+    struct aws_byte_cursor separator = aws_byte_cursor_from_c_str("\\");
+    struct aws_byte_cursor wildcard = aws_byte_cursor_from_c_str("*");
+    if (aws_byte_buf_append_dynamic(&entry_path, &dir_cursor) ||
+        aws_byte_buf_append_dynamic(&entry_path, &separator) || aws_byte_buf_append_dynamic(&entry_path, &wildcard) ||
+        aws_byte_buf_append_byte_dynamic(&entry_path, 0)) {
+        aws_byte_buf_clean_up(&entry_path);
+        return AWS_OP_ERR;
+    }
+
+    WIN32_FIND_DATAA find_data;
+    HANDLE find_handle = FindFirstFileA((const char *)entry_path.buffer, &find_data);
+    if (find_handle == INVALID_HANDLE_VALUE) {
+        DWORD error = GetLastError();
+        aws_byte_buf_clean_up(&entry_path);
+        return aws_raise_error(
+            error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND ? AWS_ERROR_FILE_INVALID_PATH
+                                                                           : AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    int result = AWS_OP_SUCCESS;
+    for (;;) {
+        if (strcmp(find_data.cFileName, ".") && strcmp(find_data.cFileName, "..")) {
+            struct aws_directory_entry entry;
+            AWS_ZERO_STRUCT(entry);
+            entry.name = aws_byte_cursor_from_c_str(find_data.cFileName);
+            entry.is_directory = (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+            entry.is_file = !entry.is_directory && (find_data.dwFileAttributes & FILE_ATTRIBUTE_DEVICE) == 0;
+
+            /* the path is rebuilt in the same buffer for every entry, it only grows for the longest name */
+            entry_path.len = 0;
+            if (aws_byte_buf_append_dynamic(&entry_path, &dir_cursor) ||
+                aws_byte_buf_append_dynamic(&entry_path, &separator) ||
+                aws_byte_buf_append_dynamic(&entry_path, &entry.name)) {
+                result = AWS_OP_ERR;
+                break;
+            }
+            entry.path = aws_byte_cursor_from_buf(&entry_path);
+
+            if (!on_entry(&entry, user_data)) {
+                break;
+            }
+        }
+
+        if (!FindNextFileA(find_handle, &find_data)) {
+            if (GetLastError() != ERROR_NO_MORE_FILES) {
+                result = aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+            }
+            break;
+        }
+    }
+
+    FindClose(find_handle);
+    aws_byte_buf_clean_up(&entry_path);
+
+    return result;
+}
+
+int aws_file_mapping_init(struct aws_file_mapping *mapping, const char *file_name, bool advise_sequential) {
+    AWS_ZERO_STRUCT(*mapping);
+
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (advise_sequential) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+
+    HANDLE os_file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, flags, NULL);
+    if (os_file == INVALID_HANDLE_VALUE) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    LARGE_INTEGER os_size;
+    if (!GetFileSizeEx(os_file, &os_size) || os_size.QuadPart < 0) {
+        CloseHandle(os_file);
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+#if SIZE_MAX < UINT64_MAX
+    if ((uint64_t)os_size.QuadPart > SIZE_MAX) {
+        CloseHandle(os_file);
+        return aws_raise_error(AWS_ERROR_OVERFLOW_DETECTED);
+    }
+#endif
+
+    /* CreateFileMapping() refuses empty files */
+    if (os_size.QuadPart > 0) {
+        HANDLE os_mapping = CreateFileMappingA(os_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!os_mapping) {
+            CloseHandle(os_file);
+            return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+        }
+
+        void *address = MapViewOfFile(os_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!address) {
+            CloseHandle(os_mapping);
+            CloseHandle(os_file);
+            return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+        }
+
+        mapping->address = address;
+        mapping->length = (size_t)os_size.QuadPart;
+        mapping->os_handle = os_mapping;
+    }
+
+    /* the mapping keeps the file open on its own */
+    CloseHandle(os_file);
+    return AWS_OP_SUCCESS;
+}
+
+void aws_file_mapping_clean_up(struct aws_file_mapping *mapping) {
+    if (mapping->address) {
+        UnmapViewOfFile(mapping->address);
+        CloseHandle(mapping->os_handle);
+    }
+
+    AWS_ZERO_STRUCT(*mapping);
+}
+
+int aws_positional_file_open(struct aws_positional_file *file, const char *file_name) {
+    AWS_ZERO_STRUCT(*file);
+
+    /* FILE_SHARE_READ only, so nobody can truncate the file under the readers */
+    HANDLE os_file =
+        CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (os_file == INVALID_HANDLE_VALUE) {
+        return aws_raise_error(AWS_IO_FILE_VALIDATION_FAILURE);
+    }
+
+    LARGE_INTEGER os_size;
+    if (!GetFileSizeEx(os_file, &os_size) || os_size.QuadPart < 0) {
+        CloseHandle(os_file);
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    FILETIME write_time;
+    if (!GetFileTime(os_file, NULL, NULL, &write_time)) {
+        CloseHandle(os_file);
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    /* FILETIME counts 100ns intervals since 1601 */
+    file->length = os_size.QuadPart;
+    file->modification_time_ns =
+        ((((uint64_t)write_time.dwHighDateTime) << 32) | (uint64_t)write_time.dwLowDateTime) * 100;
+    file->os_handle = (intptr_t)os_file;
+
+    return AWS_OP_SUCCESS;
+}
+
+int aws_positional_file_read(const struct aws_positional_file *file, uint64_t offset, struct aws_byte_buf *dest) {
+    size_t max_read = dest->capacity - dest->len;
+    DWORD to_read = max_read > MAXDWORD ? MAXDWORD : (DWORD)max_read;
+
+    /* the offset in OVERLAPPED makes this a positional read, even on a handle opened for synchronous I/O */
+    OVERLAPPED overlapped;
+    AWS_ZERO_STRUCT(overlapped);
+    overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+    DWORD actually_read = 0;
+    if (!ReadFile((HANDLE)file->os_handle, dest->buffer + dest->len, to_read, &actually_read, &overlapped)) {
+        if (GetLastError() != ERROR_HANDLE_EOF) {
+            return aws_raise_error(AWS_IO_STREAM_READ_FAILED);
+        }
+    }
+
+    dest->len += actually_read;
+
+    return AWS_OP_SUCCESS;
+}
+
+void aws_positional_file_close(struct aws_positional_file *file) {
+    CloseHandle((HANDLE)file->os_handle);
+
+    AWS_ZERO_STRUCT(*file);
+}
@@ -10,6 +10,7 @@
 #include <aws/common/string.h>
 #include <aws/io/host_resolver.h>
 #include <aws/io/logging.h>
+#include <aws/io/private/dns_message.h>
 #include <aws/io/socket.h>
 
 int aws_default_dns_resolve(
@@ -111,3 +112,9 @@ clean_up:
 
     return AWS_OP_ERR;
 }
+
+int aws_dns_load_system_nameservers(struct aws_array_list *out_nameservers) {
+    (void)out_nameservers;
+    /* would need GetAdaptersAddresses(), until then callers have to name their nameservers explicitly. */
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
@@ -0,0 +1,44 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/huge_pages.h>
+
+#include <windows.h>
+
+int aws_huge_page_slab_init(struct aws_huge_page_slab *slab, size_t size) {
+    AWS_ZERO_STRUCT(*slab);
+
+    if (size == 0 || size > SIZE_MAX - AWS_HUGE_PAGE_SIZE) {
+        return aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+    }
+    size_t length = (size + AWS_HUGE_PAGE_SIZE - 1) / AWS_HUGE_PAGE_SIZE * AWS_HUGE_PAGE_SIZE;
+
+    /* large pages need the lock-pages privilege (SeLockMemoryPrivilege) and a multiple of the large page size */
+    void *address = NULL;
+    size_t large_page_size = GetLargePageMinimum();
+    if (large_page_size && length % large_page_size == 0) {
+        address = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        slab->is_reserved = address != NULL;
+    }
+
+    if (!address) {
+        address = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!address) {
+            return aws_raise_error(AWS_ERROR_OOM);
+        }
+    }
+
+    slab->address = address;
+    slab->length = length;
+    return AWS_OP_SUCCESS;
+}
+
+void aws_huge_page_slab_clean_up(struct aws_huge_page_slab *slab) {
+    if (slab->address) {
+        VirtualFree(slab->address, 0, MEM_RELEASE);
+    }
+
+    AWS_ZERO_STRUCT(*slab);
+}
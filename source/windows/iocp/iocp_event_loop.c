@@ -11,6 +11,7 @@
 #include <aws/common/thread.h>
 
 #include <aws/io/logging.h>
+#include <aws/io/private/iocp.h>
 
 /* The next set of struct definitions are taken directly from the
     windows documentation. We can't include the header files directly
@@ -61,6 +62,7 @@ typedef enum event_thread_state {
 struct iocp_loop {
     HANDLE iocp_handle;
     struct aws_thread thread_created_on;
+    struct aws_thread_options thread_options;
     aws_thread_id_t thread_joined_to;
     struct aws_atomic_var running_thread_id;
 
@@ -78,6 +80,15 @@ struct iocp_loop {
     struct {
         struct aws_task_scheduler scheduler;
 
+        /* buffer GetQueuedCompletionStatusEx() fills in */
+        OVERLAPPED_ENTRY *completion_packets;
+        size_t completion_packets_capacity;
+        /* bounds the buffer moves between in adaptive mode. Equal if adaptive mode is off */
+        size_t min_completion_packets_capacity;
+        size_t max_completion_packets_capacity;
+        /* consecutive ticks that used a small fraction of the buffer */
+        size_t underused_tick_count;
+
         /* These variables duplicate ones in synced_data.
          * We move values out while holding the mutex and operate on them later */
         event_thread_state state;
@@ -87,8 +98,11 @@ struct iocp_loop {
 enum {
     DEFAULT_TIMEOUT_MS = 100000,
 
-    /* Max I/O completion packets to process per loop of the event-thread */
-    MAX_COMPLETION_PACKETS_PER_LOOP = 100,
+    /* I/O completion packets to process per loop of the event-thread, unless the options say otherwise */
+    DEFAULT_MAX_COMPLETION_PACKETS = 100,
+    DEFAULT_ADAPTIVE_MAX_COMPLETION_PACKETS = 1024,
+    /* in adaptive mode, the buffer shrinks after this many ticks in a row used a quarter of it or less */
+    ADAPTIVE_SHRINK_TICKS = 64,
 };
 
 static void s_destroy(struct aws_event_loop *event_loop);
@@ -135,9 +149,14 @@ struct aws_event_loop_vtable s_iocp_vtable = {
     .free_io_event_resources = s_free_io_event_resources,
 };
 
-struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, aws_io_clock_fn *clock) {
+struct aws_event_loop *aws_event_loop_new_default_with_options(
+    struct aws_allocator *alloc,
+    const struct aws_event_loop_options *options) {
     AWS_ASSERT(alloc);
-    AWS_ASSERT(clock);
+    AWS_ASSERT(options);
+    AWS_ASSERT(options->clock);
+
+    aws_io_clock_fn *clock = options->clock;
 
     if (!s_set_info_fn) {
         HMODULE ntdll = GetModuleHandleA("ntdll.dll");
@@ -207,6 +226,7 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
         goto clean_up;
     }
     clean_up_thread = true;
+    impl->thread_options = options->thread_options ? *options->thread_options : *aws_default_thread_options();
 
     err = aws_mutex_init(&impl->synced_data.mutex);
     if (err) {
@@ -222,6 +242,30 @@ struct aws_event_loop *aws_event_loop_new_default(struct aws_allocator *alloc, a
     }
     clean_up_scheduler = true;
 
+    impl->thread_data.min_completion_packets_capacity =
+        options->events_per_tick ? options->events_per_tick : DEFAULT_MAX_COMPLETION_PACKETS;
+    impl->thread_data.max_completion_packets_capacity = impl->thread_data.min_completion_packets_capacity;
+    if (options->adaptive_events_per_tick) {
+        impl->thread_data.max_completion_packets_capacity =
+            options->max_events_per_tick ? options->max_events_per_tick : DEFAULT_ADAPTIVE_MAX_COMPLETION_PACKETS;
+        if (impl->thread_data.max_completion_packets_capacity < impl->thread_data.min_completion_packets_capacity) {
+            impl->thread_data.max_completion_packets_capacity = impl->thread_data.min_completion_packets_capacity;
+        }
+    }
+
+    /* GetQueuedCompletionStatusEx() takes the buffer size as a ULONG */
+    if (impl->thread_data.max_completion_packets_capacity > MAXULONG) {
+        aws_raise_error(AWS_ERROR_INVALID_ARGUMENT);
+        goto clean_up;
+    }
+
+    impl->thread_data.completion_packets_capacity = impl->thread_data.min_completion_packets_capacity;
+    impl->thread_data.completion_packets =
+        aws_mem_calloc(alloc, impl->thread_data.completion_packets_capacity, sizeof(OVERLAPPED_ENTRY));
+    if (!impl->thread_data.completion_packets) {
+        goto clean_up;
+    }
+
     event_loop->impl_data = impl;
 
     event_loop->vtable = &s_iocp_vtable;
@@ -247,6 +291,7 @@ clean_up:
     }
 
     if (impl) {
+        aws_mem_release(alloc, impl->thread_data.completion_packets);
         aws_mem_release(alloc, impl);
     }
 
@@ -303,6 +348,7 @@ static void s_destroy(struct aws_event_loop *event_loop) {
 
     aws_mutex_clean_up(&impl->synced_data.mutex);
     aws_thread_clean_up(&impl->thread_created_on);
+    aws_mem_release(event_loop->alloc, impl->thread_data.completion_packets);
     aws_mem_release(event_loop->alloc, impl);
     aws_event_loop_clean_up_base(event_loop);
     aws_mem_release(event_loop->alloc, event_loop);
@@ -339,7 +385,7 @@ static int s_run(struct aws_event_loop *event_loop) {
     impl->synced_data.state = EVENT_THREAD_STATE_RUNNING;
 
     AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: Starting event-loop thread.", (void *)event_loop);
-    int err = aws_thread_launch(&impl->thread_created_on, s_event_thread_main, event_loop, NULL);
+    int err = aws_thread_launch(&impl->thread_created_on, s_event_thread_main, event_loop, &impl->thread_options);
     if (err) {
         AWS_LOGF_FATAL(AWS_LS_IO_EVENT_LOOP, "id=%p: thread creation failed.", (void *)event_loop);
         goto clean_up;
@@ -480,6 +526,12 @@ static bool s_is_event_thread(struct aws_event_loop *event_loop) {
 }
 
 /* Called from any thread */
+void *aws_iocp_event_loop_get_completion_port(struct aws_event_loop *event_loop) {
+    AWS_ASSERT(event_loop->vtable == &s_iocp_vtable);
+    struct iocp_loop *impl = event_loop->impl_data;
+    return impl->iocp_handle;
+}
+
 static int s_connect_to_io_completion_port(struct aws_event_loop *event_loop, struct aws_io_handle *handle) {
     struct iocp_loop *impl = event_loop->impl_data;
     AWS_ASSERT(impl);
@@ -623,6 +675,54 @@ static void s_free_io_event_resources(void *user_data) {
     (void)user_data;
 }
 
+/* In adaptive mode, grows the completion packet buffer when GetQueuedCompletionStatusEx() filled it, and shrinks it
+ * after a stretch of ticks that barely used it. This only runs on the event-thread, between calls to
+ * GetQueuedCompletionStatusEx(). */
+static void s_adapt_completion_packets_capacity(struct aws_event_loop *event_loop, ULONG num_entries) {
+    struct iocp_loop *impl = event_loop->impl_data;
+
+    if (impl->thread_data.min_completion_packets_capacity == impl->thread_data.max_completion_packets_capacity) {
+        return;
+    }
+
+    size_t capacity = impl->thread_data.completion_packets_capacity;
+    size_t new_capacity = capacity;
+
+    if (num_entries == capacity) {
+        impl->thread_data.underused_tick_count = 0;
+        new_capacity = aws_min_size(capacity * 2, impl->thread_data.max_completion_packets_capacity);
+    } else if (num_entries <= capacity / 4) {
+        if (++impl->thread_data.underused_tick_count >= ADAPTIVE_SHRINK_TICKS) {
+            impl->thread_data.underused_tick_count = 0;
+            new_capacity = aws_max_size(capacity / 2, impl->thread_data.min_completion_packets_capacity);
+        }
+    } else {
+        impl->thread_data.underused_tick_count = 0;
+    }
+
+    if (new_capacity == capacity) {
+        return;
+    }
+
+    /* the old contents have been processed already, no need to preserve them */
+    OVERLAPPED_ENTRY *new_packets = aws_mem_calloc(event_loop->alloc, new_capacity, sizeof(OVERLAPPED_ENTRY));
+    if (!new_packets) {
+        /* not fatal, keep going with the buffer we have. */
+        return;
+    }
+
+    AWS_LOGF_DEBUG(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: resizing completion packets per tick from %zu to %zu",
+        (void *)event_loop,
+        capacity,
+        new_capacity);
+
+    aws_mem_release(event_loop->alloc, impl->thread_data.completion_packets);
+    impl->thread_data.completion_packets = new_packets;
+    impl->thread_data.completion_packets_capacity = new_capacity;
+}
+
 /* Called from event-thread */
 static void s_event_thread_main(void *user_data) {
     struct aws_event_loop *event_loop = user_data;
@@ -638,22 +738,29 @@ static void s_event_thread_main(void *user_data) {
 
     DWORD timeout_ms = DEFAULT_TIMEOUT_MS;
 
-    OVERLAPPED_ENTRY completion_packets[MAX_COMPLETION_PACKETS_PER_LOOP];
-    AWS_ZERO_ARRAY(completion_packets);
-
-    AWS_LOGF_INFO(AWS_LS_IO_EVENT_LOOP, "id=%p: default timeout %d", (void *)event_loop, (int)timeout_ms);
+    AWS_LOGF_INFO(
+        AWS_LS_IO_EVENT_LOOP,
+        "id=%p: default timeout %d, max completion packets per tick %zu (adaptive up to %zu)",
+        (void *)event_loop,
+        (int)timeout_ms,
+        impl->thread_data.min_completion_packets_capacity,
+        impl->thread_data.max_completion_packets_capacity);
 
     while (impl->thread_data.state == EVENT_THREAD_STATE_RUNNING) {
         ULONG num_entries = 0;
         bool should_process_synced_data = false;
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: waiting for a maximum of %d ms", (void *)event_loop, timeout_ms);
+        OVERLAPPED_ENTRY *completion_packets = impl->thread_data.completion_packets;
+        ULONG max_entries = (ULONG)impl->thread_data.completion_packets_capacity;
         bool has_completion_entries = GetQueuedCompletionStatusEx(
-            impl->iocp_handle,               /* Completion port */
-            completion_packets,              /* Out: completion port entries */
-            MAX_COMPLETION_PACKETS_PER_LOOP, /* max number of entries to remove */
-            &num_entries,                    /* Out: number of entries removed */
-            timeout_ms,                      /* Timeout in ms. If timeout reached then FALSE is returned. */
-            false);                          /* fAlertable */
+            impl->iocp_handle,  /* Completion port */
+            completion_packets, /* Out: completion port entries */
+            max_entries,        /* max number of entries to remove */
+            &num_entries,       /* Out: number of entries removed */
+            timeout_ms,         /* Timeout in ms. If timeout reached then FALSE is returned. */
+            false);             /* fAlertable */
+
+        aws_event_loop_register_tick_start(event_loop);
 
         if (has_completion_entries) {
             AWS_LOGF_TRACE(
@@ -677,11 +784,13 @@ static void s_event_thread_main(void *user_data) {
 
                     if (overlapped->on_completion) {
                         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: invoking handler.", (void *)event_loop);
+                        uint64_t start_ns = aws_event_loop_profiler_begin(event_loop);
                         overlapped->on_completion(
                             event_loop,
                             overlapped,
                             (int)overlapped->overlapped.Internal, /* Status code for the completed request */
                             completion->dwNumberOfBytesTransferred);
+                        aws_event_loop_profiler_end(event_loop, "io_event", start_ns);
                     }
                 }
             }
@@ -702,6 +811,10 @@ static void s_event_thread_main(void *user_data) {
         AWS_LOGF_TRACE(AWS_LS_IO_EVENT_LOOP, "id=%p: running scheduled tasks.", (void *)event_loop);
         aws_task_scheduler_run_all(&impl->thread_data.scheduler, now_ns);
 
+        aws_event_loop_register_tick_end(event_loop, has_completion_entries ? (size_t)num_entries : 0);
+
+        s_adapt_completion_packets_capacity(event_loop, has_completion_entries ? num_entries : 0);
+
         /* Set timeout for next GetQueuedCompletionStatus() call.
          * If clock fails, or scheduler has no tasks, use default timeout */
         bool use_default_timeout = false;
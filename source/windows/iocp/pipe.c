@@ -612,6 +612,23 @@ int aws_pipe_unsubscribe_from_readable_events(struct aws_pipe_read_end *read_end
     return AWS_OP_SUCCESS;
 }
 
+int aws_pipe_splice_to_socket(
+    struct aws_pipe_read_end *read_end,
+    struct aws_socket *socket,
+    size_t max_bytes,
+    size_t *num_bytes_spliced) {
+    (void)read_end;
+    (void)socket;
+    (void)max_bytes;
+
+    if (num_bytes_spliced) {
+        *num_bytes_spliced = 0;
+    }
+
+    /* named pipes have no zero-copy path to a socket */
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 int aws_pipe_read(struct aws_pipe_read_end *read_end, struct aws_byte_buf *dst_buffer, size_t *amount_read) {
     AWS_ASSERT(dst_buffer && dst_buffer->buffer);
 
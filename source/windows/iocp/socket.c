@@ -21,13 +21,17 @@ below, clang-format doesn't work (at least on my version) with the c-style comme
 #include <aws/common/condition_variable.h>
 #include <aws/common/mutex.h>
 #include <aws/common/task_scheduler.h>
+#include <aws/common/thread.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/logging.h>
 #include <aws/io/pipe.h>
+#include <aws/io/private/iocp.h>
+#include <aws/io/statistics.h>
 
 #include <aws/io/io.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -73,6 +77,11 @@ struct socket_vtable {
     int (*bind)(struct aws_socket *socket, const struct aws_socket_endpoint *local_endpoint);
     int (*listen)(struct aws_socket *socket, int backlog_size);
     int (*read)(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
+    int (*read_vectored)(
+        struct aws_socket *socket,
+        struct aws_byte_buf *const *buffers,
+        size_t buffer_count,
+        size_t *amount_read);
     int (*subscribe_to_read)(struct aws_socket *socket, aws_socket_on_readable_fn *on_readable, void *user_data);
 };
 
@@ -134,6 +143,16 @@ static int s_local_listen(struct aws_socket *socket, int backlog_size);
 static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
 static int s_local_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
 static int s_dgram_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read);
+static int s_winsock_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read);
+static int s_local_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read);
 static int s_socket_close(struct aws_socket *socket);
 static int s_local_close(struct aws_socket *socket);
 static int s_ipv4_stream_bind(struct aws_socket *socket, const struct aws_socket_endpoint *local_endpoint);
@@ -171,6 +190,7 @@ static struct socket_vtable vtables[3][2] = {
                     .bind = s_ipv4_stream_bind,
                     .listen = s_tcp_listen,
                     .read = s_tcp_read,
+                    .read_vectored = s_winsock_read_vectored,
                     .close = s_socket_close,
                     .subscribe_to_read = s_stream_subscribe_to_read,
                 },
@@ -184,6 +204,7 @@ static struct socket_vtable vtables[3][2] = {
                     .bind = s_ipv4_dgram_bind,
                     .listen = s_udp_listen,
                     .read = s_dgram_read,
+                    .read_vectored = s_winsock_read_vectored,
                     .close = s_socket_close,
                     .subscribe_to_read = s_dgram_subscribe_to_read,
                 },
@@ -200,6 +221,7 @@ static struct socket_vtable vtables[3][2] = {
                     .bind = s_ipv6_stream_bind,
                     .listen = s_tcp_listen,
                     .read = s_tcp_read,
+                    .read_vectored = s_winsock_read_vectored,
                     .close = s_socket_close,
                     .subscribe_to_read = s_stream_subscribe_to_read,
                 },
@@ -213,6 +235,7 @@ static struct socket_vtable vtables[3][2] = {
                     .bind = s_ipv6_dgram_bind,
                     .listen = s_udp_listen,
                     .read = s_dgram_read,
+                    .read_vectored = s_winsock_read_vectored,
                     .close = s_socket_close,
                     .subscribe_to_read = s_dgram_subscribe_to_read,
                 },
@@ -229,6 +252,7 @@ static struct socket_vtable vtables[3][2] = {
                     .bind = s_local_bind,
                     .listen = s_local_listen,
                     .read = s_local_read,
+                    .read_vectored = s_local_read_vectored,
                     .close = s_local_close,
                     .subscribe_to_read = s_stream_subscribe_to_read,
                 },
@@ -294,9 +318,17 @@ struct io_operation_data {
     bool in_use;
 };
 
+struct rio_receive_ring;
+
+#if !defined(AWS_SUPPORT_WIN7)
+static void s_rio_release(struct aws_socket *socket);
+#endif
+
 struct iocp_socket {
     struct socket_vtable *vtable;
     struct io_operation_data *read_io_data;
+    /* set while reads come from Registered I/O, see use_registered_io */
+    struct rio_receive_ring *rio;
     struct aws_socket *incoming_socket;
     uint8_t accept_buffer[SOCK_STORAGE_SIZE * 2];
     struct socket_connect_args *connect_args;
@@ -305,7 +337,21 @@ struct iocp_socket {
 };
 
 static int s_create_socket(struct aws_socket *sock, const struct aws_socket_options *options) {
-    SOCKET handle = socket(s_convert_domain(options->domain), s_convert_type(options->type), 0);
+    SOCKET handle = INVALID_SOCKET;
+#if !defined(AWS_SUPPORT_WIN7)
+    if (options->use_registered_io && options->type == AWS_SOCKET_STREAM) {
+        handle = WSASocketW(
+            s_convert_domain(options->domain),
+            s_convert_type(options->type),
+            0,
+            NULL,
+            0,
+            WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    }
+#endif
+    if (handle == INVALID_SOCKET) {
+        handle = socket(s_convert_domain(options->domain), s_convert_type(options->type), 0);
+    }
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: initializing with domain %d and type %d",
@@ -390,6 +436,20 @@ int aws_socket_init(struct aws_socket *socket, struct aws_allocator *alloc, cons
     return err;
 }
 
+int aws_socket_init_from_handle(
+    struct aws_socket *socket,
+    struct aws_allocator *alloc,
+    const struct aws_socket_options *options,
+    const struct aws_io_handle *handle) {
+    (void)socket;
+    (void)alloc;
+    (void)options;
+    (void)handle;
+
+    AWS_LOGF_ERROR(AWS_LS_IO_SOCKET, "adopting an existing handle is not supported on this platform");
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
 void aws_socket_clean_up(struct aws_socket *socket) {
     if (!socket->impl) {
         /* protect from double clean */
@@ -515,6 +575,41 @@ int aws_socket_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size
     return socket_impl->vtable->read(socket, buffer, amount_read);
 }
 
+int aws_socket_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+    struct iocp_socket *socket_impl = socket->impl;
+    AWS_ASSERT(socket->readable_fn);
+    AWS_ASSERT(buffers || buffer_count == 0);
+
+    if (!aws_event_loop_thread_is_callers_thread(socket->event_loop)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: Read can only be called from the owning event-loop's thread.",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        return aws_raise_error(AWS_ERROR_IO_EVENT_LOOP_THREAD_ONLY);
+    }
+
+    if (!(socket->state & CONNECTED_READ)) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: Attempt to read from an unconnected socket.",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        return aws_raise_error(AWS_IO_SOCKET_NOT_CONNECTED);
+    }
+
+    if (buffer_count == 0) {
+        *amount_read = 0;
+        return AWS_OP_SUCCESS;
+    }
+
+    return socket_impl->vtable->read_vectored(socket, buffers, buffer_count, amount_read);
+}
+
 int aws_socket_subscribe_to_readable_events(
     struct aws_socket *socket,
     aws_socket_on_readable_fn *on_readable,
@@ -2219,6 +2314,16 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
         return aws_raise_error(AWS_IO_SOCKET_INVALID_OPTIONS);
     }
 
+    /* SO_REUSEADDR already lets any socket steal a bound port here, there's no load balanced equivalent. */
+    if (options->reuse_port) {
+        AWS_LOGF_ERROR(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: SO_REUSEPORT is not supported on windows.",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle);
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
     AWS_LOGF_DEBUG(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: setting socket options to: keep-alive %d, keep idle %d, keep-alive interval %d, max failed "
@@ -2232,7 +2337,103 @@ int aws_socket_set_options(struct aws_socket *socket, const struct aws_socket_op
 
     socket->options = *options;
 
+    /* local sockets are named pipes here, which size their buffers when created. */
+    if (socket->options.domain != AWS_SOCKET_LOCAL) {
+        if (socket->options.send_buffer_size) {
+            int send_buffer_size =
+                socket->options.send_buffer_size > INT_MAX ? INT_MAX : (int)socket->options.send_buffer_size;
+            if (setsockopt(
+                    (SOCKET)socket->io_handle.data.handle,
+                    SOL_SOCKET,
+                    SO_SNDBUF,
+                    (char *)&send_buffer_size,
+                    sizeof(send_buffer_size))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: setsockopt() call for SO_SNDBUF failed with WSAError %d",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    WSAGetLastError());
+            }
+        }
+
+        if (socket->options.recv_buffer_size) {
+            int recv_buffer_size =
+                socket->options.recv_buffer_size > INT_MAX ? INT_MAX : (int)socket->options.recv_buffer_size;
+            if (setsockopt(
+                    (SOCKET)socket->io_handle.data.handle,
+                    SOL_SOCKET,
+                    SO_RCVBUF,
+                    (char *)&recv_buffer_size,
+                    sizeof(recv_buffer_size))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: setsockopt() call for SO_RCVBUF failed with WSAError %d",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    WSAGetLastError());
+            }
+        }
+    }
+
     if (socket->options.domain != AWS_SOCKET_LOCAL && socket->options.type == AWS_SOCKET_STREAM) {
+        if (socket->options.tcp_nodelay) {
+            BOOL no_delay = TRUE;
+            if (setsockopt(
+                    (SOCKET)socket->io_handle.data.handle,
+                    IPPROTO_TCP,
+                    TCP_NODELAY,
+                    (char *)&no_delay,
+                    sizeof(no_delay))) {
+                AWS_LOGF_WARN(
+                    AWS_LS_IO_SOCKET,
+                    "id=%p handle=%p: setsockopt() call for enabling TCP_NODELAY failed with WSAError %d",
+                    (void *)socket,
+                    (void *)socket->io_handle.data.handle,
+                    WSAGetLastError());
+            }
+        }
+
+        if (socket->options.tcp_cork) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TCP_CORK is not supported on windows, ignoring tcp_cork.",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+        }
+
+        if (socket->options.tcp_fast_open) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TCP Fast Open is not supported on windows, ignoring tcp_fast_open.",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+        }
+
+        if (socket->options.tcp_defer_accept_sec) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TCP_DEFER_ACCEPT is not supported on windows, ignoring tcp_defer_accept_sec.",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+        }
+
+        if (socket->options.tcp_notsent_lowat) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TCP_NOTSENT_LOWAT is not supported on windows, ignoring tcp_notsent_lowat.",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+        }
+
+        if (socket->options.tcp_congestion_control[0]) {
+            AWS_LOGF_WARN(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: TCP_CONGESTION is not supported on windows, ignoring tcp_congestion_control.",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+        }
+
         if (socket->options.keepalive &&
             !(socket->options.keep_alive_interval_sec && socket->options.keep_alive_timeout_sec)) {
             int keep_alive = 1;
@@ -2422,6 +2623,12 @@ static int s_socket_close(struct aws_socket *socket) {
         socket->io_handle.data.handle = INVALID_HANDLE_VALUE;
     }
 
+#if !defined(AWS_SUPPORT_WIN7)
+    if (socket_impl->rio) {
+        s_rio_release(socket);
+    }
+#endif
+
     socket->state = CLOSED;
 
     while (!aws_linked_list_empty(&socket_impl->pending_io_operations)) {
@@ -2510,6 +2717,13 @@ int aws_socket_assign_to_event_loop(struct aws_socket *socket, struct aws_event_
     return aws_event_loop_connect_handle_to_io_completion_port(event_loop, &socket->io_handle);
 }
 
+int aws_socket_unassign_from_event_loop(struct aws_socket *socket) {
+    /* a handle can't be disassociated from the completion port it's connected to */
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET, "id=%p: moving a socket to another event loop is not supported on Windows", (void *)socket);
+    return aws_raise_error(AWS_ERROR_PLATFORM_NOT_SUPPORTED);
+}
+
 struct aws_event_loop *aws_socket_get_event_loop(struct aws_socket *socket) {
     return socket->event_loop;
 }
@@ -2646,6 +2860,364 @@ static void s_dgram_readable_event(
     }
 }
 
+#if !defined(AWS_SUPPORT_WIN7)
+
+/*
+ * Registered I/O receive ring, for stream sockets with use_registered_io.
+ *
+ * Its memory is registered with the kernel once, split into slots, and every slot is kept posted as a receive. The
+ * completion queue notifies the event loop's completion port the way an overlapped operation would, and the
+ * notification plays the part of the 0 byte read: it tells the user the socket is readable, and their reads copy out
+ * of the slots in the order they were filled, posting each one again once it's drained.
+ */
+enum {
+    RIO_RECEIVE_SLOTS = 8,
+    RIO_RECEIVE_SLOT_SIZE = 16 * 1024,
+};
+
+struct rio_receive_ring {
+    struct aws_allocator *allocator;
+    /* NULL once the socket has closed and the ring only waits on the completions of its aborted receives */
+    struct aws_socket *socket;
+    struct aws_overlapped notification;
+    RIO_CQ completion_queue;
+    RIO_RQ request_queue;
+    RIO_BUFFERID buffer_id;
+    uint8_t *memory;
+    size_t slot_len[RIO_RECEIVE_SLOTS];
+    /* slots holding received data in the order it arrived, a ring of filled_count starting at filled_begin */
+    size_t filled[RIO_RECEIVE_SLOTS];
+    size_t filled_begin;
+    size_t filled_count;
+    /* how much of the first filled slot has been read already */
+    size_t consumed;
+    size_t outstanding_receives;
+    /* once a receive fails, or AWS_IO_SOCKET_CLOSED once the peer closed. Reported after the data before it. */
+    int error_code;
+    bool notify_armed;
+    bool in_notification;
+};
+
+static RIO_EXTENSION_FUNCTION_TABLE s_rio;
+static bool s_rio_available = false;
+static aws_thread_once s_rio_init_once = AWS_THREAD_ONCE_STATIC_INIT;
+
+static void s_rio_init(void *user_data) {
+    (void)user_data;
+
+    /* the function table comes from any socket created for Registered I/O */
+    SOCKET probe = WSASocketW(AF_INET, SOCK_STREAM, IPPROTO_TCP, NULL, 0, WSA_FLAG_OVERLAPPED | WSA_FLAG_REGISTERED_IO);
+    if (probe == INVALID_SOCKET) {
+        AWS_LOGF_WARN(AWS_LS_IO_SOCKET, "static: Registered I/O is not available, WSAError %d", WSAGetLastError());
+        return;
+    }
+
+    GUID rio_id = WSAID_MULTIPLE_RIO;
+    DWORD bytes_returned = 0;
+    s_rio.cbSize = sizeof(s_rio);
+    if (WSAIoctl(
+            probe,
+            SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER,
+            &rio_id,
+            sizeof(rio_id),
+            &s_rio,
+            sizeof(s_rio),
+            &bytes_returned,
+            NULL,
+            NULL)) {
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "static: loading the Registered I/O functions failed with WSAError %d",
+            WSAGetLastError());
+    } else {
+        s_rio_available = true;
+    }
+
+    closesocket(probe);
+}
+
+static void s_rio_ring_destroy(struct rio_receive_ring *ring) {
+    if (ring->completion_queue != RIO_INVALID_CQ) {
+        s_rio.RIOCloseCompletionQueue(ring->completion_queue);
+    }
+
+    if (ring->buffer_id != RIO_INVALID_BUFFERID) {
+        s_rio.RIODeregisterBuffer(ring->buffer_id);
+    }
+
+    aws_mem_release(ring->allocator, ring->memory);
+    aws_mem_release(ring->allocator, ring);
+}
+
+static int s_rio_arm(struct rio_receive_ring *ring) {
+    if (ring->notify_armed) {
+        return AWS_OP_SUCCESS;
+    }
+
+    INT err = s_rio.RIONotify(ring->completion_queue);
+    if (err != ERROR_SUCCESS && err != WSAEALREADY) {
+        return aws_raise_error(s_determine_socket_error(err));
+    }
+
+    ring->notify_armed = true;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_rio_post_receive(struct rio_receive_ring *ring, size_t slot) {
+    RIO_BUF buffer = {
+        .BufferId = ring->buffer_id,
+        .Offset = (ULONG)(slot * RIO_RECEIVE_SLOT_SIZE),
+        .Length = RIO_RECEIVE_SLOT_SIZE,
+    };
+
+    if (!s_rio.RIOReceive(ring->request_queue, &buffer, 1, 0, (PVOID)(uintptr_t)slot)) {
+        return aws_raise_error(s_determine_socket_error(WSAGetLastError()));
+    }
+
+    ++ring->outstanding_receives;
+    return AWS_OP_SUCCESS;
+}
+
+/* frees the ring once nothing the kernel may still complete into it is outstanding, or waits for that to happen. */
+static void s_rio_ring_settle_after_close(struct rio_receive_ring *ring) {
+    if (ring->outstanding_receives && !s_rio_arm(ring)) {
+        return;
+    }
+
+    s_rio_ring_destroy(ring);
+}
+
+static void s_rio_on_notification(
+    struct aws_event_loop *event_loop,
+    struct aws_overlapped *overlapped,
+    int status_code,
+    size_t num_bytes_transferred) {
+    (void)event_loop;
+    (void)status_code;
+    (void)num_bytes_transferred;
+
+    struct rio_receive_ring *ring = overlapped->user_data;
+    ring->notify_armed = false;
+
+    RIORESULT results[RIO_RECEIVE_SLOTS];
+    ULONG result_count = s_rio.RIODequeueCompletion(ring->completion_queue, results, RIO_RECEIVE_SLOTS);
+    if (result_count == RIO_CORRUPT_CQ) {
+        result_count = 0;
+        if (!ring->error_code) {
+            ring->error_code = AWS_ERROR_SYS_CALL_FAILURE;
+        }
+    }
+
+    for (ULONG i = 0; i < result_count; ++i) {
+        --ring->outstanding_receives;
+        size_t slot = (size_t)results[i].RequestContext;
+
+        if (results[i].Status) {
+            if (!ring->error_code) {
+                ring->error_code = s_determine_socket_error(results[i].Status);
+            }
+        } else if (results[i].BytesTransferred == 0) {
+            if (!ring->error_code) {
+                ring->error_code = AWS_IO_SOCKET_CLOSED;
+            }
+        } else {
+            ring->slot_len[slot] = results[i].BytesTransferred;
+            ring->filled[(ring->filled_begin + ring->filled_count) % RIO_RECEIVE_SLOTS] = slot;
+            ++ring->filled_count;
+        }
+    }
+
+    if (!ring->socket) {
+        s_rio_ring_settle_after_close(ring);
+        return;
+    }
+
+    struct aws_socket *socket = ring->socket;
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
+
+    if (ring->outstanding_receives && s_rio_arm(ring) && !ring->error_code) {
+        ring->error_code = aws_last_error();
+    }
+
+    if (!ring->filled_count && !ring->error_code) {
+        return;
+    }
+
+    /* the user may close the socket from their callback, which leaves the ring to us. */
+    ring->in_notification = true;
+    socket->readable_fn(socket, AWS_OP_SUCCESS, socket->readable_user_data);
+    ring->in_notification = false;
+
+    if (!ring->socket) {
+        s_rio_ring_settle_after_close(ring);
+    }
+}
+
+static int s_rio_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+    struct iocp_socket *socket_impl = socket->impl;
+    struct rio_receive_ring *ring = socket_impl->rio;
+
+    size_t total_read = 0;
+    size_t buffer_index = 0;
+    while (ring->filled_count && buffer_index < buffer_count) {
+        struct aws_byte_buf *buffer = buffers[buffer_index];
+        size_t space = buffer->capacity - buffer->len;
+        if (!space) {
+            ++buffer_index;
+            continue;
+        }
+
+        size_t slot = ring->filled[ring->filled_begin];
+        size_t available = ring->slot_len[slot] - ring->consumed;
+        size_t to_copy = space < available ? space : available;
+        memcpy(
+            buffer->buffer + buffer->len, ring->memory + slot * RIO_RECEIVE_SLOT_SIZE + ring->consumed, to_copy);
+        buffer->len += to_copy;
+        ring->consumed += to_copy;
+        total_read += to_copy;
+
+        if (ring->consumed == ring->slot_len[slot]) {
+            ring->consumed = 0;
+            ring->filled_begin = (ring->filled_begin + 1) % RIO_RECEIVE_SLOTS;
+            --ring->filled_count;
+
+            /* nothing more is coming after an error or the peer closing */
+            if (!ring->error_code && s_rio_post_receive(ring, slot)) {
+                ring->error_code = aws_last_error();
+            }
+        }
+    }
+
+    if (ring->outstanding_receives && s_rio_arm(ring) && !ring->error_code) {
+        ring->error_code = aws_last_error();
+    }
+
+    if (total_read) {
+        AWS_LOGF_TRACE(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: read %llu bytes from registered receive buffers",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            (unsigned long long)total_read);
+        *amount_read = total_read;
+        return AWS_OP_SUCCESS;
+    }
+
+    /* like the regular read, report an error or the close only once the data before it has been read */
+    if (ring->error_code) {
+        socket->state = ring->error_code == AWS_IO_SOCKET_CLOSED ? CLOSED : ERRORED;
+        return aws_raise_error(ring->error_code);
+    }
+
+    if (socket->statistics) {
+        ++socket->statistics->read_would_block;
+    }
+    return aws_raise_error(AWS_IO_READ_WOULD_BLOCK);
+}
+
+/* Sets up the ring and posts its receives. On failure the socket is left as it was, to read the regular way. */
+static int s_rio_subscribe_to_read(struct aws_socket *socket) {
+    aws_thread_call_once(&s_rio_init_once, s_rio_init, NULL);
+    if (!s_rio_available) {
+        return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+    }
+
+    struct rio_receive_ring *ring = aws_mem_calloc(socket->allocator, 1, sizeof(struct rio_receive_ring));
+    if (!ring) {
+        return AWS_OP_ERR;
+    }
+
+    ring->allocator = socket->allocator;
+    ring->socket = socket;
+    ring->completion_queue = RIO_INVALID_CQ;
+    ring->request_queue = RIO_INVALID_RQ;
+    ring->buffer_id = RIO_INVALID_BUFFERID;
+    aws_overlapped_init(&ring->notification, s_rio_on_notification, ring);
+
+    ring->memory = aws_mem_acquire(socket->allocator, RIO_RECEIVE_SLOTS * RIO_RECEIVE_SLOT_SIZE);
+    if (!ring->memory) {
+        goto error;
+    }
+
+    ring->buffer_id = s_rio.RIORegisterBuffer((PCHAR)ring->memory, RIO_RECEIVE_SLOTS * RIO_RECEIVE_SLOT_SIZE);
+    if (ring->buffer_id == RIO_INVALID_BUFFERID) {
+        aws_raise_error(s_determine_socket_error(WSAGetLastError()));
+        goto error;
+    }
+
+    RIO_NOTIFICATION_COMPLETION notification;
+    AWS_ZERO_STRUCT(notification);
+    notification.Type = RIO_IOCP_COMPLETION;
+    notification.Iocp.IocpHandle = aws_iocp_event_loop_get_completion_port(socket->event_loop);
+    notification.Iocp.CompletionKey = NULL;
+    notification.Iocp.Overlapped = &ring->notification.overlapped;
+
+    /* sends don't go through the ring, but the request queue insists on room for at least one */
+    ring->completion_queue = s_rio.RIOCreateCompletionQueue(RIO_RECEIVE_SLOTS + 1, &notification);
+    if (ring->completion_queue == RIO_INVALID_CQ) {
+        aws_raise_error(s_determine_socket_error(WSAGetLastError()));
+        goto error;
+    }
+
+    ring->request_queue = s_rio.RIOCreateRequestQueue(
+        (SOCKET)socket->io_handle.data.handle,
+        RIO_RECEIVE_SLOTS,
+        1,
+        1,
+        1,
+        ring->completion_queue,
+        ring->completion_queue,
+        ring);
+    if (ring->request_queue == RIO_INVALID_RQ) {
+        aws_raise_error(s_determine_socket_error(WSAGetLastError()));
+        goto error;
+    }
+
+    if (s_rio_arm(ring)) {
+        goto error;
+    }
+
+    /* once the first receive is posted there's no going back, a later failure is reported by the reads instead. */
+    if (s_rio_post_receive(ring, 0)) {
+        goto error;
+    }
+
+    for (size_t slot = 1; slot < RIO_RECEIVE_SLOTS; ++slot) {
+        if (s_rio_post_receive(ring, slot)) {
+            ring->error_code = aws_last_error();
+            break;
+        }
+    }
+
+    struct iocp_socket *socket_impl = socket->impl;
+    socket_impl->rio = ring;
+    return AWS_OP_SUCCESS;
+
+error:
+    s_rio_ring_destroy(ring);
+    return AWS_OP_ERR;
+}
+
+/* Called once the socket is closed, which aborts whatever receives were still posted. */
+static void s_rio_release(struct aws_socket *socket) {
+    struct iocp_socket *socket_impl = socket->impl;
+    struct rio_receive_ring *ring = socket_impl->rio;
+    socket_impl->rio = NULL;
+    ring->socket = NULL;
+
+    if (!ring->in_notification) {
+        s_rio_ring_settle_after_close(ring);
+    }
+}
+
+#endif /* !AWS_SUPPORT_WIN7 */
+
 static int s_stream_subscribe_to_read(
     struct aws_socket *socket,
     aws_socket_on_readable_fn *on_readable,
@@ -2653,6 +3225,26 @@ static int s_stream_subscribe_to_read(
     socket->readable_fn = on_readable;
     socket->readable_user_data = user_data;
 
+#if !defined(AWS_SUPPORT_WIN7)
+    if (socket->options.use_registered_io && socket->options.domain != AWS_SOCKET_LOCAL) {
+        if (!s_rio_subscribe_to_read(socket)) {
+            AWS_LOGF_TRACE(
+                AWS_LS_IO_SOCKET,
+                "id=%p handle=%p: subscribed to readable events through Registered I/O",
+                (void *)socket,
+                (void *)socket->io_handle.data.handle);
+            return AWS_OP_SUCCESS;
+        }
+
+        AWS_LOGF_WARN(
+            AWS_LS_IO_SOCKET,
+            "id=%p handle=%p: setting up Registered I/O failed with error %d, falling back to regular reads",
+            (void *)socket,
+            (void *)socket->io_handle.data.handle,
+            aws_last_error());
+    }
+#endif
+
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: subscribing to readable event",
@@ -2847,6 +3439,13 @@ static int s_local_read(struct aws_socket *socket, struct aws_byte_buf *buffer,
 }
 
 static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read) {
+#if !defined(AWS_SUPPORT_WIN7)
+    struct iocp_socket *socket_impl = socket->impl;
+    if (socket_impl->rio) {
+        return s_rio_read_vectored(socket, &buffer, 1, amount_read);
+    }
+#endif
+
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET,
         "id=%p handle=%p: reading from socket",
@@ -2858,6 +3457,9 @@ static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, si
         (char *)buffer->buffer + buffer->len,
         (int)(buffer->capacity - buffer->len),
         0);
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
 
     if (read_val > 0) {
         AWS_LOGF_TRACE(
@@ -2889,6 +3491,9 @@ static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, si
             "id=%p handle=%p: read would block, scheduling 0 byte read and returning",
             (void *)socket,
             (void *)socket->io_handle.data.handle);
+        if (socket->statistics) {
+            ++socket->statistics->read_would_block;
+        }
         if (!(socket->state & CONNECTED_WAITING_ON_READABLE)) {
             struct iocp_socket *iocp_socket = socket->impl;
             socket->state |= CONNECTED_WAITING_ON_READABLE;
@@ -2937,6 +3542,88 @@ static int s_tcp_read(struct aws_socket *socket, struct aws_byte_buf *buffer, si
     return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
 }
 
+/* Most buffers handed to a single WSARecv() call. */
+#define MAX_READ_WSABUFS 64
+
+/* Scatters one receive across the buffers with WSARecv(). Anything but a successful read is handed to the
+   single-buffer read for the socket type, since it owns the 0 byte read trick and the error mapping. */
+static int s_winsock_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+    struct iocp_socket *socket_impl = socket->impl;
+
+#if !defined(AWS_SUPPORT_WIN7)
+    if (socket_impl->rio) {
+        return s_rio_read_vectored(socket, buffers, buffer_count, amount_read);
+    }
+#endif
+
+    WSABUF wsa_bufs[MAX_READ_WSABUFS];
+    DWORD buf_count = (DWORD)(buffer_count > MAX_READ_WSABUFS ? MAX_READ_WSABUFS : buffer_count);
+    for (DWORD i = 0; i < buf_count; ++i) {
+        wsa_bufs[i].buf = (char *)buffers[i]->buffer + buffers[i]->len;
+        wsa_bufs[i].len = (ULONG)(buffers[i]->capacity - buffers[i]->len);
+    }
+
+    AWS_LOGF_TRACE(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: reading from socket into %lu buffers",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle,
+        (unsigned long)buf_count);
+
+    DWORD bytes_read = 0;
+    DWORD flags = 0;
+    int err = WSARecv((SOCKET)socket->io_handle.data.handle, wsa_bufs, buf_count, &bytes_read, &flags, NULL, NULL);
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
+
+    if (err || bytes_read == 0) {
+        return socket_impl->vtable->read(socket, buffers[0], amount_read);
+    }
+
+    *amount_read = bytes_read;
+    size_t remaining = bytes_read;
+    for (DWORD i = 0; i < buf_count && remaining > 0; ++i) {
+        size_t filled = remaining > wsa_bufs[i].len ? wsa_bufs[i].len : remaining;
+        buffers[i]->len += filled;
+        remaining -= filled;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Named pipes have no scatter read, so fill one buffer at a time until the pipe runs dry. */
+static int s_local_read_vectored(
+    struct aws_socket *socket,
+    struct aws_byte_buf *const *buffers,
+    size_t buffer_count,
+    size_t *amount_read) {
+
+    size_t total_read = 0;
+    for (size_t i = 0; i < buffer_count; ++i) {
+        size_t read = 0;
+        if (s_local_read(socket, buffers[i], &read)) {
+            if (total_read == 0) {
+                return AWS_OP_ERR;
+            }
+            /* report what we have, the next read reports the failure. */
+            break;
+        }
+
+        total_read += read;
+        if (buffers[i]->len < buffers[i]->capacity) {
+            break;
+        }
+    }
+
+    *amount_read = total_read;
+    return AWS_OP_SUCCESS;
+}
+
 static int s_dgram_read(struct aws_socket *socket, struct aws_byte_buf *buffer, size_t *amount_read) {
     AWS_LOGF_TRACE(
         AWS_LS_IO_SOCKET,
@@ -2948,6 +3635,9 @@ static int s_dgram_read(struct aws_socket *socket, struct aws_byte_buf *buffer,
         (char *)buffer->buffer + buffer->len,
         (int)(buffer->capacity - buffer->len),
         0);
+    if (socket->statistics) {
+        ++socket->statistics->read_syscalls;
+    }
 
     if (read_val > 0) {
         AWS_LOGF_TRACE(
@@ -2979,6 +3669,9 @@ static int s_dgram_read(struct aws_socket *socket, struct aws_byte_buf *buffer,
             "id=%p handle=%p: read would block, scheduling 0 byte read and returning",
             (void *)socket,
             (void *)socket->io_handle.data.handle);
+        if (socket->statistics) {
+            ++socket->statistics->read_would_block;
+        }
         if (!(socket->state & CONNECTED_WAITING_ON_READABLE)) {
             struct iocp_socket *iocp_socket = socket->impl;
             socket->state |= CONNECTED_WAITING_ON_READABLE;
@@ -3154,6 +3847,9 @@ int aws_socket_write(
         (DWORD)cursor->len,
         NULL,
         &write_cb_data->io_data.signal.overlapped);
+    if (socket->statistics) {
+        ++socket->statistics->write_syscalls;
+    }
 
     if (!res) {
         int error_code = GetLastError();
@@ -3180,6 +3876,126 @@ int aws_socket_write(
     return AWS_OP_SUCCESS;
 }
 
+/* every write is its own overlapped operation here, there is no queue to hold them in. */
+void aws_socket_cork_writes(struct aws_socket *socket) {
+    (void)socket;
+}
+
+void aws_socket_uncork_writes(struct aws_socket *socket) {
+    (void)socket;
+}
+
+int aws_socket_write_from_file(
+    struct aws_socket *socket,
+    FILE *file,
+    uint64_t offset,
+    size_t length,
+    aws_socket_on_write_completed_fn *written_fn,
+    void *user_data) {
+    (void)file;
+    (void)offset;
+    (void)length;
+    (void)written_fn;
+    (void)user_data;
+
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: file writes are not supported on this platform",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+static int s_datagram_io_unsupported(struct aws_socket *socket) {
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: datagram sends and receives are not supported on this platform",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_send_to(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_socket_endpoint *destination,
+    size_t *amount_written) {
+    (void)data;
+    (void)destination;
+
+    *amount_written = 0;
+    return s_datagram_io_unsupported(socket);
+}
+
+int aws_socket_send_to_batch(
+    struct aws_socket *socket,
+    const struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_sent) {
+    (void)datagrams;
+    (void)count;
+
+    *datagrams_sent = 0;
+    return s_datagram_io_unsupported(socket);
+}
+
+int aws_socket_recv_from(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_socket_endpoint *source,
+    size_t *amount_read) {
+    (void)buffer;
+    (void)source;
+
+    *amount_read = 0;
+    return s_datagram_io_unsupported(socket);
+}
+
+int aws_socket_recv_from_batch(
+    struct aws_socket *socket,
+    struct aws_socket_datagram *datagrams,
+    size_t count,
+    size_t *datagrams_received) {
+    (void)datagrams;
+    (void)count;
+
+    *datagrams_received = 0;
+    return s_datagram_io_unsupported(socket);
+}
+
+static int s_handle_passing_unsupported(struct aws_socket *socket) {
+    AWS_LOGF_ERROR(
+        AWS_LS_IO_SOCKET,
+        "id=%p handle=%p: passing handles is not supported on this platform",
+        (void *)socket,
+        (void *)socket->io_handle.data.handle);
+    return aws_raise_error(AWS_ERROR_UNSUPPORTED_OPERATION);
+}
+
+int aws_socket_send_handle(
+    struct aws_socket *socket,
+    const struct aws_byte_cursor *data,
+    const struct aws_io_handle *handle,
+    size_t *amount_written) {
+    (void)data;
+    (void)handle;
+
+    *amount_written = 0;
+    return s_handle_passing_unsupported(socket);
+}
+
+int aws_socket_recv_handle(
+    struct aws_socket *socket,
+    struct aws_byte_buf *buffer,
+    struct aws_io_handle *out_handle,
+    size_t *amount_read) {
+    (void)buffer;
+
+    out_handle->data.handle = NULL;
+    *amount_read = 0;
+    return s_handle_passing_unsupported(socket);
+}
+
 int aws_socket_get_error(struct aws_socket *socket) {
     if (socket->options.domain != AWS_SOCKET_LOCAL) {
         int connect_result;
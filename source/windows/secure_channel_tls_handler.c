@@ -44,10 +44,12 @@
 
 void aws_tls_init_static_state(struct aws_allocator *alloc) {
     AWS_LOGF_INFO(AWS_LS_IO_TLS, "static: Initializing TLS using SecureChannel (SSPI).");
-    (void)alloc;
+    aws_pki_init_import_cache(alloc);
 }
 
-void aws_tls_clean_up_static_state(void) {}
+void aws_tls_clean_up_static_state(void) {
+    aws_pki_clean_up_import_cache();
+}
 
 struct secure_channel_ctx {
     struct aws_tls_ctx ctx;
@@ -56,6 +58,12 @@ struct secure_channel_ctx {
     PCERT_CONTEXT pcerts;
     HCERTSTORE cert_store;
     HCERTSTORE custom_trust_store;
+    /*
+     * Secure Channel only resumes sessions between contexts that share a credentials handle, so with the session
+     * cache on, client handlers all use this one instead of acquiring their own.
+     */
+    CredHandle shared_creds;
+    bool has_shared_creds;
     bool verify_peer;
 };
 
@@ -98,8 +106,12 @@ struct secure_channel_handler {
     struct aws_string *alpn_list;
     void *user_data;
     bool advertise_alpn_message;
+    aws_tls_on_protocol_negotiated on_protocol_negotiated;
     bool negotiation_finished;
     bool verify_peer;
+    /* creds belongs to ctx, which we hold a reference to. */
+    bool shares_creds;
+    struct aws_tls_ctx *ctx;
 };
 
 static size_t s_message_overhead(struct aws_channel_handler *handler) {
@@ -267,7 +279,12 @@ static void s_on_negotiation_success(struct aws_channel_handler *handler) {
     struct secure_channel_handler *sc_handler = handler->impl;
 
     /* if the user provided an ALPN handler to the channel, we need to let them know what their protocol is. */
-    if (sc_handler->slot->adj_right && sc_handler->advertise_alpn_message && sc_handler->protocol.len) {
+    if (sc_handler->on_protocol_negotiated && sc_handler->protocol.len) {
+        if (aws_tls_install_negotiated_protocol_handler(
+                sc_handler->slot, &sc_handler->protocol, sc_handler->on_protocol_negotiated, sc_handler->user_data)) {
+            aws_channel_shutdown(sc_handler->slot->channel, aws_last_error());
+        }
+    } else if (sc_handler->slot->adj_right && sc_handler->advertise_alpn_message && sc_handler->protocol.len) {
         struct aws_io_message *message = aws_channel_acquire_message_from_pool(
             sc_handler->slot->channel,
             AWS_IO_MESSAGE_APPLICATION_DATA,
@@ -1083,6 +1100,7 @@ static int s_process_pending_output_messages(struct aws_channel_handler *handler
             if (!read_out_msg) {
                 return AWS_OP_ERR;
             }
+            read_out_msg->is_sensitive = true;
 
             size_t copy_size = read_out_msg->message_data.capacity < requested_message_size
                                    ? read_out_msg->message_data.capacity
@@ -1253,6 +1271,13 @@ static int s_process_write_message(
     SECURITY_STATUS status = SEC_E_OK;
 
     if (message) {
+        if (message->message_type == AWS_IO_MESSAGE_BORROWED_DATA) {
+            return aws_raise_error(AWS_IO_CHANNEL_UNKNOWN_MESSAGE_TYPE);
+        }
+
+        /* whoever releases it, this message holds plaintext */
+        message->is_sensitive = true;
+
         AWS_LOGF_TRACE(
             AWS_LS_IO_TLS, "id=%p: processing ougoing message of size %zu", (void *)handler, message->message_data.len);
 
@@ -1541,10 +1566,12 @@ static void s_secure_channel_handler_destroy(
         DeleteSecurityContext(&sc_handler->sec_handle);
     }
 
-    if (sc_handler->creds.dwLower || sc_handler->creds.dwUpper) {
+    if (!sc_handler->shares_creds && (sc_handler->creds.dwLower || sc_handler->creds.dwUpper)) {
         DeleteSecurityContext(&sc_handler->creds);
     }
 
+    aws_tls_ctx_release(sc_handler->ctx);
+
     aws_tls_channel_handler_shared_clean_up(&sc_handler->shared_state);
 
     aws_mem_release(allocator, sc_handler);
@@ -1640,25 +1667,32 @@ static struct aws_channel_handler *s_tls_handler_new(
         credential_use = SECPKG_CRED_OUTBOUND;
     }
 
-    SECURITY_STATUS status = AcquireCredentialsHandleA(
-        NULL,
-        UNISP_NAME,
-        credential_use,
-        NULL,
-        &sc_ctx->credentials,
-        NULL,
-        NULL,
-        &sc_handler->creds,
-        &sc_handler->sspi_timestamp);
+    if (is_client_mode && sc_ctx->has_shared_creds) {
+        sc_handler->creds = sc_ctx->shared_creds;
+        sc_handler->shares_creds = true;
+        sc_handler->ctx = aws_tls_ctx_acquire(options->ctx);
+    } else {
+        SECURITY_STATUS status = AcquireCredentialsHandleA(
+            NULL,
+            UNISP_NAME,
+            credential_use,
+            NULL,
+            &sc_ctx->credentials,
+            NULL,
+            NULL,
+            &sc_handler->creds,
+            &sc_handler->sspi_timestamp);
 
-    if (status != SEC_E_OK) {
-        AWS_LOGF_ERROR(AWS_LS_IO_TLS, "Error on AcquireCredentialsHandle. SECURITY_STATUS is %d", (int)status);
-        int aws_error = s_determine_sspi_error(status);
-        aws_raise_error(aws_error);
-        goto on_error;
+        if (status != SEC_E_OK) {
+            AWS_LOGF_ERROR(AWS_LS_IO_TLS, "Error on AcquireCredentialsHandle. SECURITY_STATUS is %d", (int)status);
+            int aws_error = s_determine_sspi_error(status);
+            aws_raise_error(aws_error);
+            goto on_error;
+        }
     }
 
     sc_handler->advertise_alpn_message = options->advertise_alpn_message;
+    sc_handler->on_protocol_negotiated = options->on_protocol_negotiated;
     sc_handler->on_data_read = options->on_data_read;
     sc_handler->on_error = options->on_error;
     sc_handler->on_negotiation_result = options->on_negotiation_result;
@@ -1750,6 +1784,10 @@ static void s_secure_channel_ctx_destroy(struct secure_channel_ctx *secure_chann
         aws_string_destroy(secure_channel_ctx->alpn_list);
     }
 
+    if (secure_channel_ctx->has_shared_creds) {
+        FreeCredentialsHandle(&secure_channel_ctx->shared_creds);
+    }
+
     aws_mem_release(secure_channel_ctx->ctx.alloc, secure_channel_ctx);
 }
 
@@ -1904,6 +1942,27 @@ struct aws_tls_ctx *s_ctx_new(
         secure_channel_ctx->credentials.cCreds = 1;
     }
 
+    if (is_client_mode && options->session_cache_max_entries) {
+        TimeStamp timestamp;
+        SECURITY_STATUS status = AcquireCredentialsHandleA(
+            NULL,
+            UNISP_NAME,
+            SECPKG_CRED_OUTBOUND,
+            NULL,
+            &secure_channel_ctx->credentials,
+            NULL,
+            NULL,
+            &secure_channel_ctx->shared_creds,
+            &timestamp);
+
+        if (status != SEC_E_OK) {
+            AWS_LOGF_ERROR(AWS_LS_IO_TLS, "Error on AcquireCredentialsHandle. SECURITY_STATUS is %d", (int)status);
+            aws_raise_error(s_determine_sspi_error(status));
+            goto clean_up;
+        }
+        secure_channel_ctx->has_shared_creds = true;
+    }
+
     return &secure_channel_ctx->ctx;
 
 clean_up:
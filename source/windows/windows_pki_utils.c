@@ -5,6 +5,8 @@
 
 #include <aws/io/pki_utils.h>
 
+#include <aws/common/hash_table.h>
+#include <aws/common/mutex.h>
 #include <aws/common/uuid.h>
 
 #include <aws/io/logging.h>
@@ -21,6 +23,154 @@
 #define CERT_HASH_STR_LEN 40
 #define CERT_HASH_LEN 20
 
+/*
+ * Process-wide cache of what has been imported, keyed by a digest of the bytes it was imported from, so that creating
+ * many TLS contexts from the same certificates and key doesn't build a new store and key container each time. The
+ * cache keeps a reference on every store and certificate and each caller gets duplicates of its own. An entry counts
+ * the callers holding its store and goes away when the last of them closes it with aws_close_cert_store().
+ */
+enum pki_import_kind {
+    PKI_IMPORT_KEY_PAIR,
+    PKI_IMPORT_TRUSTED_CERTIFICATES,
+};
+
+/* SHA-256 */
+#define PKI_IMPORT_DIGEST_LEN 32
+
+struct pki_import_cache_entry {
+    uint8_t digest[PKI_IMPORT_DIGEST_LEN];
+    /* the table's key, over digest */
+    struct aws_byte_cursor key;
+    HCERTSTORE store;
+    /* NULL for trusted certificates */
+    PCCERT_CONTEXT certificate;
+    size_t users;
+};
+
+static struct aws_allocator *s_import_cache_allocator = NULL;
+/* held across a lookup and the import it saves, so everyone importing the same bytes waits for one import */
+static struct aws_mutex s_import_cache_lock = AWS_MUTEX_INIT;
+/* struct aws_byte_cursor * -> struct pki_import_cache_entry * */
+static struct aws_hash_table s_import_cache;
+
+static bool s_import_cache_key_eq(const void *a, const void *b) {
+    return aws_byte_cursor_eq(a, b);
+}
+
+static void s_import_cache_destroy_entry(void *value) {
+    struct pki_import_cache_entry *entry = value;
+
+    if (entry->certificate) {
+        CertFreeCertificateContext(entry->certificate);
+    }
+    CertCloseStore(entry->store, 0);
+    aws_mem_release(s_import_cache_allocator, entry);
+}
+
+void aws_pki_init_import_cache(struct aws_allocator *alloc) {
+    s_import_cache_allocator = alloc;
+    AWS_FATAL_ASSERT(
+        !aws_hash_table_init(
+            &s_import_cache,
+            alloc,
+            4,
+            aws_hash_byte_cursor_ptr,
+            s_import_cache_key_eq,
+            NULL,
+            s_import_cache_destroy_entry) &&
+        "failed to initialize the pki import cache");
+}
+
+void aws_pki_clean_up_import_cache(void) {
+    aws_mutex_lock(&s_import_cache_lock);
+    aws_hash_table_clean_up(&s_import_cache);
+    s_import_cache_allocator = NULL;
+    aws_mutex_unlock(&s_import_cache_lock);
+}
+
+/* The digest covers the kind and each input with its length in front, so no two different imports share it. Only the
+ * digest is kept; the inputs are copied together just long enough to hash them, then wiped. */
+static int s_import_cache_digest(
+    uint8_t digest[PKI_IMPORT_DIGEST_LEN],
+    enum pki_import_kind kind,
+    const struct aws_byte_cursor *first,
+    const struct aws_byte_cursor *second) {
+
+    if (s_import_cache_allocator == NULL) {
+        return aws_raise_error(AWS_ERROR_INVALID_STATE);
+    }
+
+    size_t second_len = second ? second->len : 0;
+    struct aws_byte_buf material;
+    if (aws_byte_buf_init(&material, s_import_cache_allocator, 1 + 2 * sizeof(uint64_t) + first->len + second_len)) {
+        return AWS_OP_ERR;
+    }
+
+    aws_byte_buf_write_u8(&material, (uint8_t)kind);
+    aws_byte_buf_write_be64(&material, first->len);
+    aws_byte_buf_write(&material, first->ptr, first->len);
+    aws_byte_buf_write_be64(&material, second_len);
+    if (second_len) {
+        aws_byte_buf_write(&material, second->ptr, second_len);
+    }
+
+    DWORD digest_len = PKI_IMPORT_DIGEST_LEN;
+    BOOL hashed =
+        CryptHashCertificate2(L"SHA256", 0, NULL, material.buffer, (DWORD)material.len, digest, &digest_len);
+    aws_byte_buf_clean_up_secure(&material);
+
+    if (!hashed || digest_len != PKI_IMPORT_DIGEST_LEN) {
+        AWS_LOGF_WARN(AWS_LS_IO_PKI, "static: hashing for the import cache failed with error %d", (int)GetLastError());
+        return aws_raise_error(AWS_ERROR_SYS_CALL_FAILURE);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* on a hit, *store and *certificate are duplicates the caller closes and frees as usual */
+static bool s_import_cache_find(
+    const uint8_t digest[PKI_IMPORT_DIGEST_LEN],
+    HCERTSTORE *store,
+    PCCERT_CONTEXT *certificate) {
+
+    struct aws_byte_cursor key = aws_byte_cursor_from_array(digest, PKI_IMPORT_DIGEST_LEN);
+    struct aws_hash_element *element = NULL;
+    aws_hash_table_find(&s_import_cache, &key, &element);
+    if (element == NULL) {
+        return false;
+    }
+
+    struct pki_import_cache_entry *entry = element->value;
+    *store = CertDuplicateStore(entry->store);
+    if (certificate) {
+        *certificate = CertDuplicateCertificateContext(entry->certificate);
+    }
+    ++entry->users;
+    return true;
+}
+
+/* failing to cache only costs the next caller another import */
+static void s_import_cache_put(
+    const uint8_t digest[PKI_IMPORT_DIGEST_LEN],
+    HCERTSTORE store,
+    PCCERT_CONTEXT certificate) {
+
+    struct pki_import_cache_entry *entry =
+        aws_mem_calloc(s_import_cache_allocator, 1, sizeof(struct pki_import_cache_entry));
+    if (entry == NULL) {
+        return;
+    }
+
+    memcpy(entry->digest, digest, PKI_IMPORT_DIGEST_LEN);
+    entry->key = aws_byte_cursor_from_array(entry->digest, PKI_IMPORT_DIGEST_LEN);
+    entry->store = CertDuplicateStore(store);
+    entry->certificate = certificate ? CertDuplicateCertificateContext(certificate) : NULL;
+    entry->users = 1;
+    if (aws_hash_table_put(&s_import_cache, &entry->key, entry, NULL)) {
+        s_import_cache_destroy_entry(entry);
+    }
+}
+
 int aws_load_cert_from_system_cert_store(const char *cert_path, HCERTSTORE *cert_store, PCCERT_CONTEXT *certs) {
 
     AWS_LOGF_INFO(AWS_LS_IO_PKI, "static: loading certificate at windows cert manager path %s.", cert_path);
@@ -129,7 +279,7 @@ int aws_load_cert_from_system_cert_store(const char *cert_path, HCERTSTORE *cert
     return AWS_OP_SUCCESS;
 }
 
-int aws_import_trusted_certificates(
+static int s_import_trusted_certificates(
     struct aws_allocator *alloc,
     const struct aws_byte_cursor *certificates_blob,
     HCERTSTORE *cert_store) {
@@ -195,18 +345,57 @@ clean_up:
     aws_cert_chain_clean_up(&certificates);
     aws_array_list_clean_up(&certificates);
 
+    /* the import cache lock is held here, and this store never made it into the cache */
     if (error_code && *cert_store) {
+        CertCloseStore(*cert_store, 0);
         *cert_store = NULL;
-        aws_close_cert_store(*cert_store);
     }
     return error_code;
 }
 
+int aws_import_trusted_certificates(
+    struct aws_allocator *alloc,
+    const struct aws_byte_cursor *certificates_blob,
+    HCERTSTORE *cert_store) {
+
+    uint8_t digest[PKI_IMPORT_DIGEST_LEN];
+    aws_mutex_lock(&s_import_cache_lock);
+
+    int result = AWS_OP_SUCCESS;
+    bool cacheable = !s_import_cache_digest(digest, PKI_IMPORT_TRUSTED_CERTIFICATES, certificates_blob, NULL);
+    if (!cacheable || !s_import_cache_find(digest, cert_store, NULL)) {
+        result = s_import_trusted_certificates(alloc, certificates_blob, cert_store);
+        if (cacheable && result == AWS_OP_SUCCESS) {
+            s_import_cache_put(digest, *cert_store, NULL);
+        }
+    }
+
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    return result;
+}
+
 void aws_close_cert_store(HCERTSTORE cert_store) {
+    /* a store from the import cache drops its entry once nobody else holds it */
+    aws_mutex_lock(&s_import_cache_lock);
+    if (s_import_cache_allocator != NULL) {
+        for (struct aws_hash_iter iter = aws_hash_iter_begin(&s_import_cache); !aws_hash_iter_done(&iter);
+             aws_hash_iter_next(&iter)) {
+            struct pki_import_cache_entry *entry = iter.element.value;
+            if (entry->store == cert_store) {
+                if (--entry->users == 0) {
+                    aws_hash_iter_delete(&iter, true);
+                }
+                break;
+            }
+        }
+    }
+    aws_mutex_unlock(&s_import_cache_lock);
+
     CertCloseStore(cert_store, 0);
 }
 
-int aws_import_key_pair_to_cert_context(
+static int s_import_key_pair_to_cert_context(
     struct aws_allocator *alloc,
     const struct aws_byte_cursor *public_cert_chain,
     const struct aws_byte_cursor *private_key,
@@ -357,8 +546,9 @@ clean_up:
     aws_cert_chain_clean_up(&private_keys);
     aws_array_list_clean_up(&private_keys);
 
+    /* the import cache lock is held here, and this store never made it into the cache */
     if (error_code && *store != NULL) {
-        aws_close_cert_store(*store);
+        CertCloseStore(*store, 0);
         *store = NULL;
     }
 
@@ -369,3 +559,27 @@ clean_up:
 
     return error_code;
 }
+
+int aws_import_key_pair_to_cert_context(
+    struct aws_allocator *alloc,
+    const struct aws_byte_cursor *public_cert_chain,
+    const struct aws_byte_cursor *private_key,
+    HCERTSTORE *store,
+    PCCERT_CONTEXT *certs) {
+
+    uint8_t digest[PKI_IMPORT_DIGEST_LEN];
+    aws_mutex_lock(&s_import_cache_lock);
+
+    int result = AWS_OP_SUCCESS;
+    bool cacheable = !s_import_cache_digest(digest, PKI_IMPORT_KEY_PAIR, public_cert_chain, private_key);
+    if (!cacheable || !s_import_cache_find(digest, store, certs)) {
+        result = s_import_key_pair_to_cert_context(alloc, public_cert_chain, private_key, store, certs);
+        if (cacheable && result == AWS_OP_SUCCESS) {
+            s_import_cache_put(digest, *store, *certs);
+        }
+    }
+
+    aws_mutex_unlock(&s_import_cache_lock);
+
+    return result;
+}
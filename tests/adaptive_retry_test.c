@@ -0,0 +1,148 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/retry_strategy.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+
+#include <aws/io/event_loop.h>
+
+struct adaptive_retry_test_data {
+    struct aws_retry_token *token;
+    int error_code;
+    bool retry_ready;
+    bool acquired;
+    struct aws_mutex mutex;
+    struct aws_condition_variable cvar;
+};
+
+static void s_adaptive_retry_test_token_acquired(
+    struct aws_retry_strategy *retry_strategy,
+    int error_code,
+    struct aws_retry_token *token,
+    void *user_data) {
+    (void)retry_strategy;
+
+    struct adaptive_retry_test_data *test_data = user_data;
+    aws_mutex_lock(&test_data->mutex);
+    test_data->token = token;
+    test_data->error_code = error_code;
+    test_data->acquired = true;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_all(&test_data->cvar);
+}
+
+static void s_adaptive_retry_test_retry_ready(struct aws_retry_token *token, int error_code, void *user_data) {
+    (void)token;
+
+    struct adaptive_retry_test_data *test_data = user_data;
+    aws_mutex_lock(&test_data->mutex);
+    test_data->error_code = error_code;
+    test_data->retry_ready = true;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_all(&test_data->cvar);
+}
+
+static bool s_adaptive_retry_test_acquired(void *arg) {
+    struct adaptive_retry_test_data *test_data = arg;
+    return test_data->acquired;
+}
+
+static bool s_adaptive_retry_test_retry_is_ready(void *arg) {
+    struct adaptive_retry_test_data *test_data = arg;
+    return test_data->retry_ready;
+}
+
+static int s_acquire_token(
+    struct aws_retry_strategy *retry_strategy,
+    struct adaptive_retry_test_data *test_data,
+    uint64_t timeout_ms) {
+    test_data->acquired = false;
+    test_data->token = NULL;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data->mutex));
+    ASSERT_SUCCESS(aws_retry_strategy_acquire_retry_token(
+        retry_strategy, NULL, s_adaptive_retry_test_token_acquired, test_data, timeout_ms));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_data->cvar, &test_data->mutex, s_adaptive_retry_test_acquired, test_data));
+    aws_mutex_unlock(&test_data->mutex);
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, test_data->error_code);
+    ASSERT_NOT_NULL(test_data->token);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that the rate limiter stays out of the way until a throttling error, and delays acquisitions after one. */
+static int s_test_adaptive_retry_throttling_delays_acquisition_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_adaptive_retry_options config = {
+        .standard_options =
+            {
+                .backoff_retry_options =
+                    {
+                        .el_group = el_group,
+                        .backoff_scale_factor_ms = 1,
+                    },
+            },
+    };
+
+    struct aws_retry_strategy *retry_strategy = aws_retry_strategy_new_adaptive(allocator, &config);
+    ASSERT_NOT_NULL(retry_strategy);
+
+    struct adaptive_retry_test_data test_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    /* nothing has been throttled yet, so even a short timeout is no problem */
+    for (size_t i = 0; i < 10; ++i) {
+        ASSERT_SUCCESS(s_acquire_token(retry_strategy, &test_data, 1));
+        ASSERT_SUCCESS(aws_retry_strategy_token_record_success(test_data.token));
+        aws_retry_strategy_release_retry_token(test_data.token);
+    }
+
+    ASSERT_SUCCESS(s_acquire_token(retry_strategy, &test_data, 0));
+    struct aws_retry_token *throttled_token = test_data.token;
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data.mutex));
+    ASSERT_SUCCESS(aws_retry_strategy_schedule_retry(
+        throttled_token, AWS_RETRY_ERROR_TYPE_THROTTLING, s_adaptive_retry_test_retry_ready, &test_data));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_data.cvar, &test_data.mutex, s_adaptive_retry_test_retry_is_ready, &test_data));
+    aws_mutex_unlock(&test_data.mutex);
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, test_data.error_code);
+    aws_retry_strategy_release_retry_token(throttled_token);
+
+    /* the bucket starts out empty at a couple of sends per second at most */
+    ASSERT_FAILS(aws_retry_strategy_acquire_retry_token(
+        retry_strategy, NULL, s_adaptive_retry_test_token_acquired, &test_data, 50));
+    ASSERT_INT_EQUALS(AWS_IO_RETRY_PERMISSION_DENIED, aws_last_error());
+
+    /* without a timeout the acquisition waits for the bucket instead */
+    uint64_t before_time = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&before_time));
+    ASSERT_SUCCESS(s_acquire_token(retry_strategy, &test_data, 0));
+    uint64_t after_time = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&after_time));
+    ASSERT_TRUE(
+        after_time - before_time >= aws_timestamp_convert(50, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    aws_retry_strategy_release_retry_token(test_data.token);
+
+    aws_retry_strategy_release(retry_strategy);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_adaptive_retry_throttling_delays_acquisition, s_test_adaptive_retry_throttling_delays_acquisition_fn)
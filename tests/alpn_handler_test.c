@@ -5,6 +5,7 @@
 
 #include <aws/io/channel.h>
 #include <aws/io/event_loop.h>
+#include <aws/io/private/tls_channel_handler_shared.h>
 #include <aws/io/tls_channel_handler.h>
 #include <aws/testing/aws_test_harness.h>
 
@@ -340,3 +341,76 @@ static int s_test_alpn_error_creating_handler(struct aws_allocator *allocator, v
 }
 
 AWS_TEST_CASE(alpn_error_creating_handler, s_test_alpn_error_creating_handler)
+
+/* Tests the path aws_tls_connection_options.on_protocol_negotiated takes: the downstream handler goes straight into a
+ * new slot right of the TLS slot, with no ALPN handler or message in between. */
+static int s_test_alpn_direct_install(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct alpn_channel_setup_test_args test_args = {.error_code = 0,
+                                                     .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+                                                     .mutex = AWS_MUTEX_INIT,
+                                                     .setup_completed = false,
+                                                     .shutdown_finished = false};
+
+    struct aws_channel_options args = {
+        .on_setup_completed = s_alpn_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .on_shutdown_completed = s_on_server_channel_on_shutdown,
+        .shutdown_user_data = &test_args,
+        .event_loop = event_loop,
+    };
+
+    struct aws_channel *channel = aws_channel_new(allocator, &args);
+    ASSERT_NOT_NULL(channel);
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_args.condition_variable, &test_args.mutex, s_alpn_test_setup_completed_predicate, &test_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_args.mutex));
+
+    /* stands in for the TLS handler's slot */
+    struct aws_channel_slot *tls_slot = aws_channel_slot_new(channel);
+    ASSERT_NOT_NULL(tls_slot);
+    struct aws_channel_handler *tls_handler = aws_mem_calloc(allocator, 1, sizeof(struct aws_channel_handler));
+    tls_handler->vtable = &s_alpn_test_vtable;
+    tls_handler->alloc = allocator;
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(tls_slot, tls_handler));
+
+    struct alpn_test_on_negotiation_args on_negotiation_args = {
+        .new_slot = NULL, .protocol = {0}, .new_handler = NULL, .allocator = allocator};
+    struct aws_byte_buf protocol = aws_byte_buf_from_c_str("h2");
+
+    /* a refused protocol leaves nothing behind */
+    ASSERT_ERROR(
+        AWS_IO_UNHANDLED_ALPN_PROTOCOL_MESSAGE,
+        aws_tls_install_negotiated_protocol_handler(
+            tls_slot, &protocol, s_alpn_tls_failed_negotiation, &on_negotiation_args));
+    ASSERT_NULL(tls_slot->adj_right);
+
+    ASSERT_SUCCESS(aws_tls_install_negotiated_protocol_handler(
+        tls_slot, &protocol, s_alpn_tls_successful_negotiation, &on_negotiation_args));
+    ASSERT_NOT_NULL(on_negotiation_args.new_slot);
+    ASSERT_PTR_EQUALS(on_negotiation_args.new_slot, tls_slot->adj_right);
+    ASSERT_PTR_EQUALS(on_negotiation_args.new_handler, tls_slot->adj_right->handler);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        protocol.buffer, protocol.len, on_negotiation_args.protocol.buffer, on_negotiation_args.protocol.len);
+
+    aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_mutex_lock(&test_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_args.condition_variable, &test_args.mutex, s_alpn_test_shutdown_predicate, &test_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_args.mutex));
+
+    aws_channel_destroy(channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(alpn_direct_install, s_test_alpn_direct_install)
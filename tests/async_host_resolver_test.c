@@ -0,0 +1,358 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/private/dns_message.h>
+
+#include <aws/common/condition_variable.h>
+#include <aws/common/string.h>
+#include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
+#include <aws/io/socket.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_test_dns_message_encode_query(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_buf query;
+    ASSERT_SUCCESS(aws_byte_buf_init(&query, allocator, 0));
+    ASSERT_SUCCESS(aws_dns_message_encode_query(
+        &query, 0x1234, aws_byte_cursor_from_c_str("example.com."), AWS_DNS_RECORD_TYPE_AAAA));
+
+    uint8_t expected[] = {
+        /* id, flags (RD), 1 question, 0 answers, 0 authority, 1 additional */
+        0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        /* example.com AAAA IN */
+        0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00, 0x00, 0x1C, 0x00, 0x01,
+        /* OPT, root owner, 1232 byte payload */
+        0x00, 0x00, 0x29, 0x04, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    ASSERT_BIN_ARRAYS_EQUALS(expected, sizeof(expected), query.buffer, query.len);
+
+    aws_byte_buf_clean_up(&query);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_encode_query, s_test_dns_message_encode_query)
+
+static int s_test_dns_message_encode_invalid_names(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    const char *invalid_names[] = {
+        "",
+        ".",
+        "a..example.com",
+        ".example.com",
+        "this-label-is-way-too-long-to-fit-in-the-sixty-three-bytes-a-dns-label-allows.com",
+    };
+
+    struct aws_byte_buf query;
+    ASSERT_SUCCESS(aws_byte_buf_init(&query, allocator, 0));
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(invalid_names); ++i) {
+        ASSERT_ERROR(
+            AWS_IO_DNS_INVALID_NAME,
+            aws_dns_message_encode_query(
+                &query, 1, aws_byte_cursor_from_c_str(invalid_names[i]), AWS_DNS_RECORD_TYPE_A));
+        ASSERT_UINT_EQUALS(0, query.len);
+    }
+
+    aws_byte_buf_clean_up(&query);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_encode_invalid_names, s_test_dns_message_encode_invalid_names)
+
+/* example.com is a CNAME for www.example.com, which has one A record. Both names are compressed. */
+static uint8_t s_cname_response[] = {
+    /* id, flags (QR RD RA), 1 question, 2 answers */
+    0xBE, 0xEF, 0x81, 0x80, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+    /* offset 12: example.com A IN */
+    0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00, 0x00, 0x01, 0x00, 0x01,
+    /* offset 29: example.com CNAME IN ttl 300, rdata at offset 41 is www + pointer to example.com */
+    0xC0, 0x0C, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2C, 0x00, 0x06, 0x03, 'w', 'w', 'w', 0xC0, 0x0C,
+    /* offset 47: www.example.com A IN ttl 60 93.184.216.34 */
+    0xC0, 0x29, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3C, 0x00, 0x04, 93, 184, 216, 34,
+};
+
+static int s_test_dns_message_decode_cname_chain(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_dns_response response;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+    ASSERT_SUCCESS(aws_dns_message_decode_response(
+        aws_byte_cursor_from_array(s_cname_response, sizeof(s_cname_response)),
+        aws_byte_cursor_from_c_str("EXAMPLE.com"),
+        AWS_DNS_RECORD_TYPE_A,
+        &response));
+
+    ASSERT_UINT_EQUALS(0xBEEF, response.id);
+    ASSERT_FALSE(response.truncated);
+    ASSERT_UINT_EQUALS(AWS_DNS_RCODE_NOERROR, response.rcode);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&response.addresses));
+
+    struct aws_dns_address_record *record = NULL;
+    ASSERT_SUCCESS(aws_array_list_get_at_ptr(&response.addresses, (void **)&record, 0));
+    ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_A, record->record_type);
+    ASSERT_BIN_ARRAYS_EQUALS("93.184.216.34", strlen("93.184.216.34"), record->address, record->address_len);
+    /* the address record's own ttl is shorter than the alias, so it wins. */
+    ASSERT_UINT_EQUALS(60, record->ttl_secs);
+
+    uint16_t id = 0;
+    ASSERT_SUCCESS(
+        aws_dns_message_read_id(aws_byte_cursor_from_array(s_cname_response, sizeof(s_cname_response)), &id));
+    ASSERT_UINT_EQUALS(0xBEEF, id);
+
+    aws_dns_response_clean_up(&response);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_decode_cname_chain, s_test_dns_message_decode_cname_chain)
+
+static int s_test_dns_message_decode_ipv6(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint8_t message[] = {
+        0x00, 0x01, 0x81, 0x80, 0x00, 0x01, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00,
+        /* host AAAA IN */
+        0x04, 'h', 'o', 's', 't', 0x00, 0x00, 0x1C, 0x00, 0x01,
+        /* 2001:db8::1 */
+        0xC0, 0x0C, 0x00, 0x1C, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x10,
+        0x20, 0x01, 0x0D, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+        /* 2001:db8:0:1:1:1:1:1, a lone zero group is not collapsed */
+        0xC0, 0x0C, 0x00, 0x1C, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x10,
+        0x20, 0x01, 0x0D, 0xB8, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01,
+        /* an A record for the same name doesn't answer an AAAA question */
+        0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x04, 10, 0, 0, 1,
+    };
+
+    struct aws_dns_response response;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+    ASSERT_SUCCESS(aws_dns_message_decode_response(
+        aws_byte_cursor_from_array(message, sizeof(message)),
+        aws_byte_cursor_from_c_str("host"),
+        AWS_DNS_RECORD_TYPE_AAAA,
+        &response));
+
+    ASSERT_UINT_EQUALS(2, aws_array_list_length(&response.addresses));
+
+    const char *expected[] = {"2001:db8::1", "2001:db8:0:1:1:1:1:1"};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(expected); ++i) {
+        struct aws_dns_address_record *record = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at_ptr(&response.addresses, (void **)&record, i));
+        ASSERT_INT_EQUALS(AWS_ADDRESS_RECORD_TYPE_AAAA, record->record_type);
+        ASSERT_UINT_EQUALS(30, record->ttl_secs);
+        ASSERT_BIN_ARRAYS_EQUALS(expected[i], strlen(expected[i]), record->address, record->address_len);
+    }
+
+    aws_dns_response_clean_up(&response);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_decode_ipv6, s_test_dns_message_decode_ipv6)
+
+static int s_test_dns_message_decode_flags(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint8_t message[] = {
+        0x00, 0x02, 0x81, 0x83, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x04, 'h', 'o', 's', 't', 0x00, 0x00, 0x01, 0x00, 0x01,
+    };
+
+    struct aws_dns_response response;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+    ASSERT_SUCCESS(aws_dns_message_decode_response(
+        aws_byte_cursor_from_array(message, sizeof(message)),
+        aws_byte_cursor_from_c_str("host"),
+        AWS_DNS_RECORD_TYPE_A,
+        &response));
+    ASSERT_UINT_EQUALS(AWS_DNS_RCODE_NXDOMAIN, response.rcode);
+    ASSERT_FALSE(response.truncated);
+    aws_dns_response_clean_up(&response);
+
+    /* set TC, the (absent) answer section isn't looked at */
+    message[2] = 0x83;
+    message[3] = 0x80;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+    ASSERT_SUCCESS(aws_dns_message_decode_response(
+        aws_byte_cursor_from_array(message, sizeof(message)),
+        aws_byte_cursor_from_c_str("host"),
+        AWS_DNS_RECORD_TYPE_A,
+        &response));
+    ASSERT_TRUE(response.truncated);
+    ASSERT_UINT_EQUALS(0, aws_array_list_length(&response.addresses));
+    aws_dns_response_clean_up(&response);
+
+    /* a query, not a response */
+    message[2] = 0x01;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED,
+        aws_dns_message_decode_response(
+            aws_byte_cursor_from_array(message, sizeof(message)),
+            aws_byte_cursor_from_c_str("host"),
+            AWS_DNS_RECORD_TYPE_A,
+            &response));
+    aws_dns_response_clean_up(&response);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_decode_flags, s_test_dns_message_decode_flags)
+
+static int s_test_dns_message_decode_rejects_bad_messages(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_dns_response response;
+    ASSERT_SUCCESS(aws_dns_response_init(&response, allocator));
+
+    /* answers a different question */
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED,
+        aws_dns_message_decode_response(
+            aws_byte_cursor_from_array(s_cname_response, sizeof(s_cname_response)),
+            aws_byte_cursor_from_c_str("example.org"),
+            AWS_DNS_RECORD_TYPE_A,
+            &response));
+
+    /* cut off in the middle of the last record */
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED,
+        aws_dns_message_decode_response(
+            aws_byte_cursor_from_array(s_cname_response, sizeof(s_cname_response) - 1),
+            aws_byte_cursor_from_c_str("example.com"),
+            AWS_DNS_RECORD_TYPE_A,
+            &response));
+
+    /* the answer's owner name is a compression pointer to itself */
+    uint8_t looping[] = {
+        0x00, 0x03, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x04, 'h', 'o', 's', 't', 0x00, 0x00, 0x01, 0x00, 0x01,
+        0xC0, 0x16, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x04, 10, 0, 0, 1,
+    };
+    ASSERT_ERROR(
+        AWS_IO_DNS_QUERY_FAILED,
+        aws_dns_message_decode_response(
+            aws_byte_cursor_from_array(looping, sizeof(looping)),
+            aws_byte_cursor_from_c_str("host"),
+            AWS_DNS_RECORD_TYPE_A,
+            &response));
+
+    ASSERT_ERROR(AWS_IO_DNS_QUERY_FAILED, aws_dns_message_read_id(aws_byte_cursor_from_array(looping, 4), NULL));
+
+    aws_dns_response_clean_up(&response);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_dns_message_decode_rejects_bad_messages, s_test_dns_message_decode_rejects_bad_messages)
+
+struct async_resolver_test_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable signal;
+    int error_code;
+    bool invoked;
+    bool shutdown_complete;
+};
+
+static void s_on_async_host_resolved(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    (void)host_name;
+    (void)host_addresses;
+    struct async_resolver_test_data *test_data = user_data;
+
+    aws_mutex_lock(&test_data->mutex);
+    test_data->error_code = err_code;
+    test_data->invoked = true;
+    aws_condition_variable_notify_one(&test_data->signal);
+    aws_mutex_unlock(&test_data->mutex);
+}
+
+static void s_on_async_resolver_shutdown(void *user_data) {
+    struct async_resolver_test_data *test_data = user_data;
+
+    aws_mutex_lock(&test_data->mutex);
+    test_data->shutdown_complete = true;
+    aws_condition_variable_notify_one(&test_data->signal);
+    aws_mutex_unlock(&test_data->mutex);
+}
+
+static bool s_host_resolved_predicate(void *arg) {
+    struct async_resolver_test_data *test_data = arg;
+    return test_data->invoked;
+}
+
+static bool s_shutdown_complete_predicate(void *arg) {
+    struct async_resolver_test_data *test_data = arg;
+    return test_data->shutdown_complete;
+}
+
+/* nothing answers on the discard port, so every attempt has to time out or be refused before the lookup fails. */
+static int s_test_async_resolver_unreachable_nameserver(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct async_resolver_test_data test_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .signal = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    ASSERT_NOT_NULL(el_group);
+
+    struct aws_socket_endpoint nameserver = {.address = "127.0.0.1", .port = 9};
+    struct aws_shutdown_callback_options shutdown_options = {
+        .shutdown_callback_fn = s_on_async_resolver_shutdown,
+        .shutdown_callback_user_data = &test_data,
+    };
+    struct aws_host_resolver_async_options options = {
+        .el_group = el_group,
+        .max_entries = 4,
+        .nameservers = &nameserver,
+        .nameserver_count = 1,
+        .query_timeout_ms = 100,
+        .max_retries = 1,
+        .shutdown_options = &shutdown_options,
+    };
+
+    struct aws_host_resolver *resolver = aws_host_resolver_new_async(allocator, &options);
+    ASSERT_NOT_NULL(resolver);
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "unreachable.example.com");
+    struct aws_host_resolution_config config = {.max_ttl = 30};
+
+    ASSERT_SUCCESS(
+        aws_host_resolver_resolve_host(resolver, host_name, s_on_async_host_resolved, &config, &test_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&test_data.signal, &test_data.mutex, s_host_resolved_predicate, &test_data));
+    ASSERT_INT_EQUALS(AWS_IO_DNS_QUERY_FAILED, test_data.error_code);
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_data.mutex));
+
+    uint32_t all_records = AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_A | AWS_GET_HOST_ADDRESS_COUNT_RECORD_TYPE_AAAA;
+    ASSERT_UINT_EQUALS(0, aws_host_resolver_get_host_address_count(resolver, host_name, all_records));
+
+    aws_host_resolver_release(resolver);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_data.signal, &test_data.mutex, s_shutdown_complete_predicate, &test_data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&test_data.mutex));
+
+    aws_string_destroy(host_name);
+    aws_event_loop_group_release(el_group);
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_async_resolver_unreachable_nameserver, s_test_async_resolver_unreachable_nameserver)
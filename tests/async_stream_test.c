@@ -0,0 +1,162 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/async_stream.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/common/condition_variable.h>
+#include <aws/common/string.h>
+
+#include <aws/io/event_loop.h>
+#include <aws/io/stream.h>
+
+AWS_STATIC_STRING_FROM_LITERAL(s_async_test_contents, "SimpleAsyncStreamTest");
+
+struct async_stream_test_data {
+    struct aws_byte_buf read_buf;
+    struct aws_event_loop *expected_loop;
+    size_t read_count;
+    int error_code;
+    bool end_of_stream;
+    bool thread_matched;
+    bool concurrent_read_refused;
+    bool done;
+    struct aws_mutex mutex;
+    struct aws_condition_variable cvar;
+};
+
+static void s_async_stream_test_finish(struct async_stream_test_data *test_data, int error_code) {
+    aws_mutex_lock(&test_data->mutex);
+    test_data->error_code = error_code;
+    test_data->done = true;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_all(&test_data->cvar);
+}
+
+static void s_async_stream_test_on_read_complete(
+    struct aws_async_input_stream *stream,
+    int error_code,
+    bool end_of_stream,
+    void *user_data) {
+
+    struct async_stream_test_data *test_data = user_data;
+    test_data->read_count += 1;
+    test_data->end_of_stream = end_of_stream;
+    if (test_data->expected_loop && !aws_event_loop_thread_is_callers_thread(test_data->expected_loop)) {
+        test_data->thread_matched = false;
+    }
+
+    if (error_code || end_of_stream) {
+        s_async_stream_test_finish(test_data, error_code);
+        return;
+    }
+
+    /* chain the next read from the completion, like a body serializer would */
+    if (test_data->read_buf.len == test_data->read_buf.capacity) {
+        aws_byte_buf_reserve_relative(&test_data->read_buf, 4);
+    }
+    if (aws_async_input_stream_read(stream, &test_data->read_buf, s_async_stream_test_on_read_complete, test_data)) {
+        s_async_stream_test_finish(test_data, aws_last_error());
+        return;
+    }
+
+    /* the read just started can't complete before this callback returns, so this one always collides with it */
+    if (!aws_async_input_stream_read(stream, &test_data->read_buf, s_async_stream_test_on_read_complete, test_data) ||
+        aws_last_error() != AWS_ERROR_INVALID_STATE) {
+        test_data->concurrent_read_refused = false;
+    }
+}
+
+static bool s_async_stream_test_done(void *arg) {
+    struct async_stream_test_data *test_data = arg;
+    return test_data->done;
+}
+
+static int s_read_async_stream_to_end(
+    struct aws_async_input_stream *stream,
+    struct async_stream_test_data *test_data) {
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data->mutex));
+    ASSERT_SUCCESS(
+        aws_async_input_stream_read(stream, &test_data->read_buf, s_async_stream_test_on_read_complete, test_data));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&test_data->cvar, &test_data->mutex, s_async_stream_test_done, test_data));
+    aws_mutex_unlock(&test_data->mutex);
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, test_data->error_code);
+    ASSERT_TRUE(test_data->end_of_stream);
+    ASSERT_TRUE(test_data->thread_matched);
+    ASSERT_TRUE(test_data->concurrent_read_refused);
+    ASSERT_TRUE(test_data->read_count > 1);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        s_async_test_contents->bytes,
+        s_async_test_contents->len,
+        test_data->read_buf.buffer,
+        test_data->read_buf.len);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_async_input_stream_from_sync_fn(
+    struct aws_allocator *allocator,
+    void *ctx,
+    bool use_completion_loop) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *io_group = aws_event_loop_group_new_default(allocator, 2, NULL);
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_event_loop *completion_loop = aws_event_loop_group_get_next_loop(el_group);
+
+    struct aws_byte_cursor contents = aws_byte_cursor_from_string(s_async_test_contents);
+    struct aws_async_input_stream_from_sync_options options = {
+        .source = aws_input_stream_new_from_cursor(allocator, &contents),
+        .io_group = io_group,
+        .completion_loop = use_completion_loop ? completion_loop : NULL,
+    };
+    ASSERT_NOT_NULL(options.source);
+
+    struct aws_async_input_stream *stream = aws_async_input_stream_new_from_sync(allocator, &options);
+    ASSERT_NOT_NULL(stream);
+
+    struct async_stream_test_data test_data = {
+        .expected_loop = use_completion_loop ? completion_loop : NULL,
+        .thread_matched = true,
+        .concurrent_read_refused = true,
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(aws_byte_buf_init(&test_data.read_buf, allocator, 4));
+
+    ASSERT_SUCCESS(s_read_async_stream_to_end(stream, &test_data));
+
+    aws_byte_buf_clean_up(&test_data.read_buf);
+    aws_async_input_stream_destroy(stream);
+    aws_event_loop_group_release(el_group);
+    aws_event_loop_group_release(io_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that reads run off the caller's thread, in order, and complete on the I/O thread by default. */
+static int s_test_async_input_stream_from_sync_simple_fn(struct aws_allocator *allocator, void *ctx) {
+    return s_test_async_input_stream_from_sync_fn(allocator, ctx, false);
+}
+
+AWS_TEST_CASE(test_async_input_stream_from_sync_simple, s_test_async_input_stream_from_sync_simple_fn)
+
+/* Test that completions are handed over to the completion loop when one is given. */
+static int s_test_async_input_stream_from_sync_completion_loop_fn(struct aws_allocator *allocator, void *ctx) {
+    return s_test_async_input_stream_from_sync_fn(allocator, ctx, true);
+}
+
+AWS_TEST_CASE(
+    test_async_input_stream_from_sync_completion_loop,
+    s_test_async_input_stream_from_sync_completion_loop_fn)
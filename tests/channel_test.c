@@ -13,6 +13,7 @@
 #include <aws/io/event_loop.h>
 #include <aws/io/socket.h>
 #include <aws/testing/aws_test_harness.h>
+#include <aws/testing/io_testing_channel.h>
 
 #include "mock_dns_resolver.h"
 #include "read_write_test_handler.h"
@@ -208,6 +209,323 @@ static int s_test_channel_slots_clean_up(struct aws_allocator *allocator, void *
 
 AWS_TEST_CASE(channel_slots_clean_up, s_test_channel_slots_clean_up)
 
+static int s_test_channel_arena_allocator(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_channel *plain_channel = NULL;
+    struct aws_channel *arena_channel = NULL;
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .setup_completed = false,
+        .shutdown_completed = false,
+    };
+
+    struct aws_channel_options args = {
+        .on_setup_completed = s_channel_setup_test_on_setup_completed,
+        .setup_user_data = &test_args,
+        .event_loop = event_loop,
+    };
+
+    ASSERT_SUCCESS(s_channel_setup_create_and_wait(allocator, &args, &test_args, &plain_channel));
+    ASSERT_PTR_EQUALS(allocator, aws_channel_get_arena_allocator(plain_channel));
+
+    test_args.setup_completed = false;
+    args.arena_size = 1024;
+    ASSERT_SUCCESS(s_channel_setup_create_and_wait(allocator, &args, &test_args, &arena_channel));
+
+    struct aws_allocator *arena = aws_channel_get_arena_allocator(arena_channel);
+    ASSERT_TRUE(arena != allocator);
+
+    /* past the inline slots, slots come from the arena */
+    struct aws_channel_slot *slots[5];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(slots); ++i) {
+        slots[i] = aws_channel_slot_new(arena_channel);
+        ASSERT_NOT_NULL(slots[i]);
+        ASSERT_PTR_EQUALS(arena, slots[i]->alloc);
+        if (i > 0) {
+            ASSERT_SUCCESS(aws_channel_slot_insert_right(slots[i - 1], slots[i]));
+        }
+    }
+
+    /* consecutive carves come back aligned and distinct */
+    uint8_t *first = aws_mem_acquire(arena, 10);
+    uint8_t *second = aws_mem_acquire(arena, 10);
+    ASSERT_NOT_NULL(first);
+    ASSERT_NOT_NULL(second);
+    ASSERT_INT_EQUALS(0, (uintptr_t)first % sizeof(void *));
+    ASSERT_INT_EQUALS(0, (uintptr_t)second % sizeof(void *));
+    ASSERT_TRUE(second >= first + 10);
+    memset(first, 0xAB, 10);
+    memset(second, 0xCD, 10);
+    aws_mem_release(arena, first);
+
+    /* requests the arena can't hold go to the channel's allocator and have to be released like any other */
+    uint8_t *big = aws_mem_acquire(arena, 4096);
+    ASSERT_NOT_NULL(big);
+    memset(big, 0xEF, 4096);
+    aws_mem_release(arena, big);
+
+    ASSERT_SUCCESS(aws_channel_slot_remove(slots[2]));
+
+    aws_channel_destroy(plain_channel);
+    aws_channel_destroy(arena_channel);
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_arena_allocator, s_test_channel_arena_allocator)
+
+struct skipped_handler_state {
+    size_t window_increments;
+    size_t shutdowns;
+    bool destroyed;
+};
+
+static int s_skipped_handler_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    struct skipped_handler_state *state = handler->impl;
+    ++state->window_increments;
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_skipped_handler_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    struct skipped_handler_state *state = handler->impl;
+    ++state->shutdowns;
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_skipped_handler_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 16 * 1024;
+}
+
+static size_t s_skipped_handler_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+    return 0;
+}
+
+static void s_skipped_handler_destroy(struct aws_channel_handler *handler) {
+    struct skipped_handler_state *state = handler->impl;
+    state->destroyed = true;
+}
+
+/* no process functions: a pass-through in both directions */
+static struct aws_channel_handler_vtable s_skipped_handler_vtable = {
+    .increment_read_window = s_skipped_handler_increment_read_window,
+    .shutdown = s_skipped_handler_shutdown,
+    .initial_window_size = s_skipped_handler_initial_window_size,
+    .message_overhead = s_skipped_handler_message_overhead,
+    .destroy = s_skipped_handler_destroy,
+};
+
+static int s_test_channel_skips_pass_through_handlers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_testing_channel_options test_channel_options = {.clock_fn = aws_high_res_clock_get_ticks};
+    struct testing_channel testing_channel;
+    ASSERT_SUCCESS(testing_channel_init(&testing_channel, allocator, &test_channel_options));
+
+    struct skipped_handler_state state;
+    AWS_ZERO_STRUCT(state);
+    struct aws_channel_handler skipped_handler = {
+        .vtable = &s_skipped_handler_vtable,
+        .alloc = allocator,
+        .impl = &state,
+    };
+
+    struct aws_channel_slot *skipped_slot = aws_channel_slot_new(testing_channel.channel);
+    ASSERT_NOT_NULL(skipped_slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_end(testing_channel.channel, skipped_slot));
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(skipped_slot, &skipped_handler));
+    ASSERT_SUCCESS(testing_channel_install_downstream_handler(&testing_channel, 16 * 1024));
+    testing_channel_drain_queued_tasks(&testing_channel);
+
+    /* reads go from the left handler straight to the right one, charging the skipped slot's window on the way */
+    size_t window_before = skipped_slot->window_size;
+    ASSERT_SUCCESS(testing_channel_push_read_str(&testing_channel, "read"));
+    ASSERT_SUCCESS(testing_channel_check_midchannel_read_messages_str(&testing_channel, allocator, "read"));
+    ASSERT_UINT_EQUALS(window_before - 4, skipped_slot->window_size);
+
+    /* and writes go the other way */
+    ASSERT_SUCCESS(testing_channel_push_write_str(&testing_channel, "write"));
+    ASSERT_SUCCESS(testing_channel_check_written_message_str(&testing_channel, "write"));
+
+    /* window updates still pass through the handler */
+    ASSERT_SUCCESS(testing_channel_increment_read_window(&testing_channel, 4));
+    testing_channel_drain_queued_tasks(&testing_channel);
+    ASSERT_TRUE(state.window_increments > 0);
+    ASSERT_UINT_EQUALS(4, testing_channel_last_window_update(&testing_channel));
+
+    /* a skipped slot can still refuse data that exceeds its window */
+    skipped_slot->window_size = 2;
+    struct aws_io_message *message =
+        aws_channel_acquire_message_from_pool(testing_channel.channel, AWS_IO_MESSAGE_APPLICATION_DATA, 4);
+    ASSERT_NOT_NULL(message);
+    message->message_data.len = 4;
+    ASSERT_FAILS(testing_channel_push_read_message(&testing_channel, message));
+    ASSERT_INT_EQUALS(AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW, aws_last_error());
+    aws_mem_release(message->allocator, message);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing_channel));
+    ASSERT_UINT_EQUALS(2, state.shutdowns);
+    ASSERT_TRUE(state.destroyed);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_skips_pass_through_handlers, s_test_channel_skips_pass_through_handlers)
+
+struct batching_handler_state {
+    /* first, so the skipped handler's lifecycle callbacks can be shared */
+    struct skipped_handler_state lifecycle;
+    size_t batch_calls;
+    size_t batched_messages;
+    size_t single_writes;
+};
+
+static int s_batching_handler_process_read_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    (void)handler;
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_batching_handler_process_read_messages(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_linked_list *messages) {
+    struct batching_handler_state *state = handler->impl;
+    ++state->batch_calls;
+    for (struct aws_linked_list_node *node = aws_linked_list_begin(messages); node != aws_linked_list_end(messages);
+         node = aws_linked_list_next(node)) {
+        ++state->batched_messages;
+    }
+
+    /* the testing handler downstream only takes single messages, so this exercises the fallback too */
+    return aws_channel_slot_send_messages(slot, messages, AWS_CHANNEL_DIR_READ);
+}
+
+static int s_batching_handler_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+    struct batching_handler_state *state = handler->impl;
+    ++state->single_writes;
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+}
+
+static struct aws_channel_handler_vtable s_batching_handler_vtable = {
+    .process_read_message = s_batching_handler_process_read_message,
+    .process_write_message = s_batching_handler_process_write_message,
+    .process_read_messages = s_batching_handler_process_read_messages,
+    .increment_read_window = s_skipped_handler_increment_read_window,
+    .shutdown = s_skipped_handler_shutdown,
+    .initial_window_size = s_skipped_handler_initial_window_size,
+    .message_overhead = s_skipped_handler_message_overhead,
+    .destroy = s_skipped_handler_destroy,
+};
+
+static int s_push_messages(
+    struct testing_channel *testing_channel,
+    struct aws_linked_list *messages,
+    const char **contents,
+    size_t count) {
+
+    aws_linked_list_init(messages);
+    for (size_t i = 0; i < count; ++i) {
+        struct aws_byte_cursor content = aws_byte_cursor_from_c_str(contents[i]);
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(testing_channel->channel, AWS_IO_MESSAGE_APPLICATION_DATA, 16);
+        ASSERT_NOT_NULL(message);
+        ASSERT_TRUE(aws_byte_buf_write_from_whole_cursor(&message->message_data, content));
+        aws_linked_list_push_back(messages, &message->queueing_handle);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_channel_send_messages_batches(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_testing_channel_options test_channel_options = {.clock_fn = aws_high_res_clock_get_ticks};
+    struct testing_channel testing_channel;
+    ASSERT_SUCCESS(testing_channel_init(&testing_channel, allocator, &test_channel_options));
+
+    struct batching_handler_state state;
+    AWS_ZERO_STRUCT(state);
+    struct aws_channel_handler batching_handler = {
+        .vtable = &s_batching_handler_vtable,
+        .alloc = allocator,
+        .impl = &state,
+    };
+
+    struct aws_channel_slot *batching_slot = aws_channel_slot_new(testing_channel.channel);
+    ASSERT_NOT_NULL(batching_slot);
+    ASSERT_SUCCESS(aws_channel_slot_insert_end(testing_channel.channel, batching_slot));
+    ASSERT_SUCCESS(aws_channel_slot_set_handler(batching_slot, &batching_handler));
+    ASSERT_SUCCESS(testing_channel_install_downstream_handler(&testing_channel, 16 * 1024));
+    testing_channel_drain_queued_tasks(&testing_channel);
+
+    const char *contents[] = {"one", "two", "three"};
+    struct aws_linked_list messages;
+
+    /* one call into the batching handler, the whole batch charged against its window */
+    size_t window_before = batching_slot->window_size;
+    ASSERT_SUCCESS(s_push_messages(&testing_channel, &messages, contents, AWS_ARRAY_SIZE(contents)));
+    ASSERT_SUCCESS(aws_channel_slot_send_messages(testing_channel.left_handler_slot, &messages, AWS_CHANNEL_DIR_READ));
+    ASSERT_TRUE(aws_linked_list_empty(&messages));
+    ASSERT_UINT_EQUALS(1, state.batch_calls);
+    ASSERT_UINT_EQUALS(3, state.batched_messages);
+    ASSERT_UINT_EQUALS(window_before - 11, batching_slot->window_size);
+    ASSERT_SUCCESS(testing_channel_check_midchannel_read_messages_str(&testing_channel, allocator, "onetwothree"));
+
+    /* without process_write_messages, each message goes through process_write_message in order */
+    ASSERT_SUCCESS(s_push_messages(&testing_channel, &messages, contents, AWS_ARRAY_SIZE(contents)));
+    ASSERT_SUCCESS(
+        aws_channel_slot_send_messages(testing_channel.right_handler_slot, &messages, AWS_CHANNEL_DIR_WRITE));
+    ASSERT_TRUE(aws_linked_list_empty(&messages));
+    ASSERT_UINT_EQUALS(3, state.single_writes);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(contents); ++i) {
+        ASSERT_SUCCESS(testing_channel_check_written_message_str(&testing_channel, contents[i]));
+    }
+
+    /* a batch that doesn't fit the window is refused whole and stays with the sender */
+    batching_slot->window_size = 8;
+    ASSERT_SUCCESS(s_push_messages(&testing_channel, &messages, contents, AWS_ARRAY_SIZE(contents)));
+    ASSERT_FAILS(aws_channel_slot_send_messages(testing_channel.left_handler_slot, &messages, AWS_CHANNEL_DIR_READ));
+    ASSERT_INT_EQUALS(AWS_IO_CHANNEL_READ_WOULD_EXCEED_WINDOW, aws_last_error());
+    ASSERT_UINT_EQUALS(8, batching_slot->window_size);
+    ASSERT_UINT_EQUALS(1, state.batch_calls);
+    while (!aws_linked_list_empty(&messages)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&messages);
+        struct aws_io_message *message = AWS_CONTAINER_OF(node, struct aws_io_message, queueing_handle);
+        aws_mem_release(message->allocator, message);
+    }
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing_channel));
+    ASSERT_TRUE(state.lifecycle.destroyed);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_send_messages_batches, s_test_channel_send_messages_batches)
+
 static void s_wait_a_bit_task(struct aws_task *task, void *arg, enum aws_task_status status) {
     (void)task;
     (void)status;
@@ -447,6 +765,98 @@ static int s_test_channel_tasks_run(struct aws_allocator *allocator, void *ctx)
 
 AWS_TEST_CASE(channel_tasks_run, s_test_channel_tasks_run);
 
+#define TASK_BATCH_CHANNEL_COUNT 3
+
+struct task_batch_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condvar;
+    struct aws_channel *channels[TASK_BATCH_CHANNEL_COUNT];
+    struct aws_channel_task tasks[TASK_BATCH_CHANNEL_COUNT];
+    size_t run_count;
+    bool did_task_fail[TASK_BATCH_CHANNEL_COUNT];
+    bool ran_off_thread[TASK_BATCH_CHANNEL_COUNT];
+};
+
+static struct task_batch_data s_task_batch_data;
+
+static void s_task_batch_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    intptr_t id = (intptr_t)arg;
+
+    aws_mutex_lock(&s_task_batch_data.mutex);
+    s_task_batch_data.did_task_fail[id] = (status == AWS_TASK_STATUS_CANCELED);
+    s_task_batch_data.ran_off_thread[id] = !aws_channel_thread_is_callers_thread(s_task_batch_data.channels[id]);
+    s_task_batch_data.run_count++;
+    aws_condition_variable_notify_one(&s_task_batch_data.condvar);
+    aws_mutex_unlock(&s_task_batch_data.mutex);
+}
+
+static bool s_task_batch_done_pred(void *user_data) {
+    (void)user_data;
+    return s_task_batch_data.run_count == TASK_BATCH_CHANNEL_COUNT;
+}
+
+/* one batch spanning two event loops, with two of the channels sharing a loop */
+static int s_test_channel_task_batch_runs(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loops[2];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(event_loops); ++i) {
+        event_loops[i] = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+        ASSERT_NOT_NULL(event_loops[i]);
+        ASSERT_SUCCESS(aws_event_loop_run(event_loops[i]));
+    }
+
+    struct channel_setup_test_args test_args = {
+        .error_code = 0,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .setup_completed = false,
+        .shutdown_completed = false,
+    };
+
+    AWS_ZERO_STRUCT(s_task_batch_data);
+    ASSERT_SUCCESS(aws_mutex_init(&s_task_batch_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_init(&s_task_batch_data.condvar));
+
+    struct aws_channel_task_batch_entry entries[TASK_BATCH_CHANNEL_COUNT];
+    for (int i = 0; i < TASK_BATCH_CHANNEL_COUNT; ++i) {
+        struct aws_channel_options args = {
+            .on_setup_completed = s_channel_setup_test_on_setup_completed,
+            .setup_user_data = &test_args,
+            .event_loop = event_loops[i % 2],
+        };
+
+        test_args.setup_completed = false;
+        ASSERT_SUCCESS(s_channel_setup_create_and_wait(allocator, &args, &test_args, &s_task_batch_data.channels[i]));
+
+        aws_channel_task_init(&s_task_batch_data.tasks[i], s_task_batch_fn, (void *)(intptr_t)i, "test_task_batch");
+        entries[i].channel = s_task_batch_data.channels[i];
+        entries[i].task = &s_task_batch_data.tasks[i];
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&s_task_batch_data.mutex));
+    aws_channel_schedule_task_batch_now(allocator, entries, TASK_BATCH_CHANNEL_COUNT);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &s_task_batch_data.condvar, &s_task_batch_data.mutex, s_task_batch_done_pred, NULL));
+
+    for (int i = 0; i < TASK_BATCH_CHANNEL_COUNT; ++i) {
+        ASSERT_FALSE(s_task_batch_data.did_task_fail[i]);
+        ASSERT_FALSE(s_task_batch_data.ran_off_thread[i]);
+    }
+    ASSERT_SUCCESS(aws_mutex_unlock(&s_task_batch_data.mutex));
+
+    for (int i = 0; i < TASK_BATCH_CHANNEL_COUNT; ++i) {
+        aws_channel_destroy(s_task_batch_data.channels[i]);
+    }
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(event_loops); ++i) {
+        aws_event_loop_destroy(event_loops[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_task_batch_runs, s_test_channel_task_batch_runs);
+
 static int s_test_channel_rejects_post_shutdown_tasks(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
@@ -588,6 +998,83 @@ static int s_test_channel_duplicate_shutdown(struct aws_allocator *allocator, vo
 
 AWS_TEST_CASE(channel_duplicate_shutdown, s_test_channel_duplicate_shutdown)
 
+#define SHUTDOWN_MANY_CHANNEL_COUNT 4
+
+/* Test that channels shut down as a batch go through every handler once each, and one already shutting down is fine */
+static int s_test_channel_shutdown_many(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_channel *channels[SHUTDOWN_MANY_CHANNEL_COUNT];
+    struct channel_setup_test_args test_args[SHUTDOWN_MANY_CHANNEL_COUNT];
+    struct skipped_handler_state states[SHUTDOWN_MANY_CHANNEL_COUNT][2];
+    struct aws_channel_handler handlers[SHUTDOWN_MANY_CHANNEL_COUNT][2];
+    AWS_ZERO_ARRAY(states);
+
+    for (size_t i = 0; i < SHUTDOWN_MANY_CHANNEL_COUNT; ++i) {
+        test_args[i] = (struct channel_setup_test_args){
+            .error_code = 0,
+            .mutex = AWS_MUTEX_INIT,
+            .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+            .setup_completed = false,
+            .shutdown_completed = false,
+        };
+
+        struct aws_channel_options args = {
+            .on_setup_completed = s_channel_setup_test_on_setup_completed,
+            .setup_user_data = &test_args[i],
+            .on_shutdown_completed = s_channel_test_shutdown,
+            .shutdown_user_data = &test_args[i],
+            .event_loop = event_loop,
+        };
+
+        channels[i] = NULL;
+        ASSERT_SUCCESS(s_channel_setup_create_and_wait(allocator, &args, &test_args[i], &channels[i]));
+
+        for (size_t j = 0; j < 2; ++j) {
+            handlers[i][j] = (struct aws_channel_handler){
+                .vtable = &s_skipped_handler_vtable,
+                .alloc = allocator,
+                .impl = &states[i][j],
+            };
+
+            struct aws_channel_slot *slot = aws_channel_slot_new(channels[i]);
+            ASSERT_NOT_NULL(slot);
+            ASSERT_SUCCESS(aws_channel_slot_insert_end(channels[i], slot));
+            ASSERT_SUCCESS(aws_channel_slot_set_handler(slot, &handlers[i][j]));
+        }
+    }
+
+    /* this one's shutdown is already pending, so the batch leaves it alone */
+    ASSERT_SUCCESS(aws_channel_shutdown(channels[0], AWS_ERROR_SUCCESS));
+    ASSERT_SUCCESS(aws_channel_shutdown_many(channels, SHUTDOWN_MANY_CHANNEL_COUNT, AWS_IO_CHANNEL_DRAIN_TIMEOUT));
+
+    for (size_t i = 0; i < SHUTDOWN_MANY_CHANNEL_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_mutex_lock(&test_args[i].mutex));
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &test_args[i].condition_variable, &test_args[i].mutex, s_channel_test_shutdown_predicate, &test_args[i]));
+        ASSERT_SUCCESS(aws_mutex_unlock(&test_args[i].mutex));
+        aws_channel_destroy(channels[i]);
+    }
+
+    aws_event_loop_destroy(event_loop);
+
+    for (size_t i = 0; i < SHUTDOWN_MANY_CHANNEL_COUNT; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            /* once in each direction */
+            ASSERT_UINT_EQUALS(2, states[i][j].shutdowns);
+            ASSERT_TRUE(states[i][j].destroyed);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(channel_shutdown_many, s_test_channel_shutdown_many)
+
 struct channel_connect_test_args {
     struct aws_mutex *mutex;
     struct aws_condition_variable cv;
@@ -676,6 +676,187 @@ static int s_test_resolver_connect_failure_recording_fn(struct aws_allocator *al
 
 AWS_TEST_CASE(test_resolver_connect_failure_recording, s_test_resolver_connect_failure_recording_fn)
 
+static int s_test_resolver_lowest_latency_selection_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 10, el_group, NULL);
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "host_address");
+
+    const struct aws_string *slow_address = aws_string_new_from_c_str(allocator, "slowaddress");
+    const struct aws_string *fast_address = aws_string_new_from_c_str(allocator, "fastaddress");
+
+    struct mock_dns_resolver mock_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_resolver, 1000, allocator));
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 30,
+        .impl = mock_dns_resolve,
+        .impl_data = &mock_resolver,
+        .address_selection = AWS_HOST_ADDRESS_SELECTION_LOWEST_LATENCY,
+    };
+
+    struct aws_host_address slow_host_address = {
+        .address = slow_address,
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "host_address"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_host_address fast_host_address = {
+        .address = fast_address,
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "host_address"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_array_list address_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&address_list, allocator, 2, sizeof(struct aws_host_address)));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &slow_host_address));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &fast_host_address));
+
+    ASSERT_SUCCESS(mock_dns_resolver_append_address_list(&mock_resolver, &address_list));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct default_host_callback_data callback_data = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = &mutex,
+    };
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+        resolver, host_name, s_default_host_resolved_test_callback, &config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &mutex, s_default_host_resolved_predicate, &callback_data);
+    ASSERT_TRUE(callback_data.has_a_address);
+    aws_host_address_clean_up(&callback_data.a_address);
+    aws_mutex_unlock(&mutex);
+
+    ASSERT_SUCCESS(aws_host_resolver_record_connection_success(resolver, &slow_host_address, 50000000));
+    ASSERT_SUCCESS(aws_host_resolver_record_connection_success(resolver, &fast_host_address, 5000000));
+
+    /* every pick but the exploring ones, one in eight, goes to the fast address */
+    size_t fast_count = 0;
+    size_t slow_count = 0;
+    for (size_t i = 0; i < 16; ++i) {
+        callback_data.invoked = false;
+        callback_data.has_a_address = false;
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            resolver, host_name, s_default_host_resolved_test_callback, &config, &callback_data));
+
+        aws_mutex_lock(&mutex);
+        aws_condition_variable_wait_pred(
+            &callback_data.condition_variable, &mutex, s_default_host_resolved_predicate, &callback_data);
+        ASSERT_TRUE(callback_data.has_a_address);
+        if (aws_string_eq(fast_address, callback_data.a_address.address)) {
+            ++fast_count;
+        } else if (aws_string_eq(slow_address, callback_data.a_address.address)) {
+            ++slow_count;
+        }
+        aws_host_address_clean_up(&callback_data.a_address);
+        aws_mutex_unlock(&mutex);
+    }
+
+    ASSERT_TRUE(fast_count >= 14);
+    ASSERT_TRUE(slow_count >= 1);
+    ASSERT_UINT_EQUALS(16, fast_count + slow_count);
+
+    mock_dns_resolver_clean_up(&mock_resolver);
+    aws_host_resolver_release(resolver);
+    aws_string_destroy((void *)host_name);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_lowest_latency_selection, s_test_resolver_lowest_latency_selection_fn)
+
+static int s_test_resolver_shares_cached_strings_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 10, el_group, NULL);
+
+    const struct aws_string *host_name = aws_string_new_from_c_str(allocator, "host_address");
+
+    struct mock_dns_resolver mock_resolver;
+    ASSERT_SUCCESS(mock_dns_resolver_init(&mock_resolver, 1000, allocator));
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 30,
+        .impl = mock_dns_resolve,
+        .impl_data = &mock_resolver,
+    };
+
+    struct aws_host_address host_address = {
+        .address = aws_string_new_from_c_str(allocator, "address1ipv4"),
+        .allocator = allocator,
+        .host = aws_string_new_from_c_str(allocator, "host_address"),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    struct aws_array_list address_list;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&address_list, allocator, 1, sizeof(struct aws_host_address)));
+    ASSERT_SUCCESS(aws_array_list_push_back(&address_list, &host_address));
+    ASSERT_SUCCESS(mock_dns_resolver_append_address_list(&mock_resolver, &address_list));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct default_host_callback_data callback_data = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = &mutex,
+    };
+
+    /* the first answer comes from the fresh resolution, the second from the cache */
+    struct aws_host_address answers[2];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(answers); ++i) {
+        callback_data.invoked = false;
+        callback_data.has_a_address = false;
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            resolver, host_name, s_default_host_resolved_test_callback, &config, &callback_data));
+
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_condition_variable_wait_pred(
+            &callback_data.condition_variable, &mutex, s_default_host_resolved_predicate, &callback_data);
+        ASSERT_TRUE(callback_data.has_a_address);
+        answers[i] = callback_data.a_address;
+        aws_mutex_unlock(&mutex);
+    }
+
+    /* both callbacks and our copies of what they got point at the strings the cache holds */
+    ASSERT_TRUE(aws_string_eq(host_address.address, answers[0].address));
+    ASSERT_PTR_EQUALS(answers[0].address, answers[1].address);
+    ASSERT_PTR_EQUALS(answers[0].host, answers[1].host);
+
+    /* the cache still holds them after these go */
+    aws_host_address_clean_up(&answers[0]);
+    struct aws_host_address copy;
+    ASSERT_SUCCESS(aws_host_address_copy(&answers[1], &copy));
+    aws_host_address_clean_up(&answers[1]);
+    ASSERT_TRUE(aws_string_eq_c_str(copy.address, "address1ipv4"));
+    aws_host_address_clean_up(&copy);
+
+    mock_dns_resolver_clean_up(&mock_resolver);
+    aws_host_resolver_release(resolver);
+    aws_string_destroy((void *)host_name);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+
+AWS_TEST_CASE(test_resolver_shares_cached_strings, s_test_resolver_shares_cached_strings_fn)
+
 static int s_test_resolver_ttl_refreshes_on_resolve_fn(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
@@ -967,6 +1148,685 @@ static int s_test_resolver_ipv6_address_lookup_fn(struct aws_allocator *allocato
 }
 AWS_TEST_CASE(test_resolver_ipv6_address_lookup, s_test_resolver_ipv6_address_lookup_fn)
 
+#define MANY_HOSTS_COUNT 200
+
+struct many_hosts_callback_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    size_t resolved_count;
+    size_t error_count;
+};
+
+static bool s_many_hosts_resolved_predicate(void *arg) {
+    struct many_hosts_callback_data *callback_data = arg;
+    return callback_data->resolved_count + callback_data->error_count == MANY_HOSTS_COUNT;
+}
+
+static void s_many_hosts_resolved_callback(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    (void)host_name;
+    (void)host_addresses;
+
+    struct many_hosts_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->mutex);
+    if (err_code) {
+        callback_data->error_count++;
+    } else {
+        callback_data->resolved_count++;
+    }
+    aws_mutex_unlock(&callback_data->mutex);
+    aws_condition_variable_notify_one(&callback_data->condition_variable);
+}
+
+/* resolves every host to a single A record with the host name as its address */
+static int s_echo_dns_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    (void)user_data;
+
+    struct aws_host_address host_address = {
+        .allocator = allocator,
+        .host = aws_string_new_from_string(allocator, host_name),
+        .address = aws_string_new_from_string(allocator, host_name),
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+
+    if (!host_address.host || !host_address.address || aws_array_list_push_back(output_addresses, &host_address)) {
+        aws_host_address_clean_up(&host_address);
+        return AWS_OP_ERR;
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* far more hosts than resolver threads, every query must still be answered and shutdown must not hang */
+static int s_test_resolver_many_hosts_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, MANY_HOSTS_COUNT, el_group, NULL);
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_echo_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name_buf[32];
+        snprintf(host_name_buf, sizeof(host_name_buf), "host%zu.example.com", i);
+        struct aws_string *host_name = aws_string_new_from_c_str(allocator, host_name_buf);
+        ASSERT_NOT_NULL(host_name);
+
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+        aws_string_destroy(host_name);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data));
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.resolved_count);
+    ASSERT_UINT_EQUALS(0, callback_data.error_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_many_hosts, s_test_resolver_many_hosts_fn)
+
+#define CONCURRENT_HITS_THREAD_COUNT 4
+#define CONCURRENT_HITS_PER_THREAD 1000
+
+struct concurrent_hits_thread_data {
+    struct aws_host_resolver *resolver;
+    const struct aws_string *host_name;
+    struct aws_host_resolution_config *config;
+    struct many_hosts_callback_data *callback_data;
+};
+
+static void s_concurrent_hits_thread_fn(void *arg) {
+    struct concurrent_hits_thread_data *thread_data = arg;
+
+    for (size_t i = 0; i < CONCURRENT_HITS_PER_THREAD; ++i) {
+        aws_host_resolver_resolve_host(
+            thread_data->resolver,
+            thread_data->host_name,
+            s_many_hosts_resolved_callback,
+            thread_data->config,
+            thread_data->callback_data);
+    }
+}
+
+static bool s_first_hit_resolved_predicate(void *arg) {
+    struct many_hosts_callback_data *callback_data = arg;
+    return callback_data->resolved_count + callback_data->error_count > 0;
+}
+
+/* once a host is cached, queries racing in from several threads are all answered from the cache */
+static int s_test_resolver_concurrent_cache_hits_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_echo_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "hot.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    ASSERT_SUCCESS(
+        aws_host_resolver_resolve_host(resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_first_hit_resolved_predicate, &callback_data));
+    ASSERT_UINT_EQUALS(1, callback_data.resolved_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    struct concurrent_hits_thread_data thread_data = {
+        .resolver = resolver,
+        .host_name = host_name,
+        .config = &config,
+        .callback_data = &callback_data,
+    };
+
+    struct aws_thread threads[CONCURRENT_HITS_THREAD_COUNT];
+    for (size_t i = 0; i < CONCURRENT_HITS_THREAD_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_concurrent_hits_thread_fn, &thread_data, NULL));
+    }
+
+    for (size_t i = 0; i < CONCURRENT_HITS_THREAD_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    /* cache hits call back before resolve_host returns, so every query has been answered by now */
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_UINT_EQUALS(1 + CONCURRENT_HITS_THREAD_COUNT * CONCURRENT_HITS_PER_THREAD, callback_data.resolved_count);
+    ASSERT_UINT_EQUALS(0, callback_data.error_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_string_destroy(host_name);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_concurrent_cache_hits, s_test_resolver_concurrent_cache_hits_fn)
+
+static int s_failing_dns_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    (void)allocator;
+    (void)host_name;
+    (void)output_addresses;
+    (void)user_data;
+
+    return aws_raise_error(AWS_IO_DNS_INVALID_NAME);
+}
+
+struct error_callback_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    int error_code;
+    size_t invoked_count;
+};
+
+static void s_error_callback(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    (void)host_name;
+    (void)host_addresses;
+
+    struct error_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->mutex);
+    callback_data->error_code = err_code;
+    ++callback_data->invoked_count;
+    aws_mutex_unlock(&callback_data->mutex);
+    aws_condition_variable_notify_one(&callback_data->condition_variable);
+}
+
+static bool s_error_callback_invoked_predicate(void *arg) {
+    struct error_callback_data *callback_data = arg;
+    return callback_data->invoked_count > 0;
+}
+
+/* after a failed resolution, queries within negative_ttl fail on the calling thread without another lookup */
+static int s_test_resolver_negative_cache_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_failing_dns_resolve,
+        .impl_data = NULL,
+        .negative_ttl = 30,
+    };
+
+    struct error_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "nxdomain.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(resolver, host_name, s_error_callback, &config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_error_callback_invoked_predicate, &callback_data));
+    ASSERT_INT_EQUALS(AWS_IO_DNS_INVALID_NAME, callback_data.error_code);
+    callback_data.invoked_count = 0;
+    callback_data.error_code = AWS_ERROR_SUCCESS;
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    /* answered before resolve_host returns */
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(resolver, host_name, s_error_callback, &config, &callback_data));
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_UINT_EQUALS(1, callback_data.invoked_count);
+    ASSERT_INT_EQUALS(AWS_IO_DNS_INVALID_NAME, callback_data.error_code);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    struct aws_host_resolver_stats stats;
+    ASSERT_SUCCESS(aws_host_resolver_get_stats(resolver, &stats));
+    ASSERT_UINT_EQUALS(1, stats.fresh_resolutions);
+    ASSERT_UINT_EQUALS(0, stats.coalesced_resolutions);
+    ASSERT_UINT_EQUALS(1, stats.negative_cache_hits);
+
+    aws_string_destroy(host_name);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_negative_cache, s_test_resolver_negative_cache_fn)
+
+struct gated_resolve_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool resolving;
+    bool released;
+};
+
+static bool s_gated_resolve_released_predicate(void *arg) {
+    struct gated_resolve_data *gate = arg;
+    return gate->released;
+}
+
+static bool s_gated_resolve_resolving_predicate(void *arg) {
+    struct gated_resolve_data *gate = arg;
+    return gate->resolving;
+}
+
+/* like s_echo_dns_resolve, but holds the lookup until the test lets it go */
+static int s_gated_dns_resolve(
+    struct aws_allocator *allocator,
+    const struct aws_string *host_name,
+    struct aws_array_list *output_addresses,
+    void *user_data) {
+
+    struct gated_resolve_data *gate = user_data;
+
+    aws_mutex_lock(&gate->mutex);
+    gate->resolving = true;
+    aws_condition_variable_notify_all(&gate->condition_variable);
+    aws_condition_variable_wait_pred(&gate->condition_variable, &gate->mutex, s_gated_resolve_released_predicate, gate);
+    aws_mutex_unlock(&gate->mutex);
+
+    return s_echo_dns_resolve(allocator, host_name, output_addresses, NULL);
+}
+
+/* queries arriving while a host's first lookup is in flight wait on it rather than starting their own */
+static int s_test_resolver_coalesced_resolutions_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+
+    struct gated_resolve_data gate = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_gated_dns_resolve,
+        .impl_data = &gate,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "coalesced.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    ASSERT_SUCCESS(
+        aws_host_resolver_resolve_host(resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&gate.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &gate.condition_variable, &gate.mutex, s_gated_resolve_resolving_predicate, &gate));
+    ASSERT_SUCCESS(aws_mutex_unlock(&gate.mutex));
+
+    const size_t waiting_query_count = 3;
+    for (size_t i = 0; i < waiting_query_count; ++i) {
+        ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+            resolver, host_name, s_many_hosts_resolved_callback, &config, &callback_data));
+    }
+
+    struct aws_host_resolver_stats stats;
+    ASSERT_SUCCESS(aws_host_resolver_get_stats(resolver, &stats));
+    ASSERT_UINT_EQUALS(1, stats.fresh_resolutions);
+    ASSERT_UINT_EQUALS(waiting_query_count, stats.coalesced_resolutions);
+    ASSERT_UINT_EQUALS(0, stats.negative_cache_hits);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&gate.mutex));
+    gate.released = true;
+    aws_condition_variable_notify_all(&gate.condition_variable);
+    ASSERT_SUCCESS(aws_mutex_unlock(&gate.mutex));
+
+    aws_string_destroy(host_name);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_coalesced_resolutions, s_test_resolver_coalesced_resolutions_fn)
+
+static int s_check_cached_a_address(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    struct aws_host_resolution_config *config,
+    const char *expected_address) {
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct default_host_callback_data callback_data = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = &mutex,
+    };
+
+    /* cached, so answered before resolve_host returns */
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host(
+        resolver, host_name, s_default_host_resolved_test_callback, config, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_TRUE(callback_data.invoked);
+    ASSERT_TRUE(callback_data.has_a_address);
+    ASSERT_FALSE(callback_data.has_aaaa_address);
+    ASSERT_STR_EQUALS(expected_address, aws_string_c_str(callback_data.a_address.address));
+    aws_host_address_clean_up(&callback_data.a_address);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    return AWS_OP_SUCCESS;
+}
+
+/* seeded addresses are served before the first lookup finishes, and survive a save and load into another resolver */
+static int s_test_resolver_seed_and_restore_cache_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+    struct aws_host_resolver *restored_resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+
+    /* lookups never finish during the test, so only the seeded addresses can answer */
+    struct gated_resolve_data gate = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_gated_dns_resolve,
+        .impl_data = &gate,
+    };
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "seeded.example.com");
+    struct aws_string *address = aws_string_new_from_c_str(allocator, "10.0.0.1");
+    ASSERT_NOT_NULL(host_name);
+    ASSERT_NOT_NULL(address);
+
+    struct aws_host_address seed_address = {
+        .address = address,
+        .record_type = AWS_ADDRESS_RECORD_TYPE_A,
+    };
+    struct aws_host_address seed_address_storage[1];
+    struct aws_array_list seed_addresses;
+    aws_array_list_init_static(&seed_addresses, seed_address_storage, 1, sizeof(struct aws_host_address));
+    ASSERT_SUCCESS(aws_array_list_push_back(&seed_addresses, &seed_address));
+
+    ASSERT_SUCCESS(aws_host_resolver_seed_host(resolver, host_name, &seed_addresses, &config));
+    ASSERT_SUCCESS(s_check_cached_a_address(resolver, host_name, &config, "10.0.0.1"));
+
+    struct aws_byte_buf cache;
+    ASSERT_SUCCESS(aws_byte_buf_init(&cache, allocator, 16));
+    ASSERT_SUCCESS(aws_host_resolver_save_cache(resolver, &cache));
+
+    ASSERT_SUCCESS(aws_host_resolver_load_cache(restored_resolver, aws_byte_cursor_from_buf(&cache), &config));
+    ASSERT_SUCCESS(s_check_cached_a_address(restored_resolver, host_name, &config, "10.0.0.1"));
+
+    /* a truncated cache is rejected */
+    struct aws_byte_cursor truncated = aws_byte_cursor_from_buf(&cache);
+    truncated.len -= 1;
+    ASSERT_ERROR(AWS_IO_FILE_VALIDATION_FAILURE, aws_host_resolver_load_cache(restored_resolver, truncated, &config));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&gate.mutex));
+    gate.released = true;
+    aws_condition_variable_notify_all(&gate.condition_variable);
+    ASSERT_SUCCESS(aws_mutex_unlock(&gate.mutex));
+
+    aws_byte_buf_clean_up(&cache);
+    aws_string_destroy(address);
+    aws_string_destroy(host_name);
+    aws_host_resolver_release(restored_resolver);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_seed_and_restore_cache, s_test_resolver_seed_and_restore_cache_fn)
+
+/* a batch gets one callback per host, from the cache the second time around */
+static int s_test_resolver_resolve_hosts_batch_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, MANY_HOSTS_COUNT, el_group, NULL);
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_echo_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct many_hosts_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_string *host_names[MANY_HOSTS_COUNT];
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        char host_name_buf[32];
+        snprintf(host_name_buf, sizeof(host_name_buf), "shard%zu.example.com", i);
+        host_names[i] = aws_string_new_from_c_str(allocator, host_name_buf);
+        ASSERT_NOT_NULL(host_names[i]);
+    }
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_hosts(
+        resolver,
+        (const struct aws_string *const *)host_names,
+        MANY_HOSTS_COUNT,
+        s_many_hosts_resolved_callback,
+        &config,
+        &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable, &callback_data.mutex, s_many_hosts_resolved_predicate, &callback_data));
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.resolved_count);
+    ASSERT_UINT_EQUALS(0, callback_data.error_count);
+    callback_data.resolved_count = 0;
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    /* everything is cached now, so the whole batch is answered before resolve_hosts returns */
+    ASSERT_SUCCESS(aws_host_resolver_resolve_hosts(
+        resolver,
+        (const struct aws_string *const *)host_names,
+        MANY_HOSTS_COUNT,
+        s_many_hosts_resolved_callback,
+        &config,
+        &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_UINT_EQUALS(MANY_HOSTS_COUNT, callback_data.resolved_count);
+    ASSERT_UINT_EQUALS(0, callback_data.error_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    for (size_t i = 0; i < MANY_HOSTS_COUNT; ++i) {
+        aws_string_destroy(host_names[i]);
+    }
+
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_resolve_hosts_batch, s_test_resolver_resolve_hosts_batch_fn)
+
+struct event_loop_callback_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_event_loop *event_loop;
+    size_t invoked_count;
+    size_t on_event_loop_count;
+    int error_code;
+};
+
+static void s_event_loop_resolved_callback(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    int err_code,
+    const struct aws_array_list *host_addresses,
+    void *user_data) {
+
+    (void)resolver;
+    (void)host_name;
+    (void)host_addresses;
+
+    struct event_loop_callback_data *callback_data = user_data;
+
+    aws_mutex_lock(&callback_data->mutex);
+    ++callback_data->invoked_count;
+    if (aws_event_loop_thread_is_callers_thread(callback_data->event_loop)) {
+        ++callback_data->on_event_loop_count;
+    }
+    if (err_code) {
+        callback_data->error_code = err_code;
+    }
+    aws_mutex_unlock(&callback_data->mutex);
+    aws_condition_variable_notify_one(&callback_data->condition_variable);
+}
+
+static bool s_event_loop_first_callback_predicate(void *arg) {
+    struct event_loop_callback_data *callback_data = arg;
+    return callback_data->invoked_count == 1;
+}
+
+static bool s_event_loop_callbacks_done_predicate(void *arg) {
+    struct event_loop_callback_data *callback_data = arg;
+    return callback_data->invoked_count == 2;
+}
+
+/* answers land on the requested event loop, both for a fresh lookup and for a cache hit made from another thread */
+static int s_test_resolver_resolve_on_event_loop_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, el_group, NULL);
+
+    struct aws_host_resolution_config config = {
+        .max_ttl = 10,
+        .impl = s_echo_dns_resolve,
+        .impl_data = NULL,
+    };
+
+    struct event_loop_callback_data callback_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = aws_event_loop_group_get_next_loop(el_group),
+    };
+
+    struct aws_string *host_name = aws_string_new_from_c_str(allocator, "affine.example.com");
+    ASSERT_NOT_NULL(host_name);
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host_on_event_loop(
+        resolver, host_name, s_event_loop_resolved_callback, &config, callback_data.event_loop, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable,
+        &callback_data.mutex,
+        s_event_loop_first_callback_predicate,
+        &callback_data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    ASSERT_SUCCESS(aws_host_resolver_resolve_host_on_event_loop(
+        resolver, host_name, s_event_loop_resolved_callback, &config, callback_data.event_loop, &callback_data));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&callback_data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &callback_data.condition_variable,
+        &callback_data.mutex,
+        s_event_loop_callbacks_done_predicate,
+        &callback_data));
+    ASSERT_UINT_EQUALS(2, callback_data.on_event_loop_count);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, callback_data.error_code);
+    ASSERT_SUCCESS(aws_mutex_unlock(&callback_data.mutex));
+
+    aws_string_destroy(host_name);
+    aws_host_resolver_release(resolver);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return 0;
+}
+AWS_TEST_CASE(test_resolver_resolve_on_event_loop, s_test_resolver_resolve_on_event_loop_fn)
+
 struct listener_test_callback_data {
     struct aws_allocator *allocator;
     struct aws_condition_variable condition_variable;
@@ -13,6 +13,8 @@
 #include <aws/common/thread.h>
 #include <aws/testing/aws_test_harness.h>
 
+#include <string.h>
+
 struct task_args {
     bool invoked;
     bool was_in_thread;
@@ -165,6 +167,342 @@ static int s_test_event_loop_canceled_tasks_run_in_el_thread(struct aws_allocato
 
 AWS_TEST_CASE(event_loop_canceled_tasks_run_in_el_thread, s_test_event_loop_canceled_tasks_run_in_el_thread)
 
+enum {
+    XTHREAD_PRODUCER_COUNT = 4,
+    XTHREAD_TASKS_PER_PRODUCER = 1000,
+};
+
+struct xthread_producer_args {
+    struct aws_event_loop *loop;
+    struct aws_task tasks[XTHREAD_TASKS_PER_PRODUCER];
+    size_t next_expected_task;
+    bool out_of_order;
+    struct aws_atomic_var *tasks_run;
+};
+
+static void s_xthread_producer_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)status;
+    struct xthread_producer_args *args = user_data;
+
+    /* tasks from a single producer must run in the order they were scheduled */
+    if (task != &args->tasks[args->next_expected_task]) {
+        args->out_of_order = true;
+    }
+    args->next_expected_task++;
+    aws_atomic_fetch_add(args->tasks_run, 1);
+}
+
+static void s_xthread_producer_fn(void *user_data) {
+    struct xthread_producer_args *args = user_data;
+
+    for (size_t i = 0; i < XTHREAD_TASKS_PER_PRODUCER; ++i) {
+        aws_task_init(&args->tasks[i], s_xthread_producer_task, args, "xthread_many_producers");
+        aws_event_loop_schedule_task_now(args->loop, &args->tasks[i]);
+    }
+}
+
+static int s_run_xthread_many_producers(struct aws_allocator *allocator, struct aws_event_loop *event_loop) {
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_atomic_var tasks_run;
+    aws_atomic_init_int(&tasks_run, 0);
+
+    struct xthread_producer_args *producer_args =
+        aws_mem_calloc(allocator, XTHREAD_PRODUCER_COUNT, sizeof(struct xthread_producer_args));
+    ASSERT_NOT_NULL(producer_args);
+
+    struct aws_thread threads[XTHREAD_PRODUCER_COUNT];
+    for (size_t i = 0; i < XTHREAD_PRODUCER_COUNT; ++i) {
+        producer_args[i].loop = event_loop;
+        producer_args[i].tasks_run = &tasks_run;
+        ASSERT_SUCCESS(aws_thread_init(&threads[i], allocator));
+        ASSERT_SUCCESS(aws_thread_launch(&threads[i], s_xthread_producer_fn, &producer_args[i], NULL));
+    }
+
+    for (size_t i = 0; i < XTHREAD_PRODUCER_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_thread_join(&threads[i]));
+        aws_thread_clean_up(&threads[i]);
+    }
+
+    while (aws_atomic_load_int(&tasks_run) < XTHREAD_PRODUCER_COUNT * XTHREAD_TASKS_PER_PRODUCER) {
+        aws_thread_current_sleep(1000000);
+    }
+
+    aws_event_loop_destroy(event_loop);
+
+    for (size_t i = 0; i < XTHREAD_PRODUCER_COUNT; ++i) {
+        ASSERT_FALSE(producer_args[i].out_of_order);
+        ASSERT_UINT_EQUALS(XTHREAD_TASKS_PER_PRODUCER, producer_args[i].next_expected_task);
+    }
+
+    aws_mem_release(allocator, producer_args);
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Test that tasks scheduled concurrently from several threads all execute, in per-thread order.
+ */
+static int s_test_event_loop_xthread_many_producers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_run_xthread_many_producers(allocator, aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks));
+}
+
+AWS_TEST_CASE(event_loop_xthread_many_producers, s_test_event_loop_xthread_many_producers)
+
+/*
+ * Same as above with a busy-polling loop, where producers skip the wakeup while the loop spins. The spin is short
+ * enough that the loop also goes back to blocking in between, so both hand-offs get exercised.
+ */
+static int s_test_event_loop_busy_poll_xthread_many_producers(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .busy_poll_spin_us = 200,
+    };
+
+    return s_run_xthread_many_producers(allocator, aws_event_loop_new_default_with_options(allocator, &options));
+}
+
+AWS_TEST_CASE(event_loop_busy_poll_xthread_many_producers, s_test_event_loop_busy_poll_xthread_many_producers)
+
+struct awake_handoff_args {
+    struct aws_atomic_var first_task_running;
+    struct aws_atomic_var second_task_scheduled;
+    struct aws_atomic_var second_task_run;
+};
+
+static void s_awake_handoff_first_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct awake_handoff_args *args = user_data;
+
+    /* hold the loop awake until the other task has been scheduled from outside */
+    aws_atomic_store_int(&args->first_task_running, 1);
+    while (!aws_atomic_load_int(&args->second_task_scheduled)) {
+        aws_thread_current_sleep(100000);
+    }
+}
+
+static void s_awake_handoff_second_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    struct awake_handoff_args *args = user_data;
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        aws_atomic_store_int(&args->second_task_run, 1);
+    }
+}
+
+/*
+ * Test that a task scheduled cross-thread while the loop is busy running tasks, when producers skip the wakeup, runs
+ * right after rather than waiting out the loop's idle timeout.
+ */
+static int s_test_event_loop_xthread_task_while_awake(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct awake_handoff_args args;
+    aws_atomic_init_int(&args.first_task_running, 0);
+    aws_atomic_init_int(&args.second_task_scheduled, 0);
+    aws_atomic_init_int(&args.second_task_run, 0);
+
+    struct aws_task first_task;
+    aws_task_init(&first_task, s_awake_handoff_first_task, &args, "xthread_task_while_awake_first");
+    aws_event_loop_schedule_task_now(event_loop, &first_task);
+
+    while (!aws_atomic_load_int(&args.first_task_running)) {
+        aws_thread_current_sleep(100000);
+    }
+
+    struct aws_task second_task;
+    aws_task_init(&second_task, s_awake_handoff_second_task, &args, "xthread_task_while_awake_second");
+    aws_event_loop_schedule_task_now(event_loop, &second_task);
+    aws_atomic_store_int(&args.second_task_scheduled, 1);
+
+    /* well short of the loop's idle timeout */
+    for (size_t i = 0; i < 5000 && !aws_atomic_load_int(&args.second_task_run); ++i) {
+        aws_thread_current_sleep(1000000);
+    }
+    ASSERT_INT_EQUALS(1, aws_atomic_load_int(&args.second_task_run));
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_xthread_task_while_awake, s_test_event_loop_xthread_task_while_awake)
+
+/*
+ * Test that with the timer wheel on, coarse future tasks run no earlier than scheduled, and that the ones still
+ * waiting are canceled on the event-loop thread when the loop is destroyed.
+ */
+static int s_test_event_loop_timer_wheel_tasks(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .use_timer_wheel = true,
+    };
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default_with_options(allocator, &options);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct task_args task1_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = AWS_MUTEX_INIT,
+        .status = -1,
+        .loop = event_loop,
+    };
+    struct task_args task2_args = {
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .mutex = AWS_MUTEX_INIT,
+        .status = -1,
+        .loop = event_loop,
+    };
+
+    struct aws_task task1;
+    aws_task_init(&task1, s_test_task, &task1_args, "timer_wheel_tasks1");
+    struct aws_task task2;
+    aws_task_init(&task2, s_test_task, &task2_args, "timer_wheel_tasks2");
+
+    uint64_t now;
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    uint64_t task1_run_at = now + aws_timestamp_convert(30, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    aws_event_loop_schedule_task_future(event_loop, &task1, task1_run_at);
+    aws_event_loop_schedule_task_future(event_loop, &task2, now + 10000000000);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task1_args.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task1_args.condition_variable, &task1_args.mutex, s_task_ran_predicate, &task1_args));
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_RUN_READY, task1_args.status);
+    ASSERT_TRUE(task1_args.was_in_thread);
+    aws_mutex_unlock(&task1_args.mutex);
+
+    ASSERT_SUCCESS(aws_event_loop_current_clock_time(event_loop, &now));
+    ASSERT_TRUE(now >= task1_run_at);
+
+    aws_event_loop_destroy(event_loop);
+
+    ASSERT_TRUE(task2_args.invoked);
+    ASSERT_TRUE(task2_args.was_in_thread);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, task2_args.status);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_timer_wheel_tasks, s_test_event_loop_timer_wheel_tasks)
+
+struct profiler_test_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool reported;
+    const char *slowest_tag;
+    uint64_t slowest_duration_ns;
+    uint64_t tick_duration_ns;
+    uint64_t slow_task_run_count;
+};
+
+static void s_profiler_test_on_type_stats(const struct aws_event_loop_task_type_stats *stats, void *user_data) {
+    struct profiler_test_args *args = user_data;
+    if (strcmp(stats->type_tag, "profiler_test_slow_work") == 0) {
+        args->slow_task_run_count = stats->run_count;
+    }
+}
+
+static void s_profiler_test_on_slow_tick(
+    struct aws_event_loop *event_loop,
+    const struct aws_event_loop_slow_tick_report *report,
+    void *user_data) {
+    struct profiler_test_args *args = user_data;
+
+    aws_mutex_lock(&args->mutex);
+    if (report->slowest_count > 0) {
+        args->slowest_tag = report->slowest[0].type_tag;
+        args->slowest_duration_ns = report->slowest[0].duration_ns;
+    }
+    args->tick_duration_ns = report->tick_duration_ns;
+    aws_event_loop_profiler_for_each_type(event_loop, s_profiler_test_on_type_stats, args);
+    args->reported = true;
+
+    /* from here is allowed */
+    aws_event_loop_disable_profiler(event_loop);
+    aws_mutex_unlock(&args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static bool s_profiler_reported(void *arg) {
+    struct profiler_test_args *args = arg;
+    return args->reported;
+}
+
+struct profiler_test_task {
+    struct aws_task task;
+    struct aws_event_loop *event_loop;
+    struct profiler_test_args *args;
+};
+
+static void s_profiler_test_slow_tick_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)status;
+    struct profiler_test_task *test_task = AWS_CONTAINER_OF(task, struct profiler_test_task, task);
+    (void)arg;
+
+    struct aws_event_loop_profiler_options options = {
+        .slow_tick_threshold_ns = aws_timestamp_convert(5, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL),
+        .on_slow_tick = s_profiler_test_on_slow_tick,
+        .user_data = test_task->args,
+    };
+    aws_event_loop_enable_profiler(test_task->event_loop, &options);
+
+    /* a quick item, then one slow enough to make the tick go over */
+    uint64_t start_ns = aws_event_loop_profiler_begin(test_task->event_loop);
+    aws_event_loop_profiler_end(test_task->event_loop, "profiler_test_quick_work", start_ns);
+
+    start_ns = aws_event_loop_profiler_begin(test_task->event_loop);
+    aws_thread_current_sleep(aws_timestamp_convert(20, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    aws_event_loop_profiler_end(test_task->event_loop, "profiler_test_slow_work", start_ns);
+}
+
+/* Test that a tick over the threshold is reported, naming its slowest work. */
+static int s_test_event_loop_profiler_slow_tick(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct profiler_test_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct profiler_test_task test_task = {
+        .event_loop = event_loop,
+        .args = &args,
+    };
+    aws_task_init(&test_task.task, s_profiler_test_slow_tick_task, NULL, "profiler_test_slow_tick");
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &test_task.task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_profiler_reported, &args));
+    aws_mutex_unlock(&args.mutex);
+
+    ASSERT_NOT_NULL(args.slowest_tag);
+    ASSERT_STR_EQUALS("profiler_test_slow_work", args.slowest_tag);
+    ASSERT_TRUE(args.slowest_duration_ns >= aws_timestamp_convert(20, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    ASSERT_TRUE(args.tick_duration_ns >= args.slowest_duration_ns);
+    ASSERT_UINT_EQUALS(1, args.slow_task_run_count);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_profiler_slow_tick, s_test_event_loop_profiler_slow_tick)
+
 #if AWS_USE_IO_COMPLETION_PORTS
 
 int aws_pipe_get_unique_name(char *dst, size_t dst_size);
@@ -303,6 +641,99 @@ static int s_test_event_loop_completion_events(struct aws_allocator *allocator,
 
 AWS_TEST_CASE(event_loop_completion_events, s_test_event_loop_completion_events)
 
+#    define MANY_COMPLETIONS_PIPE_COUNT 16
+
+struct many_completions_data {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    struct aws_overlapped overlapped[MANY_COMPLETIONS_PIPE_COUNT];
+    bool completed[MANY_COMPLETIONS_PIPE_COUNT];
+    size_t completed_count;
+    int status_code;
+};
+
+static void s_on_many_completions_operation_complete(
+    struct aws_event_loop *event_loop,
+    struct aws_overlapped *overlapped,
+    int status_code,
+    size_t num_bytes_transferred) {
+
+    (void)event_loop;
+    (void)num_bytes_transferred;
+    struct many_completions_data *data = overlapped->user_data;
+
+    aws_mutex_lock(&data->mutex);
+    size_t index = overlapped - data->overlapped;
+    if (status_code) {
+        data->status_code = status_code;
+    }
+    if (!data->completed[index]) {
+        data->completed[index] = true;
+        ++data->completed_count;
+    }
+    aws_condition_variable_notify_one(&data->condition_variable);
+    aws_mutex_unlock(&data->mutex);
+}
+
+static bool s_many_completions_predicate(void *args) {
+    struct many_completions_data *data = args;
+    return data->completed_count == MANY_COMPLETIONS_PIPE_COUNT;
+}
+
+/* Test that when more operations complete than fit in one tick's completion packet batch, every one of them gets its
+ * callback. The event loop starts with a tiny, adaptive batch so it has to grow it along the way. */
+static int s_test_event_loop_adaptive_completion_packets(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .events_per_tick = 2,
+        .adaptive_events_per_tick = true,
+        .max_events_per_tick = 8,
+    };
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default_with_options(allocator, &options);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct many_completions_data data;
+    AWS_ZERO_STRUCT(data);
+    ASSERT_SUCCESS(aws_mutex_init(&data.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_init(&data.condition_variable));
+
+    struct aws_io_handle read_handle[MANY_COMPLETIONS_PIPE_COUNT];
+    struct aws_io_handle write_handle[MANY_COMPLETIONS_PIPE_COUNT];
+    const char msg[] = "Cherry Pie";
+    for (size_t i = 0; i < MANY_COMPLETIONS_PIPE_COUNT; ++i) {
+        ASSERT_SUCCESS(s_async_pipe_init(&read_handle[i], &write_handle[i]));
+        ASSERT_SUCCESS(aws_event_loop_connect_handle_to_io_completion_port(event_loop, &write_handle[i]));
+
+        aws_overlapped_init(&data.overlapped[i], s_on_many_completions_operation_complete, &data);
+        bool write_success =
+            WriteFile(write_handle[i].data.handle, msg, sizeof(msg), NULL, &data.overlapped[i].overlapped);
+        ASSERT_TRUE(write_success || GetLastError() == ERROR_IO_PENDING);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&data.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&data.condition_variable, &data.mutex, s_many_completions_predicate, &data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&data.mutex));
+
+    ASSERT_INT_EQUALS(0, data.status_code);
+
+    aws_event_loop_destroy(event_loop);
+
+    for (size_t i = 0; i < MANY_COMPLETIONS_PIPE_COUNT; ++i) {
+        s_async_pipe_clean_up(&read_handle[i], &write_handle[i]);
+    }
+    aws_condition_variable_clean_up(&data.condition_variable);
+    aws_mutex_clean_up(&data.mutex);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_adaptive_completion_packets, s_test_event_loop_adaptive_completion_packets)
+
 #else /* !AWS_USE_IO_COMPLETION_PORTS */
 
 #    include <unistd.h>
@@ -565,39 +996,228 @@ static int s_test_event_loop_no_events_after_unsubscribe(struct aws_allocator *a
 
 AWS_TEST_CASE(event_loop_no_events_after_unsubscribe, s_test_event_loop_no_events_after_unsubscribe)
 
-/* For testing logic that must occur on the event-loop thread.
- * The main thread should give the tester an array of state functions (last entry should be NULL),
- * then kick off the tester and then wait for it to be done.
- * Each function should return one of:
- * - AWS_OP_SUCCESS: continue to next state function
- * - AWS_OP_ERRROR: fail the test
- * - REMAIN_IN_STATE: try this state function again next time
- */
-struct thread_tester;
-enum { REMAIN_IN_STATE = -2 };
-typedef int(thread_tester_state_fn)(struct thread_tester *tester);
+enum { MANY_READABLE_MAX_PIPE_COUNT = 64 };
 
-struct thread_tester {
-    struct aws_allocator *alloc;
+struct many_readable_data {
     struct aws_event_loop *event_loop;
-
+    struct aws_io_handle read_handle[MANY_READABLE_MAX_PIPE_COUNT];
+    struct aws_io_handle write_handle[MANY_READABLE_MAX_PIPE_COUNT];
+    bool readable[MANY_READABLE_MAX_PIPE_COUNT];
+    size_t pipe_count;
+    /* also subscribe the write ends for writable events, which are otherwise ignored */
+    bool subscribe_write_ends;
+    size_t readable_count;
     bool done;
-    int error_code;
+    int result_code;
     struct aws_mutex mutex;
     struct aws_condition_variable condition_variable;
+    struct aws_task task;
+};
 
-    thread_tester_state_fn **state_functions;
-    size_t current_state;
-    size_t last_printed_state;
+static void s_many_readable_signal(struct many_readable_data *data, int result_code) {
+    aws_mutex_lock(&data->mutex);
+    data->result_code = result_code;
+    data->done = true;
+    aws_condition_variable_notify_one(&data->condition_variable);
+    aws_mutex_unlock(&data->mutex);
+}
 
-    /* data for tests */
-    struct aws_io_handle read_handle;
-    struct aws_io_handle write_handle;
-    int read_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
-    int write_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
+static void s_many_readable_on_event(
+    struct aws_event_loop *event_loop,
+    struct aws_io_handle *handle,
+    int events,
+    void *user_data) {
 
-    enum { TIMER_NOT_SET, TIMER_WAITING, TIMER_DONE } timer_state;
-    struct aws_task timer_task;
+    (void)event_loop;
+    struct many_readable_data *data = user_data;
+
+    if (events & AWS_IO_EVENT_TYPE_ERROR) {
+        s_many_readable_signal(data, AWS_OP_ERR);
+        return;
+    }
+
+    if (handle >= data->write_handle && handle < data->write_handle + data->pipe_count) {
+        return;
+    }
+
+    if (!(events & AWS_IO_EVENT_TYPE_READABLE)) {
+        return;
+    }
+
+    size_t index = handle - data->read_handle;
+    if (!data->readable[index]) {
+        data->readable[index] = true;
+        if (++data->readable_count == data->pipe_count) {
+            for (size_t i = 0; i < data->pipe_count; ++i) {
+                aws_event_loop_unsubscribe_from_io_events(data->event_loop, &data->read_handle[i]);
+                if (data->subscribe_write_ends) {
+                    aws_event_loop_unsubscribe_from_io_events(data->event_loop, &data->write_handle[i]);
+                }
+            }
+            s_many_readable_signal(data, AWS_OP_SUCCESS);
+        }
+    }
+}
+
+static void s_many_readable_setup_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct many_readable_data *data = arg;
+
+    if (status != AWS_TASK_STATUS_RUN_READY) {
+        s_many_readable_signal(data, AWS_OP_ERR);
+        return;
+    }
+
+    for (size_t i = 0; i < data->pipe_count; ++i) {
+        if (aws_event_loop_subscribe_to_io_events(
+                data->event_loop, &data->read_handle[i], AWS_IO_EVENT_TYPE_READABLE, s_many_readable_on_event, data)) {
+            s_many_readable_signal(data, AWS_OP_ERR);
+            return;
+        }
+        if (data->subscribe_write_ends &&
+            aws_event_loop_subscribe_to_io_events(
+                data->event_loop, &data->write_handle[i], AWS_IO_EVENT_TYPE_WRITABLE, s_many_readable_on_event, data)) {
+            s_many_readable_signal(data, AWS_OP_ERR);
+            return;
+        }
+    }
+}
+
+static bool s_many_readable_predicate(void *arg) {
+    struct many_readable_data *data = arg;
+    return data->done;
+}
+
+/* Test that when more handles are ready than fit in one tick's event batch, every one of them gets its event.
+ * The event loop starts with a tiny, adaptive batch so it has to grow it along the way. */
+static int s_test_event_loop_adaptive_events_per_tick(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop_options options = {
+        .clock = aws_high_res_clock_get_ticks,
+        .events_per_tick = 2,
+        .adaptive_events_per_tick = true,
+        .max_events_per_tick = 8,
+    };
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default_with_options(allocator, &options);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct many_readable_data data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+        .pipe_count = 32,
+    };
+
+    const uint8_t data_to_write[] = "abc";
+    for (size_t i = 0; i < data.pipe_count; ++i) {
+        ASSERT_SUCCESS(simple_pipe_open(&data.read_handle[i], &data.write_handle[i]));
+        ASSERT_UINT_EQUALS(
+            sizeof(data_to_write), simple_pipe_write(&data.write_handle[i], data_to_write, sizeof(data_to_write)));
+    }
+
+    aws_task_init(&data.task, s_many_readable_setup_task, &data, "adaptive_events_per_tick");
+    aws_event_loop_schedule_task_now(event_loop, &data.task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&data.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&data.condition_variable, &data.mutex, s_many_readable_predicate, &data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&data.mutex));
+
+    ASSERT_SUCCESS(data.result_code);
+
+    aws_event_loop_destroy(event_loop);
+
+    for (size_t i = 0; i < data.pipe_count; ++i) {
+        simple_pipe_close(&data.read_handle[i], &data.write_handle[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_adaptive_events_per_tick, s_test_event_loop_adaptive_events_per_tick)
+
+/* Test subscribing and unsubscribing more handles in one go than one tick's event batch holds. The kqueue loop queues
+ * these registrations and submits them with its next wait, or sooner when the queue fills up. */
+static int s_test_event_loop_subscribe_many_at_once(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct many_readable_data data = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .event_loop = event_loop,
+        .pipe_count = MANY_READABLE_MAX_PIPE_COUNT,
+        .subscribe_write_ends = true,
+    };
+
+    const uint8_t data_to_write[] = "abc";
+    for (size_t i = 0; i < data.pipe_count; ++i) {
+        ASSERT_SUCCESS(simple_pipe_open(&data.read_handle[i], &data.write_handle[i]));
+        ASSERT_UINT_EQUALS(
+            sizeof(data_to_write), simple_pipe_write(&data.write_handle[i], data_to_write, sizeof(data_to_write)));
+    }
+
+    aws_task_init(&data.task, s_many_readable_setup_task, &data, "subscribe_many_at_once");
+    aws_event_loop_schedule_task_now(event_loop, &data.task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&data.mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&data.condition_variable, &data.mutex, s_many_readable_predicate, &data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&data.mutex));
+
+    ASSERT_SUCCESS(data.result_code);
+    ASSERT_UINT_EQUALS(data.pipe_count, data.readable_count);
+
+    aws_event_loop_destroy(event_loop);
+
+    for (size_t i = 0; i < data.pipe_count; ++i) {
+        simple_pipe_close(&data.read_handle[i], &data.write_handle[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_subscribe_many_at_once, s_test_event_loop_subscribe_many_at_once)
+
+/* For testing logic that must occur on the event-loop thread.
+ * The main thread should give the tester an array of state functions (last entry should be NULL),
+ * then kick off the tester and then wait for it to be done.
+ * Each function should return one of:
+ * - AWS_OP_SUCCESS: continue to next state function
+ * - AWS_OP_ERRROR: fail the test
+ * - REMAIN_IN_STATE: try this state function again next time
+ */
+struct thread_tester;
+enum { REMAIN_IN_STATE = -2 };
+typedef int(thread_tester_state_fn)(struct thread_tester *tester);
+
+struct thread_tester {
+    struct aws_allocator *alloc;
+    struct aws_event_loop *event_loop;
+
+    bool done;
+    int error_code;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+
+    thread_tester_state_fn **state_functions;
+    size_t current_state;
+    size_t last_printed_state;
+
+    /* data for tests */
+    struct aws_io_handle read_handle;
+    struct aws_io_handle write_handle;
+    int read_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
+    int write_handle_event_counts[AWS_IO_EVENT_TYPE_ERROR + 1];
+
+    enum { TIMER_NOT_SET, TIMER_WAITING, TIMER_DONE } timer_state;
+    struct aws_task timer_task;
 };
 
 static void s_thread_tester_abort(struct thread_tester *tester) {
@@ -681,12 +1301,15 @@ static void s_timer_done_task(struct aws_task *task, void *arg, enum aws_task_st
     s_thread_tester_update(tester);
 }
 
-static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_fn *state_functions[]) {
+static int s_thread_tester_run_on_loop(
+    struct aws_allocator *alloc,
+    struct aws_event_loop *event_loop,
+    thread_tester_state_fn *state_functions[]) {
 
     /* Set up tester */
     struct thread_tester tester = {
         .alloc = alloc,
-        .event_loop = aws_event_loop_new_default(alloc, aws_high_res_clock_get_ticks),
+        .event_loop = event_loop,
         .mutex = AWS_MUTEX_INIT,
         .condition_variable = AWS_CONDITION_VARIABLE_INIT,
         .state_functions = state_functions,
@@ -718,6 +1341,11 @@ static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_
     return tester.error_code;
 }
 
+static int s_thread_tester_run(struct aws_allocator *alloc, thread_tester_state_fn *state_functions[]) {
+    return s_thread_tester_run_on_loop(
+        alloc, aws_event_loop_new_default(alloc, aws_high_res_clock_get_ticks), state_functions);
+}
+
 /* Count how many times each type of event fires on the readable and writable handles */
 static void s_io_event_counter(
     struct aws_event_loop *event_loop,
@@ -963,6 +1591,42 @@ static int s_test_event_loop_readable_event_on_2nd_time_readable(struct aws_allo
 }
 AWS_TEST_CASE(event_loop_readable_event_on_2nd_time_readable, s_test_event_loop_readable_event_on_2nd_time_readable);
 
+#    ifdef AWS_USE_IO_URING
+
+static int s_test_event_loop_io_uring_readable_event_on_2nd_time_readable(
+    struct aws_allocator *allocator,
+    void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_io_uring(allocator, aws_high_res_clock_get_ticks);
+    if (!event_loop && aws_last_error() == AWS_ERROR_PLATFORM_NOT_SUPPORTED) {
+        /* kernel is too old for io_uring, or doesn't allow it here, nothing to test */
+        return AWS_OP_SUCCESS;
+    }
+
+    thread_tester_state_fn *state_functions[] = {
+        s_state_subscribe,
+        s_state_on_writable,
+        s_state_write_data,
+        s_state_on_readable,
+        s_state_read_until_blocked,
+        s_state_write_data,
+        s_state_on_readable,
+        s_state_wait_1sec,
+        s_state_fail_if_more_readable_events,
+        s_state_unsubscribe,
+        NULL,
+    };
+
+    ASSERT_SUCCESS(s_thread_tester_run_on_loop(allocator, event_loop, state_functions));
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(
+    event_loop_io_uring_readable_event_on_2nd_time_readable,
+    s_test_event_loop_io_uring_readable_event_on_2nd_time_readable);
+
+#    endif /* AWS_USE_IO_URING */
+
 #endif /* AWS_USE_IO_COMPLETION_PORTS */
 
 static int s_event_loop_test_stop_then_restart(struct aws_allocator *allocator, void *ctx) {
@@ -1064,6 +1728,306 @@ static int test_event_loop_group_setup_and_shutdown(struct aws_allocator *alloca
 
 AWS_TEST_CASE(event_loop_group_setup_and_shutdown, test_event_loop_group_setup_and_shutdown)
 
+static int test_event_loop_group_pinned_setup_and_shutdown(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *event_loop_group =
+        aws_event_loop_group_new_default_pinned_to_cpu_group(allocator, 0, 0, NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+
+    size_t el_count = aws_event_loop_group_get_loop_count(event_loop_group);
+    ASSERT_TRUE(el_count > 0);
+    ASSERT_TRUE(el_count <= aws_get_cpu_count_for_group(0));
+
+    aws_event_loop_group_release(event_loop_group);
+
+    int32_t cpu_ids[] = {0, 0};
+    event_loop_group =
+        aws_event_loop_group_new_default_pinned_to_cpus(allocator, cpu_ids, AWS_ARRAY_SIZE(cpu_ids), NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+    ASSERT_UINT_EQUALS(AWS_ARRAY_SIZE(cpu_ids), aws_event_loop_group_get_loop_count(event_loop_group));
+
+    /* make sure the pinned loops actually run tasks */
+    struct aws_event_loop *event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+    struct task_args task_args = {.condition_variable = AWS_CONDITION_VARIABLE_INIT,
+                                  .mutex = AWS_MUTEX_INIT,
+                                  .invoked = false,
+                                  .was_in_thread = false,
+                                  .status = -1,
+                                  .loop = event_loop,
+                                  .thread_id = 0};
+
+    struct aws_task task;
+    aws_task_init(&task, s_test_task, &task_args, "pinned_loop_task");
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+    ASSERT_TRUE(task_args.was_in_thread);
+    aws_mutex_unlock(&task_args.mutex);
+
+    aws_event_loop_group_release(event_loop_group);
+
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_pinned_setup_and_shutdown, test_event_loop_group_pinned_setup_and_shutdown)
+
+static void s_busy_task(struct aws_task *task, void *user_data, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct task_args *args = user_data;
+
+    /* make this tick measurably long */
+    aws_thread_current_sleep(10 * 1000 * 1000);
+
+    aws_mutex_lock(&args->mutex);
+    args->invoked = true;
+    aws_mutex_unlock(&args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+/*
+ * Test that a tick running a slow task is reflected in the loop's load metrics.
+ */
+static int s_test_event_loop_load_metrics(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_event_loop_load_metrics metrics;
+    aws_event_loop_get_load_metrics(event_loop, &metrics);
+    ASSERT_UINT_EQUALS(0, metrics.subscribed_handle_count);
+
+    struct task_args task_args = {.condition_variable = AWS_CONDITION_VARIABLE_INIT,
+                                  .mutex = AWS_MUTEX_INIT,
+                                  .invoked = false,
+                                  .was_in_thread = false,
+                                  .status = -1,
+                                  .loop = event_loop,
+                                  .thread_id = 0};
+
+    struct aws_task task;
+    aws_task_init(&task, s_busy_task, &task_args, "load_metrics_busy_task");
+
+    ASSERT_SUCCESS(aws_mutex_lock(&task_args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &task_args.condition_variable, &task_args.mutex, s_task_ran_predicate, &task_args));
+    aws_mutex_unlock(&task_args.mutex);
+
+    /* the tick is recorded right after the task returns, give the event-thread a moment to get there */
+    uint64_t busy_threshold_ns = 10 * 1000 * 1000;
+    for (int i = 0; i < 100; ++i) {
+        aws_event_loop_get_load_metrics(event_loop, &metrics);
+        if (metrics.last_tick_duration_ns >= busy_threshold_ns) {
+            break;
+        }
+        aws_thread_current_sleep(10 * 1000 * 1000);
+    }
+
+    ASSERT_TRUE(metrics.last_tick_duration_ns >= busy_threshold_ns);
+
+    aws_event_loop_destroy(event_loop);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_load_metrics, s_test_event_loop_load_metrics)
+
+struct local_slot_test_data {
+    struct aws_event_loop *event_loop;
+    struct aws_event_loop_local_object object;
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool empty_before_set;
+    bool found_after_set;
+    bool task_done;
+    int removed_count;
+};
+
+static void s_local_slot_object_removed(struct aws_event_loop_local_object *object) {
+    struct local_slot_test_data *data = object->object;
+    data->removed_count++;
+}
+
+static void s_local_slot_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct local_slot_test_data *data = arg;
+
+    data->empty_before_set =
+        aws_event_loop_get_local_slot(data->event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL) == NULL;
+    aws_event_loop_set_local_slot(data->event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL, &data->object);
+    data->found_after_set =
+        aws_event_loop_get_local_slot(data->event_loop, AWS_EVENT_LOOP_LOCAL_SLOT_MESSAGE_POOL) == &data->object;
+
+    aws_mutex_lock(&data->mutex);
+    data->task_done = true;
+    aws_condition_variable_notify_one(&data->condition_variable);
+    aws_mutex_unlock(&data->mutex);
+}
+
+static bool s_local_slot_task_done(void *arg) {
+    struct local_slot_test_data *data = arg;
+    return data->task_done;
+}
+
+/* Test that an object put in a reserved local slot is found there, and is removed when the event loop is destroyed. */
+static int s_test_event_loop_local_slots(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct local_slot_test_data data = {
+        .event_loop = event_loop,
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    data.object.object = &data;
+    data.object.on_object_removed = s_local_slot_object_removed;
+
+    struct aws_task task;
+    aws_task_init(&task, s_local_slot_task, &data, "local_slot_task");
+
+    ASSERT_SUCCESS(aws_mutex_lock(&data.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&data.condition_variable, &data.mutex, s_local_slot_task_done, &data));
+    ASSERT_SUCCESS(aws_mutex_unlock(&data.mutex));
+
+    ASSERT_TRUE(data.empty_before_set);
+    ASSERT_TRUE(data.found_after_set);
+    ASSERT_INT_EQUALS(0, data.removed_count);
+
+    aws_event_loop_destroy(event_loop);
+
+    ASSERT_INT_EQUALS(1, data.removed_count);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_local_slots, s_test_event_loop_local_slots)
+
+/*
+ * Test that every selection policy hands out loops belonging to the group, and that power-of-two-choices reaches
+ * every loop when they are all idle.
+ */
+static int s_test_event_loop_group_selection_policy(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    aws_io_library_init(allocator);
+
+    enum { LOOP_COUNT = 4 };
+    struct aws_event_loop_group *event_loop_group = aws_event_loop_group_new_default(allocator, LOOP_COUNT, NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+
+    enum aws_event_loop_selection_policy policies[] = {
+        AWS_EVENT_LOOP_SELECTION_ROUND_ROBIN,
+        AWS_EVENT_LOOP_SELECTION_POWER_OF_TWO_CHOICES,
+        AWS_EVENT_LOOP_SELECTION_LEAST_LOADED,
+    };
+
+    for (size_t policy_index = 0; policy_index < AWS_ARRAY_SIZE(policies); ++policy_index) {
+        aws_event_loop_group_set_selection_policy(event_loop_group, policies[policy_index]);
+
+        bool seen[LOOP_COUNT] = {false};
+        for (int i = 0; i < 1000; ++i) {
+            struct aws_event_loop *event_loop = aws_event_loop_group_get_next_loop(event_loop_group);
+            ASSERT_NOT_NULL(event_loop);
+
+            bool found = false;
+            for (size_t loop_index = 0; loop_index < LOOP_COUNT; ++loop_index) {
+                if (aws_event_loop_group_get_loop_at(event_loop_group, loop_index) == event_loop) {
+                    seen[loop_index] = true;
+                    found = true;
+                }
+            }
+            ASSERT_TRUE(found);
+        }
+
+        if (policies[policy_index] != AWS_EVENT_LOOP_SELECTION_LEAST_LOADED) {
+            for (size_t loop_index = 0; loop_index < LOOP_COUNT; ++loop_index) {
+                ASSERT_TRUE(seen[loop_index]);
+            }
+        }
+    }
+
+    aws_event_loop_group_release(event_loop_group);
+
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_selection_policy, s_test_event_loop_group_selection_policy)
+
+static int s_test_event_loop_group_lazy(struct aws_allocator *allocator, void *ctx) {
+
+    (void)ctx;
+    aws_io_library_init(allocator);
+
+    enum { LOOP_COUNT = 3 };
+    struct aws_event_loop_group *event_loop_group = aws_event_loop_group_new_default_lazy(allocator, LOOP_COUNT, NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+    ASSERT_UINT_EQUALS(LOOP_COUNT, aws_event_loop_group_get_loop_count(event_loop_group));
+    ASSERT_UINT_EQUALS(0, aws_event_loop_group_get_started_loop_count(event_loop_group));
+
+    /* each ask starts one more loop, until they all run */
+    struct aws_event_loop *loops[LOOP_COUNT];
+    for (size_t i = 0; i < LOOP_COUNT; ++i) {
+        loops[i] = aws_event_loop_group_get_next_loop(event_loop_group);
+        ASSERT_NOT_NULL(loops[i]);
+        ASSERT_UINT_EQUALS(i + 1, aws_event_loop_group_get_started_loop_count(event_loop_group));
+        ASSERT_PTR_EQUALS(loops[i], aws_event_loop_group_get_loop_at(event_loop_group, i));
+        for (size_t j = 0; j < i; ++j) {
+            ASSERT_FALSE(loops[i] == loops[j]);
+        }
+    }
+
+    /* then it goes back to sharing them out */
+    for (size_t i = 0; i < 2 * LOOP_COUNT; ++i) {
+        ASSERT_NOT_NULL(aws_event_loop_group_get_next_loop(event_loop_group));
+    }
+    ASSERT_UINT_EQUALS(LOOP_COUNT, aws_event_loop_group_get_started_loop_count(event_loop_group));
+    ASSERT_NULL(aws_event_loop_group_get_loop_at(event_loop_group, LOOP_COUNT));
+
+    aws_event_loop_group_release(event_loop_group);
+
+    /* asking for a loop by index starts the ones before it too, and a group never used starts none */
+    event_loop_group = aws_event_loop_group_new_default_lazy(allocator, LOOP_COUNT, NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+    ASSERT_NOT_NULL(aws_event_loop_group_get_loop_at(event_loop_group, 1));
+    ASSERT_UINT_EQUALS(2, aws_event_loop_group_get_started_loop_count(event_loop_group));
+    aws_event_loop_group_release(event_loop_group);
+
+    event_loop_group = aws_event_loop_group_new_default_lazy(allocator, LOOP_COUNT, NULL);
+    ASSERT_NOT_NULL(event_loop_group);
+    aws_event_loop_group_release(event_loop_group);
+
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(event_loop_group_lazy, s_test_event_loop_group_lazy)
+
 static void s_async_shutdown_complete_callback(void *user_data) {
 
     struct task_args *args = user_data;
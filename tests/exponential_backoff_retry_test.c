@@ -274,3 +274,102 @@ static int s_test_exponential_backoff_retry_invalid_options_fn(struct aws_alloca
     return AWS_OP_SUCCESS;
 }
 AWS_TEST_CASE(test_exponential_backoff_retry_invalid_options, s_test_exponential_backoff_retry_invalid_options_fn)
+
+struct exponential_backoff_reuse_test_data {
+    struct aws_retry_token *token;
+    struct aws_mutex mutex;
+    struct aws_condition_variable cvar;
+};
+
+static void s_reuse_test_token_acquired(
+    struct aws_retry_strategy *retry_strategy,
+    int error_code,
+    struct aws_retry_token *token,
+    void *user_data) {
+    (void)retry_strategy;
+    (void)error_code;
+
+    struct exponential_backoff_reuse_test_data *test_data = user_data;
+    aws_mutex_lock(&test_data->mutex);
+    test_data->token = token;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_all(&test_data->cvar);
+}
+
+static bool s_reuse_test_token_acquired_pred(void *arg) {
+    struct exponential_backoff_reuse_test_data *test_data = arg;
+    return test_data->token != NULL;
+}
+
+static int s_reuse_test_acquire_token(
+    struct aws_retry_strategy *retry_strategy,
+    struct exponential_backoff_reuse_test_data *test_data) {
+    test_data->token = NULL;
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data->mutex));
+    ASSERT_SUCCESS(
+        aws_retry_strategy_acquire_retry_token(retry_strategy, NULL, s_reuse_test_token_acquired, test_data, 0));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &test_data->cvar, &test_data->mutex, s_reuse_test_token_acquired_pred, test_data));
+    aws_mutex_unlock(&test_data->mutex);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that released tokens are handed out again, and that a reused token starts over with a full retry budget. */
+static int s_test_exponential_backoff_retry_token_reuse_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_exponential_backoff_retry_options config = {
+        .max_retries = 3,
+        .el_group = el_group,
+    };
+
+    struct aws_retry_strategy *retry_strategy = aws_retry_strategy_new_exponential_backoff(allocator, &config);
+    ASSERT_NOT_NULL(retry_strategy);
+
+    struct exponential_backoff_reuse_test_data reuse_data = {
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(s_reuse_test_acquire_token(retry_strategy, &reuse_data));
+    struct aws_retry_token *first_token = reuse_data.token;
+    ASSERT_SUCCESS(aws_retry_strategy_token_record_success(first_token));
+    aws_retry_strategy_release_retry_token(first_token);
+
+    ASSERT_SUCCESS(s_reuse_test_acquire_token(retry_strategy, &reuse_data));
+    ASSERT_PTR_EQUALS(first_token, reuse_data.token);
+    aws_retry_strategy_release_retry_token(reuse_data.token);
+
+    /* a token that has been retried to exhaustion doesn't carry its retry count over */
+    for (size_t i = 0; i < 2; ++i) {
+        struct exponential_backoff_test_data test_data = {
+            .retry_count = 0,
+            .failure_error_code = 0,
+            .mutex = AWS_MUTEX_INIT,
+            .cvar = AWS_CONDITION_VARIABLE_INIT,
+        };
+
+        ASSERT_SUCCESS(aws_mutex_lock(&test_data.mutex));
+        ASSERT_SUCCESS(aws_retry_strategy_acquire_retry_token(
+            retry_strategy, NULL, s_too_many_retries_test_token_acquired, &test_data, 0));
+        ASSERT_SUCCESS(
+            aws_condition_variable_wait_pred(&test_data.cvar, &test_data.mutex, s_retry_has_failed, &test_data));
+        aws_mutex_unlock(&test_data.mutex);
+
+        ASSERT_UINT_EQUALS(config.max_retries, test_data.retry_count);
+        ASSERT_UINT_EQUALS(AWS_IO_MAX_RETRIES_EXCEEDED, test_data.failure_error_code);
+    }
+
+    aws_retry_strategy_release(retry_strategy);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(test_exponential_backoff_retry_token_reuse, s_test_exponential_backoff_retry_token_reuse_fn)
@@ -9,6 +9,13 @@
 
 #include <aws/common/string.h>
 
+#include <stdio.h>
+#include <string.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4996) /* fopen */
+#endif
+
 static int s_test_home_directory_not_null(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
@@ -21,3 +28,124 @@ static int s_test_home_directory_not_null(struct aws_allocator *allocator, void
 }
 
 AWS_TEST_CASE(test_home_directory_not_null, s_test_home_directory_not_null);
+
+static int s_write_test_file(const char *file_name, const char *contents) {
+    FILE *file = fopen(file_name, "wb");
+    ASSERT_NOT_NULL(file);
+    size_t length = strlen(contents);
+    ASSERT_UINT_EQUALS(length, fwrite(contents, 1, length, file));
+    fclose(file);
+
+    return AWS_OP_SUCCESS;
+}
+
+static const char *s_bulk_read_file_names[] = {
+    "bulk_read_test_0.txt",
+    "bulk_read_test_1.txt",
+    "bulk_read_test_empty.txt",
+    "bulk_read_test_missing.txt",
+};
+
+static const char *s_bulk_read_contents[] = {
+    "first file",
+    "the second file, a little longer than the first",
+    "",
+};
+
+static int s_test_byte_bufs_init_from_files(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_bulk_read_contents); ++i) {
+        ASSERT_SUCCESS(s_write_test_file(s_bulk_read_file_names[i], s_bulk_read_contents[i]));
+    }
+
+    /* everything but the missing file */
+    size_t count = AWS_ARRAY_SIZE(s_bulk_read_contents);
+    struct aws_byte_buf bufs[AWS_ARRAY_SIZE(s_bulk_read_file_names)];
+    int error_codes[AWS_ARRAY_SIZE(s_bulk_read_file_names)];
+    ASSERT_SUCCESS(aws_byte_bufs_init_from_files(allocator, s_bulk_read_file_names, count, 2, bufs, error_codes));
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, error_codes[i]);
+        ASSERT_BIN_ARRAYS_EQUALS(s_bulk_read_contents[i], strlen(s_bulk_read_contents[i]), bufs[i].buffer, bufs[i].len);
+        /* null terminated, like aws_byte_buf_init_from_file() */
+        ASSERT_UINT_EQUALS(0, bufs[i].buffer[bufs[i].len]);
+        aws_byte_buf_clean_up(&bufs[i]);
+    }
+
+    /* one missing file fails the call, but the others are still read */
+    count = AWS_ARRAY_SIZE(s_bulk_read_file_names);
+    ASSERT_FAILS(aws_byte_bufs_init_from_files(allocator, s_bulk_read_file_names, count, 0, bufs, error_codes));
+    ASSERT_INT_EQUALS(error_codes[count - 1], aws_last_error());
+    ASSERT_FALSE(error_codes[count - 1] == AWS_ERROR_SUCCESS);
+    ASSERT_NULL(bufs[count - 1].buffer);
+    for (size_t i = 0; i < count - 1; ++i) {
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, error_codes[i]);
+        ASSERT_UINT_EQUALS(strlen(s_bulk_read_contents[i]), bufs[i].len);
+        aws_byte_buf_clean_up(&bufs[i]);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(s_bulk_read_contents); ++i) {
+        remove(s_bulk_read_file_names[i]);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_byte_bufs_init_from_files, s_test_byte_bufs_init_from_files);
+
+struct directory_scan {
+    struct aws_byte_cursor wanted_name;
+    size_t entries_seen;
+    bool found;
+    bool found_as_file;
+    bool path_matches;
+    size_t stop_after;
+};
+
+static bool s_on_directory_entry(const struct aws_directory_entry *entry, void *user_data) {
+    struct directory_scan *scan = user_data;
+    ++scan->entries_seen;
+
+    if (aws_byte_cursor_eq(&entry->name, &scan->wanted_name)) {
+        scan->found = true;
+        scan->found_as_file = entry->is_file && !entry->is_directory;
+
+        /* "." followed by a separator and the name */
+        scan->path_matches = entry->path.len == entry->name.len + 2 && entry->path.ptr[0] == '.' &&
+                             aws_is_any_directory_separator((char)entry->path.ptr[1]) &&
+                             !memcmp(entry->path.ptr + 2, entry->name.ptr, entry->name.len);
+    }
+
+    return scan->entries_seen != scan->stop_after;
+}
+
+static int s_test_directory_for_each_entry(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    ASSERT_SUCCESS(s_write_test_file(s_bulk_read_file_names[0], s_bulk_read_contents[0]));
+
+    struct directory_scan scan = {
+        .wanted_name = aws_byte_cursor_from_c_str(s_bulk_read_file_names[0]),
+    };
+    ASSERT_SUCCESS(aws_directory_for_each_entry(allocator, ".", s_on_directory_entry, &scan));
+    ASSERT_TRUE(scan.found);
+    ASSERT_TRUE(scan.found_as_file);
+    ASSERT_TRUE(scan.path_matches);
+    ASSERT_TRUE(scan.entries_seen >= 1);
+
+    /* returning false stops right there, and isn't an error */
+    struct directory_scan stopped = {
+        .wanted_name = scan.wanted_name,
+        .stop_after = 1,
+    };
+    ASSERT_SUCCESS(aws_directory_for_each_entry(allocator, ".", s_on_directory_entry, &stopped));
+    ASSERT_UINT_EQUALS(1, stopped.entries_seen);
+
+    ASSERT_FAILS(aws_directory_for_each_entry(allocator, "no_such_directory", s_on_directory_entry, &scan));
+
+    remove(s_bulk_read_file_names[0]);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_directory_for_each_entry, s_test_directory_for_each_entry);
@@ -0,0 +1,93 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/statistics.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/condition_variable.h>
+#include <aws/common/mutex.h>
+#include <aws/io/event_loop.h>
+#include <aws/testing/aws_test_harness.h>
+
+struct metrics_task_args {
+    struct aws_mutex mutex;
+    struct aws_condition_variable condition_variable;
+    bool invoked;
+};
+
+static void s_count_on_loop_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct metrics_task_args *args = arg;
+
+    aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, 10);
+    aws_io_metrics_add(AWS_IO_METRIC_OPEN_CHANNELS, -1);
+
+    aws_mutex_lock(&args->mutex);
+    args->invoked = true;
+    aws_mutex_unlock(&args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static bool s_task_invoked(void *arg) {
+    struct metrics_task_args *args = arg;
+    return args->invoked;
+}
+
+/* Test that counts made on and off event loops add up, and outlive the loop that made them. */
+static int s_test_io_metrics_snapshot_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_io_metrics_snapshot before;
+    aws_io_metrics_snapshot(&before);
+
+    /* off by default */
+    ASSERT_FALSE(aws_io_metrics_is_enabled());
+    aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, 1000);
+
+    aws_io_metrics_set_enabled(true);
+    ASSERT_TRUE(aws_io_metrics_is_enabled());
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop);
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    /* off any loop, then on one */
+    aws_io_metrics_add(AWS_IO_METRIC_BYTES_READ, 5);
+    aws_io_metrics_add(AWS_IO_METRIC_OPEN_CHANNELS, 1);
+
+    struct metrics_task_args args = {
+        .mutex = AWS_MUTEX_INIT,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    struct aws_task task;
+    aws_task_init(&task, s_count_on_loop_task, &args, "io_metrics_count_on_loop");
+
+    ASSERT_SUCCESS(aws_mutex_lock(&args.mutex));
+    aws_event_loop_schedule_task_now(event_loop, &task);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&args.condition_variable, &args.mutex, s_task_invoked, &args));
+    aws_mutex_unlock(&args.mutex);
+
+    struct aws_io_metrics_snapshot during;
+    aws_io_metrics_snapshot(&during);
+    ASSERT_UINT_EQUALS(15, during.values[AWS_IO_METRIC_BYTES_READ] - before.values[AWS_IO_METRIC_BYTES_READ]);
+    ASSERT_UINT_EQUALS(0, during.values[AWS_IO_METRIC_OPEN_CHANNELS] - before.values[AWS_IO_METRIC_OPEN_CHANNELS]);
+
+    aws_event_loop_destroy(event_loop);
+
+    struct aws_io_metrics_snapshot after;
+    aws_io_metrics_snapshot(&after);
+    ASSERT_UINT_EQUALS(15, after.values[AWS_IO_METRIC_BYTES_READ] - before.values[AWS_IO_METRIC_BYTES_READ]);
+    ASSERT_UINT_EQUALS(0, after.values[AWS_IO_METRIC_OPEN_CHANNELS] - before.values[AWS_IO_METRIC_OPEN_CHANNELS]);
+
+    aws_io_metrics_set_enabled(false);
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_io_metrics_snapshot, s_test_io_metrics_snapshot_fn)
@@ -49,3 +49,169 @@ static int s_test_io_testing_channel(struct aws_allocator *allocator, void *ctx)
 }
 
 AWS_TEST_CASE(io_testing_channel, s_test_io_testing_channel)
+
+static uint64_t s_window_update_fake_now_ns = 0;
+
+static int s_window_update_fake_clock(uint64_t *timestamp) {
+    *timestamp = s_window_update_fake_now_ns;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_io_testing_channel_window_update_interval(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_window_update_fake_now_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    struct aws_testing_channel_options test_channel_options = {.clock_fn = s_window_update_fake_clock};
+
+    struct testing_channel testing_channel;
+    ASSERT_SUCCESS(testing_channel_init(&testing_channel, allocator, &test_channel_options));
+    ASSERT_SUCCESS(testing_channel_install_downstream_handler(&testing_channel, 16 * 1024));
+    testing_channel_drain_queued_tasks(&testing_channel);
+
+    /* at most one update per millisecond */
+    aws_channel_set_window_update_policy(testing_channel.channel, 0, 1000);
+
+    /* nothing went out recently, so the first update is immediate */
+    ASSERT_SUCCESS(testing_channel_increment_read_window(&testing_channel, 100));
+    testing_channel_drain_queued_tasks(&testing_channel);
+    ASSERT_UINT_EQUALS(100, testing_channel_last_window_update(&testing_channel));
+
+    /* the next ones are held back and merged */
+    ASSERT_SUCCESS(testing_channel_increment_read_window(&testing_channel, 200));
+    testing_channel_drain_queued_tasks(&testing_channel);
+    ASSERT_SUCCESS(testing_channel_increment_read_window(&testing_channel, 300));
+    testing_channel_drain_queued_tasks(&testing_channel);
+    ASSERT_UINT_EQUALS(100, testing_channel_last_window_update(&testing_channel));
+
+    s_window_update_fake_now_ns += aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    testing_channel_drain_queued_tasks(&testing_channel);
+    ASSERT_UINT_EQUALS(500, testing_channel_last_window_update(&testing_channel));
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing_channel));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_window_update_interval, s_test_io_testing_channel_window_update_interval)
+
+struct virtual_clock_task {
+    struct aws_channel_task task;
+    uint64_t ran_at_ns;
+};
+
+static void s_virtual_clock_task_fn(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct virtual_clock_task *clock_task = arg;
+    clock_task->ran_at_ns = testing_virtual_clock_now();
+}
+
+static int s_test_io_testing_channel_virtual_clock(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint64_t start_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t ms = aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    testing_virtual_clock_set(start_ns);
+    struct aws_testing_channel_options test_channel_options = {.clock_fn = testing_virtual_clock_get_ticks};
+
+    struct testing_channel testing_channel;
+    ASSERT_SUCCESS(testing_channel_init(&testing_channel, allocator, &test_channel_options));
+    struct testing_channel *channels[] = {&testing_channel};
+
+    struct virtual_clock_task later = {.ran_at_ns = 0};
+    struct virtual_clock_task sooner = {.ran_at_ns = 0};
+    aws_channel_task_init(&later.task, s_virtual_clock_task_fn, &later, "virtual_clock_later");
+    aws_channel_task_init(&sooner.task, s_virtual_clock_task_fn, &sooner, "virtual_clock_sooner");
+    aws_channel_schedule_task_future(testing_channel.channel, &later.task, start_ns + 5 * ms);
+    aws_channel_schedule_task_future(testing_channel.channel, &sooner.task, start_ns + 2 * ms);
+
+    /* each task runs at exactly its own time, and the clock stops where it was told to */
+    testing_channels_run_until(channels, 1, start_ns + 3 * ms);
+    ASSERT_UINT_EQUALS(start_ns + 2 * ms, sooner.ran_at_ns);
+    ASSERT_UINT_EQUALS(0, later.ran_at_ns);
+    ASSERT_UINT_EQUALS(start_ns + 3 * ms, testing_virtual_clock_now());
+
+    ASSERT_UINT_EQUALS(2 * ms, testing_channels_run_until_idle(channels, 1));
+    ASSERT_UINT_EQUALS(start_ns + 5 * ms, later.ran_at_ns);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&testing_channel));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_virtual_clock, s_test_io_testing_channel_virtual_clock)
+
+static uint64_t s_link_write_completed_at_ns[2];
+static size_t s_link_writes_completed = 0;
+
+static void s_link_on_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+    (void)err_code;
+    (void)user_data;
+    s_link_write_completed_at_ns[s_link_writes_completed++] = testing_virtual_clock_now();
+}
+
+static int s_test_io_testing_channel_link_shaping(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    uint64_t start_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    uint64_t ms = aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    testing_virtual_clock_set(start_ns);
+    s_link_writes_completed = 0;
+    struct aws_testing_channel_options test_channel_options = {.clock_fn = testing_virtual_clock_get_ticks};
+
+    struct testing_channel client;
+    struct testing_channel server;
+    ASSERT_SUCCESS(testing_channel_init(&client, allocator, &test_channel_options));
+    ASSERT_SUCCESS(testing_channel_init(&server, allocator, &test_channel_options));
+    ASSERT_SUCCESS(testing_channel_install_downstream_handler(&client, 16 * 1024));
+    ASSERT_SUCCESS(testing_channel_install_downstream_handler(&server, 16 * 1024));
+    struct testing_channel *channels[] = {&client, &server};
+
+    /* 1000 bytes take 1ms to send at 1MB/s, then 10ms to arrive */
+    struct testing_link_options link_options = {
+        .bytes_per_second = 1000 * 1000,
+        .latency_ns = 10 * ms,
+    };
+    testing_channel_connect(&client, &server, &link_options);
+    testing_channel_connect(&server, &client, &link_options);
+
+    for (size_t i = 0; i < 2; ++i) {
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(client.channel, AWS_IO_MESSAGE_APPLICATION_DATA, 1000);
+        ASSERT_NOT_NULL(message);
+        message->message_data.len = 1000;
+        message->on_completion = s_link_on_write_completed;
+        ASSERT_SUCCESS(testing_channel_push_write_message(&client, message));
+    }
+
+    /* the writes are sent one after the other, and nothing shows up in the written message queue */
+    testing_channels_run_until(channels, 2, start_ns + 3 * ms);
+    ASSERT_UINT_EQUALS(2, s_link_writes_completed);
+    ASSERT_UINT_EQUALS(start_ns + 1 * ms, s_link_write_completed_at_ns[0]);
+    ASSERT_UINT_EQUALS(start_ns + 2 * ms, s_link_write_completed_at_ns[1]);
+    ASSERT_TRUE(aws_linked_list_empty(testing_channel_get_written_message_queue(&client)));
+    ASSERT_TRUE(aws_linked_list_empty(testing_channel_get_read_message_queue(&server)));
+
+    testing_channels_run_until(channels, 2, start_ns + 11 * ms);
+    ASSERT_UINT_EQUALS(1000, testing_channel_link_bytes_delivered(&server));
+
+    ASSERT_UINT_EQUALS(1 * ms, testing_channels_run_until_idle(channels, 2));
+    ASSERT_UINT_EQUALS(2000, testing_channel_link_bytes_sent(&client));
+    ASSERT_UINT_EQUALS(2000, testing_channel_link_bytes_delivered(&server));
+
+    struct aws_byte_buf received;
+    ASSERT_SUCCESS(aws_byte_buf_init(&received, allocator, 2000));
+    ASSERT_SUCCESS(testing_channel_drain_messages(testing_channel_get_read_message_queue(&server), &received));
+    ASSERT_UINT_EQUALS(2000, received.len);
+    aws_byte_buf_clean_up(&received);
+
+    ASSERT_SUCCESS(testing_channel_clean_up(&client));
+    ASSERT_SUCCESS(testing_channel_clean_up(&server));
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(io_testing_channel_link_shaping, s_test_io_testing_channel_link_shaping)
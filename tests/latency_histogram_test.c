@@ -0,0 +1,98 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/statistics.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+static int s_test_latency_histogram_buckets_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    /* buckets are contiguous, and no wider than 1/8 of where they start past the exact ones */
+    uint64_t previous_upper_ns = 0;
+    for (size_t i = 0; i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT; ++i) {
+        uint64_t lower_ns = 0;
+        uint64_t upper_ns = 0;
+        aws_latency_histogram_get_bucket_range_ns(i, &lower_ns, &upper_ns);
+
+        ASSERT_UINT_EQUALS(previous_upper_ns, lower_ns);
+        ASSERT_TRUE(upper_ns > lower_ns);
+        if (i >= 8 && i < AWS_LATENCY_HISTOGRAM_BUCKET_COUNT - 1) {
+            ASSERT_TRUE((upper_ns - lower_ns) * 8 <= lower_ns);
+        }
+        previous_upper_ns = upper_ns;
+    }
+    ASSERT_UINT_EQUALS(UINT64_MAX, previous_upper_ns);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_latency_histogram_buckets, s_test_latency_histogram_buckets_fn)
+
+static int s_test_latency_histogram_percentiles_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_latency_histogram histogram;
+    AWS_ZERO_STRUCT(histogram);
+
+    ASSERT_UINT_EQUALS(0, aws_latency_histogram_get_count(&histogram));
+    ASSERT_UINT_EQUALS(0, aws_latency_histogram_get_percentile_ns(&histogram, 50.0));
+
+    /* 1ms to 100ms */
+    for (uint64_t i = 1; i <= 100; ++i) {
+        aws_latency_histogram_record_ns(&histogram, i * 1000000);
+    }
+    /* and one off the end */
+    aws_latency_histogram_record_ns(&histogram, UINT64_MAX);
+
+    ASSERT_UINT_EQUALS(101, aws_latency_histogram_get_count(&histogram));
+
+    uint64_t p50_ns = aws_latency_histogram_get_percentile_ns(&histogram, 50.0);
+    ASSERT_TRUE(p50_ns >= 51000000 && p50_ns <= 51000000 + 51000000 / 8);
+
+    uint64_t p0_ns = aws_latency_histogram_get_percentile_ns(&histogram, 0.0);
+    ASSERT_TRUE(p0_ns > 1000000 && p0_ns <= 1000000 + 1000000 / 8);
+
+    ASSERT_UINT_EQUALS(UINT64_MAX, aws_latency_histogram_get_percentile_ns(&histogram, 100.0));
+
+    aws_latency_histogram_reset(&histogram);
+    ASSERT_UINT_EQUALS(0, aws_latency_histogram_get_count(&histogram));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_latency_histogram_percentiles, s_test_latency_histogram_percentiles_fn)
+
+static int s_test_latency_histogram_merge_and_take_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_latency_histogram loop_histograms[2];
+    AWS_ZERO_ARRAY(loop_histograms);
+    struct aws_latency_histogram total;
+    AWS_ZERO_STRUCT(total);
+
+    aws_latency_histogram_record_ns(&loop_histograms[0], 2000);
+    aws_latency_histogram_record_ns(&loop_histograms[0], 3000000);
+    aws_latency_histogram_record_ns(&loop_histograms[1], 3000000);
+
+    aws_latency_histogram_merge(&total, &loop_histograms[0]);
+    ASSERT_UINT_EQUALS(2, aws_latency_histogram_get_count(&total));
+    ASSERT_UINT_EQUALS(2, aws_latency_histogram_get_count(&loop_histograms[0]));
+
+    aws_latency_histogram_take(&total, &loop_histograms[1]);
+    ASSERT_UINT_EQUALS(3, aws_latency_histogram_get_count(&total));
+    ASSERT_UINT_EQUALS(0, aws_latency_histogram_get_count(&loop_histograms[1]));
+
+    /* two of the three are 3ms */
+    uint64_t p50_ns = aws_latency_histogram_get_percentile_ns(&total, 50.0);
+    ASSERT_TRUE(p50_ns > 3000000 && p50_ns <= 3000000 + 3000000 / 8);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_latency_histogram_merge_and_take, s_test_latency_histogram_merge_and_take_fn)
@@ -0,0 +1,312 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+
+#include <aws/io/message_pool.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#if _MSC_VER
+#    pragma warning(disable : 4204) /* non-constant aggregate initializer */
+#endif
+
+static int s_test_memory_pool_fixed_size(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_memory_pool mempool;
+    ASSERT_SUCCESS(aws_memory_pool_init(&mempool, allocator, 2, 64));
+
+    void *segments[4];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&mempool);
+        ASSERT_NOT_NULL(segments[i]);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&mempool, segments[i]);
+    }
+
+    /* without a max, the pool never retains more than it was created with */
+    ASSERT_UINT_EQUALS(2, mempool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(2, aws_array_list_length(&mempool.stack));
+
+    aws_memory_pool_clean_up(&mempool);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_fixed_size, s_test_memory_pool_fixed_size)
+
+static int s_test_memory_pool_grows_to_high_water_mark(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_memory_pool mempool;
+    ASSERT_SUCCESS(aws_memory_pool_init(&mempool, allocator, 2, 64));
+    mempool.max_segment_count = 8;
+
+    void *segments[12];
+    for (size_t i = 0; i < 6; ++i) {
+        segments[i] = aws_memory_pool_acquire(&mempool);
+        ASSERT_NOT_NULL(segments[i]);
+    }
+    ASSERT_UINT_EQUALS(6, mempool.high_water_mark);
+
+    for (size_t i = 0; i < 6; ++i) {
+        aws_memory_pool_release(&mempool, segments[i]);
+    }
+
+    ASSERT_UINT_EQUALS(6, mempool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(6, aws_array_list_length(&mempool.stack));
+
+    /* growth stops at max_segment_count */
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&mempool);
+        ASSERT_NOT_NULL(segments[i]);
+    }
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        aws_memory_pool_release(&mempool, segments[i]);
+    }
+
+    ASSERT_UINT_EQUALS(8, mempool.ideal_segment_count);
+    ASSERT_UINT_EQUALS(8, aws_array_list_length(&mempool.stack));
+
+    aws_memory_pool_clean_up(&mempool);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_grows_to_high_water_mark, s_test_memory_pool_grows_to_high_water_mark)
+
+static bool s_in_slab(const struct aws_memory_pool *mempool, const void *segment) {
+    return (const uint8_t *)segment >= (const uint8_t *)mempool->slab &&
+           (const uint8_t *)segment < (const uint8_t *)mempool->slab + mempool->slab_length;
+}
+
+static int s_test_memory_pool_huge_pages(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* works whether or not the machine has huge pages to give, only the backing differs */
+    struct aws_memory_pool mempool;
+    ASSERT_SUCCESS(aws_memory_pool_init_from_huge_pages(&mempool, allocator, 4, 16 * 1024 + 100));
+    ASSERT_NOT_NULL(mempool.slab);
+    ASSERT_TRUE(mempool.slab_length >= 4 * (16 * 1024 + 100));
+
+    void *segments[5];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        segments[i] = aws_memory_pool_acquire(&mempool);
+        ASSERT_NOT_NULL(segments[i]);
+        ASSERT_UINT_EQUALS(0, (uintptr_t)segments[i] % 16);
+        ASSERT_TRUE((i < 4) == s_in_slab(&mempool, segments[i]));
+        memset(segments[i], 0xAB, mempool.segment_size);
+    }
+
+    /* the allocated one goes back first, and is then displaced by the last slab segment */
+    aws_memory_pool_release(&mempool, segments[4]);
+    for (size_t i = 0; i < 4; ++i) {
+        aws_memory_pool_release(&mempool, segments[i]);
+    }
+
+    ASSERT_UINT_EQUALS(4, aws_array_list_length(&mempool.stack));
+    for (size_t i = 0; i < 4; ++i) {
+        void *segment = NULL;
+        ASSERT_SUCCESS(aws_array_list_get_at(&mempool.stack, &segment, i));
+        ASSERT_TRUE(s_in_slab(&mempool, segment));
+    }
+
+    aws_memory_pool_clean_up(&mempool);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(memory_pool_huge_pages, s_test_memory_pool_huge_pages)
+
+static int s_test_message_pool_large_counts(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    /* counts above UINT8_MAX used to be truncated */
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = 1024,
+        .application_data_msg_count = 300,
+        .small_block_msg_data_size = 128,
+        .small_block_msg_count = 300,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &creation_args));
+    ASSERT_UINT_EQUALS(300, aws_array_list_length(&msg_pool.application_data_pool.stack));
+    ASSERT_UINT_EQUALS(300, aws_array_list_length(&msg_pool.small_block_pool.stack));
+
+    struct aws_io_message *message = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 1024);
+    ASSERT_NOT_NULL(message);
+    ASSERT_UINT_EQUALS(1024, message->message_data.capacity);
+    ASSERT_UINT_EQUALS(299, aws_array_list_length(&msg_pool.application_data_pool.stack));
+    aws_message_pool_release(&msg_pool, message);
+    ASSERT_UINT_EQUALS(300, aws_array_list_length(&msg_pool.application_data_pool.stack));
+
+    aws_message_pool_clean_up(&msg_pool);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_large_counts, s_test_message_pool_large_counts)
+
+static int s_check_zero_policy(
+    struct aws_allocator *allocator,
+    enum aws_message_pool_zero_policy zero_policy,
+    bool is_sensitive,
+    bool expect_wiped) {
+
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = 1024,
+        .application_data_msg_count = 1,
+        .small_block_msg_data_size = 128,
+        .small_block_msg_count = 1,
+        .zero_policy = zero_policy,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &creation_args));
+
+    struct aws_io_message *message = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 64);
+    ASSERT_NOT_NULL(message);
+    ASSERT_FALSE(message->is_sensitive);
+    memset(message->message_data.buffer, 0xAB, 64);
+    message->message_data.len = 64;
+    message->is_sensitive = is_sensitive;
+    uint8_t *buffer = message->message_data.buffer;
+    aws_message_pool_release(&msg_pool, message);
+
+    /* the pool holds one small block, so the same segment comes back */
+    message = aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, 64);
+    ASSERT_NOT_NULL(message);
+    ASSERT_PTR_EQUALS(buffer, message->message_data.buffer);
+    ASSERT_FALSE(message->is_sensitive);
+    ASSERT_UINT_EQUALS(expect_wiped ? 0x00 : 0xAB, message->message_data.buffer[0]);
+    ASSERT_UINT_EQUALS(expect_wiped ? 0x00 : 0xAB, message->message_data.buffer[63]);
+    aws_message_pool_release(&msg_pool, message);
+
+    aws_message_pool_clean_up(&msg_pool);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_message_pool_zero_policy(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    ASSERT_SUCCESS(s_check_zero_policy(allocator, AWS_MESSAGE_POOL_ZERO_ALWAYS, false, true));
+    ASSERT_SUCCESS(s_check_zero_policy(allocator, AWS_MESSAGE_POOL_ZERO_NEVER, true, false));
+    ASSERT_SUCCESS(s_check_zero_policy(allocator, AWS_MESSAGE_POOL_ZERO_SENSITIVE, false, false));
+    ASSERT_SUCCESS(s_check_zero_policy(allocator, AWS_MESSAGE_POOL_ZERO_SENSITIVE, true, true));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_zero_policy, s_test_message_pool_zero_policy)
+
+static int s_test_message_pool_size_classes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = 16 * 1024,
+        .application_data_msg_count = 2,
+        .small_block_msg_data_size = 128,
+        .small_block_msg_count = 2,
+        .size_class_msg_count = 2,
+    };
+
+    struct aws_message_pool msg_pool;
+    ASSERT_SUCCESS(aws_message_pool_init(&msg_pool, allocator, &creation_args));
+
+    /* 256, 512, 1K, 2K, 4K, 8K */
+    ASSERT_UINT_EQUALS(6, msg_pool.size_class_count);
+
+    struct {
+        size_t size_hint;
+        size_t expected_capacity;
+        struct aws_memory_pool *expected_pool;
+    } cases[] = {
+        {.size_hint = 100, .expected_capacity = 100, .expected_pool = &msg_pool.small_block_pool},
+        {.size_hint = 129, .expected_capacity = 129, .expected_pool = &msg_pool.size_class_pools[0]},
+        {.size_hint = 1024, .expected_capacity = 1024, .expected_pool = &msg_pool.size_class_pools[2]},
+        {.size_hint = 3000, .expected_capacity = 3000, .expected_pool = &msg_pool.size_class_pools[4]},
+        {.size_hint = 8193, .expected_capacity = 8193, .expected_pool = &msg_pool.application_data_pool},
+        {.size_hint = 64 * 1024, .expected_capacity = 16 * 1024, .expected_pool = &msg_pool.application_data_pool},
+    };
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(cases); ++i) {
+        size_t available = aws_array_list_length(&cases[i].expected_pool->stack);
+
+        struct aws_io_message *message =
+            aws_message_pool_acquire(&msg_pool, AWS_IO_MESSAGE_APPLICATION_DATA, cases[i].size_hint);
+        ASSERT_NOT_NULL(message);
+        ASSERT_UINT_EQUALS(cases[i].expected_capacity, message->message_data.capacity);
+        ASSERT_UINT_EQUALS(available - 1, aws_array_list_length(&cases[i].expected_pool->stack));
+
+        aws_message_pool_release(&msg_pool, message);
+        ASSERT_UINT_EQUALS(available, aws_array_list_length(&cases[i].expected_pool->stack));
+    }
+
+    aws_message_pool_clean_up(&msg_pool);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_size_classes, s_test_message_pool_size_classes)
+
+static int s_test_message_pool_depot(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_message_pool_depot depot;
+    ASSERT_SUCCESS(aws_message_pool_depot_init(&depot, allocator, 8));
+
+    struct aws_message_pool_creation_args creation_args = {
+        .application_data_msg_data_size = 1024,
+        .application_data_msg_count = 4,
+        .small_block_msg_data_size = 128,
+        .small_block_msg_count = 4,
+        .depot = &depot,
+    };
+
+    struct aws_message_pool pool_a;
+    ASSERT_SUCCESS(aws_message_pool_init(&pool_a, allocator, &creation_args));
+    struct aws_message_pool pool_b;
+    ASSERT_SUCCESS(aws_message_pool_init(&pool_b, allocator, &creation_args));
+    ASSERT_UINT_EQUALS(2, pool_a.application_data_pool.depot_batch_count);
+
+    struct aws_io_message *messages[6];
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(messages); ++i) {
+        messages[i] = aws_message_pool_acquire(&pool_a, AWS_IO_MESSAGE_APPLICATION_DATA, 1024);
+        ASSERT_NOT_NULL(messages[i]);
+    }
+
+    /* the fifth release overflows: it goes to the depot along with a batch from the full pool */
+    for (size_t i = 0; i < 4; ++i) {
+        aws_message_pool_release(&pool_a, messages[i]);
+    }
+    ASSERT_UINT_EQUALS(4, aws_array_list_length(&pool_a.application_data_pool.stack));
+    aws_message_pool_release(&pool_a, messages[4]);
+    ASSERT_UINT_EQUALS(3, aws_array_list_length(&pool_a.application_data_pool.stack));
+    aws_message_pool_release(&pool_a, messages[5]);
+    ASSERT_UINT_EQUALS(4, aws_array_list_length(&pool_a.application_data_pool.stack));
+
+    /* once empty, the other pool refills with those two rather than allocating */
+    for (size_t i = 0; i < 5; ++i) {
+        messages[i] = aws_message_pool_acquire(&pool_b, AWS_IO_MESSAGE_APPLICATION_DATA, 1024);
+        ASSERT_NOT_NULL(messages[i]);
+    }
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(&pool_b.application_data_pool.stack));
+
+    for (size_t i = 0; i < 5; ++i) {
+        aws_message_pool_release(&pool_b, messages[i]);
+    }
+
+    aws_message_pool_clean_up(&pool_a);
+    aws_message_pool_clean_up(&pool_b);
+    aws_message_pool_depot_clean_up(&depot);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(message_pool_depot, s_test_message_pool_depot)
@@ -871,6 +871,41 @@ static int test_pipe_writes_are_fifo(struct pipe_state *state) {
 
 PIPE_TEST_CASE(pipe_writes_are_fifo, GIANT_BUFFER_SIZE);
 
+static void s_write_in_many_small_chunks_task(struct pipe_state *state) {
+    /* Far more writes than fit in the pipe, so most queue up and go out gathered together */
+    struct aws_byte_cursor cursor = aws_byte_cursor_from_buf(&state->buffers.src);
+    const size_t chunk_size = 100;
+    while (cursor.len > 0) {
+        size_t bytes_to_write = (chunk_size < cursor.len) ? chunk_size : cursor.len;
+        struct aws_byte_cursor chunk_cursor = aws_byte_cursor_from_array(cursor.ptr, bytes_to_write);
+
+        int err = aws_pipe_write(&state->write_end, chunk_cursor, s_close_write_end_after_all_writes_completed, state);
+        if (err) {
+            goto error;
+        }
+
+        aws_byte_cursor_advance(&cursor, bytes_to_write);
+    }
+
+    return;
+error:
+    s_signal_error(state);
+}
+
+static int test_pipe_many_small_writes_are_fifo(struct pipe_state *state) {
+
+    s_schedule_read_end_task(state, s_read_everything_task);
+    s_schedule_write_end_task(state, s_write_in_many_small_chunks_task);
+
+    ASSERT_SUCCESS(s_wait_for_results(state));
+
+    ASSERT_SUCCESS(s_pipe_state_check_copied_data(state));
+
+    return AWS_OP_SUCCESS;
+}
+
+PIPE_TEST_CASE(pipe_many_small_writes_are_fifo, 1024 * 1024);
+
 static void s_cancelled_on_write_completed(
     struct aws_pipe_write_end *write_end,
     int error_code,
@@ -5,8 +5,19 @@
 
 #include <aws/testing/aws_test_harness.h>
 
+#include <aws/io/file_utils.h>
 #include <aws/io/pki_utils.h>
 
+#include <stdio.h>
+
+#ifdef AWS_OS_APPLE
+#    include <CoreFoundation/CoreFoundation.h>
+#endif
+
+#if _MSC_VER
+#    pragma warning(disable : 4996) /* fopen */
+#endif
+
 static int s_test_pem_single_cert_parse(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     static const char *s_rsa_1024_sha224_client_crt_pem =
@@ -967,3 +978,109 @@ static int s_test_pem_invalid_in_chain_parse(struct aws_allocator *allocator, vo
 }
 
 AWS_TEST_CASE(test_pem_invalid_in_chain_parse, s_test_pem_invalid_in_chain_parse)
+
+static int s_write_trust_store_file(const char *file_name, struct aws_byte_cursor pem, size_t copies) {
+    FILE *file = fopen(file_name, "wb");
+    ASSERT_NOT_NULL(file);
+    for (size_t i = 0; i < copies; ++i) {
+        ASSERT_UINT_EQUALS(pem.len, fwrite(pem.ptr, 1, pem.len, file));
+    }
+    fclose(file);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that trust stores loaded from the same file share one decode, and that a changed file is decoded again. */
+static int s_test_trust_store_cache_shared(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+
+    static const char *s_trust_store_file_name = "trust_store_cache_test.pem";
+
+    struct aws_byte_buf pem;
+    ASSERT_SUCCESS(aws_byte_buf_init_from_file(&pem, allocator, "unittests.crt"));
+    struct aws_byte_cursor pem_cur = aws_byte_cursor_from_buf(&pem);
+    ASSERT_SUCCESS(s_write_trust_store_file(s_trust_store_file_name, pem_cur, 1));
+
+    struct aws_array_list expected;
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(&expected, allocator, 1, sizeof(struct aws_byte_buf)));
+    ASSERT_SUCCESS(aws_decode_pem_to_buffer_list(allocator, &pem_cur, &expected));
+    struct aws_byte_buf *expected_cert = NULL;
+    aws_array_list_get_at_ptr(&expected, (void **)&expected_cert, 0);
+
+    struct aws_trust_store *first = aws_trust_store_acquire_from_file(s_trust_store_file_name);
+    ASSERT_NOT_NULL(first);
+    struct aws_trust_store *second = aws_trust_store_acquire_from_file(s_trust_store_file_name);
+    ASSERT_PTR_EQUALS(first, second);
+    aws_trust_store_release(second);
+
+    const struct aws_array_list *certificates = aws_trust_store_get_certificates(first);
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(certificates));
+    struct aws_byte_buf *cert = NULL;
+    aws_array_list_get_at_ptr(certificates, (void **)&cert, 0);
+    ASSERT_BIN_ARRAYS_EQUALS(expected_cert->buffer, expected_cert->len, cert->buffer, cert->len);
+
+    /* a different length is a different file, even if the modification time didn't visibly move */
+    ASSERT_SUCCESS(s_write_trust_store_file(s_trust_store_file_name, pem_cur, 2));
+    struct aws_trust_store *changed = aws_trust_store_acquire_from_file(s_trust_store_file_name);
+    ASSERT_NOT_NULL(changed);
+    ASSERT_FALSE(changed == first);
+    ASSERT_UINT_EQUALS(2, aws_array_list_length(aws_trust_store_get_certificates(changed)));
+
+    /* the old copy stays good for whoever still holds it */
+    ASSERT_UINT_EQUALS(1, aws_array_list_length(aws_trust_store_get_certificates(first)));
+    aws_trust_store_release(first);
+
+    remove(s_trust_store_file_name);
+    ASSERT_NULL(aws_trust_store_acquire_from_file(s_trust_store_file_name));
+
+    aws_trust_store_release(changed);
+    aws_cert_chain_clean_up(&expected);
+    aws_array_list_clean_up(&expected);
+    aws_byte_buf_clean_up(&pem);
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_trust_store_cache_shared, s_test_trust_store_cache_shared)
+
+#if defined(AWS_OS_APPLE) || defined(_WIN32)
+/* Test that importing the same trusted certificates twice hands back the first import rather than doing it again. */
+static int s_test_trusted_certificate_import_cache(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+
+    struct aws_byte_buf pem;
+    ASSERT_SUCCESS(aws_byte_buf_init_from_file(&pem, allocator, "unittests.crt"));
+    struct aws_byte_cursor pem_cur = aws_byte_cursor_from_buf(&pem);
+
+#    ifdef AWS_OS_APPLE
+    CFArrayRef first = NULL;
+    CFArrayRef second = NULL;
+    ASSERT_SUCCESS(aws_import_trusted_certificates(allocator, kCFAllocatorDefault, &pem_cur, &first));
+    ASSERT_SUCCESS(aws_import_trusted_certificates(allocator, kCFAllocatorDefault, &pem_cur, &second));
+    ASSERT_NOT_NULL(first);
+    ASSERT_PTR_EQUALS(first, second);
+    aws_release_certificates(first);
+    aws_release_certificates(second);
+#    else
+    HCERTSTORE first = NULL;
+    HCERTSTORE second = NULL;
+    ASSERT_SUCCESS(aws_import_trusted_certificates(allocator, &pem_cur, &first));
+    ASSERT_SUCCESS(aws_import_trusted_certificates(allocator, &pem_cur, &second));
+    ASSERT_NOT_NULL(first);
+    ASSERT_PTR_EQUALS(first, second);
+    aws_close_cert_store(first);
+    aws_close_cert_store(second);
+#    endif
+
+    aws_byte_buf_clean_up(&pem);
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_trusted_certificate_import_cache, s_test_trusted_certificate_import_cache)
+#endif /* AWS_OS_APPLE || _WIN32 */
@@ -28,6 +28,10 @@ struct rw_test_handler_impl {
     struct aws_condition_variable condition_variable;
     struct aws_mutex mutex;
     struct aws_atomic_var shutdown_error;
+    struct aws_atomic_var drain_called;
+    bool shutdown_on_drain;
+    struct aws_byte_buf direct_read_buffer;
+    size_t direct_reads;
     void *ctx;
 };
 
@@ -102,6 +106,54 @@ static int s_rw_handler_shutdown(
     return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, abort_immediately);
 }
 
+static void s_rw_handler_drain(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    aws_atomic_store_int(&handler_impl->drain_called, true);
+
+    if (handler_impl->shutdown_on_drain) {
+        aws_channel_shutdown(slot->channel, AWS_ERROR_SUCCESS);
+    }
+}
+
+/* hands out the free end of the handler's own buffer, starting over once it's full. */
+static void s_rw_handler_acquire_read_buffer(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t max_size,
+    struct aws_byte_buf *out_buffer) {
+    (void)slot;
+
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    struct aws_byte_buf *direct_read_buffer = &handler_impl->direct_read_buffer;
+    if (direct_read_buffer->len == direct_read_buffer->capacity) {
+        direct_read_buffer->len = 0;
+    }
+
+    size_t space = direct_read_buffer->capacity - direct_read_buffer->len;
+    *out_buffer = aws_byte_buf_from_empty_array(
+        direct_read_buffer->buffer + direct_read_buffer->len, space < max_size ? space : max_size);
+}
+
+static int s_rw_handler_read_buffer_filled(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t bytes_read) {
+
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    if (!bytes_read) {
+        return AWS_OP_SUCCESS;
+    }
+
+    struct aws_byte_buf *direct_read_buffer = &handler_impl->direct_read_buffer;
+    struct aws_byte_buf data_read =
+        aws_byte_buf_from_array(direct_read_buffer->buffer + direct_read_buffer->len, bytes_read);
+    direct_read_buffer->len += bytes_read;
+    ++handler_impl->direct_reads;
+
+    handler_impl->on_read(handler, slot, &data_read, handler_impl->ctx);
+    return AWS_OP_SUCCESS;
+}
+
 static size_t s_rw_handler_message_overhead(struct aws_channel_handler *handler) {
     (void)handler;
     return 0;
@@ -120,6 +172,7 @@ static void s_rw_handler_destroy(struct aws_channel_handler *handler) {
         aws_condition_variable_notify_one(handler_impl->destroy_condition_variable);
     }
 
+    aws_byte_buf_clean_up(&handler_impl->direct_read_buffer);
     aws_mem_release(handler->alloc, handler_impl);
     aws_mem_release(handler->alloc, handler);
 }
@@ -132,6 +185,20 @@ struct aws_channel_handler_vtable s_rw_test_vtable = {
     .process_write_message = s_rw_handler_process_write_message,
     .destroy = s_rw_handler_destroy,
     .message_overhead = s_rw_handler_message_overhead,
+    .drain = s_rw_handler_drain,
+};
+
+struct aws_channel_handler_vtable s_rw_test_direct_read_vtable = {
+    .shutdown = s_rw_handler_shutdown,
+    .increment_read_window = s_rw_handler_increment_read_window,
+    .initial_window_size = s_rw_handler_get_current_window_size,
+    .process_read_message = s_rw_handler_process_read,
+    .process_write_message = s_rw_handler_process_write_message,
+    .destroy = s_rw_handler_destroy,
+    .message_overhead = s_rw_handler_message_overhead,
+    .drain = s_rw_handler_drain,
+    .acquire_read_buffer = s_rw_handler_acquire_read_buffer,
+    .read_buffer_filled = s_rw_handler_read_buffer_filled,
 };
 
 struct aws_channel_handler *rw_handler_new(
@@ -171,6 +238,31 @@ void rw_handler_enable_wait_on_destroy(
     handler_impl->destroy_condition_variable = condition_variable;
 }
 
+void rw_handler_enable_shutdown_on_drain(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    handler_impl->shutdown_on_drain = true;
+}
+
+int rw_handler_enable_direct_read(struct aws_channel_handler *handler, size_t buffer_size) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    if (aws_byte_buf_init(&handler_impl->direct_read_buffer, handler->alloc, buffer_size)) {
+        return AWS_OP_ERR;
+    }
+
+    handler->vtable = &s_rw_test_direct_read_vtable;
+    return AWS_OP_SUCCESS;
+}
+
+size_t rw_handler_direct_reads(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    return handler_impl->direct_reads;
+}
+
+bool rw_handler_drain_called(struct aws_channel_handler *handler) {
+    struct rw_test_handler_impl *handler_impl = handler->impl;
+    return aws_atomic_load_int(&handler_impl->drain_called);
+}
+
 void rw_handler_trigger_read(struct aws_channel_handler *handler, struct aws_channel_slot *slot) {
     struct rw_test_handler_impl *handler_impl = handler->impl;
 
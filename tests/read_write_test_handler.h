@@ -34,6 +34,17 @@ void rw_handler_enable_wait_on_destroy(
     struct aws_atomic_var *destroy_called,
     struct aws_condition_variable *condition_variable);
 
+/* drain records the call, and with this set also shuts the channel down the way a protocol would after its GOAWAY. */
+void rw_handler_enable_shutdown_on_drain(struct aws_channel_handler *handler);
+
+bool rw_handler_drain_called(struct aws_channel_handler *handler);
+
+/* offers a buffer of buffer_size bytes through acquire_read_buffer, so the socket handler reads straight into it. The
+ * bytes still reach on_read, and rw_handler_direct_reads() counts the reads that landed there. */
+int rw_handler_enable_direct_read(struct aws_channel_handler *handler, size_t buffer_size);
+
+size_t rw_handler_direct_reads(struct aws_channel_handler *handler);
+
 void rw_handler_write(struct aws_channel_handler *handler, struct aws_channel_slot *slot, struct aws_byte_buf *buffer);
 
 void rw_handler_trigger_read(struct aws_channel_handler *handler, struct aws_channel_slot *slot);
@@ -4,13 +4,17 @@
  */
 #include <aws/io/channel_bootstrap.h>
 #include <aws/io/event_loop.h>
+#include <aws/io/host_resolver.h>
 #include <aws/io/socket.h>
 #include <aws/io/socket_channel_handler.h>
 #include <aws/io/statistics.h>
+#include <aws/io/tls_channel_handler.h>
 
 #include <aws/common/atomics.h>
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/string.h>
+#include <aws/common/thread.h>
 
 #include <aws/testing/aws_test_harness.h>
 
@@ -31,6 +35,8 @@ struct socket_test_args {
     struct aws_channel_handler *rw_handler;
 
     struct aws_atomic_var rw_slot; /* pointer-to struct aws_channel_slot */
+    /* applied to the server's channels as they're set up */
+    enum aws_channel_read_priority read_priority;
     int error_code;
     bool shutdown_invoked;
     bool error_invoked;
@@ -135,6 +141,7 @@ static void s_socket_handler_test_server_setup_callback(
     struct socket_test_args *setup_test_args = (struct socket_test_args *)user_data;
 
     setup_test_args->channel = channel;
+    aws_channel_set_read_priority(channel, setup_test_args->read_priority);
 
     struct aws_channel_slot *rw_slot = aws_channel_slot_new(channel);
     aws_channel_slot_insert_end(channel, rw_slot);
@@ -550,83 +557,2890 @@ static int s_socket_close_test(struct aws_allocator *allocator, void *ctx) {
 
 AWS_TEST_CASE(socket_handler_close, s_socket_close_test)
 
+/* a client channel with an idle timeout that never reads or writes anything is shut down once the timeout passes */
+static int s_socket_idle_timeout_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        0));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.idle_timeout_ms = 100;
+    channel_options.user_data = &outgoing_args;
+
+    uint64_t connect_started_ns = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&connect_started_ns));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    /* nobody shuts anything down here, the client's idle timeout has to */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+
+    uint64_t shutdown_seen_ns = 0;
+    ASSERT_SUCCESS(aws_high_res_clock_get_ticks(&shutdown_seen_ns));
+    ASSERT_TRUE(
+        shutdown_seen_ns - connect_started_ns >=
+        aws_timestamp_convert(100, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL));
+    ASSERT_INT_EQUALS(AWS_IO_CHANNEL_IDLE_TIMEOUT, outgoing_args.error_code);
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_idle_timeout, s_socket_idle_timeout_test)
+
+struct borrowed_write_args {
+    struct aws_channel_slot *slot;
+    struct aws_channel_task task;
+    struct aws_byte_cursor segments[3];
+    int send_error;
+    int completion_error;
+    bool completed;
+    bool released;
+};
+
+static void s_borrowed_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+    struct borrowed_write_args *args = user_data;
+
+    aws_mutex_lock(&c_tester.mutex);
+    args->completion_error = err_code;
+    args->completed = true;
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_borrowed_write_released(void *user_data) {
+    struct borrowed_write_args *args = user_data;
+
+    aws_mutex_lock(&c_tester.mutex);
+    args->released = true;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static bool s_borrowed_write_released_predicate(void *user_data) {
+    struct borrowed_write_args *args = user_data;
+    return args->released;
+}
+
+static void s_borrowed_write_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct borrowed_write_args *args = arg;
+
+    struct aws_io_message_borrowed_options options = {
+        .segments = args->segments,
+        .segment_count = AWS_ARRAY_SIZE(args->segments),
+        .on_release = s_borrowed_write_released,
+        .release_user_data = args,
+    };
+    struct aws_io_message *message = aws_channel_acquire_borrowed_message(args->slot->channel, &options);
+    if (!message) {
+        args->send_error = aws_last_error();
+        return;
+    }
+
+    message->on_completion = s_borrowed_write_completed;
+    message->user_data = args;
+    if (aws_channel_slot_send_message(args->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+        args->send_error = aws_last_error();
+        aws_mem_release(message->allocator, message);
+    }
+}
+
+/* a message made of borrowed segments arrives whole, and is handed back once written */
+static int s_socket_borrowed_message_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    const char *expected = "scatter, gather, and no copy";
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        (int)strlen(expected)));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct borrowed_write_args write_args = {
+        .slot = aws_atomic_load_ptr(&outgoing_args.rw_slot),
+        .segments =
+            {
+                aws_byte_cursor_from_c_str("scatter, "),
+                aws_byte_cursor_from_c_str("gather, "),
+                aws_byte_cursor_from_c_str("and no copy"),
+            },
+    };
+    aws_channel_task_init(&write_args.task, s_borrowed_write_task, &write_args, "borrowed_write");
+    aws_channel_schedule_task_now(outgoing_args.channel, &write_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_borrowed_write_released_predicate, &write_args));
+
+    ASSERT_INT_EQUALS(0, write_args.send_error);
+    ASSERT_TRUE(write_args.completed);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, write_args.completion_error);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected,
+        strlen(expected),
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_borrowed_message, s_socket_borrowed_message_test)
+
+struct any_thread_write_args {
+    size_t completed;
+    size_t released;
+    int completion_error;
+};
+
+static void s_any_thread_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)message;
+    struct any_thread_write_args *args = user_data;
+
+    aws_mutex_lock(&c_tester.mutex);
+    if (!aws_channel_thread_is_callers_thread(channel)) {
+        err_code = AWS_ERROR_INVALID_STATE;
+    }
+    args->completion_error |= err_code;
+    args->completed++;
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_any_thread_write_released(void *user_data) {
+    struct any_thread_write_args *args = user_data;
+
+    aws_mutex_lock(&c_tester.mutex);
+    args->released++;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static bool s_any_thread_writes_released_predicate(void *user_data) {
+    struct any_thread_write_args *args = user_data;
+    return args->released == 3;
+}
+
+/* writes queued straight from the test thread arrive in order, and complete on the channel's thread */
+static int s_socket_write_from_any_thread_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    const char *expected = "one two three";
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        (int)strlen(expected)));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct any_thread_write_args write_args;
+    AWS_ZERO_STRUCT(write_args);
+    struct aws_byte_cursor segments[3] = {
+        aws_byte_cursor_from_c_str("one "),
+        aws_byte_cursor_from_c_str("two "),
+        aws_byte_cursor_from_c_str("three"),
+    };
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(segments); ++i) {
+        struct aws_io_message_borrowed_options options = {
+            .segments = &segments[i],
+            .segment_count = 1,
+            .on_release = s_any_thread_write_released,
+            .release_user_data = &write_args,
+        };
+        struct aws_io_message *message = aws_channel_acquire_borrowed_message(outgoing_args.channel, &options);
+        ASSERT_NOT_NULL(message);
+        message->on_completion = s_any_thread_write_completed;
+        message->user_data = &write_args;
+        ASSERT_SUCCESS(aws_channel_write_from_any_thread(outgoing_args.channel, message));
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_any_thread_writes_released_predicate, &write_args));
+
+    ASSERT_UINT_EQUALS(3, write_args.completed);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, write_args.completion_error);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected,
+        strlen(expected),
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_write_from_any_thread, s_socket_write_from_any_thread_test)
+
+struct coalesced_write_args {
+    struct aws_channel_slot *slot;
+    struct aws_channel_task task;
+    struct aws_byte_cursor writes[4];
+    int send_error;
+    int completion_error;
+    size_t completed;
+    /* completions seen before the task that wrote everything returned */
+    size_t completed_in_task;
+};
+
+static void s_coalesced_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+    (void)channel;
+    (void)message;
+    struct coalesced_write_args *args = user_data;
+
+    aws_mutex_lock(&c_tester.mutex);
+    if (err_code) {
+        args->completion_error = err_code;
+    }
+    ++args->completed;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static bool s_coalesced_writes_completed_predicate(void *user_data) {
+    struct coalesced_write_args *args = user_data;
+    return args->completed == AWS_ARRAY_SIZE(args->writes);
+}
+
+static void s_coalesced_write_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct coalesced_write_args *args = arg;
+
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(args->writes); ++i) {
+        struct aws_io_message *message = aws_channel_acquire_message_from_pool(
+            args->slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, args->writes[i].len);
+        if (!message) {
+            args->send_error = aws_last_error();
+            return;
+        }
+
+        aws_byte_buf_write_from_whole_cursor(&message->message_data, args->writes[i]);
+        message->on_completion = s_coalesced_write_completed;
+        message->user_data = args;
+        if (aws_channel_slot_send_message(args->slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            args->send_error = aws_last_error();
+            aws_mem_release(message->allocator, message);
+            return;
+        }
+    }
+
+    aws_mutex_lock(&c_tester.mutex);
+    args->completed_in_task = args->completed;
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+/* small writes issued together are held back until the end of the tick, then all arrive */
+static int s_socket_write_coalescing_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    const char *expected = "one, two, three, four";
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        (int)strlen(expected)));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.write_coalescing_threshold = 4096;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct coalesced_write_args write_args = {
+        .slot = aws_atomic_load_ptr(&outgoing_args.rw_slot),
+        .writes =
+            {
+                aws_byte_cursor_from_c_str("one, "),
+                aws_byte_cursor_from_c_str("two, "),
+                aws_byte_cursor_from_c_str("three, "),
+                aws_byte_cursor_from_c_str("four"),
+            },
+    };
+    aws_channel_task_init(&write_args.task, s_coalesced_write_task, &write_args, "coalesced_write");
+    aws_channel_schedule_task_now(outgoing_args.channel, &write_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_coalesced_writes_completed_predicate, &write_args));
+
+    ASSERT_INT_EQUALS(0, write_args.send_error);
+    ASSERT_INT_EQUALS(0, write_args.completed_in_task);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, write_args.completion_error);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected,
+        strlen(expected),
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_write_coalescing, s_socket_write_coalescing_test)
+
 static void s_creation_callback_test_channel_creation_callback(
     struct aws_client_bootstrap *bootstrap,
     int error_code,
     struct aws_channel *channel,
     void *user_data) {
 
-    (void)bootstrap;
-    (void)error_code;
+    (void)bootstrap;
+    (void)error_code;
+
+    struct socket_test_args *setup_test_args = (struct socket_test_args *)user_data;
+
+    setup_test_args->creation_callback_invoked = true;
+
+    struct aws_crt_statistics_handler *stats_handler = aws_statistics_handler_new_test(bootstrap->allocator);
+    aws_atomic_store_ptr(&c_tester.stats_handler, stats_handler);
+
+    aws_channel_set_statistics_handler(channel, stats_handler);
+}
+
+static struct aws_event_loop *s_default_new_event_loop(
+    struct aws_allocator *allocator,
+    aws_io_clock_fn *clock,
+    void *user_data) {
+
+    (void)user_data;
+    return aws_event_loop_new_default(allocator, clock);
+}
+
+static int s_statistic_test_clock_fn(uint64_t *timestamp) {
+    *timestamp = aws_atomic_load_int(&c_tester.current_time_ns);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_socket_common_tester_statistics_init(
+    struct aws_allocator *allocator,
+    struct socket_common_tester *tester) {
+
+    aws_io_library_init(allocator);
+
+    AWS_ZERO_STRUCT(*tester);
+    tester->el_group =
+        aws_event_loop_group_new(allocator, s_statistic_test_clock_fn, 1, s_default_new_event_loop, NULL, NULL);
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+    tester->mutex = mutex;
+    tester->condition_variable = condition_variable;
+    aws_atomic_store_int(&tester->current_time_ns, 0);
+    aws_atomic_store_ptr(&tester->stats_handler, NULL);
+
+    return AWS_OP_SUCCESS;
+}
+
+static bool s_stats_processed_predicate(void *user_data) {
+    struct aws_crt_statistics_handler *stats_handler = user_data;
+    struct aws_statistics_handler_test_impl *stats_impl = stats_handler->impl;
+
+    return stats_impl->total_bytes_read > 0 && stats_impl->total_bytes_written > 0;
+}
+
+static int s_open_channel_statistics_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_statistics_init(allocator, &c_tester);
+
+    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("Some bytes");
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("Fresh pressed Washington apples");
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        0));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options;
+    AWS_ZERO_STRUCT(bootstrap_options);
+    bootstrap_options.event_loop_group = c_tester.el_group;
+    bootstrap_options.host_resolver = NULL;
+
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.creation_callback = s_creation_callback_test_channel_creation_callback;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    /* wait for both ends to setup */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    ASSERT_TRUE(outgoing_args.creation_callback_invoked);
+
+    struct aws_channel_slot *outgoing_slot = aws_atomic_load_ptr(&outgoing_args.rw_slot);
+    rw_handler_write(outgoing_args.rw_handler, outgoing_slot, &write_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_read_predicate, &incoming_rw_args));
+
+    struct aws_channel_slot *incoming_slot = aws_atomic_load_ptr(&incoming_args.rw_slot);
+    rw_handler_write(incoming_args.rw_handler, incoming_slot, &read_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_read_predicate, &outgoing_rw_args));
+
+    uint64_t ms_to_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+
+    aws_atomic_store_int(&c_tester.current_time_ns, (size_t)ms_to_ns);
+
+    struct aws_crt_statistics_handler *stats_handler = aws_atomic_load_ptr(&c_tester.stats_handler);
+    struct aws_statistics_handler_test_impl *stats_impl = stats_handler->impl;
+
+    aws_mutex_lock(&stats_impl->lock);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &stats_impl->signal, &stats_impl->lock, s_stats_processed_predicate, stats_handler));
+
+    ASSERT_TRUE(stats_impl->total_bytes_read == read_tag.len);
+    ASSERT_TRUE(stats_impl->total_bytes_written == write_tag.len);
+
+    /* the bytes came out of at least one syscall that didn't block, and every such syscall moved at least a byte */
+    ASSERT_TRUE(stats_impl->total_read_syscalls > stats_impl->total_read_would_block);
+    ASSERT_TRUE(stats_impl->total_write_syscalls > stats_impl->total_write_would_block);
+    uint64_t productive_reads = stats_impl->total_read_syscalls - stats_impl->total_read_would_block;
+    ASSERT_TRUE(stats_impl->total_bytes_read / productive_reads >= 1);
+    ASSERT_TRUE(stats_impl->total_bytes_read / productive_reads <= read_tag.len);
+    ASSERT_TRUE(stats_impl->total_partial_writes <= stats_impl->total_write_syscalls);
+
+    aws_mutex_unlock(&stats_impl->lock);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    /* clean up */
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(open_channel_statistics_test, s_open_channel_statistics_test)
+
+static int s_warm_pool_rejects_invalid_options_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_options socket_options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = AWS_SOCKET_LOCAL,
+        .connect_timeout_ms = 3000,
+    };
+
+    struct aws_client_bootstrap_warm_pool_options pool_options = {
+        .host_name = "testsock.sock",
+        .socket_options = &socket_options,
+        .size = 2,
+    };
+
+    /* only tcp sockets to resolvable hosts can be kept warm */
+    ASSERT_FAILS(aws_client_bootstrap_add_warm_pool(client_bootstrap, &pool_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    socket_options.domain = AWS_SOCKET_IPV4;
+    socket_options.type = AWS_SOCKET_DGRAM;
+    pool_options.host_name = "127.0.0.1";
+    pool_options.port = 8080;
+    ASSERT_FAILS(aws_client_bootstrap_add_warm_pool(client_bootstrap, &pool_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    socket_options.type = AWS_SOCKET_STREAM;
+    pool_options.size = 0;
+    ASSERT_FAILS(aws_client_bootstrap_add_warm_pool(client_bootstrap, &pool_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_warm_pool_rejects_invalid_options, s_warm_pool_rejects_invalid_options_test)
+
+static int s_listener_per_event_loop_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        0));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, c_tester.el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_socket_options socket_options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = AWS_SOCKET_LOCAL,
+        .connect_timeout_ms = 3000,
+    };
+
+    struct aws_server_socket_channel_bootstrap_options server_options = {
+        .bootstrap = server_bootstrap,
+        .host_name = "testsock_per_loop.sock",
+        .port = 0,
+        .socket_options = &socket_options,
+        .incoming_callback = s_socket_handler_test_server_setup_callback,
+        .shutdown_callback = s_socket_handler_test_server_shutdown_callback,
+        .destroy_callback = s_socket_handler_test_server_listener_destroy_callback,
+        .listener_per_event_loop = true,
+        .user_data = &incoming_args,
+    };
+
+    /* local sockets can't share an address and every listener must agree on the port */
+    ASSERT_NULL(aws_server_bootstrap_new_socket_listener(&server_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    socket_options.domain = AWS_SOCKET_IPV4;
+    server_options.host_name = "127.0.0.1";
+    ASSERT_NULL(aws_server_bootstrap_new_socket_listener(&server_options));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    /* the failed attempts above already reported their destruction */
+    incoming_args.listener_destroyed = false;
+
+    server_options.port = 8129;
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(&server_options);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_host_resolver *resolver = aws_host_resolver_new_default(allocator, 8, c_tester.el_group, NULL);
+    ASSERT_NOT_NULL(resolver);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = "127.0.0.1";
+    channel_options.port = 8129;
+    channel_options.socket_options = &socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    /* whichever listener the kernel picked, the connection makes it to a channel */
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+
+    aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    aws_client_bootstrap_release(client_bootstrap);
+    aws_host_resolver_release(resolver);
+    aws_server_bootstrap_release(server_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_listener_per_event_loop, s_listener_per_event_loop_test)
+
+enum { SETUP_LIMIT_CONNECTION_COUNT = 4 };
+
+struct setup_limit_test_args {
+    struct aws_client_bootstrap *client_bootstrap;
+    struct aws_channel *client_channels[SETUP_LIMIT_CONNECTION_COUNT];
+    size_t client_setup_count;
+    size_t client_shutdown_count;
+    size_t server_setup_count;
+    size_t server_shutdown_count;
+    int error_code;
+    bool over_limit;
+    bool listener_destroyed;
+    size_t timing_count;
+    bool timing_out_of_order;
+};
+
+static void s_setup_limit_timing_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    const struct aws_client_connection_timing *timing,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+
+    struct setup_limit_test_args *args = user_data;
+
+    /* a local socket connects once, with no DNS or TLS along the way */
+    bool in_order = timing->requested_ns != 0 && timing->requested_ns <= timing->started_ns &&
+                    timing->started_ns <= timing->first_connect_start_ns &&
+                    timing->first_connect_start_ns <= timing->connected_ns &&
+                    timing->connected_ns <= timing->setup_complete_ns && timing->connect_attempt_count == 1 &&
+                    timing->dns_start_ns == 0 && timing->tls_start_ns == 0;
+
+    aws_mutex_lock(&c_tester.mutex);
+    args->timing_count++;
+    if (!in_order) {
+        args->timing_out_of_order = true;
+    }
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_setup_limit_client_setup_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    struct setup_limit_test_args *args = user_data;
+
+    aws_mutex_lock(&bootstrap->setup_limit_lock);
+    if (bootstrap->connection_setups_in_flight > bootstrap->max_connection_setups) {
+        args->over_limit = true;
+    }
+    aws_mutex_unlock(&bootstrap->setup_limit_lock);
+
+    aws_mutex_lock(&c_tester.mutex);
+    if (error_code) {
+        args->error_code = error_code;
+    } else {
+        args->client_channels[args->client_setup_count] = channel;
+    }
+    args->client_setup_count++;
+    aws_condition_variable_notify_one(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_setup_limit_client_shutdown_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct setup_limit_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->client_shutdown_count++;
+    aws_condition_variable_notify_one(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_setup_limit_server_setup_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct setup_limit_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->server_setup_count++;
+    aws_condition_variable_notify_one(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_setup_limit_server_shutdown_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct setup_limit_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->server_shutdown_count++;
+    aws_condition_variable_notify_one(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_setup_limit_listener_destroy_callback(struct aws_server_bootstrap *bootstrap, void *user_data) {
+    (void)bootstrap;
+
+    struct setup_limit_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->listener_destroyed = true;
+    aws_condition_variable_notify_one(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static bool s_setup_limit_setups_done_predicate(void *user_data) {
+    struct setup_limit_test_args *args = user_data;
+    return args->client_setup_count == SETUP_LIMIT_CONNECTION_COUNT &&
+           args->server_setup_count == SETUP_LIMIT_CONNECTION_COUNT;
+}
+
+static bool s_setup_limit_shutdowns_done_predicate(void *user_data) {
+    struct setup_limit_test_args *args = user_data;
+    return args->client_shutdown_count == SETUP_LIMIT_CONNECTION_COUNT &&
+           args->server_shutdown_count == SETUP_LIMIT_CONNECTION_COUNT;
+}
+
+static bool s_setup_limit_listener_destroyed_predicate(void *user_data) {
+    struct setup_limit_test_args *args = user_data;
+    return args->listener_destroyed;
+}
+
+/*
+ * Test that channel setups beyond the bootstrap's limit wait their turn, and every one of them still completes. Also
+ * checks the timing each setup reports.
+ */
+static int s_socket_handler_connection_setup_limit_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    struct setup_limit_test_args args;
+    AWS_ZERO_STRUCT(args);
+
+    struct aws_socket_options socket_options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = AWS_SOCKET_LOCAL,
+        .connect_timeout_ms = 3000,
+    };
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_server_bootstrap *server_bootstrap = aws_server_bootstrap_new(allocator, c_tester.el_group);
+    ASSERT_NOT_NULL(server_bootstrap);
+
+    struct aws_server_socket_channel_bootstrap_options server_options = {
+        .bootstrap = server_bootstrap,
+        .host_name = endpoint.address,
+        .socket_options = &socket_options,
+        .incoming_callback = s_setup_limit_server_setup_callback,
+        .shutdown_callback = s_setup_limit_server_shutdown_callback,
+        .destroy_callback = s_setup_limit_listener_destroy_callback,
+        .user_data = &args,
+    };
+    struct aws_socket *listener = aws_server_bootstrap_new_socket_listener(&server_options);
+    ASSERT_NOT_NULL(listener);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+        .max_connection_setups = 1,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = endpoint.address;
+    channel_options.socket_options = &socket_options;
+    channel_options.setup_callback = s_setup_limit_client_setup_callback;
+    channel_options.shutdown_callback = s_setup_limit_client_shutdown_callback;
+    channel_options.timing_callback = s_setup_limit_timing_callback;
+    channel_options.user_data = &args;
+
+    for (size_t i = 0; i < SETUP_LIMIT_CONNECTION_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_setup_limit_setups_done_predicate, &args));
+
+    ASSERT_SUCCESS(args.error_code);
+    ASSERT_FALSE(args.over_limit);
+    ASSERT_UINT_EQUALS(SETUP_LIMIT_CONNECTION_COUNT, args.timing_count);
+    ASSERT_FALSE(args.timing_out_of_order);
+
+    for (size_t i = 0; i < SETUP_LIMIT_CONNECTION_COUNT; ++i) {
+        aws_channel_shutdown(args.client_channels[i], AWS_OP_SUCCESS);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_setup_limit_shutdowns_done_predicate, &args));
+
+    aws_server_bootstrap_destroy_socket_listener(server_bootstrap, listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_setup_limit_listener_destroyed_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_UINT_EQUALS(0, client_bootstrap->connection_setups_in_flight);
+    ASSERT_TRUE(aws_linked_list_empty(&client_bootstrap->queued_connection_setups));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    aws_server_bootstrap_release(server_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_connection_setup_limit, s_socket_handler_connection_setup_limit_test)
+
+struct drain_test_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    int error_code;
+    bool drained;
+};
+
+static bool s_listener_drained_predicate(void *user_data) {
+    struct drain_test_args *drain_args = user_data;
+    return drain_args->drained;
+}
+
+static void s_on_listener_drained(struct aws_server_bootstrap *bootstrap, int error_code, void *user_data) {
+    (void)bootstrap;
+
+    struct drain_test_args *drain_args = user_data;
+    aws_mutex_lock(drain_args->mutex);
+    drain_args->error_code = error_code;
+    drain_args->drained = true;
+    aws_mutex_unlock(drain_args->mutex);
+    aws_condition_variable_notify_one(drain_args->condition_variable);
+}
+
+/* with shutdown_on_drain the server's handler closes its channel when asked to, otherwise the deadline has to. */
+static int s_socket_handler_drain_listener_common(struct aws_allocator *allocator, bool shutdown_on_drain) {
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        0));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+    if (shutdown_on_drain) {
+        rw_handler_enable_shutdown_on_drain(incoming_rw_handler);
+    }
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+    ASSERT_UINT_EQUALS(1, aws_server_bootstrap_get_open_channel_count(local_server_tester.listener));
+
+    struct drain_test_args drain_args = {
+        .mutex = &c_tester.mutex,
+        .condition_variable = &c_tester.condition_variable,
+    };
+    struct aws_server_bootstrap_drain_options drain_options = {
+        .timeout_ms = shutdown_on_drain ? 10000 : 100,
+        .on_drained = s_on_listener_drained,
+        .user_data = &drain_args,
+    };
+    ASSERT_SUCCESS(aws_server_bootstrap_drain_socket_listener(
+        local_server_tester.server_bootstrap, local_server_tester.listener, &drain_options));
+    ASSERT_ERROR(
+        AWS_ERROR_INVALID_STATE,
+        aws_server_bootstrap_drain_socket_listener(
+            local_server_tester.server_bootstrap, local_server_tester.listener, &drain_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_drained_predicate, &drain_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_TRUE(rw_handler_drain_called(incoming_rw_handler));
+
+    if (shutdown_on_drain) {
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, drain_args.error_code);
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, incoming_args.error_code);
+    } else {
+        ASSERT_INT_EQUALS(AWS_IO_CHANNEL_DRAIN_TIMEOUT, drain_args.error_code);
+        ASSERT_INT_EQUALS(AWS_IO_CHANNEL_DRAIN_TIMEOUT, incoming_args.error_code);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_socket_handler_drain_listener_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_socket_handler_drain_listener_common(allocator, true);
+}
+
+AWS_TEST_CASE(socket_handler_drain_listener, s_socket_handler_drain_listener_test)
+
+static int s_socket_handler_drain_listener_timeout_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_socket_handler_drain_listener_common(allocator, false);
+}
+
+AWS_TEST_CASE(socket_handler_drain_listener_timeout, s_socket_handler_drain_listener_timeout_test)
+
+enum {
+    READ_TURN_TEST_CHUNK_SIZE = 8 * 1024,
+    READ_TURN_TEST_CHUNK_COUNT = 32,
+    READ_TURN_TEST_TOTAL_SIZE = READ_TURN_TEST_CHUNK_SIZE * READ_TURN_TEST_CHUNK_COUNT,
+};
+
+/* The server reads a transfer many times its max read size at low priority, and with a read budget of a single byte
+ * per tick, so every read after the first happens on a read turn of its own. */
+static int s_socket_handler_read_turns_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    size_t original_read_budget = g_aws_channel_read_budget_per_tick;
+    g_aws_channel_read_budget_per_tick = 1;
+
+    uint8_t chunk[READ_TURN_TEST_CHUNK_SIZE];
+    for (size_t i = 0; i < sizeof(chunk); ++i) {
+        chunk[i] = (uint8_t)(i % 251);
+    }
+    struct aws_byte_buf write_chunk = aws_byte_buf_from_array(chunk, sizeof(chunk));
+
+    struct aws_byte_buf incoming_received_message;
+    ASSERT_SUCCESS(aws_byte_buf_init(&incoming_received_message, allocator, READ_TURN_TEST_TOTAL_SIZE));
+    uint8_t outgoing_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(&incoming_rw_args, &c_tester, incoming_received_message, READ_TURN_TEST_TOTAL_SIZE));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, SIZE_MAX, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+    incoming_args.read_priority = AWS_CHANNEL_READ_PRIORITY_LOW;
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+    ASSERT_INT_EQUALS(AWS_CHANNEL_READ_PRIORITY_LOW, aws_channel_get_read_priority(incoming_args.channel));
+    ASSERT_INT_EQUALS(AWS_CHANNEL_READ_PRIORITY_NORMAL, aws_channel_get_read_priority(outgoing_args.channel));
+
+    for (size_t i = 0; i < READ_TURN_TEST_CHUNK_COUNT; ++i) {
+        rw_handler_write(outgoing_args.rw_handler, aws_atomic_load_ptr(&outgoing_args.rw_slot), &write_chunk);
+    }
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+
+    for (size_t i = 0; i < READ_TURN_TEST_CHUNK_COUNT; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            chunk,
+            sizeof(chunk),
+            incoming_rw_args.received_message.buffer + i * READ_TURN_TEST_CHUNK_SIZE,
+            READ_TURN_TEST_CHUNK_SIZE);
+    }
+
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    aws_byte_buf_clean_up(&incoming_received_message);
+    g_aws_channel_read_budget_per_tick = original_read_budget;
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_read_turns, s_socket_handler_read_turns_test)
+
+struct migrate_test_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_channel *channel;
+    struct aws_event_loop *target_loop;
+    struct aws_channel_task task;
+    int error_code;
+    bool on_target_thread;
+    bool migrated;
+};
+
+static bool s_channel_migrated_predicate(void *user_data) {
+    struct migrate_test_args *migrate_args = user_data;
+    return migrate_args->migrated;
+}
+
+static void s_on_channel_migrated(struct aws_channel *channel, int error_code, void *user_data) {
+    (void)channel;
+
+    struct migrate_test_args *migrate_args = user_data;
+    aws_mutex_lock(migrate_args->mutex);
+    migrate_args->error_code = error_code;
+    migrate_args->on_target_thread = aws_event_loop_thread_is_callers_thread(migrate_args->target_loop);
+    migrate_args->migrated = true;
+    aws_mutex_unlock(migrate_args->mutex);
+    aws_condition_variable_notify_one(migrate_args->condition_variable);
+}
+
+static void s_migrate_channel_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+
+    struct migrate_test_args *migrate_args = arg;
+    if (status == AWS_TASK_STATUS_RUN_READY &&
+        !aws_channel_migrate(migrate_args->channel, migrate_args->target_loop, s_on_channel_migrated, migrate_args)) {
+        return;
+    }
+
+    aws_mutex_lock(migrate_args->mutex);
+    migrate_args->error_code = status == AWS_TASK_STATUS_RUN_READY ? aws_last_error() : AWS_IO_EVENT_LOOP_SHUTDOWN;
+    migrate_args->migrated = true;
+    aws_mutex_unlock(migrate_args->mutex);
+    aws_condition_variable_notify_one(migrate_args->condition_variable);
+}
+
+/* Moves the server's end of a connection to the group's other loop, then checks data still flows both ways. */
+static int s_socket_handler_migrate_channel_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+    aws_event_loop_group_release(c_tester.el_group);
+    c_tester.el_group = aws_event_loop_group_new_default(allocator, 2, NULL);
+    ASSERT_NOT_NULL(c_tester.el_group);
+
+    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    uint8_t incoming_received_message[128] = {0};
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        (int)write_tag.len));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        (int)read_tag.len));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    struct aws_event_loop *original_loop = aws_channel_get_event_loop(incoming_args.channel);
+    struct aws_event_loop *first_loop = aws_event_loop_group_get_loop_at(c_tester.el_group, 0);
+    struct migrate_test_args migrate_args = {
+        .mutex = &c_tester.mutex,
+        .condition_variable = &c_tester.condition_variable,
+        .channel = incoming_args.channel,
+        .target_loop =
+            original_loop == first_loop ? aws_event_loop_group_get_loop_at(c_tester.el_group, 1) : first_loop,
+    };
+    aws_channel_task_init(&migrate_args.task, s_migrate_channel_task, &migrate_args, "migrate_channel_test");
+    aws_channel_schedule_task_now(incoming_args.channel, &migrate_args.task);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_migrated_predicate, &migrate_args));
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, migrate_args.error_code);
+    ASSERT_TRUE(migrate_args.on_target_thread);
+    ASSERT_PTR_EQUALS(migrate_args.target_loop, aws_channel_get_event_loop(incoming_args.channel));
+
+    /* the socket now notifies the new loop, and tasks from other threads land there too */
+    rw_handler_write(outgoing_args.rw_handler, aws_atomic_load_ptr(&outgoing_args.rw_slot), &write_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+
+    rw_handler_write(incoming_args.rw_handler, aws_atomic_load_ptr(&incoming_args.rw_slot), &read_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &outgoing_rw_args));
+
+    ASSERT_BIN_ARRAYS_EQUALS(
+        write_tag.buffer,
+        write_tag.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        read_tag.buffer, read_tag.len, outgoing_rw_args.received_message.buffer, outgoing_rw_args.received_message.len);
+
+    ASSERT_SUCCESS(aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_migrate_channel, s_socket_handler_migrate_channel_test)
+
+#define TRACE_TEST_MAX_EVENTS 16
+
+struct trace_test_recorder {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_connection_trace_event events[TRACE_TEST_MAX_EVENTS];
+    size_t event_count;
+    bool closed;
+};
+
+static void s_trace_test_on_event(const struct aws_connection_trace_event *event, void *user_data) {
+    struct trace_test_recorder *recorder = user_data;
+
+    aws_mutex_lock(recorder->mutex);
+    if (recorder->event_count < TRACE_TEST_MAX_EVENTS) {
+        recorder->events[recorder->event_count++] = *event;
+    }
+    if (event->type == AWS_CONNECTION_TRACE_CLOSE) {
+        recorder->closed = true;
+    }
+    aws_mutex_unlock(recorder->mutex);
+
+    aws_condition_variable_notify_all(recorder->condition_variable);
+}
+
+static bool s_trace_test_closed_predicate(void *user_data) {
+    struct trace_test_recorder *recorder = user_data;
+    return recorder->closed;
+}
+
+static int s_check_trace(
+    const struct trace_test_recorder *recorder,
+    const enum aws_connection_trace_event_type *expected,
+    size_t expected_count) {
+    ASSERT_UINT_EQUALS(expected_count, recorder->event_count);
+
+    for (size_t i = 0; i < expected_count; ++i) {
+        const struct aws_connection_trace_event *event = &recorder->events[i];
+        ASSERT_INT_EQUALS(expected[i], event->type);
+        ASSERT_PTR_EQUALS(recorder->events[0].connection, event->connection);
+        /* the side that didn't shut down sees its socket closed */
+        if (event->type != AWS_CONNECTION_TRACE_CLOSE) {
+            ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, event->error_code);
+        }
+        if (i > 0) {
+            ASSERT_TRUE(event->timestamp_ns >= recorder->events[i - 1].timestamp_ns);
+        }
+        if (event->type == AWS_CONNECTION_TRACE_FIRST_BYTE || event->type == AWS_CONNECTION_TRACE_CLOSE) {
+            ASSERT_NOT_NULL(event->channel);
+        }
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_socket_handler_connection_tracer_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
+
+    uint8_t outgoing_received_message[128];
+    uint8_t incoming_received_message[128];
+
+    struct socket_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
+        (int)write_tag.len));
+
+    struct socket_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message)),
+        0));
+
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    struct socket_test_args incoming_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
+
+    struct socket_test_args outgoing_args;
+    ASSERT_SUCCESS(s_socket_test_args_init(&outgoing_args, &c_tester, outgoing_rw_handler));
+
+    struct local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(client_bootstrap);
+
+    struct trace_test_recorder client_trace = {
+        .mutex = &c_tester.mutex,
+        .condition_variable = &c_tester.condition_variable,
+    };
+    struct trace_test_recorder server_trace = client_trace;
+
+    struct aws_connection_tracer client_tracer = {.on_event = s_trace_test_on_event, .user_data = &client_trace};
+    struct aws_connection_tracer server_tracer = {.on_event = s_trace_test_on_event, .user_data = &server_trace};
+    aws_client_bootstrap_set_tracer(client_bootstrap, &client_tracer);
+    /* nothing has connected to the listener yet */
+    aws_server_bootstrap_set_tracer(local_server_tester.server_bootstrap, &server_tracer);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    /* the first attempt is traced on this thread, which mustn't hold the recorder's lock yet */
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
+
+    /* only the server reads anything, so only it reports a first byte */
+    rw_handler_write(outgoing_args.rw_handler, aws_atomic_load_ptr(&outgoing_args.rw_slot), &write_tag);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &server_trace));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &client_trace));
+
+    enum aws_connection_trace_event_type expected_client[] = {
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+        AWS_CONNECTION_TRACE_CLOSE,
+    };
+    ASSERT_SUCCESS(s_check_trace(&client_trace, expected_client, AWS_ARRAY_SIZE(expected_client)));
+
+    enum aws_connection_trace_event_type expected_server[] = {
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+        AWS_CONNECTION_TRACE_FIRST_BYTE,
+        AWS_CONNECTION_TRACE_CLOSE,
+    };
+    ASSERT_SUCCESS(s_check_trace(&server_trace, expected_server, AWS_ARRAY_SIZE(expected_server)));
+
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
+
+    aws_mutex_unlock(&c_tester.mutex);
+
+    ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
+
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_connection_tracer, s_socket_handler_connection_tracer_test)
+
+enum { BOOTSTRAP_TEST_MAX_CHANNELS = 4 };
+
+/* the server can accept a warm connection before the client's connect callback has put it in standby */
+#define WARM_POOL_TEST_SETTLE_NS (100 * 1000 * 1000)
+
+struct bootstrap_test_args {
+    struct aws_channel *client_channel;
+    struct aws_channel *server_channels[BOOTSTRAP_TEST_MAX_CHANNELS];
+    bool server_shut_down[BOOTSTRAP_TEST_MAX_CHANNELS];
+    size_t client_setup_count;
+    size_t server_setup_count;
+    size_t server_shutdown_count;
+    int error_code;
+    bool client_shut_down;
+    bool listener_destroyed;
+    /* the server shuts every channel down as soon as it's set up */
+    bool close_on_accept;
+};
+
+static void s_bootstrap_test_client_setup_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+
+    struct bootstrap_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->error_code = error_code;
+    args->client_channel = channel;
+    args->client_setup_count++;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_bootstrap_test_client_shutdown_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+    (void)channel;
+
+    struct bootstrap_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->client_shut_down = true;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_bootstrap_test_server_setup_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+
+    struct bootstrap_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    if (error_code) {
+        args->error_code = error_code;
+    } else if (args->server_setup_count < BOOTSTRAP_TEST_MAX_CHANNELS) {
+        args->server_channels[args->server_setup_count++] = channel;
+        if (args->close_on_accept) {
+            aws_channel_shutdown(channel, AWS_OP_SUCCESS);
+        }
+    }
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_bootstrap_test_server_shutdown_callback(
+    struct aws_server_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    (void)bootstrap;
+    (void)error_code;
+
+    struct bootstrap_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    for (size_t i = 0; i < args->server_setup_count; ++i) {
+        if (args->server_channels[i] == channel) {
+            args->server_shut_down[i] = true;
+        }
+    }
+    args->server_shutdown_count++;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static void s_bootstrap_test_listener_destroy_callback(struct aws_server_bootstrap *bootstrap, void *user_data) {
+    (void)bootstrap;
+
+    struct bootstrap_test_args *args = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    args->listener_destroyed = true;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+struct bootstrap_test_count {
+    struct bootstrap_test_args *args;
+    size_t count;
+};
+
+static bool s_bootstrap_test_server_setups_predicate(void *user_data) {
+    struct bootstrap_test_count *wait = user_data;
+    return wait->args->server_setup_count >= wait->count;
+}
+
+static bool s_bootstrap_test_server_shutdowns_predicate(void *user_data) {
+    struct bootstrap_test_count *wait = user_data;
+    return wait->args->server_shutdown_count >= wait->count;
+}
+
+static bool s_bootstrap_test_client_setup_predicate(void *user_data) {
+    struct bootstrap_test_args *args = user_data;
+    return args->client_setup_count > 0;
+}
+
+static bool s_bootstrap_test_client_shutdown_predicate(void *user_data) {
+    struct bootstrap_test_args *args = user_data;
+    return args->client_shut_down;
+}
+
+static bool s_bootstrap_test_first_server_shutdown_predicate(void *user_data) {
+    struct bootstrap_test_args *args = user_data;
+    return args->server_shut_down[0];
+}
+
+static bool s_bootstrap_test_listener_destroyed_predicate(void *user_data) {
+    struct bootstrap_test_args *args = user_data;
+    return args->listener_destroyed;
+}
+
+static bool s_trace_has_event(const struct trace_test_recorder *recorder, enum aws_connection_trace_event_type type) {
+    for (size_t i = 0; i < recorder->event_count; ++i) {
+        if (recorder->events[i].type == type) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* common state for the warm pool tests: a tcp listener on 127.0.0.1 and a client bootstrap with a real resolver. */
+struct warm_pool_tester {
+    struct aws_socket_options socket_options;
+    struct aws_server_bootstrap *server_bootstrap;
+    struct aws_socket *listener;
+    struct aws_host_resolver *resolver;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct trace_test_recorder client_trace;
+    struct aws_connection_tracer client_tracer;
+    uint16_t port;
+};
+
+static int s_warm_pool_tester_init(
+    struct aws_allocator *allocator,
+    struct warm_pool_tester *tester,
+    struct bootstrap_test_args *args,
+    uint16_t port) {
+
+    AWS_ZERO_STRUCT(*tester);
+    tester->socket_options.type = AWS_SOCKET_STREAM;
+    tester->socket_options.domain = AWS_SOCKET_IPV4;
+    tester->socket_options.connect_timeout_ms = 3000;
+    tester->port = port;
+
+    tester->server_bootstrap = aws_server_bootstrap_new(allocator, c_tester.el_group);
+    ASSERT_NOT_NULL(tester->server_bootstrap);
+
+    struct aws_server_socket_channel_bootstrap_options server_options = {
+        .bootstrap = tester->server_bootstrap,
+        .host_name = "127.0.0.1",
+        .port = port,
+        .socket_options = &tester->socket_options,
+        .incoming_callback = s_bootstrap_test_server_setup_callback,
+        .shutdown_callback = s_bootstrap_test_server_shutdown_callback,
+        .destroy_callback = s_bootstrap_test_listener_destroy_callback,
+        .user_data = args,
+    };
+    tester->listener = aws_server_bootstrap_new_socket_listener(&server_options);
+    ASSERT_NOT_NULL(tester->listener);
+
+    tester->resolver = aws_host_resolver_new_default(allocator, 8, c_tester.el_group, NULL);
+    ASSERT_NOT_NULL(tester->resolver);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = tester->resolver,
+    };
+    tester->client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(tester->client_bootstrap);
+
+    tester->client_trace.mutex = &c_tester.mutex;
+    tester->client_trace.condition_variable = &c_tester.condition_variable;
+    tester->client_tracer.on_event = s_trace_test_on_event;
+    tester->client_tracer.user_data = &tester->client_trace;
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_warm_pool_tester_new_channel(struct warm_pool_tester *tester, struct bootstrap_test_args *args) {
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = tester->client_bootstrap;
+    channel_options.host_name = "127.0.0.1";
+    channel_options.port = tester->port;
+    channel_options.socket_options = &tester->socket_options;
+    channel_options.setup_callback = s_bootstrap_test_client_setup_callback;
+    channel_options.shutdown_callback = s_bootstrap_test_client_shutdown_callback;
+    channel_options.user_data = args;
+
+    /* only the channel is traced, the pool's own connections aren't */
+    aws_client_bootstrap_set_tracer(tester->client_bootstrap, &tester->client_tracer);
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    return AWS_OP_SUCCESS;
+}
+
+/* releasing the client bootstrap shuts its pool down, which closes whatever is still in standby. */
+static int s_warm_pool_tester_clean_up(
+    struct warm_pool_tester *tester,
+    struct bootstrap_test_args *args,
+    size_t expected_server_channels) {
+
+    aws_client_bootstrap_release(tester->client_bootstrap);
+
+    struct bootstrap_test_count all_shut_down = {.args = args, .count = expected_server_channels};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_shutdowns_predicate, &all_shut_down));
+    ASSERT_UINT_EQUALS(expected_server_channels, args->server_setup_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    aws_server_bootstrap_destroy_socket_listener(tester->server_bootstrap, tester->listener);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_listener_destroyed_predicate, args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    aws_host_resolver_release(tester->resolver);
+    aws_server_bootstrap_release(tester->server_bootstrap);
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * Test that a channel to a pooled endpoint is built on the socket already in standby, without resolving or connecting,
+ * and that the pool connects a replacement.
+ */
+static int s_socket_handler_warm_pool_handout_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    struct bootstrap_test_args args;
+    AWS_ZERO_STRUCT(args);
+
+    struct warm_pool_tester tester;
+    ASSERT_SUCCESS(s_warm_pool_tester_init(allocator, &tester, &args, 8141));
+
+    struct aws_client_bootstrap_warm_pool_options pool_options = {
+        .host_name = "127.0.0.1",
+        .port = tester.port,
+        .socket_options = &tester.socket_options,
+        .size = 1,
+    };
+    ASSERT_SUCCESS(aws_client_bootstrap_add_warm_pool(tester.client_bootstrap, &pool_options));
+
+    struct bootstrap_test_count one_accepted = {.args = &args, .count = 1};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_setups_predicate, &one_accepted));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    aws_thread_current_sleep(WARM_POOL_TEST_SETTLE_NS);
+
+    ASSERT_SUCCESS(s_warm_pool_tester_new_channel(&tester, &args));
+
+    /* the handout makes room in the pool, so a second connection shows up at the server */
+    struct bootstrap_test_count refilled = {.args = &args, .count = 2};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_setup_predicate, &args));
+    ASSERT_SUCCESS(args.error_code);
+    ASSERT_NOT_NULL(args.client_channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_setups_predicate, &refilled));
+
+    /* closing the client's channel closes the server's first channel, the one that was kept warm */
+    aws_channel_shutdown(args.client_channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &tester.client_trace));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_first_server_shutdown_predicate, &args));
+    ASSERT_FALSE(args.server_shut_down[1]);
+    ASSERT_UINT_EQUALS(2, args.server_setup_count);
+
+    enum aws_connection_trace_event_type expected_client[] = {
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+        AWS_CONNECTION_TRACE_CLOSE,
+    };
+    ASSERT_SUCCESS(s_check_trace(&tester.client_trace, expected_client, AWS_ARRAY_SIZE(expected_client)));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_warm_pool_tester_clean_up(&tester, &args, 2));
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_warm_pool_handout, s_socket_handler_warm_pool_handout_test)
+
+/*
+ * Test that a standby socket older than max_idle_ms is closed rather than handed out, and the channel connects the
+ * usual way instead.
+ */
+static int s_socket_handler_warm_pool_max_idle_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    struct bootstrap_test_args args;
+    AWS_ZERO_STRUCT(args);
+
+    struct warm_pool_tester tester;
+    ASSERT_SUCCESS(s_warm_pool_tester_init(allocator, &tester, &args, 8142));
+
+    struct aws_client_bootstrap_warm_pool_options pool_options = {
+        .host_name = "127.0.0.1",
+        .port = tester.port,
+        .socket_options = &tester.socket_options,
+        .size = 1,
+        .max_idle_ms = 50,
+    };
+    ASSERT_SUCCESS(aws_client_bootstrap_add_warm_pool(tester.client_bootstrap, &pool_options));
+
+    struct bootstrap_test_count one_accepted = {.args = &args, .count = 1};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_setups_predicate, &one_accepted));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    /* well past max_idle_ms */
+    aws_thread_current_sleep(2 * WARM_POOL_TEST_SETTLE_NS);
+
+    ASSERT_SUCCESS(s_warm_pool_tester_new_channel(&tester, &args));
+
+    /* the stale socket is closed, and both the channel's own connection and the pool's replacement get accepted */
+    struct bootstrap_test_count all_accepted = {.args = &args, .count = 3};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_first_server_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_setup_predicate, &args));
+    ASSERT_SUCCESS(args.error_code);
+    ASSERT_NOT_NULL(args.client_channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_setups_predicate, &all_accepted));
+
+    aws_channel_shutdown(args.client_channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &tester.client_trace));
 
-    struct socket_test_args *setup_test_args = (struct socket_test_args *)user_data;
+    /* the channel went through its own connect rather than starting at CONNECT_END */
+    ASSERT_TRUE(tester.client_trace.event_count > 0);
+    ASSERT_TRUE(tester.client_trace.events[0].type != AWS_CONNECTION_TRACE_CONNECT_END);
+    ASSERT_TRUE(s_trace_has_event(&tester.client_trace, AWS_CONNECTION_TRACE_CONNECT_START));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
-    setup_test_args->creation_callback_invoked = true;
+    ASSERT_SUCCESS(s_warm_pool_tester_clean_up(&tester, &args, 3));
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
 
-    struct aws_crt_statistics_handler *stats_handler = aws_statistics_handler_new_test(bootstrap->allocator);
-    aws_atomic_store_ptr(&c_tester.stats_handler, stats_handler);
+    return AWS_OP_SUCCESS;
+}
 
-    aws_channel_set_statistics_handler(channel, stats_handler);
+AWS_TEST_CASE(socket_handler_warm_pool_max_idle, s_socket_handler_warm_pool_max_idle_test)
+
+enum { STATIC_TEST_RESOLVER_MAX_ADDRESSES = 4 };
+
+struct static_test_address {
+    const char *address;
+    enum aws_address_record_type record_type;
+};
+
+/* answers every query with the same addresses, in the order given, from the event loop it's asked to answer on. */
+struct static_test_resolver {
+    struct aws_host_resolver base;
+    struct aws_string *host_name;
+    /* struct aws_host_address */
+    struct aws_array_list addresses;
+    /* addresses passed to aws_host_resolver_record_connection_failure(), in order. Guarded by c_tester.mutex */
+    struct aws_socket_endpoint failed[STATIC_TEST_RESOLVER_MAX_ADDRESSES];
+    size_t failed_count;
+    bool destroyed;
+};
+
+struct static_test_resolution {
+    struct aws_task task;
+    struct static_test_resolver *resolver;
+    aws_on_host_resolved_result_fn *res;
+    void *user_data;
+};
+
+static void s_static_test_resolver_destroy(struct aws_host_resolver *resolver) {
+    struct static_test_resolver *test_resolver = resolver->impl;
+    aws_mutex_lock(&c_tester.mutex);
+    test_resolver->destroyed = true;
+    aws_mutex_unlock(&c_tester.mutex);
 }
 
-static struct aws_event_loop *s_default_new_event_loop(
-    struct aws_allocator *allocator,
-    aws_io_clock_fn *clock,
+static void s_static_test_resolution_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct static_test_resolution *resolution = arg;
+    struct static_test_resolver *test_resolver = resolution->resolver;
+
+    int error_code = status == AWS_TASK_STATUS_RUN_READY ? AWS_ERROR_SUCCESS : AWS_IO_EVENT_LOOP_SHUTDOWN;
+    resolution->res(
+        &test_resolver->base, test_resolver->host_name, error_code, &test_resolver->addresses, resolution->user_data);
+
+    aws_mem_release(test_resolver->base.allocator, resolution);
+}
+
+static int s_static_test_resolve_host_on_event_loop(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    struct aws_event_loop *event_loop,
     void *user_data) {
 
-    (void)user_data;
-    return aws_event_loop_new_default(allocator, clock);
+    (void)host_name;
+    (void)config;
+
+    struct static_test_resolution *resolution =
+        aws_mem_calloc(resolver->allocator, 1, sizeof(struct static_test_resolution));
+    if (!resolution) {
+        return AWS_OP_ERR;
+    }
+
+    resolution->resolver = resolver->impl;
+    resolution->res = res;
+    resolution->user_data = user_data;
+    aws_task_init(&resolution->task, s_static_test_resolution_task, resolution, "static_test_resolution");
+    aws_event_loop_schedule_task_now(event_loop, &resolution->task);
+
+    return AWS_OP_SUCCESS;
 }
 
-static int s_statistic_test_clock_fn(uint64_t *timestamp) {
-    *timestamp = aws_atomic_load_int(&c_tester.current_time_ns);
+static int s_static_test_resolve_host(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    aws_on_host_resolved_result_fn *res,
+    struct aws_host_resolution_config *config,
+    void *user_data) {
+
+    return s_static_test_resolve_host_on_event_loop(
+        resolver, host_name, res, config, aws_event_loop_group_get_next_loop(c_tester.el_group), user_data);
+}
+
+static int s_static_test_record_connection_failure(
+    struct aws_host_resolver *resolver,
+    struct aws_host_address *address) {
+
+    struct static_test_resolver *test_resolver = resolver->impl;
+    aws_mutex_lock(&c_tester.mutex);
+    if (test_resolver->failed_count < STATIC_TEST_RESOLVER_MAX_ADDRESSES) {
+        struct aws_socket_endpoint *failed = &test_resolver->failed[test_resolver->failed_count++];
+        snprintf(failed->address, sizeof(failed->address), "%s", aws_string_c_str(address->address));
+    }
+    aws_mutex_unlock(&c_tester.mutex);
 
     return AWS_OP_SUCCESS;
 }
 
-static int s_socket_common_tester_statistics_init(
+static int s_static_test_purge_cache(struct aws_host_resolver *resolver) {
+    (void)resolver;
+    return AWS_OP_SUCCESS;
+}
+
+static size_t s_static_test_get_host_address_count(
+    struct aws_host_resolver *resolver,
+    const struct aws_string *host_name,
+    uint32_t flags) {
+
+    (void)host_name;
+    (void)flags;
+
+    struct static_test_resolver *test_resolver = resolver->impl;
+    return aws_array_list_length(&test_resolver->addresses);
+}
+
+static struct aws_host_resolver_vtable s_static_test_resolver_vtable = {
+    .destroy = s_static_test_resolver_destroy,
+    .resolve_host = s_static_test_resolve_host,
+    .record_connection_failure = s_static_test_record_connection_failure,
+    .purge_cache = s_static_test_purge_cache,
+    .get_host_address_count = s_static_test_get_host_address_count,
+    .resolve_host_on_event_loop = s_static_test_resolve_host_on_event_loop,
+};
+
+static int s_static_test_resolver_init(
     struct aws_allocator *allocator,
-    struct socket_common_tester *tester) {
+    struct static_test_resolver *test_resolver,
+    const char *host_name,
+    const struct static_test_address *addresses,
+    size_t address_count) {
+
+    AWS_ZERO_STRUCT(*test_resolver);
+    test_resolver->base.allocator = allocator;
+    test_resolver->base.impl = test_resolver;
+    test_resolver->base.vtable = &s_static_test_resolver_vtable;
+    aws_ref_count_init(
+        &test_resolver->base.ref_count,
+        &test_resolver->base,
+        (aws_simple_completion_callback *)s_static_test_resolver_destroy);
+
+    test_resolver->host_name = aws_string_new_from_c_str(allocator, host_name);
+    ASSERT_NOT_NULL(test_resolver->host_name);
+    ASSERT_SUCCESS(aws_array_list_init_dynamic(
+        &test_resolver->addresses, allocator, address_count, sizeof(struct aws_host_address)));
+
+    for (size_t i = 0; i < address_count; ++i) {
+        struct aws_host_address host_address = {
+            .allocator = allocator,
+            .host = aws_string_new_from_string(allocator, test_resolver->host_name),
+            .address = aws_string_new_from_c_str(allocator, addresses[i].address),
+            .record_type = addresses[i].record_type,
+        };
+        ASSERT_SUCCESS(aws_array_list_push_back(&test_resolver->addresses, &host_address));
+    }
 
-    aws_io_library_init(allocator);
+    return AWS_OP_SUCCESS;
+}
+
+static void s_static_test_resolver_clean_up(struct static_test_resolver *test_resolver) {
+    for (size_t i = 0; i < aws_array_list_length(&test_resolver->addresses); ++i) {
+        struct aws_host_address *host_address = NULL;
+        aws_array_list_get_at_ptr(&test_resolver->addresses, (void **)&host_address, i);
+        aws_host_address_clean_up(host_address);
+    }
+    aws_array_list_clean_up(&test_resolver->addresses);
+    aws_string_destroy(test_resolver->host_name);
+}
+
+/*
+ * A tcp listener that never accepts, with its backlog already taken up by a connection of its own. The kernel drops
+ * any further SYNs, so connecting to it never completes until the connect times out.
+ */
+struct unresponsive_listener {
+    struct aws_socket listener;
+    struct aws_socket filler;
+    int filler_error_code;
+    bool filler_connected;
+};
+
+static void s_unresponsive_listener_on_filler_connected(struct aws_socket *socket, int error_code, void *user_data) {
+    (void)socket;
+
+    struct unresponsive_listener *unresponsive = user_data;
+    aws_mutex_lock(&c_tester.mutex);
+    unresponsive->filler_error_code = error_code;
+    unresponsive->filler_connected = true;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    aws_mutex_unlock(&c_tester.mutex);
+}
+
+static bool s_unresponsive_listener_filled_predicate(void *user_data) {
+    struct unresponsive_listener *unresponsive = user_data;
+    return unresponsive->filler_connected;
+}
+
+static int s_unresponsive_listener_init(
+    struct aws_allocator *allocator,
+    struct unresponsive_listener *unresponsive,
+    enum aws_socket_domain domain,
+    const char *address,
+    uint16_t port) {
+
+    AWS_ZERO_STRUCT(*unresponsive);
+
+    struct aws_socket_options options = {
+        .type = AWS_SOCKET_STREAM,
+        .domain = domain,
+        .connect_timeout_ms = 3000,
+    };
+    struct aws_socket_endpoint endpoint = {.port = port};
+    snprintf(endpoint.address, sizeof(endpoint.address), "%s", address);
+
+    ASSERT_SUCCESS(aws_socket_init(&unresponsive->listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&unresponsive->listener, &endpoint));
+    /* a backlog of 0 still has room for one connection, the filler's */
+    ASSERT_SUCCESS(aws_socket_listen(&unresponsive->listener, 0));
+
+    ASSERT_SUCCESS(aws_socket_init(&unresponsive->filler, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(
+        &unresponsive->filler,
+        &endpoint,
+        aws_event_loop_group_get_next_loop(c_tester.el_group),
+        s_unresponsive_listener_on_filler_connected,
+        unresponsive));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_unresponsive_listener_filled_predicate, unresponsive));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_SUCCESS(unresponsive->filler_error_code);
+
+    return AWS_OP_SUCCESS;
+}
+
+static void s_unresponsive_listener_clean_up(struct unresponsive_listener *unresponsive) {
+    aws_socket_close(&unresponsive->filler);
+    aws_socket_clean_up(&unresponsive->filler);
+    aws_socket_close(&unresponsive->listener);
+    aws_socket_clean_up(&unresponsive->listener);
+}
+
+#define HAPPY_EYEBALLS_TEST_HOST "happy-eyeballs.test"
+
+static size_t s_trace_count_events(
+    const struct trace_test_recorder *recorder,
+    enum aws_connection_trace_event_type type) {
+    size_t count = 0;
+    for (size_t i = 0; i < recorder->event_count; ++i) {
+        if (recorder->events[i].type == type) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static int s_check_trace_types(
+    const struct trace_test_recorder *recorder,
+    const enum aws_connection_trace_event_type *expected,
+    size_t expected_count) {
+    ASSERT_UINT_EQUALS(expected_count, recorder->event_count);
+
+    for (size_t i = 0; i < expected_count; ++i) {
+        ASSERT_INT_EQUALS(expected[i], recorder->events[i].type);
+    }
+
+    return AWS_OP_SUCCESS;
+}
+
+/* a server listener on 127.0.0.1 and a client bootstrap that resolves HAPPY_EYEBALLS_TEST_HOST with test_resolver. */
+struct happy_eyeballs_tester {
+    struct aws_socket_options socket_options;
+    struct aws_server_bootstrap *server_bootstrap;
+    struct aws_socket *listener;
+    struct aws_client_bootstrap *client_bootstrap;
+    struct trace_test_recorder client_trace;
+    struct aws_connection_tracer client_tracer;
+    uint16_t port;
+};
+
+static int s_happy_eyeballs_tester_init(
+    struct aws_allocator *allocator,
+    struct happy_eyeballs_tester *tester,
+    struct bootstrap_test_args *args,
+    struct static_test_resolver *test_resolver,
+    uint16_t port,
+    uint32_t connect_timeout_ms,
+    uint32_t connection_attempt_delay_ms) {
 
     AWS_ZERO_STRUCT(*tester);
-    tester->el_group =
-        aws_event_loop_group_new(allocator, s_statistic_test_clock_fn, 1, s_default_new_event_loop, NULL, NULL);
-    struct aws_mutex mutex = AWS_MUTEX_INIT;
-    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
-    tester->mutex = mutex;
-    tester->condition_variable = condition_variable;
-    aws_atomic_store_int(&tester->current_time_ns, 0);
-    aws_atomic_store_ptr(&tester->stats_handler, NULL);
+    tester->socket_options.type = AWS_SOCKET_STREAM;
+    tester->socket_options.domain = AWS_SOCKET_IPV4;
+    tester->socket_options.connect_timeout_ms = connect_timeout_ms;
+    tester->port = port;
+
+    if (args) {
+        tester->server_bootstrap = aws_server_bootstrap_new(allocator, c_tester.el_group);
+        ASSERT_NOT_NULL(tester->server_bootstrap);
+
+        struct aws_server_socket_channel_bootstrap_options server_options = {
+            .bootstrap = tester->server_bootstrap,
+            .host_name = "127.0.0.1",
+            .port = port,
+            .socket_options = &tester->socket_options,
+            .incoming_callback = s_bootstrap_test_server_setup_callback,
+            .shutdown_callback = s_bootstrap_test_server_shutdown_callback,
+            .destroy_callback = s_bootstrap_test_listener_destroy_callback,
+            .user_data = args,
+        };
+        tester->listener = aws_server_bootstrap_new_socket_listener(&server_options);
+        ASSERT_NOT_NULL(tester->listener);
+    }
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = &test_resolver->base,
+        .connection_attempt_delay_ms = connection_attempt_delay_ms,
+    };
+    tester->client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+    ASSERT_NOT_NULL(tester->client_bootstrap);
+    /* the bootstrap holds its own reference now */
+    aws_host_resolver_release(&test_resolver->base);
+
+    tester->client_trace.mutex = &c_tester.mutex;
+    tester->client_trace.condition_variable = &c_tester.condition_variable;
+    tester->client_tracer.on_event = s_trace_test_on_event;
+    tester->client_tracer.user_data = &tester->client_trace;
+    aws_client_bootstrap_set_tracer(tester->client_bootstrap, &tester->client_tracer);
 
     return AWS_OP_SUCCESS;
 }
 
-static bool s_stats_processed_predicate(void *user_data) {
-    struct aws_crt_statistics_handler *stats_handler = user_data;
-    struct aws_statistics_handler_test_impl *stats_impl = stats_handler->impl;
+static int s_happy_eyeballs_tester_connect(
+    struct happy_eyeballs_tester *tester,
+    struct bootstrap_test_args *args,
+    const struct aws_tls_connection_options *tls_options) {
 
-    return stats_impl->total_bytes_read > 0 && stats_impl->total_bytes_written > 0;
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = tester->client_bootstrap;
+    channel_options.host_name = HAPPY_EYEBALLS_TEST_HOST;
+    channel_options.port = tester->port;
+    channel_options.socket_options = &tester->socket_options;
+    channel_options.tls_options = tls_options;
+    channel_options.setup_callback = s_bootstrap_test_client_setup_callback;
+    channel_options.shutdown_callback = s_bootstrap_test_client_shutdown_callback;
+    channel_options.user_data = args;
+
+    /* DNS_START is traced on this thread, which mustn't hold the recorder's lock */
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    return AWS_OP_SUCCESS;
 }
 
-static int s_open_channel_statistics_test(struct aws_allocator *allocator, void *ctx) {
+static int s_happy_eyeballs_tester_clean_up(struct happy_eyeballs_tester *tester, struct bootstrap_test_args *args) {
+    if (tester->listener) {
+        aws_server_bootstrap_destroy_socket_listener(tester->server_bootstrap, tester->listener);
+        ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_listener_destroyed_predicate, args));
+        ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    }
+
+    aws_client_bootstrap_release(tester->client_bootstrap);
+    aws_server_bootstrap_release(tester->server_bootstrap);
+
+    return AWS_OP_SUCCESS;
+}
+
+#define HAPPY_EYEBALLS_TEST_DELAY_MS 300
+
+/*
+ * Test a race over three addresses: an IPv6 one that never answers, an IPv4 one that refuses and an IPv4 one that
+ * accepts. The IPv6 address goes first even though it resolved last, the refusing one follows after the attempt delay,
+ * and its failure starts the third attempt right away. The third attempt wins and the first one is closed, without
+ * counting as a failed address.
+ */
+static int s_socket_handler_happy_eyeballs_later_attempt_wins_test(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
 
-    s_socket_common_tester_statistics_init(allocator, &c_tester);
+    s_socket_common_tester_init(allocator, &c_tester);
 
-    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("Some bytes");
-    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("Fresh pressed Washington apples");
+    const uint16_t port = 8143;
+
+    struct unresponsive_listener unresponsive;
+    ASSERT_SUCCESS(s_unresponsive_listener_init(allocator, &unresponsive, AWS_SOCKET_IPV6, "::1", port));
+
+    struct static_test_address addresses[] = {
+        {.address = "127.0.0.3", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+        {.address = "127.0.0.1", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+        {.address = "::1", .record_type = AWS_ADDRESS_RECORD_TYPE_AAAA},
+    };
+    struct static_test_resolver test_resolver;
+    ASSERT_SUCCESS(s_static_test_resolver_init(
+        allocator, &test_resolver, HAPPY_EYEBALLS_TEST_HOST, addresses, AWS_ARRAY_SIZE(addresses)));
+
+    struct bootstrap_test_args args;
+    AWS_ZERO_STRUCT(args);
+
+    struct happy_eyeballs_tester tester;
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_init(
+        allocator, &tester, &args, &test_resolver, port, 3000, HAPPY_EYEBALLS_TEST_DELAY_MS));
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_connect(&tester, &args, NULL));
+
+    struct bootstrap_test_count one_accepted = {.args = &args, .count = 1};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_setup_predicate, &args));
+    ASSERT_SUCCESS(args.error_code);
+    ASSERT_NOT_NULL(args.client_channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_setups_predicate, &one_accepted));
+
+    aws_channel_shutdown(args.client_channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_shutdown_predicate, &args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &tester.client_trace));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_shutdowns_predicate, &one_accepted));
+
+    /* the abandoned attempt never reports a CONNECT_END */
+    enum aws_connection_trace_event_type expected_client[] = {
+        AWS_CONNECTION_TRACE_DNS_START,
+        AWS_CONNECTION_TRACE_DNS_END,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+        AWS_CONNECTION_TRACE_CLOSE,
+    };
+    ASSERT_SUCCESS(s_check_trace_types(&tester.client_trace, expected_client, AWS_ARRAY_SIZE(expected_client)));
+
+    const struct aws_connection_trace_event *events = tester.client_trace.events;
+    uint64_t delay_ns =
+        aws_timestamp_convert(HAPPY_EYEBALLS_TEST_DELAY_MS, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+    /* an attempt is stamped when its task runs, a little after the delay before the next one starts counting */
+    ASSERT_TRUE(events[3].timestamp_ns - events[2].timestamp_ns >= delay_ns / 2);
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_CONNECTION_REFUSED, events[4].error_code);
+    ASSERT_TRUE(events[5].timestamp_ns - events[4].timestamp_ns < delay_ns / 2);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, events[6].error_code);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, events[7].error_code);
+
+    ASSERT_UINT_EQUALS(1, test_resolver.failed_count);
+    ASSERT_STR_EQUALS("127.0.0.3", test_resolver.failed[0].address);
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_clean_up(&tester, &args));
+    s_unresponsive_listener_clean_up(&unresponsive);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    /* every thread is gone, so nothing can still be on its way */
+    ASSERT_UINT_EQUALS(1, args.client_setup_count);
+    ASSERT_UINT_EQUALS(1, args.server_setup_count);
+    ASSERT_TRUE(test_resolver.destroyed);
+    s_static_test_resolver_clean_up(&test_resolver);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_happy_eyeballs_later_attempt_wins, s_socket_handler_happy_eyeballs_later_attempt_wins_test)
+
+/*
+ * Test that when every attempt fails, refused or timed out, the setup callback fires once, with the error from the
+ * last attempt to finish.
+ */
+static int s_socket_handler_happy_eyeballs_all_attempts_fail_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    const uint16_t port = 8144;
+
+    struct unresponsive_listener unresponsive;
+    ASSERT_SUCCESS(s_unresponsive_listener_init(allocator, &unresponsive, AWS_SOCKET_IPV4, "127.0.0.2", port));
+
+    struct static_test_address addresses[] = {
+        {.address = "127.0.0.2", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+        {.address = "127.0.0.3", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+        {.address = "127.0.0.4", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+    };
+    struct static_test_resolver test_resolver;
+    ASSERT_SUCCESS(s_static_test_resolver_init(
+        allocator, &test_resolver, HAPPY_EYEBALLS_TEST_HOST, addresses, AWS_ARRAY_SIZE(addresses)));
+
+    struct bootstrap_test_args args;
+    AWS_ZERO_STRUCT(args);
+
+    struct happy_eyeballs_tester tester;
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_init(allocator, &tester, NULL, &test_resolver, port, 500, 50));
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_connect(&tester, &args, NULL));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_setup_predicate, &args));
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_TIMEOUT, args.error_code);
+    ASSERT_NULL(args.client_channel);
+
+    /* both refusals come back before the first attempt times out */
+    enum aws_connection_trace_event_type expected_client[] = {
+        AWS_CONNECTION_TRACE_DNS_START,
+        AWS_CONNECTION_TRACE_DNS_END,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_SETUP_COMPLETE,
+    };
+    ASSERT_SUCCESS(s_check_trace_types(&tester.client_trace, expected_client, AWS_ARRAY_SIZE(expected_client)));
+    ASSERT_INT_EQUALS(AWS_IO_SOCKET_TIMEOUT, tester.client_trace.events[8].error_code);
+
+    ASSERT_UINT_EQUALS(3, test_resolver.failed_count);
+    ASSERT_STR_EQUALS("127.0.0.3", test_resolver.failed[0].address);
+    ASSERT_STR_EQUALS("127.0.0.4", test_resolver.failed[1].address);
+    ASSERT_STR_EQUALS("127.0.0.2", test_resolver.failed[2].address);
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_clean_up(&tester, &args));
+    s_unresponsive_listener_clean_up(&unresponsive);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    /* a failed setup never gets a shutdown callback */
+    ASSERT_UINT_EQUALS(1, args.client_setup_count);
+    ASSERT_FALSE(args.client_shut_down);
+    ASSERT_TRUE(test_resolver.destroyed);
+    s_static_test_resolver_clean_up(&test_resolver);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(socket_handler_happy_eyeballs_all_attempts_fail, s_socket_handler_happy_eyeballs_all_attempts_fail_test)
+
+/*
+ * Test that when the winning socket's channel setup fails, after the slower attempt has been abandoned, the setup
+ * callback still fires exactly once with the error. The server hangs up on the client's TLS handshake.
+ */
+static int s_socket_handler_happy_eyeballs_setup_fails_after_win_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    const uint16_t port = 8145;
+
+    struct unresponsive_listener unresponsive;
+    ASSERT_SUCCESS(s_unresponsive_listener_init(allocator, &unresponsive, AWS_SOCKET_IPV4, "127.0.0.2", port));
+
+    struct static_test_address addresses[] = {
+        {.address = "127.0.0.2", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+        {.address = "127.0.0.1", .record_type = AWS_ADDRESS_RECORD_TYPE_A},
+    };
+    struct static_test_resolver test_resolver;
+    ASSERT_SUCCESS(s_static_test_resolver_init(
+        allocator, &test_resolver, HAPPY_EYEBALLS_TEST_HOST, addresses, AWS_ARRAY_SIZE(addresses)));
+
+    struct bootstrap_test_args args;
+    AWS_ZERO_STRUCT(args);
+    args.close_on_accept = true;
+
+    struct aws_tls_ctx_options ctx_options;
+    aws_tls_ctx_options_init_default_client(&ctx_options, allocator);
+    struct aws_tls_ctx *tls_ctx = aws_tls_client_ctx_new(allocator, &ctx_options);
+    ASSERT_NOT_NULL(tls_ctx);
+
+    struct aws_tls_connection_options tls_options;
+    aws_tls_connection_options_init_from_ctx(&tls_options, tls_ctx);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str(HAPPY_EYEBALLS_TEST_HOST);
+    ASSERT_SUCCESS(aws_tls_connection_options_set_server_name(&tls_options, allocator, &server_name));
+
+    struct happy_eyeballs_tester tester;
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_init(allocator, &tester, &args, &test_resolver, port, 3000, 50));
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_connect(&tester, &args, &tls_options));
+
+    struct bootstrap_test_count one_accepted = {.args = &args, .count = 1};
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_client_setup_predicate, &args));
+    ASSERT_TRUE(args.error_code != AWS_ERROR_SUCCESS);
+    ASSERT_NULL(args.client_channel);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_trace_test_closed_predicate, &tester.client_trace));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_bootstrap_test_server_shutdowns_predicate, &one_accepted));
+
+    /* two attempts, the second one connected and the first one was closed without ever finishing */
+    enum aws_connection_trace_event_type expected_client[] = {
+        AWS_CONNECTION_TRACE_DNS_START,
+        AWS_CONNECTION_TRACE_DNS_END,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_START,
+        AWS_CONNECTION_TRACE_CONNECT_END,
+        AWS_CONNECTION_TRACE_TLS_START,
+    };
+    const struct aws_connection_trace_event *events = tester.client_trace.events;
+    size_t event_count = tester.client_trace.event_count;
+    ASSERT_TRUE(event_count >= AWS_ARRAY_SIZE(expected_client) + 2);
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(expected_client); ++i) {
+        ASSERT_INT_EQUALS(expected_client[i], events[i].type);
+    }
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, events[4].error_code);
+    ASSERT_UINT_EQUALS(2, s_trace_count_events(&tester.client_trace, AWS_CONNECTION_TRACE_CONNECT_START));
+    ASSERT_UINT_EQUALS(1, s_trace_count_events(&tester.client_trace, AWS_CONNECTION_TRACE_CONNECT_END));
+
+    /* whether the handshake reports its own end depends on the tls implementation, the setup always does */
+    ASSERT_INT_EQUALS(AWS_CONNECTION_TRACE_SETUP_COMPLETE, events[event_count - 2].type);
+    ASSERT_INT_EQUALS(args.error_code, events[event_count - 2].error_code);
+    ASSERT_INT_EQUALS(AWS_CONNECTION_TRACE_CLOSE, events[event_count - 1].type);
+
+    /* the abandoned address didn't fail, it just lost */
+    ASSERT_UINT_EQUALS(0, test_resolver.failed_count);
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_happy_eyeballs_tester_clean_up(&tester, &args));
+    s_unresponsive_listener_clean_up(&unresponsive);
+    aws_tls_connection_options_clean_up(&tls_options);
+    aws_tls_ctx_release(tls_ctx);
+    aws_tls_ctx_options_clean_up(&ctx_options);
+    ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
+
+    ASSERT_UINT_EQUALS(1, args.client_setup_count);
+    ASSERT_FALSE(args.client_shut_down);
+    ASSERT_UINT_EQUALS(1, args.server_setup_count);
+    ASSERT_TRUE(test_resolver.destroyed);
+    s_static_test_resolver_clean_up(&test_resolver);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(
+    socket_handler_happy_eyeballs_setup_fails_after_win,
+    s_socket_handler_happy_eyeballs_setup_fails_after_win_test)
+
+enum {
+    DIRECT_READ_TEST_CHUNK_SIZE = 4 * 1024,
+    DIRECT_READ_TEST_CHUNK_COUNT = 16,
+    DIRECT_READ_TEST_TOTAL_SIZE = DIRECT_READ_TEST_CHUNK_SIZE * DIRECT_READ_TEST_CHUNK_COUNT,
+    DIRECT_READ_TEST_BUFFER_SIZE = 10 * 1024,
+};
+
+/* The server's handler offers its own buffer, smaller than the transfer and not a multiple of the chunk size, and
+ * everything the client sends arrives through it rather than through pool messages. */
+static int s_socket_handler_direct_read_test(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    s_socket_common_tester_init(allocator, &c_tester);
+
+    uint8_t chunk[DIRECT_READ_TEST_CHUNK_SIZE];
+    for (size_t i = 0; i < sizeof(chunk); ++i) {
+        chunk[i] = (uint8_t)(i % 251);
+    }
+    struct aws_byte_buf write_chunk = aws_byte_buf_from_array(chunk, sizeof(chunk));
 
+    struct aws_byte_buf incoming_received_message;
+    ASSERT_SUCCESS(aws_byte_buf_init(&incoming_received_message, allocator, DIRECT_READ_TEST_TOTAL_SIZE));
     uint8_t outgoing_received_message[128];
-    uint8_t incoming_received_message[128];
 
     struct socket_test_rw_args incoming_rw_args;
-    ASSERT_SUCCESS(s_rw_args_init(
-        &incoming_rw_args,
-        &c_tester,
-        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message)),
-        0));
+    ASSERT_SUCCESS(
+        s_rw_args_init(&incoming_rw_args, &c_tester, incoming_received_message, DIRECT_READ_TEST_TOTAL_SIZE));
 
     struct socket_test_rw_args outgoing_rw_args;
     ASSERT_SUCCESS(s_rw_args_init(
@@ -640,8 +3454,9 @@ static int s_open_channel_statistics_test(struct aws_allocator *allocator, void
     ASSERT_NOT_NULL(outgoing_rw_handler);
 
     struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
-        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, 10000, &incoming_rw_args);
-    ASSERT_NOT_NULL(outgoing_rw_handler);
+        allocator, s_socket_test_handle_read, s_socket_test_handle_write, true, SIZE_MAX, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+    ASSERT_SUCCESS(rw_handler_enable_direct_read(incoming_rw_handler, DIRECT_READ_TEST_BUFFER_SIZE));
 
     struct socket_test_args incoming_args;
     ASSERT_SUCCESS(s_socket_test_args_init(&incoming_args, &c_tester, incoming_rw_handler));
@@ -652,11 +3467,10 @@ static int s_open_channel_statistics_test(struct aws_allocator *allocator, void
     struct local_server_tester local_server_tester;
     ASSERT_SUCCESS(s_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
 
-    struct aws_client_bootstrap_options bootstrap_options;
-    AWS_ZERO_STRUCT(bootstrap_options);
-    bootstrap_options.event_loop_group = c_tester.el_group;
-    bootstrap_options.host_resolver = NULL;
-
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = NULL,
+    };
     struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
     ASSERT_NOT_NULL(client_bootstrap);
 
@@ -666,7 +3480,6 @@ static int s_open_channel_statistics_test(struct aws_allocator *allocator, void
     channel_options.host_name = local_server_tester.endpoint.address;
     channel_options.port = 0;
     channel_options.socket_options = &local_server_tester.socket_options;
-    channel_options.creation_callback = s_creation_callback_test_channel_creation_callback;
     channel_options.setup_callback = s_socket_handler_test_client_setup_callback;
     channel_options.shutdown_callback = s_socket_handler_test_client_shutdown_callback;
     channel_options.user_data = &outgoing_args;
@@ -674,60 +3487,50 @@ static int s_open_channel_statistics_test(struct aws_allocator *allocator, void
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
 
-    /* wait for both ends to setup */
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &incoming_args));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_channel_setup_predicate, &outgoing_args));
 
-    ASSERT_TRUE(outgoing_args.creation_callback_invoked);
-
-    struct aws_channel_slot *outgoing_slot = aws_atomic_load_ptr(&outgoing_args.rw_slot);
-    rw_handler_write(outgoing_args.rw_handler, outgoing_slot, &write_tag);
-    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_read_predicate, &incoming_rw_args));
-
-    struct aws_channel_slot *incoming_slot = aws_atomic_load_ptr(&incoming_args.rw_slot);
-    rw_handler_write(incoming_args.rw_handler, incoming_slot, &read_tag);
-    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_read_predicate, &outgoing_rw_args));
-
-    uint64_t ms_to_ns = aws_timestamp_convert(1, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
-
-    aws_atomic_store_int(&c_tester.current_time_ns, (size_t)ms_to_ns);
-
-    struct aws_crt_statistics_handler *stats_handler = aws_atomic_load_ptr(&c_tester.stats_handler);
-    struct aws_statistics_handler_test_impl *stats_impl = stats_handler->impl;
+    for (size_t i = 0; i < DIRECT_READ_TEST_CHUNK_COUNT; ++i) {
+        rw_handler_write(outgoing_args.rw_handler, aws_atomic_load_ptr(&outgoing_args.rw_slot), &write_chunk);
+    }
 
-    aws_mutex_lock(&stats_impl->lock);
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &stats_impl->signal, &stats_impl->lock, s_stats_processed_predicate, stats_handler));
+        &c_tester.condition_variable, &c_tester.mutex, s_socket_test_full_read_predicate, &incoming_rw_args));
 
-    ASSERT_TRUE(stats_impl->total_bytes_read == read_tag.len);
-    ASSERT_TRUE(stats_impl->total_bytes_written == write_tag.len);
+    for (size_t i = 0; i < DIRECT_READ_TEST_CHUNK_COUNT; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            chunk,
+            sizeof(chunk),
+            incoming_rw_args.received_message.buffer + i * DIRECT_READ_TEST_CHUNK_SIZE,
+            DIRECT_READ_TEST_CHUNK_SIZE);
+    }
 
-    aws_mutex_unlock(&stats_impl->lock);
+    /* at least one read per trip around the buffer */
+    ASSERT_TRUE(
+        rw_handler_direct_reads(incoming_rw_handler) >= DIRECT_READ_TEST_TOTAL_SIZE / DIRECT_READ_TEST_BUFFER_SIZE);
 
-    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS));
 
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &incoming_args));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_channel_shutdown_predicate, &outgoing_args));
-
     aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_listener_destroy_predicate, &incoming_args));
 
     aws_mutex_unlock(&c_tester.mutex);
 
-    /* clean up */
     ASSERT_SUCCESS(s_local_server_tester_clean_up(&local_server_tester));
 
     aws_client_bootstrap_release(client_bootstrap);
     ASSERT_SUCCESS(s_socket_common_tester_clean_up(&c_tester));
 
+    aws_byte_buf_clean_up(&incoming_received_message);
+
     return AWS_OP_SUCCESS;
 }
 
-AWS_TEST_CASE(open_channel_statistics_test, s_open_channel_statistics_test)
+AWS_TEST_CASE(socket_handler_direct_read, s_socket_handler_direct_read_test)
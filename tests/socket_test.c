@@ -7,16 +7,21 @@
 
 #include <aws/common/clock.h>
 #include <aws/common/condition_variable.h>
+#include <aws/common/math.h>
 #include <aws/common/string.h>
 #include <aws/common/task_scheduler.h>
 
 #include <aws/io/event_loop.h>
 #include <aws/io/host_resolver.h>
+#include <aws/io/pipe.h>
 #include <aws/io/socket.h>
 
 #ifdef _WIN32
 #    define LOCAL_SOCK_TEST_PATTERN "\\\\.\\pipe\\testsock%llu"
 #else
+#    include <fcntl.h>
+#    include <sys/socket.h>
+#    include <unistd.h>
 #    define LOCAL_SOCK_TEST_PATTERN "testsock%llu.sock"
 #endif
 
@@ -436,6 +441,63 @@ static int s_test_tcp_socket_communication(struct aws_allocator *allocator, void
 
 AWS_TEST_CASE(tcp_socket_communication, s_test_tcp_socket_communication)
 
+/* Registered I/O only changes how reads happen on Windows, everywhere else the option is ignored. */
+static int s_test_tcp_socket_registered_io_communication(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.use_registered_io = true;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8131};
+
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_socket_registered_io_communication, s_test_tcp_socket_registered_io_communication)
+
+/* The first connection to a server has no Fast Open cookie yet, so it connects the usual way, on both ends. */
+static int s_test_tcp_socket_fast_open_communication(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.tcp_fast_open = true;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8132};
+
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_socket_fast_open_communication, s_test_tcp_socket_fast_open_communication)
+
+/* reno is built into every Linux kernel, other platforms only log that they can't set it. */
+static int s_test_tcp_socket_buffer_options_communication(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+    options.send_buffer_size = 16 * 1024;
+    options.recv_buffer_size = 16 * 1024;
+    options.tcp_notsent_lowat = 4 * 1024;
+    strncpy(options.tcp_congestion_control, "reno", sizeof(options.tcp_congestion_control) - 1);
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8135};
+
+    return s_test_socket(allocator, &options, &endpoint);
+}
+
+AWS_TEST_CASE(tcp_socket_buffer_options_communication, s_test_tcp_socket_buffer_options_communication)
+
 #if defined(USE_VSOCK)
 static int s_test_vsock_loopback_socket_communication(struct aws_allocator *allocator, void *ctx) {
 /* Without vsock loopback it's difficult to test vsock functionality.
@@ -493,6 +555,314 @@ static int s_test_udp_bind_connect_communication(struct aws_allocator *allocator
 }
 AWS_TEST_CASE(udp_bind_connect_communication, s_test_udp_bind_connect_communication)
 
+#ifndef _WIN32
+#    define DATAGRAM_BATCH_COUNT 8
+
+struct datagram_batch_args {
+    struct aws_socket *sender;
+    struct aws_socket *receiver;
+    struct aws_socket_endpoint receiver_endpoint;
+    struct aws_byte_buf received[DATAGRAM_BATCH_COUNT];
+    struct aws_socket_endpoint sources[DATAGRAM_BATCH_COUNT];
+    size_t sent_count;
+    size_t received_count;
+    bool truncated;
+    int error_code;
+    bool done;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static const char *s_datagram_batch_payloads[DATAGRAM_BATCH_COUNT] = {
+    "a",
+    "datagram",
+    "batch",
+    "sent with one call",
+    "",
+    "and read back",
+    "with the sender's address",
+    "z",
+};
+
+static void s_datagram_batch_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct datagram_batch_args *args = arg;
+    aws_mutex_lock(args->mutex);
+
+    struct aws_socket_datagram datagrams[DATAGRAM_BATCH_COUNT];
+    AWS_ZERO_ARRAY(datagrams);
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        datagrams[i].buffer = aws_byte_buf_from_c_str(s_datagram_batch_payloads[i]);
+        datagrams[i].endpoint = args->receiver_endpoint;
+    }
+
+    if (aws_socket_send_to_batch(args->sender, datagrams, DATAGRAM_BATCH_COUNT, &args->sent_count)) {
+        args->error_code = aws_last_error();
+        goto done;
+    }
+
+    /* loopback delivers synchronously, so this only spins if the batch didn't all make it into the queue */
+    while (args->received_count < args->sent_count) {
+        size_t wanted = DATAGRAM_BATCH_COUNT - args->received_count;
+        for (size_t i = 0; i < wanted; ++i) {
+            AWS_ZERO_STRUCT(datagrams[i]);
+            datagrams[i].buffer = args->received[args->received_count + i];
+        }
+
+        size_t received = 0;
+        int result = aws_socket_recv_from_batch(args->receiver, datagrams, wanted, &received);
+        for (size_t i = 0; i < received; ++i) {
+            args->received[args->received_count + i] = datagrams[i].buffer;
+            args->sources[args->received_count + i] = datagrams[i].endpoint;
+            args->truncated |= datagrams[i].truncated;
+        }
+        args->received_count += received;
+
+        if (result && aws_last_error() != AWS_IO_READ_WOULD_BLOCK) {
+            args->error_code = aws_last_error();
+            break;
+        }
+    }
+
+done:
+    args->done = true;
+    aws_mutex_unlock(args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static bool s_datagram_batch_predicate(void *arg) {
+    struct datagram_batch_args *args = arg;
+    return args->done;
+}
+
+/* Tests that a batch of datagrams goes out with aws_socket_send_to_batch() and comes back in order, each with the
+ * sender's address, through aws_socket_recv_from_batch(). */
+static int s_test_udp_datagram_batch(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_DGRAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint sender_endpoint = {.address = "127.0.0.1", .port = 8133};
+    struct aws_socket_endpoint receiver_endpoint = {.address = "127.0.0.1", .port = 8134};
+
+    struct aws_socket sender;
+    struct aws_socket receiver;
+    ASSERT_SUCCESS(aws_socket_init(&sender, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_init(&receiver, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&sender, &sender_endpoint));
+    ASSERT_SUCCESS(aws_socket_bind(&receiver, &receiver_endpoint));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&sender, event_loop));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&receiver, event_loop));
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(&receiver, s_on_readable, NULL));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct datagram_batch_args args = {
+        .sender = &sender,
+        .receiver = &receiver,
+        .receiver_endpoint = receiver_endpoint,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_byte_buf_init(&args.received[i], allocator, 64));
+    }
+
+    struct aws_task batch_task;
+    aws_task_init(&batch_task, s_datagram_batch_task, &args, "udp_datagram_batch");
+    aws_event_loop_schedule_task_now(event_loop, &batch_task);
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &mutex, s_datagram_batch_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, args.error_code);
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, args.sent_count);
+    ASSERT_UINT_EQUALS(DATAGRAM_BATCH_COUNT, args.received_count);
+    ASSERT_FALSE(args.truncated);
+    for (size_t i = 0; i < DATAGRAM_BATCH_COUNT; ++i) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            s_datagram_batch_payloads[i],
+            strlen(s_datagram_batch_payloads[i]),
+            args.received[i].buffer,
+            args.received[i].len);
+        ASSERT_STR_EQUALS(sender_endpoint.address, args.sources[i].address);
+        ASSERT_UINT_EQUALS(sender_endpoint.port, args.sources[i].port);
+        aws_byte_buf_clean_up(&args.received[i]);
+    }
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    struct aws_socket *to_close[] = {&sender, &receiver};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(to_close); ++i) {
+        io_args.socket = to_close[i];
+        io_args.close_completed = false;
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+        ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+        aws_socket_clean_up(to_close[i]);
+    }
+
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(udp_datagram_batch, s_test_udp_datagram_batch)
+
+struct handle_passing_args {
+    struct aws_socket *sender;
+    struct aws_socket *receiver;
+    int passed_fd;
+    size_t amount_written;
+    struct aws_byte_buf received;
+    struct aws_io_handle received_handle;
+    int error_code;
+    bool done;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_handle_passing_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct handle_passing_args *args = arg;
+    aws_mutex_lock(args->mutex);
+
+    struct aws_byte_cursor data = aws_byte_cursor_from_c_str("here you go");
+    struct aws_io_handle handle = {.data = {.fd = args->passed_fd}};
+    if (aws_socket_send_handle(args->sender, &data, &handle, &args->amount_written)) {
+        args->error_code = aws_last_error();
+        goto done;
+    }
+
+    size_t amount_read = 0;
+    if (aws_socket_recv_handle(args->receiver, &args->received, &args->received_handle, &amount_read)) {
+        args->error_code = aws_last_error();
+    }
+
+done:
+    args->done = true;
+    aws_mutex_unlock(args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static bool s_handle_passing_predicate(void *arg) {
+    struct handle_passing_args *args = arg;
+    return args->done;
+}
+
+/* Tests that a descriptor sent with aws_socket_send_handle() arrives through aws_socket_recv_handle() along with its
+ * bytes, over both ends of a socketpair() adopted with aws_socket_init_from_handle(). */
+static int s_test_local_socket_handle_passing(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    int pair[2] = {-1, -1};
+    ASSERT_SUCCESS(socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+
+    struct aws_socket sender;
+    struct aws_socket receiver;
+    struct aws_io_handle sender_handle = {.data = {.fd = pair[0]}};
+    struct aws_io_handle receiver_handle = {.data = {.fd = pair[1]}};
+    ASSERT_SUCCESS(aws_socket_init_from_handle(&sender, allocator, &options, &sender_handle));
+    ASSERT_SUCCESS(aws_socket_init_from_handle(&receiver, allocator, &options, &receiver_handle));
+    ASSERT_TRUE(aws_socket_is_open(&sender));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&sender, event_loop));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&receiver, event_loop));
+
+    /* pass the read end of a pipe, and check it's still the same pipe on the other side */
+    int pipe_fds[2] = {-1, -1};
+    ASSERT_SUCCESS(pipe(pipe_fds));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct handle_passing_args args = {
+        .sender = &sender,
+        .receiver = &receiver,
+        .passed_fd = pipe_fds[0],
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.received, allocator, 64));
+
+    struct aws_task passing_task;
+    aws_task_init(&passing_task, s_handle_passing_task, &args, "local_socket_handle_passing");
+    aws_event_loop_schedule_task_now(event_loop, &passing_task);
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&args.condition_variable, &mutex, s_handle_passing_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, args.error_code);
+    ASSERT_UINT_EQUALS(strlen("here you go"), args.amount_written);
+    ASSERT_BIN_ARRAYS_EQUALS("here you go", strlen("here you go"), args.received.buffer, args.received.len);
+    ASSERT_TRUE(args.received_handle.data.fd >= 0);
+    ASSERT_FALSE(args.received_handle.data.fd == pipe_fds[0]);
+
+    ASSERT_INT_EQUALS(1, write(pipe_fds[1], "x", 1));
+    close(pipe_fds[0]);
+    char byte = 0;
+    ASSERT_INT_EQUALS(1, read(args.received_handle.data.fd, &byte, 1));
+    ASSERT_INT_EQUALS('x', byte);
+    close(args.received_handle.data.fd);
+    close(pipe_fds[1]);
+    aws_byte_buf_clean_up(&args.received);
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    struct aws_socket *to_close[] = {&sender, &receiver};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(to_close); ++i) {
+        io_args.socket = to_close[i];
+        io_args.close_completed = false;
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+        ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+        aws_socket_clean_up(to_close[i]);
+    }
+
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(local_socket_handle_passing, s_test_local_socket_handle_passing)
+#endif
+
 struct test_host_callback_data {
     struct aws_host_address a_address;
     struct aws_mutex *mutex;
@@ -1049,6 +1419,136 @@ static int s_cleanup_before_connect_or_timeout_doesnt_explode(struct aws_allocat
 
 AWS_TEST_CASE(cleanup_before_connect_or_timeout_doesnt_explode, s_cleanup_before_connect_or_timeout_doesnt_explode)
 
+struct loop_thread_connect_args {
+    struct aws_allocator *allocator;
+    struct aws_event_loop *event_loop;
+    struct aws_socket_options *options;
+    struct aws_socket_endpoint *endpoint;
+    struct aws_socket *connected;
+    struct aws_socket *closed;
+    struct local_outgoing_args *connected_args;
+    struct local_outgoing_args *closed_args;
+    int error_code;
+};
+
+/* connects from the loop's own thread, where the connect timeout lives in the socket, and closes one socket before its
+ * connect is decided. */
+static void s_loop_thread_connect_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct loop_thread_connect_args *args = arg;
+    if (aws_socket_init(args->connected, args->allocator, args->options) ||
+        aws_socket_connect(
+            args->connected, args->endpoint, args->event_loop, s_local_outgoing_connection, args->connected_args) ||
+        aws_socket_init(args->closed, args->allocator, args->options) ||
+        aws_socket_connect(
+            args->closed, args->endpoint, args->event_loop, s_local_outgoing_connection, args->closed_args) ||
+        aws_socket_close(args->closed)) {
+        args->error_code = aws_last_error();
+        aws_mutex_lock(args->connected_args->mutex);
+        args->connected_args->error_invoked = true;
+        aws_mutex_unlock(args->connected_args->mutex);
+        aws_condition_variable_notify_one(args->connected_args->condition_variable);
+    }
+}
+
+/* the closed socket may well have been accepted too, so nothing is kept. */
+static void s_discard_incoming(
+    struct aws_socket *socket,
+    int error_code,
+    struct aws_socket *new_socket,
+    void *user_data) {
+    (void)socket;
+    (void)user_data;
+
+    if (!error_code) {
+        aws_socket_clean_up(new_socket);
+        aws_mem_release(new_socket->allocator, new_socket);
+    }
+}
+
+static int s_test_connect_from_event_loop_thread(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 1000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_IPV4;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8136};
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_discard_incoming, NULL));
+
+    struct local_outgoing_args connected_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+    struct local_outgoing_args closed_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    struct aws_socket connected;
+    struct aws_socket closed;
+    AWS_ZERO_STRUCT(connected);
+    AWS_ZERO_STRUCT(closed);
+    struct loop_thread_connect_args connect_args = {
+        .allocator = allocator,
+        .event_loop = event_loop,
+        .options = &options,
+        .endpoint = &endpoint,
+        .connected = &connected,
+        .closed = &closed,
+        .connected_args = &connected_args,
+        .closed_args = &closed_args,
+    };
+
+    struct aws_task connect_task = {
+        .fn = s_loop_thread_connect_task,
+        .arg = &connect_args,
+    };
+    aws_event_loop_schedule_task_now(event_loop, &connect_task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &connected_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    ASSERT_SUCCESS(connect_args.error_code);
+    ASSERT_TRUE(connected_args.connect_invoked);
+    ASSERT_FALSE(connected_args.error_invoked);
+
+    /* the closed socket's connect timeout went with it, so nothing should fire for it when it would have expired. */
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_ERROR(
+        AWS_ERROR_COND_VARIABLE_TIMED_OUT,
+        aws_condition_variable_wait_for(
+            &condition_variable,
+            &mutex,
+            aws_timestamp_convert(options.connect_timeout_ms * 2, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL)));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    ASSERT_FALSE(closed_args.connect_invoked);
+    ASSERT_FALSE(closed_args.error_invoked);
+    ASSERT_FALSE(connected_args.error_invoked);
+
+    aws_socket_clean_up(&connected);
+    aws_socket_clean_up(&closed);
+    aws_socket_clean_up(&listener);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+
+AWS_TEST_CASE(connect_from_event_loop_thread, s_test_connect_from_event_loop_thread)
+
 static void s_local_listener_incoming_destroy_listener(
     struct aws_socket *socket,
     int error_code,
@@ -1314,6 +1814,573 @@ static int s_cleanup_in_write_cb_doesnt_explode(struct aws_allocator *allocator,
 }
 AWS_TEST_CASE(cleanup_in_write_cb_doesnt_explode, s_cleanup_in_write_cb_doesnt_explode)
 
+enum {
+    QUEUED_WRITE_COUNT = 32,
+    QUEUED_WRITE_SIZE = 64 * 1024,
+};
+
+struct queued_writes_args;
+
+struct queued_write_request {
+    struct queued_writes_args *args;
+    size_t index;
+};
+
+struct queued_writes_args {
+    struct aws_socket *writer;
+    struct aws_socket *reader;
+    struct aws_byte_cursor to_write[QUEUED_WRITE_COUNT];
+    struct queued_write_request requests[QUEUED_WRITE_COUNT];
+    size_t completion_order[QUEUED_WRITE_COUNT];
+    size_t completed_count;
+    int error_code;
+    struct aws_byte_buf read_data;
+    bool vectored_reads;
+    FILE *file;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+static void s_on_queued_write_complete(
+    struct aws_socket *socket,
+    int error_code,
+    size_t amount_written,
+    void *user_data) {
+    (void)socket;
+    (void)amount_written;
+
+    struct queued_write_request *request = user_data;
+    struct queued_writes_args *args = request->args;
+
+    aws_mutex_lock(args->mutex);
+    if (error_code) {
+        args->error_code = error_code;
+    }
+    args->completion_order[args->completed_count++] = request->index;
+    aws_mutex_unlock(args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static void s_queued_writes_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct queued_writes_args *args = arg;
+
+    /* far more than the socket buffer holds, so most of these queue up behind each other */
+    for (size_t i = 0; i < QUEUED_WRITE_COUNT; ++i) {
+        args->requests[i].args = args;
+        args->requests[i].index = i;
+        int result = AWS_OP_SUCCESS;
+        if (args->file) {
+            result = aws_socket_write_from_file(
+                args->writer,
+                args->file,
+                i * QUEUED_WRITE_SIZE,
+                QUEUED_WRITE_SIZE,
+                s_on_queued_write_complete,
+                &args->requests[i]);
+        } else {
+            result = aws_socket_write(args->writer, &args->to_write[i], s_on_queued_write_complete, &args->requests[i]);
+        }
+
+        if (result) {
+            aws_mutex_lock(args->mutex);
+            args->error_code = aws_last_error();
+            aws_mutex_unlock(args->mutex);
+            aws_condition_variable_notify_one(&args->condition_variable);
+            return;
+        }
+    }
+}
+
+static void s_on_queued_writes_readable(struct aws_socket *socket, int error_code, void *user_data) {
+    struct queued_writes_args *args = user_data;
+    if (error_code) {
+        return;
+    }
+
+    aws_mutex_lock(args->mutex);
+    while (args->read_data.len < args->read_data.capacity) {
+        size_t amount_read = 0;
+        if (!args->vectored_reads) {
+            if (aws_socket_read(socket, &args->read_data, &amount_read)) {
+                break;
+            }
+            continue;
+        }
+
+        /* scatter into odd-sized windows over the remaining space so chunk boundaries never line up with writes */
+        struct aws_byte_buf chunks[4];
+        struct aws_byte_buf *chunk_ptrs[AWS_ARRAY_SIZE(chunks)];
+        uint8_t *chunk_start = args->read_data.buffer + args->read_data.len;
+        size_t space = args->read_data.capacity - args->read_data.len;
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(chunks); ++i) {
+            size_t chunk_size = aws_min_size(space, 1000 + i * 333);
+            chunks[i] = aws_byte_buf_from_empty_array(chunk_start, chunk_size);
+            chunk_ptrs[i] = &chunks[i];
+            chunk_start += chunk_size;
+            space -= chunk_size;
+        }
+
+        if (aws_socket_read_vectored(socket, chunk_ptrs, AWS_ARRAY_SIZE(chunks), &amount_read)) {
+            break;
+        }
+
+        size_t chunk_total = 0;
+        for (size_t i = 0; i < AWS_ARRAY_SIZE(chunks); ++i) {
+            /* only the last chunk holding data may be partially filled */
+            if (chunks[i].len < chunks[i].capacity && i + 1 < AWS_ARRAY_SIZE(chunks) && chunks[i + 1].len) {
+                args->error_code = AWS_ERROR_INVALID_STATE;
+            }
+            chunk_total += chunks[i].len;
+        }
+        if (chunk_total != amount_read) {
+            args->error_code = AWS_ERROR_INVALID_STATE;
+        }
+        args->read_data.len += amount_read;
+    }
+    aws_mutex_unlock(args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static bool s_queued_writes_done_predicate(void *arg) {
+    struct queued_writes_args *args = arg;
+    return args->error_code ||
+           (args->completed_count == QUEUED_WRITE_COUNT && args->read_data.len == args->read_data.capacity);
+}
+
+struct queued_writes_test_options {
+    enum aws_socket_domain domain;
+    bool vectored_reads;
+    bool from_file;
+    size_t zerocopy_write_threshold;
+};
+
+static int s_run_queued_writes_test(
+    struct aws_allocator *allocator,
+    const struct queued_writes_test_options *test_options) {
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct local_listener_args listener_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+        .incoming = NULL,
+        .incoming_invoked = false,
+        .error_invoked = false,
+    };
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = test_options->domain;
+    options.zerocopy_write_threshold = test_options->zerocopy_write_threshold;
+
+    struct aws_socket_endpoint endpoint = {.address = "127.0.0.1", .port = 8128};
+    if (test_options->domain == AWS_SOCKET_LOCAL) {
+        uint64_t timestamp = 0;
+        ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+        snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+    }
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_local_listener_incoming, &listener_args));
+
+    struct local_outgoing_args outgoing_args = {
+        .mutex = &mutex, .condition_variable = &condition_variable, .connect_invoked = false, .error_invoked = false};
+
+    struct aws_socket outgoing;
+    ASSERT_SUCCESS(aws_socket_init(&outgoing, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_connect(&outgoing, &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&condition_variable, &mutex, s_incoming_predicate, &listener_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_TRUE(listener_args.incoming_invoked);
+    ASSERT_TRUE(outgoing_args.connect_invoked);
+    struct aws_socket *server_sock = listener_args.incoming;
+
+    struct aws_byte_buf write_data;
+    ASSERT_SUCCESS(aws_byte_buf_init(&write_data, allocator, QUEUED_WRITE_COUNT * QUEUED_WRITE_SIZE));
+    for (size_t i = 0; i < write_data.capacity; ++i) {
+        /* vary the pattern per request so misordered data is caught */
+        write_data.buffer[i] = (uint8_t)(i / QUEUED_WRITE_SIZE + i);
+    }
+    write_data.len = write_data.capacity;
+
+    struct queued_writes_args args = {
+        .writer = &outgoing,
+        .reader = server_sock,
+        .completed_count = 0,
+        .error_code = 0,
+        .vectored_reads = test_options->vectored_reads,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+    ASSERT_SUCCESS(aws_byte_buf_init(&args.read_data, allocator, write_data.len));
+    if (test_options->from_file) {
+        args.file = tmpfile();
+        ASSERT_NOT_NULL(args.file);
+        ASSERT_UINT_EQUALS(write_data.len, fwrite(write_data.buffer, 1, write_data.len, args.file));
+        ASSERT_SUCCESS(fflush(args.file));
+    }
+    for (size_t i = 0; i < QUEUED_WRITE_COUNT; ++i) {
+        args.to_write[i] = aws_byte_cursor_from_array(write_data.buffer + i * QUEUED_WRITE_SIZE, QUEUED_WRITE_SIZE);
+    }
+
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(server_sock, event_loop));
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(server_sock, s_on_queued_writes_readable, &args));
+    ASSERT_SUCCESS(aws_socket_subscribe_to_readable_events(&outgoing, s_on_readable, NULL));
+
+    struct aws_task write_task = {
+        .fn = s_queued_writes_task,
+        .arg = &args,
+    };
+    aws_event_loop_schedule_task_now(event_loop, &write_task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &args.condition_variable, &mutex, s_queued_writes_done_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, args.error_code);
+    for (size_t i = 0; i < QUEUED_WRITE_COUNT; ++i) {
+        ASSERT_UINT_EQUALS(i, args.completion_order[i]);
+    }
+    ASSERT_BIN_ARRAYS_EQUALS(write_data.buffer, write_data.len, args.read_data.buffer, args.read_data.len);
+
+    struct socket_io_args io_args = {
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+
+    struct aws_socket *to_close[] = {server_sock, &outgoing, &listener};
+    for (size_t i = 0; i < AWS_ARRAY_SIZE(to_close); ++i) {
+        io_args.socket = to_close[i];
+        io_args.close_completed = false;
+        aws_event_loop_schedule_task_now(event_loop, &close_task);
+        ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+        aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+        ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+        aws_socket_clean_up(to_close[i]);
+    }
+
+    if (args.file) {
+        fclose(args.file);
+    }
+    aws_mem_release(allocator, server_sock);
+    aws_byte_buf_clean_up(&args.read_data);
+    aws_byte_buf_clean_up(&write_data);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+
+/* Tests that a burst of queued writes completes in order, with the data arriving intact on the other end */
+static int s_test_socket_queued_writes_complete_in_order(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct queued_writes_test_options test_options = {.domain = AWS_SOCKET_LOCAL};
+    return s_run_queued_writes_test(allocator, &test_options);
+}
+AWS_TEST_CASE(socket_queued_writes_complete_in_order, s_test_socket_queued_writes_complete_in_order)
+
+/* Same burst, but the reader scatters each read across several buffers with aws_socket_read_vectored() */
+static int s_test_socket_read_vectored(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct queued_writes_test_options test_options = {.domain = AWS_SOCKET_LOCAL, .vectored_reads = true};
+    return s_run_queued_writes_test(allocator, &test_options);
+}
+AWS_TEST_CASE(socket_read_vectored, s_test_socket_read_vectored)
+
+/* Same burst over TCP with every write eligible for zero copy. Where MSG_ZEROCOPY isn't available this is just
+ * another copying run, and over loopback the kernel copies anyway, but completions must still come back in order
+ * once the kernel reports the buffers released. */
+static int s_test_socket_zerocopy_writes(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct queued_writes_test_options test_options = {.domain = AWS_SOCKET_IPV4, .zerocopy_write_threshold = 1};
+    return s_run_queued_writes_test(allocator, &test_options);
+}
+AWS_TEST_CASE(socket_zerocopy_writes, s_test_socket_zerocopy_writes)
+
+#ifndef _WIN32
+/* Same burst, but every request sends its slice straight from a file with aws_socket_write_from_file() */
+static int s_test_socket_write_from_file(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct queued_writes_test_options test_options = {.domain = AWS_SOCKET_LOCAL, .from_file = true};
+    return s_run_queued_writes_test(allocator, &test_options);
+}
+AWS_TEST_CASE(socket_write_from_file, s_test_socket_write_from_file)
+
+#    define ACCEPT_BURST_CONNECTION_COUNT 3
+
+struct accept_burst_args {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_socket *incoming[ACCEPT_BURST_CONNECTION_COUNT];
+    size_t incoming_count;
+    bool error_invoked;
+};
+
+static void s_accept_burst_incoming(
+    struct aws_socket *socket,
+    int error_code,
+    struct aws_socket *new_socket,
+    void *user_data) {
+    (void)socket;
+    struct accept_burst_args *burst_args = user_data;
+    aws_mutex_lock(burst_args->mutex);
+
+    if (!error_code && burst_args->incoming_count < ACCEPT_BURST_CONNECTION_COUNT) {
+        burst_args->incoming[burst_args->incoming_count++] = new_socket;
+    } else {
+        burst_args->error_invoked = true;
+    }
+    aws_mutex_unlock(burst_args->mutex);
+    aws_condition_variable_notify_one(burst_args->condition_variable);
+}
+
+static bool s_accept_burst_predicate(void *arg) {
+    struct accept_burst_args *burst_args = arg;
+    return burst_args->incoming_count == ACCEPT_BURST_CONNECTION_COUNT || burst_args->error_invoked;
+}
+
+/* With one accept allowed per readable event, a backlog of connections still gets drained by the deferred accepts, and
+ * every accepted fd comes out non-blocking and close-on-exec. */
+static int s_test_socket_accept_burst_limit(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct aws_condition_variable condition_variable = AWS_CONDITION_VARIABLE_INIT;
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+    options.max_accepts_per_event = 1;
+
+    uint64_t timestamp = 0;
+    ASSERT_SUCCESS(aws_sys_clock_get_ticks(&timestamp));
+    struct aws_socket_endpoint endpoint;
+    AWS_ZERO_STRUCT(endpoint);
+    snprintf(endpoint.address, sizeof(endpoint.address), LOCAL_SOCK_TEST_PATTERN, (long long unsigned)timestamp);
+
+    struct aws_socket listener;
+    ASSERT_SUCCESS(aws_socket_init(&listener, allocator, &options));
+    ASSERT_SUCCESS(aws_socket_bind(&listener, &endpoint));
+    ASSERT_SUCCESS(aws_socket_listen(&listener, 1024));
+
+    /* queue every connection up before accepting, so they all arrive on the same readable event */
+    struct local_outgoing_args outgoing_args[ACCEPT_BURST_CONNECTION_COUNT];
+    struct aws_socket outgoing[ACCEPT_BURST_CONNECTION_COUNT];
+    for (size_t i = 0; i < ACCEPT_BURST_CONNECTION_COUNT; ++i) {
+        outgoing_args[i] = (struct local_outgoing_args){
+            .mutex = &mutex,
+            .condition_variable = &condition_variable,
+        };
+        ASSERT_SUCCESS(aws_socket_init(&outgoing[i], allocator, &options));
+        ASSERT_SUCCESS(
+            aws_socket_connect(&outgoing[i], &endpoint, event_loop, s_local_outgoing_connection, &outgoing_args[i]));
+    }
+
+    struct accept_burst_args burst_args = {
+        .mutex = &mutex,
+        .condition_variable = &condition_variable,
+    };
+    ASSERT_SUCCESS(aws_socket_start_accept(&listener, event_loop, s_accept_burst_incoming, &burst_args));
+
+    aws_mutex_lock(&mutex);
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&condition_variable, &mutex, s_accept_burst_predicate, &burst_args));
+    for (size_t i = 0; i < ACCEPT_BURST_CONNECTION_COUNT; ++i) {
+        ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+            &condition_variable, &mutex, s_connection_completed_predicate, &outgoing_args[i]));
+        ASSERT_FALSE(outgoing_args[i].error_invoked);
+    }
+    aws_mutex_unlock(&mutex);
+
+    ASSERT_FALSE(burst_args.error_invoked);
+    ASSERT_UINT_EQUALS(ACCEPT_BURST_CONNECTION_COUNT, burst_args.incoming_count);
+
+    for (size_t i = 0; i < ACCEPT_BURST_CONNECTION_COUNT; ++i) {
+        int fd = burst_args.incoming[i]->io_handle.data.fd;
+        ASSERT_TRUE(fcntl(fd, F_GETFL) & O_NONBLOCK);
+        ASSERT_TRUE(fcntl(fd, F_GETFD) & FD_CLOEXEC);
+
+        aws_socket_clean_up(burst_args.incoming[i]);
+        aws_mem_release(allocator, burst_args.incoming[i]);
+        aws_socket_clean_up(&outgoing[i]);
+    }
+
+    aws_socket_clean_up(&listener);
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(socket_accept_burst_limit, s_test_socket_accept_burst_limit)
+
+struct pipe_splice_args {
+    struct aws_pipe_read_end *read_end;
+    struct aws_pipe_write_end *write_end;
+    struct aws_socket *socket;
+    struct aws_byte_cursor payload;
+    size_t amount_spliced;
+    int error_code;
+    bool done;
+    struct aws_mutex *mutex;
+    struct aws_condition_variable condition_variable;
+};
+
+/* the whole payload sits in the pipe now, move it on to the socket and close the pipe */
+static void s_pipe_splice_on_written(
+    struct aws_pipe_write_end *write_end,
+    int error_code,
+    struct aws_byte_cursor src_buffer,
+    void *user_data) {
+    (void)write_end;
+    (void)src_buffer;
+
+    struct pipe_splice_args *args = user_data;
+    aws_mutex_lock(args->mutex);
+
+    args->error_code = error_code;
+    if (!error_code &&
+        aws_pipe_splice_to_socket(args->read_end, args->socket, args->payload.len, &args->amount_spliced)) {
+        args->error_code = aws_last_error();
+    }
+
+    aws_pipe_clean_up_read_end(args->read_end);
+    aws_pipe_clean_up_write_end(args->write_end);
+
+    args->done = true;
+    aws_mutex_unlock(args->mutex);
+    aws_condition_variable_notify_one(&args->condition_variable);
+}
+
+static void s_pipe_splice_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+
+    struct pipe_splice_args *args = arg;
+    if (aws_pipe_write(args->write_end, args->payload, s_pipe_splice_on_written, args)) {
+        aws_mutex_lock(args->mutex);
+        args->error_code = aws_last_error();
+        aws_pipe_clean_up_read_end(args->read_end);
+        aws_pipe_clean_up_write_end(args->write_end);
+        args->done = true;
+        aws_mutex_unlock(args->mutex);
+        aws_condition_variable_notify_one(&args->condition_variable);
+    }
+}
+
+static bool s_pipe_splice_predicate(void *arg) {
+    struct pipe_splice_args *args = arg;
+    return args->done;
+}
+
+/* Tests that aws_pipe_splice_to_socket() moves what was written to a pipe on to the peer of a connected socket, one
+ * end of a socketpair() adopted with aws_socket_init_from_handle(). Platforms without splice() refuse it instead. */
+static int s_test_pipe_splice_to_socket(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct aws_event_loop *event_loop = aws_event_loop_new_default(allocator, aws_high_res_clock_get_ticks);
+
+    ASSERT_NOT_NULL(event_loop, "Event loop creation failed with error: %s", aws_error_debug_str(aws_last_error()));
+    ASSERT_SUCCESS(aws_event_loop_run(event_loop));
+
+    struct aws_socket_options options;
+    AWS_ZERO_STRUCT(options);
+    options.connect_timeout_ms = 3000;
+    options.type = AWS_SOCKET_STREAM;
+    options.domain = AWS_SOCKET_LOCAL;
+
+    int pair[2] = {-1, -1};
+    ASSERT_SUCCESS(socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+
+    struct aws_socket sender;
+    struct aws_io_handle sender_handle = {.data = {.fd = pair[0]}};
+    ASSERT_SUCCESS(aws_socket_init_from_handle(&sender, allocator, &options, &sender_handle));
+    ASSERT_SUCCESS(aws_socket_assign_to_event_loop(&sender, event_loop));
+
+    struct aws_pipe_read_end read_end;
+    struct aws_pipe_write_end write_end;
+    ASSERT_SUCCESS(aws_pipe_init(&read_end, event_loop, &write_end, event_loop, allocator));
+
+    struct aws_mutex mutex = AWS_MUTEX_INIT;
+    struct pipe_splice_args args = {
+        .read_end = &read_end,
+        .write_end = &write_end,
+        .socket = &sender,
+        .payload = aws_byte_cursor_from_c_str("spliced without a copy"),
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    struct aws_task splice_task;
+    aws_task_init(&splice_task, s_pipe_splice_task, &args, "pipe_splice_to_socket");
+    aws_event_loop_schedule_task_now(event_loop, &splice_task);
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(&args.condition_variable, &mutex, s_pipe_splice_predicate, &args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+
+#    if defined(__linux__)
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, args.error_code);
+    ASSERT_UINT_EQUALS(args.payload.len, args.amount_spliced);
+
+    char received[64];
+    ASSERT_INT_EQUALS((ssize_t)args.payload.len, read(pair[1], received, sizeof(received)));
+    ASSERT_BIN_ARRAYS_EQUALS(args.payload.ptr, args.payload.len, received, args.payload.len);
+#    else
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, args.error_code);
+    ASSERT_UINT_EQUALS(0, args.amount_spliced);
+#    endif
+
+    struct socket_io_args io_args = {
+        .socket = &sender,
+        .mutex = &mutex,
+        .condition_variable = AWS_CONDITION_VARIABLE_INIT,
+        .close_completed = false,
+    };
+    struct aws_task close_task = {
+        .fn = s_socket_close_task,
+        .arg = &io_args,
+    };
+    aws_event_loop_schedule_task_now(event_loop, &close_task);
+    ASSERT_SUCCESS(aws_mutex_lock(&mutex));
+    aws_condition_variable_wait_pred(&io_args.condition_variable, &mutex, s_close_completed_predicate, &io_args);
+    ASSERT_SUCCESS(aws_mutex_unlock(&mutex));
+    aws_socket_clean_up(&sender);
+    close(pair[1]);
+
+    aws_event_loop_destroy(event_loop);
+
+    return 0;
+}
+AWS_TEST_CASE(pipe_splice_to_socket, s_test_pipe_splice_to_socket)
+#endif
+
 #ifdef _WIN32
 static int s_local_socket_pipe_connected_race(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
@@ -0,0 +1,283 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/retry_strategy.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/common/condition_variable.h>
+
+#include <aws/io/event_loop.h>
+
+struct standard_retry_test_data {
+    enum aws_retry_error_type error_type;
+    /* record success once this many retries have run, 0 to keep failing until a retry is refused */
+    size_t succeed_after;
+    size_t retry_count;
+    int failure_error_code;
+    bool done;
+    struct aws_mutex mutex;
+    struct aws_condition_variable cvar;
+};
+
+static void s_standard_retry_test_on_retry_ready(struct aws_retry_token *token, int error_code, void *user_data);
+
+static void s_standard_retry_test_attempt_retry(
+    struct aws_retry_token *token,
+    struct standard_retry_test_data *test_data) {
+    if (aws_retry_strategy_schedule_retry(
+            token, test_data->error_type, s_standard_retry_test_on_retry_ready, test_data)) {
+        aws_mutex_lock(&test_data->mutex);
+        test_data->failure_error_code = aws_last_error();
+        test_data->done = true;
+        aws_mutex_unlock(&test_data->mutex);
+        aws_retry_strategy_release_retry_token(token);
+        aws_condition_variable_notify_all(&test_data->cvar);
+    }
+}
+
+static void s_standard_retry_test_on_retry_ready(struct aws_retry_token *token, int error_code, void *user_data) {
+    (void)error_code;
+
+    struct standard_retry_test_data *test_data = user_data;
+
+    aws_mutex_lock(&test_data->mutex);
+    test_data->retry_count += 1;
+    bool succeed = test_data->succeed_after && test_data->retry_count == test_data->succeed_after;
+    aws_mutex_unlock(&test_data->mutex);
+
+    if (!succeed) {
+        s_standard_retry_test_attempt_retry(token, test_data);
+        return;
+    }
+
+    aws_retry_strategy_token_record_success(token);
+    aws_retry_strategy_release_retry_token(token);
+    aws_mutex_lock(&test_data->mutex);
+    test_data->done = true;
+    aws_mutex_unlock(&test_data->mutex);
+    aws_condition_variable_notify_all(&test_data->cvar);
+}
+
+static void s_standard_retry_test_token_acquired(
+    struct aws_retry_strategy *retry_strategy,
+    int error_code,
+    struct aws_retry_token *token,
+    void *user_data) {
+    (void)retry_strategy;
+    (void)error_code;
+
+    s_standard_retry_test_attempt_retry(token, user_data);
+}
+
+static bool s_standard_retry_test_done(void *arg) {
+    struct standard_retry_test_data *test_data = arg;
+    return test_data->done;
+}
+
+static int s_run_standard_retries(
+    struct aws_retry_strategy *retry_strategy,
+    const struct aws_byte_cursor *partition_id,
+    struct standard_retry_test_data *test_data) {
+    test_data->retry_count = 0;
+    test_data->failure_error_code = 0;
+    test_data->done = false;
+
+    ASSERT_SUCCESS(aws_mutex_lock(&test_data->mutex));
+    ASSERT_SUCCESS(aws_retry_strategy_acquire_retry_token(
+        retry_strategy, partition_id, s_standard_retry_test_token_acquired, test_data, 0));
+
+    ASSERT_SUCCESS(
+        aws_condition_variable_wait_pred(&test_data->cvar, &test_data->mutex, s_standard_retry_test_done, test_data));
+    aws_mutex_unlock(&test_data->mutex);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_standard_retry_quota_exhausted_for_error_type(
+    struct aws_allocator *allocator,
+    enum aws_retry_error_type error_type,
+    size_t expected_retries) {
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_standard_retry_options config = {
+        .backoff_retry_options =
+            {
+                .el_group = el_group,
+                .max_retries = 10,
+                .backoff_scale_factor_ms = 1,
+            },
+        .retry_quota_options =
+            {
+                .initial_bucket_capacity = 20,
+            },
+    };
+
+    struct aws_retry_strategy *retry_strategy = aws_retry_strategy_new_standard(allocator, &config);
+    ASSERT_NOT_NULL(retry_strategy);
+
+    struct standard_retry_test_data test_data = {
+        .error_type = error_type,
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(s_run_standard_retries(retry_strategy, NULL, &test_data));
+
+    /* the quota runs dry well before max_retries */
+    ASSERT_UINT_EQUALS(expected_retries, test_data.retry_count);
+    ASSERT_INT_EQUALS(AWS_IO_RETRY_PERMISSION_DENIED, test_data.failure_error_code);
+
+    aws_retry_strategy_release(retry_strategy);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that server errors draw the standard retry cost from the quota. */
+static int s_test_standard_retry_quota_exhausted_server_errors_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_test_standard_retry_quota_exhausted_for_error_type(allocator, AWS_RETRY_ERROR_TYPE_SERVER_ERROR, 4);
+}
+
+AWS_TEST_CASE(
+    test_standard_retry_quota_exhausted_server_errors,
+    s_test_standard_retry_quota_exhausted_server_errors_fn)
+
+/* Test that transient errors (timeouts etc...) cost twice as much. */
+static int s_test_standard_retry_quota_exhausted_transient_errors_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_test_standard_retry_quota_exhausted_for_error_type(allocator, AWS_RETRY_ERROR_TYPE_TRANSIENT, 2);
+}
+
+AWS_TEST_CASE(
+    test_standard_retry_quota_exhausted_transient_errors,
+    s_test_standard_retry_quota_exhausted_transient_errors_fn)
+
+/* Test that the quota is shared between tokens and that recording success puts back what the retry took. */
+static int s_test_standard_retry_quota_refilled_by_success_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_exponential_backoff_retry_options backoff_config = {
+        .el_group = el_group,
+        .max_retries = 10,
+        .backoff_scale_factor_ms = 1,
+    };
+
+    struct aws_retry_strategy *backoff_strategy =
+        aws_retry_strategy_new_exponential_backoff(allocator, &backoff_config);
+    ASSERT_NOT_NULL(backoff_strategy);
+
+    /* room for exactly one server error retry */
+    struct aws_retry_quota_options quota_config = {
+        .initial_bucket_capacity = 5,
+    };
+    struct aws_retry_strategy *retry_strategy =
+        aws_retry_strategy_new_retry_quota(allocator, backoff_strategy, &quota_config);
+    ASSERT_NOT_NULL(retry_strategy);
+    aws_retry_strategy_release(backoff_strategy);
+
+    struct standard_retry_test_data test_data = {
+        .error_type = AWS_RETRY_ERROR_TYPE_SERVER_ERROR,
+        .succeed_after = 1,
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    ASSERT_SUCCESS(s_run_standard_retries(retry_strategy, NULL, &test_data));
+    ASSERT_UINT_EQUALS(1, test_data.retry_count);
+    ASSERT_INT_EQUALS(AWS_OP_SUCCESS, test_data.failure_error_code);
+
+    /* a fresh token gets the refunded retry, and no more */
+    test_data.succeed_after = 0;
+    ASSERT_SUCCESS(s_run_standard_retries(retry_strategy, NULL, &test_data));
+    ASSERT_UINT_EQUALS(1, test_data.retry_count);
+    ASSERT_INT_EQUALS(AWS_IO_RETRY_PERMISSION_DENIED, test_data.failure_error_code);
+
+    aws_retry_strategy_release(retry_strategy);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_standard_retry_quota_refilled_by_success, s_test_standard_retry_quota_refilled_by_success_fn)
+
+/* runs a token on partition until the quota refuses a retry, and checks how many retries it got */
+static int s_exhaust_partition(
+    struct aws_retry_strategy *retry_strategy,
+    const char *partition,
+    struct standard_retry_test_data *test_data,
+    size_t expected_retries) {
+    struct aws_byte_cursor partition_id = aws_byte_cursor_from_c_str(partition);
+    ASSERT_SUCCESS(s_run_standard_retries(retry_strategy, &partition_id, test_data));
+    ASSERT_UINT_EQUALS(expected_retries, test_data->retry_count);
+    ASSERT_INT_EQUALS(AWS_IO_RETRY_PERMISSION_DENIED, test_data->failure_error_code);
+
+    return AWS_OP_SUCCESS;
+}
+
+/* Test that each partition has a quota of its own, and that the least recently used one is evicted. */
+static int s_test_partitioned_retry_isolated_partitions_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_event_loop_group *el_group = aws_event_loop_group_new_default(allocator, 1, NULL);
+    struct aws_partitioned_retry_options config = {
+        .partition_options =
+            {
+                .backoff_retry_options =
+                    {
+                        .el_group = el_group,
+                        .max_retries = 10,
+                        .backoff_scale_factor_ms = 1,
+                    },
+                .retry_quota_options =
+                    {
+                        .initial_bucket_capacity = 10,
+                    },
+            },
+        .max_partitions = 2,
+    };
+
+    struct aws_retry_strategy *retry_strategy = aws_retry_strategy_new_partitioned(allocator, &config);
+    ASSERT_NOT_NULL(retry_strategy);
+
+    struct standard_retry_test_data test_data = {
+        .error_type = AWS_RETRY_ERROR_TYPE_SERVER_ERROR,
+        .mutex = AWS_MUTEX_INIT,
+        .cvar = AWS_CONDITION_VARIABLE_INIT,
+    };
+
+    /* exhausting "a" leaves "b" alone */
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "a", &test_data, 2));
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "b", &test_data, 2));
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "a", &test_data, 0));
+
+    /* "b" is now the least recently used partition, so "c" takes its place */
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "c", &test_data, 2));
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "a", &test_data, 0));
+    ASSERT_SUCCESS(s_exhaust_partition(retry_strategy, "b", &test_data, 2));
+
+    aws_retry_strategy_release(retry_strategy);
+    aws_event_loop_group_release(el_group);
+    ASSERT_SUCCESS(aws_global_thread_creator_shutdown_wait_for(10));
+
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_partitioned_retry_isolated_partitions, s_test_partitioned_retry_isolated_partitions_fn)
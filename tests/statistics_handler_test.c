@@ -41,6 +41,11 @@ static void s_process_statistics(
                 struct aws_crt_statistics_socket *socket_stats = (struct aws_crt_statistics_socket *)stats_base;
                 impl->total_bytes_read += socket_stats->bytes_read;
                 impl->total_bytes_written += socket_stats->bytes_written;
+                impl->total_read_syscalls += socket_stats->read_syscalls;
+                impl->total_write_syscalls += socket_stats->write_syscalls;
+                impl->total_read_would_block += socket_stats->read_would_block;
+                impl->total_write_would_block += socket_stats->write_would_block;
+                impl->total_partial_writes += socket_stats->partial_writes;
                 break;
             }
 
@@ -15,6 +15,11 @@ struct aws_statistics_handler_test_impl {
 
     uint64_t total_bytes_read;
     uint64_t total_bytes_written;
+    uint64_t total_read_syscalls;
+    uint64_t total_write_syscalls;
+    uint64_t total_read_would_block;
+    uint64_t total_write_would_block;
+    uint64_t total_partial_writes;
 
     enum aws_tls_negotiation_status tls_status;
 
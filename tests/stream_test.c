@@ -35,6 +35,16 @@ static struct aws_input_stream *s_create_file_stream(struct aws_allocator *alloc
     return aws_input_stream_new_from_file(allocator, s_test_file_name);
 }
 
+static struct aws_input_stream *s_create_mmap_stream(struct aws_allocator *allocator) {
+    remove(s_test_file_name);
+
+    FILE *file = fopen(s_test_file_name, "w+");
+    fprintf(file, "%s", (char *)s_simple_test->bytes);
+    fclose(file);
+
+    return aws_input_stream_new_from_mmap(allocator, s_test_file_name);
+}
+
 static void s_destroy_file_stream(struct aws_input_stream *stream) {
     aws_input_stream_destroy(stream);
 
@@ -321,3 +331,445 @@ static int s_test_input_stream_file_length(struct aws_allocator *allocator, void
 }
 
 AWS_TEST_CASE(test_input_stream_file_length, s_test_input_stream_file_length);
+
+static int s_test_input_stream_get_file(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_input_stream *memory_stream = s_create_memory_stream(allocator);
+    ASSERT_NULL(aws_input_stream_get_file(memory_stream));
+    s_destroy_memory_stream(memory_stream);
+
+    struct aws_input_stream *file_stream = s_create_file_stream(allocator);
+    FILE *file = aws_input_stream_get_file(file_stream);
+    ASSERT_NOT_NULL(file);
+
+    /* the FILE is the one the stream reads from, so reading the stream moves its position */
+    uint8_t read_data[4];
+    struct aws_byte_buf read_buf = aws_byte_buf_from_empty_array(read_data, sizeof(read_data));
+    ASSERT_SUCCESS(aws_input_stream_read(file_stream, &read_buf));
+    ASSERT_INT_EQUALS((long)read_buf.len, ftell(file));
+
+    s_destroy_file_stream(file_stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_get_file, s_test_input_stream_get_file);
+
+static int s_test_input_stream_mmap_iterate(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_input_stream *stream = s_create_mmap_stream(allocator);
+    ASSERT_NOT_NULL(stream);
+
+    struct aws_byte_cursor test_cursor = aws_byte_cursor_from_string(s_simple_test);
+    ASSERT_TRUE(s_do_simple_input_stream_test(stream, allocator, 2, &test_cursor) == AWS_OP_SUCCESS);
+
+    s_destroy_file_stream(stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_mmap_iterate, s_test_input_stream_mmap_iterate);
+
+static int s_test_input_stream_mmap_seek_and_length(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_input_stream *stream = s_create_mmap_stream(allocator);
+    ASSERT_NOT_NULL(stream);
+
+    struct aws_byte_cursor test_cursor = aws_byte_cursor_from_string(s_simple_test);
+    aws_byte_cursor_advance(&test_cursor, (size_t)((int64_t)s_simple_test->len + SEEK_END_OFFSET));
+    ASSERT_TRUE(
+        s_do_input_stream_seek_test(stream, allocator, SEEK_END_OFFSET, AWS_SSB_END, &test_cursor) == AWS_OP_SUCCESS);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_TRUE(length == (int64_t)s_simple_test->len);
+
+    ASSERT_TRUE(aws_input_stream_seek(stream, 13, AWS_SSB_BEGIN) == AWS_OP_ERR);
+    ASSERT_TRUE(aws_last_error() == AWS_IO_STREAM_INVALID_SEEK_POSITION);
+
+    s_destroy_file_stream(stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_mmap_seek_and_length, s_test_input_stream_mmap_seek_and_length);
+
+static int s_test_input_stream_mmap_empty_file(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    remove(s_test_file_name);
+    FILE *file = fopen(s_test_file_name, "w+");
+    fclose(file);
+
+    struct aws_input_stream *stream = aws_input_stream_new_from_mmap(allocator, s_test_file_name);
+    ASSERT_NOT_NULL(stream);
+
+    struct aws_stream_status status;
+    ASSERT_SUCCESS(aws_input_stream_get_status(stream, &status));
+    ASSERT_TRUE(status.is_end_of_stream);
+
+    int64_t length = -1;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_TRUE(length == 0);
+
+    s_destroy_file_stream(stream);
+
+    ASSERT_NULL(aws_input_stream_new_from_mmap(allocator, s_test_file_name));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_mmap_empty_file, s_test_input_stream_mmap_empty_file);
+
+static int s_test_input_stream_read_borrowed(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_input_stream *stream = s_create_mmap_stream(allocator);
+    ASSERT_NOT_NULL(stream);
+
+    /* the borrowed chunks are consecutive pieces of the stream's memory */
+    struct aws_byte_cursor expected = aws_byte_cursor_from_string(s_simple_test);
+    struct aws_byte_cursor chunk;
+    ASSERT_SUCCESS(aws_input_stream_read_borrowed(stream, 4, &chunk));
+    ASSERT_UINT_EQUALS(4, chunk.len);
+    const uint8_t *start = chunk.ptr;
+    ASSERT_BIN_ARRAYS_EQUALS(expected.ptr, 4, chunk.ptr, chunk.len);
+
+    ASSERT_SUCCESS(aws_input_stream_read_borrowed(stream, 100, &chunk));
+    ASSERT_PTR_EQUALS(start + 4, chunk.ptr);
+    ASSERT_BIN_ARRAYS_EQUALS(expected.ptr + 4, expected.len - 4, chunk.ptr, chunk.len);
+
+    ASSERT_SUCCESS(aws_input_stream_read_borrowed(stream, 100, &chunk));
+    ASSERT_UINT_EQUALS(0, chunk.len);
+
+    /* it shares its position with the copying reads */
+    ASSERT_SUCCESS(aws_input_stream_seek(stream, SEEK_BEGINNING_OFFSET, AWS_SSB_BEGIN));
+    ASSERT_SUCCESS(aws_input_stream_read_borrowed(stream, 1, &chunk));
+    ASSERT_PTR_EQUALS(start + SEEK_BEGINNING_OFFSET, chunk.ptr);
+
+    s_destroy_file_stream(stream);
+
+    struct aws_input_stream *memory_stream = s_create_memory_stream(allocator);
+    ASSERT_SUCCESS(aws_input_stream_read_borrowed(memory_stream, 100, &chunk));
+    ASSERT_PTR_EQUALS(s_simple_test->bytes, chunk.ptr);
+    ASSERT_UINT_EQUALS(s_simple_test->len, chunk.len);
+    s_destroy_memory_stream(memory_stream);
+
+    struct aws_input_stream *file_stream = s_create_file_stream(allocator);
+    ASSERT_FAILS(aws_input_stream_read_borrowed(file_stream, 100, &chunk));
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+    s_destroy_file_stream(file_stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_read_borrowed, s_test_input_stream_read_borrowed);
+
+static struct aws_shared_file *s_create_shared_file(struct aws_allocator *allocator) {
+    remove(s_test_file_name);
+
+    FILE *file = fopen(s_test_file_name, "w+");
+    fprintf(file, "%s", (char *)s_simple_test->bytes);
+    fclose(file);
+
+    return aws_shared_file_new(allocator, s_test_file_name);
+}
+
+static int s_test_input_stream_file_region_iterate(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_shared_file *shared_file = s_create_shared_file(allocator);
+    ASSERT_NOT_NULL(shared_file);
+    ASSERT_TRUE(aws_shared_file_get_length(shared_file) == (int64_t)s_simple_test->len);
+
+    struct aws_input_stream *head_stream = aws_input_stream_new_from_file_region(allocator, shared_file, 0, 6);
+    ASSERT_NOT_NULL(head_stream);
+    struct aws_input_stream *tail_stream =
+        aws_input_stream_new_from_file_region(allocator, shared_file, 6, s_simple_test->len - 6);
+    ASSERT_NOT_NULL(tail_stream);
+
+    /* the streams keep the file open on their own */
+    aws_shared_file_release(shared_file);
+
+    /* reading one stream doesn't move the other */
+    struct aws_byte_buf read_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buf, allocator, 2));
+    ASSERT_SUCCESS(aws_input_stream_read(tail_stream, &read_buf));
+    ASSERT_BIN_ARRAYS_EQUALS(s_simple_test->bytes + 6, 2, read_buf.buffer, read_buf.len);
+    ASSERT_SUCCESS(aws_input_stream_seek(tail_stream, 0, AWS_SSB_BEGIN));
+    aws_byte_buf_clean_up(&read_buf);
+
+    struct aws_byte_cursor head_cursor = aws_byte_cursor_from_array(s_simple_test->bytes, 6);
+    ASSERT_TRUE(s_do_simple_input_stream_test(head_stream, allocator, 4, &head_cursor) == AWS_OP_SUCCESS);
+
+    struct aws_byte_cursor tail_cursor = aws_byte_cursor_from_string(s_simple_test);
+    aws_byte_cursor_advance(&tail_cursor, 6);
+    ASSERT_TRUE(s_do_simple_input_stream_test(tail_stream, allocator, 100, &tail_cursor) == AWS_OP_SUCCESS);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(head_stream, &length));
+    ASSERT_TRUE(length == 6);
+
+    aws_input_stream_destroy(head_stream);
+    s_destroy_file_stream(tail_stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_file_region_iterate, s_test_input_stream_file_region_iterate);
+
+static int s_test_input_stream_file_region_bounds(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_shared_file *shared_file = s_create_shared_file(allocator);
+    ASSERT_NOT_NULL(shared_file);
+
+    /* the region must lie within the file */
+    ASSERT_NULL(aws_input_stream_new_from_file_region(allocator, shared_file, 4, s_simple_test->len));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+    ASSERT_NULL(aws_input_stream_new_from_file_region(allocator, shared_file, s_simple_test->len + 1, 0));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    /* seeks stay within the region */
+    struct aws_input_stream *stream = aws_input_stream_new_from_file_region(allocator, shared_file, 2, 6);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_TRUE(aws_input_stream_seek(stream, 7, AWS_SSB_BEGIN) == AWS_OP_ERR);
+    ASSERT_TRUE(aws_last_error() == AWS_IO_STREAM_INVALID_SEEK_POSITION);
+    ASSERT_TRUE(aws_input_stream_seek(stream, -7, AWS_SSB_END) == AWS_OP_ERR);
+    ASSERT_TRUE(aws_last_error() == AWS_IO_STREAM_INVALID_SEEK_POSITION);
+
+    ASSERT_SUCCESS(aws_input_stream_seek(stream, -2, AWS_SSB_END));
+    struct aws_byte_buf read_buf;
+    ASSERT_SUCCESS(aws_byte_buf_init(&read_buf, allocator, 100));
+    ASSERT_SUCCESS(aws_input_stream_read(stream, &read_buf));
+    ASSERT_BIN_ARRAYS_EQUALS(s_simple_test->bytes + 6, 2, read_buf.buffer, read_buf.len);
+
+    struct aws_stream_status status;
+    ASSERT_SUCCESS(aws_input_stream_get_status(stream, &status));
+    ASSERT_TRUE(status.is_end_of_stream);
+    aws_byte_buf_clean_up(&read_buf);
+    aws_input_stream_destroy(stream);
+
+    /* an empty region is over before it starts */
+    stream = aws_input_stream_new_from_file_region(allocator, shared_file, s_simple_test->len, 0);
+    ASSERT_NOT_NULL(stream);
+    ASSERT_SUCCESS(aws_input_stream_get_status(stream, &status));
+    ASSERT_TRUE(status.is_end_of_stream);
+    aws_input_stream_destroy(stream);
+
+    aws_shared_file_release(shared_file);
+    remove(s_test_file_name);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_file_region_bounds, s_test_input_stream_file_region_bounds);
+
+/* the standard check value: the checksum of "123456789" */
+AWS_STATIC_STRING_FROM_LITERAL(s_checksum_check_input, "123456789");
+
+static int s_do_checksum_stream_test(
+    struct aws_allocator *allocator,
+    enum aws_stream_checksum_algorithm algorithm,
+    uint32_t expected_checksum) {
+
+    struct aws_byte_cursor input_cursor = aws_byte_cursor_from_string(s_checksum_check_input);
+    struct aws_input_stream *source = aws_input_stream_new_from_cursor(allocator, &input_cursor);
+    ASSERT_NOT_NULL(source);
+
+    struct aws_input_stream *stream = aws_input_stream_new_checksum(allocator, source, algorithm);
+    ASSERT_NOT_NULL(stream);
+
+    /* odd sized reads, so the checksum is carried across them */
+    ASSERT_TRUE(s_do_simple_input_stream_test(stream, allocator, 2, &input_cursor) == AWS_OP_SUCCESS);
+
+    uint32_t checksum = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_checksum(stream, &checksum));
+    ASSERT_UINT_EQUALS(expected_checksum, checksum);
+
+    /* rewinding starts over, seeking elsewhere isn't allowed */
+    ASSERT_FAILS(aws_input_stream_seek(stream, 1, AWS_SSB_BEGIN));
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+    ASSERT_SUCCESS(aws_input_stream_seek(stream, 0, AWS_SSB_BEGIN));
+    ASSERT_SUCCESS(aws_input_stream_get_checksum(stream, &checksum));
+    ASSERT_UINT_EQUALS(0, checksum);
+
+    ASSERT_TRUE(s_do_simple_input_stream_test(stream, allocator, 5, &input_cursor) == AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_input_stream_get_checksum(stream, &checksum));
+    ASSERT_UINT_EQUALS(expected_checksum, checksum);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_TRUE(length == (int64_t)input_cursor.len);
+
+    aws_input_stream_destroy(stream);
+
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_input_stream_checksum_crc32(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_do_checksum_stream_test(allocator, AWS_SCA_CRC32, 0xCBF43926);
+}
+
+AWS_TEST_CASE(test_input_stream_checksum_crc32, s_test_input_stream_checksum_crc32);
+
+static int s_test_input_stream_checksum_crc32c(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    return s_do_checksum_stream_test(allocator, AWS_SCA_CRC32C, 0xE3069283);
+}
+
+AWS_TEST_CASE(test_input_stream_checksum_crc32c, s_test_input_stream_checksum_crc32c);
+
+/* bit at a time, straight from the definition */
+static uint32_t s_reference_crc(const uint8_t *input, size_t length, uint32_t polynomial) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= input[i];
+        for (size_t bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (polynomial & (0u - (crc & 1u)));
+        }
+    }
+
+    return ~crc;
+}
+
+/* Test that the word at a time paths agree with the definition at every alignment and length. */
+static int s_test_input_stream_checksum_large(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_buf input;
+    ASSERT_SUCCESS(aws_byte_buf_init(&input, allocator, 4099));
+    uint32_t state = 0x12345678;
+    while (input.len < input.capacity) {
+        state = state * 1103515245 + 12345;
+        aws_byte_buf_write_u8(&input, (uint8_t)(state >> 24));
+    }
+
+    struct aws_byte_cursor input_cursor = aws_byte_cursor_from_buf(&input);
+    for (size_t read_size = 1; read_size < 64; read_size += 7) {
+        struct aws_input_stream *crc32_stream = aws_input_stream_new_checksum(
+            allocator, aws_input_stream_new_from_cursor(allocator, &input_cursor), AWS_SCA_CRC32);
+        ASSERT_NOT_NULL(crc32_stream);
+        struct aws_input_stream *crc32c_stream = aws_input_stream_new_checksum(
+            allocator, aws_input_stream_new_from_cursor(allocator, &input_cursor), AWS_SCA_CRC32C);
+        ASSERT_NOT_NULL(crc32c_stream);
+
+        ASSERT_TRUE(s_do_simple_input_stream_test(crc32_stream, allocator, read_size, &input_cursor) == AWS_OP_SUCCESS);
+        ASSERT_TRUE(
+            s_do_simple_input_stream_test(crc32c_stream, allocator, read_size, &input_cursor) == AWS_OP_SUCCESS);
+
+        uint32_t checksum = 0;
+        ASSERT_SUCCESS(aws_input_stream_get_checksum(crc32_stream, &checksum));
+        ASSERT_UINT_EQUALS(s_reference_crc(input.buffer, input.len, 0xEDB88320), checksum);
+        ASSERT_SUCCESS(aws_input_stream_get_checksum(crc32c_stream, &checksum));
+        ASSERT_UINT_EQUALS(s_reference_crc(input.buffer, input.len, 0x82F63B78), checksum);
+
+        aws_input_stream_destroy(crc32_stream);
+        aws_input_stream_destroy(crc32c_stream);
+    }
+
+    /* only checksumming streams have a checksum */
+    struct aws_input_stream *memory_stream = s_create_memory_stream(allocator);
+    uint32_t checksum = 0;
+    ASSERT_FAILS(aws_input_stream_get_checksum(memory_stream, &checksum));
+    ASSERT_INT_EQUALS(AWS_ERROR_UNSUPPORTED_OPERATION, aws_last_error());
+    s_destroy_memory_stream(memory_stream);
+
+    aws_byte_buf_clean_up(&input);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_checksum_large, s_test_input_stream_checksum_large);
+
+/* counts the reads that reach a cursor stream */
+struct counting_stream_impl {
+    struct aws_input_stream *source;
+    size_t read_count;
+};
+
+static int s_counting_stream_seek(struct aws_input_stream *stream, aws_off_t offset, enum aws_stream_seek_basis basis) {
+    struct counting_stream_impl *impl = stream->impl;
+    return aws_input_stream_seek(impl->source, offset, basis);
+}
+
+static int s_counting_stream_read(struct aws_input_stream *stream, struct aws_byte_buf *dest) {
+    struct counting_stream_impl *impl = stream->impl;
+    impl->read_count++;
+    return aws_input_stream_read(impl->source, dest);
+}
+
+static int s_counting_stream_get_status(struct aws_input_stream *stream, struct aws_stream_status *status) {
+    struct counting_stream_impl *impl = stream->impl;
+    return aws_input_stream_get_status(impl->source, status);
+}
+
+static int s_counting_stream_get_length(struct aws_input_stream *stream, int64_t *out_length) {
+    struct counting_stream_impl *impl = stream->impl;
+    return aws_input_stream_get_length(impl->source, out_length);
+}
+
+static void s_counting_stream_destroy(struct aws_input_stream *stream) {
+    struct counting_stream_impl *impl = stream->impl;
+    aws_input_stream_destroy(impl->source);
+}
+
+static struct aws_input_stream_vtable s_counting_stream_vtable = {
+    .seek = s_counting_stream_seek,
+    .read = s_counting_stream_read,
+    .get_status = s_counting_stream_get_status,
+    .get_length = s_counting_stream_get_length,
+    .destroy = s_counting_stream_destroy,
+};
+
+static int s_test_input_stream_read_ahead(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_byte_buf input;
+    ASSERT_SUCCESS(aws_byte_buf_init(&input, allocator, 1000));
+    while (input.len < input.capacity) {
+        aws_byte_buf_write_u8(&input, (uint8_t)(input.len * 7));
+    }
+    struct aws_byte_cursor input_cursor = aws_byte_cursor_from_buf(&input);
+
+    struct counting_stream_impl counting_impl = {
+        .source = aws_input_stream_new_from_cursor(allocator, &input_cursor),
+    };
+    ASSERT_NOT_NULL(counting_impl.source);
+    struct aws_input_stream counting_stream = {
+        .allocator = allocator,
+        .impl = &counting_impl,
+        .vtable = &s_counting_stream_vtable,
+    };
+
+    ASSERT_NULL(aws_input_stream_new_read_ahead(allocator, &counting_stream, 0));
+    ASSERT_INT_EQUALS(AWS_ERROR_INVALID_ARGUMENT, aws_last_error());
+
+    struct aws_input_stream *stream = aws_input_stream_new_read_ahead(allocator, &counting_stream, 256);
+    ASSERT_NOT_NULL(stream);
+
+    /* 10 byte reads reach the source once per 256 bytes */
+    ASSERT_TRUE(s_do_simple_input_stream_test(stream, allocator, 10, &input_cursor) == AWS_OP_SUCCESS);
+    ASSERT_UINT_EQUALS(4, counting_impl.read_count);
+
+    /* seeking drops what was read ahead, and large reads go straight through */
+    ASSERT_SUCCESS(aws_input_stream_seek(stream, 0, AWS_SSB_BEGIN));
+    counting_impl.read_count = 0;
+    ASSERT_TRUE(s_do_simple_input_stream_test(stream, allocator, 512, &input_cursor) == AWS_OP_SUCCESS);
+    ASSERT_UINT_EQUALS(2, counting_impl.read_count);
+
+    int64_t length = 0;
+    ASSERT_SUCCESS(aws_input_stream_get_length(stream, &length));
+    ASSERT_TRUE(length == (int64_t)input.len);
+
+    aws_input_stream_destroy(stream);
+    aws_byte_buf_clean_up(&input);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_input_stream_read_ahead, s_test_input_stream_read_ahead);
@@ -0,0 +1,157 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/private/timer_wheel.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/task_scheduler.h>
+
+static const uint64_t s_tick_ns = AWS_TIMESTAMP_NANOS / AWS_TIMESTAMP_MILLIS;
+
+struct wheel_task_args {
+    struct aws_task task;
+    enum aws_task_status status;
+    size_t run_count;
+};
+
+static void s_wheel_task_fn(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct wheel_task_args *args = arg;
+    args->status = status;
+    args->run_count++;
+}
+
+static uint64_t s_ms_to_ns(uint64_t ms) {
+    return aws_timestamp_convert(ms, AWS_TIMESTAMP_MILLIS, AWS_TIMESTAMP_NANOS, NULL);
+}
+
+static int s_test_timer_wheel_fires_on_time(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    /* one per level, plus one beyond what the wheel spans */
+    const uint64_t delays_ms[] = {5, 100, 5000, 600000, 6 * 3600 * 1000};
+    enum { TASK_COUNT = AWS_ARRAY_SIZE(delays_ms) };
+    struct wheel_task_args args[TASK_COUNT];
+    AWS_ZERO_ARRAY(args);
+
+    const uint64_t start_ns = s_ms_to_ns(123456) + 789;
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, s_tick_ns, start_ns);
+
+    for (size_t i = 0; i < TASK_COUNT; ++i) {
+        aws_task_init(&args[i].task, s_wheel_task_fn, &args[i], "timer_wheel_fires_on_time");
+        aws_timer_wheel_schedule(&wheel, &args[i].task, start_ns + s_ms_to_ns(delays_ms[i]));
+    }
+
+    struct aws_linked_list due;
+    aws_linked_list_init(&due);
+
+    size_t fired = 0;
+    uint64_t now_ns = start_ns;
+    uint64_t deadline_ns = 0;
+    while (fired < TASK_COUNT) {
+        /* follow the wheel's deadlines the way an event loop would, never going further than a task's timestamp */
+        ASSERT_TRUE(aws_timer_wheel_next_deadline(&wheel, &deadline_ns));
+        ASSERT_TRUE(deadline_ns > now_ns);
+        now_ns = deadline_ns;
+        aws_timer_wheel_advance(&wheel, now_ns, &due);
+
+        while (!aws_linked_list_empty(&due)) {
+            struct aws_task *task = AWS_CONTAINER_OF(aws_linked_list_pop_front(&due), struct aws_task, node);
+            ASSERT_TRUE(task->timestamp <= now_ns);
+            ASSERT_TRUE(now_ns - task->timestamp < s_tick_ns);
+            struct wheel_task_args *task_args = task->arg;
+            ASSERT_UINT_EQUALS(fired, (size_t)(task_args - args));
+            ++fired;
+        }
+    }
+
+    ASSERT_FALSE(aws_timer_wheel_next_deadline(&wheel, &deadline_ns));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_fires_on_time, s_test_timer_wheel_fires_on_time)
+
+/* The event loop only advances when it wakes up, which may be long after a deadline. */
+static int s_test_timer_wheel_late_advance(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, s_tick_ns, 0);
+
+    struct wheel_task_args near_args;
+    struct wheel_task_args far_args;
+    aws_task_init(&near_args.task, s_wheel_task_fn, &near_args, "timer_wheel_late_advance_near");
+    aws_task_init(&far_args.task, s_wheel_task_fn, &far_args, "timer_wheel_late_advance_far");
+    aws_timer_wheel_schedule(&wheel, &near_args.task, s_ms_to_ns(20));
+    aws_timer_wheel_schedule(&wheel, &far_args.task, s_ms_to_ns(70000));
+
+    struct aws_linked_list due;
+    aws_linked_list_init(&due);
+
+    aws_timer_wheel_advance(&wheel, s_ms_to_ns(69999), &due);
+    ASSERT_PTR_EQUALS(&near_args.task.node, aws_linked_list_pop_front(&due));
+    ASSERT_TRUE(aws_linked_list_empty(&due));
+
+    /* something scheduled in the past comes out on the next tick */
+    struct wheel_task_args past_args;
+    aws_task_init(&past_args.task, s_wheel_task_fn, &past_args, "timer_wheel_late_advance_past");
+    aws_timer_wheel_schedule(&wheel, &past_args.task, s_ms_to_ns(10));
+
+    aws_timer_wheel_advance(&wheel, s_ms_to_ns(70000), &due);
+    size_t due_count = 0;
+    while (!aws_linked_list_empty(&due)) {
+        struct aws_linked_list_node *node = aws_linked_list_pop_front(&due);
+        ASSERT_TRUE(node == &far_args.task.node || node == &past_args.task.node);
+        ++due_count;
+    }
+    ASSERT_UINT_EQUALS(2, due_count);
+
+    uint64_t deadline_ns = 0;
+    ASSERT_FALSE(aws_timer_wheel_next_deadline(&wheel, &deadline_ns));
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_late_advance, s_test_timer_wheel_late_advance)
+
+/* Event loops cancel through their scheduler whether the task sits in it or in the wheel. */
+static int s_test_timer_wheel_cancel(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_task_scheduler scheduler;
+    ASSERT_SUCCESS(aws_task_scheduler_init(&scheduler, allocator));
+
+    struct aws_timer_wheel wheel;
+    aws_timer_wheel_init(&wheel, s_tick_ns, 0);
+
+    struct wheel_task_args canceled_args = {.run_count = 0};
+    struct wheel_task_args kept_args = {.run_count = 0};
+    aws_task_init(&canceled_args.task, s_wheel_task_fn, &canceled_args, "timer_wheel_cancel_canceled");
+    aws_task_init(&kept_args.task, s_wheel_task_fn, &kept_args, "timer_wheel_cancel_kept");
+    aws_timer_wheel_schedule(&wheel, &canceled_args.task, s_ms_to_ns(30));
+    aws_timer_wheel_schedule(&wheel, &kept_args.task, s_ms_to_ns(30));
+
+    aws_task_scheduler_cancel_task(&scheduler, &canceled_args.task);
+    ASSERT_UINT_EQUALS(1, canceled_args.run_count);
+    ASSERT_INT_EQUALS(AWS_TASK_STATUS_CANCELED, canceled_args.status);
+
+    struct aws_linked_list due;
+    aws_linked_list_init(&due);
+    aws_timer_wheel_advance(&wheel, s_ms_to_ns(30), &due);
+    ASSERT_PTR_EQUALS(&kept_args.task.node, aws_linked_list_pop_front(&due));
+    ASSERT_TRUE(aws_linked_list_empty(&due));
+    ASSERT_UINT_EQUALS(1, canceled_args.run_count);
+
+    aws_task_scheduler_clean_up(&scheduler);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(timer_wheel_cancel, s_test_timer_wheel_cancel)
@@ -56,6 +56,17 @@ struct tls_opt_tester {
     struct aws_tls_connection_options opt;
 };
 
+/* applied to every ctx the opt testers make, so one exchange can be run against different ctx configurations */
+struct tls_test_ctx_settings {
+    size_t input_ring_size;
+    bool enable_ktls;
+    /* server ctxs only, the test certificate's key is the server's. Each ctx gets a one loop group of its own. */
+    bool offload_private_key;
+    size_t connection_pool_size;
+};
+
+static struct tls_test_ctx_settings s_tls_ctx_settings;
+
 static int s_tls_server_opt_tester_init(struct aws_allocator *allocator, struct tls_opt_tester *tester) {
 
 #ifdef __APPLE__
@@ -67,7 +78,18 @@ static int s_tls_server_opt_tester_init(struct aws_allocator *allocator, struct
         &tester->ctx_options, allocator, "unittests.crt", "unittests.key"));
 #endif /* __APPLE__ */
     aws_tls_ctx_options_set_alpn_list(&tester->ctx_options, "h2;http/1.1");
+    aws_tls_ctx_options_set_input_ring_size(&tester->ctx_options, s_tls_ctx_settings.input_ring_size);
+    aws_tls_ctx_options_set_ktls_enabled(&tester->ctx_options, s_tls_ctx_settings.enable_ktls);
+    aws_tls_ctx_options_set_connection_pool_size(&tester->ctx_options, s_tls_ctx_settings.connection_pool_size);
+    struct aws_event_loop_group *offload_elg = NULL;
+    if (s_tls_ctx_settings.offload_private_key) {
+        offload_elg = aws_event_loop_group_new_default(allocator, 1, NULL);
+        ASSERT_NOT_NULL(offload_elg);
+        aws_tls_ctx_options_set_private_key_offload(&tester->ctx_options, offload_elg);
+    }
     tester->ctx = aws_tls_server_ctx_new(allocator, &tester->ctx_options);
+    /* the ctx holds the group from here on */
+    aws_event_loop_group_release(offload_elg);
     ASSERT_NOT_NULL(tester->ctx);
 
     aws_tls_connection_options_init_from_ctx(&tester->opt, tester->ctx);
@@ -83,6 +105,9 @@ static int s_tls_client_opt_tester_init(
 
     aws_tls_ctx_options_init_default_client(&tester->ctx_options, allocator);
     aws_tls_ctx_options_override_default_trust_store_from_path(&tester->ctx_options, NULL, "unittests.crt");
+    aws_tls_ctx_options_set_input_ring_size(&tester->ctx_options, s_tls_ctx_settings.input_ring_size);
+    aws_tls_ctx_options_set_ktls_enabled(&tester->ctx_options, s_tls_ctx_settings.enable_ktls);
+    aws_tls_ctx_options_set_connection_pool_size(&tester->ctx_options, s_tls_ctx_settings.connection_pool_size);
 
     tester->ctx = aws_tls_client_ctx_new(allocator, &tester->ctx_options);
     aws_tls_connection_options_init_from_ctx(&tester->opt, tester->ctx);
@@ -135,7 +160,10 @@ static int s_tls_test_arg_init(
     return AWS_OP_SUCCESS;
 }
 
-static int s_tls_common_tester_init(struct aws_allocator *allocator, struct tls_common_tester *tester) {
+static int s_tls_common_tester_init_with_loops(
+    struct aws_allocator *allocator,
+    struct tls_common_tester *tester,
+    uint16_t loop_count) {
     AWS_ZERO_STRUCT(*tester);
 
     struct aws_mutex mutex = AWS_MUTEX_INIT;
@@ -145,12 +173,16 @@ static int s_tls_common_tester_init(struct aws_allocator *allocator, struct tls_
     aws_atomic_store_int(&tester->current_time_ns, 0);
     aws_atomic_store_ptr(&tester->stats_handler, NULL);
 
-    tester->el_group = aws_event_loop_group_new_default(allocator, 0, NULL);
+    tester->el_group = aws_event_loop_group_new_default(allocator, loop_count, NULL);
     tester->resolver = aws_host_resolver_new_default(allocator, 1, tester->el_group, NULL);
 
     return AWS_OP_SUCCESS;
 }
 
+static int s_tls_common_tester_init(struct aws_allocator *allocator, struct tls_common_tester *tester) {
+    return s_tls_common_tester_init_with_loops(allocator, tester, 0);
+}
+
 static int s_tls_common_tester_clean_up(struct tls_common_tester *tester) {
     aws_host_resolver_release(tester->resolver);
     aws_event_loop_group_release(tester->el_group);
@@ -348,6 +380,8 @@ struct tls_test_rw_args {
     struct aws_mutex *mutex;
     struct aws_condition_variable *condition_variable;
     struct aws_byte_buf received_message;
+    /* for s_tls_test_read_all_predicate */
+    size_t expected_len;
     int read_invocations;
     bool invocation_happened;
 };
@@ -369,6 +403,12 @@ static bool s_tls_test_read_predicate(void *user_data) {
     return rw_args->invocation_happened;
 }
 
+static bool s_tls_test_read_all_predicate(void *user_data) {
+    struct tls_test_rw_args *rw_args = (struct tls_test_rw_args *)user_data;
+
+    return rw_args->received_message.len >= rw_args->expected_len;
+}
+
 static struct aws_byte_buf s_tls_test_handle_read(
     struct aws_channel_handler *handler,
     struct aws_channel_slot *slot,
@@ -381,48 +421,1018 @@ static struct aws_byte_buf s_tls_test_handle_read(
     struct tls_test_rw_args *rw_args = (struct tls_test_rw_args *)user_data;
     aws_mutex_lock(rw_args->mutex);
 
-    aws_byte_buf_write_from_whole_buffer(&rw_args->received_message, *data_read);
-    rw_args->read_invocations += 1;
-    rw_args->invocation_happened = true;
+    aws_byte_buf_write_from_whole_buffer(&rw_args->received_message, *data_read);
+    rw_args->read_invocations += 1;
+    rw_args->invocation_happened = true;
+
+    aws_mutex_unlock(rw_args->mutex);
+    aws_condition_variable_notify_one(rw_args->condition_variable);
+
+    return rw_args->received_message;
+}
+
+static struct aws_byte_buf s_tls_test_handle_write(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_byte_buf *data_read,
+    void *user_data) {
+
+    (void)handler;
+    (void)slot;
+    (void)data_read;
+    (void)user_data;
+
+    /*do nothing*/
+    return (struct aws_byte_buf){0};
+}
+
+/* the overhead a slot cached has to match what the handlers below it report now, e.g. once kTLS took over sends */
+static int s_tls_check_upstream_message_overhead(struct aws_channel_slot *slot) {
+    size_t expected_overhead = 0;
+    for (struct aws_channel_slot *below = slot->adj_left; below != NULL; below = below->adj_left) {
+        expected_overhead += below->handler->vtable->message_overhead(below->handler);
+    }
+
+    ASSERT_UINT_EQUALS(expected_overhead, aws_channel_slot_upstream_message_overhead(slot));
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_channel_echo_and_backpressure_common(
+    struct aws_allocator *allocator,
+    const struct tls_test_ctx_settings *settings) {
+    s_tls_ctx_settings = *settings;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
+
+    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    uint8_t incoming_received_message[128] = {0};
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct tls_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message))));
+
+    struct tls_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message))));
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, true));
+    /* make the windows small to make sure back pressure is honored. */
+    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, write_tag.len / 2, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_rw_handler);
+
+    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, read_tag.len / 2, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_rw_handler);
+
+    incoming_args.rw_handler = incoming_rw_handler;
+    outgoing_args.rw_handler = outgoing_rw_handler;
+
+    g_aws_channel_max_fragment_size = 4096;
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+    aws_tls_connection_options_set_callbacks(
+        &client_tls_opt_tester.opt, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.tls_options = &client_tls_opt_tester.opt;
+    channel_options.setup_callback = s_tls_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_tls_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+    channel_options.enable_read_back_pressure = true;
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    /* put this here to verify ownership semantics are correct. This should NOT cause a segfault. If it does, ya
+     * done messed up. */
+    aws_tls_connection_options_clean_up(&client_tls_opt_tester.opt);
+    /* wait for both ends to setup */
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_FALSE(incoming_args.error_invoked);
+
+/* currently it seems ALPN doesn't work in server mode. Just leaving this check out for now. */
+#ifndef __APPLE__
+    struct aws_byte_buf expected_protocol = aws_byte_buf_from_c_str("h2");
+
+    /* check ALPN and SNI was properly negotiated */
+    if (aws_tls_is_alpn_available()) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            expected_protocol.buffer,
+            expected_protocol.len,
+            incoming_args.negotiated_protocol.buffer,
+            incoming_args.negotiated_protocol.len);
+    }
+#endif
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_FALSE(outgoing_args.error_invoked);
+
+/* currently it seems ALPN doesn't work in server mode. Just leaving this check out for now. */
+#ifndef __MACH__
+    if (aws_tls_is_alpn_available()) {
+        ASSERT_BIN_ARRAYS_EQUALS(
+            expected_protocol.buffer,
+            expected_protocol.len,
+            outgoing_args.negotiated_protocol.buffer,
+            outgoing_args.negotiated_protocol.len);
+    }
+#endif
+
+    ASSERT_FALSE(outgoing_args.error_invoked);
+    ASSERT_SUCCESS(s_tls_check_upstream_message_overhead(outgoing_args.rw_slot));
+    ASSERT_SUCCESS(s_tls_check_upstream_message_overhead(incoming_args.rw_slot));
+
+    /* Do the IO operations */
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
+    rw_handler_write(incoming_args.rw_handler, incoming_args.rw_slot, &read_tag);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &outgoing_rw_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    incoming_rw_args.invocation_happened = false;
+    outgoing_rw_args.invocation_happened = false;
+
+    ASSERT_INT_EQUALS(1, outgoing_rw_args.read_invocations);
+    ASSERT_INT_EQUALS(1, incoming_rw_args.read_invocations);
+
+    /* Go ahead and verify back-pressure works*/
+    rw_handler_trigger_increment_read_window(incoming_args.rw_handler, incoming_args.rw_slot, 100);
+    rw_handler_trigger_increment_read_window(outgoing_args.rw_handler, outgoing_args.rw_slot, 100);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &outgoing_rw_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_INT_EQUALS(2, outgoing_rw_args.read_invocations);
+    ASSERT_INT_EQUALS(2, incoming_rw_args.read_invocations);
+
+    ASSERT_BIN_ARRAYS_EQUALS(
+        write_tag.buffer,
+        write_tag.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        read_tag.buffer, read_tag.len, outgoing_rw_args.received_message.buffer, outgoing_rw_args.received_message.len);
+
+    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    /*no shutdown on the client necessary here (it should have been triggered by shutting down the other side). just
+     * wait for the event to fire. */
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
+    aws_mutex_unlock(&c_tester.mutex);
+    /* clean up */
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_io_library_clean_up();
+    AWS_ZERO_STRUCT(s_tls_ctx_settings);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct tls_test_ctx_settings settings = {0};
+    return s_tls_channel_echo_and_backpressure_common(allocator, &settings);
+}
+
+AWS_TEST_CASE(tls_channel_echo_and_backpressure_test, s_tls_channel_echo_and_backpressure_test_fn)
+
+/* the same exchange with ciphertext read into each connection's input ring */
+static int s_tls_channel_echo_and_backpressure_input_ring_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct tls_test_ctx_settings settings = {
+        .input_ring_size = 32 * 1024,
+    };
+    return s_tls_channel_echo_and_backpressure_common(allocator, &settings);
+}
+
+AWS_TEST_CASE(tls_channel_echo_and_backpressure_input_ring_test, s_tls_channel_echo_and_backpressure_input_ring_test_fn)
+
+/*
+ * the same exchange with kTLS asked for on both ends. Where the kernel can't take the connection over, it falls back
+ * to s2n doing the record layer, and the exchange has to look the same either way.
+ */
+static int s_tls_channel_echo_and_backpressure_ktls_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct tls_test_ctx_settings settings = {
+        .enable_ktls = true,
+    };
+    return s_tls_channel_echo_and_backpressure_common(allocator, &settings);
+}
+
+AWS_TEST_CASE(tls_channel_echo_and_backpressure_ktls_test, s_tls_channel_echo_and_backpressure_ktls_test_fn)
+
+/* the same exchange with the server's signature made on an offload event loop */
+static int s_tls_channel_echo_and_backpressure_private_key_offload_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    struct tls_test_ctx_settings settings = {
+        .offload_private_key = true,
+    };
+    return s_tls_channel_echo_and_backpressure_common(allocator, &settings);
+}
+
+AWS_TEST_CASE(
+    tls_channel_echo_and_backpressure_private_key_offload_test,
+    s_tls_channel_echo_and_backpressure_private_key_offload_test_fn)
+
+/*
+ * parks an event loop until released, so work handed to it stays in flight as long as the test wants. The drain task
+ * tells the test when a loop has run everything scheduled on it before.
+ */
+struct tls_blocked_loop {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct aws_task task;
+    bool blocking;
+    bool released;
+    bool drained;
+};
+
+static bool s_tls_blocked_loop_blocking_predicate(void *user_data) {
+    struct tls_blocked_loop *blocked_loop = user_data;
+    return blocked_loop->blocking;
+}
+
+static bool s_tls_blocked_loop_released_predicate(void *user_data) {
+    struct tls_blocked_loop *blocked_loop = user_data;
+    return blocked_loop->released;
+}
+
+static bool s_tls_blocked_loop_drained_predicate(void *user_data) {
+    struct tls_blocked_loop *blocked_loop = user_data;
+    return blocked_loop->drained;
+}
+
+static void s_tls_block_loop_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct tls_blocked_loop *blocked_loop = arg;
+
+    aws_mutex_lock(blocked_loop->mutex);
+    blocked_loop->blocking = true;
+    aws_condition_variable_notify_all(blocked_loop->condition_variable);
+    aws_condition_variable_wait_pred(
+        blocked_loop->condition_variable, blocked_loop->mutex, s_tls_blocked_loop_released_predicate, blocked_loop);
+    aws_mutex_unlock(blocked_loop->mutex);
+}
+
+static void s_tls_drain_loop_task(struct aws_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    (void)status;
+    struct tls_blocked_loop *blocked_loop = arg;
+
+    aws_mutex_lock(blocked_loop->mutex);
+    blocked_loop->drained = true;
+    aws_mutex_unlock(blocked_loop->mutex);
+    aws_condition_variable_notify_all(blocked_loop->condition_variable);
+}
+
+/*
+ * The client gives up on negotiation while the server's signature is stuck on a blocked offload loop, so the server
+ * channel shuts down with the operation in flight. The server's ctx is released before the operation gets to run: the
+ * handler's hold on the channel has to keep the ctx, and the key the operation signs with, alive until it comes back.
+ */
+static int s_tls_private_key_offload_shutdown_in_flight_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
+    s_tls_ctx_settings.offload_private_key = true;
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    /* the loop stays valid for as long as the server ctx, or a handler made from it, is around */
+    struct aws_tls_ctx_options *server_ctx_options = &local_server_tester.server_tls_opt_tester.ctx_options;
+    struct aws_event_loop *offload_loop =
+        aws_event_loop_group_get_next_loop(server_ctx_options->private_key_offload_elg);
+
+    struct tls_blocked_loop blocked_loop = {
+        .mutex = &c_tester.mutex,
+        .condition_variable = &c_tester.condition_variable,
+    };
+    aws_task_init(&blocked_loop.task, s_tls_block_loop_task, &blocked_loop, "tls_test_block_loop");
+    aws_event_loop_schedule_task_now(offload_loop, &blocked_loop.task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_blocked_loop_blocking_predicate, &blocked_loop));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+    client_tls_opt_tester.opt.timeout_ms = 500;
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester.endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester.socket_options;
+    channel_options.tls_options = &client_tls_opt_tester.opt;
+    channel_options.setup_callback = s_tls_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_tls_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_TRUE(outgoing_args.error_invoked);
+    ASSERT_INT_EQUALS(AWS_IO_TLS_NEGOTIATION_TIMEOUT, outgoing_args.last_error_code);
+    /* the server channel is gone as far as its creator knows, the offloaded operation is still holding it */
+    ASSERT_TRUE(incoming_args.error_invoked);
+    ASSERT_FALSE(incoming_args.tls_negotiated);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    /* drop every reference the test had to the server ctx before the operation runs */
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+
+    /* let the operation run, then wait until the offload loop has handed it back to the server channel */
+    struct aws_task drain_task;
+    aws_task_init(&drain_task, s_tls_drain_loop_task, &blocked_loop, "tls_test_drain_loop");
+    aws_event_loop_schedule_task_now(offload_loop, &drain_task);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    blocked_loop.released = true;
+    aws_condition_variable_notify_all(&c_tester.condition_variable);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_blocked_loop_drained_predicate, &blocked_loop));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_io_library_clean_up();
+    AWS_ZERO_STRUCT(s_tls_ctx_settings);
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_private_key_offload_shutdown_in_flight, s_tls_private_key_offload_shutdown_in_flight_test_fn)
+
+/*
+ * A client that connects without TLS and sets it up from its setup callback, the way a proxy tunnel would. Unlike a
+ * bootstrapped TLS channel, the test gets at the channel before negotiation finishes.
+ */
+struct tls_layered_client_args {
+    struct tls_test_args *test_args;
+    struct aws_tls_connection_options *tls_options;
+    /* optional, goes between the socket and TLS handlers */
+    struct aws_channel_handler *under_tls_handler;
+    /* runs on the channel's thread once every handler is in, negotiation has only just started then */
+    void (*on_layered)(struct aws_channel_slot *rw_slot, void *user_data);
+    void *user_data;
+};
+
+static void s_tls_layered_client_setup_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    struct tls_layered_client_args *layered_args = user_data;
+
+    if (!error_code) {
+        struct aws_channel_slot *tls_left_slot = aws_channel_get_first_slot(channel);
+        if (layered_args->under_tls_handler) {
+            struct aws_channel_slot *under_tls_slot = aws_channel_slot_new(channel);
+            aws_channel_slot_insert_right(tls_left_slot, under_tls_slot);
+            aws_channel_slot_set_handler(under_tls_slot, layered_args->under_tls_handler);
+            tls_left_slot = under_tls_slot;
+        }
+
+        if (aws_channel_setup_client_tls(tls_left_slot, layered_args->tls_options)) {
+            aws_channel_shutdown(channel, aws_last_error());
+        }
+    }
+
+    /* puts the rw handler at the end, above the TLS handler */
+    s_tls_handler_test_client_setup_callback(bootstrap, error_code, channel, layered_args->test_args);
+
+    if (!error_code && layered_args->on_layered) {
+        layered_args->on_layered(layered_args->test_args->rw_slot, layered_args->user_data);
+    }
+}
+
+static void s_tls_layered_client_shutdown_callback(
+    struct aws_client_bootstrap *bootstrap,
+    int error_code,
+    struct aws_channel *channel,
+    void *user_data) {
+
+    struct tls_layered_client_args *layered_args = user_data;
+    s_tls_handler_test_client_shutdown_callback(bootstrap, error_code, channel, layered_args->test_args);
+}
+
+static int s_tls_layered_client_connect(
+    struct aws_client_bootstrap *client_bootstrap,
+    struct tls_local_server_tester *local_server_tester,
+    struct tls_layered_client_args *layered_args) {
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester->endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester->socket_options;
+    channel_options.setup_callback = s_tls_layered_client_setup_callback;
+    channel_options.shutdown_callback = s_tls_layered_client_shutdown_callback;
+    channel_options.user_data = layered_args;
+
+    return aws_client_bootstrap_new_socket_channel(&channel_options);
+}
+
+#define TLS_TEST_WRITE_COUNT 3
+
+struct tls_test_writes;
+
+struct tls_test_write {
+    struct tls_test_writes *writes;
+    size_t completions;
+    int error_code;
+};
+
+/* application writes sent from the test, and what their completions reported */
+struct tls_test_writes {
+    struct aws_mutex *mutex;
+    struct aws_condition_variable *condition_variable;
+    struct tls_test_write writes[TLS_TEST_WRITE_COUNT];
+    const char *payloads[TLS_TEST_WRITE_COUNT];
+    size_t completed;
+    int send_error_code;
+};
+
+static bool s_tls_test_writes_completed_predicate(void *user_data) {
+    struct tls_test_writes *writes = user_data;
+    return writes->completed >= TLS_TEST_WRITE_COUNT;
+}
+
+static void s_tls_test_write_completed(
+    struct aws_channel *channel,
+    struct aws_io_message *message,
+    int err_code,
+    void *user_data) {
+
+    (void)channel;
+    (void)message;
+
+    struct tls_test_write *write = user_data;
+    struct tls_test_writes *writes = write->writes;
+
+    aws_mutex_lock(writes->mutex);
+    write->completions += 1;
+    write->error_code = err_code;
+    writes->completed += 1;
+    aws_mutex_unlock(writes->mutex);
+    aws_condition_variable_notify_all(writes->condition_variable);
+}
+
+/* sends each payload as its own message, with nothing in the way of it going out before negotiation has finished */
+static void s_tls_test_send_writes(struct aws_channel_slot *rw_slot, void *user_data) {
+    struct tls_test_writes *writes = user_data;
+
+    for (size_t i = 0; i < TLS_TEST_WRITE_COUNT; ++i) {
+        struct aws_byte_cursor payload = aws_byte_cursor_from_c_str(writes->payloads[i]);
+        struct aws_io_message *message =
+            aws_channel_acquire_message_from_pool(rw_slot->channel, AWS_IO_MESSAGE_APPLICATION_DATA, payload.len);
+        aws_byte_buf_write_from_whole_cursor(&message->message_data, payload);
+        writes->writes[i].writes = writes;
+        message->on_completion = s_tls_test_write_completed;
+        message->user_data = &writes->writes[i];
+
+        if (aws_channel_slot_send_message(rw_slot, message, AWS_CHANNEL_DIR_WRITE)) {
+            writes->send_error_code = aws_last_error();
+            aws_mem_release(message->allocator, message);
+            return;
+        }
+    }
+}
+
+static void s_tls_test_writes_init(struct tls_test_writes *writes, struct tls_common_tester *tls_c_tester) {
+    AWS_ZERO_STRUCT(*writes);
+    writes->mutex = &tls_c_tester->mutex;
+    writes->condition_variable = &tls_c_tester->condition_variable;
+    writes->payloads[0] = "one, ";
+    writes->payloads[1] = "two, ";
+    writes->payloads[2] = "three";
+}
+
+/* writes sent while the handshake is still going arrive after it, in order, and each completes once */
+static int s_tls_queue_writes_before_negotiation_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
+
+    struct aws_byte_cursor expected = aws_byte_cursor_from_c_str("one, two, three");
+    uint8_t incoming_received_message[128] = {0};
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct tls_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message))));
+    incoming_rw_args.expected_len = expected.len;
+
+    struct tls_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message))));
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    incoming_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_args.rw_handler);
+    outgoing_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+    client_tls_opt_tester.opt.queue_writes_before_negotiation = true;
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    struct tls_test_writes writes;
+    s_tls_test_writes_init(&writes, &c_tester);
+    struct tls_layered_client_args layered_args = {
+        .test_args = &outgoing_args,
+        .tls_options = &client_tls_opt_tester.opt,
+        .on_layered = s_tls_test_send_writes,
+        .user_data = &writes,
+    };
+    ASSERT_SUCCESS(s_tls_layered_client_connect(client_bootstrap, &local_server_tester, &layered_args));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_all_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_writes_completed_predicate, &writes));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_FALSE(outgoing_args.error_invoked);
+    ASSERT_FALSE(incoming_args.error_invoked);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, writes.send_error_code);
+    ASSERT_BIN_ARRAYS_EQUALS(
+        expected.ptr,
+        expected.len,
+        incoming_rw_args.received_message.buffer,
+        incoming_rw_args.received_message.len);
+    for (size_t i = 0; i < TLS_TEST_WRITE_COUNT; ++i) {
+        ASSERT_UINT_EQUALS(1, writes.writes[i].completions);
+        ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, writes.writes[i].error_code);
+    }
+
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    /* no completion fired a second time on the way down */
+    for (size_t i = 0; i < TLS_TEST_WRITE_COUNT; ++i) {
+        ASSERT_UINT_EQUALS(1, writes.writes[i].completions);
+    }
+
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_io_library_clean_up();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_queue_writes_before_negotiation, s_tls_queue_writes_before_negotiation_test_fn)
+
+/* the client won't accept the server's certificate for this name, every queued write completes with the failure */
+static int s_tls_queue_writes_before_failed_negotiation_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
+
+    uint8_t outgoing_received_message[128] = {0};
+    struct tls_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message))));
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    outgoing_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("derp.com");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+    client_tls_opt_tester.opt.queue_writes_before_negotiation = true;
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    struct tls_test_writes writes;
+    s_tls_test_writes_init(&writes, &c_tester);
+    struct tls_layered_client_args layered_args = {
+        .test_args = &outgoing_args,
+        .tls_options = &client_tls_opt_tester.opt,
+        .on_layered = s_tls_test_send_writes,
+        .user_data = &writes,
+    };
+    ASSERT_SUCCESS(s_tls_layered_client_connect(client_bootstrap, &local_server_tester, &layered_args));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_TRUE(incoming_args.error_invoked);
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, writes.send_error_code);
+    ASSERT_UINT_EQUALS(TLS_TEST_WRITE_COUNT, writes.completed);
+    for (size_t i = 0; i < TLS_TEST_WRITE_COUNT; ++i) {
+        ASSERT_UINT_EQUALS(1, writes.writes[i].completions);
+        ASSERT_INT_EQUALS(AWS_IO_TLS_ERROR_NEGOTIATION_FAILURE, writes.writes[i].error_code);
+    }
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_io_library_clean_up();
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(tls_queue_writes_before_failed_negotiation, s_tls_queue_writes_before_failed_negotiation_test_fn)
+
+#define TLS_RECORD_HEADER_LEN 5
+
+/*
+ * Goes under the TLS handler and counts the messages it sends down, and the TLS records in them, which it follows
+ * across message boundaries. Reads pass it by. It can also be told to fail every write from then on. The test owns it,
+ * so the counts are still there after the channel is gone.
+ */
+struct tls_write_tap {
+    struct aws_channel_handler handler;
+    struct aws_mutex *mutex;
+    uint8_t record_header[TLS_RECORD_HEADER_LEN];
+    size_t record_header_len;
+    size_t record_body_remaining;
+    size_t messages;
+    size_t records;
+    bool fail_writes;
+};
+
+static int s_tls_write_tap_process_write_message(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    struct aws_io_message *message) {
+
+    struct tls_write_tap *tap = handler->impl;
+    if (tap->fail_writes) {
+        return aws_raise_error(AWS_IO_SOCKET_CLOSED);
+    }
+
+    aws_mutex_lock(tap->mutex);
+    tap->messages += 1;
+    struct aws_byte_cursor data = aws_byte_cursor_from_buf(&message->message_data);
+    while (data.len) {
+        if (tap->record_body_remaining) {
+            size_t skipped = aws_min_size(tap->record_body_remaining, data.len);
+            aws_byte_cursor_advance(&data, skipped);
+            tap->record_body_remaining -= skipped;
+            continue;
+        }
+
+        tap->record_header[tap->record_header_len++] = *aws_byte_cursor_advance(&data, 1).ptr;
+        if (tap->record_header_len == TLS_RECORD_HEADER_LEN) {
+            /* content type, legacy version, then the length of what follows */
+            tap->record_body_remaining = ((size_t)tap->record_header[3] << 8) | tap->record_header[4];
+            tap->record_header_len = 0;
+            tap->records += 1;
+        }
+    }
+    aws_mutex_unlock(tap->mutex);
+
+    return aws_channel_slot_send_message(slot, message, AWS_CHANNEL_DIR_WRITE);
+}
+
+static int s_tls_write_tap_increment_read_window(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    size_t size) {
+    (void)handler;
+
+    return aws_channel_slot_increment_read_window(slot, size);
+}
+
+static int s_tls_write_tap_shutdown(
+    struct aws_channel_handler *handler,
+    struct aws_channel_slot *slot,
+    enum aws_channel_direction dir,
+    int error_code,
+    bool free_scarce_resources_immediately) {
+    (void)handler;
+
+    return aws_channel_slot_on_handler_shutdown_complete(slot, dir, error_code, free_scarce_resources_immediately);
+}
+
+static size_t s_tls_write_tap_initial_window_size(struct aws_channel_handler *handler) {
+    (void)handler;
+
+    return SIZE_MAX;
+}
+
+static size_t s_tls_write_tap_message_overhead(struct aws_channel_handler *handler) {
+    (void)handler;
+
+    return 0;
+}
+
+static void s_tls_write_tap_destroy(struct aws_channel_handler *handler) {
+    (void)handler;
+}
+
+static struct aws_channel_handler_vtable s_tls_write_tap_vtable = {
+    .process_write_message = s_tls_write_tap_process_write_message,
+    .increment_read_window = s_tls_write_tap_increment_read_window,
+    .shutdown = s_tls_write_tap_shutdown,
+    .initial_window_size = s_tls_write_tap_initial_window_size,
+    .message_overhead = s_tls_write_tap_message_overhead,
+    .destroy = s_tls_write_tap_destroy,
+};
+
+static void s_tls_write_tap_init(
+    struct tls_write_tap *tap,
+    struct aws_allocator *allocator,
+    struct tls_common_tester *tls_c_tester) {
+    AWS_ZERO_STRUCT(*tap);
+    tap->handler.alloc = allocator;
+    tap->handler.vtable = &s_tls_write_tap_vtable;
+    tap->handler.impl = tap;
+    tap->mutex = &tls_c_tester->mutex;
+}
+
+/* sends the test's writes from the channel's thread once the handshake is over, optionally failing the tap first */
+struct tls_test_send_task {
+    struct aws_channel_task task;
+    struct aws_channel_slot *rw_slot;
+    struct tls_test_writes *writes;
+    struct tls_write_tap *tap_to_fail;
+};
+
+static void s_tls_test_send_task(struct aws_channel_task *task, void *arg, enum aws_task_status status) {
+    (void)task;
+    struct tls_test_send_task *send_task = arg;
+
+    if (status == AWS_TASK_STATUS_RUN_READY) {
+        if (send_task->tap_to_fail) {
+            send_task->tap_to_fail->fail_writes = true;
+        }
+        s_tls_test_send_writes(send_task->rw_slot, send_task->writes);
+    }
+}
+
+static bool s_tls_write_tap_at_record_boundary(struct tls_write_tap *tap) {
+    return tap->records > 0 && tap->record_header_len == 0 && tap->record_body_remaining == 0;
+}
+
+/*
+ * The records s2n produces during one call go downstream packed together rather than a message each. Small records
+ * from dynamic record sizing make a single large write produce plenty of them, and the handshake flights add a few
+ * more. Packing only ever happens within an s2n call, so separate writes still get a message each.
+ */
+static int s_tls_handler_packs_records_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
+
+    /* one message's worth, rw_handler_write() doesn't split */
+    const size_t payload_len = 8 * 1024;
+    struct aws_byte_buf payload;
+    ASSERT_SUCCESS(aws_byte_buf_init(&payload, allocator, payload_len));
+    while (payload.len < payload_len) {
+        aws_byte_buf_write_u8(&payload, (uint8_t)('a' + payload.len % 26));
+    }
+
+    struct aws_byte_buf incoming_received_message;
+    ASSERT_SUCCESS(aws_byte_buf_init(&incoming_received_message, allocator, payload_len));
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct tls_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(&incoming_rw_args, &c_tester, incoming_received_message));
+    incoming_rw_args.expected_len = payload_len;
+
+    struct tls_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message))));
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    incoming_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_args.rw_handler);
+    outgoing_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+    /* never grow to full size records */
+    aws_tls_connection_options_set_dynamic_record_sizing(&client_tls_opt_tester.opt, UINT32_MAX, 0);
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    struct tls_write_tap tap;
+    s_tls_write_tap_init(&tap, allocator, &c_tester);
+    struct tls_layered_client_args layered_args = {
+        .test_args = &outgoing_args,
+        .tls_options = &client_tls_opt_tester.opt,
+        .under_tls_handler = &tap.handler,
+    };
+    ASSERT_SUCCESS(s_tls_layered_client_connect(client_bootstrap, &local_server_tester, &layered_args));
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_FALSE(outgoing_args.error_invoked);
+    ASSERT_FALSE(incoming_args.error_invoked);
+
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &payload);
 
-    aws_mutex_unlock(rw_args->mutex);
-    aws_condition_variable_notify_one(rw_args->condition_variable);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_all_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
-    return rw_args->received_message;
-}
+    /* everything the server got went through the tap first, and ended on a record boundary */
+    ASSERT_TRUE(s_tls_write_tap_at_record_boundary(&tap));
+    /* a small record holds well under 2KB, so the write alone made several of them */
+    ASSERT_TRUE(tap.records >= payload_len / 2048);
+    ASSERT_TRUE(tap.messages < tap.records);
 
-static struct aws_byte_buf s_tls_test_handle_write(
-    struct aws_channel_handler *handler,
-    struct aws_channel_slot *slot,
-    struct aws_byte_buf *data_read,
-    void *user_data) {
+    ASSERT_BIN_ARRAYS_EQUALS(
+        payload.buffer, payload.len, incoming_rw_args.received_message.buffer, incoming_rw_args.received_message.len);
 
-    (void)handler;
-    (void)slot;
-    (void)data_read;
-    (void)user_data;
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
-    /*do nothing*/
-    return (struct aws_byte_buf){0};
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_byte_buf_clean_up(&incoming_rw_args.received_message);
+    aws_byte_buf_clean_up(&payload);
+    aws_io_library_clean_up();
+    return AWS_OP_SUCCESS;
 }
 
-static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *allocator, void *ctx) {
+AWS_TEST_CASE(tls_handler_packs_records, s_tls_handler_packs_records_test_fn)
+
+/*
+ * Once s2n has taken a write, its ciphertext failing to go downstream can't be handed back to the writer. The write
+ * completes with the error, exactly once, and the channel shuts down.
+ */
+static int s_tls_handler_downstream_write_failure_test_fn(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     aws_io_library_init(allocator);
     ASSERT_SUCCESS(s_tls_common_tester_init(allocator, &c_tester));
 
-    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
-    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
-
-    uint8_t incoming_received_message[128] = {0};
     uint8_t outgoing_received_message[128] = {0};
-
-    struct tls_test_rw_args incoming_rw_args;
-    ASSERT_SUCCESS(s_tls_rw_args_init(
-        &incoming_rw_args,
-        &c_tester,
-        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message))));
-
     struct tls_test_rw_args outgoing_rw_args;
     ASSERT_SUCCESS(s_tls_rw_args_init(
         &outgoing_rw_args,
@@ -436,26 +1446,15 @@ static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *all
     ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
 
     struct tls_local_server_tester local_server_tester;
-    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, true));
-    /* make the windows small to make sure back pressure is honored. */
-    struct aws_channel_handler *outgoing_rw_handler = rw_handler_new(
-        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, write_tag.len / 2, &outgoing_rw_args);
-    ASSERT_NOT_NULL(outgoing_rw_handler);
-
-    struct aws_channel_handler *incoming_rw_handler = rw_handler_new(
-        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, read_tag.len / 2, &incoming_rw_args);
-    ASSERT_NOT_NULL(incoming_rw_handler);
-
-    incoming_args.rw_handler = incoming_rw_handler;
-    outgoing_args.rw_handler = outgoing_rw_handler;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
 
-    g_aws_channel_max_fragment_size = 4096;
+    outgoing_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
 
     struct tls_opt_tester client_tls_opt_tester;
     struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
     ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
-    aws_tls_connection_options_set_callbacks(
-        &client_tls_opt_tester.opt, s_tls_on_negotiated, NULL, NULL, &outgoing_args);
 
     struct aws_client_bootstrap_options bootstrap_options = {
         .event_loop_group = c_tester.el_group,
@@ -463,92 +1462,138 @@ static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *all
     };
     struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
 
-    struct aws_socket_channel_bootstrap_options channel_options;
-    AWS_ZERO_STRUCT(channel_options);
-    channel_options.bootstrap = client_bootstrap;
-    channel_options.host_name = local_server_tester.endpoint.address;
-    channel_options.port = 0;
-    channel_options.socket_options = &local_server_tester.socket_options;
-    channel_options.tls_options = &client_tls_opt_tester.opt;
-    channel_options.setup_callback = s_tls_handler_test_client_setup_callback;
-    channel_options.shutdown_callback = s_tls_handler_test_client_shutdown_callback;
-    channel_options.user_data = &outgoing_args;
-    channel_options.enable_read_back_pressure = true;
-
-    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
+    struct tls_write_tap tap;
+    s_tls_write_tap_init(&tap, allocator, &c_tester);
+    struct tls_layered_client_args layered_args = {
+        .test_args = &outgoing_args,
+        .tls_options = &client_tls_opt_tester.opt,
+        .under_tls_handler = &tap.handler,
+    };
+    ASSERT_SUCCESS(s_tls_layered_client_connect(client_bootstrap, &local_server_tester, &layered_args));
 
-    /* put this here to verify ownership semantics are correct. This should NOT cause a segfault. If it does, ya
-     * done messed up. */
-    aws_tls_connection_options_clean_up(&client_tls_opt_tester.opt);
-    /* wait for both ends to setup */
+    /* the server is done once it has the client's Finished, which the client sends as it finishes itself */
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &incoming_args));
     ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_FALSE(outgoing_args.error_invoked);
     ASSERT_FALSE(incoming_args.error_invoked);
 
-/* currently it seems ALPN doesn't work in server mode. Just leaving this check out for now. */
-#ifndef __APPLE__
-    struct aws_byte_buf expected_protocol = aws_byte_buf_from_c_str("h2");
-
-    /* check ALPN and SNI was properly negotiated */
-    if (aws_tls_is_alpn_available()) {
-        ASSERT_BIN_ARRAYS_EQUALS(
-            expected_protocol.buffer,
-            expected_protocol.len,
-            incoming_args.negotiated_protocol.buffer,
-            incoming_args.negotiated_protocol.len);
-    }
-#endif
+    struct tls_test_writes writes;
+    s_tls_test_writes_init(&writes, &c_tester);
+    struct tls_test_send_task send_task = {
+        .rw_slot = outgoing_args.rw_slot,
+        .writes = &writes,
+        .tap_to_fail = &tap,
+    };
+    aws_channel_task_init(&send_task.task, s_tls_test_send_task, &send_task, "tls_test_send_writes");
+    aws_channel_schedule_task_now(outgoing_args.channel, &send_task.task);
 
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &incoming_args));
     ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
-    ASSERT_FALSE(outgoing_args.error_invoked);
 
-/* currently it seems ALPN doesn't work in server mode. Just leaving this check out for now. */
-#ifndef __MACH__
-    if (aws_tls_is_alpn_available()) {
-        ASSERT_BIN_ARRAYS_EQUALS(
-            expected_protocol.buffer,
-            expected_protocol.len,
-            outgoing_args.negotiated_protocol.buffer,
-            outgoing_args.negotiated_protocol.len);
+    /* s2n took every write, so none of them went back to the sender as a failed send */
+    ASSERT_INT_EQUALS(AWS_ERROR_SUCCESS, writes.send_error_code);
+    ASSERT_UINT_EQUALS(TLS_TEST_WRITE_COUNT, writes.completed);
+    for (size_t i = 0; i < TLS_TEST_WRITE_COUNT; ++i) {
+        ASSERT_UINT_EQUALS(1, writes.writes[i].completions);
+        ASSERT_INT_EQUALS(AWS_IO_SOCKET_CLOSED, writes.writes[i].error_code);
     }
-#endif
 
-    ASSERT_FALSE(outgoing_args.error_invoked);
-
-    /* Do the IO operations */
-    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
-    rw_handler_write(incoming_args.rw_handler, incoming_args.rw_slot, &read_tag);
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &incoming_rw_args));
-    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &outgoing_rw_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
     ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
-    incoming_rw_args.invocation_happened = false;
-    outgoing_rw_args.invocation_happened = false;
+    ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
+    aws_client_bootstrap_release(client_bootstrap);
+    ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
+    ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
+    aws_io_library_clean_up();
+    return AWS_OP_SUCCESS;
+}
 
-    ASSERT_INT_EQUALS(1, outgoing_rw_args.read_invocations);
-    ASSERT_INT_EQUALS(1, incoming_rw_args.read_invocations);
+AWS_TEST_CASE(tls_handler_downstream_write_failure, s_tls_handler_downstream_write_failure_test_fn)
 
-    /* Go ahead and verify back-pressure works*/
-    rw_handler_trigger_increment_read_window(incoming_args.rw_handler, incoming_args.rw_slot, 100);
-    rw_handler_trigger_increment_read_window(outgoing_args.rw_handler, outgoing_args.rw_slot, 100);
+/*
+ * Connects to the local server, sends a message each way and shuts down. Both channels live on the tester's only
+ * loop, and by the time this returns that loop has destroyed them, so their connections are back in the pools.
+ */
+static int s_tls_pooled_connection_round(
+    struct aws_allocator *allocator,
+    struct tls_local_server_tester *local_server_tester,
+    struct tls_test_args *incoming_args,
+    struct tls_opt_tester *client_tls_opt_tester,
+    struct aws_client_bootstrap *client_bootstrap) {
+
+    struct aws_byte_buf read_tag = aws_byte_buf_from_c_str("I'm a little teapot.");
+    struct aws_byte_buf write_tag = aws_byte_buf_from_c_str("I'm a big teapot");
+
+    uint8_t incoming_received_message[128] = {0};
+    uint8_t outgoing_received_message[128] = {0};
+
+    struct tls_test_rw_args incoming_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &incoming_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(incoming_received_message, sizeof(incoming_received_message))));
+    incoming_rw_args.expected_len = write_tag.len;
+
+    struct tls_test_rw_args outgoing_rw_args;
+    ASSERT_SUCCESS(s_tls_rw_args_init(
+        &outgoing_rw_args,
+        &c_tester,
+        aws_byte_buf_from_empty_array(outgoing_received_message, sizeof(outgoing_received_message))));
+    outgoing_rw_args.expected_len = read_tag.len;
+
+    struct tls_test_args outgoing_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &outgoing_args, false, &c_tester));
+    outgoing_args.rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &outgoing_rw_args);
+    ASSERT_NOT_NULL(outgoing_args.rw_handler);
+
+    /* the listener keeps pointing at the same args, every round starts them over */
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, incoming_args, true, &c_tester));
+    incoming_args->rw_handler = rw_handler_new(
+        allocator, s_tls_test_handle_read, s_tls_test_handle_write, true, 10000, &incoming_rw_args);
+    ASSERT_NOT_NULL(incoming_args->rw_handler);
+
+    struct aws_socket_channel_bootstrap_options channel_options;
+    AWS_ZERO_STRUCT(channel_options);
+    channel_options.bootstrap = client_bootstrap;
+    channel_options.host_name = local_server_tester->endpoint.address;
+    channel_options.port = 0;
+    channel_options.socket_options = &local_server_tester->socket_options;
+    channel_options.tls_options = &client_tls_opt_tester->opt;
+    channel_options.setup_callback = s_tls_handler_test_client_setup_callback;
+    channel_options.shutdown_callback = s_tls_handler_test_client_shutdown_callback;
+    channel_options.user_data = &outgoing_args;
+    ASSERT_SUCCESS(aws_client_bootstrap_new_socket_channel(&channel_options));
 
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &incoming_rw_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, incoming_args));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_predicate, &outgoing_rw_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_setup_predicate, &outgoing_args));
     ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+    ASSERT_FALSE(incoming_args->error_invoked);
+    ASSERT_FALSE(outgoing_args.error_invoked);
 
-    ASSERT_INT_EQUALS(2, outgoing_rw_args.read_invocations);
-    ASSERT_INT_EQUALS(2, incoming_rw_args.read_invocations);
+    rw_handler_write(outgoing_args.rw_handler, outgoing_args.rw_slot, &write_tag);
+    rw_handler_write(incoming_args->rw_handler, incoming_args->rw_slot, &read_tag);
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_all_predicate, &incoming_rw_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_test_read_all_predicate, &outgoing_rw_args));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
     ASSERT_BIN_ARRAYS_EQUALS(
         write_tag.buffer,
@@ -558,31 +1603,89 @@ static int s_tls_channel_echo_and_backpressure_test_fn(struct aws_allocator *all
     ASSERT_BIN_ARRAYS_EQUALS(
         read_tag.buffer, read_tag.len, outgoing_rw_args.received_message.buffer, outgoing_rw_args.received_message.len);
 
-    aws_channel_shutdown(incoming_args.channel, AWS_OP_SUCCESS);
+    aws_channel_shutdown(outgoing_args.channel, AWS_OP_SUCCESS);
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &incoming_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+    ASSERT_SUCCESS(aws_condition_variable_wait_pred(
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, incoming_args));
     ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
 
-    /*no shutdown on the client necessary here (it should have been triggered by shutting down the other side). just
-     * wait for the event to fire. */
+    /* both bootstraps destroy their channel right after its shutdown callback, on the loop the handlers live on */
+    struct tls_blocked_loop loop = {
+        .mutex = &c_tester.mutex,
+        .condition_variable = &c_tester.condition_variable,
+    };
+    aws_task_init(&loop.task, s_tls_drain_loop_task, &loop, "tls_test_drain_loop");
+    aws_event_loop_schedule_task_now(aws_event_loop_group_get_next_loop(c_tester.el_group), &loop.task);
     ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
-        &c_tester.condition_variable, &c_tester.mutex, s_tls_channel_shutdown_predicate, &outgoing_args));
+        &c_tester.condition_variable, &c_tester.mutex, s_tls_blocked_loop_drained_predicate, &loop));
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
+    return AWS_OP_SUCCESS;
+}
+
+/*
+ * With pooling on, the second of two connections on a loop starts from the s2n connections the first one wiped on
+ * the way out, on both ends, and still negotiates and exchanges data. The ctxs are destroyed with their pools full.
+ */
+static int s_tls_connection_pool_reuse_test_fn(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+    aws_io_library_init(allocator);
+    ASSERT_SUCCESS(s_tls_common_tester_init_with_loops(allocator, &c_tester, 1));
+    s_tls_ctx_settings.connection_pool_size = 4;
+    aws_io_metrics_set_enabled(true);
+
+    struct tls_test_args incoming_args;
+    ASSERT_SUCCESS(s_tls_test_arg_init(allocator, &incoming_args, true, &c_tester));
+    struct tls_local_server_tester local_server_tester;
+    ASSERT_SUCCESS(s_tls_local_server_tester_init(allocator, &local_server_tester, &incoming_args, &c_tester, false));
+
+    struct tls_opt_tester client_tls_opt_tester;
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("localhost");
+    ASSERT_SUCCESS(s_tls_client_opt_tester_init(allocator, &client_tls_opt_tester, server_name));
+
+    struct aws_client_bootstrap_options bootstrap_options = {
+        .event_loop_group = c_tester.el_group,
+        .host_resolver = c_tester.resolver,
+    };
+    struct aws_client_bootstrap *client_bootstrap = aws_client_bootstrap_new(allocator, &bootstrap_options);
+
+    ASSERT_SUCCESS(s_tls_pooled_connection_round(
+        allocator, &local_server_tester, &incoming_args, &client_tls_opt_tester, client_bootstrap));
+
+    struct aws_io_metrics_snapshot before;
+    aws_io_metrics_snapshot(&before);
+
+    ASSERT_SUCCESS(s_tls_pooled_connection_round(
+        allocator, &local_server_tester, &incoming_args, &client_tls_opt_tester, client_bootstrap));
+
+    struct aws_io_metrics_snapshot after;
+    aws_io_metrics_snapshot(&after);
+    aws_io_metrics_set_enabled(false);
+
+    /* one for the client's handler and one for the server's */
+    ASSERT_UINT_EQUALS(
+        2,
+        after.values[AWS_IO_METRIC_TLS_CONNECTIONS_REUSED] - before.values[AWS_IO_METRIC_TLS_CONNECTIONS_REUSED]);
+
+    ASSERT_SUCCESS(aws_mutex_lock(&c_tester.mutex));
     aws_server_bootstrap_destroy_socket_listener(local_server_tester.server_bootstrap, local_server_tester.listener);
     ASSERT_SUCCESS(aws_condition_variable_wait_pred(
         &c_tester.condition_variable, &c_tester.mutex, s_tls_listener_destroy_predicate, &incoming_args));
-    aws_mutex_unlock(&c_tester.mutex);
-    /* clean up */
+    ASSERT_SUCCESS(aws_mutex_unlock(&c_tester.mutex));
+
     ASSERT_SUCCESS(s_tls_opt_tester_clean_up(&client_tls_opt_tester));
     aws_client_bootstrap_release(client_bootstrap);
     ASSERT_SUCCESS(s_tls_local_server_tester_clean_up(&local_server_tester));
     ASSERT_SUCCESS(s_tls_common_tester_clean_up(&c_tester));
     aws_io_library_clean_up();
+    AWS_ZERO_STRUCT(s_tls_ctx_settings);
     return AWS_OP_SUCCESS;
 }
 
-AWS_TEST_CASE(tls_channel_echo_and_backpressure_test, s_tls_channel_echo_and_backpressure_test_fn)
+AWS_TEST_CASE(tls_connection_pool_reuse, s_tls_connection_pool_reuse_test_fn)
 
 struct default_host_callback_data {
     struct aws_host_address aaaa_address;
@@ -1687,3 +2790,53 @@ static int s_tls_destroy_null_context(struct aws_allocator *allocator, void *ctx
     return AWS_OP_SUCCESS;
 }
 AWS_TEST_CASE(tls_destroy_null_context, s_tls_destroy_null_context);
+
+/* A copy of connection options carries the dynamic record sizing settings along with deep copies of everything it
+ * owns, and cleaning up either one leaves the other intact. */
+static int s_tls_connection_options_copy_and_clean_up(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    aws_io_library_init(allocator);
+
+    struct aws_tls_ctx_options client_ctx_options;
+    aws_tls_ctx_options_init_default_client(&client_ctx_options, allocator);
+    struct aws_tls_ctx *client_ctx = aws_tls_client_ctx_new(allocator, &client_ctx_options);
+    ASSERT_NOT_NULL(client_ctx);
+
+    struct aws_tls_connection_options original;
+    aws_tls_connection_options_init_from_ctx(&original, client_ctx);
+    struct aws_byte_cursor server_name = aws_byte_cursor_from_c_str("example.com");
+    ASSERT_SUCCESS(aws_tls_connection_options_set_server_name(&original, allocator, &server_name));
+    ASSERT_SUCCESS(aws_tls_connection_options_set_alpn_list(&original, allocator, "h2;http/1.1"));
+    aws_tls_connection_options_set_dynamic_record_sizing(&original, 1024 * 1024, 2);
+
+    struct aws_tls_connection_options copy;
+    ASSERT_SUCCESS(aws_tls_connection_options_copy(&copy, &original));
+
+    /* the copy holds its own ref on the ctx */
+    aws_tls_ctx_release(client_ctx);
+    ASSERT_PTR_EQUALS(client_ctx, copy.ctx);
+    ASSERT_UINT_EQUALS(original.timeout_ms, copy.timeout_ms);
+    ASSERT_UINT_EQUALS(1024 * 1024, copy.dynamic_record_threshold);
+    ASSERT_UINT_EQUALS(2, copy.dynamic_record_reset_timeout_secs);
+    ASSERT_FALSE(copy.server_name == original.server_name);
+    ASSERT_FALSE(copy.alpn_list == original.alpn_list);
+    ASSERT_TRUE(aws_string_eq(copy.server_name, original.server_name));
+    ASSERT_TRUE(aws_string_eq(copy.alpn_list, original.alpn_list));
+
+    aws_tls_connection_options_clean_up(&original);
+    ASSERT_NULL(original.ctx);
+    ASSERT_NULL(original.server_name);
+    ASSERT_NULL(original.alpn_list);
+    ASSERT_UINT_EQUALS(0, original.dynamic_record_threshold);
+
+    ASSERT_TRUE(aws_string_eq_c_str(copy.server_name, "example.com"));
+    ASSERT_TRUE(aws_string_eq_c_str(copy.alpn_list, "h2;http/1.1"));
+    aws_tls_connection_options_clean_up(&copy);
+
+    aws_tls_ctx_options_clean_up(&client_ctx_options);
+    aws_io_library_clean_up();
+
+    return AWS_OP_SUCCESS;
+}
+AWS_TEST_CASE(tls_connection_options_copy_and_clean_up, s_tls_connection_options_copy_and_clean_up)
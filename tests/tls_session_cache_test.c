@@ -0,0 +1,168 @@
+/**
+ * Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: Apache-2.0.
+ */
+#include <aws/io/private/tls_session_cache.h>
+
+#include <aws/io/tls_channel_handler.h>
+
+#include <aws/testing/aws_test_harness.h>
+
+#include <aws/common/clock.h>
+#include <aws/common/string.h>
+
+AWS_STATIC_STRING_FROM_LITERAL(s_server_name, "example.com");
+AWS_STATIC_STRING_FROM_LITERAL(s_other_server_name, "example.org");
+
+static uint64_t s_fake_now = 0;
+
+static int s_fake_clock(uint64_t *timestamp) {
+    *timestamp = s_fake_now;
+    return AWS_OP_SUCCESS;
+}
+
+static int s_check_cached(
+    struct aws_allocator *allocator,
+    struct aws_tls_session_cache *cache,
+    const struct aws_string *key,
+    const char *expected) {
+
+    struct aws_byte_buf session;
+    ASSERT_SUCCESS(aws_byte_buf_init(&session, allocator, 0));
+    ASSERT_SUCCESS(aws_tls_session_cache_get(cache, key, &session));
+
+    if (expected) {
+        ASSERT_BIN_ARRAYS_EQUALS(expected, strlen(expected), session.buffer, session.len);
+    } else {
+        ASSERT_UINT_EQUALS(0, session.len);
+    }
+
+    aws_byte_buf_clean_up(&session);
+    return AWS_OP_SUCCESS;
+}
+
+static int s_test_tls_session_cache_key(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_string *key = aws_tls_session_cache_key_new(allocator, s_server_name, 443);
+    ASSERT_NOT_NULL(key);
+    ASSERT_STR_EQUALS("example.com:443", aws_string_c_str(key));
+    aws_string_destroy(key);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_tls_session_cache_key, s_test_tls_session_cache_key)
+
+static int s_test_tls_session_cache_put_get_remove(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tls_session_cache cache;
+    ASSERT_SUCCESS(aws_tls_session_cache_init(&cache, allocator, 4, 60));
+
+    struct aws_string *key = aws_tls_session_cache_key_new(allocator, s_server_name, 443);
+    struct aws_string *other_port_key = aws_tls_session_cache_key_new(allocator, s_server_name, 8443);
+    ASSERT_NOT_NULL(key);
+    ASSERT_NOT_NULL(other_port_key);
+
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, NULL));
+
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key, aws_byte_cursor_from_c_str("session-1")));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, "session-1"));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, other_port_key, NULL));
+
+    /* a newer session replaces the old one */
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key, aws_byte_cursor_from_c_str("session-2")));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, "session-2"));
+
+    aws_tls_session_cache_remove(&cache, key);
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, NULL));
+
+    aws_string_destroy(key);
+    aws_string_destroy(other_port_key);
+    aws_tls_session_cache_clean_up(&cache);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_tls_session_cache_put_get_remove, s_test_tls_session_cache_put_get_remove)
+
+static int s_test_tls_session_cache_lru_eviction(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tls_session_cache cache;
+    ASSERT_SUCCESS(aws_tls_session_cache_init(&cache, allocator, 2, 60));
+
+    struct aws_string *key_a = aws_tls_session_cache_key_new(allocator, s_server_name, 443);
+    struct aws_string *key_b = aws_tls_session_cache_key_new(allocator, s_server_name, 8443);
+    struct aws_string *key_c = aws_tls_session_cache_key_new(allocator, s_other_server_name, 443);
+
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key_a, aws_byte_cursor_from_c_str("a")));
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key_b, aws_byte_cursor_from_c_str("b")));
+
+    /* touching a makes b the least recently used */
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key_a, "a"));
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key_c, aws_byte_cursor_from_c_str("c")));
+
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key_a, "a"));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key_b, NULL));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key_c, "c"));
+
+    aws_string_destroy(key_a);
+    aws_string_destroy(key_b);
+    aws_string_destroy(key_c);
+    aws_tls_session_cache_clean_up(&cache);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_tls_session_cache_lru_eviction, s_test_tls_session_cache_lru_eviction)
+
+static int s_test_tls_session_cache_ttl(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tls_session_cache cache;
+    ASSERT_SUCCESS(aws_tls_session_cache_init(&cache, allocator, 4, 10));
+    cache.clock_fn = s_fake_clock;
+    s_fake_now = aws_timestamp_convert(1000, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    struct aws_string *key = aws_tls_session_cache_key_new(allocator, s_server_name, 443);
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key, aws_byte_cursor_from_c_str("session")));
+
+    s_fake_now += aws_timestamp_convert(9, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, "session"));
+
+    s_fake_now += aws_timestamp_convert(1, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, NULL));
+
+    aws_string_destroy(key);
+    aws_tls_session_cache_clean_up(&cache);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_tls_session_cache_ttl, s_test_tls_session_cache_ttl)
+
+static int s_test_tls_session_cache_default_ttl(struct aws_allocator *allocator, void *ctx) {
+    (void)ctx;
+
+    struct aws_tls_session_cache cache;
+    ASSERT_SUCCESS(aws_tls_session_cache_init(&cache, allocator, 4, 0));
+    cache.clock_fn = s_fake_clock;
+    s_fake_now = aws_timestamp_convert(1000, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+
+    struct aws_string *key = aws_tls_session_cache_key_new(allocator, s_server_name, 443);
+    ASSERT_SUCCESS(aws_tls_session_cache_put(&cache, key, aws_byte_cursor_from_c_str("session")));
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, "session"));
+
+    s_fake_now +=
+        aws_timestamp_convert(AWS_TLS_SESSION_CACHE_DEFAULT_TTL_SECS, AWS_TIMESTAMP_SECS, AWS_TIMESTAMP_NANOS, NULL);
+    ASSERT_SUCCESS(s_check_cached(allocator, &cache, key, NULL));
+
+    aws_string_destroy(key);
+    aws_tls_session_cache_clean_up(&cache);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(test_tls_session_cache_default_ttl, s_test_tls_session_cache_default_ttl)
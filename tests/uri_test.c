@@ -387,6 +387,58 @@ static int s_test_uri_port_too_large_parse(struct aws_allocator *allocator, void
 
 AWS_TEST_CASE(uri_port_too_large_parse, s_test_uri_port_too_large_parse);
 
+#define ASSERT_VIEW_PART_EQUALS(expected, part)                                                                        \
+    ASSERT_BIN_ARRAYS_EQUALS(expected, strlen(expected), (part).ptr, (part).len)
+
+static int s_test_uri_view_parse(struct aws_allocator *allocator, void *ctx) {
+    (void)allocator;
+    (void)ctx;
+    const char *str_uri = "https://www.test.com:8443/path/to/resource?test1=value1&testkeyonly&&test2=value2";
+
+    struct aws_byte_cursor uri_csr = aws_byte_cursor_from_c_str(str_uri);
+    struct aws_uri_view view;
+    ASSERT_SUCCESS(aws_uri_view_parse(&view, uri_csr));
+
+    /* everything points into the parsed string, nothing was copied */
+    ASSERT_PTR_EQUALS(uri_csr.ptr, view.scheme.ptr);
+    ASSERT_VIEW_PART_EQUALS("https", view.scheme);
+    ASSERT_VIEW_PART_EQUALS("www.test.com:8443", view.authority);
+    ASSERT_VIEW_PART_EQUALS("www.test.com", view.host_name);
+    ASSERT_UINT_EQUALS(8443, view.port);
+    ASSERT_VIEW_PART_EQUALS("/path/to/resource", view.path);
+    ASSERT_VIEW_PART_EQUALS("test1=value1&testkeyonly&&test2=value2", view.query_string);
+    ASSERT_VIEW_PART_EQUALS("/path/to/resource?test1=value1&testkeyonly&&test2=value2", view.path_and_query);
+
+    struct aws_uri_param param;
+    AWS_ZERO_STRUCT(param);
+    ASSERT_TRUE(aws_uri_view_query_string_next_param(&view, &param));
+    ASSERT_VIEW_PART_EQUALS("test1", param.key);
+    ASSERT_VIEW_PART_EQUALS("value1", param.value);
+    ASSERT_TRUE(aws_uri_view_query_string_next_param(&view, &param));
+    ASSERT_VIEW_PART_EQUALS("testkeyonly", param.key);
+    ASSERT_UINT_EQUALS(0, param.value.len);
+    ASSERT_TRUE(aws_uri_view_query_string_next_param(&view, &param));
+    ASSERT_VIEW_PART_EQUALS("test2", param.key);
+    ASSERT_VIEW_PART_EQUALS("value2", param.value);
+    ASSERT_FALSE(aws_uri_view_query_string_next_param(&view, &param));
+
+    /* a request-target with no path gets the default one */
+    uri_csr = aws_byte_cursor_from_c_str("www.test.com:8443");
+    ASSERT_SUCCESS(aws_uri_view_parse(&view, uri_csr));
+    ASSERT_VIEW_PART_EQUALS("www.test.com", view.host_name);
+    ASSERT_VIEW_PART_EQUALS("/", view.path);
+    ASSERT_UINT_EQUALS(0, view.query_string.len);
+    ASSERT_FALSE(aws_uri_view_query_string_next_param(&view, &param));
+
+    uri_csr = aws_byte_cursor_from_c_str("https://www.test.com:s8443/path");
+    ASSERT_ERROR(AWS_ERROR_MALFORMED_INPUT_STRING, aws_uri_view_parse(&view, uri_csr));
+    ASSERT_UINT_EQUALS(0, view.host_name.len);
+
+    return AWS_OP_SUCCESS;
+}
+
+AWS_TEST_CASE(uri_view_parse, s_test_uri_view_parse);
+
 static int s_test_uri_builder(struct aws_allocator *allocator, void *ctx) {
     (void)ctx;
     const char *str_uri =
@@ -535,6 +587,11 @@ static int s_test_uri_encode_path_rfc3986(struct aws_allocator *allocator, void
     ASSERT_SUCCESS(s_test_uri_encode_path_case(allocator, "/path/ሴ", "/path/%E1%88%B4"));
     ASSERT_SUCCESS(s_test_uri_encode_path_case(
         allocator, "/path/\"'()*+<>[\\]`{|}/", "/path/%22%27%28%29%2A%2B%3C%3E%5B%5C%5D%60%7B%7C%7D/"));
+    /* long enough to be scanned in chunks, with characters to encode inside and across chunks */
+    ASSERT_SUCCESS(s_test_uri_encode_path_case(
+        allocator,
+        "/a-long-path-segment/that_spans.several~chunks/then a space/@and:more;=stuff$&,/ሴ/end",
+        "/a-long-path-segment/that_spans.several~chunks/then%20a%20space/@and:more;=stuff$&,/%E1%88%B4/end"));
 
     return AWS_OP_SUCCESS;
 }
@@ -574,6 +631,10 @@ static int s_test_uri_encode_query(struct aws_allocator *allocator, void *ctx) {
     ASSERT_SUCCESS(s_test_uri_encode_param_case(allocator, "ሴ", "%E1%88%B4"));
     ASSERT_SUCCESS(
         s_test_uri_encode_param_case(allocator, "\"'()*+<>[\\]`{|}", "%22%27%28%29%2A%2B%3C%3E%5B%5C%5D%60%7B%7C%7D"));
+    ASSERT_SUCCESS(s_test_uri_encode_param_case(
+        allocator,
+        "a-long_param.value~that-spans-chunks/with=reserved&characters@in:it",
+        "a-long_param.value~that-spans-chunks%2Fwith%3Dreserved%26characters%40in%3Ait"));
 
     return AWS_OP_SUCCESS;
 }
@@ -648,6 +709,10 @@ static int s_test_uri_decode(struct aws_allocator *allocator, void *ctx) {
     ASSERT_SUCCESS(s_test_uri_decode_ok(allocator, "%e1%88%b4", "ሴ"));
     ASSERT_SUCCESS(s_test_uri_decode_ok(allocator, "%2520", "%20"));
     ASSERT_SUCCESS(s_test_uri_decode_ok(allocator, "ሴ", "ሴ")); /* odd input should just pass through */
+    ASSERT_SUCCESS(s_test_uri_decode_ok(
+        allocator,
+        "a-long-run-of-plain-characters%20then%2Fescapes%20",
+        "a-long-run-of-plain-characters then/escapes "));
     ASSERT_SUCCESS(s_test_uri_decode_ok(
         allocator,
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz", /* long enough to resize output buffer */